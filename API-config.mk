@@ -7,6 +7,8 @@ CXX := arm-linux-gnueabi-g++
 
 #Compilerflags:
 CXXFLAGS = -Wall
+#Libraries needed by the API (threads, clock_gettime):
+LDLIBS = -pthread -lrt
 
 #Architecture for gnublin:
 Architecture = armel
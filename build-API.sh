@@ -22,9 +22,15 @@ rm include_tmp.h
 
 cat include/functions.h >> gnublin.h
 
+cat drivers/event.h >> gnublin.h
 cat drivers/gpio.h >> gnublin.h
+cat drivers/gpio_edge.h >> gnublin.h
 cat drivers/i2c.h >> gnublin.h
 cat drivers/spi.h >> gnublin.h
+cat drivers/adc_sampler.h >> gnublin.h
+cat drivers/adc_filter.h >> gnublin.h
+cat drivers/adc_calibration.h >> gnublin.h
+cat drivers/adc_comparator.h >> gnublin.h
 cat drivers/adc.h >> gnublin.h
 
 cat modules/module_dogm.h >> gnublin.h
@@ -32,7 +38,13 @@ cat modules/module_lm75.h >> gnublin.h
 cat modules/module_adc.h >> gnublin.h
 cat modules/module_pca9555.h >> gnublin.h
 cat modules/module_relay.h >> gnublin.h
+cat modules/relay_scheduler.h >> gnublin.h
 cat modules/module_step.h >> gnublin.h
+cat modules/step_poller.h >> gnublin.h
+cat modules/step_homing.h >> gnublin.h
+cat modules/step_group.h >> gnublin.h
+cat modules/step_planner.h >> gnublin.h
+cat modules/gcode.h >> gnublin.h
 cat modules/module_lcd.h >> gnublin.h
 
 sed -i "s/#include \"..\/include\/includes.h\"/\/\/***** NEW BLOCK *****/g" gnublin.h
@@ -52,17 +64,29 @@ echo "//********************************************
 
 cat include/functions.cpp >> gnublin.cpp
 
+cat drivers/event.cpp >> gnublin.cpp
 cat drivers/gpio.cpp >> gnublin.cpp
+cat drivers/gpio_edge.cpp >> gnublin.cpp
 cat drivers/i2c.cpp >> gnublin.cpp
 cat drivers/spi.cpp >> gnublin.cpp
 cat drivers/adc.cpp >> gnublin.cpp
+cat drivers/adc_sampler.cpp >> gnublin.cpp
+cat drivers/adc_filter.cpp >> gnublin.cpp
+cat drivers/adc_calibration.cpp >> gnublin.cpp
+cat drivers/adc_comparator.cpp >> gnublin.cpp
 
 cat modules/module_dogm.cpp >> gnublin.cpp
 cat modules/module_lm75.cpp >> gnublin.cpp
 cat modules/module_adc.cpp >> gnublin.cpp
 cat modules/module_pca9555.cpp >> gnublin.cpp
 cat modules/module_relay.cpp >> gnublin.cpp
+cat modules/relay_scheduler.cpp >> gnublin.cpp
 cat modules/module_step.cpp >> gnublin.cpp
+cat modules/step_poller.cpp >> gnublin.cpp
+cat modules/step_homing.cpp >> gnublin.cpp
+cat modules/step_group.cpp >> gnublin.cpp
+cat modules/step_planner.cpp >> gnublin.cpp
+cat modules/gcode.cpp >> gnublin.cpp
 cat modules/module_lcd.cpp >> gnublin.cpp
 
 sed -i "/^#include /d" gnublin.cpp
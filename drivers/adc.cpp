@@ -5,22 +5,74 @@
 // Class for easy acces to the GPAs
 //****************************************************************************
 /** @~english 
-* @brief Opens the file stream and loads the kernel object lpc313x_adc.
+* @brief Loads the kernel object lpc313x_adc if the device file is missing.
+*
+* The device file itself is opened on the first call of getValue() and stays open.
 *
 * @~german 
-* @brief Erzeugt den Datei stream und lädt das Kernelmodul lpc313x_adc.
+* @brief Lädt das Kernelmodul lpc313x_adc, falls die Gerätedatei fehlt.
+*
+* Die Gerätedatei selbst wird beim ersten Aufruf von getValue() geöffnet und bleibt geöffnet.
 *
 */
-gnublin_adc::gnublin_adc(){
-	std::ifstream file("/dev/lpc313x_adc");
+gnublin_adc::gnublin_adc() : calibration(1024, 3300) {
+	devicefile = "/dev/lpc313x_adc";
+	std::ifstream file(devicefile.c_str());
 	if (file.fail()) {
 		system("modprobe lpc313x_adc");
 		sleep(1);
 	}
 	file.close();
+	fd = -1;
+	channel = -1;
 	error_flag = false;
 }
 
+/** @~english 
+* @brief Closes the device file.
+*
+* @~german 
+* @brief Schließt die Gerätedatei.
+*
+*/
+gnublin_adc::~gnublin_adc(){
+	if (fd >= 0)
+		close(fd);
+}
+
+//-------------setDevicefile-------------
+/** @~english 
+* @brief Set devicefile.
+*
+* With this function you can change the ADC device file. Default is "/dev/lpc313x_adc"
+* @param filename path to the ADC device file
+*
+* @~german 
+* @brief Setzt Device Datei.
+*
+* Mit dieser Funktion kann die ADC Gerätedatei geändert werden. Standardmäßig wird "/dev/lpc313x_adc" benutzt.
+* @param filename Pfad zur ADC Gerätedatei
+*/
+void gnublin_adc::setDevicefile(std::string filename){
+	if (fd >= 0)
+		close(fd);
+	fd = -1;
+	channel = -1;
+	devicefile = filename;
+}
+
+//-------------openDevice-------------
+// opens the device file once, it is kept open for all following samples
+int gnublin_adc::openDevice(){
+	if ((fd = open(devicefile.c_str(), O_RDWR)) < 0) {
+		ErrorMessage = "ERROR opening: " + devicefile + "\n";
+		error_flag = true;
+		return -1;
+	}
+	channel = -1;
+	return 1;
+}
+
 //-------------fail-------------
 /** @~english 
 * @brief Returns the error flag. 
@@ -73,63 +125,156 @@ const char *gnublin_adc::getErrorMessage(){
 * @return Wert des ADCs, im Fehlerfall -1
 */
 int gnublin_adc::getValue(int pin){
-	std::string value;
-	
-	std::string pin_str = numberToString(pin);
-	std::string device = "/dev/lpc313x_adc";
-	std::ofstream file(device.c_str());
-	if (file < 0) {
+	char buffer[16];
+	int length, value;
+
+	if (fd < 0 && openDevice() < 0)
+		return -1;
+
+	// the channel is only selected if it differs from the last one
+	if (pin != channel) {
+		length = snprintf(buffer, sizeof(buffer), "%d", pin);
+		if (pwrite(fd, buffer, length, 0) != length && (errno != ESPIPE || write(fd, buffer, length) != length)) {
+			ErrorMessage = "ERROR selecting channel on: " + devicefile + "\n";
+			error_flag = true;
+			channel = -1;
+			return -1;
+		}
+		channel = pin;
+	}
+
+	length = pread(fd, buffer, sizeof(buffer), 0);
+	if (length < 0 && errno == ESPIPE)
+		length = read(fd, buffer, sizeof(buffer));
+	if (length <= 0) {
+		ErrorMessage = "ERROR reading: " + devicefile + "\n";
+		error_flag = true;
+		return -1;
+	}
+	value = hexbufferToNumber(buffer, length);
+	if (value < 0) {
+		ErrorMessage = "ERROR parsing the value of: " + devicefile + "\n";
 		error_flag = true;
 		return -1;
 	}
-	file << pin_str;
-	file.close();
-	std::ifstream dev_file(device.c_str());
-	dev_file >> value;
-	dev_file.close();
 	error_flag = false;
-	return hexstringToNumber(value);
+	return value;
 }
 
 //-------------getVoltage-------------
 /** @~english 
 * @brief Get Voltage.
 *
-* This Funktion returns the Voltage of the given pin.
+* This Funktion returns the Voltage of the given pin, using the calibration of the pin (default: reference 3300 mV, no offset, gain 1).
 * @param pin The pin, which should be used
 * @return Voltage of the Pin - in failure: -1
 *
 * @~german 
 * @brief Ließt Spannung.
 *
-* Liefert den gemessenen Wert in mV. 
+* Liefert den gemessenen Wert in mV, umgerechnet mit der Kalibrierung des Pins (Standard: Referenz 3300 mV, kein Offset, Verstärkung 1). 
 * @param pin Gibt den ADC-Pin an, von dem gemessen werden soll 
 * @return Spannung des ADCs in mV, im Fehlerfall -1
 */
 int gnublin_adc::getVoltage(int pin){
 	int value = getValue(pin);
-	value = value*825/256;
-	return value;
+	if (value < 0)
+		return -1;
+	return calibration.toMillivolt(pin, value);
 }
 
 //-------------setReference-------------
 /** @~english 
 * @brief set Reference.
 *
-* @param ref 
+* Sets the reference voltage of all pins, which is used by getVoltage().
+* @param ref reference voltage in mV (1-5000)
 * @return success: 1, failure: -1
 *
 * @~german 
 * @brief setzt Referenz.
 *
-* @param ref 
+* Setzt die Referenzspannung aller Pins, die von getVoltage() benutzt wird.
+* @param ref Referenzspannung in mV (1-5000)
 * @return Erfolg: 1, Fehler: -1
 */
 int gnublin_adc::setReference(int ref){
+	if (calibration.setReference(ref) < 0) {
+		ErrorMessage = calibration.getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
 	error_flag = false;
 	return 1;
 }
 
+//-------------setCalibration-------------
+/** @~english 
+* @brief set the calibration of a pin.
+*
+* @param pin ADC pin (0-8)
+* @param offset offset in LSB, added to the raw value
+* @param gain_ppm gain in parts per million, 1000000 = 1.0
+* @param reference reference voltage in mV
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief setzt die Kalibrierung eines Pins.
+*
+* @param pin ADC-Pin (0-8)
+* @param offset Offset in LSB, wird zum Rohwert addiert
+* @param gain_ppm Verstärkung in millionstel, 1000000 = 1,0
+* @param reference Referenzspannung in mV
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc::setCalibration(int pin, int offset, int gain_ppm, int reference){
+	if (calibration.setChannel(pin, offset, gain_ppm, reference) < 0) {
+		ErrorMessage = calibration.getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
 
+//-------------loadCalibration-------------
+/** @~english 
+* @brief load the calibration of the pins from a file.
+*
+* Every line contains "pin offset gain reference", e.g. "1 -2 1.0031 3300".
+* @param filename path of the calibration file
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief lädt die Kalibrierung der Pins aus einer Datei.
+*
+* Jede Zeile enthält "Pin Offset Verstärkung Referenz", z.B. "1 -2 1.0031 3300".
+* @param filename Pfad zur Kalibrierungsdatei
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc::loadCalibration(std::string filename){
+	if (calibration.load(filename) < 0) {
+		ErrorMessage = calibration.getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
+
+//-------------getCalibration-------------
+/** @~english 
+* @brief get the calibration, e.g. to convert whole blocks of samples to mV.
+*
+* @return pointer to the calibration of this ADC
+*
+* @~german 
+* @brief gibt die Kalibrierung zurück, z.B. um ganze Blöcke von Werten in mV umzurechnen.
+*
+* @return Zeiger auf die Kalibrierung dieses ADCs
+*/
+gnublin_adc_calibration *gnublin_adc::getCalibration(){
+	return &calibration;
+}
 
 #endif
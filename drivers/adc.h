@@ -1,4 +1,5 @@
 #include "../include/includes.h"
+#include "adc_calibration.h"
 
 #if (BOARD != RASPBERRY_PI)
 //****************************************************************************
@@ -18,13 +19,25 @@
 class gnublin_adc {
 	public:
 		gnublin_adc();
+		~gnublin_adc();
+		void setDevicefile(std::string filename);
 		int getValue(int pin);
 		int getVoltage(int pin);
 		int setReference(int ref);
+		int setCalibration(int pin, int offset, int gain_ppm, int reference);
+		int loadCalibration(std::string filename);
+		gnublin_adc_calibration *getCalibration();
 		bool fail();
 		const char *getErrorMessage();
 	private:
+		gnublin_adc(const gnublin_adc &);
+		gnublin_adc &operator=(const gnublin_adc &);
+		int openDevice();
 		bool error_flag;
+		int fd;
+		int channel;
+		gnublin_adc_calibration calibration;
+		std::string devicefile;
 		std::string ErrorMessage;
 };
 
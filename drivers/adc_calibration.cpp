@@ -0,0 +1,276 @@
+#include "adc_calibration.h"
+
+//****************************************************************************
+// Class for converting raw ADC values to mV
+//****************************************************************************
+
+/** @~english
+* @brief Set all channels to offset 0, gain 1 and the given reference.
+*
+* @param full_scale raw value which corresponds to the reference voltage (e.g. 1024 for the GPAs)
+* @param reference reference voltage in mV
+*
+* @~german
+* @brief Setzt alle Kanäle auf Offset 0, Verstärkung 1 und die übergebene Referenz.
+*
+* @param full_scale Rohwert, der der Referenzspannung entspricht (z.B. 1024 für die GPAs)
+* @param reference Referenzspannung in mV
+*/
+gnublin_adc_calibration::gnublin_adc_calibration(int full_scale, int reference){
+	this->full_scale = full_scale;
+	for (int i = 0; i < ADC_CALIBRATION_CHANNELS; i++) {
+		offset[i] = 0;
+		gain_ppm[i] = 1000000;
+		this->reference[i] = reference;
+		update(i);
+	}
+	error_flag = false;
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_adc_calibration::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_adc_calibration::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+// multiplier = ceil(reference * gain / (full_scale * 10^6) * 2^48)
+// Rounding the multiplier up keeps the error below x / 2^48 < 1 / (2 * full_scale * 10^6),
+// which is smaller than the distance of any non tie result to the next rounding boundary.
+void gnublin_adc_calibration::update(int channel){
+	unsigned long long n = (unsigned long long)reference[channel] * gain_ppm[channel];
+	unsigned long long d = (unsigned long long)full_scale * 1000000;
+	unsigned long long q = n / d;
+	unsigned long long r = n % d;
+
+	for (int i = 0; i < ADC_CALIBRATION_SHIFT; i++) {
+		q <<= 1;
+		r <<= 1;
+		if (r >= d) {
+			r -= d;
+			q |= 1;
+		}
+	}
+	if (r)
+		q++;
+	multiplier[channel] = q;
+}
+
+//-------------setReference-------------
+/** @~english
+* @brief Set the reference voltage of all channels.
+*
+* @param reference reference voltage in mV (1-5000)
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Referenzspannung aller Kanäle.
+*
+* @param reference Referenzspannung in mV (1-5000)
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_calibration::setReference(int reference){
+	if (reference < 1 || reference > 5000) {
+		ErrorMessage = "reference is not between 1-5000 mV\n";
+		error_flag = true;
+		return -1;
+	}
+	for (int i = 0; i < ADC_CALIBRATION_CHANNELS; i++) {
+		this->reference[i] = reference;
+		update(i);
+	}
+	error_flag = false;
+	return 1;
+}
+
+//-------------setChannel-------------
+/** @~english
+* @brief Set the calibration of one channel.
+*
+* @param channel channel number (0-8)
+* @param offset offset in LSB, added to the raw value (-255 to 255)
+* @param gain_ppm gain in parts per million, 1000000 = 1.0 (1-2000000)
+* @param reference reference voltage in mV (1-5000)
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Kalibrierung eines Kanals.
+*
+* @param channel Kanalnummer (0-8)
+* @param offset Offset in LSB, wird zum Rohwert addiert (-255 bis 255)
+* @param gain_ppm Verstärkung in millionstel, 1000000 = 1,0 (1-2000000)
+* @param reference Referenzspannung in mV (1-5000)
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_calibration::setChannel(int channel, int offset, int gain_ppm, int reference){
+	if (channel < 0 || channel >= ADC_CALIBRATION_CHANNELS || offset < -255 || offset > 255
+	    || gain_ppm < 1 || gain_ppm > 2000000 || reference < 1 || reference > 5000) {
+		ErrorMessage = "invalid calibration for channel " + numberToString(channel) + "\n";
+		error_flag = true;
+		return -1;
+	}
+	this->offset[channel] = offset;
+	this->gain_ppm[channel] = gain_ppm;
+	this->reference[channel] = reference;
+	update(channel);
+	error_flag = false;
+	return 1;
+}
+
+//-------------load-------------
+/** @~english
+* @brief Load the calibration from a file.
+*
+* Every line contains "channel offset gain reference", e.g. "1 -2 1.0031 3300". Empty lines and lines starting with # are ignored.
+* @param filename path of the calibration file
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Lädt die Kalibrierung aus einer Datei.
+*
+* Jede Zeile enthält "Kanal Offset Verstärkung Referenz", z.B. "1 -2 1.0031 3300". Leere Zeilen und Zeilen, die mit # beginnen, werden ignoriert.
+* @param filename Pfad zur Kalibrierungsdatei
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_calibration::load(std::string filename){
+	std::ifstream file(filename.c_str());
+	std::string line;
+	int line_number = 0;
+
+	if (file.fail()) {
+		ErrorMessage = "ERROR opening: " + filename + "\n";
+		error_flag = true;
+		return -1;
+	}
+	while (std::getline(file, line)) {
+		std::istringstream fields(line);
+		int channel, offset, reference;
+		double gain;
+
+		line_number++;
+		if (line.find_first_not_of(" \t\r") == std::string::npos || line[line.find_first_not_of(" \t")] == '#')
+			continue;
+		if (!(fields >> channel >> offset >> gain >> reference)
+		    || setChannel(channel, offset, (int)(gain * 1000000 + 0.5), reference) < 0) {
+			ErrorMessage = "invalid line " + numberToString(line_number) + " in " + filename + "\n";
+			error_flag = true;
+			return -1;
+		}
+	}
+	error_flag = false;
+	return 1;
+}
+
+//-------------toMillivolt-------------
+/** @~english
+* @brief Convert a raw value to mV.
+*
+* @param channel channel number (0-8)
+* @param raw raw value
+* @return voltage in mV, -1 for an invalid channel
+*
+* @~german
+* @brief Rechnet einen Rohwert in mV um.
+*
+* @param channel Kanalnummer (0-8)
+* @param raw Rohwert
+* @return Spannung in mV, -1 bei ungültigem Kanal
+*/
+int gnublin_adc_calibration::toMillivolt(int channel, int raw){
+	int x;
+
+	if (channel < 0 || channel >= ADC_CALIBRATION_CHANNELS)
+		return -1;
+	x = raw + offset[channel];
+	if (x < 0)
+		x = 0;
+	return (int)(((unsigned long long)x * multiplier[channel] + (1ULL << (ADC_CALIBRATION_SHIFT - 1))) >> ADC_CALIBRATION_SHIFT);
+}
+
+/** @~english
+* @brief Convert a block of raw values of one channel to mV.
+*
+* @param channel channel number (0-8)
+* @param raw raw values
+* @param count number of values
+* @param mv the voltages in mV are stored in it
+* @return success: count, failure: -1
+*
+* @~german
+* @brief Rechnet einen Block Rohwerte eines Kanals in mV um.
+*
+* @param channel Kanalnummer (0-8)
+* @param raw Rohwerte
+* @param count Anzahl der Werte
+* @param mv hier werden die Spannungen in mV gespeichert
+* @return Erfolg: count, Fehler: -1
+*/
+int gnublin_adc_calibration::toMillivolt(int channel, const int *raw, int count, int *mv){
+	unsigned long long m;
+	int o;
+
+	if (channel < 0 || channel >= ADC_CALIBRATION_CHANNELS) {
+		ErrorMessage = "channel is not between 0-8\n";
+		error_flag = true;
+		return -1;
+	}
+	m = multiplier[channel];
+	o = offset[channel];
+	for (int i = 0; i < count; i++) {
+		int x = raw[i] + o;
+		x = x < 0 ? 0 : x;
+		mv[i] = (int)(((unsigned long long)x * m + (1ULL << (ADC_CALIBRATION_SHIFT - 1))) >> ADC_CALIBRATION_SHIFT);
+	}
+	error_flag = false;
+	return count;
+}
+
+/** @~english
+* @brief Convert samples of gnublin_adc_sampler to mV.
+*
+* @param samples samples
+* @param count number of samples
+* @param mv the voltages in mV are stored in it, -1 for samples of invalid channels
+* @return count
+*
+* @~german
+* @brief Rechnet Werte von gnublin_adc_sampler in mV um.
+*
+* @param samples Werte
+* @param count Anzahl der Werte
+* @param mv hier werden die Spannungen in mV gespeichert, -1 bei Werten ungültiger Kanäle
+* @return count
+*/
+int gnublin_adc_calibration::toMillivolt(const gnublin_adc_sample *samples, int count, int *mv){
+	for (int i = 0; i < count; i++)
+		mv[i] = toMillivolt(samples[i].channel, samples[i].value);
+	error_flag = false;
+	return count;
+}
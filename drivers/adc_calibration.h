@@ -0,0 +1,43 @@
+#include "../include/includes.h"
+#include "adc_sampler.h"
+
+#define ADC_CALIBRATION_CHANNELS	9
+#define ADC_CALIBRATION_SHIFT		48
+
+//****************************************************************************
+// Class for converting raw ADC values to mV
+//****************************************************************************
+/**
+* @class gnublin_adc_calibration
+* @~english
+* @brief Per channel calibration (offset, gain, reference) and raw to mV conversion
+*
+* mV = round((raw + offset) * gain * reference / full scale)<br>
+* The factor is precomputed as a fixed point multiplier with 48 fraction bits, which is exact to the LSB for all raw values of a 8 to 10 bit ADC.
+* @~german
+* @brief Kalibrierung pro Kanal (Offset, Verstärkung, Referenz) und Umrechnung von Rohwerten in mV
+*
+* mV = round((Rohwert + Offset) * Verstärkung * Referenz / Vollausschlag)<br>
+* Der Faktor wird als Festkomma-Multiplikator mit 48 Nachkommabits vorberechnet, der für alle Rohwerte eines 8 bis 10 Bit ADCs auf das LSB genau ist.
+*/
+class gnublin_adc_calibration {
+	public:
+		gnublin_adc_calibration(int full_scale, int reference);
+		int setReference(int reference);
+		int setChannel(int channel, int offset, int gain_ppm, int reference);
+		int load(std::string filename);
+		int toMillivolt(int channel, int raw);
+		int toMillivolt(int channel, const int *raw, int count, int *mv);
+		int toMillivolt(const gnublin_adc_sample *samples, int count, int *mv);
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		void update(int channel);
+		int full_scale;
+		int offset[ADC_CALIBRATION_CHANNELS];
+		int gain_ppm[ADC_CALIBRATION_CHANNELS];
+		int reference[ADC_CALIBRATION_CHANNELS];
+		unsigned long long multiplier[ADC_CALIBRATION_CHANNELS];
+		bool error_flag;
+		std::string ErrorMessage;
+};
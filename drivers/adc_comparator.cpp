@@ -0,0 +1,256 @@
+#include "adc_comparator.h"
+
+//****************************************************************************
+// Class for threshold and window events on ADC samples
+//****************************************************************************
+
+/** @~english
+* @brief Creates a comparator without windows and rate limits.
+*
+* @~german
+* @brief Erzeugt einen Komparator ohne Fenster und Anstiegsgrenzen.
+*/
+gnublin_adc_comparator::gnublin_adc_comparator(){
+	queue = 0;
+	for (int i = 0; i < ADC_COMPARATOR_CHANNELS; i++)
+		clear(i);
+	error_flag = false;
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_adc_comparator::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_adc_comparator::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------setQueue-------------
+/** @~english
+* @brief Set the queue which receives the events.
+*
+* @param queue event queue, it may also have a callback set
+*
+* @~german
+* @brief Setzt die Warteschlange, die die Ereignisse erhält.
+*
+* @param queue Ereignis-Warteschlange, sie kann auch einen Callback gesetzt haben
+*/
+void gnublin_adc_comparator::setQueue(gnublin_event_queue *queue){
+	this->queue = queue;
+}
+
+//-------------setWindow-------------
+/** @~english
+* @brief Set the window of a channel.
+*
+* Above is entered when the value exceeds high and left when it falls below high - hysteresis.
+* Below is entered when the value falls below low and left when it exceeds low + hysteresis.
+* For a single over threshold set low to 0, for a single under threshold set high to the maximum raw value.
+* @param channel channel number (0-8)
+* @param low lower threshold (raw value)
+* @param high upper threshold (raw value)
+* @param hysteresis hysteresis (raw value)
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt das Fenster eines Kanals.
+*
+* Oberhalb wird betreten, wenn der Wert high überschreitet, und verlassen, wenn er unter high - hysteresis fällt.
+* Unterhalb wird betreten, wenn der Wert low unterschreitet, und verlassen, wenn er über low + hysteresis steigt.
+* Für eine einzelne Oberschwelle low auf 0 setzen, für eine einzelne Unterschwelle high auf den maximalen Rohwert.
+* @param channel Kanalnummer (0-8)
+* @param low untere Schwelle (Rohwert)
+* @param high obere Schwelle (Rohwert)
+* @param hysteresis Hysterese (Rohwert)
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_comparator::setWindow(int channel, int low, int high, int hysteresis){
+	if (channel < 0 || channel >= ADC_COMPARATOR_CHANNELS || low > high || hysteresis < 0) {
+		ErrorMessage = "invalid window\n";
+		error_flag = true;
+		return -1;
+	}
+	this->low[channel] = low;
+	this->high[channel] = high;
+	this->hysteresis[channel] = hysteresis;
+	window[channel] = true;
+	primed[channel] = false;
+	error_flag = false;
+	return 1;
+}
+
+//-------------setRateLimit-------------
+/** @~english
+* @brief Set the rate of change trigger of a channel.
+*
+* EVENT_ADC_RATE is sent once when the value changes faster than the limit and again after the rate was below the limit.
+* @param channel channel number (0-8)
+* @param rate maximum change in raw values per second, 0 disables the trigger
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt den Anstiegs-Auslöser eines Kanals.
+*
+* EVENT_ADC_RATE wird einmal gesendet, wenn sich der Wert schneller als erlaubt ändert, und erneut, nachdem die Änderung wieder unter der Grenze war.
+* @param channel Kanalnummer (0-8)
+* @param rate maximale Änderung in Rohwerten pro Sekunde, 0 schaltet den Auslöser ab
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_comparator::setRateLimit(int channel, int rate){
+	if (channel < 0 || channel >= ADC_COMPARATOR_CHANNELS || rate < 0) {
+		ErrorMessage = "invalid rate limit\n";
+		error_flag = true;
+		return -1;
+	}
+	this->rate[channel] = rate;
+	rate_exceeded[channel] = false;
+	error_flag = false;
+	return 1;
+}
+
+//-------------clear-------------
+/** @~english
+* @brief Remove window and rate limit of a channel.
+*
+* @param channel channel number (0-8)
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Entfernt Fenster und Anstiegsgrenze eines Kanals.
+*
+* @param channel Kanalnummer (0-8)
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_comparator::clear(int channel){
+	if (channel < 0 || channel >= ADC_COMPARATOR_CHANNELS)
+		return -1;
+	window[channel] = false;
+	rate[channel] = 0;
+	state[channel] = ADC_STATE_INSIDE;
+	primed[channel] = false;
+	rate_exceeded[channel] = false;
+	last_value[channel] = 0;
+	last_time[channel] = 0;
+	return 1;
+}
+
+//-------------getState-------------
+/** @~english
+* @brief Current window state of a channel.
+*
+* @param channel channel number (0-8)
+* @return ADC_STATE_BELOW (-1), ADC_STATE_INSIDE (0) or ADC_STATE_ABOVE (1)
+*
+* @~german
+* @brief Aktueller Fenster-Zustand eines Kanals.
+*
+* @param channel Kanalnummer (0-8)
+* @return ADC_STATE_BELOW (-1), ADC_STATE_INSIDE (0) oder ADC_STATE_ABOVE (1)
+*/
+int gnublin_adc_comparator::getState(int channel){
+	if (channel < 0 || channel >= ADC_COMPARATOR_CHANNELS)
+		return ADC_STATE_INSIDE;
+	return state[channel];
+}
+
+void gnublin_adc_comparator::emit(int type, const gnublin_adc_sample &sample){
+	gnublin_event event;
+
+	if (!queue)
+		return;
+	event.type = type;
+	event.device = 0;
+	event.source = sample.channel;
+	event.value = sample.value;
+	event.timestamp = sample.timestamp;
+	queue->push(event);
+}
+
+//-------------check-------------
+/** @~english
+* @brief Check a sample against window and rate limit of its channel.
+*
+* Called by gnublin_adc_sampler for every sample, can also be called directly.
+* @param sample the sample
+* @return number of events sent
+*
+* @~german
+* @brief Prüft einen Wert gegen Fenster und Anstiegsgrenze seines Kanals.
+*
+* Wird von gnublin_adc_sampler für jeden Wert aufgerufen, kann auch direkt aufgerufen werden.
+* @param sample der Wert
+* @return Anzahl der gesendeten Ereignisse
+*/
+int gnublin_adc_comparator::check(const gnublin_adc_sample &sample){
+	int c = sample.channel;
+	int v = sample.value;
+	int events = 0;
+
+	if (c < 0 || c >= ADC_COMPARATOR_CHANNELS)
+		return 0;
+
+	if (window[c]) {
+		int next = state[c];
+		if (!primed[c])
+			next = v > high[c] ? ADC_STATE_ABOVE : v < low[c] ? ADC_STATE_BELOW : ADC_STATE_INSIDE;
+		else if (v > high[c])
+			next = ADC_STATE_ABOVE;
+		else if (v < low[c])
+			next = ADC_STATE_BELOW;
+		else if (state[c] == ADC_STATE_ABOVE && v < high[c] - hysteresis[c])
+			next = ADC_STATE_INSIDE;
+		else if (state[c] == ADC_STATE_BELOW && v > low[c] + hysteresis[c])
+			next = ADC_STATE_INSIDE;
+
+		// the first sample only reports a state outside of the window
+		if (next != state[c] || (!primed[c] && next != ADC_STATE_INSIDE)) {
+			emit(next == ADC_STATE_ABOVE ? EVENT_ADC_ABOVE : next == ADC_STATE_BELOW ? EVENT_ADC_BELOW : EVENT_ADC_INSIDE, sample);
+			events++;
+		}
+		state[c] = next;
+	}
+
+	if (rate[c] && primed[c] && sample.timestamp > last_time[c]) {
+		long long delta = v - last_value[c];
+		bool exceeded;
+		if (delta < 0)
+			delta = -delta;
+		exceeded = delta * 1000000 > (long long)rate[c] * (long long)(sample.timestamp - last_time[c]);
+		if (exceeded && !rate_exceeded[c]) {
+			emit(EVENT_ADC_RATE, sample);
+			events++;
+		}
+		rate_exceeded[c] = exceeded;
+	}
+	primed[c] = true;
+	last_value[c] = v;
+	last_time[c] = sample.timestamp;
+	return events;
+}
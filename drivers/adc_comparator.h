@@ -0,0 +1,55 @@
+#include "../include/includes.h"
+#include "adc_sampler.h"
+#include "event.h"
+
+#define ADC_COMPARATOR_CHANNELS 9
+
+#define ADC_STATE_BELOW		-1
+#define ADC_STATE_INSIDE	0
+#define ADC_STATE_ABOVE		1
+
+//****************************************************************************
+// Class for threshold and window events on ADC samples
+//****************************************************************************
+/**
+* @class gnublin_adc_comparator
+* @~english
+* @brief Window comparator with hysteresis and rate of change trigger
+*
+* Attached to a gnublin_adc_sampler with setComparator(), every sample is checked in the sampling thread.
+* When a channel leaves its window (EVENT_ADC_ABOVE, EVENT_ADC_BELOW), returns into it (EVENT_ADC_INSIDE) or changes faster than allowed (EVENT_ADC_RATE), an event is pushed to the queue.
+* Thresholds are raw values. The configuration should be done before the sampler is started.
+* @~german
+* @brief Fensterkomparator mit Hysterese und Anstiegs-Auslöser
+*
+* Mit setComparator() an einen gnublin_adc_sampler gehängt, wird jeder Wert im Abtast-Thread geprüft.
+* Verlässt ein Kanal sein Fenster (EVENT_ADC_ABOVE, EVENT_ADC_BELOW), kehrt er zurück (EVENT_ADC_INSIDE) oder ändert er sich schneller als erlaubt (EVENT_ADC_RATE), wird ein Ereignis in die Warteschlange gelegt.
+* Die Schwellen sind Rohwerte. Die Einstellungen sollten vor dem Start des Samplers erfolgen.
+*/
+class gnublin_adc_comparator {
+	public:
+		gnublin_adc_comparator();
+		void setQueue(gnublin_event_queue *queue);
+		int setWindow(int channel, int low, int high, int hysteresis);
+		int setRateLimit(int channel, int rate);
+		int clear(int channel);
+		int getState(int channel);
+		int check(const gnublin_adc_sample &sample);
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		void emit(int type, const gnublin_adc_sample &sample);
+		gnublin_event_queue *queue;
+		bool window[ADC_COMPARATOR_CHANNELS];
+		int low[ADC_COMPARATOR_CHANNELS];
+		int high[ADC_COMPARATOR_CHANNELS];
+		int hysteresis[ADC_COMPARATOR_CHANNELS];
+		int rate[ADC_COMPARATOR_CHANNELS];
+		int state[ADC_COMPARATOR_CHANNELS];
+		bool primed[ADC_COMPARATOR_CHANNELS];
+		bool rate_exceeded[ADC_COMPARATOR_CHANNELS];
+		int last_value[ADC_COMPARATOR_CHANNELS];
+		unsigned long long last_time[ADC_COMPARATOR_CHANNELS];
+		bool error_flag;
+		std::string ErrorMessage;
+};
@@ -0,0 +1,475 @@
+#include "adc_filter.h"
+
+//****************************************************************************
+// Class for filtering ADC sample streams in fixed point
+//****************************************************************************
+
+/** @~english
+* @brief Creates an empty filter (no channels, no stages).
+*
+* @~german
+* @brief Erzeugt einen leeren Filter (keine Kanäle, keine Stufen).
+*/
+gnublin_adc_filter::gnublin_adc_filter(){
+	stage_count = 0;
+	channels = 0;
+	channel_count = 0;
+	extra_bits = 0;
+	work_in = 0;
+	work_out = 0;
+	work_size = 0;
+	error_flag = false;
+}
+
+/** @~english
+* @brief Frees the filter state.
+*
+* @~german
+* @brief Gibt den Filterzustand frei.
+*/
+gnublin_adc_filter::~gnublin_adc_filter(){
+	freeStages();
+	delete [] channels;
+	delete [] work_in;
+	delete [] work_out;
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_adc_filter::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_adc_filter::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+void gnublin_adc_filter::freeStages(){
+	for (int i = 0; i < stage_count; i++) {
+		delete [] stages[i].acc;
+		delete [] stages[i].count;
+		delete [] stages[i].primed;
+		delete [] stages[i].history;
+	}
+}
+
+int gnublin_adc_filter::allocStage(filter_stage *stage){
+	int history = 0;
+
+	if (stage->type == ADC_FILTER_AVERAGE || stage->type == ADC_FILTER_MEDIAN)
+		history = stage->param * channel_count;
+	stage->acc = new long long[channel_count];
+	stage->count = new int[channel_count];
+	stage->primed = new int[channel_count];
+	stage->history = history ? new int[history] : 0;
+	memset(stage->acc, 0, channel_count * sizeof(long long));
+	memset(stage->count, 0, channel_count * sizeof(int));
+	memset(stage->primed, 0, channel_count * sizeof(int));
+	if (history)
+		memset(stage->history, 0, history * sizeof(int));
+	return 1;
+}
+
+//-------------setChannels-------------
+/** @~english
+* @brief Set the channels which are filtered.
+*
+* The order defines the layout of the frames for processFrames(). Already added stages are kept, their state is reset.
+* @param channels array of channel numbers
+* @param count number of channels
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Kanäle, die gefiltert werden.
+*
+* Die Reihenfolge legt den Aufbau der Frames für processFrames() fest. Bereits hinzugefügte Stufen bleiben erhalten, ihr Zustand wird zurückgesetzt.
+* @param channels Array mit Kanalnummern
+* @param count Anzahl der Kanäle
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_filter::setChannels(const int *channels, int count){
+	if (count < 1) {
+		ErrorMessage = "channel count must be at least 1\n";
+		error_flag = true;
+		return -1;
+	}
+	freeStages();
+	delete [] this->channels;
+	delete [] work_in;
+	delete [] work_out;
+	this->channels = new int[count];
+	for (int i = 0; i < count; i++)
+		this->channels[i] = channels[i];
+	channel_count = count;
+	work_size = ADC_FILTER_CHUNK * count;
+	work_in = new int[work_size];
+	work_out = new int[work_size];
+	for (int i = 0; i < stage_count; i++)
+		allocStage(&stages[i]);
+	error_flag = false;
+	return 1;
+}
+
+//-------------addStage-------------
+/** @~english
+* @brief Append a filter stage.
+*
+* ADC_FILTER_DECIMATE: param = oversampling factor (power of two, 2-256), one output per param inputs<br>
+* ADC_FILTER_AVERAGE: param = window length (2-64)<br>
+* ADC_FILTER_MEDIAN: param = window length (odd, 3-15)<br>
+* ADC_FILTER_IIR: param = time constant k (1-15), y += (x - y) / 2^k
+* @param type type of the stage
+* @param param parameter of the stage
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Hängt eine Filterstufe an.
+*
+* ADC_FILTER_DECIMATE: param = Überabtastfaktor (Zweierpotenz, 2-256), ein Ausgangswert pro param Eingangswerte<br>
+* ADC_FILTER_AVERAGE: param = Fensterlänge (2-64)<br>
+* ADC_FILTER_MEDIAN: param = Fensterlänge (ungerade, 3-15)<br>
+* ADC_FILTER_IIR: param = Zeitkonstante k (1-15), y += (x - y) / 2^k
+* @param type Art der Stufe
+* @param param Parameter der Stufe
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_filter::addStage(int type, int param){
+	filter_stage *stage = &stages[stage_count];
+	bool valid = false;
+
+	if (stage_count == ADC_FILTER_MAX_STAGES) {
+		ErrorMessage = "too many filter stages\n";
+		error_flag = true;
+		return -1;
+	}
+	switch (type) {
+		case ADC_FILTER_DECIMATE: valid = param >= 2 && param <= 256 && (param & (param - 1)) == 0; break;
+		case ADC_FILTER_AVERAGE: valid = param >= 2 && param <= 64; break;
+		case ADC_FILTER_MEDIAN: valid = param >= 3 && param <= 15 && (param & 1); break;
+		case ADC_FILTER_IIR: valid = param >= 1 && param <= 15; break;
+	}
+	if (!valid) {
+		ErrorMessage = "invalid filter stage\n";
+		error_flag = true;
+		return -1;
+	}
+	stage->type = type;
+	stage->param = param;
+	stage->shift = param;
+	stage->reciprocal = (1LL << 32) / param;
+	if (type == ADC_FILTER_DECIMATE)
+		for (stage->shift = 0; (1 << stage->shift) < param; stage->shift++);
+	stage->acc = 0;
+	stage->count = stage->primed = stage->history = 0;
+	if (channel_count)
+		allocStage(stage);
+	stage_count++;
+	error_flag = false;
+	return 1;
+}
+
+//-------------clearStages-------------
+/** @~english
+* @brief Remove all filter stages.
+*
+* @~german
+* @brief Entfernt alle Filterstufen.
+*/
+void gnublin_adc_filter::clearStages(){
+	freeStages();
+	stage_count = 0;
+}
+
+//-------------setExtraBits-------------
+/** @~english
+* @brief Set the number of fraction bits kept in the output.
+*
+* With 0 (default) the output has the resolution of the raw values, with 2 the output is the raw value * 4 and so on.
+* @param bits 0-8
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Anzahl der Nachkommabits in der Ausgabe.
+*
+* Mit 0 (Standard) hat die Ausgabe die Auflösung der Rohwerte, mit 2 ist die Ausgabe der Rohwert * 4 usw.
+* @param bits 0-8
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_filter::setExtraBits(int bits){
+	if (bits < 0 || bits > ADC_FILTER_FRAC_BITS) {
+		ErrorMessage = "extra bits are not between 0-8\n";
+		error_flag = true;
+		return -1;
+	}
+	extra_bits = bits;
+	error_flag = false;
+	return 1;
+}
+
+//-------------reset-------------
+/** @~english
+* @brief Reset the state of all stages and channels.
+*
+* @~german
+* @brief Setzt den Zustand aller Stufen und Kanäle zurück.
+*/
+void gnublin_adc_filter::reset(){
+	if (channel_count == 0)
+		return;
+	freeStages();
+	for (int i = 0; i < stage_count; i++)
+		allocStage(&stages[i]);
+}
+
+int gnublin_adc_filter::findSlot(int channel){
+	for (int i = 0; i < channel_count; i++)
+		if (channels[i] == channel)
+			return i;
+	return -1;
+}
+
+// runs one stage over "frames" frames of "lanes" interleaved channels, starting at state slot "slot"
+int gnublin_adc_filter::runStage(filter_stage *stage, const int *in, int frames, int lanes, int slot, int *out){
+	long long *acc = stage->acc + slot;
+	int n = stage->param;
+	int stride = channel_count;
+	int o = 0;
+
+	// fill the history with the first value, so the output doesn't start at 0
+	if (stage->type != ADC_FILTER_DECIMATE && frames > 0) {
+		for (int l = 0; l < lanes; l++) {
+			if (stage->primed[slot + l])
+				continue;
+			if (stage->history)
+				for (int i = 0; i < n; i++)
+					stage->history[i * stride + slot + l] = in[l];
+			if (stage->type == ADC_FILTER_AVERAGE)
+				acc[l] = (long long)in[l] * n;
+			else if (stage->type == ADC_FILTER_IIR)
+				acc[l] = (long long)in[l] << stage->shift;
+			else
+				acc[l] = in[l];
+			stage->primed[slot + l] = 1;
+		}
+	}
+
+	switch (stage->type) {
+	case ADC_FILTER_DECIMATE: {
+		int round = 1 << (stage->shift - 1);
+		for (int f = 0; f < frames; f++) {
+			const int *x = in + f * lanes;
+			for (int l = 0; l < lanes; l++)
+				acc[l] += x[l];
+			if (++stage->count[slot] == n) {
+				int *y = out + o * lanes;
+				for (int l = 0; l < lanes; l++) {
+					y[l] = (int)((acc[l] + round) >> stage->shift);
+					acc[l] = 0;
+				}
+				stage->count[slot] = 0;
+				o++;
+			}
+		}
+		return o;
+	}
+	case ADC_FILTER_AVERAGE: {
+		long long reciprocal = stage->reciprocal;
+		for (int f = 0; f < frames; f++) {
+			const int *x = in + f * lanes;
+			int *y = out + f * lanes;
+			int *h = stage->history + stage->count[slot] * stride + slot;
+			for (int l = 0; l < lanes; l++) {
+				acc[l] += x[l] - h[l];
+				h[l] = x[l];
+				y[l] = (int)((acc[l] * reciprocal + (1LL << 31)) >> 32);
+			}
+			if (++stage->count[slot] == n)
+				stage->count[slot] = 0;
+		}
+		return frames;
+	}
+	case ADC_FILTER_MEDIAN: {
+		int window[15];
+		for (int f = 0; f < frames; f++) {
+			const int *x = in + f * lanes;
+			int *y = out + f * lanes;
+			int pos = stage->count[slot];
+			for (int l = 0; l < lanes; l++) {
+				int *h = stage->history + slot + l;
+				h[pos * stride] = x[l];
+				// insertion sort of the small window
+				for (int i = 0; i < n; i++) {
+					int v = h[i * stride];
+					int j = i;
+					for (; j > 0 && window[j - 1] > v; j--)
+						window[j] = window[j - 1];
+					window[j] = v;
+				}
+				y[l] = window[n >> 1];
+			}
+			stage->count[slot] = pos + 1 == n ? 0 : pos + 1;
+		}
+		return frames;
+	}
+	case ADC_FILTER_IIR: {
+		int k = stage->shift;
+		for (int f = 0; f < frames; f++) {
+			const int *x = in + f * lanes;
+			int *y = out + f * lanes;
+			// the sum keeps k more fraction bits, so the output reaches the input exactly
+			for (int l = 0; l < lanes; l++) {
+				acc[l] += x[l] - (acc[l] >> k);
+				y[l] = (int)(acc[l] >> k);
+			}
+		}
+		return frames;
+	}
+	}
+	return 0;
+}
+
+// converts raw values to fixed point, runs all stages chunk wise and converts back
+int gnublin_adc_filter::run(const int *in, int frames, int lanes, int slot, int *out){
+	int shift = ADC_FILTER_FRAC_BITS - extra_bits;
+	int round = shift ? 1 << (shift - 1) : 0;
+	int total = 0;
+
+	for (int done = 0; done < frames; done += ADC_FILTER_CHUNK) {
+		int n = frames - done < ADC_FILTER_CHUNK ? frames - done : ADC_FILTER_CHUNK;
+		const int *x = in + done * lanes;
+		int *a = work_in;
+		int *b = work_out;
+
+		for (int i = 0; i < n * lanes; i++)
+			a[i] = x[i] << ADC_FILTER_FRAC_BITS;
+		for (int s = 0; s < stage_count && n > 0; s++) {
+			int *t;
+			n = runStage(&stages[s], a, n, lanes, slot, b);
+			t = a; a = b; b = t;
+		}
+		int *y = out + total * lanes;
+		for (int i = 0; i < n * lanes; i++)
+			y[i] = (a[i] + round) >> shift;
+		total += n;
+	}
+	return total;
+}
+
+//-------------process-------------
+/** @~english
+* @brief Filter a block of raw values of one channel.
+*
+* @param channel channel number
+* @param in raw values
+* @param count number of raw values
+* @param out filtered values, must have room for count values
+* @return number of filtered values (less than count with decimation), -1 for an unknown channel
+*
+* @~german
+* @brief Filtert einen Block Rohwerte eines Kanals.
+*
+* @param channel Kanalnummer
+* @param in Rohwerte
+* @param count Anzahl der Rohwerte
+* @param out gefilterte Werte, muss Platz für count Werte haben
+* @return Anzahl der gefilterten Werte (mit Dezimierung weniger als count), -1 bei unbekanntem Kanal
+*/
+int gnublin_adc_filter::process(int channel, const int *in, int count, int *out){
+	int slot = findSlot(channel);
+
+	if (slot < 0) {
+		ErrorMessage = "unknown channel\n";
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return run(in, count, 1, slot, out);
+}
+
+/** @~english
+* @brief Filter samples as delivered by gnublin_adc_sampler.
+*
+* Samples of channels which are not set are dropped.
+* @param in samples
+* @param count number of samples
+* @param out filtered samples, must have room for count samples
+* @return number of filtered samples
+*
+* @~german
+* @brief Filtert Werte, wie sie gnublin_adc_sampler liefert.
+*
+* Werte von Kanälen, die nicht gesetzt sind, werden verworfen.
+* @param in Werte
+* @param count Anzahl der Werte
+* @param out gefilterte Werte, muss Platz für count Werte haben
+* @return Anzahl der gefilterten Werte
+*/
+int gnublin_adc_filter::process(const gnublin_adc_sample *in, int count, gnublin_adc_sample *out){
+	int o = 0;
+
+	for (int i = 0; i < count; i++) {
+		int slot = findSlot(in[i].channel);
+		if (slot < 0)
+			continue;
+		if (run(&in[i].value, 1, 1, slot, &out[o].value) == 1) {
+			out[o].timestamp = in[i].timestamp;
+			out[o].channel = in[i].channel;
+			o++;
+		}
+	}
+	error_flag = false;
+	return o;
+}
+
+//-------------processFrames-------------
+/** @~english
+* @brief Filter a block of frames containing one raw value of every channel.
+*
+* The values of a frame are ordered like the channel list of setChannels(). Don't mix with the per channel process() calls without reset().
+* @param in frames * channels raw values
+* @param frames number of frames
+* @param out filtered frames, must have room for frames * channels values
+* @return number of filtered frames
+*
+* @~german
+* @brief Filtert einen Block von Frames mit je einem Rohwert pro Kanal.
+*
+* Die Werte eines Frames sind wie die Kanalliste von setChannels() angeordnet. Nicht ohne reset() mit den process() Aufrufen pro Kanal mischen.
+* @param in Frames * Kanäle Rohwerte
+* @param frames Anzahl der Frames
+* @param out gefilterte Frames, muss Platz für Frames * Kanäle Werte haben
+* @return Anzahl der gefilterten Frames
+*/
+int gnublin_adc_filter::processFrames(const int *in, int frames, int *out){
+	if (channel_count == 0) {
+		ErrorMessage = "no channels set\n";
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return run(in, frames, channel_count, 0, out);
+}
@@ -0,0 +1,73 @@
+#include "../include/includes.h"
+#include "adc_sampler.h"
+
+#define ADC_FILTER_DECIMATE	1
+#define ADC_FILTER_AVERAGE	2
+#define ADC_FILTER_MEDIAN	3
+#define ADC_FILTER_IIR		4
+
+#define ADC_FILTER_MAX_STAGES	4
+#define ADC_FILTER_FRAC_BITS	8
+#define ADC_FILTER_CHUNK	256
+
+//****************************************************************************
+// Class for filtering ADC sample streams in fixed point
+//****************************************************************************
+/**
+* @class gnublin_adc_filter
+* @~english
+* @brief Fixed point filter pipeline for raw ADC samples
+*
+* Up to four stages (oversample and decimate, moving average, median of N, IIR low pass) are applied in the order they were added.
+* The filter state of all channels is kept in contiguous arrays, so a block of interleaved frames is filtered with tight loops over the channels.
+* Internally the values carry 8 fraction bits, setExtraBits() lets the output keep some of them (e.g. after oversampling).
+* @~german
+* @brief Festkomma-Filterkette für ADC Rohwerte
+*
+* Bis zu vier Stufen (Überabtastung mit Dezimierung, gleitender Mittelwert, Median aus N, IIR Tiefpass) werden in der Reihenfolge angewendet, in der sie hinzugefügt wurden.
+* Der Filterzustand aller Kanäle liegt in zusammenhängenden Arrays, so dass ein Block aus verschachtelten Frames mit kurzen Schleifen über die Kanäle gefiltert wird.
+* Intern haben die Werte 8 Nachkommabits, mit setExtraBits() kann ein Teil davon in die Ausgabe übernommen werden (z.B. nach Überabtastung).
+*/
+class gnublin_adc_filter {
+	public:
+		gnublin_adc_filter();
+		~gnublin_adc_filter();
+		int setChannels(const int *channels, int count);
+		int addStage(int type, int param);
+		void clearStages();
+		int setExtraBits(int bits);
+		void reset();
+		int process(int channel, const int *in, int count, int *out);
+		int process(const gnublin_adc_sample *in, int count, gnublin_adc_sample *out);
+		int processFrames(const int *in, int frames, int *out);
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		struct filter_stage {
+			int type;
+			int param;
+			int shift;		// decimation: log2(param), iir: time constant
+			long long reciprocal;	// average: 2^32 / param
+			long long *acc;		// per slot: decimation sum, average sum, iir output * 2^k
+			int *count;		// per slot: decimation count, history position
+			int *primed;		// per slot: history / iir output initialised
+			int *history;		// per slot: param values
+		};
+		gnublin_adc_filter(const gnublin_adc_filter &);
+		gnublin_adc_filter &operator=(const gnublin_adc_filter &);
+		void freeStages();
+		int allocStage(filter_stage *stage);
+		int findSlot(int channel);
+		int run(const int *in, int frames, int lanes, int slot, int *out);
+		int runStage(filter_stage *stage, const int *in, int frames, int lanes, int slot, int *out);
+		filter_stage stages[ADC_FILTER_MAX_STAGES];
+		int stage_count;
+		int *channels;
+		int channel_count;
+		int extra_bits;
+		int *work_in;
+		int *work_out;
+		int work_size;
+		bool error_flag;
+		std::string ErrorMessage;
+};
@@ -0,0 +1,538 @@
+#include "adc_sampler.h"
+#include "adc.h"
+#include "adc_comparator.h"
+#include "../modules/module_adc.h"
+
+//****************************************************************************
+// Class for continuous sampling of the GPAs or the GNUBLIN Module-ADC
+//****************************************************************************
+
+#if (BOARD != RASPBERRY_PI)
+/** @~english
+* @brief Create a sampler for the GPAs of the GNUBLIN board.
+*
+* Default: no channels, 100 scans per second, 1024 samples buffer.
+* @param adc the gnublin_adc which should be sampled
+*
+* @~german
+* @brief Erzeugt einen Sampler für die GPAs des GNUBLIN Boards.
+*
+* Standard: keine Kanäle, 100 Abtastungen pro Sekunde, Puffer für 1024 Werte.
+* @param adc der gnublin_adc, der abgetastet werden soll
+*/
+gnublin_adc_sampler::gnublin_adc_sampler(gnublin_adc *adc){
+	init();
+	this->adc = adc;
+}
+#endif
+
+/** @~english
+* @brief Create a sampler for the GNUBLIN Module-ADC.
+*
+* Default: no channels, 100 scans per second, 1024 samples buffer.
+* @param adc the gnublin_module_adc which should be sampled
+*
+* @~german
+* @brief Erzeugt einen Sampler für das GNUBLIN Module-ADC.
+*
+* Standard: keine Kanäle, 100 Abtastungen pro Sekunde, Puffer für 1024 Werte.
+* @param adc das gnublin_module_adc, das abgetastet werden soll
+*/
+gnublin_adc_sampler::gnublin_adc_sampler(gnublin_module_adc *adc){
+	init();
+	module_adc = adc;
+}
+
+/** @~english
+* @brief Stops the sampling thread and frees the buffer.
+*
+* @~german
+* @brief Hält den Abtast-Thread an und gibt den Puffer frei.
+*/
+gnublin_adc_sampler::~gnublin_adc_sampler(){
+	stop();
+	delete [] ring;
+	if (wakeup_fd >= 0)
+		close(wakeup_fd);
+}
+
+void gnublin_adc_sampler::init(){
+	adc = 0;
+	module_adc = 0;
+	comparator = 0;
+	channel_count = 0;
+	period_ns = 10000000;
+	ring = 0;
+	ring_mask = 0;
+	head = 0;
+	tail = 0;
+	reader_waiting = 0;
+	overruns = 0;
+	read_errors = 0;
+	run_flag = false;
+	error_flag = false;
+	memset(latest, 0, sizeof(latest));
+	memset((void *)latest_seq, 0, sizeof(latest_seq));
+	wakeup_fd = eventfd(0, 0);
+	setBufferSize(1024);
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_adc_sampler::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_adc_sampler::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------setChannels-------------
+/** @~english
+* @brief Set the channel list.
+*
+* The channels are scanned in the given order. Can only be changed while the sampler is stopped.
+* @param channels array of channel numbers (as used by getValue() of the ADC class)
+* @param count number of channels (1-8)
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Kanalliste.
+*
+* Die Kanäle werden in der angegebenen Reihenfolge abgetastet. Kann nur bei angehaltenem Sampler geändert werden.
+* @param channels Array mit Kanalnummern (wie bei getValue() der ADC Klasse)
+* @param count Anzahl der Kanäle (1-8)
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_sampler::setChannels(const int *channels, int count){
+	if (run_flag) {
+		ErrorMessage = "sampler is running\n";
+		error_flag = true;
+		return -1;
+	}
+	if (count < 1 || count > ADC_SAMPLER_MAX_CHANNELS) {
+		ErrorMessage = "channel count is not between 1-8\n";
+		error_flag = true;
+		return -1;
+	}
+	for (int i = 0; i < count; i++)
+		this->channels[i] = channels[i];
+	channel_count = count;
+	error_flag = false;
+	return 1;
+}
+
+//-------------setRate-------------
+/** @~english
+* @brief Set the scan rate.
+*
+* @param hz scans of the whole channel list per second
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Abtastrate.
+*
+* @param hz Abtastungen der ganzen Kanalliste pro Sekunde
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_sampler::setRate(int hz){
+	if (hz < 1 || hz > 100000) {
+		ErrorMessage = "rate is not between 1-100000 Hz\n";
+		error_flag = true;
+		return -1;
+	}
+	period_ns = 1000000000 / hz;
+	error_flag = false;
+	return 1;
+}
+
+//-------------setBufferSize-------------
+/** @~english
+* @brief Set the size of the ring buffer.
+*
+* The size is rounded up to the next power of two. Can only be changed while the sampler is stopped.
+* @param size number of samples
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Größe des Ringpuffers.
+*
+* Die Größe wird auf die nächste Zweierpotenz aufgerundet. Kann nur bei angehaltenem Sampler geändert werden.
+* @param size Anzahl der Werte
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_sampler::setBufferSize(int size){
+	unsigned int capacity = 2;
+
+	if (run_flag || size < 2 || size > (1 << 20)) {
+		ErrorMessage = "buffer size can't be changed\n";
+		error_flag = true;
+		return -1;
+	}
+	while (capacity < (unsigned int)size)
+		capacity <<= 1;
+	delete [] ring;
+	ring = new gnublin_adc_sample[capacity];
+	ring_mask = capacity - 1;
+	head = 0;
+	tail = 0;
+	error_flag = false;
+	return 1;
+}
+
+//-------------setComparator-------------
+/** @~english
+* @brief Attach a window comparator which checks every sample.
+*
+* Should be set before start(). NULL removes the comparator.
+* @param comparator the comparator
+*
+* @~german
+* @brief Hängt einen Fensterkomparator an, der jeden Wert prüft.
+*
+* Sollte vor start() gesetzt werden. NULL entfernt den Komparator.
+* @param comparator der Komparator
+*/
+void gnublin_adc_sampler::setComparator(gnublin_adc_comparator *comparator){
+	this->comparator = comparator;
+}
+
+//-------------start-------------
+/** @~english
+* @brief Start the sampling thread.
+*
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Startet den Abtast-Thread.
+*
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_sampler::start(){
+	if (run_flag)
+		return 1;
+	if (channel_count == 0) {
+		ErrorMessage = "no channels set\n";
+		error_flag = true;
+		return -1;
+	}
+	run_flag = true;
+	if (pthread_create(&thread, NULL, run, this) != 0) {
+		run_flag = false;
+		ErrorMessage = "could not create sampling thread\n";
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
+
+//-------------stop-------------
+/** @~english
+* @brief Stop the sampling thread.
+*
+* Samples in the buffer stay readable.
+*
+* @~german
+* @brief Hält den Abtast-Thread an.
+*
+* Werte im Puffer können weiterhin gelesen werden.
+*/
+void gnublin_adc_sampler::stop(){
+	uint64_t one = 1;
+
+	if (!run_flag)
+		return;
+	run_flag = false;
+	pthread_join(thread, NULL);
+	// wake up a reader which is blocked in read()
+	if (write(wakeup_fd, &one, sizeof(one)) < 0)
+		error_flag = true;
+}
+
+//-------------running-------------
+/** @~english
+* @brief Returns true while the sampling thread is running.
+*
+* @~german
+* @brief Gibt true zurück, solange der Abtast-Thread läuft.
+*/
+bool gnublin_adc_sampler::running(){
+	return run_flag;
+}
+
+void *gnublin_adc_sampler::run(void *arg){
+	gnublin_adc_sampler *sampler = (gnublin_adc_sampler *)arg;
+	struct timespec next;
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	while (sampler->run_flag) {
+		sampler->scan();
+		// absolute deadlines, so the rate doesn't drift with the scan time
+		next.tv_nsec += sampler->period_ns;
+		while (next.tv_nsec >= 1000000000) {
+			next.tv_nsec -= 1000000000;
+			next.tv_sec++;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+	}
+	return NULL;
+}
+
+int gnublin_adc_sampler::readChannel(int channel){
+#if (BOARD != RASPBERRY_PI)
+	if (adc)
+		return adc->getValue(channel);
+#endif
+	return module_adc->getValue(channel);
+}
+
+void gnublin_adc_sampler::scan(){
+	gnublin_adc_sample sample;
+	int values[MODULE_ADC_CHANNELS];
+	uint64_t one = 1;
+
+	// the module is read with one I2C transaction per scan, the GPAs one by one
+	if (module_adc) {
+		int mask = 0;
+		for (int i = 0; i < channel_count; i++)
+			if (channels[i] >= 1 && channels[i] <= MODULE_ADC_CHANNELS)
+				mask |= 1 << (channels[i] - 1);
+		for (int i = 0; i < MODULE_ADC_CHANNELS; i++)
+			values[i] = -1;
+		if (mask)
+			module_adc->scan(mask, values);
+		sample.timestamp = getMonotonicTime();
+	}
+
+	for (int i = 0; i < channel_count; i++) {
+		sample.channel = channels[i];
+		if (module_adc) {
+			bool valid = channels[i] >= 1 && channels[i] <= MODULE_ADC_CHANNELS;
+			sample.value = valid ? values[channels[i] - 1] : -1;
+		}
+		else {
+			sample.value = readChannel(channels[i]);
+			sample.timestamp = getMonotonicTime();
+		}
+		if (sample.value < 0) {
+			read_errors++;
+			continue;
+		}
+		latest_seq[i]++;
+		__sync_synchronize();
+		latest[i] = sample;
+		__sync_synchronize();
+		latest_seq[i]++;
+		push(sample);
+		if (comparator)
+			comparator->check(sample);
+	}
+	__sync_synchronize();
+	if (reader_waiting)
+		if (write(wakeup_fd, &one, sizeof(one)) < 0)
+			read_errors++;
+}
+
+void gnublin_adc_sampler::push(const gnublin_adc_sample &sample){
+	unsigned int h = head;
+
+	if (h - tail > ring_mask) {
+		overruns++;
+		return;
+	}
+	ring[h & ring_mask] = sample;
+	__sync_synchronize();
+	head = h + 1;
+}
+
+//-------------getLatest-------------
+/** @~english
+* @brief Get the latest sample of a channel.
+*
+* @param channel channel number
+* @param sample the latest sample is stored in it
+* @return success: 1, no sample yet or unknown channel: -1
+*
+* @~german
+* @brief Liefert den letzten Wert eines Kanals.
+*
+* @param channel Kanalnummer
+* @param sample hier wird der letzte Wert gespeichert
+* @return Erfolg: 1, noch kein Wert oder unbekannter Kanal: -1
+*/
+int gnublin_adc_sampler::getLatest(int channel, gnublin_adc_sample *sample){
+	unsigned int seq;
+
+	for (int i = 0; i < channel_count; i++) {
+		if (channels[i] != channel)
+			continue;
+		do {
+			seq = latest_seq[i];
+			__sync_synchronize();
+			*sample = latest[i];
+			__sync_synchronize();
+		} while ((seq & 1) || seq != latest_seq[i]);
+		if (seq == 0)
+			return -1;
+		return 1;
+	}
+	return -1;
+}
+
+//-------------getLatestValue-------------
+/** @~english
+* @brief Get the latest raw value of a channel.
+*
+* @param channel channel number
+* @return raw value, -1 if there is no sample yet
+*
+* @~german
+* @brief Liefert den letzten Rohwert eines Kanals.
+*
+* @param channel Kanalnummer
+* @return Rohwert, -1 falls noch kein Wert vorliegt
+*/
+int gnublin_adc_sampler::getLatestValue(int channel){
+	gnublin_adc_sample sample;
+
+	if (getLatest(channel, &sample) < 0)
+		return -1;
+	return sample.value;
+}
+
+//-------------available-------------
+/** @~english
+* @brief Number of samples waiting in the ring buffer.
+*
+* @~german
+* @brief Anzahl der Werte, die im Ringpuffer bereitliegen.
+*/
+int gnublin_adc_sampler::available(){
+	return head - tail;
+}
+
+//-------------read-------------
+/** @~english
+* @brief Read samples from the ring buffer without waiting.
+*
+* @param buffer the samples are stored in it
+* @param count maximum number of samples
+* @return number of samples read
+*
+* @~german
+* @brief Liest Werte aus dem Ringpuffer, ohne zu warten.
+*
+* @param buffer hier werden die Werte gespeichert
+* @param count maximale Anzahl an Werten
+* @return Anzahl der gelesenen Werte
+*/
+int gnublin_adc_sampler::read(gnublin_adc_sample *buffer, int count){
+	unsigned int t = tail;
+	unsigned int n = head - t;
+
+	if (count < 0)
+		return 0;
+	if (n > (unsigned int)count)
+		n = count;
+	__sync_synchronize();
+	for (unsigned int i = 0; i < n; i++)
+		buffer[i] = ring[(t + i) & ring_mask];
+	__sync_synchronize();
+	tail = t + n;
+	return n;
+}
+
+/** @~english
+* @brief Read a block of samples, wait until it is complete.
+*
+* @param buffer the samples are stored in it
+* @param count number of samples
+* @param timeout_ms maximum time to wait in ms, -1 waits forever
+* @return number of samples read, less than count at timeout
+*
+* @~german
+* @brief Liest einen Block von Werten und wartet, bis er vollständig ist.
+*
+* @param buffer hier werden die Werte gespeichert
+* @param count Anzahl der Werte
+* @param timeout_ms maximale Wartezeit in ms, -1 wartet unbegrenzt
+* @return Anzahl der gelesenen Werte, bei Zeitüberschreitung weniger als count
+*/
+int gnublin_adc_sampler::read(gnublin_adc_sample *buffer, int count, int timeout_ms){
+	unsigned long long deadline = getMonotonicTime() + (unsigned long long)timeout_ms * 1000;
+	struct pollfd pfd;
+	uint64_t events;
+	int done = 0;
+	int wait_ms = timeout_ms;
+
+	pfd.fd = wakeup_fd;
+	pfd.events = POLLIN;
+	while (done < count) {
+		done += read(buffer + done, count - done);
+		if (done == count || !run_flag)
+			break;
+		reader_waiting = 1;
+		__sync_synchronize();
+		if (available() == 0) {
+			if (timeout_ms >= 0) {
+				unsigned long long now = getMonotonicTime();
+				if (now >= deadline)
+					break;
+				wait_ms = (deadline - now + 999) / 1000;
+			}
+			if (poll(&pfd, 1, wait_ms) > 0)
+				if (::read(wakeup_fd, &events, sizeof(events)) < 0)
+					break;
+		}
+		reader_waiting = 0;
+	}
+	reader_waiting = 0;
+	return done;
+}
+
+//-------------getOverruns-------------
+/** @~english
+* @brief Number of samples dropped because the ring buffer was full.
+*
+* @~german
+* @brief Anzahl der verworfenen Werte, weil der Ringpuffer voll war.
+*/
+unsigned int gnublin_adc_sampler::getOverruns(){
+	return overruns;
+}
+
+//-------------getReadErrors-------------
+/** @~english
+* @brief Number of failed conversions since the sampler was created.
+*
+* @~german
+* @brief Anzahl fehlgeschlagener Wandlungen seit Erzeugung des Samplers.
+*/
+unsigned int gnublin_adc_sampler::getReadErrors(){
+	return read_errors;
+}
@@ -0,0 +1,90 @@
+#include "../include/includes.h"
+
+class gnublin_adc;
+class gnublin_module_adc;
+class gnublin_adc_comparator;
+
+#define ADC_SAMPLER_MAX_CHANNELS 8
+
+/**
+* @struct gnublin_adc_sample
+* @~english
+* @brief One timestamped raw ADC sample
+*
+* @~german
+* @brief Ein ADC Rohwert mit Zeitstempel
+*/
+struct gnublin_adc_sample {
+	unsigned long long timestamp; // µs, CLOCK_MONOTONIC
+	int channel;
+	int value;
+};
+
+//****************************************************************************
+// Class for continuous sampling of the GPAs or the GNUBLIN Module-ADC
+//****************************************************************************
+/**
+* @class gnublin_adc_sampler
+* @~english
+* @brief Background sampler for gnublin_adc and gnublin_module_adc
+*
+* A thread scans the configured channel list at a fixed rate and stores timestamped raw samples in a lock-free single-producer/single-consumer ring buffer.
+* @~german
+* @brief Hintergrund-Abtastung für gnublin_adc und gnublin_module_adc
+*
+* Ein Thread tastet die eingestellten Kanäle mit fester Rate ab und legt die Rohwerte mit Zeitstempel in einem lock-freien Ringpuffer (ein Erzeuger, ein Verbraucher) ab.
+*/
+class gnublin_adc_sampler {
+	public:
+#if (BOARD != RASPBERRY_PI)
+		gnublin_adc_sampler(gnublin_adc *adc);
+#endif
+		gnublin_adc_sampler(gnublin_module_adc *adc);
+		~gnublin_adc_sampler();
+		int setChannels(const int *channels, int count);
+		int setRate(int hz);
+		int setBufferSize(int size);
+		void setComparator(gnublin_adc_comparator *comparator);
+		int start();
+		void stop();
+		bool running();
+		int getLatest(int channel, gnublin_adc_sample *sample);
+		int getLatestValue(int channel);
+		int available();
+		int read(gnublin_adc_sample *buffer, int count);
+		int read(gnublin_adc_sample *buffer, int count, int timeout_ms);
+		unsigned int getOverruns();
+		unsigned int getReadErrors();
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		gnublin_adc_sampler(const gnublin_adc_sampler &);
+		gnublin_adc_sampler &operator=(const gnublin_adc_sampler &);
+		void init();
+		static void *run(void *arg);
+		void scan();
+		int readChannel(int channel);
+		void push(const gnublin_adc_sample &sample);
+		gnublin_adc *adc;
+		gnublin_module_adc *module_adc;
+		gnublin_adc_comparator *comparator;
+		int channels[ADC_SAMPLER_MAX_CHANNELS];
+		int channel_count;
+		int period_ns;
+		// ring buffer, head is only written by the sampling thread, tail only by the reader
+		gnublin_adc_sample *ring;
+		unsigned int ring_mask;
+		volatile unsigned int head;
+		volatile unsigned int tail;
+		volatile int reader_waiting;
+		int wakeup_fd;
+		// latest value per channel slot, guarded by a sequence counter
+		gnublin_adc_sample latest[ADC_SAMPLER_MAX_CHANNELS];
+		volatile unsigned int latest_seq[ADC_SAMPLER_MAX_CHANNELS];
+		volatile unsigned int overruns;
+		volatile unsigned int read_errors;
+		volatile bool run_flag;
+		pthread_t thread;
+		bool error_flag;
+		std::string ErrorMessage;
+};
@@ -0,0 +1,197 @@
+#include "event.h"
+
+//****************************************************************************
+// Class for delivering events from background threads
+//****************************************************************************
+
+/** @~english
+* @brief Creates a queue for 64 events.
+*
+* @~german
+* @brief Erzeugt eine Warteschlange für 64 Ereignisse.
+*/
+gnublin_event_queue::gnublin_event_queue(){
+	init(64);
+}
+
+/** @~english
+* @brief Creates a queue for the given number of events.
+*
+* @param size maximum number of queued events
+*
+* @~german
+* @brief Erzeugt eine Warteschlange für die angegebene Anzahl an Ereignissen.
+*
+* @param size maximale Anzahl eingereihter Ereignisse
+*/
+gnublin_event_queue::gnublin_event_queue(int size){
+	init(size > 0 ? size : 1);
+}
+
+gnublin_event_queue::~gnublin_event_queue(){
+	pthread_cond_destroy(&cond);
+	pthread_mutex_destroy(&mutex);
+	delete [] events;
+}
+
+void gnublin_event_queue::init(int size){
+	pthread_condattr_t attr;
+
+	this->size = size;
+	events = new gnublin_event[size];
+	first = 0;
+	count = 0;
+	dropped = 0;
+	callback = 0;
+	callback_arg = 0;
+	pthread_mutex_init(&mutex, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&cond, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+//-------------setCallback-------------
+/** @~english
+* @brief Set a callback which receives the events instead of the queue.
+*
+* The callback is called from the thread which detected the event, it should return quickly. NULL switches back to queueing.
+* @param callback function which is called for every event
+* @param arg user pointer passed to the callback
+*
+* @~german
+* @brief Setzt einen Callback, der die Ereignisse anstelle der Warteschlange erhält.
+*
+* Der Callback wird aus dem Thread aufgerufen, der das Ereignis erkannt hat, er sollte schnell zurückkehren. Mit NULL werden die Ereignisse wieder eingereiht.
+* @param callback Funktion, die für jedes Ereignis aufgerufen wird
+* @param arg Benutzerzeiger, der an den Callback übergeben wird
+*/
+void gnublin_event_queue::setCallback(gnublin_event_callback callback, void *arg){
+	pthread_mutex_lock(&mutex);
+	this->callback = callback;
+	callback_arg = arg;
+	pthread_mutex_unlock(&mutex);
+}
+
+//-------------push-------------
+/** @~english
+* @brief Deliver an event.
+*
+* @param event the event
+* @return success: 1, queue full (event dropped): -1
+*
+* @~german
+* @brief Liefert ein Ereignis aus.
+*
+* @param event das Ereignis
+* @return Erfolg: 1, Warteschlange voll (Ereignis verworfen): -1
+*/
+int gnublin_event_queue::push(const gnublin_event &event){
+	gnublin_event_callback cb;
+	void *arg;
+
+	pthread_mutex_lock(&mutex);
+	cb = callback;
+	arg = callback_arg;
+	if (!cb) {
+		if (count == size) {
+			dropped++;
+			pthread_mutex_unlock(&mutex);
+			return -1;
+		}
+		events[(first + count) % size] = event;
+		count++;
+		pthread_cond_signal(&cond);
+	}
+	pthread_mutex_unlock(&mutex);
+	if (cb)
+		cb(&event, arg);
+	return 1;
+}
+
+//-------------wait-------------
+/** @~english
+* @brief Wait for the next event.
+*
+* @param event the event is stored in it
+* @param timeout_ms maximum time to wait in ms, -1 waits forever
+* @return event received: 1, timeout: 0
+*
+* @~german
+* @brief Wartet auf das nächste Ereignis.
+*
+* @param event hier wird das Ereignis gespeichert
+* @param timeout_ms maximale Wartezeit in ms, -1 wartet unbegrenzt
+* @return Ereignis erhalten: 1, Zeitüberschreitung: 0
+*/
+int gnublin_event_queue::wait(gnublin_event *event, int timeout_ms){
+	struct timespec deadline;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += timeout_ms / 1000;
+	deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000) {
+		deadline.tv_nsec -= 1000000000;
+		deadline.tv_sec++;
+	}
+	pthread_mutex_lock(&mutex);
+	while (count == 0) {
+		if (timeout_ms < 0)
+			pthread_cond_wait(&cond, &mutex);
+		else if (pthread_cond_timedwait(&cond, &mutex, &deadline) == ETIMEDOUT)
+			break;
+	}
+	if (count == 0) {
+		pthread_mutex_unlock(&mutex);
+		return 0;
+	}
+	*event = events[first];
+	first = (first + 1) % size;
+	count--;
+	pthread_mutex_unlock(&mutex);
+	return 1;
+}
+
+//-------------poll-------------
+/** @~english
+* @brief Fetch the next event without waiting.
+*
+* @param event the event is stored in it
+* @return event received: 1, queue empty: 0
+*
+* @~german
+* @brief Holt das nächste Ereignis ab, ohne zu warten.
+*
+* @param event hier wird das Ereignis gespeichert
+* @return Ereignis erhalten: 1, Warteschlange leer: 0
+*/
+int gnublin_event_queue::poll(gnublin_event *event){
+	return wait(event, 0);
+}
+
+//-------------pending-------------
+/** @~english
+* @brief Number of queued events.
+*
+* @~german
+* @brief Anzahl der eingereihten Ereignisse.
+*/
+int gnublin_event_queue::pending(){
+	int n;
+
+	pthread_mutex_lock(&mutex);
+	n = count;
+	pthread_mutex_unlock(&mutex);
+	return n;
+}
+
+//-------------getDropped-------------
+/** @~english
+* @brief Number of events dropped because the queue was full.
+*
+* @~german
+* @brief Anzahl der verworfenen Ereignisse, weil die Warteschlange voll war.
+*/
+unsigned int gnublin_event_queue::getDropped(){
+	return dropped;
+}
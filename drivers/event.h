@@ -0,0 +1,70 @@
+#include "../include/includes.h"
+
+//event types
+#define EVENT_GPIO_EDGE		1
+#define EVENT_ADC_ABOVE		2
+#define EVENT_ADC_BELOW		3
+#define EVENT_ADC_INSIDE	4
+#define EVENT_ADC_RATE		5
+#define EVENT_TEMP_ALARM	6
+#define EVENT_TEMP_CLEAR	7
+#define EVENT_PIN_CHANGE	8
+#define EVENT_MOTION_DONE	9
+
+/**
+* @struct gnublin_event
+* @~english
+* @brief An event as delivered by gnublin_event_queue
+*
+* @~german
+* @brief Ein Ereignis, wie es von gnublin_event_queue geliefert wird
+*/
+struct gnublin_event {
+	int type;			// EVENT_*
+	int device;			// e.g. I2C address of the sending module, 0 for onboard sources
+	int source;			// pin or channel number
+	int value;			// new level or sample value
+	unsigned long long timestamp;	// µs, CLOCK_MONOTONIC
+};
+
+typedef void (*gnublin_event_callback)(const gnublin_event *event, void *arg);
+
+//****************************************************************************
+// Class for delivering events from background threads
+//****************************************************************************
+/**
+* @class gnublin_event_queue
+* @~english
+* @brief Thread safe queue for events (GPIO edges, ADC comparator, ...)
+*
+* Events are either queued and fetched with wait()/poll(), or, if a callback is set, passed to the callback directly from the thread which detected the event.
+* @~german
+* @brief Threadsichere Warteschlange für Ereignisse (GPIO Flanken, ADC Komparator, ...)
+*
+* Ereignisse werden entweder eingereiht und mit wait()/poll() abgeholt oder, falls ein Callback gesetzt ist, direkt aus dem Thread, der das Ereignis erkannt hat, an den Callback übergeben.
+*/
+class gnublin_event_queue {
+	public:
+		gnublin_event_queue();
+		gnublin_event_queue(int size);
+		~gnublin_event_queue();
+		void setCallback(gnublin_event_callback callback, void *arg);
+		int push(const gnublin_event &event);
+		int wait(gnublin_event *event, int timeout_ms);
+		int poll(gnublin_event *event);
+		int pending();
+		unsigned int getDropped();
+	private:
+		gnublin_event_queue(const gnublin_event_queue &);
+		gnublin_event_queue &operator=(const gnublin_event_queue &);
+		void init(int size);
+		gnublin_event *events;
+		int size;
+		int first;
+		int count;
+		unsigned int dropped;
+		gnublin_event_callback callback;
+		void *callback_arg;
+		pthread_mutex_t mutex;
+		pthread_cond_t cond;
+};
@@ -0,0 +1,246 @@
+#include "gpio_edge.h"
+
+//****************************************************************************
+// Class for waiting on GPIO edges
+//****************************************************************************
+
+/** @~english
+* @brief Reset the ErrorFlag. The thread is started with the first watch().
+*
+* @~german
+* @brief Setzt das ErrorFlag zurück. Der Thread wird mit dem ersten watch() gestartet.
+*/
+gnublin_gpio_edge::gnublin_gpio_edge(){
+	count = 0;
+	wakeup_fd = eventfd(0, 0);
+	run_flag = false;
+	error_flag = false;
+	pthread_mutex_init(&mutex, NULL);
+}
+
+/** @~english
+* @brief Stops the thread and closes the value files.
+*
+* @~german
+* @brief Hält den Thread an und schließt die value Dateien.
+*/
+gnublin_gpio_edge::~gnublin_gpio_edge(){
+	if (run_flag) {
+		run_flag = false;
+		wakeup();
+		pthread_join(thread, NULL);
+	}
+	for (int i = 0; i < count; i++)
+		close(fds[i]);
+	close(wakeup_fd);
+	pthread_mutex_destroy(&mutex);
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_gpio_edge::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_gpio_edge::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+void gnublin_gpio_edge::wakeup(){
+	uint64_t one = 1;
+
+	if (write(wakeup_fd, &one, sizeof(one)) < 0)
+		error_flag = true;
+}
+
+//-------------watch-------------
+/** @~english
+* @brief Watch a pin for edges.
+*
+* The pin is exported and set as input.
+* @param pin GPIO pin number
+* @param edge "rising", "falling" or "both"
+* @param queue the events of this pin are delivered to it
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Überwacht einen Pin auf Flanken.
+*
+* Der Pin wird exportiert und als Eingang gesetzt.
+* @param pin GPIO Pin Nummer
+* @param edge "rising", "falling" oder "both"
+* @param queue hierhin werden die Ereignisse dieses Pins geliefert
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_gpio_edge::watch(int pin, std::string edge, gnublin_event_queue *queue){
+	std::string dir = "/sys/class/gpio/gpio" + numberToString(pin);
+	char value;
+	int fd;
+
+	if (edge != "rising" && edge != "falling" && edge != "both") {
+		ErrorMessage = "edge != rising/falling/both\n";
+		error_flag = true;
+		return -1;
+	}
+	unwatch(pin);
+	if (count == GPIO_EDGE_MAX_PINS) {
+		ErrorMessage = "too many pins watched\n";
+		error_flag = true;
+		return -1;
+	}
+
+	// exporting fails if the pin is already exported, that's fine
+	std::ofstream file("/sys/class/gpio/export");
+	file << pin;
+	file.close();
+	file.clear();
+	file.open((dir + "/direction").c_str());
+	file << "in";
+	file.close();
+	file.clear();
+	file.open((dir + "/edge").c_str());
+	file << edge;
+	file.close();
+	if (file.fail() || (fd = open((dir + "/value").c_str(), O_RDONLY)) < 0) {
+		ErrorMessage = "ERROR setting up edge on gpio" + numberToString(pin) + "\n";
+		error_flag = true;
+		return -1;
+	}
+	// the first read clears the pending state
+	if (read(fd, &value, 1) < 0)
+		value = 0;
+
+	pthread_mutex_lock(&mutex);
+	pins[count] = pin;
+	fds[count] = fd;
+	queues[count] = queue;
+	count++;
+	pthread_mutex_unlock(&mutex);
+
+	if (!run_flag) {
+		run_flag = true;
+		if (pthread_create(&thread, NULL, run, this) != 0) {
+			run_flag = false;
+			ErrorMessage = "could not create edge thread\n";
+			error_flag = true;
+			return -1;
+		}
+	}
+	else
+		wakeup();
+	error_flag = false;
+	return 1;
+}
+
+//-------------unwatch-------------
+/** @~english
+* @brief Stop watching a pin.
+*
+* @param pin GPIO pin number
+* @return success: 1, pin wasn't watched: -1
+*
+* @~german
+* @brief Beendet die Überwachung eines Pins.
+*
+* @param pin GPIO Pin Nummer
+* @return Erfolg: 1, Pin wurde nicht überwacht: -1
+*/
+int gnublin_gpio_edge::unwatch(int pin){
+	int result = -1;
+
+	pthread_mutex_lock(&mutex);
+	for (int i = 0; i < count; i++) {
+		if (pins[i] != pin)
+			continue;
+		close(fds[i]);
+		count--;
+		pins[i] = pins[count];
+		fds[i] = fds[count];
+		queues[i] = queues[count];
+		result = 1;
+		break;
+	}
+	pthread_mutex_unlock(&mutex);
+	if (result > 0 && run_flag)
+		wakeup();
+	return result;
+}
+
+void *gnublin_gpio_edge::run(void *arg){
+	gnublin_gpio_edge *self = (gnublin_gpio_edge *)arg;
+	struct pollfd pfd[GPIO_EDGE_MAX_PINS + 1];
+	gnublin_event events[GPIO_EDGE_MAX_PINS];
+	gnublin_event_queue *targets[GPIO_EDGE_MAX_PINS];
+	uint64_t counter;
+	int n;
+
+	while (self->run_flag) {
+		pthread_mutex_lock(&self->mutex);
+		n = self->count;
+		for (int i = 0; i < n; i++) {
+			pfd[i].fd = self->fds[i];
+			pfd[i].events = POLLPRI | POLLERR;
+			pfd[i].revents = 0;
+		}
+		pthread_mutex_unlock(&self->mutex);
+		pfd[n].fd = self->wakeup_fd;
+		pfd[n].events = POLLIN;
+		pfd[n].revents = 0;
+
+		if (poll(pfd, n + 1, -1) <= 0)
+			continue;
+		if (pfd[n].revents & POLLIN) {
+			// the pin list changed, the fds of this round may be stale
+			if (read(self->wakeup_fd, &counter, sizeof(counter)) < 0)
+				self->error_flag = true;
+			continue;
+		}
+
+		int found = 0;
+		unsigned long long now = getMonotonicTime();
+		pthread_mutex_lock(&self->mutex);
+		for (int i = 0; i < n && i < self->count; i++) {
+			char value;
+			if (!(pfd[i].revents & (POLLPRI | POLLERR)) || self->fds[i] != pfd[i].fd)
+				continue;
+			if (pread(pfd[i].fd, &value, 1, 0) != 1)
+				continue;
+			events[found].type = EVENT_GPIO_EDGE;
+			events[found].device = 0;
+			events[found].source = self->pins[i];
+			events[found].value = value == '1';
+			events[found].timestamp = now;
+			targets[found] = self->queues[i];
+			found++;
+		}
+		pthread_mutex_unlock(&self->mutex);
+		// delivered without the lock, a callback may call watch()/unwatch()
+		for (int i = 0; i < found; i++)
+			targets[i]->push(events[i]);
+	}
+	return NULL;
+}
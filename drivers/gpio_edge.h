@@ -0,0 +1,45 @@
+#include "../include/includes.h"
+#include "event.h"
+
+#define GPIO_EDGE_MAX_PINS 16
+
+//****************************************************************************
+// Class for waiting on GPIO edges
+//****************************************************************************
+/**
+* @class gnublin_gpio_edge
+* @~english
+* @brief Delivers GPIO edges as events
+*
+* One thread waits on the sysfs value files of all watched pins (poll() on POLLPRI), so no CPU time and no bus traffic is spent while nothing happens.
+* Every edge is delivered as EVENT_GPIO_EDGE to the gnublin_event_queue of the pin.
+* @~german
+* @brief Liefert GPIO Flanken als Ereignisse
+*
+* Ein Thread wartet auf die sysfs value Dateien aller überwachten Pins (poll() auf POLLPRI), solange nichts passiert wird also weder Rechenzeit noch Bus-Verkehr benötigt.
+* Jede Flanke wird als EVENT_GPIO_EDGE an die gnublin_event_queue des Pins geliefert.
+*/
+class gnublin_gpio_edge {
+	public:
+		gnublin_gpio_edge();
+		~gnublin_gpio_edge();
+		int watch(int pin, std::string edge, gnublin_event_queue *queue);
+		int unwatch(int pin);
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		gnublin_gpio_edge(const gnublin_gpio_edge &);
+		gnublin_gpio_edge &operator=(const gnublin_gpio_edge &);
+		static void *run(void *arg);
+		void wakeup();
+		int pins[GPIO_EDGE_MAX_PINS];
+		int fds[GPIO_EDGE_MAX_PINS];
+		gnublin_event_queue *queues[GPIO_EDGE_MAX_PINS];
+		int count;
+		int wakeup_fd;
+		pthread_mutex_t mutex;
+		pthread_t thread;
+		volatile bool run_flag;
+		bool error_flag;
+		std::string ErrorMessage;
+};
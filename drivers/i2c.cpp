@@ -16,6 +16,7 @@ gnublin_i2c::gnublin_i2c()
 {
 	devicefile="/dev/i2c-1";
 	error_flag=false;
+	transactions=0;
 }
 
 //-------------------------------Fail-------------------------------
@@ -127,6 +128,7 @@ void gnublin_i2c::setDevicefile(std::string filename){
 */
 int gnublin_i2c::receive(unsigned char *RxBuf, int length){
 	error_flag=false;
+	transactions++;
 	int fd;
 
 
@@ -188,6 +190,7 @@ int gnublin_i2c::receive(unsigned char *RxBuf, int length){
 */
 int gnublin_i2c::receive(unsigned char RegisterAddress, unsigned char *RxBuf, int length){
 	error_flag=false;	
+	transactions++;
 	int fd;
 
 	if ((fd = open(devicefile.c_str(), O_RDWR)) < 0) {
@@ -248,6 +251,7 @@ int gnublin_i2c::receive(unsigned char RegisterAddress, unsigned char *RxBuf, in
 */
 int gnublin_i2c::send(unsigned char *TxBuf, int length){
 	error_flag=false;	
+	transactions++;
 	int fd; 
 
 	if ((fd = open(devicefile.c_str(), O_RDWR)) < 0) {
@@ -308,6 +312,7 @@ int gnublin_i2c::send(unsigned char *TxBuf, int length){
 */
 int gnublin_i2c::send(unsigned char RegisterAddress, unsigned char *TxBuf, int length){
 	error_flag=false;	
+	transactions++;
 	int fd, i;
 	unsigned char data[length+1];
 	data[0]=RegisterAddress;
@@ -365,6 +370,7 @@ int gnublin_i2c::send(unsigned char RegisterAddress, unsigned char *TxBuf, int l
 */
 int gnublin_i2c::send(int value){
 	error_flag=false;
+	transactions++;
 	int buffer[1];
 	buffer[0]=value;	
 	int fd; 
@@ -393,3 +399,80 @@ int gnublin_i2c::send(int value){
 	close(fd);	
 	return 1;
 }
+
+//----------------------------------transfer----------------------------------
+/** @~english 
+* @brief execute several messages as one combined I2C transaction.
+*
+* All messages are passed to the kernel with one I2C_RDWR ioctl, so they are separated by repeated starts instead of stop conditions and the bus is not released in between.
+* The slave address of every message is taken from msgs[i].addr, so one transaction can address several devices on the bus.<br>
+* e.g.<br>
+* write the register pointer 0x00 and read 2 bytes back<br>
+* unsigned char reg = 0x00, buf[2];<br>
+* struct i2c_msg msgs[2] = {{0x48, 0, 1, &reg}, {0x48, I2C_M_RD, 2, buf}};<br>
+* transfer(msgs, 2);
+* @param msgs array of messages
+* @param count number of messages (1-42)
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief führt mehrere Nachrichten als eine kombinierte I2C Transaktion aus.
+*
+* Alle Nachrichten werden mit einem I2C_RDWR ioctl an den Kernel übergeben, sie werden also durch Repeated Starts statt Stop Bedingungen getrennt und der Bus wird dazwischen nicht freigegeben.
+* Die Slave Adresse jeder Nachricht wird aus msgs[i].addr genommen, so kann eine Transaktion mehrere Geräte am Bus ansprechen.<br>
+* Beispiel:<br>
+* Registerzeiger 0x00 schreiben und 2 Bytes zurücklesen<br>
+* unsigned char reg = 0x00, buf[2];<br>
+* struct i2c_msg msgs[2] = {{0x48, 0, 1, &reg}, {0x48, I2C_M_RD, 2, buf}};<br>
+* transfer(msgs, 2);
+* @param msgs Array von Nachrichten
+* @param count Anzahl der Nachrichten (1-42)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_i2c::transfer(struct i2c_msg *msgs, int count){
+	error_flag=false;
+	transactions++;
+	struct i2c_rdwr_ioctl_data data;
+	int fd;
+
+	if (count < 1 || count > I2C_TRANSFER_MAX_MSGS) {
+		ErrorMessage="message count is not between 1-42\n";
+		error_flag=true;
+		return -1;
+	}
+
+	if ((fd = open(devicefile.c_str(), O_RDWR)) < 0) {
+		ErrorMessage="ERROR opening: " + devicefile + "\n";
+		error_flag=true;
+		return -1;
+	}
+
+	data.msgs = msgs;
+	data.nmsgs = count;
+	if (ioctl(fd, I2C_RDWR, &data) != count) {
+		ErrorMessage="i2c transfer error! dev file: " + devicefile + "\n";
+		error_flag=true;
+		close(fd);
+		return -1;
+	}
+
+	close(fd);
+	return 1;
+}
+
+//----------------------------------getTransactions----------------------------------
+/** @~english 
+* @brief returns the number of bus transactions.
+*
+* Every call of send(), receive() and transfer() counts as one transaction, also if it fails.
+* @return number of transactions since the object was created
+*
+* @~german 
+* @brief gibt die Anzahl der Bus Transaktionen zurück.
+*
+* Jeder Aufruf von send(), receive() und transfer() zählt als eine Transaktion, auch wenn er fehlschlägt.
+* @return Anzahl der Transaktionen seit der Erzeugung des Objekts
+*/
+unsigned int gnublin_i2c::getTransactions(){
+	return transactions;
+}
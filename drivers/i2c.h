@@ -1,4 +1,6 @@
 #include "../include/includes.h"
+
+#define I2C_TRANSFER_MAX_MSGS 42
 //*******************************************************************
 //Class for accessing GNUBLIN i2c Bus
 //*******************************************************************
@@ -19,6 +21,7 @@ class gnublin_i2c {
 	int slave_address;
 	std::string devicefile;
 	std::string ErrorMessage;
+	unsigned int transactions;
 public:
 	gnublin_i2c();
 	bool fail();
@@ -31,4 +34,6 @@ public:
 	int send(unsigned char *TxBuf, int length);
 	int send(unsigned char RegisterAddress, unsigned char *TxBuf, int length);
 	int send(int value);
+	int transfer(struct i2c_msg *msgs, int count);
+	unsigned int getTransactions();
 };
@@ -0,0 +1,86 @@
+#include "gnublin.h"
+
+// Compares the old iostream based ADC read path with the persistent fd path
+// of gnublin_adc. Without arguments a simulated device node is used, so the
+// benchmark also runs on a host without the lpc313x_adc driver. It is a plain
+// file, so the channel select writes into it: its sample is the channel
+// number, which the select leaves intact, and both paths must read it.
+//
+// usage: adc_benchmark [devicefile] [seconds]
+
+static double now(){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#define SIMULATED_PIN 1
+
+static void resetSimulation(const char *device){
+	std::ofstream file(device);
+	file << SIMULATED_PIN << "\n";
+	file.close();
+}
+
+// the read path as it was implemented before: ofstream, ifstream, stringstream
+static int legacyGetValue(const char *device, int pin){
+	std::string value;
+	std::ofstream file(device);
+	file << numberToString(pin);
+	file.close();
+	std::ifstream dev_file(device);
+	dev_file >> value;
+	dev_file.close();
+	return hexstringToNumber(value);
+}
+
+int main(int argc, char **argv){
+	const char *device = "/tmp/gnublin_adc_sim";
+	bool simulated = true;
+	double seconds = 2;
+	double start, elapsed;
+	long samples;
+	int value;
+
+	if (argc > 1) {
+		device = argv[1];
+		simulated = false;
+	}
+	if (argc > 2)
+		seconds = atof(argv[2]);
+
+	if (simulated)
+		resetSimulation(device);
+	samples = 0;
+	start = now();
+	do {
+		value = legacyGetValue(device, SIMULATED_PIN);
+		samples++;
+	} while ((elapsed = now() - start) < seconds);
+	if (simulated && value != SIMULATED_PIN) {
+		printf("iostream path read %d instead of %d\n", value, SIMULATED_PIN);
+		return 1;
+	}
+	printf("iostream path:      %10.0f samples/s\n", samples / elapsed);
+
+	if (simulated)
+		resetSimulation(device);
+	gnublin_adc ad;
+	ad.setDevicefile(device);
+	samples = 0;
+	start = now();
+	do {
+		value = ad.getValue(SIMULATED_PIN);
+		samples++;
+	} while ((elapsed = now() - start) < seconds);
+	if (ad.fail()) {
+		printf("%s", ad.getErrorMessage());
+		return 1;
+	}
+	if (simulated && value != SIMULATED_PIN) {
+		printf("persistent fd path read %d instead of %d\n", value, SIMULATED_PIN);
+		return 1;
+	}
+	printf("persistent fd path: %10.0f samples/s\n", samples / elapsed);
+	return 0;
+}
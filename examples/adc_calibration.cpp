@@ -0,0 +1,91 @@
+#include "gnublin.h"
+
+// Checks the fixed point conversion of gnublin_adc_calibration against a
+// golden table and against exact integer rounding for random calibrations
+// over all raw values of the GPAs (full scale 1024) and the Module-ADC
+// (full scale 255). Runs on a host, exits with 1 on the first mismatch.
+//
+// usage: adc_calibration
+
+struct golden {
+	int full_scale, offset, gain_ppm, reference, raw, mv;
+};
+
+// mV = round half up((raw + offset) * gain_ppm * reference / (full_scale * 10^6)), raw + offset below 0 counts as 0
+static const golden table[] = {
+	{ 1024, 0, 1000000, 3300, 0, 0 },
+	{ 1024, 0, 1000000, 3300, 1, 3 },
+	{ 1024, 0, 1000000, 3300, 128, 413 },	// 412.5
+	{ 1024, 0, 1000000, 3300, 512, 1650 },
+	{ 1024, 0, 1000000, 3300, 1023, 3297 },
+	{ 1024, -2, 1003100, 3300, 1, 0 },
+	{ 1024, -2, 1003100, 3300, 3, 3 },
+	{ 1024, -2, 1003100, 3300, 700, 2256 },
+	{ 1024, -2, 1003100, 3300, 1023, 3301 },
+	{ 1024, 5, 999000, 2500, 0, 12 },
+	{ 1024, 5, 999000, 2500, 511, 1259 },
+	{ 1024, 5, 999000, 2500, 1023, 2507 },
+	{ 255, 0, 1000000, 2500, 1, 10 },
+	{ 255, 0, 1000000, 2500, 128, 1255 },
+	{ 255, 0, 1000000, 2500, 255, 2500 },
+	{ 256, 3, 1500000, 5000, 0, 88 },
+	{ 256, 3, 1500000, 5000, 100, 3018 },
+	{ 256, 3, 1500000, 5000, 255, 7559 },
+	{ 1000, 0, 1000000, 1, 499, 0 },
+	{ 1000, 0, 1000000, 1, 500, 1 },	// 0.5
+	{ 1000, 0, 1000000, 1, 999, 1 },
+};
+
+// exact result with 64 bit integers: (raw + offset) * gain * reference < 2^63
+static int exact(int full_scale, int offset, int gain_ppm, int reference, int raw){
+	long long x = raw + offset < 0 ? 0 : raw + offset;
+	long long n = x * gain_ppm * reference;
+	long long d = (long long)full_scale * 1000000;
+	return (int)((2 * n + d) / (2 * d));
+}
+
+int main(){
+	int count = sizeof(table) / sizeof(table[0]);
+	int raw[1024], mv[1024];
+	long checked = 0;
+
+	for (int i = 0; i < count; i++) {
+		const golden *g = &table[i];
+		gnublin_adc_calibration calibration(g->full_scale, g->reference);
+		int result;
+
+		calibration.setChannel(0, g->offset, g->gain_ppm, g->reference);
+		result = calibration.toMillivolt(0, g->raw);
+		if (result != g->mv) {
+			printf("golden table line %d: raw %d gives %d mV instead of %d mV\n", i, g->raw, result, g->mv);
+			return 1;
+		}
+		checked++;
+	}
+
+	for (int i = 0; i < 1024; i++)
+		raw[i] = i;
+	srand(1);
+	for (int set = 0; set < 2000; set++) {
+		int full_scale = set & 1 ? 1024 : 255;
+		int offset = rand() % 511 - 255;
+		int gain_ppm = 1 + rand() % 2000000;
+		int reference = 1 + rand() % 5000;
+		gnublin_adc_calibration calibration(full_scale, reference);
+
+		calibration.setChannel(set % ADC_CALIBRATION_CHANNELS, offset, gain_ppm, reference);
+		calibration.toMillivolt(set % ADC_CALIBRATION_CHANNELS, raw, full_scale, mv);
+		for (int i = 0; i < full_scale; i++) {
+			int expected = exact(full_scale, offset, gain_ppm, reference, i);
+
+			if (mv[i] != expected) {
+				printf("full scale %d, offset %d, gain %d ppm, reference %d mV: raw %d gives %d mV instead of %d mV\n",
+				       full_scale, offset, gain_ppm, reference, i, mv[i], expected);
+				return 1;
+			}
+		}
+		checked += full_scale;
+	}
+	printf("%ld conversions exact\n", checked);
+	return 0;
+}
@@ -0,0 +1,29 @@
+#include "gnublin.h"
+
+// sleeps until GPA1 leaves the window 100-800 (raw) or jumps faster than 500 LSB/s
+int main(){
+	gnublin_adc adc;
+	gnublin_adc_sampler sampler(&adc);
+	gnublin_adc_comparator comparator;
+	gnublin_event_queue queue;
+	gnublin_event event;
+	int channel = 1;
+
+	comparator.setWindow(1, 100, 800, 20);
+	comparator.setRateLimit(1, 500);
+	comparator.setQueue(&queue);
+	sampler.setChannels(&channel, 1);
+	sampler.setRate(20);
+	sampler.setComparator(&comparator);
+	sampler.start();
+
+	while(1){
+		queue.wait(&event, -1);
+		switch (event.type) {
+			case EVENT_ADC_ABOVE: printf("GPA%i above: %i\n", event.source, event.value); break;
+			case EVENT_ADC_BELOW: printf("GPA%i below: %i\n", event.source, event.value); break;
+			case EVENT_ADC_INSIDE: printf("GPA%i back inside: %i\n", event.source, event.value); break;
+			case EVENT_ADC_RATE: printf("GPA%i changes too fast: %i\n", event.source, event.value); break;
+		}
+	}
+}
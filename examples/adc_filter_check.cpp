@@ -0,0 +1,63 @@
+#include "gnublin.h"
+
+// Checks that the IIR stage of gnublin_adc_filter settles exactly on a step
+// input for every allowed time constant k, rising and falling, with and
+// without extra fraction bits. Runs on a host, exits with 1 on the first
+// mismatch.
+//
+// usage: adc_filter_check
+
+#define BLOCK 1024
+
+static const int steps[][2] = {
+	{ 0, 1000 },
+	{ 1000, 3 },
+	{ 0, 1023 },
+	{ 1023, 0 },
+	{ 512, 513 },
+	{ 513, 512 },
+};
+
+// feeds "from" once and then "to" until the output stays at "to", returns the number of values needed or -1
+static int settle(int k, int extra_bits, int from, int to){
+	gnublin_adc_filter filter;
+	int channel = 0;
+	int in[BLOCK], out[BLOCK];
+	int expected = to << extra_bits;
+	long limit = 40L << k;
+
+	filter.setChannels(&channel, 1);
+	filter.addStage(ADC_FILTER_IIR, k);
+	filter.setExtraBits(extra_bits);
+	filter.process(channel, &from, 1, out);
+	for (int i = 0; i < BLOCK; i++)
+		in[i] = to;
+	for (long done = 0; done < limit; done += BLOCK) {
+		filter.process(channel, in, BLOCK, out);
+		if (out[BLOCK - 1] == expected) {
+			// once there, the output must not move any more
+			filter.process(channel, in, BLOCK, out);
+			for (int i = 0; i < BLOCK; i++)
+				if (out[i] != expected)
+					return -1;
+			return done + BLOCK;
+		}
+	}
+	printf("k %d, extra bits %d, step %d -> %d: stays at %d instead of %d\n", k, extra_bits, from, to, out[BLOCK - 1], expected);
+	return -1;
+}
+
+int main(){
+	int count = sizeof(steps) / sizeof(steps[0]);
+
+	for (int k = 1; k <= 15; k++) {
+		for (int extra_bits = 0; extra_bits <= ADC_FILTER_FRAC_BITS; extra_bits += ADC_FILTER_FRAC_BITS) {
+			for (int i = 0; i < count; i++) {
+				if (settle(k, extra_bits, steps[i][0], steps[i][1]) < 0)
+					return 1;
+			}
+		}
+	}
+	printf("all IIR steps settle exactly for k = 1 to 15\n");
+	return 0;
+}
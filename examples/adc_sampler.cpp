@@ -0,0 +1,23 @@
+#include "gnublin.h"
+
+int main(){
+	gnublin_module_adc adc;
+	gnublin_adc_sampler sampler(&adc);
+	gnublin_adc_sample block[50];
+	int channels[] = {1, 2};
+
+	sampler.setChannels(channels, 2);
+	sampler.setRate(50);
+	if (sampler.start() < 0) {
+		printf("%s", sampler.getErrorMessage());
+		return 1;
+	}
+
+	while(1){
+		// one block of 25 scans of both channels, about half a second
+		int n = sampler.read(block, 50, 1000);
+		for (int i = 0; i < n; i++)
+			printf("%llu ch%i: %i\n", block[i].timestamp, block[i].channel, block[i].value);
+		printf("latest ch1: %i, overruns: %u\n\n", sampler.getLatestValue(1), sampler.getOverruns());
+	}
+}
@@ -0,0 +1,42 @@
+#include "gnublin.h"
+
+// Runs a G-code file (or stdin with "-") on X (0x60), Y (0x61) and Z (0x62)
+// with 80 steps per mm, M104/M109 switch the heater on relay 1.
+//
+// usage: gcode <file|->
+
+int main(int argc, char **argv)
+{
+	gnublin_module_step x, y, z;
+	gnublin_module_step *motors[3] = { &x, &y, &z };
+	gnublin_module_relay heater;
+	gnublin_step_planner planner;
+	gnublin_gcode gcode(&planner);
+
+	if (argc < 2) {
+		printf("usage: %s <file|->\n", argv[0]);
+		return 1;
+	}
+	x.setAddress(0x60);
+	y.setAddress(0x61);
+	z.setAddress(0x62);
+	for (int i = 0; i < 3; i++) {
+		motors[i]->setMotorParam();
+		motors[i]->getFullStatus1();
+		motors[i]->runInit();
+		motors[i]->resetPosition();
+		planner.addAxis(motors[i]);
+	}
+	gcode.setAxis('X', 0, 80);
+	gcode.setAxis('Y', 1, 80);
+	gcode.setAxis('Z', 2, 80);
+	gcode.setAxis('E', -1, 1);
+	gcode.setHeater(&heater, 1);
+
+	if (gcode.run(argv[1]) < 0) {
+		printf("%s", gcode.getErrorMessage());
+		return 1;
+	}
+	printf("%u lines, %u moves, %u segments, %u codes ignored\n",
+	       gcode.getLines(), gcode.getMoves(), gcode.getSegments(), gcode.getIgnored());
+}
@@ -0,0 +1,55 @@
+#include "gnublin.h"
+
+// Measures the parser throughput in lines per second. A program with
+// typical slicer output is written to a temporary file and parsed without
+// a planner, so it runs on a host. With a file as argument that file is
+// parsed instead.
+//
+// usage: gcode_benchmark [file]
+
+#define LINES 1000000
+
+static double now(){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv){
+	gnublin_gcode gcode(NULL);
+	std::string filename = "/tmp/gcode_benchmark.gcode";
+	double start, seconds;
+	int result;
+
+	if (argc > 1)
+		filename = argv[1];
+	else {
+		FILE *file = fopen(filename.c_str(), "w");
+
+		if (!file) {
+			printf("ERROR opening: %s\n", filename.c_str());
+			return 1;
+		}
+		fprintf(file, "; generated by gcode_benchmark\nG21\nG90\nG28\nM104 S200\n");
+		for (int i = 0; i < LINES; i++) {
+			if (i % 100 == 0)
+				fprintf(file, "G0 Z%.2f F3000 ; layer %d\n", (i / 100) * 0.2, i / 100);
+			else
+				fprintf(file, "N%d G1 X%.3f Y%.3f E%.5f F1800*%d\n", i, (i % 97) * 1.25, (i % 89) * 0.75, i * 0.0331, i & 127);
+		}
+		fprintf(file, "M104 S0\nM30\n");
+		fclose(file);
+	}
+
+	start = now();
+	result = gcode.run(filename);
+	seconds = now() - start;
+	if (result < 0) {
+		printf("%s", gcode.getErrorMessage());
+		return 1;
+	}
+	printf("%u lines in %.3f s: %.0f lines/s\n", gcode.getLines(), seconds, gcode.getLines() / seconds);
+	printf("%u moves, %u segments after merging, %u codes ignored\n", gcode.getMoves(), gcode.getSegments(), gcode.getIgnored());
+	if (argc < 2)
+		unlink(filename.c_str());
+}
@@ -0,0 +1,28 @@
+#include "gnublin.h"
+
+// OS output of the LM75 connected to GPIO 11, sleeps until the temperature crosses 30 / 28 degree
+// usage: lm75_alarm [-i]   (-i: interrupt mode, OS is released by the read and becomes active again below 28 degree)
+int main(int argc, char **argv)
+{
+	gnublin_module_lm75 lm75;
+	gnublin_event_queue queue;
+	gnublin_event event;
+	bool interrupt = argc > 1 && strcmp(argv[1], "-i") == 0;
+
+	lm75.setAddress(0x4f);
+	lm75.setMode(interrupt ? LM75_MODE_INTERRUPT : LM75_MODE_COMPARATOR);
+	lm75.setFaultQueue(2);
+	lm75.setTos(30000);
+	lm75.setThyst(28000);
+	if (lm75.attachAlarm(11, &queue) < 0) {
+		printf("%s", lm75.getErrorMessage());
+		return 1;
+	}
+
+	while (queue.wait(&event, -1) > 0) {
+		if (event.type == EVENT_TEMP_ALARM)
+			printf("over temperature: %.3f\n", event.value / 1000.0);
+		else
+			printf("temperature ok: %.3f\n", event.value / 1000.0);
+	}
+}
@@ -0,0 +1,32 @@
+#include "gnublin.h"
+
+// three threads share one LM75, the sensor is read at most every 500 ms
+gnublin_module_lm75 lm75;
+gnublin_lm75_cache cache(&lm75, 500);
+
+void *reader(void *arg)
+{
+	const char *name = (const char *)arg;
+
+	while (1) {
+		float temp = cache.getTempFloat();
+		printf("%s: %.3f (%i ms old)\n", name, temp, cache.getAge());
+		usleep(100000);
+	}
+	return NULL;
+}
+
+int main()
+{
+	pthread_t ui, logger;
+
+	pthread_create(&ui, NULL, reader, (void *)"ui");
+	pthread_create(&logger, NULL, reader, (void *)"logger");
+	while (1) {
+		float temp;
+		// the heater loop always wants a fresh value
+		if (cache.getTemp(&temp, 0) > 0)
+			printf("heater: %.3f, %u sensor reads\n", temp, cache.getReads());
+		sleep(1);
+	}
+}
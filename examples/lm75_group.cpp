@@ -0,0 +1,27 @@
+#include "gnublin.h"
+
+// reads 8 LM75 on /dev/i2c-1 and 8 LM75 on /dev/i2c-0 once per second
+int main()
+{
+	gnublin_lm75_group sensors;
+	const int *temp;
+
+	for (int address = 0x48; address <= 0x4f; address++) {
+		sensors.addSensor("/dev/i2c-1", address);
+		sensors.addSensor("/dev/i2c-0", address);
+	}
+
+	while (1) {
+		if (sensors.update() < 0)
+			printf("%s", sensors.getErrorMessage());
+		temp = sensors.getTemperatures();
+		for (int i = 0; i < sensors.size(); i++) {
+			if (sensors.valid(i))
+				printf("%6.3f ", temp[i] / 1000.0);
+			else
+				printf("   --- ");
+		}
+		printf("\n");
+		sleep(1);
+	}
+}
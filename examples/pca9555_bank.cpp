@@ -0,0 +1,30 @@
+#include "gnublin.h"
+
+// 8 portexpanders (0x20-0x27) as one bank of 128 pins:
+// pin 0-63 are outputs running a light, pin 64-127 are inputs
+int main()
+{
+	gnublin_pca9555_bank bank;
+	int pos = 0;
+
+	for (int address = 0x20; address <= 0x27; address++)
+		bank.addExpander(address);
+	for (int pin = 0; pin < 64; pin++) {
+		bank.digitalWrite(pin, LOW);
+		bank.pinMode(pin, PCA9555_OUTPUT);
+	}
+	for (int pin = 64; pin < bank.size(); pin++)
+		bank.pinMode(pin, PCA9555_INPUT);
+
+	while (1) {
+		bank.digitalWrite(pos, LOW);
+		pos = (pos + 1) % 64;
+		bank.digitalWrite(pos, HIGH);
+		if (bank.commit() < 0 || bank.update() < 0) {
+			printf("%s", bank.getErrorMessage());
+			return 1;
+		}
+		printf("input 64: %i, %u transactions\n", bank.digitalRead(64), bank.getTransactions());
+		usleep(100000);
+	}
+}
@@ -0,0 +1,93 @@
+#include "gnublin.h"
+
+// Compares the CPU cost of the old pinMode()/digitalWrite() register value
+// computation (pow() and string compares) with the typed path, without any
+// bus access, so it runs on a host. With an address as argument the complete
+// calls are measured on a connected PCA9555 as well.
+//
+// usage: pca9555_benchmark [address]
+
+#define LOOPS 1000000
+
+static double now(){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// the register value computation as it was implemented before
+static int legacyPinMode(unsigned char *shadow, int pin, std::string direction){
+	unsigned char TxBuf[1];
+
+	if (pin < 0 || pin > 15)
+		return -1;
+	if (pin >= 0 && pin <= 7) {
+		TxBuf[0] = pow(2, pin);
+		if (direction == "out")
+			shadow[6] = shadow[6] & ~TxBuf[0];
+		else if (direction == "in")
+			shadow[6] = shadow[6] | TxBuf[0];
+		else
+			return -1;
+	}
+	else {
+		TxBuf[0] = pow(2, (pin - 8));
+		if (direction == "out")
+			shadow[7] = shadow[7] & ~TxBuf[0];
+		else if (direction == "in")
+			shadow[7] = shadow[7] | TxBuf[0];
+		else
+			return -1;
+	}
+	return 1;
+}
+
+// the register value computation of pinMode(int, pca9555_direction)
+static int typedPinMode(unsigned char *shadow, int pin, pca9555_direction direction){
+	if ((unsigned int)pin > 15)
+		return -1;
+	unsigned char reg = 0x06 + (pin >> 3);
+	unsigned char mask = 1 << (pin & 7);
+	shadow[reg] = (shadow[reg] & ~mask) | (mask & -(int)direction);
+	return 1;
+}
+
+int main(int argc, char **argv){
+	// volatile keeps the compiler from folding the loops
+	volatile unsigned char shadow[8] = {0};
+	double start, legacy, typed;
+	int sum = 0;
+
+	start = now();
+	for (int i = 0; i < LOOPS; i++)
+		sum += legacyPinMode((unsigned char *)shadow, i & 15, (i & 16) ? "in" : "out");
+	legacy = now() - start;
+
+	start = now();
+	for (int i = 0; i < LOOPS; i++)
+		sum += typedPinMode((unsigned char *)shadow, i & 15, (i & 16) ? PCA9555_INPUT : PCA9555_OUTPUT);
+	typed = now() - start;
+
+	printf("register value computation, %i calls (check %i)\n", LOOPS, sum);
+	printf("pow() + string: %8.1f ns/call\n", legacy * 1e9 / LOOPS);
+	printf("typed:          %8.1f ns/call\n", typed * 1e9 / LOOPS);
+
+	if (argc > 1) {
+		gnublin_module_pca9555 pca;
+		int calls = 1000;
+
+		pca.setAddress(strtol(argv[1], NULL, 16));
+		start = now();
+		for (int i = 0; i < calls; i++)
+			pca.pinMode(i & 15, (i & 16) ? "in" : "out");
+		legacy = now() - start;
+		start = now();
+		for (int i = 0; i < calls; i++)
+			pca.pinMode(i & 15, (i & 16) ? PCA9555_INPUT : PCA9555_OUTPUT);
+		typed = now() - start;
+		printf("complete pinMode() on the bus, %i calls\n", calls);
+		printf("string wrapper: %8.1f us/call\n", legacy * 1e6 / calls);
+		printf("typed:          %8.1f us/call\n", typed * 1e6 / calls);
+	}
+	return 0;
+}
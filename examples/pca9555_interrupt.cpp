@@ -0,0 +1,19 @@
+#include "gnublin.h"
+
+// INT of the portexpander connected to GPIO 14, prints every change of an input
+int main()
+{
+	gnublin_module_pca9555 pca;
+	gnublin_event_queue queue;
+	gnublin_event event;
+
+	pca.setAddress(0x20);
+	pca.setDirection16(0xffff);		// all pins are inputs
+	if (pca.attachInterrupt(14, &queue) < 0) {
+		printf("%s", pca.getErrorMessage());
+		return 1;
+	}
+
+	while (queue.wait(&event, -1) > 0)
+		printf("pin %i: %i\n", event.source, event.value);
+}
@@ -7,6 +7,8 @@ gnublin_module_step Motor_x;
 gnublin_module_step Motor_z;
 gnublin_module_step Motor_y;
 gnublin_module_step Motor_p;
+gnublin_step_group Motors;
+gnublin_step_homing homing;
 
 
 using namespace std;
@@ -14,26 +16,56 @@ using namespace std;
 int hflag = 0;
 int initflag = 0;
 int printflag = 0;
+volatile sig_atomic_t aborted = 0;
 
 void my_handler(int s){
+	int saved_errno = errno;
+
+	//one bus transaction stops all Motors, without the locks the main loop may hold
+	Motors.emergencyStop();
+	homing.cancel();
+	aborted = 1;
+	errno = saved_errno;
+}
+
+//called from the main loop after Ctrl-C: lift the Z axis and quit
+void checkAbort(){
+	if(!aborted)
+		return;
 	cout << "Execution aborted!" << endl;
-	Motor_x.hardStop();
-	Motor_z.hardStop();
-	Motor_y.hardStop();
-	Motor_p.hardStop();
+	//a drive which was interrupted by the signal may have started a motor again
+	Motors.hardStop();
 	Motor_z.drive(10500);
 	while(Motor_z.getMotionStatus()!=0){
-		usleep(10000);	
+		usleep(10000);
 	}
 	exit(1);
 }
 
+void waitMotor(gnublin_module_step &motor, int us){
+	while(motor.getMotionStatus()!=0){
+		checkAbort();
+		usleep(us);
+	}
+	checkAbort();
+}
+
 int initMotor(){
 	//set the Motor Slave Addresses
 	Motor_x.setAddress(0x7f);
 	Motor_z.setAddress(0x60);
 	Motor_y.setAddress(0x62);
 	Motor_p.setAddress(0x61);
+	Motors.addMotor(&Motor_x);
+	Motors.addMotor(&Motor_z);
+	Motors.addMotor(&Motor_y);
+	Motors.addMotor(&Motor_p);
+
+	//getMotionStatus() and getSwitch() called within 1 ms share one status read
+	Motor_x.setStatusMaxAge(1);
+	Motor_z.setStatusMaxAge(1);
+	Motor_y.setStatusMaxAge(1);
+	Motor_p.setStatusMaxAge(1);
 
 	//Motor_x
 	//SetMotorParam
@@ -76,86 +108,44 @@ int initMotor(){
 }
 int initPrinter(){
 	Motor_z.drive(30000);
-	while(Motor_z.getMotionStatus()!=0){
-		usleep(10000);
-	}
+	waitMotor(Motor_z, 10000);
 	Motor_z.drive(30000);
-	while(Motor_z.getMotionStatus()!=0){
-		usleep(10000);
-	}
+	waitMotor(Motor_z, 10000);
 	Motor_z.drive(30000);
-	while(Motor_z.getMotionStatus()!=0){
-		usleep(10000);
-	}
+	waitMotor(Motor_z, 10000);
 
-	//drive all Motors to the Swich
-
-	while(Motor_y.getSwitch()==0){
-		Motor_y.drive(-10000);
-		while(Motor_y.getMotionStatus()!=0){
-			usleep(1000);
-			if(Motor_y.getSwitch()){
-				Motor_y.hardStop();
-				Motor_y.resetPosition();
-				break;
-			}
-		}
-	}
-	
-	while(Motor_x.getSwitch()==0){
-		Motor_x.drive(10000);
-		while(Motor_x.getMotionStatus()!=0){
-			usleep(1000);
-			if(Motor_x.getSwitch()){
-				Motor_x.hardStop();
-				Motor_x.resetPosition();
-				break;
-			}
-		}
+	//drive all Motors to the Swich at the same time, the switch positions become 0
+	homing.addAxis(&Motor_y, -1);
+	homing.addAxis(&Motor_x, 1);
+	homing.addAxis(&Motor_z, -1);
+	homing.setVmax(4, 1);
+	homing.setTravel(200000);
+	if(homing.run(120000) < 0){
+		checkAbort();
+		cout << homing.getErrorMessage();
+		return -1;
 	}
+	cout << "homed in " << homing.getTime(0) << " / " << homing.getTime(1) << " / " << homing.getTime(2) << " ms" << endl;
 
-	while(Motor_z.getSwitch()==0){
-		Motor_z.drive(-30000);
-		while(Motor_z.getMotionStatus()!=0){
-			usleep(1000);
-			if(Motor_z.getSwitch()){
-				Motor_z.hardStop();
-				Motor_z.resetPosition();
-				break;
-			}
-		}
-	}
-	
 	//drive Motors to the print position
 	Motor_z.drive(30000);
-	while(Motor_z.getMotionStatus()!=0){
-		usleep(10000);
-	}
+	waitMotor(Motor_z, 10000);
 	Motor_z.drive(30000);
-	while(Motor_z.getMotionStatus()!=0){
-		usleep(10000);
-	}
+	waitMotor(Motor_z, 10000);
 	Motor_z.drive(20000);
-	while(Motor_z.getMotionStatus()!=0){
-		usleep(10000);
-	}
+	waitMotor(Motor_z, 10000);
 
 	Motor_y.drive(7300);
-	while(Motor_y.getMotionStatus()!=0){
-		usleep(10000);
-	}
+	waitMotor(Motor_y, 10000);
 
 	Motor_x.drive(-7500);
-	while(Motor_x.getMotionStatus()!=0){
-		usleep(10000);
-	}
+	waitMotor(Motor_x, 10000);
 	return 1;	
 }
 
 int print(){
 	Motor_p.drive(-10);
-	while(Motor_p.getMotionStatus()!=0)
-		usleep(150);
+	waitMotor(Motor_p, 150);
 	return 1;
 }
 
@@ -188,6 +178,7 @@ int print_x_slow(int position, int steps)
 	int i;
 
 	for(i=0;i<=position;i+=abs(steps)){
+		checkAbort();
 		Motor_x.drive(steps);
 		Motor_p.drive(-(abs(steps)/3));
 		usleep(1000*3);
@@ -200,6 +191,7 @@ int print_z_slow(int position, int steps)
 	int i;
 
 	for(i=0;i<=position;i+=abs(steps)){
+		checkAbort();
 		Motor_y.drive(steps);
 		Motor_p.drive(-(abs(steps)/3));
 		usleep(1000*3);
@@ -222,9 +214,7 @@ int main(int argc, char **argv){
 	Motor_y.setMotorParam();
 
 	Motor_z.drive(-10500);
-	while(Motor_z.getMotionStatus()!=0){
-		usleep(10000);	
-	}
+	waitMotor(Motor_z, 10000);
 
 	Motor_p.drive(-100);
 	for(i=0;i<=10;i++){
@@ -232,13 +222,12 @@ int main(int argc, char **argv){
 		print_z_slow(2000,-10);
 		print_x_slow(3000,-10);
 		print_z_slow(2000,10);
+		checkAbort();
 		Motor_z.drive(1000);
 		usleep(1000*100);
 	}
 
 	Motor_z.drive(10500);
-	while(Motor_z.getMotionStatus()!=0){
-		usleep(10000);	
-	}
+	waitMotor(Motor_z, 10000);
 	return 1;
 }
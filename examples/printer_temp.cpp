@@ -6,6 +6,8 @@
 gnublin_module_dogm display;
 gnublin_gpio gpio;
 gnublin_adc adc;
+gnublin_adc_sampler sampler(&adc);
+gnublin_adc_filter filter;
 
 
 using namespace std;
@@ -18,16 +20,25 @@ void my_handler(int s){
 	exit(1); 
 }
 
+// waits for the next 10 s block of samples (10 Hz), removes spikes with a
+// median of 5 and smooths with an IIR low pass
 float get_temperature(){
+	gnublin_adc_sample block[100];
+	int raw[100];
+	int filtered[100];
 	int voltage =0;
 	float resistance=0;
 	float temperature=0;
+	int n;
 	
-	
-	if((voltage = adc.getVoltage(1))==-1){
+	n = sampler.read(block, 100, 11000);
+	for (int i = 0; i < n; i++)
+		raw[i] = block[i].value;
+	if(n == 0 || (n = filter.process(1, raw, n, filtered)) <= 0){
 		return -1;
 	}
 	else {
+		voltage = filtered[n-1]*825/256;
 		resistance = (voltage * 330) / (3300 - voltage);
 		temperature = ((resistance/100)-1)*259.74;
 	}
@@ -40,7 +51,15 @@ int main(int argc, char **argv){
 	char tempchar[13];
 	float temperature;
 	int heating=0;
+	int channel=1;
 	signal (SIGINT,my_handler);
+
+	sampler.setChannels(&channel, 1);
+	sampler.setRate(10);
+	filter.setChannels(&channel, 1);
+	filter.addStage(ADC_FILTER_MEDIAN, 5);
+	filter.addStage(ADC_FILTER_IIR, 3);
+	sampler.start();
 	
 	gpio.pinMode(18, OUTPUT);
 	gpio.digitalWrite(18, HIGH);
@@ -72,7 +91,6 @@ int main(int argc, char **argv){
 			if(heating)display.print((char*)"Heizung: ein", 2);
 			if(!heating)display.print((char*)"Heizung: aus", 2);
 		}
-		sleep(10);
     	}
 
 
@@ -0,0 +1,31 @@
+#include "gnublin.h"
+
+// 4 relay boards (0x20-0x23): every relay blinks with its own period,
+// relays which toggle in the same ms are switched with one write per board
+int main()
+{
+	gnublin_module_relay relays[4];
+	gnublin_relay_scheduler scheduler;
+
+	for (int i = 0; i < 4; i++) {
+		relays[i].setAddress(0x20 + i);
+		scheduler.addBoard(&relays[i]);
+	}
+	for (int cycle = 0; cycle < 10; cycle++) {
+		for (int board = 0; board < 4; board++) {
+			for (int relay = 1; relay <= 8; relay++) {
+				int period = 100 * relay;
+				if (scheduler.pulse(board, relay, period / 2, cycle * period) < 0) {
+					printf("%s", scheduler.getErrorMessage());
+					return 1;
+				}
+			}
+		}
+	}
+	scheduler.start();
+	while (scheduler.pending() > 0)
+		usleep(100000);
+	scheduler.stop();
+	printf("%u actions, %u writes, %u errors\n", scheduler.getExecuted(), scheduler.getWrites(), scheduler.getErrors());
+	printf("jitter: average %u us, max %u us\n", scheduler.getAverageJitter(), scheduler.getMaxJitter());
+}
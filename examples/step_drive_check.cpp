@@ -0,0 +1,275 @@
+#include "gnublin.h"
+#include <fcntl.h>
+#include <stdarg.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+// Checks gnublin_module_step against a simulated TMC222 instead of the I2C
+// bus: relative drives while a status snapshot is reused, a snapshot taken
+// while the motor moves, drives next to a polling thread and a missing
+// device. The simulation replaces open(), close(), read(), write() and
+// ioctl() for the device file below, all other files go to the kernel.
+// Runs on a host, exits with 1 on the first failure.
+//
+// usage: step_drive_check
+
+#define SIM_DEVICE "/tmp/gnublin_step_sim"
+#define SIM_ADDRESS 0x60
+#define SIM_STEPS_PER_MS 50
+
+struct sim_tmc222 {
+	int position, target, vmax, vmin, irun, ihold;
+	unsigned char last_command;
+	unsigned long long time;
+};
+
+static sim_tmc222 chip;
+static pthread_mutex_t sim_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool sim_fd[1024];
+static int sim_slave[1024];
+
+// moves the position towards the target once per bus transaction, the lock must be held
+static void simMove(){
+	unsigned long long now = getMonotonicTime();
+	int steps = (int)((now - chip.time) * SIM_STEPS_PER_MS / 1000);
+
+	if (steps <= 0)
+		return;
+	chip.time = now;
+	if (chip.position < chip.target)
+		chip.position = chip.position + steps < chip.target ? chip.position + steps : chip.target;
+	else if (chip.position > chip.target)
+		chip.position = chip.position - steps > chip.target ? chip.position - steps : chip.target;
+}
+
+static int simWrite(int address, const unsigned char *buf, int len){
+	if (address != SIM_ADDRESS || len < 1)
+		return -1;
+	chip.last_command = buf[0];
+	switch (buf[0]) {
+	case 0x8b:	// SetPosition
+		if (len >= 5)
+			chip.target = (short)(buf[3] << 8 | buf[4]);
+		break;
+	case 0x85:	// SoftStop
+	case 0x8f:	// HardStop
+		chip.target = chip.position;
+		break;
+	case 0x86:	// ResetPosition
+		chip.position = chip.target = 0;
+		break;
+	case 0x89:	// SetMotorParam
+		if (len >= 8) {
+			chip.irun = buf[3] >> 4;
+			chip.ihold = buf[3] & 0x0f;
+			chip.vmax = buf[4] >> 4;
+			chip.vmin = buf[4] & 0x0f;
+		}
+		break;
+	}
+	return 0;
+}
+
+// answers GetFullStatus2 after 0xfc, GetFullStatus1 otherwise
+static int simRead(int address, unsigned char *buf, int len){
+	unsigned char frame[8] = { 0 };
+
+	if (address != SIM_ADDRESS)
+		return -1;
+	frame[0] = address;
+	if (chip.last_command == 0xfc) {
+		frame[1] = chip.position >> 8;
+		frame[2] = chip.position;
+		frame[3] = chip.target >> 8;
+		frame[4] = chip.target;
+	} else {
+		frame[1] = chip.irun << 4 | chip.ihold;
+		frame[2] = chip.vmax << 4 | chip.vmin;
+		frame[3] = 3 << 5;
+		if (chip.position != chip.target)
+			frame[5] = (chip.target > chip.position ? 3 : 7) << 5;
+	}
+	for (int i = 0; i < len && i < 8; i++)
+		buf[i] = frame[i];
+	return 0;
+}
+
+extern "C" int open(const char *path, int flags, ...){
+	va_list ap;
+	int mode, fd;
+
+	va_start(ap, flags);
+	mode = va_arg(ap, int);
+	va_end(ap);
+	if (strcmp(path, SIM_DEVICE) != 0)
+		return syscall(SYS_openat, AT_FDCWD, path, flags, mode);
+	fd = syscall(SYS_openat, AT_FDCWD, "/dev/null", O_RDWR, 0);
+	if (fd >= 0 && fd < 1024)
+		sim_fd[fd] = true;
+	return fd;
+}
+
+extern "C" int close(int fd){
+	if (fd >= 0 && fd < 1024)
+		sim_fd[fd] = false;
+	return syscall(SYS_close, fd);
+}
+
+extern "C" int ioctl(int fd, unsigned long request, ...) throw(){
+	va_list ap;
+	void *arg;
+	struct i2c_rdwr_ioctl_data *data;
+	int result;
+
+	va_start(ap, request);
+	arg = va_arg(ap, void *);
+	va_end(ap);
+	if (fd < 0 || fd >= 1024 || !sim_fd[fd])
+		return syscall(SYS_ioctl, fd, request, arg);
+	if (request == I2C_SLAVE) {
+		sim_slave[fd] = (int)(long)arg;
+		return 0;
+	}
+	if (request != I2C_RDWR)
+		return -1;
+	data = (struct i2c_rdwr_ioctl_data *)arg;
+	result = data->nmsgs;
+	pthread_mutex_lock(&sim_lock);
+	simMove();
+	for (unsigned int i = 0; i < data->nmsgs; i++) {
+		struct i2c_msg *msg = &data->msgs[i];
+		if ((msg->flags & I2C_M_RD ? simRead(msg->addr, msg->buf, msg->len) : simWrite(msg->addr, msg->buf, msg->len)) < 0) {
+			result = -1;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&sim_lock);
+	return result;
+}
+
+extern "C" ssize_t read(int fd, void *buf, size_t len){
+	int result;
+
+	if (fd < 0 || fd >= 1024 || !sim_fd[fd])
+		return syscall(SYS_read, fd, buf, len);
+	pthread_mutex_lock(&sim_lock);
+	simMove();
+	result = simRead(sim_slave[fd], (unsigned char *)buf, len);
+	pthread_mutex_unlock(&sim_lock);
+	return result < 0 ? -1 : (ssize_t)len;
+}
+
+extern "C" ssize_t write(int fd, const void *buf, size_t len){
+	int result;
+
+	if (fd < 0 || fd >= 1024 || !sim_fd[fd])
+		return syscall(SYS_write, fd, buf, len);
+	pthread_mutex_lock(&sim_lock);
+	simMove();
+	result = simWrite(sim_slave[fd], (const unsigned char *)buf, len);
+	pthread_mutex_unlock(&sim_lock);
+	return result < 0 ? -1 : (ssize_t)len;
+}
+
+static int simPosition(){
+	int position;
+
+	pthread_mutex_lock(&sim_lock);
+	simMove();
+	position = chip.position;
+	pthread_mutex_unlock(&sim_lock);
+	return position;
+}
+
+static gnublin_module_step motor;
+static volatile bool polling;
+static volatile int torn;
+
+// the chip reports a motion exactly while position and target differ, a
+// snapshot mixing two reads breaks this
+static void *poll(void *){
+	gnublin_step_status status;
+
+	while (polling) {
+		motor.getMotionStatus();
+		if (motor.getStatus(&status) > 0 && (status.motion != 0) != (status.position != status.target))
+			torn = torn + 1;
+		motor.updateStatus(&status);
+	}
+	return NULL;
+}
+
+static int waitStop(){
+	gnublin_step_status status;
+
+	do {
+		usleep(1000);
+		if (motor.updateStatus(&status) < 0)
+			return -1;
+	} while (status.motion || status.position != status.target);
+	return 1;
+}
+
+static int check(const char *name, int expected, int actual){
+	printf("%s: expected %d, got %d\n", name, expected, actual);
+	return expected == actual ? 0 : 1;
+}
+
+int main(){
+	gnublin_module_step missing;
+	pthread_t poller;
+	int start, failures = 0;
+
+	chip.time = getMonotonicTime();
+	motor.setDevicefile(SIM_DEVICE);
+	motor.setAddress(SIM_ADDRESS);
+	if (motor.setMotorParam() < 0) {
+		printf("%s", motor.getErrorMessage());
+		return 1;
+	}
+
+	// drive() must read the position itself and not use the reused snapshot
+	motor.setStatusMaxAge(10000);
+	motor.getActualPosition();
+	for (int i = 0; i < 5; i++) {
+		if (motor.drive(100) < 0 || waitStop() < 0) {
+			printf("%s", motor.getErrorMessage());
+			return 1;
+		}
+	}
+	failures += check("drives with a reused snapshot", 500, simPosition());
+
+	motor.setPosition(1500);
+	usleep(10000);
+	motor.getActualPosition();
+	usleep(50000);
+	if (motor.drive(100) < 0 || waitStop() < 0) {
+		printf("%s", motor.getErrorMessage());
+		return 1;
+	}
+	failures += check("drive after a snapshot taken while moving", 1600, simPosition());
+
+	motor.setStatusMaxAge(1);
+	polling = true;
+	pthread_create(&poller, NULL, poll, NULL);
+	start = simPosition();
+	for (int i = 0; i < 50; i++) {
+		if (motor.drive(i % 2 ? -37 : 53) < 0 || waitStop() < 0) {
+			printf("%s", motor.getErrorMessage());
+			failures++;
+			break;
+		}
+	}
+	polling = false;
+	pthread_join(poller, NULL);
+	failures += check("drives next to a polling thread", start + 25 * 53 - 25 * 37, simPosition());
+	failures += check("torn snapshots", 0, torn);
+
+	missing.setDevicefile(SIM_DEVICE);
+	missing.setAddress(0x10);
+	failures += check("drive of a missing device", -1, missing.drive(10));
+	failures += check("error flag of a missing device", 1, missing.fail() ? 1 : 0);
+	failures += check("status of a missing device", -1, missing.getMotionStatus());
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,35 @@
+#include "gnublin.h"
+
+// Stops four motors (0x60-0x63) one by one and as a group and prints the
+// worst case latency, i.e. the time until the last motor got its HardStop.
+int main()
+{
+	gnublin_module_step motors[4];
+	gnublin_step_group group;
+	unsigned long long start, single;
+
+	for (int i = 0; i < 4; i++) {
+		motors[i].setAddress(0x60 + i);
+		motors[i].setMotorParam();
+		motors[i].getFullStatus1();
+		motors[i].runInit();
+		group.addMotor(&motors[i]);
+	}
+
+	start = getMonotonicTime();
+	for (int i = 0; i < 4; i++)
+		motors[i].hardStop();
+	single = getMonotonicTime() - start;
+
+	if (group.hardStop() < 0) {
+		printf("%s", group.getErrorMessage());
+		return 1;
+	}
+	printf("one by one: %llu us, group: %llu us", single, group.getLatency());
+	group.setBroadcast(true);
+	if (group.hardStop() < 0) {
+		printf("\n%s", group.getErrorMessage());
+		return 1;
+	}
+	printf(", general call: %llu us\n", group.getLatency());
+}
@@ -0,0 +1,26 @@
+#include "gnublin.h"
+
+// X (0x60) and Y (0x61) move to their switches in negative direction at the
+// same time, afterwards the switch positions are 0
+int main()
+{
+	gnublin_module_step x, y;
+	gnublin_step_homing homing;
+
+	x.setAddress(0x60);
+	y.setAddress(0x61);
+	x.setMotorParam();
+	y.setMotorParam();
+	x.getFullStatus1();
+	y.getFullStatus1();
+	x.runInit();
+	y.runInit();
+	homing.addAxis(&x, -1);
+	homing.addAxis(&y, -1);
+
+	if (homing.run(60000) < 0) {
+		printf("%s", homing.getErrorMessage());
+		return 1;
+	}
+	printf("X homed in %d ms, Y homed in %d ms, %u status reads\n", homing.getTime(0), homing.getTime(1), homing.getPolls());
+}
@@ -0,0 +1,32 @@
+#include "gnublin.h"
+
+// X (0x60) and Y (0x61) draw a square with a diagonal, both axes arrive together
+int main()
+{
+	gnublin_module_step x, y;
+	gnublin_step_planner planner;
+	int path[][2] = { {4000, 0}, {4000, 4000}, {0, 4000}, {0, 0}, {4000, 4000}, {0, 0} };
+
+	x.setAddress(0x60);
+	y.setAddress(0x61);
+	x.setMotorParam();
+	y.setMotorParam();
+	x.getFullStatus1();
+	y.getFullStatus1();
+	x.runInit();
+	y.runInit();
+	x.resetPosition();
+	y.resetPosition();
+	planner.addAxis(&x);
+	planner.addAxis(&y);
+	planner.setVmax(10);
+
+	// the segments are queued at once, each one starts when the previous one is done
+	for (int i = 0; i < 6; i++)
+		planner.move(path[i]);
+	if (planner.wait(-1) < 0) {
+		printf("%s", planner.getErrorMessage());
+		return 1;
+	}
+	printf("%u segments done\n", planner.getSegments());
+}
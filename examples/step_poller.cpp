@@ -0,0 +1,29 @@
+#include "gnublin.h"
+
+// moves three motors at once and waits for all of them with one thread
+int main()
+{
+	gnublin_module_step motors[3];
+	gnublin_step_poller poller;
+	int handles[3];
+
+	for (int i = 0; i < 3; i++) {
+		motors[i].setAddress(0x60 + i);
+		motors[i].setVmax(4);
+		motors[i].setMotorParam();
+		motors[i].getFullStatus1();
+		motors[i].runInit();
+		poller.addMotor(&motors[i]);
+	}
+	for (int i = 0; i < 3; i++) {
+		handles[i] = poller.drive(i, 5000 * (i + 1));
+		if (handles[i] < 0) {
+			printf("%s", poller.getErrorMessage());
+			return 1;
+		}
+	}
+	// the poller reads the status rarely while the motors are far from their targets
+	while (poller.wait(handles, 3, 500) == 0)
+		printf("positions: %i %i %i\n", poller.getPosition(0), poller.getPosition(1), poller.getPosition(2));
+	printf("all motors arrived, %u status reads\n", poller.getPolls());
+}
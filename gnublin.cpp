@@ -1,6 +1,6 @@
 //********************************************
 //GNUBLIN API -- MAIN FILE
-//build date: 06/10/13 11:30
+//build date: 10/19/26 07:37
 //******************************************** 
 
 #include"gnublin.h"
@@ -39,6 +39,236 @@ int hexstringToNumber(std::string str){
 	return var;
 }
 
+//Converting a buffer wich repesenting a hexnumber to number (without iostreams)
+int hexbufferToNumber(const char *buf, int length){
+	int i = 0;
+	int var = 0;
+	int digits = 0;
+
+	while (i < length && (buf[i] == ' ' || buf[i] == '\t' || buf[i] == '\n'))
+		i++;
+	if (i + 1 < length && buf[i] == '0' && (buf[i+1] == 'x' || buf[i+1] == 'X'))
+		i += 2;
+	for (; i < length; i++, digits++) {
+		char c = buf[i];
+		if (c >= '0' && c <= '9')
+			var = (var << 4) | (c - '0');
+		else if (c >= 'a' && c <= 'f')
+			var = (var << 4) | (c - 'a' + 10);
+		else if (c >= 'A' && c <= 'F')
+			var = (var << 4) | (c - 'A' + 10);
+		else
+			break;
+	}
+	if (digits == 0)
+		return -1;
+	return var;
+}
+
+//Monotonic time in microseconds, used to timestamp samples and events
+unsigned long long getMonotonicTime(){
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//****************************************************************************
+// Class for delivering events from background threads
+//****************************************************************************
+
+/** @~english
+* @brief Creates a queue for 64 events.
+*
+* @~german
+* @brief Erzeugt eine Warteschlange für 64 Ereignisse.
+*/
+gnublin_event_queue::gnublin_event_queue(){
+	init(64);
+}
+
+/** @~english
+* @brief Creates a queue for the given number of events.
+*
+* @param size maximum number of queued events
+*
+* @~german
+* @brief Erzeugt eine Warteschlange für die angegebene Anzahl an Ereignissen.
+*
+* @param size maximale Anzahl eingereihter Ereignisse
+*/
+gnublin_event_queue::gnublin_event_queue(int size){
+	init(size > 0 ? size : 1);
+}
+
+gnublin_event_queue::~gnublin_event_queue(){
+	pthread_cond_destroy(&cond);
+	pthread_mutex_destroy(&mutex);
+	delete [] events;
+}
+
+void gnublin_event_queue::init(int size){
+	pthread_condattr_t attr;
+
+	this->size = size;
+	events = new gnublin_event[size];
+	first = 0;
+	count = 0;
+	dropped = 0;
+	callback = 0;
+	callback_arg = 0;
+	pthread_mutex_init(&mutex, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&cond, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+//-------------setCallback-------------
+/** @~english
+* @brief Set a callback which receives the events instead of the queue.
+*
+* The callback is called from the thread which detected the event, it should return quickly. NULL switches back to queueing.
+* @param callback function which is called for every event
+* @param arg user pointer passed to the callback
+*
+* @~german
+* @brief Setzt einen Callback, der die Ereignisse anstelle der Warteschlange erhält.
+*
+* Der Callback wird aus dem Thread aufgerufen, der das Ereignis erkannt hat, er sollte schnell zurückkehren. Mit NULL werden die Ereignisse wieder eingereiht.
+* @param callback Funktion, die für jedes Ereignis aufgerufen wird
+* @param arg Benutzerzeiger, der an den Callback übergeben wird
+*/
+void gnublin_event_queue::setCallback(gnublin_event_callback callback, void *arg){
+	pthread_mutex_lock(&mutex);
+	this->callback = callback;
+	callback_arg = arg;
+	pthread_mutex_unlock(&mutex);
+}
+
+//-------------push-------------
+/** @~english
+* @brief Deliver an event.
+*
+* @param event the event
+* @return success: 1, queue full (event dropped): -1
+*
+* @~german
+* @brief Liefert ein Ereignis aus.
+*
+* @param event das Ereignis
+* @return Erfolg: 1, Warteschlange voll (Ereignis verworfen): -1
+*/
+int gnublin_event_queue::push(const gnublin_event &event){
+	gnublin_event_callback cb;
+	void *arg;
+
+	pthread_mutex_lock(&mutex);
+	cb = callback;
+	arg = callback_arg;
+	if (!cb) {
+		if (count == size) {
+			dropped++;
+			pthread_mutex_unlock(&mutex);
+			return -1;
+		}
+		events[(first + count) % size] = event;
+		count++;
+		pthread_cond_signal(&cond);
+	}
+	pthread_mutex_unlock(&mutex);
+	if (cb)
+		cb(&event, arg);
+	return 1;
+}
+
+//-------------wait-------------
+/** @~english
+* @brief Wait for the next event.
+*
+* @param event the event is stored in it
+* @param timeout_ms maximum time to wait in ms, -1 waits forever
+* @return event received: 1, timeout: 0
+*
+* @~german
+* @brief Wartet auf das nächste Ereignis.
+*
+* @param event hier wird das Ereignis gespeichert
+* @param timeout_ms maximale Wartezeit in ms, -1 wartet unbegrenzt
+* @return Ereignis erhalten: 1, Zeitüberschreitung: 0
+*/
+int gnublin_event_queue::wait(gnublin_event *event, int timeout_ms){
+	struct timespec deadline;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += timeout_ms / 1000;
+	deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000) {
+		deadline.tv_nsec -= 1000000000;
+		deadline.tv_sec++;
+	}
+	pthread_mutex_lock(&mutex);
+	while (count == 0) {
+		if (timeout_ms < 0)
+			pthread_cond_wait(&cond, &mutex);
+		else if (pthread_cond_timedwait(&cond, &mutex, &deadline) == ETIMEDOUT)
+			break;
+	}
+	if (count == 0) {
+		pthread_mutex_unlock(&mutex);
+		return 0;
+	}
+	*event = events[first];
+	first = (first + 1) % size;
+	count--;
+	pthread_mutex_unlock(&mutex);
+	return 1;
+}
+
+//-------------poll-------------
+/** @~english
+* @brief Fetch the next event without waiting.
+*
+* @param event the event is stored in it
+* @return event received: 1, queue empty: 0
+*
+* @~german
+* @brief Holt das nächste Ereignis ab, ohne zu warten.
+*
+* @param event hier wird das Ereignis gespeichert
+* @return Ereignis erhalten: 1, Warteschlange leer: 0
+*/
+int gnublin_event_queue::poll(gnublin_event *event){
+	return wait(event, 0);
+}
+
+//-------------pending-------------
+/** @~english
+* @brief Number of queued events.
+*
+* @~german
+* @brief Anzahl der eingereihten Ereignisse.
+*/
+int gnublin_event_queue::pending(){
+	int n;
+
+	pthread_mutex_lock(&mutex);
+	n = count;
+	pthread_mutex_unlock(&mutex);
+	return n;
+}
+
+//-------------getDropped-------------
+/** @~english
+* @brief Number of events dropped because the queue was full.
+*
+* @~german
+* @brief Anzahl der verworfenen Ereignisse, weil die Warteschlange voll war.
+*/
+unsigned int gnublin_event_queue::getDropped(){
+	return dropped;
+}
+
 /** @~english 
 * @brief Reset the ErrorFlag.
 *
@@ -236,6 +466,251 @@ int gnublin_gpio::digitalRead(int pin) {
 }
 
 
+//****************************************************************************
+// Class for waiting on GPIO edges
+//****************************************************************************
+
+/** @~english
+* @brief Reset the ErrorFlag. The thread is started with the first watch().
+*
+* @~german
+* @brief Setzt das ErrorFlag zurück. Der Thread wird mit dem ersten watch() gestartet.
+*/
+gnublin_gpio_edge::gnublin_gpio_edge(){
+	count = 0;
+	wakeup_fd = eventfd(0, 0);
+	run_flag = false;
+	error_flag = false;
+	pthread_mutex_init(&mutex, NULL);
+}
+
+/** @~english
+* @brief Stops the thread and closes the value files.
+*
+* @~german
+* @brief Hält den Thread an und schließt die value Dateien.
+*/
+gnublin_gpio_edge::~gnublin_gpio_edge(){
+	if (run_flag) {
+		run_flag = false;
+		wakeup();
+		pthread_join(thread, NULL);
+	}
+	for (int i = 0; i < count; i++)
+		close(fds[i]);
+	close(wakeup_fd);
+	pthread_mutex_destroy(&mutex);
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_gpio_edge::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_gpio_edge::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+void gnublin_gpio_edge::wakeup(){
+	uint64_t one = 1;
+
+	if (write(wakeup_fd, &one, sizeof(one)) < 0)
+		error_flag = true;
+}
+
+//-------------watch-------------
+/** @~english
+* @brief Watch a pin for edges.
+*
+* The pin is exported and set as input.
+* @param pin GPIO pin number
+* @param edge "rising", "falling" or "both"
+* @param queue the events of this pin are delivered to it
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Überwacht einen Pin auf Flanken.
+*
+* Der Pin wird exportiert und als Eingang gesetzt.
+* @param pin GPIO Pin Nummer
+* @param edge "rising", "falling" oder "both"
+* @param queue hierhin werden die Ereignisse dieses Pins geliefert
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_gpio_edge::watch(int pin, std::string edge, gnublin_event_queue *queue){
+	std::string dir = "/sys/class/gpio/gpio" + numberToString(pin);
+	char value;
+	int fd;
+
+	if (edge != "rising" && edge != "falling" && edge != "both") {
+		ErrorMessage = "edge != rising/falling/both\n";
+		error_flag = true;
+		return -1;
+	}
+	unwatch(pin);
+	if (count == GPIO_EDGE_MAX_PINS) {
+		ErrorMessage = "too many pins watched\n";
+		error_flag = true;
+		return -1;
+	}
+
+	// exporting fails if the pin is already exported, that's fine
+	std::ofstream file("/sys/class/gpio/export");
+	file << pin;
+	file.close();
+	file.clear();
+	file.open((dir + "/direction").c_str());
+	file << "in";
+	file.close();
+	file.clear();
+	file.open((dir + "/edge").c_str());
+	file << edge;
+	file.close();
+	if (file.fail() || (fd = open((dir + "/value").c_str(), O_RDONLY)) < 0) {
+		ErrorMessage = "ERROR setting up edge on gpio" + numberToString(pin) + "\n";
+		error_flag = true;
+		return -1;
+	}
+	// the first read clears the pending state
+	if (read(fd, &value, 1) < 0)
+		value = 0;
+
+	pthread_mutex_lock(&mutex);
+	pins[count] = pin;
+	fds[count] = fd;
+	queues[count] = queue;
+	count++;
+	pthread_mutex_unlock(&mutex);
+
+	if (!run_flag) {
+		run_flag = true;
+		if (pthread_create(&thread, NULL, run, this) != 0) {
+			run_flag = false;
+			ErrorMessage = "could not create edge thread\n";
+			error_flag = true;
+			return -1;
+		}
+	}
+	else
+		wakeup();
+	error_flag = false;
+	return 1;
+}
+
+//-------------unwatch-------------
+/** @~english
+* @brief Stop watching a pin.
+*
+* @param pin GPIO pin number
+* @return success: 1, pin wasn't watched: -1
+*
+* @~german
+* @brief Beendet die Überwachung eines Pins.
+*
+* @param pin GPIO Pin Nummer
+* @return Erfolg: 1, Pin wurde nicht überwacht: -1
+*/
+int gnublin_gpio_edge::unwatch(int pin){
+	int result = -1;
+
+	pthread_mutex_lock(&mutex);
+	for (int i = 0; i < count; i++) {
+		if (pins[i] != pin)
+			continue;
+		close(fds[i]);
+		count--;
+		pins[i] = pins[count];
+		fds[i] = fds[count];
+		queues[i] = queues[count];
+		result = 1;
+		break;
+	}
+	pthread_mutex_unlock(&mutex);
+	if (result > 0 && run_flag)
+		wakeup();
+	return result;
+}
+
+void *gnublin_gpio_edge::run(void *arg){
+	gnublin_gpio_edge *self = (gnublin_gpio_edge *)arg;
+	struct pollfd pfd[GPIO_EDGE_MAX_PINS + 1];
+	gnublin_event events[GPIO_EDGE_MAX_PINS];
+	gnublin_event_queue *targets[GPIO_EDGE_MAX_PINS];
+	uint64_t counter;
+	int n;
+
+	while (self->run_flag) {
+		pthread_mutex_lock(&self->mutex);
+		n = self->count;
+		for (int i = 0; i < n; i++) {
+			pfd[i].fd = self->fds[i];
+			pfd[i].events = POLLPRI | POLLERR;
+			pfd[i].revents = 0;
+		}
+		pthread_mutex_unlock(&self->mutex);
+		pfd[n].fd = self->wakeup_fd;
+		pfd[n].events = POLLIN;
+		pfd[n].revents = 0;
+
+		if (poll(pfd, n + 1, -1) <= 0)
+			continue;
+		if (pfd[n].revents & POLLIN) {
+			// the pin list changed, the fds of this round may be stale
+			if (read(self->wakeup_fd, &counter, sizeof(counter)) < 0)
+				self->error_flag = true;
+			continue;
+		}
+
+		int found = 0;
+		unsigned long long now = getMonotonicTime();
+		pthread_mutex_lock(&self->mutex);
+		for (int i = 0; i < n && i < self->count; i++) {
+			char value;
+			if (!(pfd[i].revents & (POLLPRI | POLLERR)) || self->fds[i] != pfd[i].fd)
+				continue;
+			if (pread(pfd[i].fd, &value, 1, 0) != 1)
+				continue;
+			events[found].type = EVENT_GPIO_EDGE;
+			events[found].device = 0;
+			events[found].source = self->pins[i];
+			events[found].value = value == '1';
+			events[found].timestamp = now;
+			targets[found] = self->queues[i];
+			found++;
+		}
+		pthread_mutex_unlock(&self->mutex);
+		// delivered without the lock, a callback may call watch()/unwatch()
+		for (int i = 0; i < found; i++)
+			targets[i]->push(events[i]);
+	}
+	return NULL;
+}
+
 //*******************************************************************
 //Class for accessing GNUBLIN i2c Bus
 //*******************************************************************
@@ -252,6 +727,7 @@ gnublin_i2c::gnublin_i2c()
 {
 	devicefile="/dev/i2c-1";
 	error_flag=false;
+	transactions=0;
 }
 
 //-------------------------------Fail-------------------------------
@@ -363,6 +839,7 @@ void gnublin_i2c::setDevicefile(std::string filename){
 */
 int gnublin_i2c::receive(unsigned char *RxBuf, int length){
 	error_flag=false;
+	transactions++;
 	int fd;
 
 
@@ -424,6 +901,7 @@ int gnublin_i2c::receive(unsigned char *RxBuf, int length){
 */
 int gnublin_i2c::receive(unsigned char RegisterAddress, unsigned char *RxBuf, int length){
 	error_flag=false;	
+	transactions++;
 	int fd;
 
 	if ((fd = open(devicefile.c_str(), O_RDWR)) < 0) {
@@ -484,6 +962,7 @@ int gnublin_i2c::receive(unsigned char RegisterAddress, unsigned char *RxBuf, in
 */
 int gnublin_i2c::send(unsigned char *TxBuf, int length){
 	error_flag=false;	
+	transactions++;
 	int fd; 
 
 	if ((fd = open(devicefile.c_str(), O_RDWR)) < 0) {
@@ -544,6 +1023,7 @@ int gnublin_i2c::send(unsigned char *TxBuf, int length){
 */
 int gnublin_i2c::send(unsigned char RegisterAddress, unsigned char *TxBuf, int length){
 	error_flag=false;	
+	transactions++;
 	int fd, i;
 	unsigned char data[length+1];
 	data[0]=RegisterAddress;
@@ -601,6 +1081,7 @@ int gnublin_i2c::send(unsigned char RegisterAddress, unsigned char *TxBuf, int l
 */
 int gnublin_i2c::send(int value){
 	error_flag=false;
+	transactions++;
 	int buffer[1];
 	buffer[0]=value;	
 	int fd; 
@@ -630,6 +1111,83 @@ int gnublin_i2c::send(int value){
 	return 1;
 }
 
+//----------------------------------transfer----------------------------------
+/** @~english 
+* @brief execute several messages as one combined I2C transaction.
+*
+* All messages are passed to the kernel with one I2C_RDWR ioctl, so they are separated by repeated starts instead of stop conditions and the bus is not released in between.
+* The slave address of every message is taken from msgs[i].addr, so one transaction can address several devices on the bus.<br>
+* e.g.<br>
+* write the register pointer 0x00 and read 2 bytes back<br>
+* unsigned char reg = 0x00, buf[2];<br>
+* struct i2c_msg msgs[2] = {{0x48, 0, 1, &reg}, {0x48, I2C_M_RD, 2, buf}};<br>
+* transfer(msgs, 2);
+* @param msgs array of messages
+* @param count number of messages (1-42)
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief führt mehrere Nachrichten als eine kombinierte I2C Transaktion aus.
+*
+* Alle Nachrichten werden mit einem I2C_RDWR ioctl an den Kernel übergeben, sie werden also durch Repeated Starts statt Stop Bedingungen getrennt und der Bus wird dazwischen nicht freigegeben.
+* Die Slave Adresse jeder Nachricht wird aus msgs[i].addr genommen, so kann eine Transaktion mehrere Geräte am Bus ansprechen.<br>
+* Beispiel:<br>
+* Registerzeiger 0x00 schreiben und 2 Bytes zurücklesen<br>
+* unsigned char reg = 0x00, buf[2];<br>
+* struct i2c_msg msgs[2] = {{0x48, 0, 1, &reg}, {0x48, I2C_M_RD, 2, buf}};<br>
+* transfer(msgs, 2);
+* @param msgs Array von Nachrichten
+* @param count Anzahl der Nachrichten (1-42)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_i2c::transfer(struct i2c_msg *msgs, int count){
+	error_flag=false;
+	transactions++;
+	struct i2c_rdwr_ioctl_data data;
+	int fd;
+
+	if (count < 1 || count > I2C_TRANSFER_MAX_MSGS) {
+		ErrorMessage="message count is not between 1-42\n";
+		error_flag=true;
+		return -1;
+	}
+
+	if ((fd = open(devicefile.c_str(), O_RDWR)) < 0) {
+		ErrorMessage="ERROR opening: " + devicefile + "\n";
+		error_flag=true;
+		return -1;
+	}
+
+	data.msgs = msgs;
+	data.nmsgs = count;
+	if (ioctl(fd, I2C_RDWR, &data) != count) {
+		ErrorMessage="i2c transfer error! dev file: " + devicefile + "\n";
+		error_flag=true;
+		close(fd);
+		return -1;
+	}
+
+	close(fd);
+	return 1;
+}
+
+//----------------------------------getTransactions----------------------------------
+/** @~english 
+* @brief returns the number of bus transactions.
+*
+* Every call of send(), receive() and transfer() counts as one transaction, also if it fails.
+* @return number of transactions since the object was created
+*
+* @~german 
+* @brief gibt die Anzahl der Bus Transaktionen zurück.
+*
+* Jeder Aufruf von send(), receive() und transfer() zählt als eine Transaktion, auch wenn er fehlschlägt.
+* @return Anzahl der Transaktionen seit der Erzeugung des Objekts
+*/
+unsigned int gnublin_i2c::getTransactions(){
+	return transactions;
+}
+
 
 //***************************************************************************
 // Class for accessing the SPI-Bus
@@ -1058,22 +1616,74 @@ int gnublin_spi::message(unsigned char* tx, int tx_length, unsigned char* rx, in
 // Class for easy acces to the GPAs
 //****************************************************************************
 /** @~english 
-* @brief Opens the file stream and loads the kernel object lpc313x_adc.
+* @brief Loads the kernel object lpc313x_adc if the device file is missing.
+*
+* The device file itself is opened on the first call of getValue() and stays open.
 *
 * @~german 
-* @brief Erzeugt den Datei stream und lädt das Kernelmodul lpc313x_adc.
+* @brief Lädt das Kernelmodul lpc313x_adc, falls die Gerätedatei fehlt.
+*
+* Die Gerätedatei selbst wird beim ersten Aufruf von getValue() geöffnet und bleibt geöffnet.
 *
 */
-gnublin_adc::gnublin_adc(){
-	std::ifstream file("/dev/lpc313x_adc");
+gnublin_adc::gnublin_adc() : calibration(1024, 3300) {
+	devicefile = "/dev/lpc313x_adc";
+	std::ifstream file(devicefile.c_str());
 	if (file.fail()) {
 		system("modprobe lpc313x_adc");
 		sleep(1);
 	}
 	file.close();
+	fd = -1;
+	channel = -1;
 	error_flag = false;
 }
 
+/** @~english 
+* @brief Closes the device file.
+*
+* @~german 
+* @brief Schließt die Gerätedatei.
+*
+*/
+gnublin_adc::~gnublin_adc(){
+	if (fd >= 0)
+		close(fd);
+}
+
+//-------------setDevicefile-------------
+/** @~english 
+* @brief Set devicefile.
+*
+* With this function you can change the ADC device file. Default is "/dev/lpc313x_adc"
+* @param filename path to the ADC device file
+*
+* @~german 
+* @brief Setzt Device Datei.
+*
+* Mit dieser Funktion kann die ADC Gerätedatei geändert werden. Standardmäßig wird "/dev/lpc313x_adc" benutzt.
+* @param filename Pfad zur ADC Gerätedatei
+*/
+void gnublin_adc::setDevicefile(std::string filename){
+	if (fd >= 0)
+		close(fd);
+	fd = -1;
+	channel = -1;
+	devicefile = filename;
+}
+
+//-------------openDevice-------------
+// opens the device file once, it is kept open for all following samples
+int gnublin_adc::openDevice(){
+	if ((fd = open(devicefile.c_str(), O_RDWR)) < 0) {
+		ErrorMessage = "ERROR opening: " + devicefile + "\n";
+		error_flag = true;
+		return -1;
+	}
+	channel = -1;
+	return 1;
+}
+
 //-------------fail-------------
 /** @~english 
 * @brief Returns the error flag. 
@@ -1126,368 +1736,401 @@ const char *gnublin_adc::getErrorMessage(){
 * @return Wert des ADCs, im Fehlerfall -1
 */
 int gnublin_adc::getValue(int pin){
-	std::string value;
-	
-	std::string pin_str = numberToString(pin);
-	std::string device = "/dev/lpc313x_adc";
-	std::ofstream file(device.c_str());
-	if (file < 0) {
-		error_flag = true;
+	char buffer[16];
+	int length, value;
+
+	if (fd < 0 && openDevice() < 0)
 		return -1;
-	}
-	file << pin_str;
-	file.close();
-	std::ifstream dev_file(device.c_str());
-	dev_file >> value;
-	dev_file.close();
+
+	// the channel is only selected if it differs from the last one
+	if (pin != channel) {
+		length = snprintf(buffer, sizeof(buffer), "%d", pin);
+		if (pwrite(fd, buffer, length, 0) != length && (errno != ESPIPE || write(fd, buffer, length) != length)) {
+			ErrorMessage = "ERROR selecting channel on: " + devicefile + "\n";
+			error_flag = true;
+			channel = -1;
+			return -1;
+		}
+		channel = pin;
+	}
+
+	length = pread(fd, buffer, sizeof(buffer), 0);
+	if (length < 0 && errno == ESPIPE)
+		length = read(fd, buffer, sizeof(buffer));
+	if (length <= 0) {
+		ErrorMessage = "ERROR reading: " + devicefile + "\n";
+		error_flag = true;
+		return -1;
+	}
+	value = hexbufferToNumber(buffer, length);
+	if (value < 0) {
+		ErrorMessage = "ERROR parsing the value of: " + devicefile + "\n";
+		error_flag = true;
+		return -1;
+	}
 	error_flag = false;
-	return hexstringToNumber(value);
+	return value;
 }
 
 //-------------getVoltage-------------
 /** @~english 
 * @brief Get Voltage.
 *
-* This Funktion returns the Voltage of the given pin.
+* This Funktion returns the Voltage of the given pin, using the calibration of the pin (default: reference 3300 mV, no offset, gain 1).
 * @param pin The pin, which should be used
 * @return Voltage of the Pin - in failure: -1
 *
 * @~german 
 * @brief Ließt Spannung.
 *
-* Liefert den gemessenen Wert in mV. 
+* Liefert den gemessenen Wert in mV, umgerechnet mit der Kalibrierung des Pins (Standard: Referenz 3300 mV, kein Offset, Verstärkung 1). 
 * @param pin Gibt den ADC-Pin an, von dem gemessen werden soll 
 * @return Spannung des ADCs in mV, im Fehlerfall -1
 */
 int gnublin_adc::getVoltage(int pin){
 	int value = getValue(pin);
-	value = value*825/256;
-	return value;
+	if (value < 0)
+		return -1;
+	return calibration.toMillivolt(pin, value);
 }
 
 //-------------setReference-------------
 /** @~english 
 * @brief set Reference.
 *
-* @param ref 
+* Sets the reference voltage of all pins, which is used by getVoltage().
+* @param ref reference voltage in mV (1-5000)
 * @return success: 1, failure: -1
 *
 * @~german 
 * @brief setzt Referenz.
 *
-* @param ref 
+* Setzt die Referenzspannung aller Pins, die von getVoltage() benutzt wird.
+* @param ref Referenzspannung in mV (1-5000)
 * @return Erfolg: 1, Fehler: -1
 */
 int gnublin_adc::setReference(int ref){
+	if (calibration.setReference(ref) < 0) {
+		ErrorMessage = calibration.getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
 	error_flag = false;
 	return 1;
 }
 
-
-
-#endif
-
-//***************************************************************************
-// Class for accesing the GNUBLIN MODULE-DISPLAY 2x16
-//***************************************************************************
-
-
-//********** Constructor ***************************
-
-/**
-* @~english
-* @brief Set the default RS-PIN
+//-------------setCalibration-------------
+/** @~english 
+* @brief set the calibration of a pin.
 *
-* Default RS-Pin:
-* GNUBLIN: GPIO14
-* RASPBERRY PI: GPIO4
+* @param pin ADC pin (0-8)
+* @param offset offset in LSB, added to the raw value
+* @param gain_ppm gain in parts per million, 1000000 = 1.0
+* @param reference reference voltage in mV
+* @return success: 1, failure: -1
 *
-* @~german
-* @brief Setzt die standard RS-Pins
+* @~german 
+* @brief setzt die Kalibrierung eines Pins.
 *
-* Standard RS-Pin:
-* GNUBLIN: GPIO14
-* RASPBERRY PI: GPIO4
+* @param pin ADC-Pin (0-8)
+* @param offset Offset in LSB, wird zum Rohwert addiert
+* @param gain_ppm Verstärkung in millionstel, 1000000 = 1,0
+* @param reference Referenzspannung in mV
+* @return Erfolg: 1, Fehler: -1
 */
-gnublin_module_dogm::gnublin_module_dogm(){
-
-#if (BOARD == RASPBERRY_PI)
-	rs_pin = 4;
-#else
-	rs_pin = 14;
-#endif
-	gpio.pinMode(rs_pin, OUTPUT);
-	init_flag = false;
-	error_flag = false;	
+int gnublin_adc::setCalibration(int pin, int offset, int gain_ppm, int reference){
+	if (calibration.setChannel(pin, offset, gain_ppm, reference) < 0) {
+		ErrorMessage = calibration.getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
 }
 
-//********* init()**********************************
-// execute initialisation of the display
-// parameters: 	NONE
-// return: 	* [int] 1	for success
-//		* [int] -1  	for failure
-
-/**
-* @~english
-* @brief Initialisizes the Display
+//-------------loadCalibration-------------
+/** @~english 
+* @brief load the calibration of the pins from a file.
 *
-* @return 1 by success, -1 by failure
+* Every line contains "pin offset gain reference", e.g. "1 -2 1.0031 3300".
+* @param filename path of the calibration file
+* @return success: 1, failure: -1
 *
-* @~german
-* @brief Initialisiert das Display
+* @~german 
+* @brief lädt die Kalibrierung der Pins aus einer Datei.
 *
-* @return 1 bei Erfolg, -1 im Fehlerfall
+* Jede Zeile enthält "Pin Offset Verstärkung Referenz", z.B. "1 -2 1.0031 3300".
+* @param filename Pfad zur Kalibrierungsdatei
+* @return Erfolg: 1, Fehler: -1
 */
-int gnublin_module_dogm::init(){
-	__u8 init_str[] = {0x39, 0x14, 0x55, 0x6D, 0x78, 0x38, 0x0C, 0x01, 0x06};
-	if (gpio.digitalWrite(rs_pin, LOW) <0){
-			error_flag = true;
-			return -1;
-	}
-	spi.setSpeed(100000);
-	if (spi.send(init_str, 9) < 0){
+int gnublin_adc::loadCalibration(std::string filename){
+	if (calibration.load(filename) < 0) {
+		ErrorMessage = calibration.getErrorMessage();
 		error_flag = true;
 		return -1;
 	}
-	init_flag = true;
 	error_flag = false;
 	return 1;
 }
 
+//-------------getCalibration-------------
+/** @~english 
+* @brief get the calibration, e.g. to convert whole blocks of samples to mV.
+*
+* @return pointer to the calibration of this ADC
+*
+* @~german 
+* @brief gibt die Kalibrierung zurück, z.B. um ganze Blöcke von Werten in mV umzurechnen.
+*
+* @return Zeiger auf die Kalibrierung dieses ADCs
+*/
+gnublin_adc_calibration *gnublin_adc::getCalibration(){
+	return &calibration;
+}
 
-//************ fail() *******************************
+#endif
 
-/**
-* @~english
-* @brief Returns the errorflag to detect error in the previous called method.
+//****************************************************************************
+// Class for continuous sampling of the GPAs or the GNUBLIN Module-ADC
+//****************************************************************************
+
+#if (BOARD != RASPBERRY_PI)
+/** @~english
+* @brief Create a sampler for the GPAs of the GNUBLIN board.
 *
-* @return error_flag
+* Default: no channels, 100 scans per second, 1024 samples buffer.
+* @param adc the gnublin_adc which should be sampled
 *
 * @~german
-* @brief Gibt das errorflag zurück, um Fehler in der zuvor aufgerugfenen Methode zu erkennen.
+* @brief Erzeugt einen Sampler für die GPAs des GNUBLIN Boards.
 *
-* @return error_flag
+* Standard: keine Kanäle, 100 Abtastungen pro Sekunde, Puffer für 1024 Werte.
+* @param adc der gnublin_adc, der abgetastet werden soll
 */
-bool gnublin_module_dogm::fail(){
-	return error_flag;
+gnublin_adc_sampler::gnublin_adc_sampler(gnublin_adc *adc){
+	init();
+	this->adc = adc;
 }
+#endif
 
-
-//-------------get Error Message-------------
-/**
-* @~english
-* @brief Returns the ErrorMessage of the previous error if one exist.
+/** @~english
+* @brief Create a sampler for the GNUBLIN Module-ADC.
 *
-* @return ErrorMessage as C-String
+* Default: no channels, 100 scans per second, 1024 samples buffer.
+* @param adc the gnublin_module_adc which should be sampled
 *
 * @~german
-* @brief Gibt die Fehlernachricht des zuvor aufgetretenen Fehlers zurück, wenn weine exisitert.
+* @brief Erzeugt einen Sampler für das GNUBLIN Module-ADC.
 *
-* @return ErrorMessage als C-String
+* Standard: keine Kanäle, 100 Abtastungen pro Sekunde, Puffer für 1024 Werte.
+* @param adc das gnublin_module_adc, das abgetastet werden soll
 */
-const char *gnublin_module_dogm::getErrorMessage(){
-	return ErrorMessage.c_str();
+gnublin_adc_sampler::gnublin_adc_sampler(gnublin_module_adc *adc){
+	init();
+	module_adc = adc;
 }
 
+/** @~english
+* @brief Stops the sampling thread and frees the buffer.
+*
+* @~german
+* @brief Hält den Abtast-Thread an und gibt den Puffer frei.
+*/
+gnublin_adc_sampler::~gnublin_adc_sampler(){
+	stop();
+	delete [] ring;
+	if (wakeup_fd >= 0)
+		close(wakeup_fd);
+}
+
+void gnublin_adc_sampler::init(){
+	adc = 0;
+	module_adc = 0;
+	comparator = 0;
+	channel_count = 0;
+	period_ns = 10000000;
+	ring = 0;
+	ring_mask = 0;
+	head = 0;
+	tail = 0;
+	reader_waiting = 0;
+	overruns = 0;
+	read_errors = 0;
+	run_flag = false;
+	error_flag = false;
+	memset(latest, 0, sizeof(latest));
+	memset((void *)latest_seq, 0, sizeof(latest_seq));
+	wakeup_fd = eventfd(0, 0);
+	setBufferSize(1024);
+}
 
-//*********** setRsPin() *****************************
-
-/**
-* @~english
-* @brief Set the custom RS pin
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
 *
-* @param pin Number of the RS-pin
-* @return 1 by success, -1 by failure
+* If something went wrong, the flag is true.
+* @return bool error_flag
 *
 * @~german
-* @brief Setzt den benutzerdefinierten RS-Pin.
+* @brief Gibt das Error Flag zurück.
 *
-* @param pin Nummer des RS-Pin
-* @return 1 bei Erfolg, -1 im Fehlerfall
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
 */
-int gnublin_module_dogm::setRsPin(int pin){
-	rs_pin = pin;
-	gpio.pinMode(rs_pin, OUTPUT);
-	return 1;
+bool gnublin_adc_sampler::fail(){
+	return error_flag;
 }
 
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_adc_sampler::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
 
-//*********** setCS ************************************
-
-/**
-* @~english
-* @brief Set the custom chipselect pin
+//-------------setChannels-------------
+/** @~english
+* @brief Set the channel list.
 *
-* @param cs Number of the chipselect-pin
-* @return 1 by success, -1 by failure
+* The channels are scanned in the given order. Can only be changed while the sampler is stopped.
+* @param channels array of channel numbers (as used by getValue() of the ADC class)
+* @param count number of channels (1-8)
+* @return success: 1, failure: -1
 *
 * @~german
-* @brief Setzt den benutzerdefinierten Chipselect-Pin.
+* @brief Setzt die Kanalliste.
 *
-* @param cs Nummer des Chipselect-Pin
-* @return 1 bei Erfolg, -1 im Fehlerfall
+* Die Kanäle werden in der angegebenen Reihenfolge abgetastet. Kann nur bei angehaltenem Sampler geändert werden.
+* @param channels Array mit Kanalnummern (wie bei getValue() der ADC Klasse)
+* @param count Anzahl der Kanäle (1-8)
+* @return Erfolg: 1, Fehler: -1
 */
-int gnublin_module_dogm::setCS(int cs){
-	if (spi.setCS(cs) < 0){
+int gnublin_adc_sampler::setChannels(const int *channels, int count){
+	if (run_flag) {
+		ErrorMessage = "sampler is running\n";
+		error_flag = true;
+		return -1;
+	}
+	if (count < 1 || count > ADC_SAMPLER_MAX_CHANNELS) {
+		ErrorMessage = "channel count is not between 1-8\n";
 		error_flag = true;
 		return -1;
 	}
+	for (int i = 0; i < count; i++)
+		this->channels[i] = channels[i];
+	channel_count = count;
 	error_flag = false;
 	return 1;
 }
 
-
-//************ print() **********************************
-
-/**
-* @~english
-* @brief Print string on display
+//-------------setRate-------------
+/** @~english
+* @brief Set the scan rate.
 *
-* @param buffer buffor of the string
-* @return 1 by success, -1 by failure
+* @param hz scans of the whole channel list per second
+* @return success: 1, failure: -1
 *
 * @~german
-* @brief Schreibt String auf das Display
+* @brief Setzt die Abtastrate.
 *
-* @param buffer Buffer für den String
-* @return 1 bei Erfolg, -1 im Fehlerfall
+* @param hz Abtastungen der ganzen Kanalliste pro Sekunde
+* @return Erfolg: 1, Fehler: -1
 */
-int gnublin_module_dogm::print(char* buffer){
-	__u8 tmp[32];
-	int len = strlen(buffer);
-	if(!init_flag){
-		init();
-	}
-	for(int i=0; i<len; i++){
-		tmp[i] = buffer[i];
-	}
-	gpio.digitalWrite(rs_pin, HIGH);
-	if (spi.send(tmp, len) < 0){
-		gpio.digitalWrite(rs_pin, LOW);
+int gnublin_adc_sampler::setRate(int hz){
+	if (hz < 1 || hz > 100000) {
+		ErrorMessage = "rate is not between 1-100000 Hz\n";
 		error_flag = true;
 		return -1;
 	}
-	gpio.digitalWrite(rs_pin, LOW);
+	period_ns = 1000000000 / hz;
 	error_flag = false;
 	return 1;
 }
 
-
-//************ print() **********************************
-
-/**
-* @~english
-* @brief Print string on a specific line of the display
+//-------------setBufferSize-------------
+/** @~english
+* @brief Set the size of the ring buffer.
 *
-* @param buffer buffor of the string
-* @param line number of the line (1,2)
-* @return 1 by success, -1 by failure
+* The size is rounded up to the next power of two. Can only be changed while the sampler is stopped.
+* @param size number of samples
+* @return success: 1, failure: -1
 *
 * @~german
-* @brief Schreibt String in eine bestimmte Zeile des Displays
+* @brief Setzt die Größe des Ringpuffers.
 *
-* @param buffer Buffer für den String
-* @param line Zeilenenummer (1,2)
-* @return 1 bei Erfolg, -1 im Fehlerfall
+* Die Größe wird auf die nächste Zweierpotenz aufgerundet. Kann nur bei angehaltenem Sampler geändert werden.
+* @param size Anzahl der Werte
+* @return Erfolg: 1, Fehler: -1
 */
-int gnublin_module_dogm::print(char* buffer, int line){
-	error_flag = false;
-	if(!init_flag){
-		init();
-	}
-	if (returnHome() < 0){
-		return -1;
-	}
-	if (line == 1){
-		print(buffer);
-	}
-	else if (line == 2) {
-		offset(16);
-		print(buffer);
-	}
-	else {
+int gnublin_adc_sampler::setBufferSize(int size){
+	unsigned int capacity = 2;
+
+	if (run_flag || size < 2 || size > (1 << 20)) {
+		ErrorMessage = "buffer size can't be changed\n";
 		error_flag = true;
 		return -1;
 	}
-	return -1;
+	while (capacity < (unsigned int)size)
+		capacity <<= 1;
+	delete [] ring;
+	ring = new gnublin_adc_sample[capacity];
+	ring_mask = capacity - 1;
+	head = 0;
+	tail = 0;
+	error_flag = false;
+	return 1;
 }
 
-
-//************ print() **********************************
-
-/**
-* @~english
-* @brief Print string on a specific line with given offset on the display
+//-------------setComparator-------------
+/** @~english
+* @brief Attach a window comparator which checks every sample.
 *
-* @param buffer buffor of the string
-* @param line number of the line (1,2)
-* @param off number of elements for the offset
-* @return 1 by success, -1 by failure
+* Should be set before start(). NULL removes the comparator.
+* @param comparator the comparator
 *
 * @~german
-* @brief Schreibt String in eine bestimmte Zeile mit gegebenem Offset auf das Displays
+* @brief Hängt einen Fensterkomparator an, der jeden Wert prüft.
 *
-* @param buffer Buffer für den String
-* @param line Zeilenenummer (1,2)
-* @param off Anzahl der Positionen, um die verschoben werden soll
-* @return 1 bei Erfolg, -1 im Fehlerfall
+* Sollte vor start() gesetzt werden. NULL entfernt den Komparator.
+* @param comparator der Komparator
 */
-int gnublin_module_dogm::print(char* buffer, int line, int off){
-	error_flag = false;
-	if(!init_flag){
-		init();
-	}
-	returnHome();
-	if (line == 1){
-		offset(off);
-		print(buffer);
-	}
-	else if (line == 2) {
-		off +=16;
-		offset(off);
-		print(buffer);
-	}
-	else {
-		error_flag = true;
-		return -1;
-	}
-	return -1;
+void gnublin_adc_sampler::setComparator(gnublin_adc_comparator *comparator){
+	this->comparator = comparator;
 }
 
-
-//****************** offset() **********************************
-
-/**
-* @~english
-* @brief Set an offset to the display
+//-------------start-------------
+/** @~english
+* @brief Start the sampling thread.
 *
-* @param num Number of the element on which the cursor will be set
-* @return 1 by success, -1 by failure
+* @return success: 1, failure: -1
 *
 * @~german
-* @brief Setzt den Cursor an eine bestimmte Position
+* @brief Startet den Abtast-Thread.
 *
-* @param num Nummber der Zeichnposition an die der Cursor gesetzt werden soll
-* @return 1 bei Erfolg, -1 im Fehlerfall
+* @return Erfolg: 1, Fehler: -1
 */
-int gnublin_module_dogm::offset(int num){
-	__u8 tmp;
-	if(!init_flag){
-		char init_str[2] = " ";
-		init();
-		print(init_str);
-	}
-	if (num >= 0 && num < 16){
-		tmp = num + 128;
-	}
-	else if (num >= 16 && num < 32){
-		tmp = num - 16 + 192;
-	}
-	else {
+int gnublin_adc_sampler::start(){
+	if (run_flag)
+		return 1;
+	if (channel_count == 0) {
+		ErrorMessage = "no channels set\n";
 		error_flag = true;
 		return -1;
 	}
-	if (spi.send(&tmp, 1) < 0){
+	run_flag = true;
+	if (pthread_create(&thread, NULL, run, this) != 0) {
+		run_flag = false;
+		ErrorMessage = "could not create sampling thread\n";
 		error_flag = true;
 		return -1;
 	}
@@ -1495,2041 +2138,9059 @@ int gnublin_module_dogm::offset(int num){
 	return 1;
 }
 
-
-//*************** clear() ****************************************
-
-/**
-* @~english
-* @brief clear the display
+//-------------stop-------------
+/** @~english
+* @brief Stop the sampling thread.
 *
-* @return 1 by success, -1 by failure
+* Samples in the buffer stay readable.
 *
 * @~german
-* @brief Löscht den Inhalt des Displays.
+* @brief Hält den Abtast-Thread an.
 *
-* @return 1 bei Erfolg, -1 im Fehlerfall
+* Werte im Puffer können weiterhin gelesen werden.
 */
-int gnublin_module_dogm::clear(){
-	__u8 clear_cmd = 0x01;
-	if(!init_flag){
-		init();
-	}
-	if (spi.send(&clear_cmd, 1) < 0){
+void gnublin_adc_sampler::stop(){
+	uint64_t one = 1;
+
+	if (!run_flag)
+		return;
+	run_flag = false;
+	pthread_join(thread, NULL);
+	// wake up a reader which is blocked in read()
+	if (write(wakeup_fd, &one, sizeof(one)) < 0)
 		error_flag = true;
-		return -1;
-	}
-	return 1;
 }
 
-
-//**************** returnHome() ************************************
-
-/**
-* @~english
-* @brief Reset the Display
-*
-* @return 1 by success, -1 by failure
+//-------------running-------------
+/** @~english
+* @brief Returns true while the sampling thread is running.
 *
 * @~german
-* @brief Resetet das Display.
-*
-* @return 1 bei Erfolg, -1 im Fehlerfall
+* @brief Gibt true zurück, solange der Abtast-Thread läuft.
 */
-int gnublin_module_dogm::returnHome(){
-	__u8 return_cmd = 0x02;
-	if(!init_flag){
-		init();
+bool gnublin_adc_sampler::running(){
+	return run_flag;
+}
+
+void *gnublin_adc_sampler::run(void *arg){
+	gnublin_adc_sampler *sampler = (gnublin_adc_sampler *)arg;
+	struct timespec next;
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	while (sampler->run_flag) {
+		sampler->scan();
+		// absolute deadlines, so the rate doesn't drift with the scan time
+		next.tv_nsec += sampler->period_ns;
+		while (next.tv_nsec >= 1000000000) {
+			next.tv_nsec -= 1000000000;
+			next.tv_sec++;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
 	}
-	if (spi.send(&return_cmd, 1) < 0){
-		error_flag = true;
-		return -1;
+	return NULL;
+}
+
+int gnublin_adc_sampler::readChannel(int channel){
+#if (BOARD != RASPBERRY_PI)
+	if (adc)
+		return adc->getValue(channel);
+#endif
+	return module_adc->getValue(channel);
+}
+
+void gnublin_adc_sampler::scan(){
+	gnublin_adc_sample sample;
+	int values[MODULE_ADC_CHANNELS];
+	uint64_t one = 1;
+
+	// the module is read with one I2C transaction per scan, the GPAs one by one
+	if (module_adc) {
+		int mask = 0;
+		for (int i = 0; i < channel_count; i++)
+			if (channels[i] >= 1 && channels[i] <= MODULE_ADC_CHANNELS)
+				mask |= 1 << (channels[i] - 1);
+		for (int i = 0; i < MODULE_ADC_CHANNELS; i++)
+			values[i] = -1;
+		if (mask)
+			module_adc->scan(mask, values);
+		sample.timestamp = getMonotonicTime();
+	}
+
+	for (int i = 0; i < channel_count; i++) {
+		sample.channel = channels[i];
+		if (module_adc) {
+			bool valid = channels[i] >= 1 && channels[i] <= MODULE_ADC_CHANNELS;
+			sample.value = valid ? values[channels[i] - 1] : -1;
+		}
+		else {
+			sample.value = readChannel(channels[i]);
+			sample.timestamp = getMonotonicTime();
+		}
+		if (sample.value < 0) {
+			read_errors++;
+			continue;
+		}
+		latest_seq[i]++;
+		__sync_synchronize();
+		latest[i] = sample;
+		__sync_synchronize();
+		latest_seq[i]++;
+		push(sample);
+		if (comparator)
+			comparator->check(sample);
 	}
-	return 1;
-}	
+	__sync_synchronize();
+	if (reader_waiting)
+		if (write(wakeup_fd, &one, sizeof(one)) < 0)
+			read_errors++;
+}
 
+void gnublin_adc_sampler::push(const gnublin_adc_sample &sample){
+	unsigned int h = head;
 
-//**************** shift() *****************************************
+	if (h - tail > ring_mask) {
+		overruns++;
+		return;
+	}
+	ring[h & ring_mask] = sample;
+	__sync_synchronize();
+	head = h + 1;
+}
 
-/**
-* @~english
-* @brief Shift the whole display
+//-------------getLatest-------------
+/** @~english
+* @brief Get the latest sample of a channel.
 *
-* @param num Number of shifts, positive: right, negativ: left
-* @return 1 by success, -1 by failure
+* @param channel channel number
+* @param sample the latest sample is stored in it
+* @return success: 1, no sample yet or unknown channel: -1
 *
 * @~german
-* @brief Verschiebt das ganze Display
+* @brief Liefert den letzten Wert eines Kanals.
 *
-* @param num Anzahl der zu verschiebenden Positionen, positiv: rechts, negativ: left
-* @return 1 bei Erfolg, -1 im Fehlerfall
+* @param channel Kanalnummer
+* @param sample hier wird der letzte Wert gespeichert
+* @return Erfolg: 1, noch kein Wert oder unbekannter Kanal: -1
 */
-int gnublin_module_dogm::shift(int num){
-	__u8 shift_cmd;
-	if(!init_flag){
-		init();
-	}
-	if (num > 0){
-		shift_cmd = 0x1C;
-		for (int i=0; i < num; i++){
-			if(spi.send(&shift_cmd, 1) < 0){
-				error_flag = true;
-				return -1;
-			}
-		}
-	}
-	else if (num < 0){
-		shift_cmd = 0x18;
-		for (int i=0; i > num; i--){
-			if(spi.send(&shift_cmd, 1) < 0){
-				error_flag = true;
-				return -1;
-			}
-		}
-	}
-	else {
-		error_flag = true;
-		return -1;
+int gnublin_adc_sampler::getLatest(int channel, gnublin_adc_sample *sample){
+	unsigned int seq;
+
+	for (int i = 0; i < channel_count; i++) {
+		if (channels[i] != channel)
+			continue;
+		do {
+			seq = latest_seq[i];
+			__sync_synchronize();
+			*sample = latest[i];
+			__sync_synchronize();
+		} while ((seq & 1) || seq != latest_seq[i]);
+		if (seq == 0)
+			return -1;
+		return 1;
 	}
-	error_flag = false;
-	return 1;
+	return -1;
 }
 
-
-//*********************** controlDisplay() **********************************
-
-/**
-* @~english
-* @brief Set display parameters
+//-------------getLatestValue-------------
+/** @~english
+* @brief Get the latest raw value of a channel.
 *
-* @param power switch display on(1) or off(0)  (not the chontrollerchip)
-* @param cursor switch cursor on(1) or off(0)
-* @param blink switch the vlinking of the cursor on(1) or off(0)
-* @return 1 by success, -1 by failure
+* @param channel channel number
+* @return raw value, -1 if there is no sample yet
 *
 * @~german
-* @brief Setzt Displayparameter.
+* @brief Liefert den letzten Rohwert eines Kanals.
 *
-* @param power Display an(1) oder aus(0) schalten (nicht den Displaycontroller)
-* @param cursor Schatet den Cursor an(1) oder aus(0)
-* @param blink Schaltet das Blinken des Cursors an(1) oder aus(0)
-* @return 1 bei Erfolg, -1 im Fehlerfall
+* @param channel Kanalnummer
+* @return Rohwert, -1 falls noch kein Wert vorliegt
 */
-int gnublin_module_dogm::controlDisplay(int power, int cursor, int blink) {
-	__u8 display_cmd = 0x08;
-	if(!init_flag){
-		init();
-	}
-	if (power == 1) {
-		display_cmd += 0x04;
-	}
-	if (cursor == 1) {
-		display_cmd += 0x02;
-	}
-	if (blink == 1) {
-		display_cmd += 0x01;
-	}
-	if (spi.send(&display_cmd, 1) < 0){
-		error_flag = true;
+int gnublin_adc_sampler::getLatestValue(int channel){
+	gnublin_adc_sample sample;
+
+	if (getLatest(channel, &sample) < 0)
 		return -1;
-	}
-	error_flag = false;
-	return 1;
+	return sample.value;
 }
-//*******************************************************************
-//Class for accessing the LM75 IC via I2C
-//*******************************************************************
 
-//------------------Konstruktor------------------
-/** @~english 
-* @brief Sets the error_flag to "false" and the standard i2c Address to 0x4f
-*
-* @~german 
-* @brief Setzt das error_flag auf "false" und die Standard i2c Adresse auf 0x4f
+//-------------available-------------
+/** @~english
+* @brief Number of samples waiting in the ring buffer.
 *
+* @~german
+* @brief Anzahl der Werte, die im Ringpuffer bereitliegen.
 */
-gnublin_module_lm75::gnublin_module_lm75()
-{
-	error_flag=false;
-	setAddress(0x4f);
+int gnublin_adc_sampler::available(){
+	return head - tail;
 }
 
-
-//-------------get Error Message-------------
-/** @~english 
-* @brief Get the last Error Message.
+//-------------read-------------
+/** @~english
+* @brief Read samples from the ring buffer without waiting.
 *
-* This function returns the last Error Message, which occurred in that Class.
-* @return ErrorMessage as c-string
+* @param buffer the samples are stored in it
+* @param count maximum number of samples
+* @return number of samples read
 *
-* @~german 
-* @brief Gibt die letzte Error Nachricht zurück.
+* @~german
+* @brief Liest Werte aus dem Ringpuffer, ohne zu warten.
 *
-* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
-* @return ErrorMessage als c-string
+* @param buffer hier werden die Werte gespeichert
+* @param count maximale Anzahl an Werten
+* @return Anzahl der gelesenen Werte
 */
-const char *gnublin_module_lm75::getErrorMessage(){
-	return ErrorMessage.c_str();
+int gnublin_adc_sampler::read(gnublin_adc_sample *buffer, int count){
+	unsigned int t = tail;
+	unsigned int n = head - t;
+
+	if (count < 0)
+		return 0;
+	if (n > (unsigned int)count)
+		n = count;
+	__sync_synchronize();
+	for (unsigned int i = 0; i < n; i++)
+		buffer[i] = ring[(t + i) & ring_mask];
+	__sync_synchronize();
+	tail = t + n;
+	return n;
 }
 
-//-------------------------------Fail-------------------------------
-/** @~english 
-* @brief returns the error flag to check if the last operation went wrong
+/** @~english
+* @brief Read a block of samples, wait until it is complete.
 *
-* @return error_flag as boolean
+* @param buffer the samples are stored in it
+* @param count number of samples
+* @param timeout_ms maximum time to wait in ms, -1 waits forever
+* @return number of samples read, less than count at timeout
 *
-* @~german 
-* @brief Gibt das error_flag zurück um zu überprüfen ob die vorangegangene Operation einen Fehler auweist
+* @~german
+* @brief Liest einen Block von Werten und wartet, bis er vollständig ist.
 *
-* @return error_flag als bool
+* @param buffer hier werden die Werte gespeichert
+* @param count Anzahl der Werte
+* @param timeout_ms maximale Wartezeit in ms, -1 wartet unbegrenzt
+* @return Anzahl der gelesenen Werte, bei Zeitüberschreitung weniger als count
 */
-bool gnublin_module_lm75::fail(){
-	return error_flag;
+int gnublin_adc_sampler::read(gnublin_adc_sample *buffer, int count, int timeout_ms){
+	unsigned long long deadline = getMonotonicTime() + (unsigned long long)timeout_ms * 1000;
+	struct pollfd pfd;
+	uint64_t events;
+	int done = 0;
+	int wait_ms = timeout_ms;
+
+	pfd.fd = wakeup_fd;
+	pfd.events = POLLIN;
+	while (done < count) {
+		done += read(buffer + done, count - done);
+		if (done == count || !run_flag)
+			break;
+		reader_waiting = 1;
+		__sync_synchronize();
+		if (available() == 0) {
+			if (timeout_ms >= 0) {
+				unsigned long long now = getMonotonicTime();
+				if (now >= deadline)
+					break;
+				wait_ms = (deadline - now + 999) / 1000;
+			}
+			if (poll(&pfd, 1, wait_ms) > 0)
+				if (::read(wakeup_fd, &events, sizeof(events)) < 0)
+					break;
+		}
+		reader_waiting = 0;
+	}
+	reader_waiting = 0;
+	return done;
 }
 
-//-------------set Address-------------
-/** @~english 
-* @brief Set the i2c slave address 
-*
-* With this function you can set the individual I2C Slave-Address.
-* @param Address new I2C slave Address
-*
-* @~german 
-* @brief Setzt die i2c slave Adresse
+//-------------getOverruns-------------
+/** @~english
+* @brief Number of samples dropped because the ring buffer was full.
 *
-* Mit dieser Funktion kann die individuelle I2C Slave-Adresse gesetzt werden.
-* @param Address neue I2C slave Adresse
+* @~german
+* @brief Anzahl der verworfenen Werte, weil der Ringpuffer voll war.
 */
-void gnublin_module_lm75::setAddress(int Address){
-	i2c.setAddress(Address);
+unsigned int gnublin_adc_sampler::getOverruns(){
+	return overruns;
 }
 
-
-//-------------------set devicefile----------------
+//-------------getReadErrors-------------
 /** @~english
-* @brief set i2c the device file. default is "/dev/i2c-1"
-*
-* This function sets the devicefile you want to access. by default "/dev/i2c-1" is set.
-* @param filename path to the devicefile e.g. "/dev/i2c-0"
+* @brief Number of failed conversions since the sampler was created.
 *
 * @~german
-* @brief setzt die I2C Device Datei. Standard ist die "/dev/i2c-1"
-*
-* Diese Funktion setzt die Geräte Datei, auf die man zugreifen möchte. Standardmäßig ist bereits "/dev/i2c-1" gesetzt.
-* @param filename Dateipfad zur Geräte Datei, z.B. "/dev/i2c-0"
+* @brief Anzahl fehlgeschlagener Wandlungen seit Erzeugung des Samplers.
 */
-void gnublin_module_lm75::setDevicefile(std::string filename){
-	i2c.setDevicefile(filename);
+unsigned int gnublin_adc_sampler::getReadErrors(){
+	return read_errors;
 }
 
-
-//-----------------------------------get Temp-----------------------------------
+//****************************************************************************
+// Class for filtering ADC sample streams in fixed point
+//****************************************************************************
+
 /** @~english
-* @brief reads the raw data via i2c from the LM75 chip and calculates the temperature
-*
-* @return Returns the Temperature, 0 at failure (check with fail() and getErrorMessage())
+* @brief Creates an empty filter (no channels, no stages).
 *
 * @~german
-* @brief liest die Roh-Daten aus dem LM75 und berechnet die Temperatur
-*
-* @return Temperatur, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
+* @brief Erzeugt einen leeren Filter (keine Kanäle, keine Stufen).
 */
-int gnublin_module_lm75::getTemp(){
-	short value=0;
-	int temp;	
-	unsigned char rx_buf[2];
-	error_flag=false;
-
-	if(i2c.receive(0x00, rx_buf, 2)>0){
-		// rx_buf[0] = MSByte
-		// rx_buf[1] = LSByte
-		// save the MSB
-		value = rx_buf[0];
-		// make space for the LSB
-		value<<=8;
-		// save the LSB
-		value |= rx_buf[1];
-		// Bit 0-4 isn't used in the LM75, so shift right 5 times
-		value>>=5;
-
-		//check if temperature is negative
-		if(rx_buf[0] & 0x80)
-		{
-			value = value|0xF800;
-			value =~value +1;
-			temp = value*(-0.125);
-			return temp;
-		}
-		else { //temperature is positive
-			temp = value*0.125;
-			return temp;
-		}
-
-
-	}
-	else{
-		error_flag=true;
-		ErrorMessage = "Error i2c receive\n";
-		return 0;	
-	}
+gnublin_adc_filter::gnublin_adc_filter(){
+	stage_count = 0;
+	channels = 0;
+	channel_count = 0;
+	extra_bits = 0;
+	work_in = 0;
+	work_out = 0;
+	work_size = 0;
+	error_flag = false;
 }
 
+/** @~english
+* @brief Frees the filter state.
+*
+* @~german
+* @brief Gibt den Filterzustand frei.
+*/
+gnublin_adc_filter::~gnublin_adc_filter(){
+	freeStages();
+	delete [] channels;
+	delete [] work_in;
+	delete [] work_out;
+}
 
-//--------------------------------get Temp float--------------------------------
+//-------------fail-------------
 /** @~english
-* @brief reads the raw data via i2c from the LM75 chip and calculates the temperature
+* @brief Returns the error flag.
 *
-* @return Returns the Temperature as float, 0 at failure (check with fail() and getErrorMessage())
+* If something went wrong, the flag is true.
+* @return bool error_flag
 *
 * @~german
-* @brief liest die Roh-Daten aus dem LM75 und berechnet die Temperatur
+* @brief Gibt das Error Flag zurück.
 *
-* @return Temperatur als Fließkommazahl, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
 */
-float gnublin_module_lm75::getTempFloat(){
-	short value=0;
-	float temp;	
-	unsigned char rx_buf[2];
-	error_flag=false;
-
-	if(i2c.receive(0x00, rx_buf, 2)>0){
-		// rx_buf[0] = MSByte
-		// rx_buf[1] = LSByte
-		// save the MSB
-		value = rx_buf[0];
-		// make space for the LSB
-		value<<=8;
-		// save the LSB
-		value |= rx_buf[1];
-		// Bit 0-4 isn't used in the LM75, so shift right 5 times
-		value>>=5;
-
-		//check if temperature is negative
-		if(rx_buf[0] & 0x80)
-		{
-			value = value|0xF800;
-			value =~value +1;
-			temp = value*(-0.125);
-			return temp;
-		}
-		else { //temperature is positive
-			temp = value*0.125;
-			return temp;
-		}
-		
-	}
-	else{	
-		error_flag=true;
-		ErrorMessage="Error i2c receive\n";
-		return 0;
-	}
-		
+bool gnublin_adc_filter::fail(){
+	return error_flag;
 }
 
-
-//--------------------------------get Value---------------------------------
+//-------------getErrorMessage-------------
 /** @~english
-* @brief reads the raw data via i2c from the LM75 chip and shift the bits correctly
+* @brief Get the last Error Message.
 *
-* @return Returns raw value, already shifted. 0 at failure (check with fail() and getErrorMessage())
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
 *
 * @~german
-* @brief liest die Roh-Daten aus dem LM75 und schiebt die Bits in die richtige Reihenfolge
+* @brief Gibt die letzte Error Nachricht zurück.
 *
-* @return Rohwert, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
 */
-short gnublin_module_lm75::getValue(){
-	short value=0;
-	unsigned char rx_buf[2];
-	error_flag=false;
-	if(i2c.receive(0x00, rx_buf, 2)>0){
-		
-		// rx_buf[0] = MSByte
-		// rx_buf[1] = LSByte
-		// save the MSB
-		value = rx_buf[0];
-		// make space for the LSB
-		value<<=8;
-		// save the LSB
-		value |= rx_buf[1];
-		// Bit 0-4 isn't used in the LM75, so shift right 5 times
-		value>>=5;
-		return value;
-		
-	}
-	else{
-		error_flag=true;
-		ErrorMessage="Error i2c receive\n";
-		return 0;
+const char *gnublin_adc_filter::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+void gnublin_adc_filter::freeStages(){
+	for (int i = 0; i < stage_count; i++) {
+		delete [] stages[i].acc;
+		delete [] stages[i].count;
+		delete [] stages[i].primed;
+		delete [] stages[i].history;
 	}
 }
 
+int gnublin_adc_filter::allocStage(filter_stage *stage){
+	int history = 0;
 
-//*****************************************************************************
-// Class for accesing GNUBLIN Module-ADC / ADS7830
-//*****************************************************************************
+	if (stage->type == ADC_FILTER_AVERAGE || stage->type == ADC_FILTER_MEDIAN)
+		history = stage->param * channel_count;
+	stage->acc = new long long[channel_count];
+	stage->count = new int[channel_count];
+	stage->primed = new int[channel_count];
+	stage->history = history ? new int[history] : 0;
+	memset(stage->acc, 0, channel_count * sizeof(long long));
+	memset(stage->count, 0, channel_count * sizeof(int));
+	memset(stage->primed, 0, channel_count * sizeof(int));
+	if (history)
+		memset(stage->history, 0, history * sizeof(int));
+	return 1;
+}
 
-/**
-* @~english
-* @brief Set the default I2C Address and reference to intern
+//-------------setChannels-------------
+/** @~english
+* @brief Set the channels which are filtered.
 *
-* Default I2C Address: 0x48
+* The order defines the layout of the frames for processFrames(). Already added stages are kept, their state is reset.
+* @param channels array of channel numbers
+* @param count number of channels
+* @return success: 1, failure: -1
 *
 * @~german
-* @brief Setzt die standard I2C Adresse und die Referenzspannung auf intern
+* @brief Setzt die Kanäle, die gefiltert werden.
 *
-* Standard I2C Addresse: 0x48
+* Die Reihenfolge legt den Aufbau der Frames für processFrames() fest. Bereits hinzugefügte Stufen bleiben erhalten, ihr Zustand wird zurückgesetzt.
+* @param channels Array mit Kanalnummern
+* @param count Anzahl der Kanäle
+* @return Erfolg: 1, Fehler: -1
 */
-gnublin_module_adc::gnublin_module_adc() {
-	i2c.setAddress(0x48);
-	referenceValue = 2500;
-	reference_flag = IN;
+int gnublin_adc_filter::setChannels(const int *channels, int count){
+	if (count < 1) {
+		ErrorMessage = "channel count must be at least 1\n";
+		error_flag = true;
+		return -1;
+	}
+	freeStages();
+	delete [] this->channels;
+	delete [] work_in;
+	delete [] work_out;
+	this->channels = new int[count];
+	for (int i = 0; i < count; i++)
+		this->channels[i] = channels[i];
+	channel_count = count;
+	work_size = ADC_FILTER_CHUNK * count;
+	work_in = new int[work_size];
+	work_out = new int[work_size];
+	for (int i = 0; i < stage_count; i++)
+		allocStage(&stages[i]);
 	error_flag = false;
+	return 1;
 }
 
-//-------------get Error Message-------------
-
-/**
-* @~english
-* @brief Returns the ErrorMessage of the previous error if one exist.
-*
-* @return ErrorMessage as C-String
+//-------------addStage-------------
+/** @~english
+* @brief Append a filter stage.
+*
+* ADC_FILTER_DECIMATE: param = oversampling factor (power of two, 2-256), one output per param inputs<br>
+* ADC_FILTER_AVERAGE: param = window length (2-64)<br>
+* ADC_FILTER_MEDIAN: param = window length (odd, 3-15)<br>
+* ADC_FILTER_IIR: param = time constant k (1-15), y += (x - y) / 2^k
+* @param type type of the stage
+* @param param parameter of the stage
+* @return success: 1, failure: -1
 *
 * @~german
-* @brief Gibt die Fehlernachricht des zuvor aufgetretenen Fehlers zurück, wenn weine exisitert.
-*
-* @return ErrorMessage als C-String
+* @brief Hängt eine Filterstufe an.
+*
+* ADC_FILTER_DECIMATE: param = Überabtastfaktor (Zweierpotenz, 2-256), ein Ausgangswert pro param Eingangswerte<br>
+* ADC_FILTER_AVERAGE: param = Fensterlänge (2-64)<br>
+* ADC_FILTER_MEDIAN: param = Fensterlänge (ungerade, 3-15)<br>
+* ADC_FILTER_IIR: param = Zeitkonstante k (1-15), y += (x - y) / 2^k
+* @param type Art der Stufe
+* @param param Parameter der Stufe
+* @return Erfolg: 1, Fehler: -1
 */
-const char *gnublin_module_adc::getErrorMessage(){
-	return ErrorMessage.c_str();
-}
+int gnublin_adc_filter::addStage(int type, int param){
+	filter_stage *stage = &stages[stage_count];
+	bool valid = false;
 
+	if (stage_count == ADC_FILTER_MAX_STAGES) {
+		ErrorMessage = "too many filter stages\n";
+		error_flag = true;
+		return -1;
+	}
+	switch (type) {
+		case ADC_FILTER_DECIMATE: valid = param >= 2 && param <= 256 && (param & (param - 1)) == 0; break;
+		case ADC_FILTER_AVERAGE: valid = param >= 2 && param <= 64; break;
+		case ADC_FILTER_MEDIAN: valid = param >= 3 && param <= 15 && (param & 1); break;
+		case ADC_FILTER_IIR: valid = param >= 1 && param <= 15; break;
+	}
+	if (!valid) {
+		ErrorMessage = "invalid filter stage\n";
+		error_flag = true;
+		return -1;
+	}
+	stage->type = type;
+	stage->param = param;
+	stage->shift = param;
+	stage->reciprocal = (1LL << 32) / param;
+	if (type == ADC_FILTER_DECIMATE)
+		for (stage->shift = 0; (1 << stage->shift) < param; stage->shift++);
+	stage->acc = 0;
+	stage->count = stage->primed = stage->history = 0;
+	if (channel_count)
+		allocStage(stage);
+	stage_count++;
+	error_flag = false;
+	return 1;
+}
 
-//------------ fail() -----------------------
-
-/**
-* @~english
-* @brief Returns the errorflag to detect error in the previous called method.
-*
-* @return error_flag
+//-------------clearStages-------------
+/** @~english
+* @brief Remove all filter stages.
 *
 * @~german
-* @brief Gibt das errorflag zurück, um Fehler in der zuvor aufgerugfenen Methode zu erkennen.
-*
-* @return error_flag
+* @brief Entfernt alle Filterstufen.
 */
-bool gnublin_module_adc::fail() {
-	return error_flag;
+void gnublin_adc_filter::clearStages(){
+	freeStages();
+	stage_count = 0;
 }
 
-
-//-------------setAddress-------------
-// set the slave address
-// parameters:		[int]address	i2c slave Address
-// return:		NONE
-/**
-* @~english
-* @brief Set the I2C Address
+//-------------setExtraBits-------------
+/** @~english
+* @brief Set the number of fraction bits kept in the output.
 *
-* @param address I2C Address
-* @return 1 by success, -1 by failure
+* With 0 (default) the output has the resolution of the raw values, with 2 the output is the raw value * 4 and so on.
+* @param bits 0-8
+* @return success: 1, failure: -1
 *
 * @~german
-* @brief Setzt die I2C Adresse.
+* @brief Setzt die Anzahl der Nachkommabits in der Ausgabe.
 *
-* @param address I2C Adresse
-* @return 1 bei Erfolg, -1 im Fehlerfall
+* Mit 0 (Standard) hat die Ausgabe die Auflösung der Rohwerte, mit 2 ist die Ausgabe der Rohwert * 4 usw.
+* @param bits 0-8
+* @return Erfolg: 1, Fehler: -1
 */
-int gnublin_module_adc::setAddress(int address) {
-	i2c.setAddress(address);
-	if (i2c.fail()) {
+int gnublin_adc_filter::setExtraBits(int bits){
+	if (bits < 0 || bits > ADC_FILTER_FRAC_BITS) {
+		ErrorMessage = "extra bits are not between 0-8\n";
 		error_flag = true;
 		return -1;
 	}
+	extra_bits = bits;
 	error_flag = false;
 	return 1;
 }
 
+//-------------reset-------------
+/** @~english
+* @brief Reset the state of all stages and channels.
+*
+* @~german
+* @brief Setzt den Zustand aller Stufen und Kanäle zurück.
+*/
+void gnublin_adc_filter::reset(){
+	if (channel_count == 0)
+		return;
+	freeStages();
+	for (int i = 0; i < stage_count; i++)
+		allocStage(&stages[i]);
+}
+
+int gnublin_adc_filter::findSlot(int channel){
+	for (int i = 0; i < channel_count; i++)
+		if (channels[i] == channel)
+			return i;
+	return -1;
+}
 
-//-------------------setDevicefile----------------
-// set the i2c device file. default is "/dev/i2c-1"
-// parameters:		[string]filename	path to the dev file
-// return:		NONE
-/**
-* @~english
-* @brief Set a custom I2C devicefile
+// runs one stage over "frames" frames of "lanes" interleaved channels, starting at state slot "slot"
+int gnublin_adc_filter::runStage(filter_stage *stage, const int *in, int frames, int lanes, int slot, int *out){
+	long long *acc = stage->acc + slot;
+	int n = stage->param;
+	int stride = channel_count;
+	int o = 0;
+
+	// fill the history with the first value, so the output doesn't start at 0
+	if (stage->type != ADC_FILTER_DECIMATE && frames > 0) {
+		for (int l = 0; l < lanes; l++) {
+			if (stage->primed[slot + l])
+				continue;
+			if (stage->history)
+				for (int i = 0; i < n; i++)
+					stage->history[i * stride + slot + l] = in[l];
+			if (stage->type == ADC_FILTER_AVERAGE)
+				acc[l] = (long long)in[l] * n;
+			else if (stage->type == ADC_FILTER_IIR)
+				acc[l] = (long long)in[l] << stage->shift;
+			else
+				acc[l] = in[l];
+			stage->primed[slot + l] = 1;
+		}
+	}
+
+	switch (stage->type) {
+	case ADC_FILTER_DECIMATE: {
+		int round = 1 << (stage->shift - 1);
+		for (int f = 0; f < frames; f++) {
+			const int *x = in + f * lanes;
+			for (int l = 0; l < lanes; l++)
+				acc[l] += x[l];
+			if (++stage->count[slot] == n) {
+				int *y = out + o * lanes;
+				for (int l = 0; l < lanes; l++) {
+					y[l] = (int)((acc[l] + round) >> stage->shift);
+					acc[l] = 0;
+				}
+				stage->count[slot] = 0;
+				o++;
+			}
+		}
+		return o;
+	}
+	case ADC_FILTER_AVERAGE: {
+		long long reciprocal = stage->reciprocal;
+		for (int f = 0; f < frames; f++) {
+			const int *x = in + f * lanes;
+			int *y = out + f * lanes;
+			int *h = stage->history + stage->count[slot] * stride + slot;
+			for (int l = 0; l < lanes; l++) {
+				acc[l] += x[l] - h[l];
+				h[l] = x[l];
+				y[l] = (int)((acc[l] * reciprocal + (1LL << 31)) >> 32);
+			}
+			if (++stage->count[slot] == n)
+				stage->count[slot] = 0;
+		}
+		return frames;
+	}
+	case ADC_FILTER_MEDIAN: {
+		int window[15];
+		for (int f = 0; f < frames; f++) {
+			const int *x = in + f * lanes;
+			int *y = out + f * lanes;
+			int pos = stage->count[slot];
+			for (int l = 0; l < lanes; l++) {
+				int *h = stage->history + slot + l;
+				h[pos * stride] = x[l];
+				// insertion sort of the small window
+				for (int i = 0; i < n; i++) {
+					int v = h[i * stride];
+					int j = i;
+					for (; j > 0 && window[j - 1] > v; j--)
+						window[j] = window[j - 1];
+					window[j] = v;
+				}
+				y[l] = window[n >> 1];
+			}
+			stage->count[slot] = pos + 1 == n ? 0 : pos + 1;
+		}
+		return frames;
+	}
+	case ADC_FILTER_IIR: {
+		int k = stage->shift;
+		for (int f = 0; f < frames; f++) {
+			const int *x = in + f * lanes;
+			int *y = out + f * lanes;
+			// the sum keeps k more fraction bits, so the output reaches the input exactly
+			for (int l = 0; l < lanes; l++) {
+				acc[l] += x[l] - (acc[l] >> k);
+				y[l] = (int)(acc[l] >> k);
+			}
+		}
+		return frames;
+	}
+	}
+	return 0;
+}
+
+// converts raw values to fixed point, runs all stages chunk wise and converts back
+int gnublin_adc_filter::run(const int *in, int frames, int lanes, int slot, int *out){
+	int shift = ADC_FILTER_FRAC_BITS - extra_bits;
+	int round = shift ? 1 << (shift - 1) : 0;
+	int total = 0;
+
+	for (int done = 0; done < frames; done += ADC_FILTER_CHUNK) {
+		int n = frames - done < ADC_FILTER_CHUNK ? frames - done : ADC_FILTER_CHUNK;
+		const int *x = in + done * lanes;
+		int *a = work_in;
+		int *b = work_out;
+
+		for (int i = 0; i < n * lanes; i++)
+			a[i] = x[i] << ADC_FILTER_FRAC_BITS;
+		for (int s = 0; s < stage_count && n > 0; s++) {
+			int *t;
+			n = runStage(&stages[s], a, n, lanes, slot, b);
+			t = a; a = b; b = t;
+		}
+		int *y = out + total * lanes;
+		for (int i = 0; i < n * lanes; i++)
+			y[i] = (a[i] + round) >> shift;
+		total += n;
+	}
+	return total;
+}
+
+//-------------process-------------
+/** @~english
+* @brief Filter a block of raw values of one channel.
 *
-* default devicefile: "/dev/i2c-1"
-* @param filename path of the devicefile
-* @return 1 by success, -1 by failure
+* @param channel channel number
+* @param in raw values
+* @param count number of raw values
+* @param out filtered values, must have room for count values
+* @return number of filtered values (less than count with decimation), -1 for an unknown channel
 *
 * @~german
-* @brief Setzt ein benutzerdefiniertes Devicefile.
+* @brief Filtert einen Block Rohwerte eines Kanals.
 *
-* Standard Devicefile ist "/dev/i2c-1"
-* @param filename Pfad zum Devicefile
-* @return 1 bei Erfolg, -1 im Fehlerfall
+* @param channel Kanalnummer
+* @param in Rohwerte
+* @param count Anzahl der Rohwerte
+* @param out gefilterte Werte, muss Platz für count Werte haben
+* @return Anzahl der gefilterten Werte (mit Dezimierung weniger als count), -1 bei unbekanntem Kanal
 */
-int gnublin_module_adc::setDevicefile(std::string filename) {
-	i2c.setDevicefile(filename);
-	if (i2c.fail()) {
+int gnublin_adc_filter::process(int channel, const int *in, int count, int *out){
+	int slot = findSlot(channel);
+
+	if (slot < 0) {
+		ErrorMessage = "unknown channel\n";
 		error_flag = true;
 		return -1;
 	}
 	error_flag = false;
-	return 1;
+	return run(in, count, 1, slot, out);
 }
 
-//-------------------setReference() ----------------
-
-/**
-* @~english
-* @brief Set the reverencevoltage to intern or extern
+/** @~english
+* @brief Filter samples as delivered by gnublin_adc_sampler.
 *
-* @param value IN (1) for intern (2.5V), OUT (0) for extern (3.3V)
-* @return 1 by success, -1 by failure
+* Samples of channels which are not set are dropped.
+* @param in samples
+* @param count number of samples
+* @param out filtered samples, must have room for count samples
+* @return number of filtered samples
 *
 * @~german
-* @brief Setzt die referenzspannung auf intern oder extern.
+* @brief Filtert Werte, wie sie gnublin_adc_sampler liefert.
 *
-* @param value IN (1) für intern (2,5V), OUT (0) für extern (3,3V)
-* @return 1 bei Erfolg, -1 im Fehlerfall
+* Werte von Kanälen, die nicht gesetzt sind, werden verworfen.
+* @param in Werte
+* @param count Anzahl der Werte
+* @param out gefilterte Werte, muss Platz für count Werte haben
+* @return Anzahl der gefilterten Werte
 */
-int gnublin_module_adc::setReference(int value) {
-	if (value == 0) {
-		referenceValue = 3300;
-		reference_flag = 0;
-	}
-	else if (value == 1) {
-		referenceValue = 2500;
-		reference_flag = 1;
-	}
-	else {
-		error_flag = true;
-		return -1;
+int gnublin_adc_filter::process(const gnublin_adc_sample *in, int count, gnublin_adc_sample *out){
+	int o = 0;
+
+	for (int i = 0; i < count; i++) {
+		int slot = findSlot(in[i].channel);
+		if (slot < 0)
+			continue;
+		if (run(&in[i].value, 1, 1, slot, &out[o].value) == 1) {
+			out[o].timestamp = in[i].timestamp;
+			out[o].channel = in[i].channel;
+			o++;
+		}
 	}
 	error_flag = false;
-	return 1;
+	return o;
 }
 
-
-//---------------------- getValue() -----------------------
-
-/**
-* @~english
-* @brief Get a value of an ADC channel in reference to GND
+//-------------processFrames-------------
+/** @~english
+* @brief Filter a block of frames containing one raw value of every channel.
 *
-* @param channel Number of the ADC-channel (1-8)
-* @return value
+* The values of a frame are ordered like the channel list of setChannels(). Don't mix with the per channel process() calls without reset().
+* @param in frames * channels raw values
+* @param frames number of frames
+* @param out filtered frames, must have room for frames * channels values
+* @return number of filtered frames
 *
 * @~german
-* @brief Liefert den Wert eine ADC Ports bezogen zu GND
+* @brief Filtert einen Block von Frames mit je einem Rohwert pro Kanal.
 *
-* @param channel Nummer des ADC-Ports (1-8)
-* @return Wert
+* Die Werte eines Frames sind wie die Kanalliste von setChannels() angeordnet. Nicht ohne reset() mit den process() Aufrufen pro Kanal mischen.
+* @param in Frames * Kanäle Rohwerte
+* @param frames Anzahl der Frames
+* @param out gefilterte Frames, muss Platz für Frames * Kanäle Werte haben
+* @return Anzahl der gefilterten Frames
 */
-int gnublin_module_adc::getValue(int channel) {
-	int command;
-	unsigned char value[1];
-	
-	if (reference_flag == 0){
-		switch (channel) {
-			case 1: command = 0x87; break;
-			case 2: command = 0xC7; break;
-			case 3: command = 0x97; break;
-			case 4: command = 0xD7; break;
-			case 5: command = 0xA7; break;
-			case 6: command = 0xE7; break;
-			case 7: command = 0xB7; break;
-			case 8: command = 0xF7; break;
-			default: error_flag = true; return -1; break;
-		}
-	}
-	else {
-		switch (channel) {
-			case 1: command = 0x8F; break;
-			case 2: command = 0xCF; break;
-			case 3: command = 0x9F; break;
-			case 4: command = 0xDF; break;
-			case 5: command = 0xAF; break;
-			case 6: command = 0xEF; break;
-			case 7: command = 0xBF; break;
-			case 8: command = 0xFF; break;
-			default: error_flag = true; return -1; break;
-		}
-	}
-	
-	i2c.send(command);
-	if (i2c.fail()) {
+int gnublin_adc_filter::processFrames(const int *in, int frames, int *out){
+	if (channel_count == 0) {
+		ErrorMessage = "no channels set\n";
 		error_flag = true;
 		return -1;
 	}
+	error_flag = false;
+	return run(in, frames, channel_count, 0, out);
+}
 
-	i2c.receive(value, 1);
-	if (i2c.fail()) {
-		error_flag = true;
-		return -1;
+//****************************************************************************
+// Class for converting raw ADC values to mV
+//****************************************************************************
+
+/** @~english
+* @brief Set all channels to offset 0, gain 1 and the given reference.
+*
+* @param full_scale raw value which corresponds to the reference voltage (e.g. 1024 for the GPAs)
+* @param reference reference voltage in mV
+*
+* @~german
+* @brief Setzt alle Kanäle auf Offset 0, Verstärkung 1 und die übergebene Referenz.
+*
+* @param full_scale Rohwert, der der Referenzspannung entspricht (z.B. 1024 für die GPAs)
+* @param reference Referenzspannung in mV
+*/
+gnublin_adc_calibration::gnublin_adc_calibration(int full_scale, int reference){
+	this->full_scale = full_scale;
+	for (int i = 0; i < ADC_CALIBRATION_CHANNELS; i++) {
+		offset[i] = 0;
+		gain_ppm[i] = 1000000;
+		this->reference[i] = reference;
+		update(i);
 	}
 	error_flag = false;
-	return value[0];	
 }
 
-/**
-* @~english
-* @brief Get a value of an ADC channel in reference to a second ADC channel (differential)
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
 *
-* This combinations are possible<br>
-* 1 - 2<br>
-* 3 - 4<br>
-* 5 - 6<br>
-* 7 - 8<br>
-* 2 - 1<br>
-* 4 - 3<br>
-* 6 - 5<br>
-* 8 - 7<br>
-* @param channel1 Number of the first ADC-channel 
-* @param channel2 Number of the second ADC-channel
-* @return value
+* If something went wrong, the flag is true.
+* @return bool error_flag
 *
 * @~german
-* @brief Liefert den Wert eines ADC Ports bezogen auf einen zweiten ADC Port (differentielle Messung)
+* @brief Gibt das Error Flag zurück.
 *
-* Dies Kombinationen sind möglich:<br>
-* 1 - 2<br>
-* 3 - 4<br>
-* 5 - 6<br>
-* 7 - 8<br>
-* 2 - 1<br>
-* 4 - 3<br>
-* 6 - 5<br>
-* 8 - 7<br>
-* @param channel1 Nummer des ersten ADC-Ports
-* @param channel2 Nummer des zweiten ADC-Ports
-* @return Wert
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
 */
-int gnublin_module_adc::getValue(int channel1, int channel2) {
-	int command = -1;
-	unsigned char value[1];
-	
-	for (int i = 1; i<9; i += 2 ) {
-		if (channel1 == i && channel2 == (i+1)){
-			switch(i) {
-				case 1: command = 0x00; break;
-				case 3: command = 0x10; break;
-				case 5: command = 0x20; break;
-				case 7: command = 0x30; break;
-			}
-		}
-		if (channel2 == i && channel1 == (i+1)) {
-			switch(i) {
-				case 1: command = 0x40; break;
-				case 3: command = 0x50; break;
-				case 5: command = 0x60; break;
-				case 7: command = 0x70; break;
-			}
+bool gnublin_adc_calibration::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_adc_calibration::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+// multiplier = ceil(reference * gain / (full_scale * 10^6) * 2^48)
+// Rounding the multiplier up keeps the error below x / 2^48 < 1 / (2 * full_scale * 10^6),
+// which is smaller than the distance of any non tie result to the next rounding boundary.
+void gnublin_adc_calibration::update(int channel){
+	unsigned long long n = (unsigned long long)reference[channel] * gain_ppm[channel];
+	unsigned long long d = (unsigned long long)full_scale * 1000000;
+	unsigned long long q = n / d;
+	unsigned long long r = n % d;
+
+	for (int i = 0; i < ADC_CALIBRATION_SHIFT; i++) {
+		q <<= 1;
+		r <<= 1;
+		if (r >= d) {
+			r -= d;
+			q |= 1;
 		}
 	}
-	if (command == -1){
+	if (r)
+		q++;
+	multiplier[channel] = q;
+}
+
+//-------------setReference-------------
+/** @~english
+* @brief Set the reference voltage of all channels.
+*
+* @param reference reference voltage in mV (1-5000)
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Referenzspannung aller Kanäle.
+*
+* @param reference Referenzspannung in mV (1-5000)
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_calibration::setReference(int reference){
+	if (reference < 1 || reference > 5000) {
+		ErrorMessage = "reference is not between 1-5000 mV\n";
 		error_flag = true;
 		return -1;
 	}
-	if (reference_flag == 0) {
-		command += 0x7;
-	}
-	else {
-		command += 0xF;
+	for (int i = 0; i < ADC_CALIBRATION_CHANNELS; i++) {
+		this->reference[i] = reference;
+		update(i);
 	}
-	i2c.send(command);
-	if (i2c.fail()) {
+	error_flag = false;
+	return 1;
+}
+
+//-------------setChannel-------------
+/** @~english
+* @brief Set the calibration of one channel.
+*
+* @param channel channel number (0-8)
+* @param offset offset in LSB, added to the raw value (-255 to 255)
+* @param gain_ppm gain in parts per million, 1000000 = 1.0 (1-2000000)
+* @param reference reference voltage in mV (1-5000)
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Kalibrierung eines Kanals.
+*
+* @param channel Kanalnummer (0-8)
+* @param offset Offset in LSB, wird zum Rohwert addiert (-255 bis 255)
+* @param gain_ppm Verstärkung in millionstel, 1000000 = 1,0 (1-2000000)
+* @param reference Referenzspannung in mV (1-5000)
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_calibration::setChannel(int channel, int offset, int gain_ppm, int reference){
+	if (channel < 0 || channel >= ADC_CALIBRATION_CHANNELS || offset < -255 || offset > 255
+	    || gain_ppm < 1 || gain_ppm > 2000000 || reference < 1 || reference > 5000) {
+		ErrorMessage = "invalid calibration for channel " + numberToString(channel) + "\n";
 		error_flag = true;
 		return -1;
 	}
+	this->offset[channel] = offset;
+	this->gain_ppm[channel] = gain_ppm;
+	this->reference[channel] = reference;
+	update(channel);
+	error_flag = false;
+	return 1;
+}
 
-	i2c.receive(value, 1);
-	if (i2c.fail()) {
+//-------------load-------------
+/** @~english
+* @brief Load the calibration from a file.
+*
+* Every line contains "channel offset gain reference", e.g. "1 -2 1.0031 3300". Empty lines and lines starting with # are ignored.
+* @param filename path of the calibration file
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Lädt die Kalibrierung aus einer Datei.
+*
+* Jede Zeile enthält "Kanal Offset Verstärkung Referenz", z.B. "1 -2 1.0031 3300". Leere Zeilen und Zeilen, die mit # beginnen, werden ignoriert.
+* @param filename Pfad zur Kalibrierungsdatei
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_adc_calibration::load(std::string filename){
+	std::ifstream file(filename.c_str());
+	std::string line;
+	int line_number = 0;
+
+	if (file.fail()) {
+		ErrorMessage = "ERROR opening: " + filename + "\n";
 		error_flag = true;
 		return -1;
 	}
+	while (std::getline(file, line)) {
+		std::istringstream fields(line);
+		int channel, offset, reference;
+		double gain;
+
+		line_number++;
+		if (line.find_first_not_of(" \t\r") == std::string::npos || line[line.find_first_not_of(" \t")] == '#')
+			continue;
+		if (!(fields >> channel >> offset >> gain >> reference)
+		    || setChannel(channel, offset, (int)(gain * 1000000 + 0.5), reference) < 0) {
+			ErrorMessage = "invalid line " + numberToString(line_number) + " in " + filename + "\n";
+			error_flag = true;
+			return -1;
+		}
+	}
 	error_flag = false;
-	return value[0];
+	return 1;
 }
 
-
-//---------------------- getVoltage() -----------------------
-// get ADC Value of channel in reference to GND
-// parameters:		[int] channel		ADC-Port
-// return:		[int] voltage		voltage of ADC-channel in mV
-/**
-* @~english
-* @brief Get the voltage of an ADC channel in reference to GND in mV
+//-------------toMillivolt-------------
+/** @~english
+* @brief Convert a raw value to mV.
 *
-* @param channel Number of the ADC-channel (1-8)
-* @return value in mV
+* @param channel channel number (0-8)
+* @param raw raw value
+* @return voltage in mV, -1 for an invalid channel
 *
 * @~german
-* @brief Liefert den Wert eine ADC Ports bezogen zu GND in mV
+* @brief Rechnet einen Rohwert in mV um.
 *
-* @param channel Nummer des ADC-Ports (1-8)
-* @return Wert in mV
+* @param channel Kanalnummer (0-8)
+* @param raw Rohwert
+* @return Spannung in mV, -1 bei ungültigem Kanal
 */
-int gnublin_module_adc::getVoltage(int channel) {
-	error_flag = false;
-	int voltage;
-	int value = getValue(channel);
-	if (error_flag) {
+int gnublin_adc_calibration::toMillivolt(int channel, int raw){
+	int x;
+
+	if (channel < 0 || channel >= ADC_CALIBRATION_CHANNELS)
 		return -1;
-	}
-	
-	voltage = value * referenceValue / 255;
-	return voltage;
+	x = raw + offset[channel];
+	if (x < 0)
+		x = 0;
+	return (int)(((unsigned long long)x * multiplier[channel] + (1ULL << (ADC_CALIBRATION_SHIFT - 1))) >> ADC_CALIBRATION_SHIFT);
 }
 
-/**
-* @~english
-* @brief Get the voltage of an ADC channel in reference to a second ADC channel in mV (differential)
+/** @~english
+* @brief Convert a block of raw values of one channel to mV.
 *
-* This combinations are possible<br>
-* 1 - 2<br>
-* 3 - 4<br>
-* 5 - 6<br>
-* 7 - 8<br>
-* 2 - 1<br>
-* 4 - 3<br>
-* 6 - 5<br>
-* 8 - 7<br>
-* @param channel1 Number of the first ADC-channel 
-* @param channel2 Number of the second ADC-channel
-* @return voltage in mV
+* @param channel channel number (0-8)
+* @param raw raw values
+* @param count number of values
+* @param mv the voltages in mV are stored in it
+* @return success: count, failure: -1
 *
 * @~german
-* @brief Liefert den Wert eines ADC Ports bezogen auf einen zweiten ADC Port in mV (differentielle Messung)
+* @brief Rechnet einen Block Rohwerte eines Kanals in mV um.
 *
-* Dies Kombinationen sind möglich:<br>
-* 1 - 2<br>
-* 3 - 4<br>
-* 5 - 6<br>
-* 7 - 8<br>
-* 2 - 1<br>
-* 4 - 3<br>
-* 6 - 5<br>
-* 8 - 7<br>
-* @param channel1 Nummer des ersten ADC-Ports
-* @param channel2 Nummer des zweiten ADC-Ports
-* @return Wert in mV
+* @param channel Kanalnummer (0-8)
+* @param raw Rohwerte
+* @param count Anzahl der Werte
+* @param mv hier werden die Spannungen in mV gespeichert
+* @return Erfolg: count, Fehler: -1
 */
-int gnublin_module_adc::getVoltage(int channel1, int channel2) {
-	error_flag = false;
-	int voltage;
-	int value = getValue(channel1, channel2);
-	if (error_flag) {
+int gnublin_adc_calibration::toMillivolt(int channel, const int *raw, int count, int *mv){
+	unsigned long long m;
+	int o;
+
+	if (channel < 0 || channel >= ADC_CALIBRATION_CHANNELS) {
+		ErrorMessage = "channel is not between 0-8\n";
+		error_flag = true;
 		return -1;
 	}
-	
-	voltage = value * referenceValue / 255;
-	return voltage;
+	m = multiplier[channel];
+	o = offset[channel];
+	for (int i = 0; i < count; i++) {
+		int x = raw[i] + o;
+		x = x < 0 ? 0 : x;
+		mv[i] = (int)(((unsigned long long)x * m + (1ULL << (ADC_CALIBRATION_SHIFT - 1))) >> ADC_CALIBRATION_SHIFT);
+	}
+	error_flag = false;
+	return count;
 }
 
-//*******************************************************************
-//Class for accessing GNUBLIN Module-Portexpander or any PCA9555
-//*******************************************************************
-
-//------------------Konstruktor------------------
-/** @~english 
-* @brief Set standard i2c address 0x20, set ErrorFlag false
+/** @~english
+* @brief Convert samples of gnublin_adc_sampler to mV.
 *
-* @~german 
-* @brief Setze standard i2c Adresse 0x20 und setze das ErrorFlag auf false.
+* @param samples samples
+* @param count number of samples
+* @param mv the voltages in mV are stored in it, -1 for samples of invalid channels
+* @return count
 *
+* @~german
+* @brief Rechnet Werte von gnublin_adc_sampler in mV um.
+*
+* @param samples Werte
+* @param count Anzahl der Werte
+* @param mv hier werden die Spannungen in mV gespeichert, -1 bei Werten ungültiger Kanäle
+* @return count
 */
-gnublin_module_pca9555::gnublin_module_pca9555() 
-{
-	error_flag=false;
-	setAddress(0x20);
+int gnublin_adc_calibration::toMillivolt(const gnublin_adc_sample *samples, int count, int *mv){
+	for (int i = 0; i < count; i++)
+		mv[i] = toMillivolt(samples[i].channel, samples[i].value);
+	error_flag = false;
+	return count;
 }
 
+//****************************************************************************
+// Class for threshold and window events on ADC samples
+//****************************************************************************
 
-//-------------get Error Message-------------
-/** @~english 
-* @brief Get the last Error Message.
-*
-* This function returns the last Error Message, which occurred in that Class.
-* @return ErrorMessage as c-string
-*
-* @~german 
-* @brief Gibt die letzte Error Nachricht zurück.
+/** @~english
+* @brief Creates a comparator without windows and rate limits.
 *
-* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
-* @return ErrorMessage als c-string
+* @~german
+* @brief Erzeugt einen Komparator ohne Fenster und Anstiegsgrenzen.
 */
-const char *gnublin_module_pca9555::getErrorMessage(){
-	return ErrorMessage.c_str();
+gnublin_adc_comparator::gnublin_adc_comparator(){
+	queue = 0;
+	for (int i = 0; i < ADC_COMPARATOR_CHANNELS; i++)
+		clear(i);
+	error_flag = false;
 }
 
-//-------------------------------Fail-------------------------------
-/** @~english 
-* @brief returns the error flag to check if the last operation went wrong
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
 *
-* @return error_flag as boolean
+* If something went wrong, the flag is true.
+* @return bool error_flag
 *
-* @~german 
-* @brief Gibt das error_flag zurück um zu überprüfen ob die vorangegangene Operation einen Fehler auweist
+* @~german
+* @brief Gibt das Error Flag zurück.
 *
-* @return error_flag als bool
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
 */
-bool gnublin_module_pca9555::fail(){
+bool gnublin_adc_comparator::fail(){
 	return error_flag;
 }
 
-//-------------set Address-------------
-/** @~english 
-* @brief Set the i2c slave address 
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
 *
-* With this function you can set the individual I2C Slave-Address of the PCA9555.
-* @param Address new I2C slave Address
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
 *
-* @~german 
-* @brief Setzt die i2c slave Adresse
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
 *
-* Mit dieser Funktion kann die individuelle I2C Slave-Adresse des PCA9555 gesetzt werden.
-* @param Address neue I2C slave Adresse
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
 */
-void gnublin_module_pca9555::setAddress(int Address){
-	i2c.setAddress(Address);
+const char *gnublin_adc_comparator::getErrorMessage(){
+	return ErrorMessage.c_str();
 }
 
-
-//-------------------set devicefile----------------
+//-------------setQueue-------------
 /** @~english
-* @brief set i2c the device file. default is "/dev/i2c-1"
+* @brief Set the queue which receives the events.
 *
-* This function sets the devicefile you want to access. by default "/dev/i2c-1" is set.
-* @param filename path to the devicefile e.g. "/dev/i2c-0"
+* @param queue event queue, it may also have a callback set
 *
 * @~german
-* @brief setzt die I2C Device Datei. Standard ist die "/dev/i2c-1"
+* @brief Setzt die Warteschlange, die die Ereignisse erhält.
 *
-* Diese Funktion setzt die Geräte Datei, auf die man zugreifen möchte. Standardmäßig ist bereits "/dev/i2c-1" gesetzt.
-* @param filename Dateipfad zur Geräte Datei, z.B. "/dev/i2c-0"
+* @param queue Ereignis-Warteschlange, sie kann auch einen Callback gesetzt haben
 */
-void gnublin_module_pca9555::setDevicefile(std::string filename){
-	i2c.setDevicefile(filename);
+void gnublin_adc_comparator::setQueue(gnublin_event_queue *queue){
+	this->queue = queue;
 }
 
-//-----------------------------------Pin Mode-----------------------------------
+//-------------setWindow-------------
 /** @~english
-* @brief Controls the pin mode (INPUT/OUTPUT)
-*
-* With this Function you can set a single pin of the PCA9555 wether as input or output.
-* @param pin Number of the pin (0-15)
-* @param direction INPUT or OUTPUT
+* @brief Set the window of a channel.
+*
+* Above is entered when the value exceeds high and left when it falls below high - hysteresis.
+* Below is entered when the value falls below low and left when it exceeds low + hysteresis.
+* For a single over threshold set low to 0, for a single under threshold set high to the maximum raw value.
+* @param channel channel number (0-8)
+* @param low lower threshold (raw value)
+* @param high upper threshold (raw value)
+* @param hysteresis hysteresis (raw value)
 * @return success: 1, failure: -1
 *
 * @~german
-* @brief Setzt den Pin Modus (Eingang/Ausgang)
-*
-* Mit dieser Funktion kann man einen einzelnen Pin entweder als Eingang oder als Ausgang setzen.
-* @param pin Nummer des Pins (0-15)
-* @param direction INPUT (Eingang) oder OUTPUT (Ausgang)
-* @return Erfolg: 1, Misserfolg: -1
+* @brief Setzt das Fenster eines Kanals.
+*
+* Oberhalb wird betreten, wenn der Wert high überschreitet, und verlassen, wenn er unter high - hysteresis fällt.
+* Unterhalb wird betreten, wenn der Wert low unterschreitet, und verlassen, wenn er über low + hysteresis steigt.
+* Für eine einzelne Oberschwelle low auf 0 setzen, für eine einzelne Unterschwelle high auf den maximalen Rohwert.
+* @param channel Kanalnummer (0-8)
+* @param low untere Schwelle (Rohwert)
+* @param high obere Schwelle (Rohwert)
+* @param hysteresis Hysterese (Rohwert)
+* @return Erfolg: 1, Fehler: -1
 */
-int gnublin_module_pca9555::pinMode(int pin, std::string direction){
-	error_flag=false;
-	unsigned char TxBuf[1];
-	unsigned char RxBuf[1];
-
-	if (pin < 0 || pin > 15){
-		error_flag=true;
-		ErrorMessage="Pin Number is not between 0-15";
+int gnublin_adc_comparator::setWindow(int channel, int low, int high, int hysteresis){
+	if (channel < 0 || channel >= ADC_COMPARATOR_CHANNELS || low > high || hysteresis < 0) {
+		ErrorMessage = "invalid window\n";
+		error_flag = true;
 		return -1;
 	}
-
-	if(pin >= 0 && pin <= 7){ // Port 0
-
-			TxBuf[0]=pow(2, pin); //convert pin into its binary form e. g. Pin 3 = 8
-
-			if (i2c.receive(0x06, RxBuf, 1)>0){ //read the current state
-
-				if (direction=="out"){
-					TxBuf[0]=RxBuf[0] & ~TxBuf[0]; // at output you have to invert the pin you want to set und AND it to change only the pin 
-					if(i2c.send(0x06, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}
-									
-				}
-				else if (direction=="in"){
-					TxBuf[0]=RxBuf[0] | TxBuf[0]; // at input you just have to do a OR
-					if(i2c.send(0x06, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}
-				}
-				else{
-					error_flag=true;
-					ErrorMessage="direction != IN/OUTPUT";				
-					return -1;			
-				}
-			}
-			else {
-			error_flag=true;
-			ErrorMessage="i2c.receive Error";
-			return -1;
-			}
-	}
-	else if(pin >= 8 && pin <= 15){ // Port 1
-
-			TxBuf[0]=pow(2, (pin-8)); //convert pin into its binary form e. g. Pin 3 = 8
-
-			if(i2c.receive(0x07, RxBuf, 1)>0){ //read the current state
-			
-				if (direction=="out"){
-					TxBuf[0]=RxBuf[0] & ~TxBuf[0];
-					if(i2c.send(0x07, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}					
-				}
-				else if (direction=="in"){
-					TxBuf[0]=RxBuf[0] | TxBuf[0];
-					if(i2c.send(0x07, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}
-				}
-				else{
-					error_flag=true;
-					ErrorMessage="direction != IN/OUTPUT";				
-					return -1;			
-				}
-			}
-			else {
-			error_flag=true;
-			ErrorMessage="i2c.receive Error";
-			return -1;
-			}
-	}
-	else return -1;
+	this->low[channel] = low;
+	this->high[channel] = high;
+	this->hysteresis[channel] = hysteresis;
+	window[channel] = true;
+	primed[channel] = false;
+	error_flag = false;
+	return 1;
 }
 
-
-//-----------------------------------Port Mode-----------------------------------
+//-------------setRateLimit-------------
 /** @~english
-* @brief Controls the port mode (INPUT/OUTPUT)
+* @brief Set the rate of change trigger of a channel.
 *
-* With this Function you can set a whole port of the PCA9555 wether as input or output.
-* @param port Number of the port (0-1)
-* @param direction INPUT or OUTPUT
+* EVENT_ADC_RATE is sent once when the value changes faster than the limit and again after the rate was below the limit.
+* @param channel channel number (0-8)
+* @param rate maximum change in raw values per second, 0 disables the trigger
 * @return success: 1, failure: -1
 *
 * @~german
-* @brief Setzt den Port Modus (Eingang/Ausgang)
+* @brief Setzt den Anstiegs-Auslöser eines Kanals.
 *
-* Mit dieser Funktion kann man einen ganzen Port entweder als Eingang oder als Ausgang setzen.
-* @param port Nummer des Ports (0-1)
-* @param direction INPUT (Eingang) oder OUTPUT (Ausgang)
-* @return Erfolg: 1, Misserfolg: -1
+* EVENT_ADC_RATE wird einmal gesendet, wenn sich der Wert schneller als erlaubt ändert, und erneut, nachdem die Änderung wieder unter der Grenze war.
+* @param channel Kanalnummer (0-8)
+* @param rate maximale Änderung in Rohwerten pro Sekunde, 0 schaltet den Auslöser ab
+* @return Erfolg: 1, Fehler: -1
 */
-int gnublin_module_pca9555::portMode(int port, std::string direction){
-	error_flag=false;
-	unsigned char TxBuf[1];
-
-	if (port < 0 || port > 1){
-		error_flag=true;
-		ErrorMessage="Port Number is not between 0-1";
+int gnublin_adc_comparator::setRateLimit(int channel, int rate){
+	if (channel < 0 || channel >= ADC_COMPARATOR_CHANNELS || rate < 0) {
+		ErrorMessage = "invalid rate limit\n";
+		error_flag = true;
 		return -1;
 	}
-
-	if(port == 0){ // Port 0
-
-			if (direction=="out"){
-				TxBuf[0]=0x00;
-				if(i2c.send(0x06, TxBuf, 1)>0){
-				return 1;
-				}
-				else {
-					error_flag=true;
-					ErrorMessage="i2c.send Error";
-					return -1;
-				}
-								
-			}
-			else if (direction=="in"){
-				TxBuf[0]=0xff;
-				if(i2c.send(0x06, TxBuf, 1)>0){
-				return 1;
-				}
-				else {
-					error_flag=true;
-					ErrorMessage="i2c.send Error";
-					return -1;
-				}
-			}
-			else{
-				error_flag=true;
-				ErrorMessage="direction != IN/OUTPUT";				
-				return -1;			
-			}
-	}
-	else if(port==1){ // Port 1
-		
-			if (direction=="out"){
-				TxBuf[0]=0x00;
-				if(i2c.send(0x07, TxBuf, 1)>0){
-				return 1;
-				}
-				else {
-					error_flag=true;
-					ErrorMessage="i2c.send Error";
-					return -1;
-				}					
-			}
-			else if (direction=="in"){
-				TxBuf[0]=0xff;
-				if(i2c.send(0x07, TxBuf, 1)>0){
-				return 1;
-				}
-				else {
-					error_flag=true;
-					ErrorMessage="i2c.send Error";
-					return -1;
-				}
-			}
-			else{
-				error_flag=true;
-				ErrorMessage="direction != IN/OUTPUT";				
-				return -1;			
-			}
-	}
-	else return -1;
+	this->rate[channel] = rate;
+	rate_exceeded[channel] = false;
+	error_flag = false;
+	return 1;
 }
 
-
-//-----------------------------------digital Write-----------------------------------
+//-------------clear-------------
 /** @~english
-* @brief sets the level of an output pin (HIGH/LOW)
+* @brief Remove window and rate limit of a channel.
 *
-* With this Function you can set the logical level of an output pin to wether HIGH or LOW.
-* @param pin Number of the pin (0-15)
-* @param value HIGH (1) or LOW (0)
+* @param channel channel number (0-8)
 * @return success: 1, failure: -1
 *
 * @~german
-* @brief Setzt den Pegel eines Ausgangs (HIGH/LOW)
+* @brief Entfernt Fenster und Anstiegsgrenze eines Kanals.
 *
-* Mit dieser Funktion kann man den Pegel eines Ausgangs entweder auf HIGH oder auf LOW setzen.
-* @param pin Nummer des Pins (0-15)
-* @param value HIGH (1) oder LOW (0) 
-* @return Erfolg: 1, Misserfolg: -1
+* @param channel Kanalnummer (0-8)
+* @return Erfolg: 1, Fehler: -1
 */
-int gnublin_module_pca9555::digitalWrite(int pin, int value){
-	error_flag=false;
-	unsigned char TxBuf[1];
-	unsigned char RxBuf[1];
-
-	if (pin < 0 || pin > 15){
-		error_flag=true;
-		ErrorMessage="Pin Number is not between 0-15";
+int gnublin_adc_comparator::clear(int channel){
+	if (channel < 0 || channel >= ADC_COMPARATOR_CHANNELS)
 		return -1;
-	}
-
-
-	if(pin >= 0 && pin <= 7){ // Port 0
-
-			TxBuf[0]=pow(2, pin); //convert pin into its binary form e. g. Pin 3 = 8
-
-			if (i2c.receive(0x02, RxBuf, 1)>0){ //read the current state
-
-				if (value==0){
-					TxBuf[0]=(RxBuf[0] & ~TxBuf[0]); // at low you have to invert the pin you want to set and do a AND to change only the pin you want 
-					if(i2c.send(0x02, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}
-									
-				}
-				else if (value==1){
-					TxBuf[0]=(RxBuf[0] | TxBuf[0]); // at high you just have to do a OR
-					if(i2c.send(0x02, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}
-				}
-				else{
-					error_flag=true;
-					ErrorMessage="value != 1/0";				
-					return -1;			
-				}
-			}
-			else {
-			error_flag=true;
-			ErrorMessage="i2c.receive Error";
-			return -1;
-			}
-	}
-	else if(pin >= 8 && pin <= 15){ // Port 1
-
-			TxBuf[0]=pow(2, (pin-8)); //convert pin into its binary form e. g. Pin 3 = 8
-
-			if(i2c.receive(0x03, RxBuf, 1)>0){ //read the current state
-				if (value==0){
-					
-					TxBuf[0]=RxBuf[0] & ~TxBuf[0];
-					if(i2c.send(0x03, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}					
-				}
-				else if (value==1){
-					TxBuf[0]=RxBuf[0] | TxBuf[0];
-					if(i2c.send(0x03, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}
-				}
-				else{
-					error_flag=true;
-					ErrorMessage="value != HIGH/LOW";				
-					return -1;			
-				}
-			}
-			else {
-			error_flag=true;
-			ErrorMessage="i2c.receive Error";
-			return -1;
-			}
-	}
-	else return -1;
+	window[channel] = false;
+	rate[channel] = 0;
+	state[channel] = ADC_STATE_INSIDE;
+	primed[channel] = false;
+	rate_exceeded[channel] = false;
+	last_value[channel] = 0;
+	last_time[channel] = 0;
+	return 1;
 }
 
-//-----------------------------------write Port-----------------------------------
+//-------------getState-------------
 /** @~english
-* @brief  Writes one byte to a complete port
+* @brief Current window state of a channel.
 *
-* With this Function you can write a whole byte to a whole port of the PCA9555.
-* @param port Number of the port (0-1)
-* @param value The Byte you want to write.  e.g. 0x12 to write 00010010 
-* @return success: 1, failure: -1
+* @param channel channel number (0-8)
+* @return ADC_STATE_BELOW (-1), ADC_STATE_INSIDE (0) or ADC_STATE_ABOVE (1)
 *
 * @~german
-* @brief Schreibt ein Byte an einen kompletten Port
+* @brief Aktueller Fenster-Zustand eines Kanals.
 *
-* Mit dieser Funktion kann man ein komplettes Byte an einen ganzen Port des PCA9555 schreiben.
-* @param port Nummer des Ports (0-1)
-* @param value Das Byte, dass man schreiben möchte. z.B. 0x12 um 00010010 zu schreiben. 
-* @return Erfolg: 1, Misserfolg: -1
+* @param channel Kanalnummer (0-8)
+* @return ADC_STATE_BELOW (-1), ADC_STATE_INSIDE (0) oder ADC_STATE_ABOVE (1)
 */
-int gnublin_module_pca9555::writePort(int port, unsigned char value){
-	error_flag=false;
-	unsigned char buffer[1];
-	buffer[0]=value;
+int gnublin_adc_comparator::getState(int channel){
+	if (channel < 0 || channel >= ADC_COMPARATOR_CHANNELS)
+		return ADC_STATE_INSIDE;
+	return state[channel];
+}
 
-	if(port==0){ // Port 0
-		if(i2c.send(0x02, buffer, 1)>0){
-			return 1;
-		}
-		else {
-			error_flag=true;
-			ErrorMessage="i2c.send Error";
-			return -1;
-		}
-	}
-	else if(port==1){
-		if(i2c.send(0x03, buffer, 1)>0){
-			return 1;
-		}
-		else {
-			error_flag=true;
-			ErrorMessage="i2c.send Error";
-			return -1;
-		}
-	}		
-	else{
-		error_flag=true;
-		ErrorMessage="Pin Number is not between 0-1";
-		return -1;		
-	}
-	
+void gnublin_adc_comparator::emit(int type, const gnublin_adc_sample &sample){
+	gnublin_event event;
+
+	if (!queue)
+		return;
+	event.type = type;
+	event.device = 0;
+	event.source = sample.channel;
+	event.value = sample.value;
+	event.timestamp = sample.timestamp;
+	queue->push(event);
 }
 
-//-----------------------------------digital read-----------------------------------
+//-------------check-------------
 /** @~english
-* @brief reads the state of an input pin and returns it
+* @brief Check a sample against window and rate limit of its channel.
 *
-* With this function you can read the level of an input pin.
-* @param pin Number of the pin (0-15) you want to read from
-* @return 0/1 logical level of the pin, failure: -1
+* Called by gnublin_adc_sampler for every sample, can also be called directly.
+* @param sample the sample
+* @return number of events sent
 *
 * @~german
-* @brief Liest den Zustand eins Eingang-Pins und gibt ihn zurück
+* @brief Prüft einen Wert gegen Fenster und Anstiegsgrenze seines Kanals.
 *
-* Mit dieser Funktion kann man den Zustand eines Pins auslesen.
-* @param pin Nummer des Pins (0-15) von dem man lesen will.
-* @return 0/1 logischer Pegel des Pins, Misserfolg: -1
+* Wird von gnublin_adc_sampler für jeden Wert aufgerufen, kann auch direkt aufgerufen werden.
+* @param sample der Wert
+* @return Anzahl der gesendeten Ereignisse
 */
-int gnublin_module_pca9555::digitalRead(int pin) {
-	error_flag=false;
-	unsigned char RxBuf[1];
+int gnublin_adc_comparator::check(const gnublin_adc_sample &sample){
+	int c = sample.channel;
+	int v = sample.value;
+	int events = 0;
 
-	if (pin < 0 || pin > 15){
-		error_flag=true;
-		ErrorMessage="Pin Number is not between 0-15\n";
-		return -1;
-	}
-	
-	if(pin >= 0 && pin <= 7){ // Port 0		
-		if(i2c.receive(0x00, RxBuf, 1)>0){
-
-				RxBuf[0]<<=(7-pin); // MSB is now the pin you want to read from
-				RxBuf[0]&=128; // set all bits to 0 except the MSB
-		
-				if(RxBuf[0]==0){
-					return 0;
-				}
-				else if (RxBuf[0]==128){
-					return 1;
-				}
-				else{
-					error_flag=true;
-					ErrorMessage="bitshift failed\n";
-					return -1;
-				}
-		}
-		else{
-			error_flag=true;
-			ErrorMessage="i2c.receive Error";
-			return -1;
-		}
-	}
-	else if(pin >= 8 && pin <= 15){ // Port 1
-		if(i2c.receive(0x01, RxBuf, 1)>0){
+	if (c < 0 || c >= ADC_COMPARATOR_CHANNELS)
+		return 0;
 
-				RxBuf[0]<<=(15-pin); // MSB is now the pin you want to read from
-				RxBuf[0]&=128;	// set all bits to 0 except the MSB	
-		
-				if(RxBuf[0]==0){
-					return 0;
-				}
-				else if (RxBuf[0]==128){
-					return 1;
-				}
-				else{
-					error_flag=true;
-					ErrorMessage="bitshift failed\n";
-					return -1;
-				}
+	if (window[c]) {
+		int next = state[c];
+		if (!primed[c])
+			next = v > high[c] ? ADC_STATE_ABOVE : v < low[c] ? ADC_STATE_BELOW : ADC_STATE_INSIDE;
+		else if (v > high[c])
+			next = ADC_STATE_ABOVE;
+		else if (v < low[c])
+			next = ADC_STATE_BELOW;
+		else if (state[c] == ADC_STATE_ABOVE && v < high[c] - hysteresis[c])
+			next = ADC_STATE_INSIDE;
+		else if (state[c] == ADC_STATE_BELOW && v > low[c] + hysteresis[c])
+			next = ADC_STATE_INSIDE;
+
+		// the first sample only reports a state outside of the window
+		if (next != state[c] || (!primed[c] && next != ADC_STATE_INSIDE)) {
+			emit(next == ADC_STATE_ABOVE ? EVENT_ADC_ABOVE : next == ADC_STATE_BELOW ? EVENT_ADC_BELOW : EVENT_ADC_INSIDE, sample);
+			events++;
 		}
-		else{
-			error_flag=true;
-			ErrorMessage="i2c.receive Error";
-			return -1;
+		state[c] = next;
+	}
+
+	if (rate[c] && primed[c] && sample.timestamp > last_time[c]) {
+		long long delta = v - last_value[c];
+		bool exceeded;
+		if (delta < 0)
+			delta = -delta;
+		exceeded = delta * 1000000 > (long long)rate[c] * (long long)(sample.timestamp - last_time[c]);
+		if (exceeded && !rate_exceeded[c]) {
+			emit(EVENT_ADC_RATE, sample);
+			events++;
 		}
+		rate_exceeded[c] = exceeded;
 	}
-	error_flag=true;
-	ErrorMessage="something went wrong";
-	return -1;
+	primed[c] = true;
+	last_value[c] = v;
+	last_time[c] = sample.timestamp;
+	return events;
 }
 
+//***************************************************************************
+// Class for accesing the GNUBLIN MODULE-DISPLAY 2x16
+//***************************************************************************
 
-//****************************************************************************
-// Class for easy use of the GNUBLIN Module-Relay
-//****************************************************************************
 
+//********** Constructor ***************************
 
-//------------------Konstruktor------------------
-/** @~english 
-* @brief Set standards.
+/**
+* @~english
+* @brief Set the default RS-PIN
 *
-* Set standard i2c address 0x20, set ErrorFlag false
-* @~german 
-* @brief Setze Standartwerte.
+* Default RS-Pin:
+* GNUBLIN: GPIO14
+* RASPBERRY PI: GPIO4
 *
-* Setze standard i2c Adresse 0x20 und setze das ErrorFlag auf false.
+* @~german
+* @brief Setzt die standard RS-Pins
+*
+* Standard RS-Pin:
+* GNUBLIN: GPIO14
+* RASPBERRY PI: GPIO4
 */
-gnublin_module_relay::gnublin_module_relay() {
-	error_flag=false;
-	setAddress(0x20);
+gnublin_module_dogm::gnublin_module_dogm(){
+
+#if (BOARD == RASPBERRY_PI)
+	rs_pin = 4;
+#else
+	rs_pin = 14;
+#endif
+	gpio.pinMode(rs_pin, OUTPUT);
+	init_flag = false;
+	error_flag = false;	
 }
 
+//********* init()**********************************
+// execute initialisation of the display
+// parameters: 	NONE
+// return: 	* [int] 1	for success
+//		* [int] -1  	for failure
 
-//-------------getErrorMessage-------------
-/** @~english 
-* @brief Get the last Error Message.
+/**
+* @~english
+* @brief Initialisizes the Display
 *
-* This Funktion returns the last Error Message, which occurred in that Class.
-* @return ErrorMessage as c-string
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Initialisiert das Display
+*
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_dogm::init(){
+	__u8 init_str[] = {0x39, 0x14, 0x55, 0x6D, 0x78, 0x38, 0x0C, 0x01, 0x06};
+	if (gpio.digitalWrite(rs_pin, LOW) <0){
+			error_flag = true;
+			return -1;
+	}
+	spi.setSpeed(100000);
+	if (spi.send(init_str, 9) < 0){
+		error_flag = true;
+		return -1;
+	}
+	init_flag = true;
+	error_flag = false;
+	return 1;
+}
+
+
+//************ fail() *******************************
+
+/**
+* @~english
+* @brief Returns the errorflag to detect error in the previous called method.
+*
+* @return error_flag
+*
+* @~german
+* @brief Gibt das errorflag zurück, um Fehler in der zuvor aufgerugfenen Methode zu erkennen.
+*
+* @return error_flag
+*/
+bool gnublin_module_dogm::fail(){
+	return error_flag;
+}
+
+
+//-------------get Error Message-------------
+/**
+* @~english
+* @brief Returns the ErrorMessage of the previous error if one exist.
+*
+* @return ErrorMessage as C-String
+*
+* @~german
+* @brief Gibt die Fehlernachricht des zuvor aufgetretenen Fehlers zurück, wenn weine exisitert.
+*
+* @return ErrorMessage als C-String
+*/
+const char *gnublin_module_dogm::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+
+//*********** setRsPin() *****************************
+
+/**
+* @~english
+* @brief Set the custom RS pin
+*
+* @param pin Number of the RS-pin
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Setzt den benutzerdefinierten RS-Pin.
+*
+* @param pin Nummer des RS-Pin
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_dogm::setRsPin(int pin){
+	rs_pin = pin;
+	gpio.pinMode(rs_pin, OUTPUT);
+	return 1;
+}
+
+
+//*********** setCS ************************************
+
+/**
+* @~english
+* @brief Set the custom chipselect pin
+*
+* @param cs Number of the chipselect-pin
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Setzt den benutzerdefinierten Chipselect-Pin.
+*
+* @param cs Nummer des Chipselect-Pin
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_dogm::setCS(int cs){
+	if (spi.setCS(cs) < 0){
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
+
+
+//************ print() **********************************
+
+/**
+* @~english
+* @brief Print string on display
+*
+* @param buffer buffor of the string
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Schreibt String auf das Display
+*
+* @param buffer Buffer für den String
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_dogm::print(char* buffer){
+	__u8 tmp[32];
+	int len = strlen(buffer);
+	if(!init_flag){
+		init();
+	}
+	for(int i=0; i<len; i++){
+		tmp[i] = buffer[i];
+	}
+	gpio.digitalWrite(rs_pin, HIGH);
+	if (spi.send(tmp, len) < 0){
+		gpio.digitalWrite(rs_pin, LOW);
+		error_flag = true;
+		return -1;
+	}
+	gpio.digitalWrite(rs_pin, LOW);
+	error_flag = false;
+	return 1;
+}
+
+
+//************ print() **********************************
+
+/**
+* @~english
+* @brief Print string on a specific line of the display
+*
+* @param buffer buffor of the string
+* @param line number of the line (1,2)
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Schreibt String in eine bestimmte Zeile des Displays
+*
+* @param buffer Buffer für den String
+* @param line Zeilenenummer (1,2)
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_dogm::print(char* buffer, int line){
+	error_flag = false;
+	if(!init_flag){
+		init();
+	}
+	if (returnHome() < 0){
+		return -1;
+	}
+	if (line == 1){
+		print(buffer);
+	}
+	else if (line == 2) {
+		offset(16);
+		print(buffer);
+	}
+	else {
+		error_flag = true;
+		return -1;
+	}
+	return -1;
+}
+
+
+//************ print() **********************************
+
+/**
+* @~english
+* @brief Print string on a specific line with given offset on the display
+*
+* @param buffer buffor of the string
+* @param line number of the line (1,2)
+* @param off number of elements for the offset
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Schreibt String in eine bestimmte Zeile mit gegebenem Offset auf das Displays
+*
+* @param buffer Buffer für den String
+* @param line Zeilenenummer (1,2)
+* @param off Anzahl der Positionen, um die verschoben werden soll
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_dogm::print(char* buffer, int line, int off){
+	error_flag = false;
+	if(!init_flag){
+		init();
+	}
+	returnHome();
+	if (line == 1){
+		offset(off);
+		print(buffer);
+	}
+	else if (line == 2) {
+		off +=16;
+		offset(off);
+		print(buffer);
+	}
+	else {
+		error_flag = true;
+		return -1;
+	}
+	return -1;
+}
+
+
+//****************** offset() **********************************
+
+/**
+* @~english
+* @brief Set an offset to the display
+*
+* @param num Number of the element on which the cursor will be set
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Setzt den Cursor an eine bestimmte Position
+*
+* @param num Nummber der Zeichnposition an die der Cursor gesetzt werden soll
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_dogm::offset(int num){
+	__u8 tmp;
+	if(!init_flag){
+		char init_str[2] = " ";
+		init();
+		print(init_str);
+	}
+	if (num >= 0 && num < 16){
+		tmp = num + 128;
+	}
+	else if (num >= 16 && num < 32){
+		tmp = num - 16 + 192;
+	}
+	else {
+		error_flag = true;
+		return -1;
+	}
+	if (spi.send(&tmp, 1) < 0){
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
+
+
+//*************** clear() ****************************************
+
+/**
+* @~english
+* @brief clear the display
+*
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Löscht den Inhalt des Displays.
+*
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_dogm::clear(){
+	__u8 clear_cmd = 0x01;
+	if(!init_flag){
+		init();
+	}
+	if (spi.send(&clear_cmd, 1) < 0){
+		error_flag = true;
+		return -1;
+	}
+	return 1;
+}
+
+
+//**************** returnHome() ************************************
+
+/**
+* @~english
+* @brief Reset the Display
+*
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Resetet das Display.
+*
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_dogm::returnHome(){
+	__u8 return_cmd = 0x02;
+	if(!init_flag){
+		init();
+	}
+	if (spi.send(&return_cmd, 1) < 0){
+		error_flag = true;
+		return -1;
+	}
+	return 1;
+}	
+
+
+//**************** shift() *****************************************
+
+/**
+* @~english
+* @brief Shift the whole display
+*
+* @param num Number of shifts, positive: right, negativ: left
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Verschiebt das ganze Display
+*
+* @param num Anzahl der zu verschiebenden Positionen, positiv: rechts, negativ: left
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_dogm::shift(int num){
+	__u8 shift_cmd;
+	if(!init_flag){
+		init();
+	}
+	if (num > 0){
+		shift_cmd = 0x1C;
+		for (int i=0; i < num; i++){
+			if(spi.send(&shift_cmd, 1) < 0){
+				error_flag = true;
+				return -1;
+			}
+		}
+	}
+	else if (num < 0){
+		shift_cmd = 0x18;
+		for (int i=0; i > num; i--){
+			if(spi.send(&shift_cmd, 1) < 0){
+				error_flag = true;
+				return -1;
+			}
+		}
+	}
+	else {
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
+
+
+//*********************** controlDisplay() **********************************
+
+/**
+* @~english
+* @brief Set display parameters
+*
+* @param power switch display on(1) or off(0)  (not the chontrollerchip)
+* @param cursor switch cursor on(1) or off(0)
+* @param blink switch the vlinking of the cursor on(1) or off(0)
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Setzt Displayparameter.
+*
+* @param power Display an(1) oder aus(0) schalten (nicht den Displaycontroller)
+* @param cursor Schatet den Cursor an(1) oder aus(0)
+* @param blink Schaltet das Blinken des Cursors an(1) oder aus(0)
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_dogm::controlDisplay(int power, int cursor, int blink) {
+	__u8 display_cmd = 0x08;
+	if(!init_flag){
+		init();
+	}
+	if (power == 1) {
+		display_cmd += 0x04;
+	}
+	if (cursor == 1) {
+		display_cmd += 0x02;
+	}
+	if (blink == 1) {
+		display_cmd += 0x01;
+	}
+	if (spi.send(&display_cmd, 1) < 0){
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
+
+// temperature register (MSByte, LSByte) to milli degree celsius:
+// the 11 bit two's complement value sits in the upper bits, an arithmetic
+// shift sign extends it and one LSB is 0.125 degree = 125 milli degree
+static inline int lm75Decode(const unsigned char *buf){
+	return ((short)(buf[0] << 8 | buf[1]) >> 5) * 125;
+}
+//*******************************************************************
+//Class for accessing the LM75 IC via I2C
+//*******************************************************************
+
+//------------------Konstruktor------------------
+/** @~english 
+* @brief Sets the error_flag to "false" and the standard i2c Address to 0x4f
+*
+* @~german 
+* @brief Setzt das error_flag auf "false" und die Standard i2c Adresse auf 0x4f
+*
+*/
+gnublin_module_lm75::gnublin_module_lm75()
+{
+	error_flag=false;
+	config=-1;
+	conversion_ms=LM75_CONVERSION_MS;
+	os_edge=NULL;
+	os_events=NULL;
+	alarm_queue=NULL;
+	alarm_pin=-1;
+	alarmed=false;
+	setAddress(0x4f);
+}
+
+
+//------------------Destruktor------------------
+/** @~english 
+* @brief Stops watching the OS pin
+*
+* @~german 
+* @brief Beendet die Überwachung des OS Pins
+*
+*/
+gnublin_module_lm75::~gnublin_module_lm75()
+{
+	detachAlarm();
+}
+
+
+//-------------get Error Message-------------
+/** @~english 
+* @brief Get the last Error Message.
+*
+* This function returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german 
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_module_lm75::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------------------------Fail-------------------------------
+/** @~english 
+* @brief returns the error flag to check if the last operation went wrong
+*
+* @return error_flag as boolean
+*
+* @~german 
+* @brief Gibt das error_flag zurück um zu überprüfen ob die vorangegangene Operation einen Fehler auweist
+*
+* @return error_flag als bool
+*/
+bool gnublin_module_lm75::fail(){
+	return error_flag;
+}
+
+//-------------set Address-------------
+/** @~english 
+* @brief Set the i2c slave address 
+*
+* With this function you can set the individual I2C Slave-Address.
+* @param Address new I2C slave Address
+*
+* @~german 
+* @brief Setzt die i2c slave Adresse
+*
+* Mit dieser Funktion kann die individuelle I2C Slave-Adresse gesetzt werden.
+* @param Address neue I2C slave Adresse
+*/
+void gnublin_module_lm75::setAddress(int Address){
+	i2c.setAddress(Address);
+	config=-1;
+}
+
+
+//-------------------set devicefile----------------
+/** @~english
+* @brief set i2c the device file. default is "/dev/i2c-1"
+*
+* This function sets the devicefile you want to access. by default "/dev/i2c-1" is set.
+* @param filename path to the devicefile e.g. "/dev/i2c-0"
+*
+* @~german
+* @brief setzt die I2C Device Datei. Standard ist die "/dev/i2c-1"
+*
+* Diese Funktion setzt die Geräte Datei, auf die man zugreifen möchte. Standardmäßig ist bereits "/dev/i2c-1" gesetzt.
+* @param filename Dateipfad zur Geräte Datei, z.B. "/dev/i2c-0"
+*/
+void gnublin_module_lm75::setDevicefile(std::string filename){
+	i2c.setDevicefile(filename);
+	config=-1;
+}
+
+
+//-----------------------------------get Temp-----------------------------------
+/** @~english
+* @brief reads the raw data via i2c from the LM75 chip and calculates the temperature
+*
+* @return Returns the Temperature, 0 at failure (check with fail() and getErrorMessage())
+*
+* @~german
+* @brief liest die Roh-Daten aus dem LM75 und berechnet die Temperatur
+*
+* @return Temperatur, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
+*/
+int gnublin_module_lm75::getTemp(){
+	unsigned char rx_buf[2];
+
+	if (readRaw(rx_buf) < 0)
+		return 0;
+	// integer division truncates towards zero like the old float conversion
+	return lm75Decode(rx_buf) / 1000;
+}
+
+
+//--------------------------------get Temp float--------------------------------
+/** @~english
+* @brief reads the raw data via i2c from the LM75 chip and calculates the temperature
+*
+* @return Returns the Temperature as float, 0 at failure (check with fail() and getErrorMessage())
+*
+* @~german
+* @brief liest die Roh-Daten aus dem LM75 und berechnet die Temperatur
+*
+* @return Temperatur als Fließkommazahl, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
+*/
+float gnublin_module_lm75::getTempFloat(){
+	unsigned char rx_buf[2];
+
+	if (readRaw(rx_buf) < 0)
+		return 0;
+	return lm75Decode(rx_buf) / 1000.0f;
+}
+
+
+//--------------------------------get Value---------------------------------
+/** @~english
+* @brief reads the raw data via i2c from the LM75 chip and shift the bits correctly
+*
+* @return Returns raw value, already shifted. 0 at failure (check with fail() and getErrorMessage())
+*
+* @~german
+* @brief liest die Roh-Daten aus dem LM75 und schiebt die Bits in die richtige Reihenfolge
+*
+* @return Rohwert, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
+*/
+short gnublin_module_lm75::getValue(){
+	unsigned char rx_buf[2];
+
+	if (readRaw(rx_buf) < 0)
+		return 0;
+	// Bit 0-4 isn't used in the LM75, so shift right 5 times
+	return (short)(rx_buf[0] << 8 | rx_buf[1]) >> 5;
+}
+
+
+// reads the temperature register, rx_buf[0] = MSByte, rx_buf[1] = LSByte
+int gnublin_module_lm75::readRaw(unsigned char *rx_buf){
+	error_flag=false;
+	if(i2c.receive(0x00, rx_buf, 2)<0){
+		error_flag=true;
+		ErrorMessage="Error i2c receive\n";
+		return -1;
+	}
+	return 1;
+}
+
+
+
+//--------------------------------get Config--------------------------------
+/** @~english
+* @brief reads the configuration register
+*
+* Bit 0: shutdown, bit 1: interrupt mode, bit 2: OS active high, bit 3-4: fault queue
+* @return configuration register, -1 at failure
+*
+* @~german
+* @brief liest das Konfigurationsregister
+*
+* Bit 0: Shutdown, Bit 1: Interrupt Modus, Bit 2: OS aktiv high, Bit 3-4: Fehlerwarteschlange
+* @return Konfigurationsregister, im Fehlerfall -1
+*/
+int gnublin_module_lm75::getConfig(){
+	unsigned char value;
+
+	error_flag=false;
+	if(i2c.receive(LM75_CONFIG, &value, 1)<0){
+		error_flag=true;
+		ErrorMessage="Error i2c receive\n";
+		return -1;
+	}
+	config=value;
+	return config;
+}
+
+
+//--------------------------------set Config--------------------------------
+/** @~english
+* @brief writes the configuration register
+*
+* @param value new configuration, see getConfig()
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief schreibt das Konfigurationsregister
+*
+* @param value neue Konfiguration, siehe getConfig()
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::setConfig(int value){
+	unsigned char tx_buf = value & 0x1f;
+
+	error_flag=false;
+	if(i2c.send(LM75_CONFIG, &tx_buf, 1)<0){
+		error_flag=true;
+		ErrorMessage="Error i2c send\n";
+		config=-1;
+		return -1;
+	}
+	config=tx_buf;
+	return 1;
+}
+
+// read-modify-write of the configuration register, the register is only read once
+int gnublin_module_lm75::updateConfig(int mask, int bits){
+	if(config<0 && getConfig()<0)
+		return -1;
+	return setConfig((config & ~mask) | bits);
+}
+
+
+//--------------------------------set Mode--------------------------------
+/** @~english
+* @brief sets the mode of the OS output
+*
+* LM75_MODE_COMPARATOR: OS is active while the temperature is above TOS and until it falls below THYST.<br>
+* LM75_MODE_INTERRUPT: OS becomes active when the temperature crosses TOS or THYST and is released by reading any register.
+* @param mode LM75_MODE_COMPARATOR or LM75_MODE_INTERRUPT
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief setzt den Modus des OS Ausgangs
+*
+* LM75_MODE_COMPARATOR: OS ist aktiv, solange die Temperatur über TOS liegt und bis sie unter THYST fällt.<br>
+* LM75_MODE_INTERRUPT: OS wird aktiv, wenn die Temperatur TOS oder THYST überschreitet und wird durch Lesen eines beliebigen Registers zurückgesetzt.
+* @param mode LM75_MODE_COMPARATOR oder LM75_MODE_INTERRUPT
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::setMode(int mode){
+	if(mode!=LM75_MODE_COMPARATOR && mode!=LM75_MODE_INTERRUPT){
+		error_flag=true;
+		ErrorMessage="invalid mode\n";
+		return -1;
+	}
+	return updateConfig(LM75_INTERRUPT, mode ? LM75_INTERRUPT : 0);
+}
+
+
+//--------------------------------set Fault Queue--------------------------------
+/** @~english
+* @brief sets the number of consecutive faults needed to activate OS
+*
+* @param faults 1, 2, 4 or 6
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief setzt die Anzahl aufeinanderfolgender Fehler, die OS aktivieren
+*
+* @param faults 1, 2, 4 oder 6
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::setFaultQueue(int faults){
+	int bits;
+
+	switch(faults){
+		case 1: bits=0x00; break;
+		case 2: bits=0x08; break;
+		case 4: bits=0x10; break;
+		case 6: bits=0x18; break;
+		default:
+			error_flag=true;
+			ErrorMessage="fault queue is not 1, 2, 4 or 6\n";
+			return -1;
+	}
+	return updateConfig(LM75_FAULT_QUEUE, bits);
+}
+
+
+//--------------------------------set Polarity--------------------------------
+/** @~english
+* @brief sets the polarity of the OS output
+*
+* @param active_high true: OS is active high, false: OS is active low (default)
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief setzt die Polarität des OS Ausgangs
+*
+* @param active_high true: OS ist aktiv high, false: OS ist aktiv low (Standard)
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::setPolarity(bool active_high){
+	return updateConfig(LM75_OS_ACTIVE_HIGH, active_high ? LM75_OS_ACTIVE_HIGH : 0);
+}
+
+
+//--------------------------------set Shutdown--------------------------------
+/** @~english
+* @brief switches the shutdown mode
+*
+* In shutdown mode the LM75 stops converting and draws only a few µA, the registers stay accessible.
+* @param shutdown true: shutdown, false: normal operation
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief schaltet den Shutdown Modus
+*
+* Im Shutdown Modus stoppt der LM75 die Wandlung und benötigt nur wenige µA, die Register bleiben zugänglich.
+* @param shutdown true: Shutdown, false: normaler Betrieb
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::setShutdown(bool shutdown){
+	return updateConfig(LM75_SHUTDOWN, shutdown ? LM75_SHUTDOWN : 0);
+}
+
+
+// TOS and THYST: 9 bit two's complement in the upper bits, 1 LSB = 0.5 degree
+int gnublin_module_lm75::writeThreshold(unsigned char reg, int temp){
+	unsigned char tx_buf[2];
+	short value;
+
+	if(temp<-55000 || temp>125000){
+		error_flag=true;
+		ErrorMessage="temperature is not between -55000 and 125000\n";
+		return -1;
+	}
+	value=(short)(temp/500*128);
+	tx_buf[0]=value>>8;
+	tx_buf[1]=value&0xff;
+	error_flag=false;
+	if(i2c.send(reg, tx_buf, 2)<0){
+		error_flag=true;
+		ErrorMessage="Error i2c send\n";
+		return -1;
+	}
+	return 1;
+}
+
+int gnublin_module_lm75::readThreshold(unsigned char reg){
+	unsigned char rx_buf[2];
+
+	error_flag=false;
+	if(i2c.receive(reg, rx_buf, 2)<0){
+		error_flag=true;
+		ErrorMessage="Error i2c receive\n";
+		return 0;
+	}
+	return ((short)(rx_buf[0] << 8 | rx_buf[1]) >> 7) * 500;
+}
+
+
+//--------------------------------set Tos--------------------------------
+/** @~english
+* @brief sets the overtemperature shutdown threshold
+*
+* @param temp threshold in milli degree celsius (-55000 to 125000), rounded towards 0 to 0.5 degree
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief setzt die Übertemperatur-Schwelle
+*
+* @param temp Schwelle in tausendstel Grad Celsius (-55000 bis 125000), wird in Richtung 0 auf 0,5 Grad gerundet
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::setTos(int temp){
+	return writeThreshold(LM75_TOS, temp);
+}
+
+
+//--------------------------------set Thyst--------------------------------
+/** @~english
+* @brief sets the hysteresis threshold
+*
+* @param temp threshold in milli degree celsius (-55000 to 125000), rounded towards 0 to 0.5 degree
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief setzt die Hysterese-Schwelle
+*
+* @param temp Schwelle in tausendstel Grad Celsius (-55000 bis 125000), wird in Richtung 0 auf 0,5 Grad gerundet
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::setThyst(int temp){
+	return writeThreshold(LM75_THYST, temp);
+}
+
+
+//--------------------------------get Tos--------------------------------
+/** @~english
+* @brief reads the overtemperature shutdown threshold
+*
+* @return threshold in milli degree celsius, 0 at failure (check with fail() and getErrorMessage())
+*
+* @~german
+* @brief liest die Übertemperatur-Schwelle
+*
+* @return Schwelle in tausendstel Grad Celsius, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
+*/
+int gnublin_module_lm75::getTos(){
+	return readThreshold(LM75_TOS);
+}
+
+
+//--------------------------------get Thyst--------------------------------
+/** @~english
+* @brief reads the hysteresis threshold
+*
+* @return threshold in milli degree celsius, 0 at failure (check with fail() and getErrorMessage())
+*
+* @~german
+* @brief liest die Hysterese-Schwelle
+*
+* @return Schwelle in tausendstel Grad Celsius, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
+*/
+int gnublin_module_lm75::getThyst(){
+	return readThreshold(LM75_THYST);
+}
+
+
+//--------------------------------set Conversion Time--------------------------------
+/** @~english
+* @brief sets the time getTempOneShot() waits for the conversion
+*
+* The default is 100 ms, some LM75 variants need up to 300 ms.
+* @param ms conversion time in ms
+*
+* @~german
+* @brief setzt die Zeit, die getTempOneShot() auf die Wandlung wartet
+*
+* Standard sind 100 ms, manche LM75 Varianten benötigen bis zu 300 ms.
+* @param ms Wandlungszeit in ms
+*/
+void gnublin_module_lm75::setConversionTime(int ms){
+	conversion_ms=ms;
+}
+
+
+//--------------------------------get Temp One Shot--------------------------------
+/** @~english
+* @brief wakes the LM75 from shutdown mode for one conversion
+*
+* Leaves shutdown mode, waits for one conversion, reads the temperature and enters shutdown mode again.
+* Between the calls the sensor stays in shutdown mode.
+* @return temperature in milli degree celsius, 0 at failure (check with fail() and getErrorMessage())
+*
+* @~german
+* @brief weckt den LM75 für eine Wandlung aus dem Shutdown Modus
+*
+* Verlässt den Shutdown Modus, wartet eine Wandlung ab, liest die Temperatur und geht wieder in den Shutdown Modus.
+* Zwischen den Aufrufen bleibt der Sensor im Shutdown Modus.
+* @return Temperatur in tausendstel Grad Celsius, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
+*/
+int gnublin_module_lm75::getTempOneShot(){
+	unsigned char rx_buf[2];
+	int temp;
+
+	if(setShutdown(false)<0)
+		return 0;
+	usleep(conversion_ms*1000);
+	if(readRaw(rx_buf)<0){
+		setShutdown(true);
+		error_flag=true;
+		return 0;
+	}
+	temp=lm75Decode(rx_buf);
+	if(setShutdown(true)<0)
+		return 0;
+	return temp;
+}
+
+
+//--------------------------------attach Alarm--------------------------------
+/** @~english
+* @brief delivers the OS output, connected to a GPIO, as events
+*
+* Every edge of the OS pin reads the temperature and delivers EVENT_TEMP_ALARM when OS becomes active
+* and EVENT_TEMP_CLEAR when it is released in comparator mode (source: pin, device: I2C address, value: temperature in milli degree celsius).
+* In interrupt mode the read releases OS again, so the next crossing is reported without further action. There OS becomes active above TOS and below THYST in turn,
+* the activation above TOS delivers EVENT_TEMP_ALARM, the one below THYST EVENT_TEMP_CLEAR.
+* The host can block in gnublin_event_queue::wait() instead of polling the temperature.
+* @param pin GPIO the OS output is connected to
+* @param queue queue which receives the events
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief liefert den an einen GPIO angeschlossenen OS Ausgang als Ereignisse
+*
+* Jede Flanke am OS Pin liest die Temperatur und liefert EVENT_TEMP_ALARM, wenn OS aktiv wird,
+* und EVENT_TEMP_CLEAR, wenn es im Komparator Modus zurückgesetzt wird (source: Pin, device: I2C Adresse, value: Temperatur in tausendstel Grad Celsius).
+* Im Interrupt Modus setzt das Lesen OS wieder zurück, so dass die nächste Überschreitung ohne weiteres Zutun gemeldet wird. Dort wird OS abwechselnd über TOS und unter THYST aktiv,
+* die Aktivierung über TOS liefert EVENT_TEMP_ALARM, die unter THYST EVENT_TEMP_CLEAR.
+* Der Host kann in gnublin_event_queue::wait() blockieren, anstatt die Temperatur abzufragen.
+* @param pin GPIO, an den der OS Ausgang angeschlossen ist
+* @param queue Warteschlange, die die Ereignisse erhält
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::attachAlarm(int pin, gnublin_event_queue *queue){
+	detachAlarm();
+	if(config<0 && getConfig()<0)
+		return -1;
+	alarm_queue=queue;
+	alarm_i2c=i2c;
+	alarm_pin=pin;
+	alarmed=false;
+	os_events=new gnublin_event_queue();
+	os_events->setCallback(osCallback, this);
+	os_edge=new gnublin_gpio_edge();
+	if(os_edge->watch(pin, "both", os_events)<0){
+		ErrorMessage=os_edge->getErrorMessage();
+		detachAlarm();
+		error_flag=true;
+		return -1;
+	}
+	error_flag=false;
+	return 1;
+}
+
+
+//--------------------------------detach Alarm--------------------------------
+/** @~english
+* @brief stops delivering the OS output as events
+*
+* @~german
+* @brief beendet die Lieferung des OS Ausgangs als Ereignisse
+*/
+void gnublin_module_lm75::detachAlarm(){
+	// deleting the edge object joins its thread, so no callback runs afterwards
+	delete os_edge;
+	delete os_events;
+	os_edge=NULL;
+	os_events=NULL;
+	alarm_queue=NULL;
+	alarm_pin=-1;
+}
+
+// called from the edge thread for every edge of the OS pin
+void gnublin_module_lm75::osCallback(const gnublin_event *event, void *arg){
+	gnublin_module_lm75 *lm75=(gnublin_module_lm75 *)arg;
+	bool active_high=lm75->config & LM75_OS_ACTIVE_HIGH;
+	bool active=(event->value != 0) == active_high;
+	unsigned char rx_buf[2];
+	gnublin_event alarm;
+
+	if(lm75->config & LM75_INTERRUPT){
+		// only the activation is of interest, the release is caused by our own read;
+		// OS becomes active above TOS and below THYST in turn
+		if(!active)
+			return;
+		lm75->alarmed=!lm75->alarmed;
+		active=lm75->alarmed;
+	}
+	alarm.type=active ? EVENT_TEMP_ALARM : EVENT_TEMP_CLEAR;
+	alarm.device=lm75->alarm_i2c.getAddress();
+	alarm.source=lm75->alarm_pin;
+	alarm.value=0;
+	alarm.timestamp=event->timestamp;
+	if(lm75->alarm_i2c.receive(LM75_TEMP, rx_buf, 2)>0)
+		alarm.value=lm75Decode(rx_buf);
+	lm75->alarm_queue->push(alarm);
+}
+
+//*******************************************************************
+//Class for reading several LM75 on one or more I2C buses
+//*******************************************************************
+
+//------------------Konstruktor------------------
+/** @~english 
+* @brief Creates an empty sensor group
+*
+* @~german 
+* @brief Erzeugt eine leere Sensorgruppe
+*
+*/
+gnublin_lm75_group::gnublin_lm75_group(){
+	sensor_count = 0;
+	bus_count = 0;
+	error_flag = false;
+}
+
+
+//-------------get Error Message-------------
+/** @~english 
+* @brief Get the last Error Message.
+*
+* This function returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german 
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_lm75_group::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------------------------Fail-------------------------------
+/** @~english 
+* @brief returns the error flag to check if the last operation went wrong
+*
+* @return error_flag as boolean
+*
+* @~german 
+* @brief Gibt das error_flag zurück um zu überprüfen ob die vorangegangene Operation einen Fehler auweist
+*
+* @return error_flag als bool
+*/
+bool gnublin_lm75_group::fail(){
+	return error_flag;
+}
+
+
+//-------------------------------add Sensor-------------------------------
+/** @~english 
+* @brief adds a LM75 on the default bus "/dev/i2c-1"
+*
+* @param address I2C slave address (0x48-0x4f)
+* @return index of the sensor in the temperature array, -1 at failure
+*
+* @~german 
+* @brief fügt einen LM75 am Standard Bus "/dev/i2c-1" hinzu
+*
+* @param address I2C Slave Adresse (0x48-0x4f)
+* @return Index des Sensors im Temperatur-Array, -1 im Fehlerfall
+*/
+int gnublin_lm75_group::addSensor(int address){
+	return addSensor("/dev/i2c-1", address);
+}
+
+/** @~english 
+* @brief adds a LM75 on the given bus
+*
+* The sensors are stored in the order they were added, the first sensor has the index 0.
+* @param devicefile path to the devicefile of the bus, e.g. "/dev/i2c-0"
+* @param address I2C slave address (0x48-0x4f)
+* @return index of the sensor in the temperature array, -1 at failure
+*
+* @~german 
+* @brief fügt einen LM75 am angegebenen Bus hinzu
+*
+* Die Sensoren werden in der Reihenfolge gespeichert, in der sie hinzugefügt wurden, der erste Sensor hat den Index 0.
+* @param devicefile Pfad zur Geräte Datei des Busses, z.B. "/dev/i2c-0"
+* @param address I2C Slave Adresse (0x48-0x4f)
+* @return Index des Sensors im Temperatur-Array, -1 im Fehlerfall
+*/
+int gnublin_lm75_group::addSensor(std::string devicefile, int address){
+	int b;
+
+	if (address < 0x48 || address > 0x4f) {
+		error_flag = true;
+		ErrorMessage = "address is not between 0x48-0x4f\n";
+		return -1;
+	}
+	if (sensor_count >= LM75_GROUP_MAX_SENSORS) {
+		error_flag = true;
+		ErrorMessage = "too many sensors\n";
+		return -1;
+	}
+	for (b = 0; b < bus_count; b++)
+		if (buses[b].devicefile == devicefile)
+			break;
+	if (b == bus_count) {
+		if (bus_count >= LM75_GROUP_MAX_BUSES) {
+			error_flag = true;
+			ErrorMessage = "too many buses\n";
+			return -1;
+		}
+		buses[b].devicefile = devicefile;
+		buses[b].i2c.setDevicefile(devicefile);
+		buses[b].count = 0;
+		buses[b].group = this;
+		bus_count++;
+	}
+	for (int i = 0; i < buses[b].count; i++) {
+		if (addresses[buses[b].sensors[i]] == address) {
+			error_flag = true;
+			ErrorMessage = "sensor " + numberToString(address) + " already added\n";
+			return -1;
+		}
+	}
+	buses[b].sensors[buses[b].count++] = sensor_count;
+	addresses[sensor_count] = address;
+	raw[sensor_count][0] = 0;
+	raw[sensor_count][1] = 0;
+	temperatures[sensor_count] = 0;
+	status[sensor_count] = 0;
+	error_flag = false;
+	return sensor_count++;
+}
+
+
+//-------------------------------size-------------------------------
+/** @~english 
+* @brief returns the number of sensors
+*
+* @return number of sensors
+*
+* @~german 
+* @brief gibt die Anzahl der Sensoren zurück
+*
+* @return Anzahl der Sensoren
+*/
+int gnublin_lm75_group::size(){
+	return sensor_count;
+}
+
+
+//-------------------------------update-------------------------------
+/** @~english 
+* @brief reads the temperatures of all sensors
+*
+* All sensors of a bus are read with one I2C transaction, the buses are read in parallel (one thread per additional bus).
+* If the transaction of a bus fails, its sensors are read one by one, so a missing sensor doesn't invalidate the others.
+* @return number of sensors read successfully, -1 if no sensor could be read (check with valid())
+*
+* @~german 
+* @brief liest die Temperaturen aller Sensoren
+*
+* Alle Sensoren eines Busses werden mit einer I2C Transaktion gelesen, die Busse werden parallel gelesen (ein Thread für jeden weiteren Bus).
+* Falls die Transaktion eines Busses fehlschlägt, werden seine Sensoren einzeln gelesen, so dass ein fehlender Sensor die anderen nicht ungültig macht.
+* @return Anzahl der erfolgreich gelesenen Sensoren, -1 wenn kein Sensor gelesen werden konnte (überprüfen mit valid())
+*/
+int gnublin_lm75_group::update(){
+	pthread_t threads[LM75_GROUP_MAX_BUSES];
+	bool started[LM75_GROUP_MAX_BUSES];
+	int ok = 0;
+
+	if (sensor_count == 0) {
+		error_flag = true;
+		ErrorMessage = "no sensors added\n";
+		return -1;
+	}
+	for (int b = 1; b < bus_count; b++) {
+		started[b] = pthread_create(&threads[b], NULL, pollBus, &buses[b]) == 0;
+		if (!started[b])
+			readBus(&buses[b]);
+	}
+	readBus(&buses[0]);
+	for (int b = 1; b < bus_count; b++)
+		if (started[b])
+			pthread_join(threads[b], NULL);
+
+	for (int i = 0; i < sensor_count; i++) {
+		temperatures[i] = lm75Decode(raw[i]);
+		ok += status[i];
+	}
+	if (ok == 0) {
+		error_flag = true;
+		ErrorMessage = buses[0].i2c.getErrorMessage();
+		return -1;
+	}
+	error_flag = false;
+	return ok;
+}
+
+void *gnublin_lm75_group::pollBus(void *arg){
+	lm75_bus *bus = (lm75_bus *)arg;
+
+	bus->group->readBus(bus);
+	return NULL;
+}
+
+// pointer register 0x00 and 2 bytes temperature for every sensor of the bus
+void gnublin_lm75_group::readBus(lm75_bus *bus){
+	struct i2c_msg msgs[2 * LM75_GROUP_BUS_SENSORS];
+	unsigned char pointer = 0x00;
+
+	for (int i = 0; i < bus->count; i++) {
+		int s = bus->sensors[i];
+		msgs[2 * i].addr = addresses[s];
+		msgs[2 * i].flags = 0;
+		msgs[2 * i].len = 1;
+		msgs[2 * i].buf = &pointer;
+		msgs[2 * i + 1].addr = addresses[s];
+		msgs[2 * i + 1].flags = I2C_M_RD;
+		msgs[2 * i + 1].len = 2;
+		msgs[2 * i + 1].buf = raw[s];
+	}
+	if (bus->i2c.transfer(msgs, 2 * bus->count) > 0) {
+		for (int i = 0; i < bus->count; i++)
+			status[bus->sensors[i]] = 1;
+		return;
+	}
+	for (int i = 0; i < bus->count; i++)
+		status[bus->sensors[i]] = bus->i2c.transfer(&msgs[2 * i], 2) > 0;
+}
+
+
+//-------------------------------get Temperatures-------------------------------
+/** @~english 
+* @brief returns the temperatures of the last update()
+*
+* @return array with size() temperatures in milli degree celsius, in the order the sensors were added
+*
+* @~german 
+* @brief gibt die Temperaturen des letzten update() zurück
+*
+* @return Array mit size() Temperaturen in tausendstel Grad Celsius, in der Reihenfolge, in der die Sensoren hinzugefügt wurden
+*/
+const int *gnublin_lm75_group::getTemperatures(){
+	return temperatures;
+}
+
+
+//-------------------------------get Temp-------------------------------
+/** @~english 
+* @brief returns the temperature of one sensor of the last update()
+*
+* @param index index of the sensor
+* @return temperature in milli degree celsius, 0 for an invalid index
+*
+* @~german 
+* @brief gibt die Temperatur eines Sensors des letzten update() zurück
+*
+* @param index Index des Sensors
+* @return Temperatur in tausendstel Grad Celsius, 0 bei ungültigem Index
+*/
+int gnublin_lm75_group::getTemp(int index){
+	if (index < 0 || index >= sensor_count)
+		return 0;
+	return temperatures[index];
+}
+
+
+//-------------------------------valid-------------------------------
+/** @~english 
+* @brief checks if a sensor could be read in the last update()
+*
+* @param index index of the sensor
+* @return true if the temperature is valid
+*
+* @~german 
+* @brief prüft, ob ein Sensor beim letzten update() gelesen werden konnte
+*
+* @param index Index des Sensors
+* @return true, wenn die Temperatur gültig ist
+*/
+bool gnublin_lm75_group::valid(int index){
+	if (index < 0 || index >= sensor_count)
+		return false;
+	return status[index];
+}
+
+
+//*******************************************************************
+//Class for sharing the temperature of one LM75 between threads
+//*******************************************************************
+
+//------------------Konstruktor------------------
+/** @~english 
+* @brief Creates a cache for a LM75
+*
+* @param lm75 the sensor
+* @param ttl_ms time-to-live of a temperature in ms
+*
+* @~german 
+* @brief Erzeugt einen Zwischenspeicher für einen LM75
+*
+* @param lm75 der Sensor
+* @param ttl_ms Gültigkeitsdauer einer Temperatur in ms
+*/
+gnublin_lm75_cache::gnublin_lm75_cache(gnublin_module_lm75 *lm75, int ttl_ms){
+	this->lm75 = lm75;
+	this->ttl_ms = ttl_ms;
+	temp = 0;
+	timestamp = 0;
+	valid = false;
+	reading = false;
+	read_ok = false;
+	generation = 0;
+	reads = 0;
+	error_flag = false;
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&cond, NULL);
+}
+
+gnublin_lm75_cache::~gnublin_lm75_cache(){
+	pthread_cond_destroy(&cond);
+	pthread_mutex_destroy(&mutex);
+}
+
+
+//-------------get Error Message-------------
+/** @~english 
+* @brief Get the last Error Message.
+*
+* This function returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german 
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_lm75_cache::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------------------------Fail-------------------------------
+/** @~english 
+* @brief returns the error flag to check if the last operation went wrong
+*
+* @return error_flag as boolean
+*
+* @~german 
+* @brief Gibt das error_flag zurück um zu überprüfen ob die vorangegangene Operation einen Fehler auweist
+*
+* @return error_flag als bool
+*/
+bool gnublin_lm75_cache::fail(){
+	return error_flag;
+}
+
+
+//-------------------------------set TTL-------------------------------
+/** @~english 
+* @brief sets the time-to-live of a temperature
+*
+* @param ms time-to-live in ms
+*
+* @~german 
+* @brief setzt die Gültigkeitsdauer einer Temperatur
+*
+* @param ms Gültigkeitsdauer in ms
+*/
+void gnublin_lm75_cache::setTTL(int ms){
+	pthread_mutex_lock(&mutex);
+	ttl_ms = ms;
+	pthread_mutex_unlock(&mutex);
+}
+
+
+//-------------------------------get Temp-------------------------------
+/** @~english 
+* @brief returns a temperature which is at most max_age_ms old
+*
+* If the cached temperature is too old, the sensor is read. If another thread is already reading it, this thread waits for that result.<br>
+* max_age_ms = 0 always waits for a new read, max_age_ms = -1 returns any cached temperature and only reads if there is none.
+* This function is thread safe.
+* @param temp the temperature in degree celsius is stored in it
+* @param max_age_ms accepted age in ms
+* @return 1 at success, -1 if the sensor couldn't be read
+*
+* @~german 
+* @brief gibt eine Temperatur zurück, die höchstens max_age_ms alt ist
+*
+* Ist die gespeicherte Temperatur zu alt, wird der Sensor gelesen. Liest ein anderer Thread ihn bereits, wartet dieser Thread auf dessen Ergebnis.<br>
+* max_age_ms = 0 wartet immer auf einen neuen Lesevorgang, max_age_ms = -1 liefert jede gespeicherte Temperatur und liest nur, wenn keine vorhanden ist.
+* Diese Funktion ist threadsicher.
+* @param temp hier wird die Temperatur in Grad Celsius gespeichert
+* @param max_age_ms akzeptiertes Alter in ms
+* @return 1 bei Erfolg, -1 wenn der Sensor nicht gelesen werden konnte
+*/
+int gnublin_lm75_cache::getTemp(float *temp, int max_age_ms){
+	unsigned long long now = getMonotonicTime();
+	bool ok;
+	float value;
+
+	pthread_mutex_lock(&mutex);
+	if (valid && (max_age_ms < 0 || now - timestamp <= (unsigned long long)max_age_ms * 1000)) {
+		*temp = this->temp;
+		pthread_mutex_unlock(&mutex);
+		return 1;
+	}
+	if (reading) {
+		// a read is in flight, its result is younger than our request
+		unsigned int g = generation;
+		while (generation == g)
+			pthread_cond_wait(&cond, &mutex);
+		ok = read_ok;
+		*temp = this->temp;
+		pthread_mutex_unlock(&mutex);
+		return ok ? 1 : -1;
+	}
+	reading = true;
+	pthread_mutex_unlock(&mutex);
+
+	value = lm75->getTempFloat();
+	ok = !lm75->fail();
+
+	pthread_mutex_lock(&mutex);
+	if (ok) {
+		this->temp = value;
+		timestamp = getMonotonicTime();
+		valid = true;
+	}
+	else {
+		ErrorMessage = lm75->getErrorMessage();
+	}
+	read_ok = ok;
+	reads++;
+	reading = false;
+	generation++;
+	pthread_cond_broadcast(&cond);
+	*temp = this->temp;
+	pthread_mutex_unlock(&mutex);
+	return ok ? 1 : -1;
+}
+
+
+//-------------------------------get Temp float-------------------------------
+/** @~english 
+* @brief returns the temperature, the sensor is only read if the cached temperature is older than the TTL
+*
+* @return temperature as float, 0 at failure (check with fail() and getErrorMessage())
+*
+* @~german 
+* @brief gibt die Temperatur zurück, der Sensor wird nur gelesen, wenn die gespeicherte Temperatur älter als die Gültigkeitsdauer ist
+*
+* @return Temperatur als Fließkommazahl, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
+*/
+float gnublin_lm75_cache::getTempFloat(){
+	float value;
+
+	if (getTemp(&value, ttl_ms) < 0) {
+		error_flag = true;
+		return 0;
+	}
+	error_flag = false;
+	return value;
+}
+
+
+//-------------------------------get Age-------------------------------
+/** @~english 
+* @brief returns the age of the cached temperature
+*
+* @return age in ms, -1 if no temperature was read yet
+*
+* @~german 
+* @brief gibt das Alter der gespeicherten Temperatur zurück
+*
+* @return Alter in ms, -1 wenn noch keine Temperatur gelesen wurde
+*/
+int gnublin_lm75_cache::getAge(){
+	int age = -1;
+
+	pthread_mutex_lock(&mutex);
+	if (valid)
+		age = (getMonotonicTime() - timestamp) / 1000;
+	pthread_mutex_unlock(&mutex);
+	return age;
+}
+
+
+//-------------------------------stale-------------------------------
+/** @~english 
+* @brief checks if the cached temperature is older than the TTL
+*
+* @return true if the next getTempFloat() reads the sensor
+*
+* @~german 
+* @brief prüft, ob die gespeicherte Temperatur älter als die Gültigkeitsdauer ist
+*
+* @return true, wenn das nächste getTempFloat() den Sensor liest
+*/
+bool gnublin_lm75_cache::stale(){
+	int age = getAge();
+
+	return age < 0 || age > ttl_ms;
+}
+
+
+//-------------------------------get Reads-------------------------------
+/** @~english 
+* @brief returns the number of sensor reads
+*
+* @return number of I2C reads done by the cache
+*
+* @~german 
+* @brief gibt die Anzahl der Sensor-Lesevorgänge zurück
+*
+* @return Anzahl der vom Zwischenspeicher ausgeführten I2C Lesevorgänge
+*/
+unsigned int gnublin_lm75_cache::getReads(){
+	return reads;
+}
+
+// ADS7830 command byte: SD C2 C1 C0 PD1 PD0 X X, single ended channels 1-8.
+// The power down bits are or'ed in: 0x07 extern reference, 0x0F intern reference.
+static const unsigned char module_adc_commands[MODULE_ADC_CHANNELS] = {
+	0x80, 0xC0, 0x90, 0xD0, 0xA0, 0xE0, 0xB0, 0xF0
+};
+
+//*****************************************************************************
+// Class for accesing GNUBLIN Module-ADC / ADS7830
+//*****************************************************************************
+
+/**
+* @~english
+* @brief Set the default I2C Address and reference to intern
+*
+* Default I2C Address: 0x48
+*
+* @~german
+* @brief Setzt die standard I2C Adresse und die Referenzspannung auf intern
+*
+* Standard I2C Addresse: 0x48
+*/
+gnublin_module_adc::gnublin_module_adc() : calibration(255, 2500) {
+	i2c.setAddress(0x48);
+	reference_flag = IN;
+	error_flag = false;
+}
+
+//-------------get Error Message-------------
+
+/**
+* @~english
+* @brief Returns the ErrorMessage of the previous error if one exist.
+*
+* @return ErrorMessage as C-String
+*
+* @~german
+* @brief Gibt die Fehlernachricht des zuvor aufgetretenen Fehlers zurück, wenn weine exisitert.
+*
+* @return ErrorMessage als C-String
+*/
+const char *gnublin_module_adc::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+
+//------------ fail() -----------------------
+
+/**
+* @~english
+* @brief Returns the errorflag to detect error in the previous called method.
+*
+* @return error_flag
+*
+* @~german
+* @brief Gibt das errorflag zurück, um Fehler in der zuvor aufgerugfenen Methode zu erkennen.
+*
+* @return error_flag
+*/
+bool gnublin_module_adc::fail() {
+	return error_flag;
+}
+
+
+//-------------setAddress-------------
+// set the slave address
+// parameters:		[int]address	i2c slave Address
+// return:		NONE
+/**
+* @~english
+* @brief Set the I2C Address
+*
+* @param address I2C Address
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Setzt die I2C Adresse.
+*
+* @param address I2C Adresse
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_adc::setAddress(int address) {
+	i2c.setAddress(address);
+	if (i2c.fail()) {
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
+
+
+//-------------------setDevicefile----------------
+// set the i2c device file. default is "/dev/i2c-1"
+// parameters:		[string]filename	path to the dev file
+// return:		NONE
+/**
+* @~english
+* @brief Set a custom I2C devicefile
+*
+* default devicefile: "/dev/i2c-1"
+* @param filename path of the devicefile
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Setzt ein benutzerdefiniertes Devicefile.
+*
+* Standard Devicefile ist "/dev/i2c-1"
+* @param filename Pfad zum Devicefile
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_adc::setDevicefile(std::string filename) {
+	i2c.setDevicefile(filename);
+	if (i2c.fail()) {
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
+
+//-------------------setReference() ----------------
+
+/**
+* @~english
+* @brief Set the reverencevoltage to intern or extern
+*
+* This overrides the references loaded with loadCalibration().
+* @param value IN (1) for intern (2.5V), OUT (0) for extern (3.3V)
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Setzt die referenzspannung auf intern oder extern.
+*
+* Dies überschreibt die mit loadCalibration() geladenen Referenzen.
+* @param value IN (1) für intern (2,5V), OUT (0) für extern (3,3V)
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_adc::setReference(int value) {
+	if (value == 0) {
+		calibration.setReference(3300);
+		reference_flag = 0;
+	}
+	else if (value == 1) {
+		calibration.setReference(2500);
+		reference_flag = 1;
+	}
+	else {
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
+
+
+//---------------------- getValue() -----------------------
+
+/**
+* @~english
+* @brief Get a value of an ADC channel in reference to GND
+*
+* @param channel Number of the ADC-channel (1-8)
+* @return value
+*
+* @~german
+* @brief Liefert den Wert eine ADC Ports bezogen zu GND
+*
+* @param channel Nummer des ADC-Ports (1-8)
+* @return Wert
+*/
+int gnublin_module_adc::getValue(int channel) {
+	if (channel < 1 || channel > MODULE_ADC_CHANNELS) {
+		error_flag = true;
+		return -1;
+	}
+	return read(module_adc_commands[channel - 1]);
+}
+
+/**
+* @~english
+* @brief Get a value of an ADC channel in reference to a second ADC channel (differential)
+*
+* This combinations are possible<br>
+* 1 - 2<br>
+* 3 - 4<br>
+* 5 - 6<br>
+* 7 - 8<br>
+* 2 - 1<br>
+* 4 - 3<br>
+* 6 - 5<br>
+* 8 - 7<br>
+* @param channel1 Number of the first ADC-channel 
+* @param channel2 Number of the second ADC-channel
+* @return value
+*
+* @~german
+* @brief Liefert den Wert eines ADC Ports bezogen auf einen zweiten ADC Port (differentielle Messung)
+*
+* Dies Kombinationen sind möglich:<br>
+* 1 - 2<br>
+* 3 - 4<br>
+* 5 - 6<br>
+* 7 - 8<br>
+* 2 - 1<br>
+* 4 - 3<br>
+* 6 - 5<br>
+* 8 - 7<br>
+* @param channel1 Nummer des ersten ADC-Ports
+* @param channel2 Nummer des zweiten ADC-Ports
+* @return Wert
+*/
+int gnublin_module_adc::getValue(int channel1, int channel2) {
+	// the partner of a channel is the other channel of its pair, 1-2, 3-4, ...
+	if (channel1 < 1 || channel1 > MODULE_ADC_CHANNELS || channel2 != ((channel1 - 1) ^ 1) + 1) {
+		error_flag = true;
+		return -1;
+	}
+	// the differential command is the single ended one of channel1 without the SD bit
+	return read(module_adc_commands[channel1 - 1] & 0x7F);
+}
+
+/**
+* @~english
+* @brief Get a value of a channel described at compile time
+*
+* e.g. getValue(gnublin_adc_single_ended<3>()) or getValue(gnublin_adc_differential<2, 1>())<br>
+* The command byte is computed by the compiler, invalid channels and pairs don't compile.
+* @param channel channel descriptor
+* @return value
+*
+* @~german
+* @brief Liefert den Wert eines zur Übersetzungszeit beschriebenen Kanals
+*
+* z.B. getValue(gnublin_adc_single_ended<3>()) oder getValue(gnublin_adc_differential<2, 1>())<br>
+* Das Kommandobyte wird vom Compiler berechnet, ungültige Kanäle und Paare lassen sich nicht übersetzen.
+* @param channel Kanalbeschreibung
+* @return Wert
+*/
+int gnublin_module_adc::getValue(const gnublin_adc_channel &channel) {
+	return read(channel.command);
+}
+
+// one combined transaction: command byte, repeated start, result
+int gnublin_module_adc::read(int command) {
+	unsigned char buf[2];
+	struct i2c_msg msgs[2];
+
+	buf[0] = command | (reference_flag ? 0x0F : 0x07);
+	msgs[0].addr = i2c.getAddress();
+	msgs[0].flags = 0;
+	msgs[0].len = 1;
+	msgs[0].buf = &buf[0];
+	msgs[1].addr = msgs[0].addr;
+	msgs[1].flags = I2C_M_RD;
+	msgs[1].len = 1;
+	msgs[1].buf = &buf[1];
+	if (i2c.transfer(msgs, 2) < 0) {
+		ErrorMessage = i2c.getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return buf[1];
+}
+
+
+//---------------------- scan() -----------------------
+
+/**
+* @~english
+* @brief Read several channels in reference to GND with one I2C transaction
+*
+* For every selected channel the command byte and the read of the result are queued, the whole sequence is executed with one I2C_RDWR call.<br>
+* The value of channel n is stored in values[n-1], values of channels which are not selected are left untouched.
+* @param mask bit n-1 selects channel n, e.g. 0x05 for the channels 1 and 3
+* @param values array with at least 8 elements
+* @return number of channels read, -1 by failure
+*
+* @~german
+* @brief Liest mehrere Kanäle bezogen zu GND mit einer I2C Transaktion
+*
+* Für jeden ausgewählten Kanal werden das Kommandobyte und das Lesen des Ergebnisses eingereiht, die ganze Folge wird mit einem I2C_RDWR Aufruf ausgeführt.<br>
+* Der Wert von Kanal n wird in values[n-1] gespeichert, die Werte nicht ausgewählter Kanäle bleiben unverändert.
+* @param mask Bit n-1 wählt Kanal n aus, z.B. 0x05 für die Kanäle 1 und 3
+* @param values Array mit mindestens 8 Elementen
+* @return Anzahl der gelesenen Kanäle, -1 im Fehlerfall
+*/
+int gnublin_module_adc::scan(int mask, int *values) {
+	unsigned char commands[MODULE_ADC_CHANNELS];
+	unsigned char results[MODULE_ADC_CHANNELS];
+	int selected[MODULE_ADC_CHANNELS];
+	int count = 0;
+
+	if (mask < 1 || mask > 0xFF) {
+		ErrorMessage = "channel mask is not between 0x01-0xFF\n";
+		error_flag = true;
+		return -1;
+	}
+	for (int i = 0; i < MODULE_ADC_CHANNELS; i++) {
+		if (!(mask & (1 << i)))
+			continue;
+		commands[count] = module_adc_commands[i];
+		selected[count] = i;
+		count++;
+	}
+	if (scanCommands(commands, count, results) < 0)
+		return -1;
+	for (int i = 0; i < count; i++)
+		values[selected[i]] = results[i];
+	return count;
+}
+
+/**
+* @~english
+* @brief Read all 8 channels in reference to GND with one I2C transaction
+*
+* @param values array with at least 8 elements, the value of channel n is stored in values[n-1]
+* @return 8, -1 by failure
+*
+* @~german
+* @brief Liest alle 8 Kanäle bezogen zu GND mit einer I2C Transaktion
+*
+* @param values Array mit mindestens 8 Elementen, der Wert von Kanal n wird in values[n-1] gespeichert
+* @return 8, -1 im Fehlerfall
+*/
+int gnublin_module_adc::scanAll(int *values) {
+	return scan(0xFF, values);
+}
+
+/**
+* @~english
+* @brief Read a precomputed scan list with one I2C transaction
+*
+* @param list scan list, see gnublin_adc_scan_list
+* @param values array with at least list.size() elements, the value of the i-th entry is stored in values[i]
+* @return number of values read, -1 by failure
+*
+* @~german
+* @brief Liest eine vorberechnete Scanliste mit einer I2C Transaktion
+*
+* @param list Scanliste, siehe gnublin_adc_scan_list
+* @param values Array mit mindestens list.size() Elementen, der Wert des i-ten Eintrags wird in values[i] gespeichert
+* @return Anzahl der gelesenen Werte, -1 im Fehlerfall
+*/
+int gnublin_module_adc::scan(const gnublin_adc_scan_list &list, int *values) {
+	unsigned char results[MODULE_ADC_SCAN_MAX];
+
+	if (list.count < 1) {
+		ErrorMessage = "scan list is empty\n";
+		error_flag = true;
+		return -1;
+	}
+	if (scanCommands(list.commands, list.count, results) < 0)
+		return -1;
+	for (int i = 0; i < list.count; i++)
+		values[i] = results[i];
+	return list.count;
+}
+
+// queue command byte and result read of every command, execute them with one I2C_RDWR call
+int gnublin_module_adc::scanCommands(const unsigned char *commands, int count, unsigned char *results) {
+	struct i2c_msg msgs[2 * MODULE_ADC_SCAN_MAX];
+	unsigned char bytes[MODULE_ADC_SCAN_MAX];
+	int power = reference_flag ? 0x0F : 0x07;
+	int address = i2c.getAddress();
+
+	for (int i = 0; i < count; i++) {
+		bytes[i] = commands[i] | power;
+		msgs[2 * i].addr = address;
+		msgs[2 * i].flags = 0;
+		msgs[2 * i].len = 1;
+		msgs[2 * i].buf = &bytes[i];
+		msgs[2 * i + 1].addr = address;
+		msgs[2 * i + 1].flags = I2C_M_RD;
+		msgs[2 * i + 1].len = 1;
+		msgs[2 * i + 1].buf = &results[i];
+	}
+	if (i2c.transfer(msgs, 2 * count) < 0) {
+		ErrorMessage = i2c.getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return count;
+}
+
+
+//---------------------- getVoltage() -----------------------
+// get ADC Value of channel in reference to GND
+// parameters:		[int] channel		ADC-Port
+// return:		[int] voltage		voltage of ADC-channel in mV
+/**
+* @~english
+* @brief Get the voltage of an ADC channel in reference to GND in mV
+*
+* The value is converted with the calibration of the channel and rounded to the nearest mV.
+* @param channel Number of the ADC-channel (1-8)
+* @return value in mV
+*
+* @~german
+* @brief Liefert den Wert eine ADC Ports bezogen zu GND in mV
+*
+* Der Wert wird mit der Kalibrierung des Kanals umgerechnet und auf ganze mV gerundet.
+* @param channel Nummer des ADC-Ports (1-8)
+* @return Wert in mV
+*/
+int gnublin_module_adc::getVoltage(int channel) {
+	error_flag = false;
+	int value = getValue(channel);
+	if (error_flag) {
+		return -1;
+	}
+	
+	return calibration.toMillivolt(channel, value);
+}
+
+/**
+* @~english
+* @brief Get the voltage of an ADC channel in reference to a second ADC channel in mV (differential)
+*
+* This combinations are possible<br>
+* 1 - 2<br>
+* 3 - 4<br>
+* 5 - 6<br>
+* 7 - 8<br>
+* 2 - 1<br>
+* 4 - 3<br>
+* 6 - 5<br>
+* 8 - 7<br>
+* @param channel1 Number of the first ADC-channel 
+* @param channel2 Number of the second ADC-channel
+* @return voltage in mV
+*
+* @~german
+* @brief Liefert den Wert eines ADC Ports bezogen auf einen zweiten ADC Port in mV (differentielle Messung)
+*
+* Dies Kombinationen sind möglich:<br>
+* 1 - 2<br>
+* 3 - 4<br>
+* 5 - 6<br>
+* 7 - 8<br>
+* 2 - 1<br>
+* 4 - 3<br>
+* 6 - 5<br>
+* 8 - 7<br>
+* @param channel1 Nummer des ersten ADC-Ports
+* @param channel2 Nummer des zweiten ADC-Ports
+* @return Wert in mV
+*/
+int gnublin_module_adc::getVoltage(int channel1, int channel2) {
+	error_flag = false;
+	int value = getValue(channel1, channel2);
+	if (error_flag) {
+		return -1;
+	}
+	
+	return calibration.toMillivolt(channel1, value);
+}
+
+/**
+* @~english
+* @brief Get the voltage of a channel described at compile time in mV
+*
+* Differential channels use the calibration of their first channel.
+* @param channel channel descriptor, e.g. gnublin_adc_single_ended<3>()
+* @return voltage in mV
+*
+* @~german
+* @brief Liefert die Spannung eines zur Übersetzungszeit beschriebenen Kanals in mV
+*
+* Differentielle Kanäle verwenden die Kalibrierung ihres ersten Kanals.
+* @param channel Kanalbeschreibung, z.B. gnublin_adc_single_ended<3>()
+* @return Wert in mV
+*/
+int gnublin_module_adc::getVoltage(const gnublin_adc_channel &channel) {
+	error_flag = false;
+	int value = getValue(channel);
+	if (error_flag) {
+		return -1;
+	}
+	
+	return calibration.toMillivolt(channel.channel, value);
+}
+
+
+//---------------------- calibration -----------------------
+
+/**
+* @~english
+* @brief Set the calibration of a channel
+*
+* @param channel Number of the ADC-channel (1-8)
+* @param offset offset in LSB, added to the raw value
+* @param gain_ppm gain in parts per million, 1000000 = 1.0
+* @param reference reference voltage in mV
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Setzt die Kalibrierung eines Kanals
+*
+* @param channel Nummer des ADC-Ports (1-8)
+* @param offset Offset in LSB, wird zum Rohwert addiert
+* @param gain_ppm Verstärkung in millionstel, 1000000 = 1,0
+* @param reference Referenzspannung in mV
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_adc::setCalibration(int channel, int offset, int gain_ppm, int reference) {
+	if (calibration.setChannel(channel, offset, gain_ppm, reference) < 0) {
+		ErrorMessage = calibration.getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
+
+/**
+* @~english
+* @brief Load the calibration of the channels from a file
+*
+* Every line contains "channel offset gain reference", e.g. "1 -2 1.0031 2500".
+* @param filename path of the calibration file
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Lädt die Kalibrierung der Kanäle aus einer Datei
+*
+* Jede Zeile enthält "Kanal Offset Verstärkung Referenz", z.B. "1 -2 1.0031 2500".
+* @param filename Pfad zur Kalibrierungsdatei
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_adc::loadCalibration(std::string filename) {
+	if (calibration.load(filename) < 0) {
+		ErrorMessage = calibration.getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
+
+/**
+* @~english
+* @brief Get the calibration, e.g. to convert whole blocks of samples to mV
+*
+* @return pointer to the calibration of this module
+*
+* @~german
+* @brief Gibt die Kalibrierung zurück, z.B. um ganze Blöcke von Werten in mV umzurechnen
+*
+* @return Zeiger auf die Kalibrierung dieses Moduls
+*/
+gnublin_adc_calibration *gnublin_module_adc::getCalibration() {
+	return &calibration;
+}
+
+
+//*****************************************************************************
+// Precomputed channel list for gnublin_module_adc::scan()
+//*****************************************************************************
+
+/**
+* @~english
+* @brief Create an empty scan list
+*
+* @~german
+* @brief Erzeugt eine leere Scanliste
+*/
+gnublin_adc_scan_list::gnublin_adc_scan_list() {
+	count = 0;
+}
+
+/**
+* @~english
+* @brief Append a channel to the list
+*
+* e.g. list.add(gnublin_adc_single_ended<1>()).add(gnublin_adc_differential<3, 4>());
+* @param channel channel descriptor
+* @return the list itself, entries beyond 16 are ignored
+*
+* @~german
+* @brief Hängt einen Kanal an die Liste an
+*
+* z.B. list.add(gnublin_adc_single_ended<1>()).add(gnublin_adc_differential<3, 4>());
+* @param channel Kanalbeschreibung
+* @return die Liste selbst, Einträge über 16 hinaus werden ignoriert
+*/
+gnublin_adc_scan_list &gnublin_adc_scan_list::add(const gnublin_adc_channel &channel) {
+	if (count < MODULE_ADC_SCAN_MAX) {
+		commands[count] = channel.command;
+		channels[count] = channel.channel;
+		count++;
+	}
+	return *this;
+}
+
+/**
+* @~english
+* @brief Remove all channels
+*
+* @~german
+* @brief Entfernt alle Kanäle
+*/
+void gnublin_adc_scan_list::clear() {
+	count = 0;
+}
+
+/**
+* @~english
+* @brief Get the number of channels in the list
+*
+* @return number of channels
+*
+* @~german
+* @brief Gibt die Anzahl der Kanäle in der Liste zurück
+*
+* @return Anzahl der Kanäle
+*/
+int gnublin_adc_scan_list::size() const {
+	return count;
+}
+
+/**
+* @~english
+* @brief Get the calibration channel of an entry, e.g. for gnublin_adc_calibration::toMillivolt()
+*
+* @param index index of the entry
+* @return channel (1-8), -1 for an invalid index
+*
+* @~german
+* @brief Gibt den Kalibrierungskanal eines Eintrags zurück, z.B. für gnublin_adc_calibration::toMillivolt()
+*
+* @param index Index des Eintrags
+* @return Kanal (1-8), -1 bei ungültigem Index
+*/
+int gnublin_adc_scan_list::getChannel(int index) const {
+	if (index < 0 || index >= count)
+		return -1;
+	return channels[index];
+}
+
+//*******************************************************************
+//Class for accessing GNUBLIN Module-Portexpander or any PCA9555
+//*******************************************************************
+
+//------------------Konstruktor------------------
+/** @~english 
+* @brief Set standard i2c address 0x20, set ErrorFlag false
+*
+* @~german 
+* @brief Setze standard i2c Adresse 0x20 und setze das ErrorFlag auf false.
+*
+*/
+gnublin_module_pca9555::gnublin_module_pca9555() 
+{
+	error_flag=false;
+	verify_flag=false;
+	int_edge=NULL;
+	int_events=NULL;
+	change_queue=NULL;
+	snapshot=0;
+	setAddress(0x20);
+}
+
+
+//------------------Destruktor------------------
+/** @~english 
+* @brief Stops watching the INT pin
+*
+* @~german 
+* @brief Beendet die Überwachung des INT Pins
+*
+*/
+gnublin_module_pca9555::~gnublin_module_pca9555()
+{
+	detachInterrupt();
+}
+
+
+//-------------get Error Message-------------
+/** @~english 
+* @brief Get the last Error Message.
+*
+* This function returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german 
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_module_pca9555::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------------------------Fail-------------------------------
+/** @~english 
+* @brief returns the error flag to check if the last operation went wrong
+*
+* @return error_flag as boolean
+*
+* @~german 
+* @brief Gibt das error_flag zurück um zu überprüfen ob die vorangegangene Operation einen Fehler auweist
+*
+* @return error_flag als bool
+*/
+bool gnublin_module_pca9555::fail(){
+	return error_flag;
+}
+
+//-------------set Address-------------
+/** @~english 
+* @brief Set the i2c slave address 
+*
+* With this function you can set the individual I2C Slave-Address of the PCA9555.
+* @param Address new I2C slave Address
+*
+* @~german 
+* @brief Setzt die i2c slave Adresse
+*
+* Mit dieser Funktion kann die individuelle I2C Slave-Adresse des PCA9555 gesetzt werden.
+* @param Address neue I2C slave Adresse
+*/
+void gnublin_module_pca9555::setAddress(int Address){
+	i2c.setAddress(Address);
+	shadow_valid=false;
+}
+
+
+//-------------------set devicefile----------------
+/** @~english
+* @brief set i2c the device file. default is "/dev/i2c-1"
+*
+* This function sets the devicefile you want to access. by default "/dev/i2c-1" is set.
+* @param filename path to the devicefile e.g. "/dev/i2c-0"
+*
+* @~german
+* @brief setzt die I2C Device Datei. Standard ist die "/dev/i2c-1"
+*
+* Diese Funktion setzt die Geräte Datei, auf die man zugreifen möchte. Standardmäßig ist bereits "/dev/i2c-1" gesetzt.
+* @param filename Dateipfad zur Geräte Datei, z.B. "/dev/i2c-0"
+*/
+void gnublin_module_pca9555::setDevicefile(std::string filename){
+	i2c.setDevicefile(filename);
+	shadow_valid=false;
+}
+
+//-----------------------------------Pin Mode-----------------------------------
+/** @~english
+* @brief Controls the pin mode (INPUT/OUTPUT)
+*
+* With this Function you can set a single pin of the PCA9555 wether as input or output.
+* @param pin Number of the pin (0-15)
+* @param direction PCA9555_INPUT or PCA9555_OUTPUT
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt den Pin Modus (Eingang/Ausgang)
+*
+* Mit dieser Funktion kann man einen einzelnen Pin entweder als Eingang oder als Ausgang setzen.
+* @param pin Nummer des Pins (0-15)
+* @param direction PCA9555_INPUT (Eingang) oder PCA9555_OUTPUT (Ausgang)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::pinMode(int pin, pca9555_direction direction){
+	error_flag=false;
+
+	if ((unsigned int)pin > 15){
+		error_flag=true;
+		ErrorMessage="Pin Number is not between 0-15";
+		return -1;
+	}
+	if (loadShadow() < 0)
+		return -1;
+
+	// configuration register 0x06 (pin 0-7) or 0x07 (pin 8-15), a set bit is an input
+	unsigned char reg=0x06 + (pin >> 3);
+	unsigned char mask=1 << (pin & 7);
+	return writeRegister(reg, (shadow[reg] & ~mask) | (mask & -(int)direction));
+}
+
+/** @~english
+* @brief Controls the pin mode (INPUT/OUTPUT)
+*
+* Wrapper for pinMode(int, pca9555_direction).
+* @param pin Number of the pin (0-15)
+* @param direction INPUT or OUTPUT
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt den Pin Modus (Eingang/Ausgang)
+*
+* Wrapper für pinMode(int, pca9555_direction).
+* @param pin Nummer des Pins (0-15)
+* @param direction INPUT (Eingang) oder OUTPUT (Ausgang)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::pinMode(int pin, std::string direction){
+	if (direction=="out")
+		return pinMode(pin, PCA9555_OUTPUT);
+	if (direction=="in")
+		return pinMode(pin, PCA9555_INPUT);
+	error_flag=true;
+	ErrorMessage="direction != IN/OUTPUT";
+	return -1;
+}
+
+
+//-----------------------------------Port Mode-----------------------------------
+/** @~english
+* @brief Controls the port mode (INPUT/OUTPUT)
+*
+* With this Function you can set a whole port of the PCA9555 wether as input or output.
+* @param port Number of the port (0-1)
+* @param direction PCA9555_INPUT or PCA9555_OUTPUT
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt den Port Modus (Eingang/Ausgang)
+*
+* Mit dieser Funktion kann man einen ganzen Port entweder als Eingang oder als Ausgang setzen.
+* @param port Nummer des Ports (0-1)
+* @param direction PCA9555_INPUT (Eingang) oder PCA9555_OUTPUT (Ausgang)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::portMode(int port, pca9555_direction direction){
+	error_flag=false;
+
+	if ((unsigned int)port > 1){
+		error_flag=true;
+		ErrorMessage="Port Number is not between 0-1";
+		return -1;
+	}
+	if (loadShadow() < 0)
+		return -1;
+
+	return writeRegister(0x06 + port, -(int)direction);
+}
+
+/** @~english
+* @brief Controls the port mode (INPUT/OUTPUT)
+*
+* Wrapper for portMode(int, pca9555_direction).
+* @param port Number of the port (0-1)
+* @param direction INPUT or OUTPUT
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt den Port Modus (Eingang/Ausgang)
+*
+* Wrapper für portMode(int, pca9555_direction).
+* @param port Nummer des Ports (0-1)
+* @param direction INPUT (Eingang) oder OUTPUT (Ausgang)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::portMode(int port, std::string direction){
+	if (direction=="out")
+		return portMode(port, PCA9555_OUTPUT);
+	if (direction=="in")
+		return portMode(port, PCA9555_INPUT);
+	error_flag=true;
+	ErrorMessage="direction != IN/OUTPUT";
+	return -1;
+}
+
+//-----------------------------------Port Mode Masked-----------------------------------
+/** @~english
+* @brief Controls the mode of some pins of a port with one I2C message
+*
+* The pins selected by mask get the direction, the other pins keep theirs.
+* @param port Number of the port (0-1)
+* @param mask bit n = 1: pin n of the port is changed
+* @param direction PCA9555_INPUT or PCA9555_OUTPUT
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt den Modus einiger Pins eines Ports mit einer I2C Nachricht
+*
+* Die mit mask ausgewählten Pins erhalten die Richtung, die anderen Pins behalten ihre.
+* @param port Nummer des Ports (0-1)
+* @param mask Bit n = 1: Pin n des Ports wird geändert
+* @param direction PCA9555_INPUT (Eingang) oder PCA9555_OUTPUT (Ausgang)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::portModeMasked(int port, unsigned char mask, pca9555_direction direction){
+	error_flag=false;
+
+	if ((unsigned int)port > 1){
+		error_flag=true;
+		ErrorMessage="Port Number is not between 0-1";
+		return -1;
+	}
+	if (loadShadow() < 0)
+		return -1;
+
+	return writeRegister(0x06 + port, (shadow[0x06 + port] & ~mask) | (mask & -(int)direction));
+}
+
+
+//-----------------------------------digital Write-----------------------------------
+/** @~english
+* @brief sets the level of an output pin (HIGH/LOW)
+*
+* With this Function you can set the logical level of an output pin to wether HIGH or LOW.
+* @param pin Number of the pin (0-15)
+* @param value HIGH (1) or LOW (0)
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt den Pegel eines Ausgangs (HIGH/LOW)
+*
+* Mit dieser Funktion kann man den Pegel eines Ausgangs entweder auf HIGH oder auf LOW setzen.
+* @param pin Nummer des Pins (0-15)
+* @param value HIGH (1) oder LOW (0) 
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::digitalWrite(int pin, int value){
+	error_flag=false;
+
+	if ((unsigned int)pin > 15){
+		error_flag=true;
+		ErrorMessage="Pin Number is not between 0-15";
+		return -1;
+	}
+	if ((unsigned int)value > 1){
+		error_flag=true;
+		ErrorMessage="value != HIGH/LOW";
+		return -1;
+	}
+	if (loadShadow() < 0)
+		return -1;
+
+	// output register 0x02 (pin 0-7) or 0x03 (pin 8-15)
+	unsigned char reg=0x02 + (pin >> 3);
+	unsigned char mask=1 << (pin & 7);
+	return writeRegister(reg, (shadow[reg] & ~mask) | (mask & -value));
+}
+
+//-----------------------------------write Port-----------------------------------
+/** @~english
+* @brief  Writes one byte to a complete port
+*
+* With this Function you can write a whole byte to a whole port of the PCA9555.
+* @param port Number of the port (0-1)
+* @param value The Byte you want to write.  e.g. 0x12 to write 00010010 
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Schreibt ein Byte an einen kompletten Port
+*
+* Mit dieser Funktion kann man ein komplettes Byte an einen ganzen Port des PCA9555 schreiben.
+* @param port Nummer des Ports (0-1)
+* @param value Das Byte, dass man schreiben möchte. z.B. 0x12 um 00010010 zu schreiben. 
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::writePort(int port, unsigned char value){
+	error_flag=false;
+
+	if (port < 0 || port > 1){
+		error_flag=true;
+		ErrorMessage="Pin Number is not between 0-1";
+		return -1;
+	}
+	if (loadShadow() < 0)
+		return -1;
+
+	return writeRegister(0x02+port, value);
+}
+
+//-----------------------------------write Port Masked-----------------------------------
+/** @~english
+* @brief  Changes some pins of a port with one I2C message
+*
+* The pins selected by mask get the levels of the corresponding bits of value, the other pins keep their levels.
+* @param port Number of the port (0-1)
+* @param mask bit n = 1: pin n of the port is changed
+* @param value new levels
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Ändert einige Pins eines Ports mit einer I2C Nachricht
+*
+* Die mit mask ausgewählten Pins erhalten die Pegel der entsprechenden Bits von value, die anderen Pins behalten ihre Pegel.
+* @param port Nummer des Ports (0-1)
+* @param mask Bit n = 1: Pin n des Ports wird geändert
+* @param value neue Pegel
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::writePortMasked(int port, unsigned char mask, unsigned char value){
+	error_flag=false;
+
+	if ((unsigned int)port > 1){
+		error_flag=true;
+		ErrorMessage="Port Number is not between 0-1";
+		return -1;
+	}
+	if (loadShadow() < 0)
+		return -1;
+
+	return writeRegister(0x02 + port, (shadow[0x02 + port] & ~mask) | (value & mask));
+}
+
+//-----------------------------------write Ports-----------------------------------
+/** @~english
+* @brief  Writes both ports with one I2C message
+*
+* Port 0 and port 1 are written with one message (register pair auto-increment), so all 16 outputs change at the same time.
+* @param value bit 0-7: port 0, bit 8-15: port 1 (pin n = bit n)
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Schreibt beide Ports mit einer I2C Nachricht
+*
+* Port 0 und Port 1 werden mit einer Nachricht geschrieben (automatisches Weiterschalten im Registerpaar), alle 16 Ausgänge ändern sich also gleichzeitig.
+* @param value Bit 0-7: Port 0, Bit 8-15: Port 1 (Pin n = Bit n)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::writePorts(uint16_t value){
+	error_flag=false;
+
+	if (loadShadow() < 0)
+		return -1;
+
+	return writeRegisters(0x02, value);
+}
+
+//-----------------------------------read Ports-----------------------------------
+/** @~english
+* @brief  Reads the inputs of both ports with one I2C transaction
+*
+* @return bit 0-7: port 0, bit 8-15: port 1 (pin n = bit n), failure: -1
+*
+* @~german
+* @brief Liest die Eingänge beider Ports mit einer I2C Transaktion
+*
+* @return Bit 0-7: Port 0, Bit 8-15: Port 1 (Pin n = Bit n), Misserfolg: -1
+*/
+int gnublin_module_pca9555::readPorts(){
+	error_flag=false;
+	unsigned char RxBuf[2];
+
+	if (i2c.receive(0x00, RxBuf, 2) < 0) {
+		error_flag=true;
+		ErrorMessage="i2c.receive Error";
+		return -1;
+	}
+	return RxBuf[0] | (RxBuf[1] << 8);
+}
+
+//-----------------------------------set Direction 16-----------------------------------
+/** @~english
+* @brief  Sets the direction of all 16 pins with one I2C message
+*
+* @param inputs bit n = 1: pin n is an input, bit n = 0: pin n is an output
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Richtung aller 16 Pins mit einer I2C Nachricht
+*
+* @param inputs Bit n = 1: Pin n ist ein Eingang, Bit n = 0: Pin n ist ein Ausgang
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::setDirection16(uint16_t inputs){
+	error_flag=false;
+
+	if (loadShadow() < 0)
+		return -1;
+
+	return writeRegisters(0x06, inputs);
+}
+
+//-----------------------------------digital read-----------------------------------
+/** @~english
+* @brief reads the state of an input pin and returns it
+*
+* With this function you can read the level of an input pin.
+* @param pin Number of the pin (0-15) you want to read from
+* @return 0/1 logical level of the pin, failure: -1
+*
+* @~german
+* @brief Liest den Zustand eins Eingang-Pins und gibt ihn zurück
+*
+* Mit dieser Funktion kann man den Zustand eines Pins auslesen.
+* @param pin Nummer des Pins (0-15) von dem man lesen will.
+* @return 0/1 logischer Pegel des Pins, Misserfolg: -1
+*/
+int gnublin_module_pca9555::digitalRead(int pin) {
+	error_flag=false;
+	unsigned char RxBuf[1];
+
+	if ((unsigned int)pin > 15){
+		error_flag=true;
+		ErrorMessage="Pin Number is not between 0-15\n";
+		return -1;
+	}
+
+	// input register 0x00 (pin 0-7) or 0x01 (pin 8-15)
+	if(i2c.receive(pin >> 3, RxBuf, 1) < 0){
+		error_flag=true;
+		ErrorMessage="i2c.receive Error";
+		return -1;
+	}
+	return (RxBuf[0] >> (pin & 7)) & 1;
+}
+
+
+//-----------------------------------set Polarity-----------------------------------
+/** @~english
+* @brief inverts the polarity of an input pin
+*
+* If the polarity of a pin is inverted, digitalRead() returns 1 for a low level and 0 for a high level.
+* @param pin Number of the pin (0-15)
+* @param inverted 1: inverted, 0: normal
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief invertiert die Polarität eines Eingangs
+*
+* Ist die Polarität eines Pins invertiert, liefert digitalRead() bei low Pegel 1 und bei high Pegel 0.
+* @param pin Nummer des Pins (0-15)
+* @param inverted 1: invertiert, 0: normal
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::setPolarity(int pin, int inverted){
+	error_flag=false;
+
+	if ((unsigned int)pin > 15){
+		error_flag=true;
+		ErrorMessage="Pin Number is not between 0-15";
+		return -1;
+	}
+	if (loadShadow() < 0)
+		return -1;
+
+	// polarity register 0x04 (pin 0-7) or 0x05 (pin 8-15)
+	unsigned char reg=0x04 + (pin >> 3);
+	unsigned char mask=1 << (pin & 7);
+	return writeRegister(reg, (shadow[reg] & ~mask) | (mask & -(inverted != 0)));
+}
+
+
+//-----------------------------------resync-----------------------------------
+/** @~english
+* @brief reads the output, polarity and configuration registers into the shadow registers
+*
+* pinMode(), digitalWrite(), ... modify a copy of these registers and only write the changed register, so each change is one I2C transfer and a write of an unchanged value none.
+* The copy is read once before the first change. Call resync() if another program or a reset of the chip changed the registers.
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief liest die Ausgangs-, Polaritäts- und Konfigurationsregister in die Schattenregister
+*
+* pinMode(), digitalWrite(), ... ändern eine Kopie dieser Register und schreiben nur das geänderte Register, jede Änderung ist also ein I2C Transfer und das Schreiben eines unveränderten Werts keiner.
+* Die Kopie wird einmal vor der ersten Änderung gelesen. resync() muss aufgerufen werden, wenn ein anderes Programm oder ein Reset des Chips die Register verändert hat.
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::resync(){
+	// the PCA9555 only toggles between the two registers of a pair, so every pair is a separate message
+	unsigned char regs[3]={0x02, 0x04, 0x06};
+	struct i2c_msg msgs[6];
+
+	error_flag=false;
+	for (int i = 0; i < 3; i++) {
+		msgs[2*i].addr=i2c.getAddress();
+		msgs[2*i].flags=0;
+		msgs[2*i].len=1;
+		msgs[2*i].buf=&regs[i];
+		msgs[2*i+1].addr=i2c.getAddress();
+		msgs[2*i+1].flags=I2C_M_RD;
+		msgs[2*i+1].len=2;
+		msgs[2*i+1].buf=&shadow[regs[i]];
+	}
+	if (i2c.transfer(msgs, 6) < 0) {
+		error_flag=true;
+		ErrorMessage="i2c.receive Error";
+		shadow_valid=false;
+		return -1;
+	}
+	shadow_valid=true;
+	return 1;
+}
+
+
+//-----------------------------------set Verify-----------------------------------
+/** @~english
+* @brief switches the verify-on-write debug mode
+*
+* If enabled, every written register is read back and compared with the shadow register.
+* A difference is reported as failure, e.g. if the chip was reset in between.
+* @param verify true: verify every write, false: don't verify (default)
+*
+* @~german
+* @brief schaltet den Debug Modus zur Prüfung jedes Schreibvorgangs
+*
+* Ist er eingeschaltet, wird jedes geschriebene Register zurückgelesen und mit dem Schattenregister verglichen.
+* Eine Abweichung wird als Fehler gemeldet, z.B. wenn der Chip zwischendurch zurückgesetzt wurde.
+* @param verify true: jeden Schreibvorgang prüfen, false: nicht prüfen (Standard)
+*/
+void gnublin_module_pca9555::setVerify(bool verify){
+	verify_flag=verify;
+}
+
+
+// reads the shadow registers before the first change
+int gnublin_module_pca9555::loadShadow(){
+	if (shadow_valid)
+		return 1;
+	return resync();
+}
+
+// writes one register and updates its shadow register, a register which already has the value isn't written
+int gnublin_module_pca9555::writeRegister(unsigned char reg, unsigned char value){
+	unsigned char buffer[1];
+
+	if (value == shadow[reg] && !verify_flag)
+		return 1;
+	buffer[0]=value;
+	if (i2c.send(reg, buffer, 1) < 0) {
+		error_flag=true;
+		ErrorMessage="i2c.send Error";
+		return -1;
+	}
+	shadow[reg]=value;
+	if (verify_flag) {
+		if (i2c.receive(reg, buffer, 1) < 0) {
+			error_flag=true;
+			ErrorMessage="i2c.receive Error";
+			return -1;
+		}
+		if (buffer[0] != value) {
+			error_flag=true;
+			ErrorMessage="verify failed: register " + numberToString(reg) + " is " + numberToString(buffer[0]) + " instead of " + numberToString(value) + "\n";
+			return -1;
+		}
+	}
+	return 1;
+}
+
+// writes both registers of a pair in one message and updates their shadow registers
+int gnublin_module_pca9555::writeRegisters(unsigned char reg, uint16_t value){
+	unsigned char buffer[2];
+
+	if (value == (shadow[reg] | shadow[reg+1] << 8) && !verify_flag)
+		return 1;
+	buffer[0]=value & 0xff;
+	buffer[1]=value >> 8;
+	if (i2c.send(reg, buffer, 2) < 0) {
+		error_flag=true;
+		ErrorMessage="i2c.send Error";
+		return -1;
+	}
+	shadow[reg]=buffer[0];
+	shadow[reg+1]=buffer[1];
+	if (verify_flag) {
+		if (i2c.receive(reg, buffer, 2) < 0) {
+			error_flag=true;
+			ErrorMessage="i2c.receive Error";
+			return -1;
+		}
+		if (buffer[0] != shadow[reg] || buffer[1] != shadow[reg+1]) {
+			error_flag=true;
+			ErrorMessage="verify failed: register pair " + numberToString(reg) + " is " + numberToString(buffer[0] | buffer[1] << 8) + " instead of " + numberToString(value) + "\n";
+			return -1;
+		}
+	}
+	return 1;
+}
+
+
+//-----------------------------------get Transactions-----------------------------------
+/** @~english
+* @brief returns the number of I2C transactions done by this object
+*
+* @return number of transactions
+*
+* @~german
+* @brief gibt die Anzahl der I2C Transaktionen dieses Objekts zurück
+*
+* @return Anzahl der Transaktionen
+*/
+unsigned int gnublin_module_pca9555::getTransactions(){
+	return i2c.getTransactions();
+}
+
+
+//-----------------------------------attach Interrupt-----------------------------------
+/** @~english
+* @brief delivers input changes as events, using the INT output of the PCA9555
+*
+* INT (open drain, needs a pull-up) has to be connected to a GPIO. On every falling edge both input ports are read with one transaction,
+* which also releases INT, and compared with the previous state. Every changed pin is delivered as EVENT_PIN_CHANGE
+* (device: I2C address, source: pin 0-15, value: new level). As long as no input changes, there is no bus traffic.
+* @param pin GPIO the INT output is connected to
+* @param queue queue which receives the events
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief liefert Änderungen der Eingänge als Ereignisse, mit Hilfe des INT Ausgangs des PCA9555
+*
+* INT (Open Drain, benötigt einen Pull-Up) muss mit einem GPIO verbunden sein. Bei jeder fallenden Flanke werden beide Eingangsports mit einer Transaktion gelesen,
+* was INT auch zurücksetzt, und mit dem vorherigen Zustand verglichen. Jeder geänderte Pin wird als EVENT_PIN_CHANGE geliefert
+* (device: I2C Adresse, source: Pin 0-15, value: neuer Pegel). Solange sich kein Eingang ändert, gibt es keinen Bus-Verkehr.
+* @param pin GPIO, an den der INT Ausgang angeschlossen ist
+* @param queue Warteschlange, die die Ereignisse erhält
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::attachInterrupt(int pin, gnublin_event_queue *queue){
+	detachInterrupt();
+	// the first read is the reference and releases a pending INT
+	snapshot=readPorts();
+	if (snapshot < 0)
+		return -1;
+	change_queue=queue;
+	int_i2c=i2c;
+	int_events=new gnublin_event_queue();
+	int_events->setCallback(intCallback, this);
+	int_edge=new gnublin_gpio_edge();
+	if (int_edge->watch(pin, "falling", int_events) < 0) {
+		ErrorMessage=int_edge->getErrorMessage();
+		detachInterrupt();
+		error_flag=true;
+		return -1;
+	}
+	error_flag=false;
+	return 1;
+}
+
+
+//-----------------------------------detach Interrupt-----------------------------------
+/** @~english
+* @brief stops delivering input changes as events
+*
+* @~german
+* @brief beendet die Lieferung von Änderungen der Eingänge als Ereignisse
+*/
+void gnublin_module_pca9555::detachInterrupt(){
+	// deleting the edge object joins its thread, so no callback runs afterwards
+	delete int_edge;
+	delete int_events;
+	int_edge=NULL;
+	int_events=NULL;
+	change_queue=NULL;
+}
+
+// called from the edge thread for every falling edge of INT
+void gnublin_module_pca9555::intCallback(const gnublin_event *event, void *arg){
+	gnublin_module_pca9555 *pca=(gnublin_module_pca9555 *)arg;
+	unsigned char RxBuf[2];
+	gnublin_event change;
+	int state, diff;
+
+	if (pca->int_i2c.receive(0x00, RxBuf, 2) < 0)
+		return;
+	state=RxBuf[0] | (RxBuf[1] << 8);
+	diff=state ^ pca->snapshot;
+	pca->snapshot=state;
+
+	change.type=EVENT_PIN_CHANGE;
+	change.device=pca->int_i2c.getAddress();
+	change.timestamp=event->timestamp;
+	while (diff) {
+		int pin=__builtin_ctz(diff);
+		diff&=diff-1;
+		change.source=pin;
+		change.value=(state >> pin) & 1;
+		pca->change_queue->push(change);
+	}
+}
+
+
+//*******************************************************************
+//Class for using several PCA9555 as one wide GPIO bank
+//*******************************************************************
+
+//------------------Konstruktor------------------
+/** @~english 
+* @brief Creates an empty bank
+*
+* @~german 
+* @brief Erzeugt eine leere Bank
+*
+*/
+gnublin_pca9555_bank::gnublin_pca9555_bank(){
+	error_flag=false;
+	bus_count=0;
+	chip_count=0;
+	shadow_valid=false;
+	transactions=0;
+}
+
+
+//-------------get Error Message-------------
+/** @~english 
+* @brief Get the last Error Message.
+*
+* This function returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german 
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_pca9555_bank::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------------------------Fail-------------------------------
+/** @~english 
+* @brief returns the error flag to check if the last operation went wrong
+*
+* @return error_flag as boolean
+*
+* @~german 
+* @brief Gibt das error_flag zurück um zu überprüfen ob die vorangegangene Operation einen Fehler auweist
+*
+* @return error_flag als bool
+*/
+bool gnublin_pca9555_bank::fail(){
+	return error_flag;
+}
+
+
+//-----------------------------------add Expander-----------------------------------
+/** @~english
+* @brief adds a PCA9555 on the default bus "/dev/i2c-1"
+*
+* @param address I2C slave address (0x20-0x27)
+* @return index of the expander, its pins are index * 16 to index * 16 + 15. failure: -1
+*
+* @~german
+* @brief fügt einen PCA9555 am Standard Bus "/dev/i2c-1" hinzu
+*
+* @param address I2C Slave Adresse (0x20-0x27)
+* @return Index des Portexpanders, seine Pins sind Index * 16 bis Index * 16 + 15. Misserfolg: -1
+*/
+int gnublin_pca9555_bank::addExpander(int address){
+	return addExpander("/dev/i2c-1", address);
+}
+
+/** @~english
+* @brief adds a PCA9555 on the given bus
+*
+* @param devicefile path to the devicefile of the bus, e.g. "/dev/i2c-0"
+* @param address I2C slave address (0x20-0x27)
+* @return index of the expander, its pins are index * 16 to index * 16 + 15. failure: -1
+*
+* @~german
+* @brief fügt einen PCA9555 am angegebenen Bus hinzu
+*
+* @param devicefile Pfad zur Geräte Datei des Busses, z.B. "/dev/i2c-0"
+* @param address I2C Slave Adresse (0x20-0x27)
+* @return Index des Portexpanders, seine Pins sind Index * 16 bis Index * 16 + 15. Misserfolg: -1
+*/
+int gnublin_pca9555_bank::addExpander(std::string devicefile, int address){
+	int b;
+
+	error_flag=false;
+	if (address < 0x20 || address > 0x27){
+		error_flag=true;
+		ErrorMessage="address is not between 0x20-0x27\n";
+		return -1;
+	}
+	if (chip_count >= PCA9555_BANK_MAX_CHIPS){
+		error_flag=true;
+		ErrorMessage="too many expanders\n";
+		return -1;
+	}
+	for (b = 0; b < bus_count; b++)
+		if (bus_devicefile[b] == devicefile)
+			break;
+	if (b == bus_count){
+		if (bus_count >= PCA9555_BANK_MAX_BUSES){
+			error_flag=true;
+			ErrorMessage="too many buses\n";
+			return -1;
+		}
+		buses[b].setDevicefile(devicefile);
+		bus_devicefile[b]=devicefile;
+		bus_count++;
+	}
+	for (int i = 0; i < chip_count; i++){
+		if (chip_bus[i] == b && chip_address[i] == address){
+			error_flag=true;
+			ErrorMessage="expander " + numberToString(address) + " already added\n";
+			return -1;
+		}
+	}
+	chip_bus[chip_count]=b;
+	chip_address[chip_count]=address;
+	shadow_valid=false;
+	return chip_count++;
+}
+
+
+//-----------------------------------size-----------------------------------
+/** @~english
+* @brief returns the number of pins
+*
+* @return 16 * number of expanders
+*
+* @~german
+* @brief gibt die Anzahl der Pins zurück
+*
+* @return 16 * Anzahl der Portexpander
+*/
+int gnublin_pca9555_bank::size(){
+	return chip_count * 16;
+}
+
+
+//-----------------------------------Pin Mode-----------------------------------
+/** @~english
+* @brief requests the mode of a pin, it is written with the next commit()
+*
+* @param pin Number of the pin (0 to size() - 1)
+* @param direction PCA9555_INPUT or PCA9555_OUTPUT
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief fordert den Modus eines Pins an, er wird mit dem nächsten commit() geschrieben
+*
+* @param pin Nummer des Pins (0 bis size() - 1)
+* @param direction PCA9555_INPUT (Eingang) oder PCA9555_OUTPUT (Ausgang)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_pca9555_bank::pinMode(int pin, pca9555_direction direction){
+	error_flag=false;
+	if ((unsigned int)pin >= (unsigned int)size()){
+		error_flag=true;
+		ErrorMessage="Pin Number is not between 0-" + numberToString(size() - 1) + "\n";
+		return -1;
+	}
+	if (loadShadow() < 0)
+		return -1;
+	uint16_t mask=1 << (pin & 15);
+	config[pin >> 4]=(config[pin >> 4] & ~mask) | (mask & -(int)direction);
+	return 1;
+}
+
+
+//-----------------------------------digital Write-----------------------------------
+/** @~english
+* @brief requests the level of an output pin, it is written with the next commit()
+*
+* @param pin Number of the pin (0 to size() - 1)
+* @param value HIGH (1) or LOW (0)
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief fordert den Pegel eines Ausgangs an, er wird mit dem nächsten commit() geschrieben
+*
+* @param pin Nummer des Pins (0 bis size() - 1)
+* @param value HIGH (1) oder LOW (0)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_pca9555_bank::digitalWrite(int pin, int value){
+	error_flag=false;
+	if ((unsigned int)pin >= (unsigned int)size()){
+		error_flag=true;
+		ErrorMessage="Pin Number is not between 0-" + numberToString(size() - 1) + "\n";
+		return -1;
+	}
+	if ((unsigned int)value > 1){
+		error_flag=true;
+		ErrorMessage="value != HIGH/LOW";
+		return -1;
+	}
+	if (loadShadow() < 0)
+		return -1;
+	uint16_t mask=1 << (pin & 15);
+	output[pin >> 4]=(output[pin >> 4] & ~mask) | (mask & -value);
+	return 1;
+}
+
+
+//-----------------------------------commit-----------------------------------
+/** @~english
+* @brief writes the requested state to the expanders
+*
+* Only ports which differ from the shadow registers are written, both ports of an expander with one message.
+* All messages of a bus are sent with one I2C transaction, the outputs before the directions, so a pin which becomes an output starts with its new level.
+* @return number of written ports, failure: -1
+*
+* @~german
+* @brief schreibt den angeforderten Zustand in die Portexpander
+*
+* Nur Ports, die sich von den Schattenregistern unterscheiden, werden geschrieben, beide Ports eines Portexpanders mit einer Nachricht.
+* Alle Nachrichten eines Busses werden mit einer I2C Transaktion gesendet, die Ausgänge vor den Richtungen, so dass ein Pin, der zum Ausgang wird, mit seinem neuen Pegel startet.
+* @return Anzahl der geschriebenen Ports, Misserfolg: -1
+*/
+int gnublin_pca9555_bank::commit(){
+	struct i2c_msg msgs[2 * PCA9555_BANK_MAX_CHIPS];
+	unsigned char buf[2 * PCA9555_BANK_MAX_CHIPS][3];
+	int ports=0;
+
+	error_flag=false;
+	if (loadShadow() < 0)
+		return -1;
+	for (int b = 0; b < bus_count; b++){
+		int count=0;
+
+		// pass 0: output registers, pass 1: configuration registers
+		for (int pass = 0; pass < 2; pass++){
+			for (int i = 0; i < chip_count; i++){
+				if (chip_bus[i] != b)
+					continue;
+				uint16_t value=pass ? config[i] : output[i];
+				uint16_t diff=value ^ (pass ? shadow_config[i] : shadow_output[i]);
+				unsigned char reg=pass ? 0x06 : 0x02;
+				unsigned char *p=buf[count];
+
+				if (!diff)
+					continue;
+				msgs[count].addr=chip_address[i];
+				msgs[count].flags=0;
+				msgs[count].buf=p;
+				if ((diff & 0x00ff) && (diff & 0xff00)){ // both ports, the register pair auto-increments
+					p[0]=reg;
+					p[1]=value & 0xff;
+					p[2]=value >> 8;
+					msgs[count].len=3;
+					ports+=2;
+				}
+				else if (diff & 0x00ff){
+					p[0]=reg;
+					p[1]=value & 0xff;
+					msgs[count].len=2;
+					ports++;
+				}
+				else {
+					p[0]=reg + 1;
+					p[1]=value >> 8;
+					msgs[count].len=2;
+					ports++;
+				}
+				count++;
+			}
+		}
+		if (count && transfer(b, msgs, count) < 0)
+			return -1;
+		for (int i = 0; i < chip_count; i++){
+			if (chip_bus[i] == b){
+				shadow_output[i]=output[i];
+				shadow_config[i]=config[i];
+			}
+		}
+	}
+	return ports;
+}
+
+
+//-----------------------------------update-----------------------------------
+/** @~english
+* @brief reads the inputs of all expanders
+*
+* Both input ports of all expanders of a bus are read with one I2C transaction.
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief liest die Eingänge aller Portexpander
+*
+* Beide Eingangsports aller Portexpander eines Busses werden mit einer I2C Transaktion gelesen.
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_pca9555_bank::update(){
+	struct i2c_msg msgs[2 * PCA9555_BANK_MAX_CHIPS];
+	unsigned char buf[PCA9555_BANK_MAX_CHIPS][2];
+	unsigned char reg=0x00;
+
+	error_flag=false;
+	for (int b = 0; b < bus_count; b++){
+		int count=0;
+
+		for (int i = 0; i < chip_count; i++){
+			if (chip_bus[i] != b)
+				continue;
+			msgs[count].addr=chip_address[i];
+			msgs[count].flags=0;
+			msgs[count].len=1;
+			msgs[count].buf=&reg;
+			msgs[count+1].addr=chip_address[i];
+			msgs[count+1].flags=I2C_M_RD;
+			msgs[count+1].len=2;
+			msgs[count+1].buf=buf[i];
+			count+=2;
+		}
+		if (transfer(b, msgs, count) < 0)
+			return -1;
+	}
+	for (int i = 0; i < chip_count; i++)
+		inputs[i]=buf[i][0] | (buf[i][1] << 8);
+	return 1;
+}
+
+
+//-----------------------------------digital read-----------------------------------
+/** @~english
+* @brief returns the level of a pin of the last update()
+*
+* @param pin Number of the pin (0 to size() - 1)
+* @return 0/1 logical level of the pin, failure: -1
+*
+* @~german
+* @brief gibt den Pegel eines Pins vom letzten update() zurück
+*
+* @param pin Nummer des Pins (0 bis size() - 1)
+* @return 0/1 logischer Pegel des Pins, Misserfolg: -1
+*/
+int gnublin_pca9555_bank::digitalRead(int pin){
+	if ((unsigned int)pin >= (unsigned int)size())
+		return -1;
+	return (inputs[pin >> 4] >> (pin & 15)) & 1;
+}
+
+
+//-----------------------------------get Inputs-----------------------------------
+/** @~english
+* @brief returns the inputs of the last update()
+*
+* @return array with one 16 bit value per expander
+*
+* @~german
+* @brief gibt die Eingänge vom letzten update() zurück
+*
+* @return Array mit einem 16 Bit Wert pro Portexpander
+*/
+const uint16_t *gnublin_pca9555_bank::getInputs(){
+	return inputs;
+}
+
+
+//-----------------------------------resync-----------------------------------
+/** @~english
+* @brief reads the output and configuration registers of all expanders
+*
+* The requested state is reset to the state of the chips. It is read automatically before the first change.
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief liest die Ausgangs- und Konfigurationsregister aller Portexpander
+*
+* Der angeforderte Zustand wird auf den Zustand der Chips zurückgesetzt. Er wird vor der ersten Änderung automatisch gelesen.
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_pca9555_bank::resync(){
+	struct i2c_msg msgs[4 * PCA9555_BANK_MAX_CHIPS];
+	unsigned char buf[PCA9555_BANK_MAX_CHIPS][4];
+	unsigned char regs[2]={0x02, 0x06};
+
+	error_flag=false;
+	shadow_valid=false;
+	for (int b = 0; b < bus_count; b++){
+		int count=0;
+
+		for (int i = 0; i < chip_count; i++){
+			if (chip_bus[i] != b)
+				continue;
+			for (int r = 0; r < 2; r++){
+				msgs[count].addr=chip_address[i];
+				msgs[count].flags=0;
+				msgs[count].len=1;
+				msgs[count].buf=&regs[r];
+				msgs[count+1].addr=chip_address[i];
+				msgs[count+1].flags=I2C_M_RD;
+				msgs[count+1].len=2;
+				msgs[count+1].buf=&buf[i][2*r];
+				count+=2;
+			}
+		}
+		if (transfer(b, msgs, count) < 0)
+			return -1;
+	}
+	for (int i = 0; i < chip_count; i++){
+		shadow_output[i]=output[i]=buf[i][0] | (buf[i][1] << 8);
+		shadow_config[i]=config[i]=buf[i][2] | (buf[i][3] << 8);
+	}
+	shadow_valid=true;
+	return 1;
+}
+
+
+//-----------------------------------get Transactions-----------------------------------
+/** @~english
+* @brief returns the number of I2C transactions done by this bank
+*
+* @return number of transactions
+*
+* @~german
+* @brief gibt die Anzahl der I2C Transaktionen dieser Bank zurück
+*
+* @return Anzahl der Transaktionen
+*/
+unsigned int gnublin_pca9555_bank::getTransactions(){
+	return transactions;
+}
+
+int gnublin_pca9555_bank::loadShadow(){
+	if (shadow_valid)
+		return 1;
+	return resync();
+}
+
+int gnublin_pca9555_bank::transfer(int bus, struct i2c_msg *msgs, int count){
+	transactions++;
+	if (buses[bus].transfer(msgs, count) < 0){
+		error_flag=true;
+		ErrorMessage=buses[bus].getErrorMessage();
+		return -1;
+	}
+	return 1;
+}
+
+
+//****************************************************************************
+// Class for easy use of the GNUBLIN Module-Relay
+//****************************************************************************
+
+
+//------------------Konstruktor------------------
+/** @~english 
+* @brief Set standards.
+*
+* Set standard i2c address 0x20, set ErrorFlag false
+* @~german 
+* @brief Setze Standartwerte.
+*
+* Setze standard i2c Adresse 0x20 und setze das ErrorFlag auf false.
+*/
+gnublin_module_relay::gnublin_module_relay() {
+	error_flag=false;
+	last_transactions=0;
+	state=0;
+	min_on=0;
+	min_off=0;
+	memset(&local_wear, 0, sizeof(local_wear));
+	local_wear.magic=RELAY_WEAR_MAGIC;
+	wear=&local_wear;
+	wear_fd=-1;
+	setAddress(0x20);
+}
+
+
+//------------------Destruktor------------------
+/** @~english 
+* @brief Closes the wear state file.
+*
+* @~german 
+* @brief Schließt die Verschleiß-Zustandsdatei.
+*/
+gnublin_module_relay::~gnublin_module_relay() {
+	closeWearFile();
+}
+
+
+//-------------getErrorMessage-------------
+/** @~english 
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german 
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_module_relay::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------------------------fail-------------------------------
+/** @~english 
+* @brief Returns the error flag. 
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german 
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_module_relay::fail(){
+	return error_flag;
+}
+
+//-------------setAddress-------------
+/** @~english 
+* @brief Set the slave address 
+*
+* With this function you can set the individual I2C Slave-Address of the module.
+* @param Address new I2C slave Address
+*
+* @~german 
+* @brief Setzt Slave Adresse.
+*
+* Mit dieser Funktion kann die individuelle I2C Slave-Adresse des Moduls gesetzt werden.
+* @param Address neue I2C slave Adresse
+*/
+void gnublin_module_relay::setAddress(int Address){
+	pca9555.setAddress(Address);
+	outputs=0;
+	known=0;
+	deferred_mask=0;
+}
+
+
+//-------------setDevicefile-------------
+/** @~english 
+* @brief Set devicefile.
+*
+* With this function you can change the I2C device file. Default is "/dev/i2c-1"
+* @param filename path to the I2C device file
+*
+* @~german 
+* @brief Setzt Device Datei.
+*
+* Mit dieser Funktion kann die I2C Gerätedatei geändert werden. Standartmäßig wird "/dev/i2c-1" benutzt.
+* @param filename Pfad zur I2C Gerätedatei
+*/
+void gnublin_module_relay::setDevicefile(std::string filename){
+	pca9555.setDevicefile(filename);
+	outputs=0;
+	known=0;
+	deferred_mask=0;
+}
+
+//-------------------switch Pin----------------
+/** @~english 
+* @brief Switch pin.
+*
+* This function sets the given relay to the given value.
+* @param pin Number of the relay to switch (1-8)
+* @param value close (1) or open (0) the relay (ON, OFF)
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Schalte Pin.
+*
+* Schalten der einzelnen Relays. 
+* @param pin Nummer des anzusteuernden Relays (1-8)
+* @param value schließen (1) oder öffnen (0) des Relays (ON, OFF)
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_relay::switchPin(int pin, int value) {
+	error_flag=false;
+
+	if (pin < 1 || pin > 8) {
+		error_flag=true;
+		ErrorMessage="pin is not between 1-8!\n";
+		return -1;
+	}
+	if (value != 0 && value != 1) {
+		error_flag=true;
+		ErrorMessage="value is not 0 or 1!\n";
+		return -1;
+	}
+	return setRelays(1 << (pin-1), value << (pin-1));
+}
+
+
+//-------------------set Relays----------------
+/** @~english 
+* @brief Switch several relays at once.
+*
+* All relays selected by mask are switched with one port write, the other relays keep their state.
+* A relay pin is configured as output with its first write, the pins of the other relays are not touched.
+* Relays which are already in the requested state are not written, relays which changed less than the minimum time ago (see setMinTime()) are deferred until flush().
+* A new request for a relay replaces its deferred one.
+* @param mask bit n-1 = 1: relay n is switched
+* @param values bit n-1: new state of relay n, close (1) or open (0)
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Schalte mehrere Relays gleichzeitig.
+*
+* Alle mit mask ausgewählten Relays werden mit einem Schreibzugriff auf den Port geschaltet, die anderen Relays behalten ihren Zustand.
+* Ein Relay Pin wird mit seinem ersten Schreibzugriff als Ausgang konfiguriert, die Pins der anderen Relays werden nicht verändert.
+* Relays, die bereits im angeforderten Zustand sind, werden nicht geschrieben, Relays, die vor weniger als der Mindestzeit geschaltet haben (siehe setMinTime()), werden bis flush() zurückgestellt.
+* Eine neue Anforderung für ein Relay ersetzt seine zurückgestellte.
+* @param mask Bit n-1 = 1: Relay n wird geschaltet
+* @param values Bit n-1: neuer Zustand von Relay n, schließen (1) oder öffnen (0)
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_relay::setRelays(uint8_t mask, uint8_t values) {
+	return apply(deferred_mask | mask, (deferred_values & ~mask) | (values & mask));
+}
+
+
+// writes the relays of mask which may switch now, the others stay deferred
+int gnublin_module_relay::apply(uint8_t mask, uint8_t values) {
+	unsigned long long now=getMonotonicTime();
+	unsigned int start=pca9555.getTransactions();
+	uint8_t send=0;
+
+	error_flag=false;
+	last_transactions=0;
+	// known relays which already have the requested state are dropped
+	mask&=~(known & ~(state ^ values));
+	for (uint8_t m=mask; m; m&=m-1) {
+		int i=__builtin_ctz(m);
+		uint8_t bit=1 << i;
+
+		if ((known & bit) && now - changed_at[i] < ((state & bit) ? min_on : min_off))
+			continue;
+		send|=bit;
+	}
+	deferred_mask=mask & ~send;
+	deferred_values=values & deferred_mask;
+	if (!send)
+		return 1;
+
+	// the outputs get their level before they are switched to output, so no relay clicks
+	if (pca9555.writePortMasked(0, send, values) < 0) {
+		error_flag=true;
+		ErrorMessage=pca9555.getErrorMessage();
+		last_transactions=pca9555.getTransactions()-start;
+		deferred_mask=mask;
+		deferred_values=values & mask;
+		return -1;
+	}
+	// only the written pins become outputs, the others keep the power-up level high as inputs
+	if (send & ~outputs) {
+		if (pca9555.portModeMasked(0, send & ~outputs, PCA9555_OUTPUT) < 0) {
+			error_flag=true;
+			ErrorMessage=pca9555.getErrorMessage();
+			last_transactions=pca9555.getTransactions()-start;
+			return -1;
+		}
+		outputs|=send;
+	}
+	for (uint8_t m=send; m; m&=m-1) {
+		int i=__builtin_ctz(m);
+
+		// the first write of a relay is not counted as a switch, its previous state is unknown
+		if (known & (1 << i))
+			__sync_fetch_and_add(&wear->switches[i], 1);
+		changed_at[i]=now;
+	}
+	state=(state & ~send) | (values & send);
+	known|=send;
+	last_transactions=pca9555.getTransactions()-start;
+	return 1;
+}
+
+
+//-------------------set All----------------
+/** @~english 
+* @brief Set the state of all 8 relays with one port write.
+*
+* @param values bit n-1: new state of relay n, close (1) or open (0)
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Setze den Zustand aller 8 Relays mit einem Schreibzugriff auf den Port.
+*
+* @param values Bit n-1: neuer Zustand von Relay n, schließen (1) oder öffnen (0)
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_relay::setAll(uint8_t values) {
+	return setRelays(0xff, values);
+}
+
+
+//-------------------get Transactions----------------
+/** @~english 
+* @brief Number of I2C transactions of the last switchPin(), setRelays(), setAll() or flush() call.
+*
+* @return number of transactions
+*
+* @~german 
+* @brief Anzahl der I2C Transaktionen des letzten Aufrufs von switchPin(), setRelays(), setAll() oder flush().
+*
+* @return Anzahl der Transaktionen
+*/
+unsigned int gnublin_module_relay::getTransactions() {
+	return last_transactions;
+}
+
+
+//-------------------set Min Time----------------
+/** @~english 
+* @brief Set the minimum time a relay stays closed and open.
+*
+* Protects the relays against a control loop which switches too fast. 0 disables the limit.
+* @param on_ms minimum time a relay stays closed in ms
+* @param off_ms minimum time a relay stays open in ms
+*
+* @~german 
+* @brief Setze die Mindestzeit, die ein Relay geschlossen und offen bleibt.
+*
+* Schützt die Relays vor einer Regelung, die zu schnell schaltet. 0 schaltet die Begrenzung ab.
+* @param on_ms Mindestzeit, die ein Relay geschlossen bleibt, in ms
+* @param off_ms Mindestzeit, die ein Relay offen bleibt, in ms
+*/
+void gnublin_module_relay::setMinTime(unsigned int on_ms, unsigned int off_ms) {
+	min_on=on_ms*1000ULL;
+	min_off=off_ms*1000ULL;
+}
+
+
+//-------------------flush----------------
+/** @~english 
+* @brief Write the deferred relays whose minimum time is over.
+*
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Schreibe die zurückgestellten Relays, deren Mindestzeit abgelaufen ist.
+*
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_relay::flush() {
+	if (!deferred_mask) {
+		error_flag=false;
+		last_transactions=0;
+		return 1;
+	}
+	return apply(deferred_mask, deferred_values);
+}
+
+
+//-------------------get Flush Delay----------------
+/** @~english 
+* @brief Time until the next deferred relay may be switched.
+*
+* @return delay in ms, 0: flush() switches a relay now, -1: no relay is deferred
+*
+* @~german 
+* @brief Zeit, bis das nächste zurückgestellte Relay geschaltet werden darf.
+*
+* @return Verzögerung in ms, 0: flush() schaltet jetzt ein Relay, -1: kein Relay ist zurückgestellt
+*/
+int gnublin_module_relay::getFlushDelay() {
+	unsigned long long now=getMonotonicTime();
+	unsigned long long delay=~0ULL;
+
+	if (!deferred_mask)
+		return -1;
+	for (uint8_t m=deferred_mask; m; m&=m-1) {
+		int i=__builtin_ctz(m);
+		unsigned long long min=(state & (1 << i)) ? min_on : min_off;
+		unsigned long long age=now - changed_at[i];
+		unsigned long long d=age < min ? min - age : 0;
+
+		if (d < delay)
+			delay=d;
+	}
+	return (int)((delay + 999) / 1000);
+}
+
+
+//-------------------get Deferred----------------
+/** @~english 
+* @brief Relays with a deferred request.
+*
+* @return bit n-1 = 1: relay n is deferred
+*
+* @~german 
+* @brief Relays mit einer zurückgestellten Anforderung.
+*
+* @return Bit n-1 = 1: Relay n ist zurückgestellt
+*/
+uint8_t gnublin_module_relay::getDeferred() {
+	return deferred_mask;
+}
+
+
+//-------------------open Wear File----------------
+/** @~english 
+* @brief Keep the switching cycles in a state file.
+*
+* The file is created if it does not exist and mapped into memory, so counting a switch is a plain memory access.
+* Several processes may use the same file, the counters are incremented atomically.
+* @param filename path of the state file, one file per relay board
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Speichere die Schaltspiele in einer Zustandsdatei.
+*
+* Die Datei wird angelegt, falls sie nicht existiert, und in den Speicher eingeblendet, das Zählen eines Schaltspiels ist also ein einfacher Speicherzugriff.
+* Mehrere Prozesse können dieselbe Datei verwenden, die Zähler werden atomar erhöht.
+* @param filename Pfad der Zustandsdatei, eine Datei pro Relay Board
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_relay::openWearFile(std::string filename) {
+	struct stat st;
+	gnublin_relay_wear *map;
+	int fd;
+
+	fd=open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		error_flag=true;
+		ErrorMessage="ERROR opening: " + filename + "\n";
+		return -1;
+	}
+	if (fstat(fd, &st) < 0 || (st.st_size < (off_t)sizeof(gnublin_relay_wear) && ftruncate(fd, sizeof(gnublin_relay_wear)) < 0)) {
+		close(fd);
+		error_flag=true;
+		ErrorMessage="ERROR resizing: " + filename + "\n";
+		return -1;
+	}
+	map=(gnublin_relay_wear *)mmap(NULL, sizeof(gnublin_relay_wear), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		close(fd);
+		error_flag=true;
+		ErrorMessage="ERROR mapping: " + filename + "\n";
+		return -1;
+	}
+	if (map->magic != RELAY_WEAR_MAGIC) {
+		memset(map, 0, sizeof(gnublin_relay_wear));
+		map->magic=RELAY_WEAR_MAGIC;
+	}
+	closeWearFile();
+	wear=map;
+	wear_fd=fd;
+	error_flag=false;
+	return 1;
+}
+
+
+//-------------------close Wear File----------------
+/** @~english 
+* @brief Close the state file, the switching cycles are counted in memory again.
+*
+* @~german 
+* @brief Schließe die Zustandsdatei, die Schaltspiele werden wieder im Speicher gezählt.
+*/
+void gnublin_module_relay::closeWearFile() {
+	if (wear_fd < 0)
+		return;
+	msync(wear, sizeof(gnublin_relay_wear), MS_ASYNC);
+	munmap(wear, sizeof(gnublin_relay_wear));
+	close(wear_fd);
+	wear=&local_wear;
+	wear_fd=-1;
+}
+
+
+//-------------------get Switch Count----------------
+/** @~english 
+* @brief Number of switching cycles of a relay.
+*
+* @param pin Number of the relay (1-8)
+* @return number of switching cycles, 0 for an invalid pin
+*
+* @~german 
+* @brief Anzahl der Schaltspiele eines Relays.
+*
+* @param pin Nummer des Relays (1-8)
+* @return Anzahl der Schaltspiele, 0 bei ungültigem Pin
+*/
+unsigned int gnublin_module_relay::getSwitchCount(int pin) {
+	if (pin < 1 || pin > 8) {
+		error_flag=true;
+		ErrorMessage="pin is not between 1-8!\n";
+		return 0;
+	}
+	error_flag=false;
+	return wear->switches[pin-1];
+}
+
+//****************************************************************************
+// Class for timed switching of GNUBLIN Module-Relays
+//****************************************************************************
+
+/** @~english
+* @brief Create a scheduler for up to 4096 pending actions.
+*
+* @~german
+* @brief Erzeugt einen Scheduler für bis zu 4096 anstehende Aktionen.
+*/
+gnublin_relay_scheduler::gnublin_relay_scheduler(){
+	init(RELAY_SCHEDULER_ACTIONS);
+}
+
+/** @~english
+* @brief Create a scheduler.
+*
+* @param actions maximum number of pending actions, the memory is allocated once
+*
+* @~german
+* @brief Erzeugt einen Scheduler.
+*
+* @param actions maximale Anzahl anstehender Aktionen, der Speicher wird einmal reserviert
+*/
+gnublin_relay_scheduler::gnublin_relay_scheduler(int actions){
+	init(actions);
+}
+
+void gnublin_relay_scheduler::init(int actions){
+	error_flag = false;
+	if (actions < 2)
+		actions = 2;
+	this->actions = new relay_action[actions];
+	action_count = actions;
+	for (int i = 0; i < actions; i++)
+		this->actions[i].next = i + 1 < actions ? i + 1 : -1;
+	free_list = 0;
+	used = 0;
+	for (int l = 0; l < RELAY_WHEEL_LEVELS; l++) {
+		for (int s = 0; s < RELAY_WHEEL_SLOTS; s++) {
+			heads[l][s] = -1;
+			tails[l][s] = -1;
+		}
+	}
+	current_tick = getMonotonicTime() / 1000;
+	armed_tick = 0;
+	flush_tick = 0;
+	board_count = 0;
+	executed = 0;
+	writes = 0;
+	errors = 0;
+	jitter_sum = 0;
+	jitter_max = 0;
+	run_flag = false;
+	timer_fd = timerfd_create(CLOCK_MONOTONIC, 0);
+	if (timer_fd < 0) {
+		ErrorMessage = "timerfd_create failed\n";
+		error_flag = true;
+	}
+	pthread_mutex_init(&mutex, NULL);
+}
+
+/** @~english
+* @brief Stops the thread, pending actions are discarded.
+*
+* @~german
+* @brief Hält den Thread an, anstehende Aktionen werden verworfen.
+*/
+gnublin_relay_scheduler::~gnublin_relay_scheduler(){
+	stop();
+	if (timer_fd >= 0)
+		close(timer_fd);
+	delete [] actions;
+	pthread_mutex_destroy(&mutex);
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_relay_scheduler::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_relay_scheduler::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------addBoard-------------
+/** @~english
+* @brief Add a relay board.
+*
+* @param relay the board
+* @return index of the board, failure: -1
+*
+* @~german
+* @brief Fügt ein Relay Board hinzu.
+*
+* @param relay das Board
+* @return Index des Boards, Fehler: -1
+*/
+int gnublin_relay_scheduler::addBoard(gnublin_module_relay *relay){
+	int board;
+
+	pthread_mutex_lock(&mutex);
+	if (board_count >= RELAY_SCHEDULER_MAX_BOARDS) {
+		pthread_mutex_unlock(&mutex);
+		ErrorMessage = "too many boards\n";
+		error_flag = true;
+		return -1;
+	}
+	board = board_count;
+	boards[board] = relay;
+	for (int i = 0; i < 8; i++)
+		epochs[board][i] = 0;
+	board_count++;
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return board;
+}
+
+//-------------schedule-------------
+/** @~english
+* @brief Switch a relay after a delay.
+*
+* @param board index of the board
+* @param relay number of the relay (1-8)
+* @param value close (1) or open (0) the relay
+* @param delay_ms delay in ms
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Schaltet ein Relay nach einer Verzögerung.
+*
+* @param board Index des Boards
+* @param relay Nummer des Relays (1-8)
+* @param value schließen (1) oder öffnen (0) des Relays
+* @param delay_ms Verzögerung in ms
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_relay_scheduler::schedule(int board, int relay, int value, unsigned int delay_ms){
+	return scheduleAt(board, relay, value, getMonotonicTime() + delay_ms * 1000ULL);
+}
+
+//-------------scheduleAt-------------
+/** @~english
+* @brief Switch a relay at a point in time.
+*
+* Actions for the same relay which are due in the same ms are executed in the order they were scheduled.
+* @param board index of the board
+* @param relay number of the relay (1-8)
+* @param value close (1) or open (0) the relay
+* @param time µs, CLOCK_MONOTONIC (see getMonotonicTime()), times in the past are executed immediately
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Schaltet ein Relay zu einem Zeitpunkt.
+*
+* Aktionen für dasselbe Relay, die in derselben ms fällig sind, werden in der Reihenfolge ausgeführt, in der sie geplant wurden.
+* @param board Index des Boards
+* @param relay Nummer des Relays (1-8)
+* @param value schließen (1) oder öffnen (0) des Relays
+* @param time µs, CLOCK_MONOTONIC (siehe getMonotonicTime()), Zeitpunkte in der Vergangenheit werden sofort ausgeführt
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_relay_scheduler::scheduleAt(int board, int relay, int value, unsigned long long time){
+	int a;
+
+	if (board < 0 || board >= board_count || relay < 1 || relay > 8 || (value != 0 && value != 1)) {
+		ErrorMessage = "invalid board, relay or value\n";
+		error_flag = true;
+		return -1;
+	}
+	pthread_mutex_lock(&mutex);
+	if (free_list < 0) {
+		pthread_mutex_unlock(&mutex);
+		ErrorMessage = "too many pending actions\n";
+		error_flag = true;
+		return -1;
+	}
+	// the tick stands still while nothing is pending, catch up so the wheel doesn't have to step through the idle time
+	if (used == 0) {
+		unsigned long long now = getMonotonicTime() / 1000;
+		if (now > current_tick)
+			current_tick = now;
+	}
+	a = free_list;
+	free_list = actions[a].next;
+	used++;
+	actions[a].due = time;
+	actions[a].expires = (time + 999) / 1000;
+	if (actions[a].expires <= current_tick)
+		actions[a].expires = current_tick + 1;
+	actions[a].board = board;
+	actions[a].mask = 1 << (relay - 1);
+	actions[a].value = value << (relay - 1);
+	actions[a].epoch = epochs[board][relay - 1];
+	insert(a);
+	if (armed_tick == 0 || actions[a].expires < armed_tick)
+		arm(actions[a].expires);
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return 1;
+}
+
+//-------------pulse-------------
+/** @~english
+* @brief Close a relay for some time.
+*
+* @param board index of the board
+* @param relay number of the relay (1-8)
+* @param duration_ms time the relay stays closed in ms
+* @param delay_ms delay until the relay is closed in ms
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Schließt ein Relay für eine bestimmte Zeit.
+*
+* @param board Index des Boards
+* @param relay Nummer des Relays (1-8)
+* @param duration_ms Zeit, die das Relay geschlossen bleibt, in ms
+* @param delay_ms Verzögerung, bis das Relay geschlossen wird, in ms
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_relay_scheduler::pulse(int board, int relay, unsigned int duration_ms, unsigned int delay_ms){
+	unsigned long long on = getMonotonicTime() + delay_ms * 1000ULL;
+
+	pthread_mutex_lock(&mutex);
+	if (used + 2 > action_count) {
+		pthread_mutex_unlock(&mutex);
+		ErrorMessage = "too many pending actions\n";
+		error_flag = true;
+		return -1;
+	}
+	pthread_mutex_unlock(&mutex);
+	if (scheduleAt(board, relay, 1, on) < 0)
+		return -1;
+	return scheduleAt(board, relay, 0, on + duration_ms * 1000ULL);
+}
+
+//-------------cancel-------------
+/** @~english
+* @brief Cancel all pending actions of a relay.
+*
+* The cancelled actions keep their memory until they would have been due.
+* @param board index of the board
+* @param relay number of the relay (1-8)
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Bricht alle anstehenden Aktionen eines Relays ab.
+*
+* Die abgebrochenen Aktionen belegen ihren Speicher, bis sie fällig gewesen wären.
+* @param board Index des Boards
+* @param relay Nummer des Relays (1-8)
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_relay_scheduler::cancel(int board, int relay){
+	if (board < 0 || board >= board_count || relay < 1 || relay > 8) {
+		ErrorMessage = "invalid board or relay\n";
+		error_flag = true;
+		return -1;
+	}
+	pthread_mutex_lock(&mutex);
+	epochs[board][relay - 1]++;
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return 1;
+}
+
+//-------------start-------------
+/** @~english
+* @brief Start the scheduler thread.
+*
+* Actions can be scheduled before, they are executed as soon as the thread runs.
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Startet den Scheduler Thread.
+*
+* Aktionen können auch vorher geplant werden, sie werden ausgeführt, sobald der Thread läuft.
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_relay_scheduler::start(){
+	if (run_flag)
+		return 1;
+	if (timer_fd < 0) {
+		ErrorMessage = "timerfd_create failed\n";
+		error_flag = true;
+		return -1;
+	}
+	pthread_mutex_lock(&mutex);
+	rearm();
+	pthread_mutex_unlock(&mutex);
+	run_flag = true;
+	if (pthread_create(&thread, NULL, run, this) != 0) {
+		run_flag = false;
+		ErrorMessage = "pthread_create failed\n";
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
+
+//-------------stop-------------
+/** @~english
+* @brief Stop the scheduler thread, pending actions are kept.
+*
+* @~german
+* @brief Hält den Scheduler Thread an, anstehende Aktionen bleiben erhalten.
+*/
+void gnublin_relay_scheduler::stop(){
+	struct itimerspec its;
+
+	if (!run_flag)
+		return;
+	run_flag = false;
+	// an absolute time in the past expires immediately and wakes the thread
+	memset(&its, 0, sizeof(its));
+	its.it_value.tv_nsec = 1;
+	timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+	pthread_join(thread, NULL);
+	pthread_mutex_lock(&mutex);
+	armed_tick = 0;
+	pthread_mutex_unlock(&mutex);
+}
+
+//-------------pending-------------
+/** @~english
+* @brief Get the number of pending actions.
+*
+* @return number of actions, including cancelled ones which were not due yet
+*
+* @~german
+* @brief Gibt die Anzahl anstehender Aktionen zurück.
+*
+* @return Anzahl der Aktionen, einschließlich abgebrochener, die noch nicht fällig waren
+*/
+int gnublin_relay_scheduler::pending(){
+	int n;
+
+	pthread_mutex_lock(&mutex);
+	n = used;
+	pthread_mutex_unlock(&mutex);
+	return n;
+}
+
+//-------------statistics-------------
+/** @~english
+* @brief Get the number of executed actions.
+*
+* @return number of actions
+*
+* @~german
+* @brief Gibt die Anzahl ausgeführter Aktionen zurück.
+*
+* @return Anzahl der Aktionen
+*/
+unsigned int gnublin_relay_scheduler::getExecuted(){
+	return executed;
+}
+
+/** @~english
+* @brief Get the number of port writes.
+*
+* Less writes than executed actions show how many actions were coalesced or dropped by the boards.
+* @return number of writes
+*
+* @~german
+* @brief Gibt die Anzahl der Schreibzugriffe auf die Ports zurück.
+*
+* Weniger Schreibzugriffe als ausgeführte Aktionen zeigen, wie viele Aktionen zusammengefasst oder von den Boards verworfen wurden.
+* @return Anzahl der Schreibzugriffe
+*/
+unsigned int gnublin_relay_scheduler::getWrites(){
+	return writes;
+}
+
+/** @~english
+* @brief Get the number of failed port writes.
+*
+* @return number of failed writes
+*
+* @~german
+* @brief Gibt die Anzahl fehlgeschlagener Schreibzugriffe zurück.
+*
+* @return Anzahl fehlgeschlagener Schreibzugriffe
+*/
+unsigned int gnublin_relay_scheduler::getErrors(){
+	return errors;
+}
+
+/** @~english
+* @brief Get the largest delay between due time and port write.
+*
+* @return jitter in µs
+*
+* @~german
+* @brief Gibt die größte Verzögerung zwischen Fälligkeit und Schreibzugriff zurück.
+*
+* @return Jitter in µs
+*/
+unsigned int gnublin_relay_scheduler::getMaxJitter(){
+	return jitter_max;
+}
+
+/** @~english
+* @brief Get the average delay between due time and port write.
+*
+* @return jitter in µs
+*
+* @~german
+* @brief Gibt die durchschnittliche Verzögerung zwischen Fälligkeit und Schreibzugriff zurück.
+*
+* @return Jitter in µs
+*/
+unsigned int gnublin_relay_scheduler::getAverageJitter(){
+	unsigned int avg;
+
+	pthread_mutex_lock(&mutex);
+	avg = executed ? jitter_sum / executed : 0;
+	pthread_mutex_unlock(&mutex);
+	return avg;
+}
+
+/** @~english
+* @brief Reset the counters and the jitter statistics.
+*
+* @~german
+* @brief Setzt die Zähler und die Jitter Statistik zurück.
+*/
+void gnublin_relay_scheduler::resetStatistics(){
+	pthread_mutex_lock(&mutex);
+	executed = 0;
+	writes = 0;
+	errors = 0;
+	jitter_sum = 0;
+	jitter_max = 0;
+	pthread_mutex_unlock(&mutex);
+}
+
+// appends an action to a list, the order of actions due in the same tick is kept
+void gnublin_relay_scheduler::append(int *head, int *tail, int action){
+	actions[action].next = -1;
+	if (*head < 0)
+		*head = action;
+	else
+		actions[*tail].next = action;
+	*tail = action;
+}
+
+void gnublin_relay_scheduler::insert(int action){
+	unsigned long long expires = actions[action].expires;
+	unsigned long long delta = expires - current_tick;
+	int level, slot;
+
+	if (delta < (1ULL << RELAY_WHEEL_BITS0)) {
+		level = 0;
+		slot = expires & (RELAY_WHEEL_SLOTS - 1);
+	}
+	else if (delta < (1ULL << (RELAY_WHEEL_BITS0 + RELAY_WHEEL_BITS))) {
+		level = 1;
+		slot = (expires >> RELAY_WHEEL_BITS0) & ((1 << RELAY_WHEEL_BITS) - 1);
+	}
+	else if (delta < (1ULL << (RELAY_WHEEL_BITS0 + 2 * RELAY_WHEEL_BITS))) {
+		level = 2;
+		slot = (expires >> (RELAY_WHEEL_BITS0 + RELAY_WHEEL_BITS)) & ((1 << RELAY_WHEEL_BITS) - 1);
+	}
+	else {
+		// beyond the wheel: park in the last level, the action is inserted again when that slot cascades
+		if (delta >= (1ULL << (RELAY_WHEEL_BITS0 + 3 * RELAY_WHEEL_BITS)))
+			expires = current_tick + (1ULL << (RELAY_WHEEL_BITS0 + 3 * RELAY_WHEEL_BITS)) - 1;
+		level = 3;
+		slot = (expires >> (RELAY_WHEEL_BITS0 + 2 * RELAY_WHEEL_BITS)) & ((1 << RELAY_WHEEL_BITS) - 1);
+	}
+	append(&heads[level][slot], &tails[level][slot], action);
+}
+
+// moves the actions of a slot of a higher level to the lower levels
+void gnublin_relay_scheduler::cascade(int level, int slot){
+	int a = heads[level][slot];
+
+	heads[level][slot] = -1;
+	tails[level][slot] = -1;
+	while (a >= 0) {
+		int next = actions[a].next;
+		insert(a);
+		a = next;
+	}
+}
+
+// goes to the next tick with due actions or a cascade, at most to "tick", the due actions are appended to the fired list
+void gnublin_relay_scheduler::advance(unsigned long long tick, int *fired_head, int *fired_tail){
+	int index, a;
+
+	if (used == 0) {
+		current_tick = tick;
+		return;
+	}
+	// jump over empty slots of level 0, but not over the next cascade
+	while (current_tick + 1 < tick && ((current_tick + 1) & (RELAY_WHEEL_SLOTS - 1)) != 0
+	       && heads[0][(current_tick + 1) & (RELAY_WHEEL_SLOTS - 1)] < 0)
+		current_tick++;
+	current_tick++;
+	index = current_tick & (RELAY_WHEEL_SLOTS - 1);
+	if (index == 0) {
+		int i1 = (current_tick >> RELAY_WHEEL_BITS0) & ((1 << RELAY_WHEEL_BITS) - 1);
+		cascade(1, i1);
+		if (i1 == 0) {
+			int i2 = (current_tick >> (RELAY_WHEEL_BITS0 + RELAY_WHEEL_BITS)) & ((1 << RELAY_WHEEL_BITS) - 1);
+			cascade(2, i2);
+			if (i2 == 0)
+				cascade(3, (current_tick >> (RELAY_WHEEL_BITS0 + 2 * RELAY_WHEEL_BITS)) & ((1 << RELAY_WHEEL_BITS) - 1));
+		}
+	}
+	a = heads[0][index];
+	heads[0][index] = -1;
+	tails[0][index] = -1;
+	while (a >= 0) {
+		int next = actions[a].next;
+		append(fired_head, fired_tail, a);
+		a = next;
+	}
+}
+
+void gnublin_relay_scheduler::arm(unsigned long long tick){
+	struct itimerspec its;
+
+	armed_tick = tick;
+	memset(&its, 0, sizeof(its));
+	its.it_value.tv_sec = tick / 1000;
+	its.it_value.tv_nsec = (tick % 1000) * 1000000;
+	timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+// arms the timer for the next non-empty slot of level 0, the next cascade or the next deferred relay, disarms it if nothing is pending
+void gnublin_relay_scheduler::rearm(){
+	unsigned long long tick = current_tick + 1;
+	struct itimerspec its;
+
+	if (used == 0 && flush_tick == 0) {
+		armed_tick = 0;
+		memset(&its, 0, sizeof(its));
+		timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+		return;
+	}
+	while (used && heads[0][tick & (RELAY_WHEEL_SLOTS - 1)] < 0 && (tick & (RELAY_WHEEL_SLOTS - 1)) != 0)
+		tick++;
+	if (flush_tick && (used == 0 || flush_tick < tick))
+		tick = flush_tick;
+	arm(tick);
+}
+
+void *gnublin_relay_scheduler::run(void *arg){
+	gnublin_relay_scheduler *s = (gnublin_relay_scheduler *)arg;
+	unsigned char masks[RELAY_SCHEDULER_MAX_BOARDS];
+	unsigned char values[RELAY_SCHEDULER_MAX_BOARDS];
+	uint64_t expirations;
+
+	while (s->run_flag) {
+		unsigned long long now, flush, written[RELAY_SCHEDULER_MAX_BOARDS];
+		int fired = -1, fired_tail = -1;
+
+		if (read(s->timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EINTR)
+			break;
+		if (!s->run_flag)
+			break;
+
+		now = getMonotonicTime() / 1000;
+		pthread_mutex_lock(&s->mutex);
+		while (s->current_tick < now)
+			s->advance(now, &fired, &fired_tail);
+		// coalesce the due actions per board, later actions of a relay overwrite earlier ones
+		for (int b = 0; b < s->board_count; b++)
+			masks[b] = 0;
+		for (int a = fired; a >= 0; a = s->actions[a].next) {
+			relay_action *action = &s->actions[a];
+			int bit = __builtin_ctz(action->mask);
+
+			if (action->epoch != s->epochs[action->board][bit]) {
+				action->mask = 0;	// cancelled
+				continue;
+			}
+			masks[action->board] |= action->mask;
+			values[action->board] = (values[action->board] & ~action->mask) | action->value;
+		}
+		pthread_mutex_unlock(&s->mutex);
+
+		for (int b = 0; b < s->board_count; b++) {
+			if (masks[b]) {
+				written[b] = getMonotonicTime();
+				if (s->boards[b]->setRelays(masks[b], values[b]) < 0)
+					s->errors++;
+			}
+			else if (s->boards[b]->getFlushDelay() == 0) {
+				if (s->boards[b]->flush() < 0)
+					s->errors++;
+			}
+			else
+				continue;
+			if (s->boards[b]->getTransactions())
+				s->writes++;
+		}
+		// wake up again for the earliest deferred relay
+		flush = 0;
+		for (int b = 0; b < s->board_count; b++) {
+			int delay = s->boards[b]->getFlushDelay();
+			unsigned long long tick = now + delay + 1;
+
+			if (delay >= 0 && (flush == 0 || tick < flush))
+				flush = tick;
+		}
+
+		pthread_mutex_lock(&s->mutex);
+		while (fired >= 0) {
+			relay_action *action = &s->actions[fired];
+			int next = action->next;
+
+			if (action->mask) {
+				unsigned long long jitter = written[action->board] > action->due ? written[action->board] - action->due : 0;
+				s->jitter_sum += jitter;
+				if (jitter > s->jitter_max)
+					s->jitter_max = jitter;
+				s->executed++;
+			}
+			action->next = s->free_list;
+			s->free_list = fired;
+			s->used--;
+			fired = next;
+		}
+		s->flush_tick = flush;
+		s->rearm();
+		pthread_mutex_unlock(&s->mutex);
+	}
+	return NULL;
+}
+
+//*******************************************************************
+//Class for accessing GNUBLIN Module-step
+//*******************************************************************
+
+// TMC222 maximum velocity in full steps per second for Vmax 0-15
+static const unsigned short step_vmax_table[16] = {
+	99, 136, 167, 197, 213, 228, 243, 273, 303, 334, 364, 395, 456, 546, 729, 973
+};
+
+//-------------stepVelocity-------------
+/** @~english 
+* @brief Velocity of a TMC222 for a Vmax setting.
+*
+* @param vmax Vmax (0-15)
+* @return velocity in full steps per second, -1 for an invalid Vmax
+*
+* @~german 
+* @brief Geschwindigkeit eines TMC222 für eine Vmax Einstellung.
+*
+* @param vmax Vmax (0-15)
+* @return Geschwindigkeit in Vollschritten pro Sekunde, -1 bei ungültigem Vmax
+*/
+int stepVelocity(unsigned int vmax){
+	if (vmax > 15)
+		return -1;
+	return step_vmax_table[vmax];
+}
+
+//-------------gnublin_module_step-------------
+/** @~english 
+* @brief Set the motor parameters to the default values (irun = 15, ihold = 1, vmax = 8, vmin = 1).
+*
+* @~german 
+* @brief Setzt die Standartwerte der Motor Parameter (irun = 15, ihold = 1, vmax = 8, vmin = 1).
+*
+*/
+gnublin_module_step::gnublin_module_step()
+{
+	irun = 15;
+	ihold = 1;
+	vmax = 8;
+	vmin = 1;
+	error_flag = false;
+	status_valid = false;
+	status_max_age = 0;
+	pthread_mutex_init(&lock, NULL);
+}
+
+gnublin_module_step::~gnublin_module_step()
+{
+	pthread_mutex_destroy(&lock);
+}
+
+//-------------fail-------------
+/** @~english 
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german 
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_module_step::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english 
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german 
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_module_step::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------setAddress-------------
+/** @~english 
+* @brief Set the slave address 
+*
+* With this function you can set the individual I2C Slave-Address of the module.
+* @param Address new I2C slave Address
+*
+* @~german 
+* @brief Setzt Slave Adresse.
+*
+* Mit dieser Funktion kann die individuelle I2C Slave-Adresse des Moduls gesetzt werden.
+* @param Address neue I2C slave Adresse
+*/
+void gnublin_module_step::setAddress(int Address){
+	i2c.setAddress(Address);
+	discardStatus();
+}
+
+//-------------getAddress-------------
+/** @~english 
+* @brief Get the slave address.
+*
+* @return I2C slave address
+*
+* @~german 
+* @brief Gibt die Slave Adresse zurück.
+*
+* @return I2C Slave Adresse
+*/
+int gnublin_module_step::getAddress(){
+	return i2c.getAddress();
+}
+
+//-------------setDevicefile-------------
+/** @~english 
+* @brief Set devicefile.
+*
+* With this function you can change the I2C device file. Default is "/dev/i2c-1"
+* @param filename path to the I2C device file
+*
+* @~german 
+* @brief Setzt Device Datei.
+*
+* Mit dieser Funktion kann die I2C Gerätedatei geändert werden. Standartmäßig wird "/dev/i2c-1" benutzt.
+* @param filename Pfad zur I2C Gerätedatei
+*/
+void gnublin_module_step::setDevicefile(std::string filename){
+	i2c.setDevicefile(filename);
+	discardStatus();
+}
+
+//-------------setIrun-------------
+/** @~english 
+* @brief Set Irun.
+*
+* This Funktion sets the new Irun value.
+* @param newIrun values from 0 to 15 are possible
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Setze Irun.
+*
+* Diese Funktion setzt den neuen Irun Wert
+* @param newIrun Werte von 0 bis 15
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::setIrun(unsigned int newIrun){
+	if(newIrun <= 15){
+		irun=newIrun;
+		return 1;
+	}
+	else return -1;
+}
+
+//-------------setIhold-------------
+/** @~english 
+* @brief Set Ihold.
+*
+* This Funktion sets the new Ihold value.
+* @param newIhold values from 0 to 15 are possible
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Setze Ihold
+*
+* Diese Funktion setzt den neuen Ihold Wert
+* @param newIhold Werte von 0 bis 15
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::setIhold(unsigned int newIhold){
+	if(newIhold <= 15){
+		ihold=newIhold;
+		return 1;
+	}
+	else return -1;
+}
+
+//-------------setVmax-------------
+/** @~english 
+* @brief Set Vmax.
+*
+* This Funktion sets the new Vmax value.
+* @param newVmax values from 0 to 15 are possible
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Setze Vmax
+*
+* Diese Funktion setzt den neuen Vmax Wert
+* @param newVmax Werte von 0 bis 15
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::setVmax(unsigned int newVmax){
+	if(newVmax <= 15){
+		vmax=newVmax;
+		return 1;
+	}
+	else return -1;
+}
+
+//-------------setVmin-------------
+/** @~english 
+* @brief Set Vmin.
+*
+* This Funktion sets the new Vmin value.
+* @param newVmin values from 0 to 15 are possible
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Setze Vmin
+*
+* Diese Funktion setzt den neuen Vmin Wert
+* @param newVmin Werte von 0 bis 15
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::setVmin(unsigned int newVmin){
+	if(newVmin <= 15){
+		vmin=newVmin;
+		return 1;
+	}
+	else return -1;
+}
+
+//-------------writeTMC-------------
+/** @~english 
+* @brief Write to TMC.
+*
+* This funktion sends the amount of bytes (num) of the char array TxBuf to the TMC222 chip on the module-step.
+* @param TxBuf Send buffer
+* @param num amount of Bytes
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Sende an TMC.
+*
+* Diese Funktion sendet die Menge (num) an Bytes des Char Array TxBuf an den TMC222 Chip, welcher sich auf dem Moudule-step befindet.
+* @param TxBuf Sende Puffer
+* @param num Anzahl der zu sendenden Bytes
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::writeTMC(unsigned char *TxBuf, int num){
+	if(i2c.send(TxBuf, num) < 0){
+	    return -1;
+   	}
+	else return 1;
+}
+
+//-------------readTMC-------------
+/** @~english 
+* @brief Read from TMC.
+*
+* This funktion reads the amount of bytes (num) of the TMC222 chip on the module-step and write it to the char array RxBuf.
+* @param RxBuf Receive buffer
+* @param num amount of Bytes
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Sende an TMC.
+*
+* Diese Funktion ließt die Menge (num) an Bytes vom TMC222 Chip, welcher sich auf dem Moudule-step befindet und übergibt das Ergebnis im Char Array RxBuf.
+* @param RxBuf Empfangs Puffer
+* @param num Anzahl der zu lesenden Bytes
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::readTMC(unsigned char *RxBuf, int num){
+   	if(i2c.receive(RxBuf, num) < 0){
+       	return -1;
+    }
+	else return 1;	
+}
+
+//-------------burnNewAddress-------------
+/** @~english 
+* @brief Burn a new I2C slave Address.
+*
+* This function calculates the needet bits to burn on the TMC222 chip, to get the new given slave-address. After that, the OTP bits are burned into the Chip.
+* @param new_address the new slave address
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Brennt die übergebene slave Adresse.
+*
+* Diese Funktion berechnet die benötigten Bits, um die neue Adresse auf den Chip zu brennen. Anschließend werden die OTP bits gebrannt.
+* Achtung: Sind die Bits einmal gesetzt, kann dies nicht wieder rückgängig gemacht werden. Falls eine Adresse eingegeben wird, die nicht möglich ist, wird dies von der Funktion gemeldet.
+* 
+* @param new_address die neue Slave Adresse
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::burnNewAddress(int new_address){
+	
+	//SetOTPParam
+	unsigned char buffer[5];
+	int new_ad = 0;
+	int old_ad = 0;
+	int slave_address=i2c.getAddress();
+	std::string yes = "NO!";
+
+ 	if(new_address <= slave_address){
+		printf("\tThe new address must be higher than the old one (0x%x)!\n",slave_address);
+		return -1;
+ 	}
+ 	else if (new_address > 0x7f){
+		printf("The biggest slave address of the TMC222 is 0x7f\n");
+		return -1;
+ 	}
+ 	else{
+  		old_ad = (slave_address & 0x1e) >> 1;
+  		new_ad = (new_address & 0x1e) >> 1;
+  		if(((new_ad & 0x1)<(old_ad & 0x1))|((new_ad & 0x2)<(old_ad & 0x2))|((new_ad & 0x4)<(old_ad & 0x4))|((new_ad & 0x8)<(old_ad & 0x8))){
+        		printf("\tThis address could not be set, because the '1' cant be undone!\n"
+        			"\told OTP AD: 0x%x\n"
+        			"\tnew OTP AD: 0x%x\n",old_ad, new_ad);
+        		return -1;
+  		}
+	  	if((new_address & 0x01) == 1){
+			printf("\tThe LSB address bit is set by the jumper on the module-step\n");
+			new_address --;
+			printf("\tThe new address will be set to: 0x%x \n", new_address);
+	  	}
+
+	    	printf("\tIf a bit of the OTP (on time programmable) is set, it cant be undone! \n\t"
+	    		"If you are sure to write the new Address (0x%x) then type 'yes' in CAPITALS\n\n\t", new_address);
+	    	std::cin >> yes;
+	    	if(yes == "YES"){
+			buffer[0] = 0x90; //SetOTPParam
+			buffer[1] = 0xff; //N/A
+			buffer[2] = 0xff; //N/A
+			buffer[3] = 0x02; //set AD3 AD2 AD1 AD0
+			buffer[4] = (unsigned char) new_ad;
+
+		   	if(i2c.send(buffer, 5) < 0){
+			   	return -1;
+			}
+			else {
+				printf("\tNew Address was successfully set to: 0x%x\n\tPlease replug the module.\n\n", new_address);
+				return 1;
+			}
+	    	}
+	  	else{
+			printf("\tYou didn't type 'YES'\n");
+			return -1;
+	  	}
+	}
+}
+
+//-------------getFullStatus-------------
+/** @~english 
+* @brief Get full Status 1.
+*
+* This funktion sends the getFullStatus1 Command to the Chip.
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Get full Status 1.
+*
+* Diese Funktion sendet den getFullStatus1 Befehl an den Chip.
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::getFullStatus1(){
+      	if(i2c.send(0x81) > 0){
+		return 1;		
+	}
+	else return -1;
+}
+
+//-------------getFullStatus2-------------
+/** @~english 
+* @brief Get full Status 2.
+*
+* This funktion sends the getFullStatus2 Command to the Chip.
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Get full Status 2.
+*
+* Diese Funktion sendet den getFullStatus2 Befehl an den Chip.
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::getFullStatus2(){
+	if(i2c.send(0xfc) > 0){
+		return 1;
+	}
+	else return -1;
+}
+
+//-------------runInit-------------
+/** @~english 
+* @brief Run Init.
+*
+* This funktion sends the runInit Command to the Chip.
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Run Init.
+*
+* Diese Funktion sendet den runInit Befehl an den Chip.
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::runInit(){
+		discardStatus();
+		if(i2c.send(0x88) > 0){
+		return 1;
+		}
+		else return -1;
+}
+
+//-------------setMotorParam-------------
+/** @~english 
+* @brief Set motor parameter.
+*
+* This function sends the motor parameter to the module.
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Setze Motor Parameter.
+*
+* Diese Funktion sendet die eingestellten Motor Parameter an das Modul.
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::setMotorParam(){
+	unsigned char buffer[8];
+
+	buildSetMotorParam(buffer);
+
+	discardStatus();
+    if(i2c.send(buffer, 8) > 0){
+	return 1;
+	}
+	else return -1;
+}
+
+//-------------setMotorParam-------------
+/** @~english 
+* @brief Set motor parameter.
+*
+* This function sends the motor parameter to the module.
+* @param newIrun
+* @param newIhold
+* @param newVmax
+* @param newVmin
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Setze Motor Parameter.
+*
+* Diese Funktion sendet die übergebenen Motor Parameter an das Modul.
+* @param newIrun
+* @param newIhold
+* @param newVmax
+* @param newVmin
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::setMotorParam(unsigned int newIrun, unsigned int newIhold, unsigned int newVmax, unsigned int newVmin){
+	irun=newIrun;
+	ihold=newIhold;
+	vmax=newVmax;
+	vmin=newVmin;
+
+	unsigned char buffer[8];
+
+	buildSetMotorParam(buffer);
+
+	discardStatus();
+    if(i2c.send(buffer, 8) > 0){
+	return 1;
+	}
+	else return -1;
+}
+
+//-------------hardStop-------------
+/** @~english 
+* @brief Hard stop.
+*
+* This funktion sends the hardStop Command to the Chip. The motor will stop immediately.
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Hard Stop.
+*
+* Diese Funktion sendet den hardStop Befehl an den Chip. Der Motor bleibt sofort Stehen.
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::hardStop(){
+		discardStatus();
+		if(i2c.send(0x85) > 0){
+		return 1;
+		}
+		else return -1;
+}
+
+//-------------softStop-------------
+/** @~english 
+* @brief Soft stop.
+*
+* This funktion sends the softStop Command to the Chip. The motor slows down and stops.
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Soft Stop.
+*
+* Diese Funktion sendet den SoftStop Befehl an den Chip. Der Motor fährt langsam herrunter.
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::softStop(){
+		discardStatus();
+		if(i2c.send(0x8f) > 0){
+		return 1;
+		}
+		else return -1;
+}
+
+//-------------resetPosition-------------
+/** @~english 
+* @brief Reset Position.
+*
+* This funktion sends the resetPosition Command to the Chip. The internal position counter of the chip is reset to 0.
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Reset Position.
+*
+* Diese Funktion sendet den resetPosition Befehl an den Chip. Der interne Positions Zähler des Chips wird auf 0 zurückgesetzt.
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::resetPosition(){
+		discardStatus();
+		if(i2c.send(0x86) > 0){
+		return 1;
+		}
+		else return -1;
+}
+
+//-------------setPosition-------------
+/** @~english 
+* @brief Set Position.
+*
+* This funktion sends the Position Command to the Chip. The motor drives to the given position.
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Setze Position.
+*
+* Diese Funktion sendet den Position Befehl an den Chip. Der Motor fährt an die übergebene Position.
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::setPosition(int position){
+	unsigned char buffer[5];
+
+	buildSetPosition(buffer, position);
+	
+	pthread_mutex_lock(&lock);
+	status_valid = false;
+	if(i2c.send(buffer, 5) > 0){
+		pthread_mutex_unlock(&lock);
+		return 1;
+	}
+	pthread_mutex_unlock(&lock);
+	return -1;
+}
+
+//-------------drive-------------
+/** @~english 
+* @brief Drive.
+*
+* This Funktion reads the actual position from the motor and adds the amount of given steps to drive. So you can let the motor drive an amount of steps, without heaving trouble with the absolute positions.
+* The position is always read from the motor (never from the status snapshot), and no other command of this object is sent between the read and the SetPosition.
+* @param steps steps relative to the actual position
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Fahre.
+*
+* Diese Funktion ließt die aktuelle Position des Motors und addiert die anzahl der übergebenen Schritte. So kann man den Motor einfach um eine bestimmte Anzahl Schritte fahren lassen, ohne sich über die absoulute Position gedanken machen zu müssen.
+* Die Position wird immer vom Motor gelesen (nie aus der Status Momentaufnahme), und zwischen dem Lesen und dem SetPosition wird kein anderer Befehl dieses Objekts gesendet.
+* @param steps Schritte relativ zur aktuellen Position
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::drive(int steps){
+	unsigned char command = 0xfc;	// GetFullStatus2
+	unsigned char fs2[8];
+	unsigned char buffer[5];
+	struct i2c_msg msgs[2];
+	int position;
+
+	msgs[0].addr = i2c.getAddress();
+	msgs[0].flags = 0;
+	msgs[0].len = 1;
+	msgs[0].buf = &command;
+	msgs[1].addr = i2c.getAddress();
+	msgs[1].flags = I2C_M_RD;
+	msgs[1].len = 8;
+	msgs[1].buf = fs2;
+
+	// no other command of this object may change the target between the read and the write
+	pthread_mutex_lock(&lock);
+	status_valid = false;
+	if (i2c.transfer(msgs, 2) < 0) {
+		error_flag = true;
+		ErrorMessage = i2c.getErrorMessage();
+		pthread_mutex_unlock(&lock);
+		return -1;
+	}
+	position = (short)(fs2[1] << 8 | fs2[2]);
+	buildSetPosition(buffer, position + steps);
+	if (i2c.send(buffer, 5) < 0) {
+		error_flag = true;
+		ErrorMessage = i2c.getErrorMessage();
+		pthread_mutex_unlock(&lock);
+		return -1;
+	}
+	error_flag = false;
+	pthread_mutex_unlock(&lock);
+	return 1;
+}
+
+//-------------getMotionStatus-------------
+/** @~english 
+* @brief Get motion status.
+*
+* This funktion Indicates the actual behavior of the position controller. <br>
+*	0: Actual Position = Target Position; Velocity= 0 <br>
+*	1: Positive Acceleration; Velocity > 0 <br>
+*	2: Negative Acceleration; Velocity > 0 <br>
+*	3: Acceleration = 0 Velocity = maximum pos Velocity <br>
+*	4: Actual Position /= Target Position; Velocity= 0 <br>
+*	5: Positive Acceleration; Velocity < 0 <br>
+*	6: Positive Acceleration; Velocity < 0 <br>
+*	7: Acceleration = 0 Velocity = maximum neg Velocity <br>
+*	-1: failure
+*
+* @return motionStatus
+*
+* @~german 
+* @brief Bewegungs-Status.
+*
+* Diese Funktion gibt den aktuellen bewegungs Status des module-step zurück. <br>
+*	0: Aktuelle Position = Ziehl Position; Geschwindigkeit= 0 <br>
+*	1: Positive Beschleunigung; Geschwindigkeit > 0 <br>
+*	2: Negative Beschleunigung; Geschwindigkeit > 0 <br>
+*	3: Beschleunigung = 0; Geschwindigkeit = maximum pos Geschwindigkeit <br>
+*	4: Aktuelle Position /= Ziehl Position; Geschwindigkeit= 0 <br>
+*	5: Positive Beschleunigung; Geschwindigkeit < 0 <br>
+*	6: Positive Beschleunigung; Geschwindigkeit < 0 <br>
+*	7: Acceleration = 0 Geschwindigkeit = maximum neg Geschwindigkeit  <br>
+*	-1: Fehler
+* @return motionStatus
+*/
+int gnublin_module_step::getMotionStatus(){
+	gnublin_step_status snapshot;
+
+	if(refreshStatus(&snapshot) < 0)
+		return -1;
+	return snapshot.motion;
+}
+
+
+//-------------------get Switch status----------------
+/** @~english 
+* @brief Get switch condition.
+*
+* This function checks the status of the connected switch and returns the value. <br>
+* Switch closed: 1 <br>
+* Switch open: 0 <br>
+* Failure: -1
+* @return success: swi
+*
+* @~german 
+* @brief Setze Position.
+*
+* Diese Funktion überprüft den Zustand des angeschlossenen Schalters und gibt den Wert zurück. <br>
+* Schalter geschlossen: 1 <br>
+* Schalter offen: 0 <br>
+* Fehler: -1
+* @return swi
+*/
+int gnublin_module_step::getSwitch(){
+	gnublin_step_status snapshot;
+
+	if(refreshStatus(&snapshot) < 0)
+		return -1;
+	return snapshot.switch_closed ? 1 : 0;
+}
+
+//-------------------getActualPosition----------------
+/** @~english 
+* @brief Get actual position.
+*
+* This funktion returns the actual position of the status snapshot (see updateStatus()).
+* @return actualPosition as unsigned 16 bit value (0-65535), -1 if failure
+*
+* @~german 
+* @brief Aktuelle Position ausgeben.
+*
+* Diese Funktion gibt die aktuelle Position der Status Momentaufnahme zurück (siehe updateStatus()).
+* @return actualPosition als vorzeichenloser 16 Bit Wert (0-65535), -1 bei Fehler
+*/
+int gnublin_module_step::getActualPosition(){
+	gnublin_step_status snapshot;
+
+	if(refreshStatus(&snapshot) < 0)
+		return -1;
+	return snapshot.position & 0xffff;
+}
+
+//-------------------updateStatus----------------
+/** @~english 
+* @brief Take a new status snapshot.
+*
+* Sends GetFullStatus1 and GetFullStatus2 and reads both answers in one bus transaction, then decodes all fields.
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Erstellt eine neue Status Momentaufnahme.
+*
+* Sendet GetFullStatus1 und GetFullStatus2 und liest beide Antworten in einer Bus Transaktion, danach werden alle Felder dekodiert.
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::updateStatus(){
+	int result;
+
+	pthread_mutex_lock(&lock);
+	result = readStatus();
+	pthread_mutex_unlock(&lock);
+	return result;
+}
+
+// takes a new snapshot, the lock must be held
+int gnublin_module_step::readStatus(){
+	unsigned char commands[2] = { 0x81, 0xfc };	// GetFullStatus1, GetFullStatus2
+	unsigned char fs1[8], fs2[8];
+	struct i2c_msg msgs[4];
+
+	for (int i = 0; i < 2; i++) {
+		msgs[2*i].addr = i2c.getAddress();
+		msgs[2*i].flags = 0;
+		msgs[2*i].len = 1;
+		msgs[2*i].buf = &commands[i];
+		msgs[2*i+1].addr = i2c.getAddress();
+		msgs[2*i+1].flags = I2C_M_RD;
+		msgs[2*i+1].len = 8;
+		msgs[2*i+1].buf = i ? fs2 : fs1;
+	}
+	if (i2c.transfer(msgs, 4) < 0) {
+		status_valid = false;
+		error_flag = true;
+		ErrorMessage = i2c.getErrorMessage();
+		return -1;
+	}
+	status.timestamp = getMonotonicTime();
+	status.irun = fs1[1] >> 4;
+	status.ihold = fs1[1] & 0x0f;
+	status.vmax = fs1[2] >> 4;
+	status.vmin = fs1[2] & 0x0f;
+	status.acc_shape = fs1[3] & 0x80;
+	status.step_mode = (fs1[3] >> 5) & 0x03;
+	status.shaft = fs1[3] & 0x10;
+	status.acc = fs1[3] & 0x0f;
+	status.vdd_reset = fs1[4] & 0x80;
+	status.step_loss = fs1[4] & 0x40;
+	status.electrical_defect = fs1[4] & 0x20;
+	status.under_voltage = fs1[4] & 0x10;
+	status.thermal_shutdown = fs1[4] & 0x08;
+	status.thermal_warning = fs1[4] & 0x04;
+	status.temp_info = fs1[4] & 0x03;
+	status.motion = (fs1[5] & 0xe0) >> 5;
+	status.switch_closed = fs1[5] & 0x10;
+	status.overcurrent = fs1[5] & 0x0c;
+	status.charge_pump_failure = fs1[5] & 0x01;
+	status.position = (short)(fs2[1] << 8 | fs2[2]);
+	status.target = (short)(fs2[3] << 8 | fs2[4]);
+	status_valid = true;
+	error_flag = false;
+	return 1;
+}
+
+/** @~english 
+* @brief Take a new status snapshot and copy it.
+*
+* @param status the snapshot is copied to it
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Erstellt eine neue Status Momentaufnahme und kopiert sie.
+*
+* @param status hierhin wird die Momentaufnahme kopiert
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::updateStatus(gnublin_step_status *status){
+	int result;
+
+	pthread_mutex_lock(&lock);
+	result = readStatus();
+	if (result > 0)
+		*status = this->status;
+	pthread_mutex_unlock(&lock);
+	return result;
+}
+
+// copies the snapshot, a new one is taken if there is none or it is older than the allowed age
+int gnublin_module_step::refreshStatus(gnublin_step_status *status){
+	int result = 1;
+
+	pthread_mutex_lock(&lock);
+	if (status_valid && status_max_age && getMonotonicTime() - this->status.timestamp <= status_max_age)
+		error_flag = false;
+	else
+		result = readStatus();
+	if (result > 0)
+		*status = this->status;
+	pthread_mutex_unlock(&lock);
+	return result;
+}
+
+//-------------------getStatus----------------
+/** @~english 
+* @brief Get the status snapshot.
+*
+* A new snapshot is taken if the last one is older than the allowed age (see setStatusMaxAge()).
+* @param status the snapshot is copied to it
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Gibt die Status Momentaufnahme zurück.
+*
+* Eine neue Momentaufnahme wird erstellt, wenn die letzte älter als das erlaubte Alter ist (siehe setStatusMaxAge()).
+* @param status hierhin wird die Momentaufnahme kopiert
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::getStatus(gnublin_step_status *status){
+	return refreshStatus(status);
+}
+
+//-------------------setStatusMaxAge----------------
+/** @~english 
+* @brief Set how long a status snapshot is reused.
+*
+* Commands which change the motion (setPosition(), drive(), hardStop(), ...) always discard the snapshot.
+* @param ms maximum age in ms, 0: every call takes a new snapshot (default)
+*
+* @~german 
+* @brief Setzt, wie lange eine Status Momentaufnahme wiederverwendet wird.
+*
+* Befehle, die die Bewegung ändern (setPosition(), drive(), hardStop(), ...), verwerfen die Momentaufnahme immer.
+* @param ms maximales Alter in ms, 0: jeder Aufruf erstellt eine neue Momentaufnahme (Standard)
+*/
+void gnublin_module_step::setStatusMaxAge(unsigned int ms){
+	pthread_mutex_lock(&lock);
+	status_max_age = ms * 1000ULL;
+	pthread_mutex_unlock(&lock);
+}
+
+//-------------------discardStatus----------------
+/** @~english 
+* @brief Discard the status snapshot.
+*
+* Needed when a command was sent to this module by other means, e.g. with transfer() of another module or as general call.
+*
+* @~german 
+* @brief Verwirft die Status Momentaufnahme.
+*
+* Nötig, wenn ein Befehl auf anderem Weg an dieses Modul gesendet wurde, z.B. mit transfer() eines anderen Moduls oder als General Call.
+*/
+void gnublin_module_step::discardStatus(){
+	pthread_mutex_lock(&lock);
+	status_valid = false;
+	pthread_mutex_unlock(&lock);
+}
+
+//-------------------buildSetMotorParam----------------
+/** @~english 
+* @brief Build a SetMotorParam frame with the set motor parameters.
+*
+* Together with buildSetPosition() and transfer() several commands can be sent in one bus transaction.
+* @param buffer 8 bytes, the frame is stored in it
+* @return length of the frame (8)
+*
+* @~german 
+* @brief Erstellt einen SetMotorParam Rahmen mit den eingestellten Motor Parametern.
+*
+* Zusammen mit buildSetPosition() und transfer() können mehrere Befehle in einer Bus Transaktion gesendet werden.
+* @param buffer 8 Bytes, hier wird der Rahmen gespeichert
+* @return Länge des Rahmens (8)
+*/
+int gnublin_module_step::buildSetMotorParam(unsigned char *buffer){
+	return buildSetMotorParam(buffer, vmax);
+}
+
+/** @~english 
+* @brief Build a SetMotorParam frame with another Vmax.
+*
+* The set Vmax of the module is not changed.
+* @param buffer 8 bytes, the frame is stored in it
+* @param vmax Vmax of the frame (0-15)
+* @return length of the frame (8)
+*
+* @~german 
+* @brief Erstellt einen SetMotorParam Rahmen mit einem anderen Vmax.
+*
+* Das eingestellte Vmax des Moduls wird nicht verändert.
+* @param buffer 8 Bytes, hier wird der Rahmen gespeichert
+* @param vmax Vmax des Rahmens (0-15)
+* @return Länge des Rahmens (8)
+*/
+int gnublin_module_step::buildSetMotorParam(unsigned char *buffer, unsigned int vmax){
+	buffer[0] = 0x89; //SetMotorParam
+	buffer[1] = 0xff; //N/A
+	buffer[2] = 0xff; //N/A
+	buffer[3] = (unsigned char) ((irun * 0x10) + ihold); //Irun & I hold
+	buffer[4] = (unsigned char) ((vmax * 0x10) + vmin); //Vmax & Vmin 
+	buffer[5] = 0x00; //status
+	buffer[6] = 0x00; //securePos
+	buffer[7] = 0x00; //StepMode
+	return 8;
+}
+
+//-------------------buildSetPosition----------------
+/** @~english 
+* @brief Build a SetPosition frame.
+*
+* @param buffer 5 bytes, the frame is stored in it
+* @param position target position
+* @return length of the frame (5)
+*
+* @~german 
+* @brief Erstellt einen SetPosition Rahmen.
+*
+* @param buffer 5 Bytes, hier wird der Rahmen gespeichert
+* @param position Ziel Position
+* @return Länge des Rahmens (5)
+*/
+int gnublin_module_step::buildSetPosition(unsigned char *buffer, int position){
+	buffer[0] = 0x8B;   // SetPosition Command
+	buffer[1] = 0xff;   // not avialable
+	buffer[2] = 0xff;   // not avialable
+	buffer[3] = (unsigned char) (position >> 8);  // PositionByte1 (15:8)
+	buffer[4] = (unsigned char)  position;       // PositionByte2 (7:0)
+	return 5;
+}
+
+//-------------------transfer----------------
+/** @~english 
+* @brief Send several messages in one bus transaction.
+*
+* The messages go to the bus of this module, their addresses may belong to other modules on the same bus. The status snapshot is discarded.
+* @param msgs messages (see gnublin_i2c::transfer())
+* @param count number of messages
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Sendet mehrere Nachrichten in einer Bus Transaktion.
+*
+* Die Nachrichten gehen an den Bus dieses Moduls, ihre Adressen dürfen zu anderen Modulen am selben Bus gehören. Die Status Momentaufnahme wird verworfen.
+* @param msgs Nachrichten (siehe gnublin_i2c::transfer())
+* @param count Anzahl der Nachrichten
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::transfer(struct i2c_msg *msgs, int count){
+	pthread_mutex_lock(&lock);
+	status_valid = false;
+	if (i2c.transfer(msgs, count) < 0) {
+		error_flag = true;
+		ErrorMessage = i2c.getErrorMessage();
+		pthread_mutex_unlock(&lock);
+		return -1;
+	}
+	error_flag = false;
+	pthread_mutex_unlock(&lock);
+	return 1;
+}
+
+//****************************************************************************
+// Class for waiting on the motion of several GNUBLIN Module-steps
+//****************************************************************************
+
+/** @~english
+* @brief Create a poller without motors.
+*
+* @~german
+* @brief Erzeugt einen Poller ohne Motoren.
+*/
+gnublin_step_poller::gnublin_step_poller(){
+	pthread_condattr_t attr;
+
+	motor_count = 0;
+	queue = NULL;
+	min_interval = STEP_POLLER_MIN_INTERVAL * 1000ULL;
+	max_interval = STEP_POLLER_MAX_INTERVAL * 1000ULL;
+	polls = 0;
+	thread_started = false;
+	run_flag = false;
+	error_flag = false;
+	pthread_mutex_init(&mutex, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&work, &attr);
+	pthread_cond_init(&completion, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+/** @~english
+* @brief Stops the thread, moves in progress are not stopped.
+*
+* @~german
+* @brief Hält den Thread an, laufende Bewegungen werden nicht angehalten.
+*/
+gnublin_step_poller::~gnublin_step_poller(){
+	if (thread_started) {
+		pthread_mutex_lock(&mutex);
+		run_flag = false;
+		pthread_cond_signal(&work);
+		pthread_mutex_unlock(&mutex);
+		pthread_join(thread, NULL);
+	}
+	pthread_cond_destroy(&work);
+	pthread_cond_destroy(&completion);
+	pthread_mutex_destroy(&mutex);
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_step_poller::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_step_poller::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------addMotor-------------
+/** @~english
+* @brief Add a motor.
+*
+* The thread is started with the first motor.
+* @param motor the motor, it must be initialised (setMotorParam(), runInit())
+* @return index of the motor, failure: -1
+*
+* @~german
+* @brief Fügt einen Motor hinzu.
+*
+* Der Thread wird mit dem ersten Motor gestartet.
+* @param motor der Motor, er muss initialisiert sein (setMotorParam(), runInit())
+* @return Index des Motors, Fehler: -1
+*/
+int gnublin_step_poller::addMotor(gnublin_module_step *motor){
+	int index;
+
+	pthread_mutex_lock(&mutex);
+	if (motor_count >= STEP_POLLER_MAX_MOTORS) {
+		pthread_mutex_unlock(&mutex);
+		ErrorMessage = "too many motors\n";
+		error_flag = true;
+		return -1;
+	}
+	if (!thread_started) {
+		run_flag = true;
+		if (pthread_create(&thread, NULL, run, this) != 0) {
+			run_flag = false;
+			pthread_mutex_unlock(&mutex);
+			ErrorMessage = "pthread_create failed\n";
+			error_flag = true;
+			return -1;
+		}
+		thread_started = true;
+	}
+	index = motor_count;
+	motors[index].motor = motor;
+	motors[index].issued = 0;
+	motors[index].completed = 0;
+	motors[index].result = 1;
+	motors[index].position = 0;
+	motors[index].velocity = 0;
+	motors[index].next_poll = 0;
+	motor_count++;
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return index;
+}
+
+//-------------setPosition-------------
+/** @~english
+* @brief Drive a motor to a position.
+*
+* A new move of a motor replaces its previous one, both handles complete when the motor stands still.
+* @param motor index of the motor
+* @param position target position
+* @return handle of the move (> 0), failure: -1
+*
+* @~german
+* @brief Fährt einen Motor an eine Position.
+*
+* Eine neue Bewegung eines Motors ersetzt seine vorherige, beide Handles sind abgeschlossen, wenn der Motor steht.
+* @param motor Index des Motors
+* @param position Ziel Position
+* @return Handle der Bewegung (> 0), Fehler: -1
+*/
+int gnublin_step_poller::setPosition(int motor, int position){
+	return start(motor, position, false);
+}
+
+//-------------drive-------------
+/** @~english
+* @brief Drive a motor an amount of steps.
+*
+* @param motor index of the motor
+* @param steps steps relative to the actual position
+* @return handle of the move (> 0), failure: -1
+*
+* @~german
+* @brief Fährt einen Motor eine Anzahl Schritte.
+*
+* @param motor Index des Motors
+* @param steps Schritte relativ zur aktuellen Position
+* @return Handle der Bewegung (> 0), Fehler: -1
+*/
+int gnublin_step_poller::drive(int motor, int steps){
+	return start(motor, steps, true);
+}
+
+int gnublin_step_poller::start(int motor, int value, bool relative){
+	motor_state *m;
+	int result, handle;
+
+	if (motor < 0 || motor >= motor_count) {
+		ErrorMessage = "invalid motor\n";
+		error_flag = true;
+		return -1;
+	}
+	m = &motors[motor];
+	pthread_mutex_lock(&mutex);
+	result = relative ? m->motor->drive(value) : m->motor->setPosition(value);
+	if (result < 0) {
+		ErrorMessage = m->motor->getErrorMessage();
+		pthread_mutex_unlock(&mutex);
+		error_flag = true;
+		return -1;
+	}
+	handle = issue(motor, relative ? abs(value) : abs(value - m->position));
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return handle;
+}
+
+//-------------watch-------------
+/** @~english
+* @brief Watch a move which was started without the poller.
+*
+* E.g. a SetPosition which was sent together with other commands with gnublin_module_step::transfer().
+* @param motor index of the motor
+* @param target target position of the move
+* @return handle of the move (> 0), failure: -1
+*
+* @~german
+* @brief Überwacht eine Bewegung, die ohne den Poller gestartet wurde.
+*
+* Z.B. ein SetPosition, das zusammen mit anderen Befehlen mit gnublin_module_step::transfer() gesendet wurde.
+* @param motor Index des Motors
+* @param target Ziel Position der Bewegung
+* @return Handle der Bewegung (> 0), Fehler: -1
+*/
+int gnublin_step_poller::watch(int motor, int target){
+	int handle;
+
+	if (motor < 0 || motor >= motor_count) {
+		ErrorMessage = "invalid motor\n";
+		error_flag = true;
+		return -1;
+	}
+	pthread_mutex_lock(&mutex);
+	handle = issue(motor, abs(target - motors[motor].position));
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return handle;
+}
+
+// registers a new move and wakes up the thread; the mutex must be held
+int gnublin_step_poller::issue(int motor, int distance){
+	motor_state *m = &motors[motor];
+
+	m->issued++;
+	m->next_poll = getMonotonicTime() + interval(motor, distance);
+	pthread_cond_signal(&work);
+	return m->issued * STEP_POLLER_MAX_MOTORS + motor;
+}
+
+// half of the expected remaining time, between the minimum and maximum interval
+unsigned long long gnublin_step_poller::interval(int motor, int remaining){
+	unsigned long long t;
+
+	if (motors[motor].velocity == 0)
+		return min_interval;
+	t = remaining * 500000ULL / motors[motor].velocity;
+	if (t < min_interval)
+		return min_interval;
+	if (t > max_interval)
+		return max_interval;
+	return t;
+}
+
+// 1: done, 0: running, -1: failed; the mutex must be held
+int gnublin_step_poller::check(int handle){
+	int motor = handle % STEP_POLLER_MAX_MOTORS;
+	unsigned int sequence = handle / STEP_POLLER_MAX_MOTORS;
+
+	if (handle <= 0 || motor >= motor_count || sequence > motors[motor].issued)
+		return -1;
+	if (sequence > motors[motor].completed)
+		return 0;
+	return motors[motor].result;
+}
+
+//-------------done-------------
+/** @~english
+* @brief Check if a move is completed.
+*
+* @param handle handle of the move
+* @return done: 1, running: 0, failure or invalid handle: -1
+*
+* @~german
+* @brief Prüft, ob eine Bewegung abgeschlossen ist.
+*
+* @param handle Handle der Bewegung
+* @return abgeschlossen: 1, läuft: 0, Fehler oder ungültiges Handle: -1
+*/
+int gnublin_step_poller::done(int handle){
+	int result;
+
+	pthread_mutex_lock(&mutex);
+	result = check(handle);
+	pthread_mutex_unlock(&mutex);
+	return result;
+}
+
+// absolute CLOCK_MONOTONIC time after timeout_ms, false for an unlimited timeout
+bool gnublin_step_poller::deadline(int timeout_ms, struct timespec *time){
+	if (timeout_ms < 0)
+		return false;
+	clock_gettime(CLOCK_MONOTONIC, time);
+	time->tv_sec += timeout_ms / 1000;
+	time->tv_nsec += (timeout_ms % 1000) * 1000000L;
+	if (time->tv_nsec >= 1000000000) {
+		time->tv_nsec -= 1000000000;
+		time->tv_sec++;
+	}
+	return true;
+}
+
+//-------------wait-------------
+/** @~english
+* @brief Wait until a move is completed.
+*
+* @param handle handle of the move
+* @param timeout_ms maximum time to wait in ms, -1 waits forever
+* @return done: 1, timeout: 0, failure or invalid handle: -1
+*
+* @~german
+* @brief Wartet, bis eine Bewegung abgeschlossen ist.
+*
+* @param handle Handle der Bewegung
+* @param timeout_ms maximale Wartezeit in ms, -1 wartet unbegrenzt
+* @return abgeschlossen: 1, Zeitüberschreitung: 0, Fehler oder ungültiges Handle: -1
+*/
+int gnublin_step_poller::wait(int handle, int timeout_ms){
+	return wait(&handle, 1, timeout_ms);
+}
+
+/** @~english
+* @brief Wait until several moves are completed.
+*
+* @param handles handles of the moves
+* @param count number of handles
+* @param timeout_ms maximum time to wait in ms, -1 waits forever
+* @return all done: 1, timeout: 0, a move failed or an invalid handle: -1
+*
+* @~german
+* @brief Wartet, bis mehrere Bewegungen abgeschlossen sind.
+*
+* @param handles Handles der Bewegungen
+* @param count Anzahl der Handles
+* @param timeout_ms maximale Wartezeit in ms, -1 wartet unbegrenzt
+* @return alle abgeschlossen: 1, Zeitüberschreitung: 0, eine Bewegung fehlgeschlagen oder ungültiges Handle: -1
+*/
+int gnublin_step_poller::wait(const int *handles, int count, int timeout_ms){
+	struct timespec time;
+	bool limited = deadline(timeout_ms, &time);
+	int result = 1;
+
+	pthread_mutex_lock(&mutex);
+	for (int i = 0; i < count; i++) {
+		while ((result = check(handles[i])) == 0) {
+			if (!limited)
+				pthread_cond_wait(&completion, &mutex);
+			else if (pthread_cond_timedwait(&completion, &mutex, &time) == ETIMEDOUT) {
+				result = check(handles[i]);
+				break;
+			}
+		}
+		if (result != 1)
+			break;
+	}
+	pthread_mutex_unlock(&mutex);
+	return result;
+}
+
+//-------------waitAll-------------
+/** @~english
+* @brief Wait until all motors stand still.
+*
+* @param timeout_ms maximum time to wait in ms, -1 waits forever
+* @return all done: 1, timeout: 0, a move failed: -1
+*
+* @~german
+* @brief Wartet, bis alle Motoren stehen.
+*
+* @param timeout_ms maximale Wartezeit in ms, -1 wartet unbegrenzt
+* @return alle abgeschlossen: 1, Zeitüberschreitung: 0, eine Bewegung fehlgeschlagen: -1
+*/
+int gnublin_step_poller::waitAll(int timeout_ms){
+	int handles[STEP_POLLER_MAX_MOTORS];
+	int count = 0;
+
+	pthread_mutex_lock(&mutex);
+	for (int i = 0; i < motor_count; i++) {
+		if (motors[i].issued)
+			handles[count++] = motors[i].issued * STEP_POLLER_MAX_MOTORS + i;
+	}
+	pthread_mutex_unlock(&mutex);
+	return wait(handles, count, timeout_ms);
+}
+
+//-------------getPosition-------------
+/** @~english
+* @brief Position of a motor at its last status read.
+*
+* @param motor index of the motor
+* @return position, 0 for an invalid motor
+*
+* @~german
+* @brief Position eines Motors beim letzten Status Lesezugriff.
+*
+* @param motor Index des Motors
+* @return Position, 0 bei ungültigem Motor
+*/
+int gnublin_step_poller::getPosition(int motor){
+	int position;
+
+	if (motor < 0 || motor >= motor_count)
+		return 0;
+	pthread_mutex_lock(&mutex);
+	position = motors[motor].position;
+	pthread_mutex_unlock(&mutex);
+	return position;
+}
+
+//-------------setEventQueue-------------
+/** @~english
+* @brief Deliver completed moves as events.
+*
+* Every completed move pushes an EVENT_MOTION_DONE event, device is the I2C address, source the index of the motor and value the position (or -1 for a failure).
+* @param queue the event queue, NULL: no events
+*
+* @~german
+* @brief Liefert abgeschlossene Bewegungen als Ereignisse.
+*
+* Jede abgeschlossene Bewegung erzeugt ein EVENT_MOTION_DONE Ereignis, device ist die I2C Adresse, source der Index des Motors und value die Position (oder -1 bei einem Fehler).
+* @param queue die Ereignis Warteschlange, NULL: keine Ereignisse
+*/
+void gnublin_step_poller::setEventQueue(gnublin_event_queue *queue){
+	pthread_mutex_lock(&mutex);
+	this->queue = queue;
+	pthread_mutex_unlock(&mutex);
+}
+
+//-------------setInterval-------------
+/** @~english
+* @brief Set the limits of the polling interval.
+*
+* @param min_ms shortest interval in ms (1-1000), default 2
+* @param max_ms longest interval in ms (min_ms-10000), default 100
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Grenzen des Abfrage Intervalls.
 *
-* @~german 
+* @param min_ms kürzestes Intervall in ms (1-1000), Standard 2
+* @param max_ms längstes Intervall in ms (min_ms-10000), Standard 100
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_poller::setInterval(int min_ms, int max_ms){
+	if (min_ms < 1 || min_ms > 1000 || max_ms < min_ms || max_ms > 10000) {
+		ErrorMessage = "invalid interval\n";
+		error_flag = true;
+		return -1;
+	}
+	pthread_mutex_lock(&mutex);
+	min_interval = min_ms * 1000ULL;
+	max_interval = max_ms * 1000ULL;
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return 1;
+}
+
+//-------------getPolls-------------
+/** @~english
+* @brief Number of status reads of the thread.
+*
+* @return number of status reads
+*
+* @~german
+* @brief Anzahl der Status Lesezugriffe des Threads.
+*
+* @return Anzahl der Status Lesezugriffe
+*/
+unsigned int gnublin_step_poller::getPolls(){
+	return polls;
+}
+
+// reads the status of a moving motor and completes its moves when it stands at the target; the mutex must be held
+bool gnublin_step_poller::poll(int motor, unsigned long long now, gnublin_event *event){
+	motor_state *m = &motors[motor];
+	gnublin_step_status status;
+
+	polls++;
+	if (m->motor->updateStatus(&status) < 0 || status.electrical_defect || status.thermal_shutdown) {
+		m->result = -1;
+	}
+	else {
+		m->position = status.position;
+		m->velocity = stepVelocity(status.vmax) * (2 << status.step_mode);
+		if (status.motion != 0 || status.position != status.target) {
+			m->next_poll = now + interval(motor, abs(status.target - status.position));
+			return false;
+		}
+		m->result = 1;
+	}
+	m->completed = m->issued;
+	pthread_cond_broadcast(&completion);
+	event->type = EVENT_MOTION_DONE;
+	event->device = m->motor->getAddress();
+	event->source = motor;
+	event->value = m->result < 0 ? -1 : m->position;
+	event->timestamp = now;
+	return true;
+}
+
+void *gnublin_step_poller::run(void *arg){
+	gnublin_step_poller *p = (gnublin_step_poller *)arg;
+	gnublin_event events[STEP_POLLER_MAX_MOTORS];
+
+	pthread_mutex_lock(&p->mutex);
+	while (p->run_flag) {
+		unsigned long long now = getMonotonicTime();
+		unsigned long long next = 0;
+		struct timespec time;
+		int count = 0;
+
+		for (int i = 0; i < p->motor_count; i++) {
+			motor_state *m = &p->motors[i];
+
+			if (m->completed == m->issued)
+				continue;
+			if (m->next_poll <= now && p->poll(i, now, &events[count]))
+				count++;
+			if (m->completed != m->issued && (next == 0 || m->next_poll < next))
+				next = m->next_poll;
+		}
+		// the callback of the queue may call the poller, so the events are pushed without the mutex
+		if (count && p->queue) {
+			gnublin_event_queue *queue = p->queue;
+
+			pthread_mutex_unlock(&p->mutex);
+			for (int i = 0; i < count; i++)
+				queue->push(events[i]);
+			pthread_mutex_lock(&p->mutex);
+			continue;
+		}
+		if (next == 0) {
+			pthread_cond_wait(&p->work, &p->mutex);
+			continue;
+		}
+		time.tv_sec = next / 1000000;
+		time.tv_nsec = (next % 1000000) * 1000;
+		pthread_cond_timedwait(&p->work, &p->mutex, &time);
+	}
+	pthread_mutex_unlock(&p->mutex);
+	return NULL;
+}
+
+//****************************************************************************
+// Class for homing GNUBLIN Module-steps at their end switch
+//****************************************************************************
+
+/** @~english
+* @brief Create a homing routine without axes.
+*
+* Defaults: fast Vmax 12, slow Vmax 2, back off 200 steps, travel 30000 steps.
+*
+* @~german
+* @brief Erzeugt eine Referenzfahrt ohne Achsen.
+*
+* Standardwerte: schnelles Vmax 12, langsames Vmax 2, Rückfahrt 200 Schritte, Fahrweg 30000 Schritte.
+*/
+gnublin_step_homing::gnublin_step_homing(){
+	axis_count = 0;
+	fast_vmax = 12;
+	slow_vmax = 2;
+	backoff = 200;
+	travel = 30000;
+	min_interval = STEP_HOMING_MIN_INTERVAL * 1000ULL;
+	max_interval = STEP_HOMING_MAX_INTERVAL * 1000ULL;
+	polls = 0;
+	cancelled = 0;
+	error_flag = false;
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_step_homing::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
 * @brief Gibt die letzte Error Nachricht zurück.
 *
 * Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
 * @return ErrorMessage als c-string
 */
-const char *gnublin_module_relay::getErrorMessage(){
+const char *gnublin_step_homing::getErrorMessage(){
 	return ErrorMessage.c_str();
 }
 
-//-------------------------------fail-------------------------------
-/** @~english 
-* @brief Returns the error flag. 
+//-------------addAxis-------------
+/** @~english
+* @brief Add an axis.
+*
+* @param motor the motor, it must be initialised (setMotorParam(), getFullStatus1(), runInit())
+* @param direction direction of the switch, 1: positive, -1: negative
+* @return index of the axis, failure: -1
+*
+* @~german
+* @brief Fügt eine Achse hinzu.
+*
+* @param motor der Motor, er muss initialisiert sein (setMotorParam(), getFullStatus1(), runInit())
+* @param direction Richtung des Schalters, 1: positiv, -1: negativ
+* @return Index der Achse, Fehler: -1
+*/
+int gnublin_step_homing::addAxis(gnublin_module_step *motor, int direction){
+	if (axis_count >= STEP_HOMING_MAX_AXES || (direction != 1 && direction != -1)) {
+		ErrorMessage = "too many axes or invalid direction\n";
+		error_flag = true;
+		return -1;
+	}
+	axes[axis_count].motor = motor;
+	axes[axis_count].direction = direction;
+	axes[axis_count].phase = HOMING_FAILED;
+	axes[axis_count].time = 0;
+	error_flag = false;
+	return axis_count++;
+}
+
+//-------------setVmax-------------
+/** @~english
+* @brief Set the velocities of the approaches.
+*
+* The Vmax of the motors is restored when they are homed.
+* @param fast Vmax of the fast approach (0-15)
+* @param slow Vmax of the slow approach (0-15), the switch position is as exact as the distance moved in the shortest interval
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Geschwindigkeiten der Anfahrten.
+*
+* Das Vmax der Motoren wird wiederhergestellt, wenn sie referenziert sind.
+* @param fast Vmax der schnellen Anfahrt (0-15)
+* @param slow Vmax der langsamen Anfahrt (0-15), die Schalter Position ist so genau wie die Strecke, die im kürzesten Abstand gefahren wird
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_homing::setVmax(unsigned int fast, unsigned int slow){
+	if (fast > 15 || slow > 15) {
+		ErrorMessage = "vmax is not between 0-15\n";
+		error_flag = true;
+		return -1;
+	}
+	fast_vmax = fast;
+	slow_vmax = slow;
+	error_flag = false;
+	return 1;
+}
+
+//-------------setBackoff-------------
+/** @~english
+* @brief Set the distance of the back off after the fast approach.
+*
+* It must be larger than the distance the motor needs to stop from the fast velocity.
+* @param steps distance in steps (1-2000), default 200
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Strecke der Rückfahrt nach der schnellen Anfahrt.
+*
+* Sie muss größer als der Bremsweg des Motors aus der schnellen Geschwindigkeit sein.
+* @param steps Strecke in Schritten (1-2000), Standard 200
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_homing::setBackoff(int steps){
+	if (steps < 1 || steps > 2000) {
+		ErrorMessage = "backoff is not between 1-2000\n";
+		error_flag = true;
+		return -1;
+	}
+	backoff = steps;
+	error_flag = false;
+	return 1;
+}
+
+//-------------setTravel-------------
+/** @~english
+* @brief Set the longest distance of the fast approach.
+*
+* An axis fails if its switch has not closed after this distance.
+* @param steps distance in steps (1-1000000), default 30000
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die längste Strecke der schnellen Anfahrt.
+*
+* Eine Achse schlägt fehl, wenn ihr Schalter nach dieser Strecke nicht geschlossen hat.
+* @param steps Strecke in Schritten (1-1000000), Standard 30000
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_homing::setTravel(int steps){
+	if (steps < 1 || steps > 1000000) {
+		ErrorMessage = "travel is not between 1-1000000\n";
+		error_flag = true;
+		return -1;
+	}
+	travel = steps;
+	error_flag = false;
+	return 1;
+}
+
+//-------------setInterval-------------
+/** @~english
+* @brief Set the limits of the polling interval.
+*
+* @param min_ms shortest interval in ms (1-1000), default 1
+* @param max_ms longest interval in ms (min_ms-10000), default 50
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Grenzen des Abfrage Intervalls.
+*
+* @param min_ms kürzestes Intervall in ms (1-1000), Standard 1
+* @param max_ms längstes Intervall in ms (min_ms-10000), Standard 50
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_homing::setInterval(int min_ms, int max_ms){
+	if (min_ms < 1 || min_ms > 1000 || max_ms < min_ms || max_ms > 10000) {
+		ErrorMessage = "invalid interval\n";
+		error_flag = true;
+		return -1;
+	}
+	min_interval = min_ms * 1000ULL;
+	max_interval = max_ms * 1000ULL;
+	error_flag = false;
+	return 1;
+}
+
+// half of the time the motor needs for the distance, between the minimum and maximum interval
+unsigned long long gnublin_step_homing::interval(unsigned int velocity, int distance){
+	unsigned long long t;
+
+	if (velocity == 0)
+		return min_interval;
+	t = distance * 500000ULL / velocity;
+	if (t < min_interval)
+		return min_interval;
+	if (t > max_interval)
+		return max_interval;
+	return t;
+}
+
+// stops the motor of a failed axis and remembers the message
+int gnublin_step_homing::failAxis(int axis, const std::string &message){
+	axes[axis].motor->softStop();
+	axes[axis].phase = HOMING_FAILED;
+	ErrorMessage = "axis " + numberToString(axis) + ": " + message + "\n";
+	return -1;
+}
+
+// starts the next chunk of the fast approach from position 0, so the target fits into the signed 16 bit position
+int gnublin_step_homing::approach(int axis){
+	homing_axis *a = &axes[axis];
+
+	a->chunk = travel - a->travelled < STEP_HOMING_CHUNK ? travel - a->travelled : STEP_HOMING_CHUNK;
+	if (a->motor->resetPosition() < 0 || a->motor->setPosition(a->direction * a->chunk) < 0)
+		return failAxis(axis, "starting the fast approach failed");
+	a->phase = HOMING_FAST;
+	return 1;
+}
+
+// remembers the Vmax and starts the fast approach, or the back off if the switch is already closed
+int gnublin_step_homing::begin(int axis, unsigned long long now){
+	homing_axis *a = &axes[axis];
+	gnublin_step_status status;
+
+	a->time = now;
+	a->next_poll = now;
+	a->travelled = 0;
+	polls++;
+	if (a->motor->updateStatus(&status) < 0)
+		return failAxis(axis, a->motor->getErrorMessage());
+	a->vmax = status.vmax;
+	if (a->motor->setVmax(fast_vmax) < 0 || a->motor->setMotorParam() < 0)
+		return failAxis(axis, "setting the fast vmax failed");
+	if (status.switch_closed) {
+		a->phase = HOMING_BACKOFF;
+		if (a->motor->resetPosition() < 0 || a->motor->setPosition(-a->direction * backoff) < 0)
+			return failAxis(axis, "starting the back off failed");
+		return 1;
+	}
+	return approach(axis);
+}
+
+// polls one axis and advances its phase
+int gnublin_step_homing::step(int axis, unsigned long long now){
+	homing_axis *a = &axes[axis];
+	gnublin_step_status status;
+	unsigned int velocity;
+	int remaining;
+	bool stopped;
+
+	polls++;
+	if (a->motor->updateStatus(&status) < 0)
+		return failAxis(axis, a->motor->getErrorMessage());
+	if (status.electrical_defect || status.thermal_shutdown)
+		return failAxis(axis, "electrical defect or thermal shutdown");
+	stopped = status.motion == 0 && status.position == status.target;
+	velocity = stepVelocity(status.vmax) * (2 << status.step_mode);
+	remaining = abs(status.target - status.position);
+
+	switch (a->phase) {
+		case HOMING_FAST:
+			if (status.switch_closed) {
+				// a soft stop would ramp down from the fast Vmax and overshoot the switch by more than the back off
+				if (a->motor->hardStop() < 0)
+					return failAxis(axis, "stopping failed");
+				a->phase = HOMING_FAST_STOP;
+			}
+			else if (stopped) {
+				a->travelled += a->chunk;
+				if (a->travelled >= travel)
+					return failAxis(axis, "switch not found");
+				if (approach(axis) < 0)
+					return -1;
+				remaining = a->chunk;
+			}
+			else {
+				// the motor must not move further than half the back off distance between two polls
+				a->next_poll = now + interval(velocity, remaining < backoff ? remaining : backoff);
+				return 1;
+			}
+			break;
+		case HOMING_FAST_STOP:
+			if (stopped) {
+				if (a->motor->setPosition(status.position - a->direction * backoff) < 0)
+					return failAxis(axis, "starting the back off failed");
+				a->phase = HOMING_BACKOFF;
+				remaining = backoff;
+			}
+			break;
+		case HOMING_BACKOFF:
+			if (stopped) {
+				if (status.switch_closed)
+					return failAxis(axis, "switch does not open");
+				if (a->motor->setVmax(slow_vmax) < 0 || a->motor->setMotorParam() < 0
+				    || a->motor->setPosition(status.position + a->direction * 2 * backoff) < 0)
+					return failAxis(axis, "starting the slow approach failed");
+				a->phase = HOMING_SLOW;
+				a->next_poll = now + min_interval;
+				return 1;
+			}
+			break;
+		case HOMING_SLOW:
+			if (status.switch_closed) {
+				if (a->motor->hardStop() < 0)
+					return failAxis(axis, "stopping failed");
+				a->phase = HOMING_SLOW_STOP;
+			}
+			else if (stopped)
+				return failAxis(axis, "switch not found");
+			else {
+				a->next_poll = now + min_interval;
+				return 1;
+			}
+			break;
+		case HOMING_SLOW_STOP:
+			if (stopped) {
+				if (a->motor->resetPosition() < 0)
+					return failAxis(axis, "resetting the position failed");
+				a->motor->setVmax(a->vmax);
+				if (a->motor->setMotorParam() < 0)
+					return failAxis(axis, "restoring the vmax failed");
+				a->time = now - a->time;
+				a->phase = HOMING_DONE;
+				return 1;
+			}
+			break;
+		default:
+			return 1;
+	}
+	a->next_poll = now + interval(velocity, remaining);
+	return 1;
+}
+
+//-------------run-------------
+/** @~english
+* @brief Home all axes and wait until they are done.
+*
+* If an axis fails, it is stopped and the other axes are homed anyway.
+* @param timeout_ms maximum time in ms, -1 waits forever; at the timeout all moving axes are stopped
+* @return all axes homed: 1, failure: -1 (the message names the failed axis)
+*
+* @~german
+* @brief Referenziert alle Achsen und wartet, bis sie fertig sind.
+*
+* Schlägt eine Achse fehl, wird sie angehalten und die anderen Achsen werden trotzdem referenziert.
+* @param timeout_ms maximale Zeit in ms, -1 wartet unbegrenzt; bei Zeitüberschreitung werden alle fahrenden Achsen angehalten
+* @return alle Achsen referenziert: 1, Fehler: -1 (die Meldung nennt die fehlgeschlagene Achse)
+*/
+int gnublin_step_homing::run(int timeout_ms){
+	unsigned long long start = getMonotonicTime();
+	unsigned long long end = start + timeout_ms * 1000ULL;
+	int result = 1;
+
+	polls = 0;
+	for (int i = 0; i < axis_count; i++) {
+		if (begin(i, start) < 0)
+			result = -1;
+	}
+	while (1) {
+		unsigned long long now = getMonotonicTime();
+		unsigned long long next = 0;
+
+		for (int i = 0; i < axis_count; i++) {
+			homing_axis *a = &axes[i];
+
+			if (a->phase == HOMING_DONE || a->phase == HOMING_FAILED)
+				continue;
+			if (cancelled) {
+				result = failAxis(i, "cancelled");
+				continue;
+			}
+			if (timeout_ms >= 0 && now >= end) {
+				result = failAxis(i, "timeout");
+				continue;
+			}
+			if (a->next_poll <= now && step(i, now) < 0) {
+				result = -1;
+				continue;
+			}
+			if (a->phase != HOMING_DONE && (next == 0 || a->next_poll < next))
+				next = a->next_poll;
+		}
+		if (next == 0)
+			break;
+		now = getMonotonicTime();
+		if (timeout_ms >= 0 && next > end)
+			next = end;
+		if (next > now)
+			usleep(next - now);
+	}
+	// the cancel is used up, the object can home again
+	cancelled = 0;
+	error_flag = result < 0;
+	return result;
+}
+
+//-------------cancel-------------
+/** @~english
+* @brief Cancel run().
+*
+* The running run(), or the next one if none is running, stops all axes which are not done yet and returns -1. Later calls of run() home again. Only a flag is set, so it may be called from a signal handler.
+*
+* @~german
+* @brief Bricht run() ab.
+*
+* Das laufende run(), oder das nächste, wenn keines läuft, hält alle noch nicht fertigen Achsen an und gibt -1 zurück. Spätere Aufrufe von run() referenzieren wieder. Es wird nur ein Flag gesetzt, die Funktion darf also aus einem Signal Handler aufgerufen werden.
+*/
+void gnublin_step_homing::cancel(){
+	cancelled = 1;
+}
+
+//-------------getTime-------------
+/** @~english
+* @brief Time an axis needed for homing in the last run().
+*
+* @param axis index of the axis
+* @return time in ms, -1 if the axis failed
+*
+* @~german
+* @brief Zeit, die eine Achse beim letzten run() für die Referenzfahrt gebraucht hat.
+*
+* @param axis Index der Achse
+* @return Zeit in ms, -1 wenn die Achse fehlgeschlagen ist
+*/
+int gnublin_step_homing::getTime(int axis){
+	if (axis < 0 || axis >= axis_count || axes[axis].phase != HOMING_DONE)
+		return -1;
+	return axes[axis].time / 1000;
+}
+
+//-------------getPolls-------------
+/** @~english
+* @brief Number of status reads in the last run().
+*
+* @return number of status reads
+*
+* @~german
+* @brief Anzahl der Status Lesezugriffe beim letzten run().
+*
+* @return Anzahl der Status Lesezugriffe
+*/
+unsigned int gnublin_step_homing::getPolls(){
+	return polls;
+}
+
+//****************************************************************************
+// Class for sending commands to several GNUBLIN Module-steps at once
+//****************************************************************************
+
+/** @~english
+* @brief Create an empty group.
+*
+* @~german
+* @brief Erzeugt eine leere Gruppe.
+*/
+gnublin_step_group::gnublin_step_group(){
+	motor_count = 0;
+	broadcast = false;
+	devicefile = "/dev/i2c-1";
+	latency = 0;
+	error_flag = false;
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
 *
 * If something went wrong, the flag is true.
 * @return bool error_flag
 *
-* @~german 
+* @~german
 * @brief Gibt das Error Flag zurück.
 *
 * Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
 * @return bool error_flag
 */
-bool gnublin_module_relay::fail(){
+bool gnublin_step_group::fail(){
 	return error_flag;
 }
 
-//-------------setAddress-------------
-/** @~english 
-* @brief Set the slave address 
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_step_group::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------addMotor-------------
+/** @~english
+* @brief Add a motor.
+*
+* @param motor the motor
+* @return index of the motor, failure: -1
+*
+* @~german
+* @brief Fügt einen Motor hinzu.
+*
+* @param motor der Motor
+* @return Index des Motors, Fehler: -1
+*/
+int gnublin_step_group::addMotor(gnublin_module_step *motor){
+	if (motor_count >= STEP_GROUP_MAX_MOTORS) {
+		ErrorMessage = "too many motors\n";
+		error_flag = true;
+		return -1;
+	}
+	motors[motor_count] = motor;
+	error_flag = false;
+	return motor_count++;
+}
+
+//-------------setBroadcast-------------
+/** @~english
+* @brief Send the commands to the general call address.
 *
-* With this function you can set the individual I2C Slave-Address of the module.
-* @param Address new I2C slave Address
+* One frame reaches all TMC222 on the bus at the same time. setMotorParam() then sends the parameters of the first motor to all motors.
+* @param broadcast true: general call, false: one frame per motor (default)
 *
-* @~german 
-* @brief Setzt Slave Adresse.
+* @~german
+* @brief Sendet die Befehle an die General Call Adresse.
 *
-* Mit dieser Funktion kann die individuelle I2C Slave-Adresse des Moduls gesetzt werden.
-* @param Address neue I2C slave Adresse
+* Ein Rahmen erreicht alle TMC222 am Bus gleichzeitig. setMotorParam() sendet dann die Parameter des ersten Motors an alle Motoren.
+* @param broadcast true: General Call, false: ein Rahmen pro Motor (Standard)
 */
-void gnublin_module_relay::setAddress(int Address){
-	pca9555.setAddress(Address);
+void gnublin_step_group::setBroadcast(bool broadcast){
+	this->broadcast = broadcast;
 }
 
-
 //-------------setDevicefile-------------
-/** @~english 
-* @brief Set devicefile.
+/** @~english
+* @brief Set the I2C device file of the bus for emergencyStop().
 *
-* With this function you can change the I2C device file. Default is "/dev/i2c-1"
+* The other commands use the bus of the first motor. Default is "/dev/i2c-1".
 * @param filename path to the I2C device file
 *
-* @~german 
-* @brief Setzt Device Datei.
+* @~german
+* @brief Setzt die I2C Gerätedatei des Busses für emergencyStop().
 *
-* Mit dieser Funktion kann die I2C Gerätedatei geändert werden. Standartmäßig wird "/dev/i2c-1" benutzt.
+* Die anderen Befehle benutzen den Bus des ersten Motors. Standardmäßig wird "/dev/i2c-1" benutzt.
 * @param filename Pfad zur I2C Gerätedatei
 */
-void gnublin_module_relay::setDevicefile(std::string filename){
-	pca9555.setDevicefile(filename);
+void gnublin_step_group::setDevicefile(std::string filename){
+	devicefile = filename;
 }
 
-//-------------------switch Pin----------------
-/** @~english 
-* @brief Switch pin.
-*
-* This function sets the given relay to the given value.
-* @param pin Number of the relay to switch (1-8)
-* @param value close (1) or open (0) the relay (ON, OFF)
-* @return success: 1, failure: -1
-*
-* @~german 
-* @brief Schalte Pin.
-*
-* Schalten der einzelnen Relays. 
-* @param pin Nummer des anzusteuernden Relays (1-8)
-* @param value schließen (1) oder öffnen (0) des Relays (ON, OFF)
-* @return Erfolg: 1, Fehler: -1
-*/
-int gnublin_module_relay::switchPin(int pin, int value) {
-	error_flag=false;
+// sends frames of the given length (one per motor, or the first one as general call) in one transaction
+int gnublin_step_group::send(unsigned char *frames, int length){
+	struct i2c_msg msgs[STEP_GROUP_MAX_MOTORS];
+	unsigned long long start = getMonotonicTime();
+	int count = broadcast ? 1 : motor_count;
 
-	if (pin < 1 || pin > 8) {
-		error_flag=true;
-		ErrorMessage="pin is not between 1-8!\n";
+	if (motor_count == 0) {
+		ErrorMessage = "no motors\n";
+		error_flag = true;
 		return -1;
 	}
-	if (pca9555.pinMode((pin-1), OUTPUT) < 0){
-		error_flag=true;
-		ErrorMessage=pca9555.getErrorMessage(); //"pca9555.pinMode failed! Address correct?\n";
-		return -1;
+	for (int i = 0; i < count; i++) {
+		msgs[i].addr = broadcast ? 0 : motors[i]->getAddress();
+		msgs[i].flags = 0;
+		msgs[i].len = length;
+		msgs[i].buf = &frames[i * length];
 	}
-	if (pca9555.digitalWrite((pin-1), value) < 0) {
-		error_flag=true;
-		ErrorMessage="pca9555.digitalWrite failed! Address correct?\n";		
+	if (motors[0]->transfer(msgs, count) < 0) {
+		latency = getMonotonicTime() - start;
+		ErrorMessage = motors[0]->getErrorMessage();
+		error_flag = true;
 		return -1;
 	}
+	latency = getMonotonicTime() - start;
+	for (int i = 1; i < motor_count; i++)
+		motors[i]->discardStatus();
+	error_flag = false;
 	return 1;
 }
 
+//-------------hardStop-------------
+/** @~english
+* @brief Stop all motors immediately.
+*
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Hält alle Motoren sofort an.
+*
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_group::hardStop(){
+	unsigned char frames[STEP_GROUP_MAX_MOTORS];
 
+	memset(frames, 0x85, sizeof(frames));	// HardStop
+	return send(frames, 1);
+}
 
-//*******************************************************************
-//Class for accessing GNUBLIN Module-step
-//*******************************************************************
-
-//-------------gnublin_module_step-------------
-/** @~english 
-* @brief Set irun and vmax to the default values (irun = 15, vmax = 8).
+//-------------emergencyStop-------------
+/** @~english
+* @brief Stop all motors immediately, from a signal handler.
 *
-* @~german 
-* @brief Setzt die Standartwerte für irun und vmax (irun = 15, vmax = 8).
+* Like hardStop(), but the frames go straight to a new file descriptor of the bus (see setDevicefile()) without the locks of the motors, so it may be called from a signal handler while another command of the motors is running.
+* It neither sets the error state nor the latency and does not discard the status snapshots of the motors.
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Hält alle Motoren sofort an, aus einem Signal Handler.
 *
+* Wie hardStop(), aber die Rahmen gehen ohne die Sperren der Motoren direkt an einen neuen Dateideskriptor des Busses (siehe setDevicefile()), die Funktion darf also aus einem Signal Handler aufgerufen werden, während ein anderer Befehl der Motoren läuft.
+* Sie setzt weder den Fehlerzustand noch die Latenz und verwirft die Status Momentaufnahmen der Motoren nicht.
+* @return Erfolg: 1, Fehler: -1
 */
-gnublin_module_step::gnublin_module_step()
-{
-	irun = 15;
-	vmax = 8;
+int gnublin_step_group::emergencyStop(){
+	unsigned char frame = 0x85;	// HardStop
+	struct i2c_msg msgs[STEP_GROUP_MAX_MOTORS];
+	struct i2c_rdwr_ioctl_data data;
+	int count = broadcast ? 1 : motor_count;
+	int fd, result;
+
+	if (motor_count == 0)
+		return -1;
+	for (int i = 0; i < count; i++) {
+		msgs[i].addr = broadcast ? 0 : motors[i]->getAddress();
+		msgs[i].flags = 0;
+		msgs[i].len = 1;
+		msgs[i].buf = &frame;
+	}
+	data.msgs = msgs;
+	data.nmsgs = count;
+	// only async signal safe calls from here on
+	fd = open(devicefile.c_str(), O_RDWR);
+	if (fd < 0)
+		return -1;
+	result = ioctl(fd, I2C_RDWR, &data) == count ? 1 : -1;
+	close(fd);
+	return result;
 }
 
-//-------------getErrorMessage-------------
-/** @~english 
-* @brief Get the last Error Message.
+//-------------softStop-------------
+/** @~english
+* @brief Slow down and stop all motors.
 *
-* This Funktion returns the last Error Message, which occurred in that Class.
-* @return ErrorMessage as c-string
+* @return success: 1, failure: -1
 *
-* @~german 
-* @brief Gibt die letzte Error Nachricht zurück.
+* @~german
+* @brief Bremst alle Motoren ab und hält sie an.
 *
-* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
-* @return ErrorMessage als c-string
+* @return Erfolg: 1, Fehler: -1
 */
-const char *gnublin_module_step::getErrorMessage(){
-	return ErrorMessage.c_str();
+int gnublin_step_group::softStop(){
+	unsigned char frames[STEP_GROUP_MAX_MOTORS];
+
+	memset(frames, 0x8f, sizeof(frames));	// SoftStop
+	return send(frames, 1);
 }
 
-//-------------setAddress-------------
-/** @~english 
-* @brief Set the slave address 
+//-------------setMotorParam-------------
+/** @~english
+* @brief Send the motor parameters of all motors.
 *
-* With this function you can set the individual I2C Slave-Address of the module.
-* @param Address new I2C slave Address
+* Every motor gets the parameters set with its own setIrun(), setVmax(), ...
+* @return success: 1, failure: -1
 *
-* @~german 
-* @brief Setzt Slave Adresse.
+* @~german
+* @brief Sendet die Motor Parameter aller Motoren.
 *
-* Mit dieser Funktion kann die individuelle I2C Slave-Adresse des Moduls gesetzt werden.
-* @param Address neue I2C slave Adresse
+* Jeder Motor bekommt die Parameter, die mit seinem eigenen setIrun(), setVmax(), ... eingestellt wurden.
+* @return Erfolg: 1, Fehler: -1
 */
-void gnublin_module_step::setAddress(int Address){
-	i2c.setAddress(Address);
+int gnublin_step_group::setMotorParam(){
+	unsigned char frames[STEP_GROUP_MAX_MOTORS * 8];
+
+	for (int i = 0; i < motor_count; i++)
+		motors[i]->buildSetMotorParam(&frames[i * 8]);
+	return send(frames, 8);
 }
 
-//-------------setDevicefile-------------
-/** @~english 
-* @brief Set devicefile.
+//-------------getLatency-------------
+/** @~english
+* @brief Duration of the last command from the call until the transaction was done.
 *
-* With this function you can change the I2C device file. Default is "/dev/i2c-1"
-* @param filename path to the I2C device file
+* This is the worst case latency: the last motor got its command at the latest at this time after the call.
+* @return time in µs
 *
-* @~german 
-* @brief Setzt Device Datei.
+* @~german
+* @brief Dauer des letzten Befehls vom Aufruf bis die Transaktion fertig war.
 *
-* Mit dieser Funktion kann die I2C Gerätedatei geändert werden. Standartmäßig wird "/dev/i2c-1" benutzt.
-* @param filename Pfad zur I2C Gerätedatei
+* Das ist die Latenz im ungünstigsten Fall: der letzte Motor hat seinen Befehl spätestens nach dieser Zeit bekommen.
+* @return Zeit in µs
 */
-void gnublin_module_step::setDevicefile(std::string filename){
-	i2c.setDevicefile(filename);
+unsigned long long gnublin_step_group::getLatency(){
+	return latency;
 }
 
-//-------------setIrun-------------
-/** @~english 
-* @brief Set Irun.
-*
-* This Funktion sets the new Irun value.
-* @param newIrun values from 0 to 15 are possible
-* @return success: 1, failure: -1
+//****************************************************************************
+// Class for coordinated moves of several GNUBLIN Module-steps
+//****************************************************************************
+
+/** @~english
+* @brief Create a planner without axes, Vmax is 8.
 *
-* @~german 
-* @brief Setze Irun.
+* @~german
+* @brief Erzeugt einen Planer ohne Achsen, Vmax ist 8.
+*/
+gnublin_step_planner::gnublin_step_planner(){
+	pthread_condattr_t attr;
+
+	axis_count = 0;
+	vmax = 8;
+	first = 0;
+	count = 0;
+	busy = false;
+	segments = 0;
+	errors = 0;
+	thread_started = false;
+	run_flag = false;
+	error_flag = false;
+	pthread_mutex_init(&mutex, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&work, &attr);
+	pthread_cond_init(&space, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+/** @~english
+* @brief Waits until the sent segment is done, queued segments are discarded.
 *
-* Diese Funktion setzt den neuen Irun Wert
-* @param newIrun Werte von 0 bis 15
-* @return Erfolg: 1, Fehler: -1
+* @~german
+* @brief Wartet, bis das gesendete Segment fertig ist, eingereihte Segmente werden verworfen.
 */
-int gnublin_module_step::setIrun(unsigned int newIrun){
-	if(newIrun <= 15){
-		irun=newIrun;
-		return 1;
+gnublin_step_planner::~gnublin_step_planner(){
+	if (thread_started) {
+		pthread_mutex_lock(&mutex);
+		run_flag = false;
+		count = 0;
+		pthread_cond_broadcast(&work);
+		pthread_mutex_unlock(&mutex);
+		pthread_join(thread, NULL);
 	}
-	else return -1;
+	pthread_cond_destroy(&work);
+	pthread_cond_destroy(&space);
+	pthread_mutex_destroy(&mutex);
 }
 
-//-------------setIhold-------------
-/** @~english 
-* @brief Set Ihold.
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
 *
-* This Funktion sets the new Ihold value.
-* @param newIhold values from 0 to 15 are possible
-* @return success: 1, failure: -1
+* If something went wrong, the flag is true.
+* @return bool error_flag
 *
-* @~german 
-* @brief Setze Ihold
+* @~german
+* @brief Gibt das Error Flag zurück.
 *
-* Diese Funktion setzt den neuen Ihold Wert
-* @param newIhold Werte von 0 bis 15
-* @return Erfolg: 1, Fehler: -1
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
 */
-int gnublin_module_step::setIhold(unsigned int newIhold){
-	if(newIhold <= 15){
-		ihold=newIhold;
-		return 1;
-	}
-	else return -1;
+bool gnublin_step_planner::fail(){
+	return error_flag;
 }
 
-//-------------setVmax-------------
-/** @~english 
-* @brief Set Vmax.
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
 *
-* This Funktion sets the new Vmax value.
-* @param newVmax values from 0 to 15 are possible
-* @return success: 1, failure: -1
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
 *
-* @~german 
-* @brief Setze Vmax
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
 *
-* Diese Funktion setzt den neuen Vmax Wert
-* @param newVmax Werte von 0 bis 15
-* @return Erfolg: 1, Fehler: -1
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
 */
-int gnublin_module_step::setVmax(unsigned int newVmax){
-	if(newVmax <= 15){
-		vmax=newVmax;
-		return 1;
-	}
-	else return -1;
+const char *gnublin_step_planner::getErrorMessage(){
+	return ErrorMessage.c_str();
 }
 
-//-------------setVmin-------------
-/** @~english 
-* @brief Set Vmin.
+//-------------addAxis-------------
+/** @~english
+* @brief Add an axis.
 *
-* This Funktion sets the new Vmin value.
-* @param newVmin values from 0 to 15 are possible
-* @return success: 1, failure: -1
+* The actual position of the motor is read, all axes must be added before the first move.
+* @param motor the motor, it must be initialised (setMotorParam(), runInit())
+* @return index of the axis, failure: -1
 *
-* @~german 
-* @brief Setze Vmin
+* @~german
+* @brief Fügt eine Achse hinzu.
 *
-* Diese Funktion setzt den neuen Vmin Wert
-* @param newVmin Werte von 0 bis 15
-* @return Erfolg: 1, Fehler: -1
+* Die aktuelle Position des Motors wird gelesen, alle Achsen müssen vor der ersten Bewegung hinzugefügt werden.
+* @param motor der Motor, er muss initialisiert sein (setMotorParam(), runInit())
+* @return Index der Achse, Fehler: -1
 */
-int gnublin_module_step::setVmin(unsigned int newVmin){
-	if(newVmin <= 15){
-		vmin=newVmin;
-		return 1;
+int gnublin_step_planner::addAxis(gnublin_module_step *motor){
+	gnublin_step_status status;
+	int axis;
+
+	pthread_mutex_lock(&mutex);
+	if (axis_count >= STEP_PLANNER_MAX_AXES || count || busy) {
+		pthread_mutex_unlock(&mutex);
+		ErrorMessage = "too many axes or planner is moving\n";
+		error_flag = true;
+		return -1;
 	}
-	else return -1;
+	if (motor->updateStatus(&status) < 0) {
+		pthread_mutex_unlock(&mutex);
+		ErrorMessage = motor->getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
+	if (poller.addMotor(motor) < 0) {
+		pthread_mutex_unlock(&mutex);
+		ErrorMessage = poller.getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
+	axis = axis_count;
+	axes[axis] = motor;
+	planned[axis] = status.position;
+	current[axis] = status.position;
+	sent_vmax[axis] = -1;
+	axis_count++;
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return axis;
 }
 
-//-------------writeTMC-------------
-/** @~english 
-* @brief Write to TMC.
+//-------------setVmax-------------
+/** @~english
+* @brief Set the velocity of the longest axis.
 *
-* This funktion sends the amount of bytes (num) of the char array TxBuf to the TMC222 chip on the module-step.
-* @param TxBuf Send buffer
-* @param num amount of Bytes
+* Applies to the segments which are queued afterwards.
+* @param vmax Vmax of the TMC222 (0-15)
 * @return success: 1, failure: -1
 *
-* @~german 
-* @brief Sende an TMC.
+* @~german
+* @brief Setzt die Geschwindigkeit der längsten Achse.
 *
-* Diese Funktion sendet die Menge (num) an Bytes des Char Array TxBuf an den TMC222 Chip, welcher sich auf dem Moudule-step befindet.
-* @param TxBuf Sende Puffer
-* @param num Anzahl der zu sendenden Bytes
+* Gilt für die danach eingereihten Segmente.
+* @param vmax Vmax des TMC222 (0-15)
 * @return Erfolg: 1, Fehler: -1
-*/
-int gnublin_module_step::writeTMC(unsigned char *TxBuf, int num){
-	if(!i2c.send(TxBuf, num)){
-	    return -1;
-   	}
-	else return 1;
+*/
+int gnublin_step_planner::setVmax(unsigned int vmax){
+	if (vmax > 15) {
+		ErrorMessage = "vmax is not between 0-15\n";
+		error_flag = true;
+		return -1;
+	}
+	pthread_mutex_lock(&mutex);
+	this->vmax = vmax;
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return 1;
 }
 
-//-------------readTMC-------------
-/** @~english 
-* @brief Read from TMC.
+//-------------move-------------
+/** @~english
+* @brief Queue a linear move to absolute positions.
 *
-* This funktion reads the amount of bytes (num) of the TMC222 chip on the module-step and write it to the char array RxBuf.
-* @param RxBuf Receive buffer
-* @param num amount of Bytes
+* Blocks while the queue is full (32 segments).
+* @param targets target position of every axis, in the order the axes were added
 * @return success: 1, failure: -1
 *
-* @~german 
-* @brief Sende an TMC.
+* @~german
+* @brief Reiht eine lineare Bewegung zu absoluten Positionen ein.
 *
-* Diese Funktion ließt die Menge (num) an Bytes vom TMC222 Chip, welcher sich auf dem Moudule-step befindet und übergibt das Ergebnis im Char Array RxBuf.
-* @param RxBuf Empfangs Puffer
-* @param num Anzahl der zu lesenden Bytes
+* Blockiert, solange die Warteschlange voll ist (32 Segmente).
+* @param targets Ziel Position jeder Achse, in der Reihenfolge, in der die Achsen hinzugefügt wurden
 * @return Erfolg: 1, Fehler: -1
 */
-int gnublin_module_step::readTMC(unsigned char *RxBuf, int num){
-   	if(!i2c.receive(RxBuf, num)){
-       	return -1;
-    }
-	else return 1;	
+int gnublin_step_planner::move(const int *targets){
+	segment next;
+
+	for (int i = 0; i < axis_count; i++)
+		next.target[i] = targets[i];
+	return push(next);
 }
 
-//-------------burnNewAddress-------------
-/** @~english 
-* @brief Burn a new I2C slave Address.
+//-------------moveRelative-------------
+/** @~english
+* @brief Queue a linear move relative to the end of the queued moves.
 *
-* This function calculates the needet bits to burn on the TMC222 chip, to get the new given slave-address. After that, the OTP bits are burned into the Chip.
-* @param new_address the new slave address
+* @param steps steps of every axis, in the order the axes were added
 * @return success: 1, failure: -1
 *
-* @~german 
-* @brief Brennt die übergebene slave Adresse.
+* @~german
+* @brief Reiht eine lineare Bewegung relativ zum Ende der eingereihten Bewegungen ein.
 *
-* Diese Funktion berechnet die benötigten Bits, um die neue Adresse auf den Chip zu brennen. Anschließend werden die OTP bits gebrannt.
-* Achtung: Sind die Bits einmal gesetzt, kann dies nicht wieder rückgängig gemacht werden. Falls eine Adresse eingegeben wird, die nicht möglich ist, wird dies von der Funktion gemeldet.
-* 
-* @param new_address die neue Slave Adresse
+* @param steps Schritte jeder Achse, in der Reihenfolge, in der die Achsen hinzugefügt wurden
 * @return Erfolg: 1, Fehler: -1
 */
-int gnublin_module_step::burnNewAddress(int new_address){
-	
-	//SetOTPParam
-	unsigned char buffer[5];
-	int new_ad = 0;
-	int old_ad = 0;
-	int slave_address=i2c.getAddress();
-	std::string yes = "NO!";
-
- 	if(new_address <= slave_address){
-		printf("\tThe new address must be higher than the old one (0x%x)!\n",slave_address);
-		return -1;
- 	}
- 	else if (new_address > 0x7f){
-		printf("The biggest slave address of the TMC222 is 0x7f\n");
-		return -1;
- 	}
- 	else{
-  		old_ad = (slave_address & 0x1e) >> 1;
-  		new_ad = (new_address & 0x1e) >> 1;
-  		if(((new_ad & 0x1)<(old_ad & 0x1))|((new_ad & 0x2)<(old_ad & 0x2))|((new_ad & 0x4)<(old_ad & 0x4))|((new_ad & 0x8)<(old_ad & 0x8))){
-        		printf("\tThis address could not be set, because the '1' cant be undone!\n"
-        			"\told OTP AD: 0x%x\n"
-        			"\tnew OTP AD: 0x%x\n",old_ad, new_ad);
-        		return -1;
-  		}
-	  	if((new_address & 0x01) == 1){
-			printf("\tThe LSB address bit is set by the jumper on the module-step\n");
-			new_address --;
-			printf("\tThe new address will be set to: 0x%x \n", new_address);
-	  	}
+int gnublin_step_planner::moveRelative(const int *steps){
+	segment next;
 
-	    	printf("\tIf a bit of the OTP (on time programmable) is set, it cant be undone! \n\t"
-	    		"If you are sure to write the new Address (0x%x) then type 'yes' in CAPITALS\n\n\t", new_address);
-	    	std::cin >> yes;
-	    	if(yes == "YES"){
-			buffer[0] = 0x90; //SetOTPParam
-			buffer[1] = 0xff; //N/A
-			buffer[2] = 0xff; //N/A
-			buffer[3] = 0x02; //set AD3 AD2 AD1 AD0
-			buffer[4] = (unsigned char) new_ad;
+	pthread_mutex_lock(&mutex);
+	for (int i = 0; i < axis_count; i++)
+		next.target[i] = planned[i] + steps[i];
+	pthread_mutex_unlock(&mutex);
+	return push(next);
+}
 
-		   	if(!i2c.send(buffer, 5)){
-			   	return -1;
-			}
-			else {
-				printf("\tNew Address was successfully set to: 0x%x\n\tPlease replug the module.\n\n", new_address);
-				return 1;
-			}
-	    	}
-	  	else{
-			printf("\tYou didn't type 'YES'\n");
+int gnublin_step_planner::push(const segment &next){
+	if (axis_count == 0) {
+		ErrorMessage = "no axis\n";
+		error_flag = true;
+		return -1;
+	}
+	for (int i = 0; i < axis_count; i++) {
+		if (next.target[i] < -32768 || next.target[i] > 32767) {
+			ErrorMessage = "position is not between -32768 and 32767\n";
+			error_flag = true;
 			return -1;
-	  	}
+		}
 	}
+	pthread_mutex_lock(&mutex);
+	if (!thread_started) {
+		run_flag = true;
+		if (pthread_create(&thread, NULL, run, this) != 0) {
+			run_flag = false;
+			pthread_mutex_unlock(&mutex);
+			ErrorMessage = "pthread_create failed\n";
+			error_flag = true;
+			return -1;
+		}
+		thread_started = true;
+	}
+	while (count == STEP_PLANNER_QUEUE)
+		pthread_cond_wait(&space, &mutex);
+	queue[(first + count) % STEP_PLANNER_QUEUE] = next;
+	queue[(first + count) % STEP_PLANNER_QUEUE].vmax = vmax;
+	count++;
+	for (int i = 0; i < axis_count; i++)
+		planned[i] = next.target[i];
+	pthread_cond_signal(&work);
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return 1;
 }
 
-//-------------getFullStatus-------------
-/** @~english 
-* @brief Get full Status 1.
+//-------------wait-------------
+/** @~english
+* @brief Wait until all queued segments are done.
 *
-* This funktion sends the getFullStatus1 Command to the Chip.
-* @return success: 1, failure: -1
+* @param timeout_ms maximum time to wait in ms, -1 waits forever
+* @return done: 1, timeout: 0, a segment failed: -1 (see getErrorMessage())
 *
-* @~german 
-* @brief Get full Status 1.
+* @~german
+* @brief Wartet, bis alle eingereihten Segmente fertig sind.
 *
-* Diese Funktion sendet den getFullStatus1 Befehl an den Chip.
-* @return Erfolg: 1, Fehler: -1
+* @param timeout_ms maximale Wartezeit in ms, -1 wartet unbegrenzt
+* @return fertig: 1, Zeitüberschreitung: 0, ein Segment ist fehlgeschlagen: -1 (siehe getErrorMessage())
 */
-int gnublin_module_step::getFullStatus1(){
-      	if(i2c.send(0x81)){
-		return 1;		
+int gnublin_step_planner::wait(int timeout_ms){
+	struct timespec deadline;
+	int result = 1;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += timeout_ms / 1000;
+	deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000) {
+		deadline.tv_nsec -= 1000000000;
+		deadline.tv_sec++;
+	}
+	pthread_mutex_lock(&mutex);
+	while (count || busy) {
+		if (timeout_ms < 0)
+			pthread_cond_wait(&space, &mutex);
+		else if (pthread_cond_timedwait(&space, &mutex, &deadline) == ETIMEDOUT)
+			break;
+	}
+	if (count || busy)
+		result = 0;
+	if (!thread_error.empty()) {
+		ErrorMessage = thread_error;
+		thread_error.clear();
+		error_flag = true;
+		pthread_mutex_unlock(&mutex);
+		return -1;
 	}
-	else return -1;
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return result;
 }
 
-//-------------getFullStatus2-------------
-/** @~english 
-* @brief Get full Status 2.
+//-------------pending-------------
+/** @~english
+* @brief Number of segments which are queued or running.
 *
-* This funktion sends the getFullStatus2 Command to the Chip.
-* @return success: 1, failure: -1
+* @return number of segments
 *
-* @~german 
-* @brief Get full Status 2.
+* @~german
+* @brief Anzahl der eingereihten oder laufenden Segmente.
 *
-* Diese Funktion sendet den getFullStatus2 Befehl an den Chip.
-* @return Erfolg: 1, Fehler: -1
+* @return Anzahl der Segmente
 */
-int gnublin_module_step::getFullStatus2(){
-	if(i2c.send(0xfc)){
-		return 1;
-	}
-	else return -1;
+int gnublin_step_planner::pending(){
+	int n;
+
+	pthread_mutex_lock(&mutex);
+	n = count + (busy ? 1 : 0);
+	pthread_mutex_unlock(&mutex);
+	return n;
 }
 
-//-------------runInit-------------
-/** @~english 
-* @brief Run Init.
+//-------------getPosition-------------
+/** @~english
+* @brief Position of an axis at the end of the queued segments.
 *
-* This funktion sends the runInit Command to the Chip.
-* @return success: 1, failure: -1
+* @param axis index of the axis
+* @return position, 0 for an invalid axis
 *
-* @~german 
-* @brief Run Init.
+* @~german
+* @brief Position einer Achse am Ende der eingereihten Segmente.
 *
-* Diese Funktion sendet den runInit Befehl an den Chip.
-* @return Erfolg: 1, Fehler: -1
+* @param axis Index der Achse
+* @return Position, 0 bei ungültiger Achse
 */
-int gnublin_module_step::runInit(){
-		if(i2c.send(0x88)){
-		return 1;
-		}
-		else return -1;
+int gnublin_step_planner::getPosition(int axis){
+	int position;
+
+	if (axis < 0 || axis >= axis_count)
+		return 0;
+	pthread_mutex_lock(&mutex);
+	position = planned[axis];
+	pthread_mutex_unlock(&mutex);
+	return position;
 }
 
-//-------------setMotorParam-------------
-/** @~english 
-* @brief Set motor parameter.
+//-------------getSegments-------------
+/** @~english
+* @brief Number of finished segments.
 *
-* This function sends the motor parameter to the module.
-* @return success: 1, failure: -1
+* @return number of segments
 *
-* @~german 
-* @brief Setze Motor Parameter.
+* @~german
+* @brief Anzahl der fertigen Segmente.
 *
-* Diese Funktion sendet die eingestellten Motor Parameter an das Modul.
-* @return Erfolg: 1, Fehler: -1
+* @return Anzahl der Segmente
 */
-int gnublin_module_step::setMotorParam(){
-	unsigned char buffer[8];
-	//SetMotorParam
-	buffer[0] = 0x89; //SetMotorParam
-	buffer[1] = 0xff; //N/A
-	buffer[2] = 0xff; //N/A
-	buffer[3] = (unsigned char) ((irun * 0x10) + ihold); //Irun & I hold
-	buffer[4] = (unsigned char) ((vmax * 0x10) + vmin); //Vmax & Vmin 
-	buffer[5] = 0x00; //status
-	buffer[6] = 0x00; //securePos
-	buffer[7] = 0x00; //StepMode
-
-    if(i2c.send(buffer, 8)){
-	return 1;
-	}
-	else return -1;
+unsigned int gnublin_step_planner::getSegments(){
+	return segments;
 }
 
-//-------------setMotorParam-------------
-/** @~english 
-* @brief Set motor parameter.
+//-------------getErrors-------------
+/** @~english
+* @brief Number of failed segments.
 *
-* This function sends the motor parameter to the module.
-* @param newIrun
-* @param newIhold
-* @param newVmax
-* @param newVmin
-* @return success: 1, failure: -1
+* @return number of segments
 *
-* @~german 
-* @brief Setze Motor Parameter.
+* @~german
+* @brief Anzahl der fehlgeschlagenen Segmente.
 *
-* Diese Funktion sendet die übergebenen Motor Parameter an das Modul.
-* @param newIrun
-* @param newIhold
-* @param newVmax
-* @param newVmin
-* @return Erfolg: 1, Fehler: -1
+* @return Anzahl der Segmente
 */
-int gnublin_module_step::setMotorParam(unsigned int newIrun, unsigned int newIhold, unsigned int newVmax, unsigned int newVmin){
-	irun=newIrun;
-	ihold=newIhold;
-	vmax=newVmax;
-	vmin=newVmin;
+unsigned int gnublin_step_planner::getErrors(){
+	return errors;
+}
 
-	unsigned char buffer[8];
-	//SetMotorParam
-	buffer[0] = 0x89; //SetMotorParam
-	buffer[1] = 0xff; //N/A
-	buffer[2] = 0xff; //N/A
-	buffer[3] = (unsigned char) ((irun * 0x10) + ihold); //Irun & I hold
-	buffer[4] = (unsigned char) ((vmax * 0x10) + vmin); //Vmax & Vmin 
-	buffer[5] = 0x00; //status
-	buffer[6] = 0x00; //securePos
-	buffer[7] = 0x00; //StepMode
+// sends the motor parameters and positions of one segment in one transfer, returns the number of moving axes
+int gnublin_step_planner::dispatch(const segment &next, int *handles){
+	struct i2c_msg msgs[2 * STEP_PLANNER_MAX_AXES];
+	unsigned char params[STEP_PLANNER_MAX_AXES][8];
+	unsigned char positions[STEP_PLANNER_MAX_AXES][5];
+	int distance[STEP_PLANNER_MAX_AXES];
+	int longest = 0, velocity = stepVelocity(next.vmax);
+	int n = 0, moving = 0;
 
-    if(i2c.send(buffer, 8)){
-	return 1;
+	for (int i = 0; i < axis_count; i++) {
+		distance[i] = abs(next.target[i] - current[i]);
+		if (distance[i] > longest)
+			longest = distance[i];
 	}
-	else return -1;
+	if (longest == 0)
+		return 0;
+
+	// pass 0: motor parameters of the axes whose velocity changes, pass 1: positions
+	for (int pass = 0; pass < 2; pass++) {
+		for (int i = 0; i < axis_count; i++) {
+			if (distance[i] == 0)
+				continue;
+			msgs[n].addr = axes[i]->getAddress();
+			msgs[n].flags = 0;
+			if (pass == 0) {
+				int wanted = (long long)velocity * distance[i] / longest;
+				int best = next.vmax;
+
+				for (int v = 0; v < (int)next.vmax; v++) {
+					if (abs(stepVelocity(v) - wanted) < abs(stepVelocity(best) - wanted))
+						best = v;
+				}
+				if (best == sent_vmax[i])
+					continue;
+				msgs[n].len = axes[i]->buildSetMotorParam(params[i], best);
+				msgs[n].buf = params[i];
+				sent_vmax[i] = best;
+			}
+			else {
+				msgs[n].len = axes[i]->buildSetPosition(positions[i], next.target[i]);
+				msgs[n].buf = positions[i];
+			}
+			n++;
+		}
+	}
+	if (axes[0]->transfer(msgs, n) < 0) {
+		// the parameters may not have arrived
+		for (int i = 0; i < axis_count; i++)
+			sent_vmax[i] = -1;
+		return -1;
+	}
+	for (int i = 0; i < axis_count; i++) {
+		if (distance[i] == 0)
+			continue;
+		handles[moving++] = poller.watch(i, next.target[i]);
+		current[i] = next.target[i];
+	}
+	return moving;
+}
+
+void *gnublin_step_planner::run(void *arg){
+	gnublin_step_planner *p = (gnublin_step_planner *)arg;
+	int handles[STEP_PLANNER_MAX_AXES];
+
+	pthread_mutex_lock(&p->mutex);
+	while (p->run_flag) {
+		segment next;
+		int moving;
+
+		if (p->count == 0) {
+			// the axes may be used directly now, so the parameters are sent again with the next segment
+			for (int i = 0; i < p->axis_count; i++)
+				p->sent_vmax[i] = -1;
+			p->busy = false;
+			pthread_cond_broadcast(&p->space);
+			pthread_cond_wait(&p->work, &p->mutex);
+			continue;
+		}
+		next = p->queue[p->first];
+		p->first = (p->first + 1) % STEP_PLANNER_QUEUE;
+		p->count--;
+		p->busy = true;
+		pthread_cond_broadcast(&p->space);
+		pthread_mutex_unlock(&p->mutex);
+
+		moving = p->dispatch(next, handles);
+		if (moving < 0) {
+			pthread_mutex_lock(&p->mutex);
+			p->thread_error = p->axes[0]->getErrorMessage();
+			p->errors++;
+		}
+		else if (moving > 0 && p->poller.wait(handles, moving, -1) < 0) {
+			pthread_mutex_lock(&p->mutex);
+			p->thread_error = "an axis failed while moving\n";
+			p->errors++;
+		}
+		else
+			pthread_mutex_lock(&p->mutex);
+		p->segments++;
+	}
+	p->busy = false;
+	pthread_cond_broadcast(&p->space);
+	pthread_mutex_unlock(&p->mutex);
+	return NULL;
+}
+
+//****************************************************************************
+// Class for running G-code on GNUBLIN Module-steps
+//****************************************************************************
+
+static const char gcode_letters[GCODE_AXES] = { 'X', 'Y', 'Z', 'E' };
+
+/** @~english
+* @brief Create an interpreter.
+*
+* X, Y, Z and E are mapped to the planner axes 0-3 with 100 steps per mm.
+* @param planner the planner which executes the moves, NULL: the program is only parsed
+*
+* @~german
+* @brief Erzeugt einen Interpreter.
+*
+* X, Y, Z und E werden auf die Planer Achsen 0-3 mit 100 Schritten pro mm abgebildet.
+* @param planner der Planer, der die Bewegungen ausführt, NULL: das Programm wird nur ausgewertet
+*/
+gnublin_gcode::gnublin_gcode(gnublin_step_planner *planner){
+	this->planner = planner;
+	heater = NULL;
+	heater_pin = 1;
+	for (int i = 0; i < GCODE_AXES; i++) {
+		axis_map[i] = i;
+		steps_per_mm[i] = 100;
+	}
+	microsteps = 2;
+	rapid_vmax = 15;
+	reset();
+	error_flag = false;
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_gcode::fail(){
+	return error_flag;
 }
 
-//-------------hardStop-------------
-/** @~english 
-* @brief Hard stop.
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
 *
-* This funktion sends the hardStop Command to the Chip. The motor will stop immediately.
-* @return success: 1, failure: -1
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
 *
-* @~german 
-* @brief Hard Stop.
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
 *
-* Diese Funktion sendet den hardStop Befehl an den Chip. Der Motor bleibt sofort Stehen.
-* @return Erfolg: 1, Fehler: -1
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
 */
-int gnublin_module_step::hardStop(){
-		if(i2c.send(0x85)){
-		return 1;
-		}
-		else return -1;
+const char *gnublin_gcode::getErrorMessage(){
+	return ErrorMessage.c_str();
 }
 
-//-------------softStop-------------
-/** @~english 
-* @brief Soft stop.
+int gnublin_gcode::error(const std::string &message){
+	ErrorMessage = "line " + numberToString(line_number) + ": " + message + "\n";
+	error_flag = true;
+	return -1;
+}
+
+//-------------setAxis-------------
+/** @~english
+* @brief Map a G-code axis to a planner axis.
 *
-* This funktion sends the softStop Command to the Chip. The motor slows down and stops.
+* @param letter X, Y, Z or E
+* @param axis index of the planner axis, -1: moves of this axis are ignored
+* @param steps_per_mm motor positions per mm
 * @return success: 1, failure: -1
 *
-* @~german 
-* @brief Soft Stop.
+* @~german
+* @brief Bildet eine G-code Achse auf eine Planer Achse ab.
 *
-* Diese Funktion sendet den SoftStop Befehl an den Chip. Der Motor fährt langsam herrunter.
+* @param letter X, Y, Z oder E
+* @param axis Index der Planer Achse, -1: Bewegungen dieser Achse werden ignoriert
+* @param steps_per_mm Motor Positionen pro mm
 * @return Erfolg: 1, Fehler: -1
 */
-int gnublin_module_step::softStop(){
-		if(i2c.send(0x8f)){
-		return 1;
+int gnublin_gcode::setAxis(char letter, int axis, double steps_per_mm){
+	for (int i = 0; i < GCODE_AXES; i++) {
+		if (gcode_letters[i] != toupper(letter))
+			continue;
+		if (axis < -1 || axis >= STEP_PLANNER_MAX_AXES || steps_per_mm <= 0) {
+			ErrorMessage = "invalid axis or steps per mm\n";
+			error_flag = true;
+			return -1;
 		}
-		else return -1;
+		axis_map[i] = axis;
+		this->steps_per_mm[i] = steps_per_mm;
+		error_flag = false;
+		return 1;
+	}
+	ErrorMessage = "axis is not X, Y, Z or E\n";
+	error_flag = true;
+	return -1;
 }
 
-//-------------resetPosition-------------
-/** @~english 
-* @brief Reset Position.
+//-------------setMicrosteps-------------
+/** @~english
+* @brief Set the motor positions per full step.
 *
-* This funktion sends the resetPosition Command to the Chip. The internal position counter of the chip is reset to 0.
+* Used to convert the feed to a Vmax. The default 2 matches the half step mode set by gnublin_module_step::setMotorParam().
+* @param microsteps 2, 4, 8 or 16
 * @return success: 1, failure: -1
 *
-* @~german 
-* @brief Reset Position.
+* @~german
+* @brief Setzt die Motor Positionen pro Vollschritt.
 *
-* Diese Funktion sendet den resetPosition Befehl an den Chip. Der interne Positions Zähler des Chips wird auf 0 zurückgesetzt.
+* Wird zur Umrechnung des Vorschubs in ein Vmax verwendet. Der Standardwert 2 entspricht dem Halbschritt Modus, den gnublin_module_step::setMotorParam() einstellt.
+* @param microsteps 2, 4, 8 oder 16
 * @return Erfolg: 1, Fehler: -1
 */
-int gnublin_module_step::resetPosition(){
-		if(i2c.send(0x86)){
-		return 1;
-		}
-		else return -1;
+int gnublin_gcode::setMicrosteps(int microsteps){
+	if (microsteps != 2 && microsteps != 4 && microsteps != 8 && microsteps != 16) {
+		ErrorMessage = "microsteps is not 2, 4, 8 or 16\n";
+		error_flag = true;
+		return -1;
+	}
+	this->microsteps = microsteps;
+	error_flag = false;
+	return 1;
 }
 
-//-------------setPosition-------------
-/** @~english 
-* @brief Set Position.
+//-------------setRapidVmax-------------
+/** @~english
+* @brief Set the Vmax of G0 moves, which is also the limit for G1 moves.
 *
-* This funktion sends the Position Command to the Chip. The motor drives to the given position.
+* @param vmax Vmax of the TMC222 (0-15), default 15
 * @return success: 1, failure: -1
 *
-* @~german 
-* @brief Setze Position.
+* @~german
+* @brief Setzt das Vmax von G0 Bewegungen, das auch die Grenze für G1 Bewegungen ist.
 *
-* Diese Funktion sendet den Position Befehl an den Chip. Der Motor fährt an die übergebene Position.
+* @param vmax Vmax des TMC222 (0-15), Standard 15
 * @return Erfolg: 1, Fehler: -1
 */
-int gnublin_module_step::setPosition(int position){
-	unsigned char buffer[5];
-	buffer[0] = 0x8B;   // SetPosition Command
-	buffer[1] = 0xff;   // not avialable
-	buffer[2] = 0xff;   // not avialable
-	buffer[3] = (unsigned char) (position >> 8);  // PositionByte1 (15:8)
-	buffer[4] = (unsigned char)  position;       // PositionByte2 (7:0)
-	
-	if(i2c.send(buffer, 5)){
-		return 1;
+int gnublin_gcode::setRapidVmax(unsigned int vmax){
+	if (vmax > 15) {
+		ErrorMessage = "vmax is not between 0-15\n";
+		error_flag = true;
+		return -1;
 	}
-	else return -1;
+	rapid_vmax = vmax;
+	error_flag = false;
+	return 1;
 }
 
-//-------------drive-------------
-/** @~english 
-* @brief Drive.
+//-------------setHeater-------------
+/** @~english
+* @brief Set the relay which is switched by M104 and M109.
 *
-* This Funktion reads the actual position from the motor and adds the amount of given steps to drive. So you can let the motor drive an amount of steps, without heaving trouble with the absolute positions.
-* @return success: 1, failure: -1
+* @param relay the relay board, NULL: M104 and M109 are ignored
+* @param pin number of the relay (1-8)
 *
-* @~german 
-* @brief Fahre.
+* @~german
+* @brief Setzt das Relay, das von M104 und M109 geschaltet wird.
 *
-* Diese Funktion ließt die aktuelle Position des Motors und addiert die anzahl der übergebenen Schritte. So kann man den Motor einfach um eine bestimmte Anzahl Schritte fahren lassen, ohne sich über die absoulute Position gedanken machen zu müssen.
-* @return Erfolg: 1, Fehler: -1
+* @param relay das Relay Board, NULL: M104 und M109 werden ignoriert
+* @param pin Nummer des Relays (1-8)
 */
-int gnublin_module_step::drive(int steps){
-	int old_position;
-	int new_position;
+void gnublin_gcode::setHeater(gnublin_module_relay *relay, int pin){
+	heater = relay;
+	heater_pin = pin;
+}
+
+void gnublin_gcode::reset(){
+	for (int i = 0; i < STEP_PLANNER_MAX_AXES; i++)
+		steps[i] = planner ? planner->getPosition(i) : 0;
+	for (int i = 0; i < GCODE_AXES; i++) {
+		position[i] = axis_map[i] < 0 ? 0 : steps[axis_map[i]] / steps_per_mm[i];
+		offset[i] = 0;
+	}
+	feed = 0;
+	unit = 1;
+	relative = false;
+	motion = 0;
+	stopped = false;
+	first = 0;
+	count = 0;
+	line_number = 0;
+	moves = 0;
+	segments = 0;
+	ignored = 0;
+}
+
+//-------------run-------------
+/** @~english
+* @brief Run a G-code program and wait until all moves are done.
+*
+* @param filename path of the program, "-" reads from stdin
+* @return success: 1, failure: -1 (the error message contains the line number)
+*
+* @~german
+* @brief Führt ein G-code Programm aus und wartet, bis alle Bewegungen fertig sind.
+*
+* @param filename Pfad des Programms, "-" liest von stdin
+* @return Erfolg: 1, Fehler: -1 (die Fehlermeldung enthält die Zeilennummer)
+*/
+int gnublin_gcode::run(std::string filename){
+	int fd, result;
 
-	old_position = getActualPosition();
-	new_position = old_position+steps;
-	if(setPosition(new_position)){
-		return 1;
+	if (filename == "-")
+		return run(0);
+	if ((fd = open(filename.c_str(), O_RDONLY)) < 0) {
+		ErrorMessage = "ERROR opening: " + filename + "\n";
+		error_flag = true;
+		return -1;
 	}
-	else return -1;
+	result = run(fd);
+	close(fd);
+	return result;
 }
 
-//-------------getMotionStatus-------------
-/** @~english 
-* @brief Get motion status.
-*
-* This funktion Indicates the actual behavior of the position controller. <br>
-*	0: Actual Position = Target Position; Velocity= 0 <br>
-*	1: Positive Acceleration; Velocity > 0 <br>
-*	2: Negative Acceleration; Velocity > 0 <br>
-*	3: Acceleration = 0 Velocity = maximum pos Velocity <br>
-*	4: Actual Position /= Target Position; Velocity= 0 <br>
-*	5: Positive Acceleration; Velocity < 0 <br>
-*	6: Positive Acceleration; Velocity < 0 <br>
-*	7: Acceleration = 0 Velocity = maximum neg Velocity <br>
-*	-1: failure
+/** @~english
+* @brief Run a G-code program from a file descriptor (file, pipe or socket).
 *
-* @return motionStatus
+* @param fd the file descriptor, it is read until end of file
+* @return success: 1, failure: -1 (the error message contains the line number)
 *
-* @~german 
-* @brief Bewegungs-Status.
+* @~german
+* @brief Führt ein G-code Programm von einem Dateideskriptor aus (Datei, Pipe oder Socket).
 *
-* Diese Funktion gibt den aktuellen bewegungs Status des module-step zurück. <br>
-*	0: Aktuelle Position = Ziehl Position; Geschwindigkeit= 0 <br>
-*	1: Positive Beschleunigung; Geschwindigkeit > 0 <br>
-*	2: Negative Beschleunigung; Geschwindigkeit > 0 <br>
-*	3: Beschleunigung = 0; Geschwindigkeit = maximum pos Geschwindigkeit <br>
-*	4: Aktuelle Position /= Ziehl Position; Geschwindigkeit= 0 <br>
-*	5: Positive Beschleunigung; Geschwindigkeit < 0 <br>
-*	6: Positive Beschleunigung; Geschwindigkeit < 0 <br>
-*	7: Acceleration = 0 Geschwindigkeit = maximum neg Geschwindigkeit  <br>
-*	-1: Fehler
-* @return motionStatus
+* @param fd der Dateideskriptor, er wird bis zum Dateiende gelesen
+* @return Erfolg: 1, Fehler: -1 (die Fehlermeldung enthält die Zeilennummer)
 */
-int gnublin_module_step::getMotionStatus(){
-	unsigned char RxBuf[8];
-	int motionStatus = -1;
-	getFullStatus1();
-	
-    	if(!i2c.receive(RxBuf, 8))
+int gnublin_gcode::run(int fd){
+	char buffer[GCODE_READ_SIZE];
+	char line[GCODE_LINE_MAX];
+	int length = 0;
+	bool too_long = false;
+	ssize_t n;
+
+	reset();
+	error_flag = false;
+	while (!stopped) {
+		// the read blocks on a pipe until the next block arrives, meanwhile the planner works off all
+		// queued moves except the last one, which may still be merged with the next move
+		if (flush(1) < 0)
+			return -1;
+		n = read(fd, buffer, sizeof(buffer));
+		if (n == 0)
+			break;
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return error("read failed");
+		}
+		for (ssize_t i = 0; i < n && !stopped; i++) {
+			if (buffer[i] != '\n') {
+				if (length < GCODE_LINE_MAX - 1)
+					line[length++] = buffer[i];
+				else
+					too_long = true;
+				continue;
+			}
+			line_number++;
+			if (too_long)
+				return error("line is longer than " + numberToString(GCODE_LINE_MAX - 1) + " characters");
+			line[length] = 0;
+			if (execute(line) < 0)
+				return -1;
+			length = 0;
+		}
+	}
+	if (length && !stopped) {
+		line_number++;
+		if (too_long)
+			return error("line is longer than " + numberToString(GCODE_LINE_MAX - 1) + " characters");
+		line[length] = 0;
+		if (execute(line) < 0)
+			return -1;
+	}
+	return sync();
+}
+
+// parses and executes one line
+int gnublin_gcode::execute(char *line){
+	double value[26];
+	bool has[26];
+	double g[4];
+	int g_count = 0;
+	char missing = 0;
+	bool home = false, set_position = false, axis_word = false;
+	char *p = line;
+
+	memset(has, 0, sizeof(has));
+	while (*p) {
+		char c = *p;
+		char *end;
+		int letter;
+
+		if (c == ';' || c == '*')
+			break;
+		if (c == '(') {
+			while (*p && *p != ')')
+				p++;
+			if (*p)
+				p++;
+			continue;
+		}
+		if (c == ' ' || c == '\t' || c == '\r') {
+			p++;
+			continue;
+		}
+		if (!isalpha(c))
+			return error(std::string("unexpected character '") + c + "'");
+		letter = toupper(c) - 'A';
+		value[letter] = strtod(++p, &end);
+		// axis words without a number are only allowed with G28, which is known after the line
+		if (end == p && !missing)
+			missing = toupper(c);
+		p = end;
+		if (letter == 'G' - 'A') {
+			if (g_count == 4)
+				return error("more than 4 G words");
+			g[g_count++] = value[letter];
+		}
+		else
+			has[letter] = true;
+		// the rest of M117 is a message for the display
+		if (letter == 'M' - 'A' && (int)value[letter] == 117)
+			break;
+	}
+
+	for (int i = 0; i < g_count; i++) {
+		switch ((int)g[i]) {
+			case 0:
+			case 1:  motion = (int)g[i]; break;
+			case 20: unit = 25.4; break;
+			case 21: unit = 1; break;
+			case 28: home = true; break;
+			case 90: relative = false; break;
+			case 91: relative = true; break;
+			case 92: set_position = true; break;
+			default: ignored++; break;
+		}
+	}
+	// G28 X Y selects axes, everywhere else a missing number is an error
+	if (missing && !(home && strchr("XYZE", missing)))
+		return error(std::string("missing number after ") + missing);
+	if (has['F' - 'A'])
+		feed = value['F' - 'A'] * unit;
+	for (int i = 0; i < GCODE_AXES; i++)
+		axis_word |= has[gcode_letters[i] - 'A'];
+
+	if (home) {
+		double target[GCODE_AXES];
+
+		// G28 without axes homes all axes
+		for (int i = 0; i < GCODE_AXES; i++) {
+			bool selected = !axis_word || has[gcode_letters[i] - 'A'];
+
+			target[i] = selected ? 0 : position[i] + offset[i];
+			if (selected)
+				offset[i] = 0;
+		}
+		if (queueMove(target, true) < 0)
+			return -1;
+		for (int i = 0; i < GCODE_AXES; i++)
+			position[i] = target[i] - offset[i];
+	}
+	else if (set_position) {
+		for (int i = 0; i < GCODE_AXES; i++) {
+			if (!has[gcode_letters[i] - 'A'])
+				continue;
+			offset[i] += position[i] - value[gcode_letters[i] - 'A'] * unit;
+			position[i] = value[gcode_letters[i] - 'A'] * unit;
+		}
+	}
+	else if (axis_word) {
+		double target[GCODE_AXES];
+
+		for (int i = 0; i < GCODE_AXES; i++) {
+			double v = value[gcode_letters[i] - 'A'] * unit;
+
+			if (has[gcode_letters[i] - 'A'])
+				position[i] = relative ? position[i] + v : v;
+			target[i] = position[i] + offset[i];
+		}
+		if (queueMove(target, motion == 0) < 0)
+			return -1;
+	}
+
+	if (has['M' - 'A']) {
+		switch ((int)value['M' - 'A']) {
+			case 104:
+			case 109:
+				if (!heater) {
+					ignored++;
+					break;
+				}
+				if (sync() < 0)
+					return -1;
+				if (heater->switchPin(heater_pin, has['S' - 'A'] && value['S' - 'A'] > 0 ? 1 : 0) < 0)
+					return error(heater->getErrorMessage());
+				break;
+			case 2:
+			case 30:
+				stopped = true;
+				break;
+			default:
+				ignored++;
+				break;
+		}
+	}
+	return 1;
+}
+
+// Vmax for the feed: the fastest velocity of the longest axis which does not exceed the feed
+unsigned int gnublin_gcode::feedToVmax(double distance, int longest){
+	double full_steps;
+	unsigned int vmax = 0;
+
+	if (feed <= 0 || distance <= 0)
+		return rapid_vmax;
+	full_steps = longest * (feed / 60) / distance / microsteps;
+	while (vmax < rapid_vmax && stepVelocity(vmax + 1) <= full_steps)
+		vmax++;
+	return vmax;
+}
+
+// converts a move to motor positions and merges it with the last queued move if it continues in the same direction
+int gnublin_gcode::queueMove(const double *mm, bool rapid){
+	gcode_move next;
+	double distance = 0;
+	int longest = 0;
+	bool moving = false;
+
+	for (int i = 0; i < STEP_PLANNER_MAX_AXES; i++) {
+		next.target[i] = steps[i];
+		next.delta[i] = 0;
+	}
+	for (int i = 0; i < GCODE_AXES; i++) {
+		int axis = axis_map[i];
+		double from, to;
+
+		if (axis < 0)
+			continue;
+		from = steps[axis] / steps_per_mm[i];
+		to = mm[i];
+		distance += (to - from) * (to - from);
+		next.target[axis] = (int)floor(to * steps_per_mm[i] + 0.5);
+		next.delta[axis] = next.target[axis] - steps[axis];
+		if (next.delta[axis]) {
+			moving = true;
+			if (abs(next.delta[axis]) > longest)
+				longest = abs(next.delta[axis]);
+		}
+	}
+	if (!moving)
+		return 1;
+	moves++;
+	next.vmax = rapid ? rapid_vmax : feedToVmax(sqrt(distance), longest);
+	for (int i = 0; i < STEP_PLANNER_MAX_AXES; i++)
+		steps[i] = next.target[i];
+
+	if (count) {
+		gcode_move *last = &lookahead[(first + count - 1) % GCODE_LOOKAHEAD];
+		bool same = last->vmax == next.vmax;
+		long long dot = 0;
+
+		// same direction: all 2x2 cross products are 0 and the dot product is positive
+		for (int i = 0; i < STEP_PLANNER_MAX_AXES && same; i++) {
+			dot += (long long)last->delta[i] * next.delta[i];
+			for (int j = i + 1; j < STEP_PLANNER_MAX_AXES && same; j++)
+				same = (long long)last->delta[i] * next.delta[j] == (long long)last->delta[j] * next.delta[i];
+		}
+		if (same && dot > 0) {
+			for (int i = 0; i < STEP_PLANNER_MAX_AXES; i++) {
+				last->target[i] = next.target[i];
+				last->delta[i] += next.delta[i];
+			}
+			return 1;
+		}
+	}
+	if (count == GCODE_LOOKAHEAD && flush(GCODE_LOOKAHEAD - 1) < 0)
 		return -1;
-	motionStatus = (RxBuf[5] & 0xe0) >> 5;
-	return motionStatus;
-	
+	lookahead[(first + count) % GCODE_LOOKAHEAD] = next;
+	count++;
+	return 1;
 }
 
+// sends queued moves to the planner until only keep moves are left
+int gnublin_gcode::flush(int keep){
+	while (count > keep) {
+		gcode_move *next = &lookahead[first];
 
-//-------------------get Switch status----------------
-/** @~english 
-* @brief Get switch condition.
+		if (planner) {
+			if (planner->setVmax(next->vmax) < 0 || planner->move(next->target) < 0)
+				return error(planner->getErrorMessage());
+		}
+		segments++;
+		first = (first + 1) % GCODE_LOOKAHEAD;
+		count--;
+	}
+	return 1;
+}
+
+// sends all queued moves and waits until they are done
+int gnublin_gcode::sync(){
+	if (flush(0) < 0)
+		return -1;
+	if (planner && planner->wait(-1) < 0)
+		return error(planner->getErrorMessage());
+	return 1;
+}
+
+//-------------statistics-------------
+/** @~english
+* @brief Number of lines of the last program.
 *
-* This function checks the status of the connected switch and returns the value. <br>
-* Switch closed: 1 <br>
-* Switch open: 0 <br>
-* Failure: -1
-* @return success: swi
+* @return number of lines
 *
-* @~german 
-* @brief Setze Position.
+* @~german
+* @brief Anzahl der Zeilen des letzten Programms.
 *
-* Diese Funktion überprüft den Zustand des angeschlossenen Schalters und gibt den Wert zurück. <br>
-* Schalter geschlossen: 1 <br>
-* Schalter offen: 0 <br>
-* Fehler: -1
-* @return swi
+* @return Anzahl der Zeilen
 */
-int gnublin_module_step::getSwitch(){
-	unsigned char RxBuf[8];    	
-	int swi = 0;
-
-    	getFullStatus1();
+unsigned int gnublin_gcode::getLines(){
+	return line_number;
+}
 
-    	if(i2c.receive(RxBuf, 8)){
-	
-			if(RxBuf[5] & 0x10){
-				swi = 1;				
-			}
-			else{
-				swi = 0;
-			}
-			return swi;
-		}	
-		else return -1;
+/** @~english
+* @brief Number of moves of the last program.
+*
+* @return number of moves
+*
+* @~german
+* @brief Anzahl der Bewegungen des letzten Programms.
+*
+* @return Anzahl der Bewegungen
+*/
+unsigned int gnublin_gcode::getMoves(){
+	return moves;
 }
 
-//-------------------getActualPosition----------------
-/** @~english 
-* @brief Get actual position.
+/** @~english
+* @brief Number of segments sent to the planner, merged moves count once.
 *
-* This funktion sends the getActualPosition Command to the Chip and returns its actiual position.
-* @return actualPosition -1 if failure
+* @return number of segments
 *
-* @~german 
-* @brief Aktuelle Position ausgeben.
+* @~german
+* @brief Anzahl der an den Planer gesendeten Segmente, zusammengefasste Bewegungen zählen einmal.
 *
-* Diese Funktion sendet den getActualPosition Befehl an den Chip und gibt dessen aktuelle Position zurück.
-* @return actualPosition -1 bei Fehler
+* @return Anzahl der Segmente
 */
-int gnublin_module_step::getActualPosition(){
-	unsigned char RxBuf[8];	
-	int actualPosition=-1;
-	
-	if(getFullStatus2()==-1)
-		return -1;
-	
-	if(i2c.receive(RxBuf, 8)){
-		actualPosition = (RxBuf[1]<<8 | RxBuf[2]);
-	}	
-	return actualPosition;
+unsigned int gnublin_gcode::getSegments(){
+	return segments;
 }
 
+/** @~english
+* @brief Number of ignored G and M codes of the last program.
+*
+* @return number of codes
+*
+* @~german
+* @brief Anzahl der ignorierten G und M Befehle des letzten Programms.
+*
+* @return Anzahl der Befehle
+*/
+unsigned int gnublin_gcode::getIgnored(){
+	return ignored;
+}
 
 //*******************************************************************
 //Class for accessing GNUBLIN Module-LCD 4x20
@@ -3634,12 +11295,7 @@ void gnublin_module_lcd::setDevicefile(std::string filename){
 * @return Erfolg: 1, Fehler: -1
 */
 int gnublin_module_lcd::out(unsigned char rsrw, unsigned char data ){
-	if(!pca.writePort(0, data)){			//send data on Port 0
-		error_flag=true;
-		ErrorMessage = pca.getErrorMessage();
-		return -1;
-	}
-	if(!pca.writePort(1, rsrw)){			//send RS/RW bits on Port 1
+	if(pca.writePorts(data | (rsrw << 8)) < 0){	//send data on Port 0 and RS/RW bits on Port 1
 		error_flag=true;
 		ErrorMessage = pca.getErrorMessage();
 		return -1;
@@ -3850,25 +11506,15 @@ int gnublin_module_lcd::string(const char *data){
 * @return Erfolg: 1, Fehler: -1
 */
 int gnublin_module_lcd::init(){
-	//Set Ports as output
-	if(!pca.portMode(0, "out")){ 	//Port 0 as Output
-		error_flag=true;
-		ErrorMessage = pca.getErrorMessage();
-		return -1;
-	}
-	if(!pca.portMode(1, "out")){ 	//Port 1 as Output
+	//set all outputs to 0 before the ports become outputs
+	if(pca.writePorts(0x0000) < 0){
 		error_flag=true;
 		ErrorMessage = pca.getErrorMessage();
 		return -1;
 	}
 
-	//// initial alle Ausgänge auf Null
-	if(!pca.writePort(0, 0x00)){
-		error_flag=true;
-		ErrorMessage = pca.getErrorMessage();
-		return -1;
-	}
-	if(!pca.writePort(1, 0x00)){
+	//Set Ports as output
+	if(pca.setDirection16(0x0000) < 0){
 		error_flag=true;
 		ErrorMessage = pca.getErrorMessage();
 		return -1;
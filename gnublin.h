@@ -1,6 +1,6 @@
 //********************************************
 //GNUBLIN API -- HEADER FILE
-//build date: 06/10/13 11:30
+//build date: 10/19/26 07:37
 //******************************************** 
 
 
@@ -38,6 +38,7 @@
 
 #include <cstring>
 #include <ctime>
+#include <errno.h>
 #include <fcntl.h>
 #include <fstream>
 #include <iostream>
@@ -45,13 +46,21 @@
 #include <linux/i2c-dev.h>
 #include <linux/spi/spidev.h>
 #include <sstream>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
 #include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 
 
 //BOARDS
@@ -70,6 +79,78 @@
 int stringToNumber(std::string str);
 std::string numberToString(int num);
 int hexstringToNumber(std::string str);
+int hexbufferToNumber(const char *buf, int length);
+unsigned long long getMonotonicTime();
+//***** NEW BLOCK *****
+
+//event types
+#define EVENT_GPIO_EDGE		1
+#define EVENT_ADC_ABOVE		2
+#define EVENT_ADC_BELOW		3
+#define EVENT_ADC_INSIDE	4
+#define EVENT_ADC_RATE		5
+#define EVENT_TEMP_ALARM	6
+#define EVENT_TEMP_CLEAR	7
+#define EVENT_PIN_CHANGE	8
+#define EVENT_MOTION_DONE	9
+
+/**
+* @struct gnublin_event
+* @~english
+* @brief An event as delivered by gnublin_event_queue
+*
+* @~german
+* @brief Ein Ereignis, wie es von gnublin_event_queue geliefert wird
+*/
+struct gnublin_event {
+	int type;			// EVENT_*
+	int device;			// e.g. I2C address of the sending module, 0 for onboard sources
+	int source;			// pin or channel number
+	int value;			// new level or sample value
+	unsigned long long timestamp;	// µs, CLOCK_MONOTONIC
+};
+
+typedef void (*gnublin_event_callback)(const gnublin_event *event, void *arg);
+
+//****************************************************************************
+// Class for delivering events from background threads
+//****************************************************************************
+/**
+* @class gnublin_event_queue
+* @~english
+* @brief Thread safe queue for events (GPIO edges, ADC comparator, ...)
+*
+* Events are either queued and fetched with wait()/poll(), or, if a callback is set, passed to the callback directly from the thread which detected the event.
+* @~german
+* @brief Threadsichere Warteschlange für Ereignisse (GPIO Flanken, ADC Komparator, ...)
+*
+* Ereignisse werden entweder eingereiht und mit wait()/poll() abgeholt oder, falls ein Callback gesetzt ist, direkt aus dem Thread, der das Ereignis erkannt hat, an den Callback übergeben.
+*/
+class gnublin_event_queue {
+	public:
+		gnublin_event_queue();
+		gnublin_event_queue(int size);
+		~gnublin_event_queue();
+		void setCallback(gnublin_event_callback callback, void *arg);
+		int push(const gnublin_event &event);
+		int wait(gnublin_event *event, int timeout_ms);
+		int poll(gnublin_event *event);
+		int pending();
+		unsigned int getDropped();
+	private:
+		gnublin_event_queue(const gnublin_event_queue &);
+		gnublin_event_queue &operator=(const gnublin_event_queue &);
+		void init(int size);
+		gnublin_event *events;
+		int size;
+		int first;
+		int count;
+		unsigned int dropped;
+		gnublin_event_callback callback;
+		void *callback_arg;
+		pthread_mutex_t mutex;
+		pthread_cond_t cond;
+};
 //***** NEW BLOCK *****
 
 /**
@@ -97,6 +178,52 @@ class gnublin_gpio {
 		std::string ErrorMessage;
 };
 //***** NEW BLOCK *****
+
+#define GPIO_EDGE_MAX_PINS 16
+
+//****************************************************************************
+// Class for waiting on GPIO edges
+//****************************************************************************
+/**
+* @class gnublin_gpio_edge
+* @~english
+* @brief Delivers GPIO edges as events
+*
+* One thread waits on the sysfs value files of all watched pins (poll() on POLLPRI), so no CPU time and no bus traffic is spent while nothing happens.
+* Every edge is delivered as EVENT_GPIO_EDGE to the gnublin_event_queue of the pin.
+* @~german
+* @brief Liefert GPIO Flanken als Ereignisse
+*
+* Ein Thread wartet auf die sysfs value Dateien aller überwachten Pins (poll() auf POLLPRI), solange nichts passiert wird also weder Rechenzeit noch Bus-Verkehr benötigt.
+* Jede Flanke wird als EVENT_GPIO_EDGE an die gnublin_event_queue des Pins geliefert.
+*/
+class gnublin_gpio_edge {
+	public:
+		gnublin_gpio_edge();
+		~gnublin_gpio_edge();
+		int watch(int pin, std::string edge, gnublin_event_queue *queue);
+		int unwatch(int pin);
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		gnublin_gpio_edge(const gnublin_gpio_edge &);
+		gnublin_gpio_edge &operator=(const gnublin_gpio_edge &);
+		static void *run(void *arg);
+		void wakeup();
+		int pins[GPIO_EDGE_MAX_PINS];
+		int fds[GPIO_EDGE_MAX_PINS];
+		gnublin_event_queue *queues[GPIO_EDGE_MAX_PINS];
+		int count;
+		int wakeup_fd;
+		pthread_mutex_t mutex;
+		pthread_t thread;
+		volatile bool run_flag;
+		bool error_flag;
+		std::string ErrorMessage;
+};
+//***** NEW BLOCK *****
+
+#define I2C_TRANSFER_MAX_MSGS 42
 //*******************************************************************
 //Class for accessing GNUBLIN i2c Bus
 //*******************************************************************
@@ -114,10 +241,10 @@ class gnublin_gpio {
 
 class gnublin_i2c {
 	bool error_flag;
-	bool close_mode;
 	int slave_address;
 	std::string devicefile;
 	std::string ErrorMessage;
+	unsigned int transactions;
 public:
 	gnublin_i2c();
 	bool fail();
@@ -130,6 +257,8 @@ public:
 	int send(unsigned char *TxBuf, int length);
 	int send(unsigned char RegisterAddress, unsigned char *TxBuf, int length);
 	int send(int value);
+	int transfer(struct i2c_msg *msgs, int count);
+	unsigned int getTransactions();
 };
 //***** NEW BLOCK *****
 
@@ -174,6 +303,263 @@ class gnublin_spi{
 };
 //***** NEW BLOCK *****
 
+class gnublin_adc;
+class gnublin_module_adc;
+class gnublin_adc_comparator;
+
+#define ADC_SAMPLER_MAX_CHANNELS 8
+
+/**
+* @struct gnublin_adc_sample
+* @~english
+* @brief One timestamped raw ADC sample
+*
+* @~german
+* @brief Ein ADC Rohwert mit Zeitstempel
+*/
+struct gnublin_adc_sample {
+	unsigned long long timestamp; // µs, CLOCK_MONOTONIC
+	int channel;
+	int value;
+};
+
+//****************************************************************************
+// Class for continuous sampling of the GPAs or the GNUBLIN Module-ADC
+//****************************************************************************
+/**
+* @class gnublin_adc_sampler
+* @~english
+* @brief Background sampler for gnublin_adc and gnublin_module_adc
+*
+* A thread scans the configured channel list at a fixed rate and stores timestamped raw samples in a lock-free single-producer/single-consumer ring buffer.
+* @~german
+* @brief Hintergrund-Abtastung für gnublin_adc und gnublin_module_adc
+*
+* Ein Thread tastet die eingestellten Kanäle mit fester Rate ab und legt die Rohwerte mit Zeitstempel in einem lock-freien Ringpuffer (ein Erzeuger, ein Verbraucher) ab.
+*/
+class gnublin_adc_sampler {
+	public:
+#if (BOARD != RASPBERRY_PI)
+		gnublin_adc_sampler(gnublin_adc *adc);
+#endif
+		gnublin_adc_sampler(gnublin_module_adc *adc);
+		~gnublin_adc_sampler();
+		int setChannels(const int *channels, int count);
+		int setRate(int hz);
+		int setBufferSize(int size);
+		void setComparator(gnublin_adc_comparator *comparator);
+		int start();
+		void stop();
+		bool running();
+		int getLatest(int channel, gnublin_adc_sample *sample);
+		int getLatestValue(int channel);
+		int available();
+		int read(gnublin_adc_sample *buffer, int count);
+		int read(gnublin_adc_sample *buffer, int count, int timeout_ms);
+		unsigned int getOverruns();
+		unsigned int getReadErrors();
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		gnublin_adc_sampler(const gnublin_adc_sampler &);
+		gnublin_adc_sampler &operator=(const gnublin_adc_sampler &);
+		void init();
+		static void *run(void *arg);
+		void scan();
+		int readChannel(int channel);
+		void push(const gnublin_adc_sample &sample);
+		gnublin_adc *adc;
+		gnublin_module_adc *module_adc;
+		gnublin_adc_comparator *comparator;
+		int channels[ADC_SAMPLER_MAX_CHANNELS];
+		int channel_count;
+		int period_ns;
+		// ring buffer, head is only written by the sampling thread, tail only by the reader
+		gnublin_adc_sample *ring;
+		unsigned int ring_mask;
+		volatile unsigned int head;
+		volatile unsigned int tail;
+		volatile int reader_waiting;
+		int wakeup_fd;
+		// latest value per channel slot, guarded by a sequence counter
+		gnublin_adc_sample latest[ADC_SAMPLER_MAX_CHANNELS];
+		volatile unsigned int latest_seq[ADC_SAMPLER_MAX_CHANNELS];
+		volatile unsigned int overruns;
+		volatile unsigned int read_errors;
+		volatile bool run_flag;
+		pthread_t thread;
+		bool error_flag;
+		std::string ErrorMessage;
+};
+//***** NEW BLOCK *****
+
+#define ADC_FILTER_DECIMATE	1
+#define ADC_FILTER_AVERAGE	2
+#define ADC_FILTER_MEDIAN	3
+#define ADC_FILTER_IIR		4
+
+#define ADC_FILTER_MAX_STAGES	4
+#define ADC_FILTER_FRAC_BITS	8
+#define ADC_FILTER_CHUNK	256
+
+//****************************************************************************
+// Class for filtering ADC sample streams in fixed point
+//****************************************************************************
+/**
+* @class gnublin_adc_filter
+* @~english
+* @brief Fixed point filter pipeline for raw ADC samples
+*
+* Up to four stages (oversample and decimate, moving average, median of N, IIR low pass) are applied in the order they were added.
+* The filter state of all channels is kept in contiguous arrays, so a block of interleaved frames is filtered with tight loops over the channels.
+* Internally the values carry 8 fraction bits, setExtraBits() lets the output keep some of them (e.g. after oversampling).
+* @~german
+* @brief Festkomma-Filterkette für ADC Rohwerte
+*
+* Bis zu vier Stufen (Überabtastung mit Dezimierung, gleitender Mittelwert, Median aus N, IIR Tiefpass) werden in der Reihenfolge angewendet, in der sie hinzugefügt wurden.
+* Der Filterzustand aller Kanäle liegt in zusammenhängenden Arrays, so dass ein Block aus verschachtelten Frames mit kurzen Schleifen über die Kanäle gefiltert wird.
+* Intern haben die Werte 8 Nachkommabits, mit setExtraBits() kann ein Teil davon in die Ausgabe übernommen werden (z.B. nach Überabtastung).
+*/
+class gnublin_adc_filter {
+	public:
+		gnublin_adc_filter();
+		~gnublin_adc_filter();
+		int setChannels(const int *channels, int count);
+		int addStage(int type, int param);
+		void clearStages();
+		int setExtraBits(int bits);
+		void reset();
+		int process(int channel, const int *in, int count, int *out);
+		int process(const gnublin_adc_sample *in, int count, gnublin_adc_sample *out);
+		int processFrames(const int *in, int frames, int *out);
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		struct filter_stage {
+			int type;
+			int param;
+			int shift;		// decimation: log2(param), iir: time constant
+			long long reciprocal;	// average: 2^32 / param
+			long long *acc;		// per slot: decimation sum, average sum, iir output * 2^k
+			int *count;		// per slot: decimation count, history position
+			int *primed;		// per slot: history / iir output initialised
+			int *history;		// per slot: param values
+		};
+		gnublin_adc_filter(const gnublin_adc_filter &);
+		gnublin_adc_filter &operator=(const gnublin_adc_filter &);
+		void freeStages();
+		int allocStage(filter_stage *stage);
+		int findSlot(int channel);
+		int run(const int *in, int frames, int lanes, int slot, int *out);
+		int runStage(filter_stage *stage, const int *in, int frames, int lanes, int slot, int *out);
+		filter_stage stages[ADC_FILTER_MAX_STAGES];
+		int stage_count;
+		int *channels;
+		int channel_count;
+		int extra_bits;
+		int *work_in;
+		int *work_out;
+		int work_size;
+		bool error_flag;
+		std::string ErrorMessage;
+};
+//***** NEW BLOCK *****
+
+#define ADC_CALIBRATION_CHANNELS	9
+#define ADC_CALIBRATION_SHIFT		48
+
+//****************************************************************************
+// Class for converting raw ADC values to mV
+//****************************************************************************
+/**
+* @class gnublin_adc_calibration
+* @~english
+* @brief Per channel calibration (offset, gain, reference) and raw to mV conversion
+*
+* mV = round((raw + offset) * gain * reference / full scale)<br>
+* The factor is precomputed as a fixed point multiplier with 48 fraction bits, which is exact to the LSB for all raw values of a 8 to 10 bit ADC.
+* @~german
+* @brief Kalibrierung pro Kanal (Offset, Verstärkung, Referenz) und Umrechnung von Rohwerten in mV
+*
+* mV = round((Rohwert + Offset) * Verstärkung * Referenz / Vollausschlag)<br>
+* Der Faktor wird als Festkomma-Multiplikator mit 48 Nachkommabits vorberechnet, der für alle Rohwerte eines 8 bis 10 Bit ADCs auf das LSB genau ist.
+*/
+class gnublin_adc_calibration {
+	public:
+		gnublin_adc_calibration(int full_scale, int reference);
+		int setReference(int reference);
+		int setChannel(int channel, int offset, int gain_ppm, int reference);
+		int load(std::string filename);
+		int toMillivolt(int channel, int raw);
+		int toMillivolt(int channel, const int *raw, int count, int *mv);
+		int toMillivolt(const gnublin_adc_sample *samples, int count, int *mv);
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		void update(int channel);
+		int full_scale;
+		int offset[ADC_CALIBRATION_CHANNELS];
+		int gain_ppm[ADC_CALIBRATION_CHANNELS];
+		int reference[ADC_CALIBRATION_CHANNELS];
+		unsigned long long multiplier[ADC_CALIBRATION_CHANNELS];
+		bool error_flag;
+		std::string ErrorMessage;
+};
+//***** NEW BLOCK *****
+
+#define ADC_COMPARATOR_CHANNELS 9
+
+#define ADC_STATE_BELOW		-1
+#define ADC_STATE_INSIDE	0
+#define ADC_STATE_ABOVE		1
+
+//****************************************************************************
+// Class for threshold and window events on ADC samples
+//****************************************************************************
+/**
+* @class gnublin_adc_comparator
+* @~english
+* @brief Window comparator with hysteresis and rate of change trigger
+*
+* Attached to a gnublin_adc_sampler with setComparator(), every sample is checked in the sampling thread.
+* When a channel leaves its window (EVENT_ADC_ABOVE, EVENT_ADC_BELOW), returns into it (EVENT_ADC_INSIDE) or changes faster than allowed (EVENT_ADC_RATE), an event is pushed to the queue.
+* Thresholds are raw values. The configuration should be done before the sampler is started.
+* @~german
+* @brief Fensterkomparator mit Hysterese und Anstiegs-Auslöser
+*
+* Mit setComparator() an einen gnublin_adc_sampler gehängt, wird jeder Wert im Abtast-Thread geprüft.
+* Verlässt ein Kanal sein Fenster (EVENT_ADC_ABOVE, EVENT_ADC_BELOW), kehrt er zurück (EVENT_ADC_INSIDE) oder ändert er sich schneller als erlaubt (EVENT_ADC_RATE), wird ein Ereignis in die Warteschlange gelegt.
+* Die Schwellen sind Rohwerte. Die Einstellungen sollten vor dem Start des Samplers erfolgen.
+*/
+class gnublin_adc_comparator {
+	public:
+		gnublin_adc_comparator();
+		void setQueue(gnublin_event_queue *queue);
+		int setWindow(int channel, int low, int high, int hysteresis);
+		int setRateLimit(int channel, int rate);
+		int clear(int channel);
+		int getState(int channel);
+		int check(const gnublin_adc_sample &sample);
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		void emit(int type, const gnublin_adc_sample &sample);
+		gnublin_event_queue *queue;
+		bool window[ADC_COMPARATOR_CHANNELS];
+		int low[ADC_COMPARATOR_CHANNELS];
+		int high[ADC_COMPARATOR_CHANNELS];
+		int hysteresis[ADC_COMPARATOR_CHANNELS];
+		int rate[ADC_COMPARATOR_CHANNELS];
+		int state[ADC_COMPARATOR_CHANNELS];
+		bool primed[ADC_COMPARATOR_CHANNELS];
+		bool rate_exceeded[ADC_COMPARATOR_CHANNELS];
+		int last_value[ADC_COMPARATOR_CHANNELS];
+		unsigned long long last_time[ADC_COMPARATOR_CHANNELS];
+		bool error_flag;
+		std::string ErrorMessage;
+};
+//***** NEW BLOCK *****
+
 #if (BOARD != RASPBERRY_PI)
 //****************************************************************************
 // Class for easy acces to the GPAs
@@ -192,13 +578,25 @@ class gnublin_spi{
 class gnublin_adc {
 	public:
 		gnublin_adc();
+		~gnublin_adc();
+		void setDevicefile(std::string filename);
 		int getValue(int pin);
 		int getVoltage(int pin);
 		int setReference(int ref);
+		int setCalibration(int pin, int offset, int gain_ppm, int reference);
+		int loadCalibration(std::string filename);
+		gnublin_adc_calibration *getCalibration();
 		bool fail();
 		const char *getErrorMessage();
 	private:
+		gnublin_adc(const gnublin_adc &);
+		gnublin_adc &operator=(const gnublin_adc &);
+		int openDevice();
 		bool error_flag;
+		int fd;
+		int channel;
+		gnublin_adc_calibration calibration;
+		std::string devicefile;
 		std::string ErrorMessage;
 };
 
@@ -246,6 +644,25 @@ class gnublin_module_dogm{
 
 };
 //***** NEW BLOCK *****
+
+//LM75 registers
+#define LM75_TEMP	0x00
+#define LM75_CONFIG	0x01
+#define LM75_THYST	0x02
+#define LM75_TOS	0x03
+
+//configuration register bits
+#define LM75_SHUTDOWN		0x01
+#define LM75_INTERRUPT		0x02
+#define LM75_OS_ACTIVE_HIGH	0x04
+#define LM75_FAULT_QUEUE	0x18
+
+//OS modes
+#define LM75_MODE_COMPARATOR	0
+#define LM75_MODE_INTERRUPT	1
+
+//time for one conversion after leaving shutdown mode
+#define LM75_CONVERSION_MS	100
 //*******************************************************************
 //Class for accessing the LM75 IC via I2C
 //*******************************************************************
@@ -262,8 +679,23 @@ class gnublin_module_lm75 {
 	bool error_flag;
 	gnublin_i2c i2c;
 	std::string ErrorMessage;
+	int config;
+	int conversion_ms;
+	gnublin_gpio_edge *os_edge;
+	gnublin_event_queue *os_events;
+	gnublin_event_queue *alarm_queue;
+	gnublin_i2c alarm_i2c;
+	int alarm_pin;
+	bool alarmed;			// interrupt mode: the last activation was above TOS
+	gnublin_module_lm75(const gnublin_module_lm75 &);
+	gnublin_module_lm75 &operator=(const gnublin_module_lm75 &);
+	int updateConfig(int mask, int bits);
+	int writeThreshold(unsigned char reg, int temp);
+	int readThreshold(unsigned char reg);
+	static void osCallback(const gnublin_event *event, void *arg);
 public:
 	gnublin_module_lm75();
+	~gnublin_module_lm75();
 	const char *getErrorMessage();
 	bool fail();
 	void setAddress(int Address);
@@ -271,9 +703,211 @@ public:
 	int getTemp();
 	float getTempFloat();
 	short getValue();
+	int getConfig();
+	int setConfig(int value);
+	int setMode(int mode);
+	int setFaultQueue(int faults);
+	int setPolarity(bool active_high);
+	int setShutdown(bool shutdown);
+	int setTos(int temp);
+	int setThyst(int temp);
+	int getTos();
+	int getThyst();
+	void setConversionTime(int ms);
+	int getTempOneShot();
+	int attachAlarm(int pin, gnublin_event_queue *queue);
+	void detachAlarm();
+private:
+	int readRaw(unsigned char *rx_buf);
+};
+
+
+#define LM75_GROUP_MAX_BUSES	4
+#define LM75_GROUP_BUS_SENSORS	8
+#define LM75_GROUP_MAX_SENSORS	(LM75_GROUP_MAX_BUSES * LM75_GROUP_BUS_SENSORS)
+
+//*******************************************************************
+//Class for reading several LM75 on one or more I2C buses
+//*******************************************************************
+/**
+* @class gnublin_lm75_group
+* @~english
+* @brief Reads up to 8 LM75 (0x48-0x4f) per bus on up to 4 buses
+*
+* update() reads all sensors of a bus with one I2C transaction and polls the buses in parallel,
+* the temperatures are stored in one contiguous array in milli degree celsius.
+* @~german 
+* @brief Liest bis zu 8 LM75 (0x48-0x4f) pro Bus an bis zu 4 Bussen
+*
+* update() liest alle Sensoren eines Busses mit einer I2C Transaktion und fragt die Busse parallel ab,
+* die Temperaturen werden in einem zusammenhängenden Array in tausendstel Grad Celsius gespeichert.
+*/
+class gnublin_lm75_group {
+	struct lm75_bus {
+		std::string devicefile;
+		gnublin_i2c i2c;
+		int sensors[LM75_GROUP_BUS_SENSORS];
+		int count;
+		gnublin_lm75_group *group;
+	};
+	bool error_flag;
+	std::string ErrorMessage;
+	lm75_bus buses[LM75_GROUP_MAX_BUSES];
+	int bus_count;
+	int addresses[LM75_GROUP_MAX_SENSORS];
+	unsigned char raw[LM75_GROUP_MAX_SENSORS][2];
+	int temperatures[LM75_GROUP_MAX_SENSORS];
+	int status[LM75_GROUP_MAX_SENSORS];
+	int sensor_count;
+	gnublin_lm75_group(const gnublin_lm75_group &);
+	gnublin_lm75_group &operator=(const gnublin_lm75_group &);
+	static void *pollBus(void *arg);
+	void readBus(lm75_bus *bus);
+public:
+	gnublin_lm75_group();
+	const char *getErrorMessage();
+	bool fail();
+	int addSensor(int address);
+	int addSensor(std::string devicefile, int address);
+	int size();
+	int update();
+	const int *getTemperatures();
+	int getTemp(int index);
+	bool valid(int index);
+};
+
+
+//*******************************************************************
+//Class for sharing the temperature of one LM75 between threads
+//*******************************************************************
+/**
+* @class gnublin_lm75_cache
+* @~english
+* @brief Caches the temperature of a gnublin_module_lm75 for a time-to-live
+*
+* Reads younger than the TTL are answered from the cache. If several threads need a new value at the same time,
+* only one of them reads the sensor and the others wait for its result (single-flight).
+* All threads should read the sensor through the same cache object.
+* @~german 
+* @brief Speichert die Temperatur eines gnublin_module_lm75 für eine Gültigkeitsdauer zwischen
+*
+* Abfragen, die jünger als die Gültigkeitsdauer sind, werden aus dem Zwischenspeicher beantwortet. Brauchen mehrere Threads gleichzeitig einen neuen Wert,
+* liest nur einer den Sensor und die anderen warten auf sein Ergebnis (single-flight).
+* Alle Threads sollten den Sensor über dasselbe Cache Objekt lesen.
+*/
+class gnublin_lm75_cache {
+	gnublin_module_lm75 *lm75;
+	int ttl_ms;
+	float temp;
+	unsigned long long timestamp;
+	bool valid;
+	bool reading;
+	bool read_ok;
+	unsigned int generation;
+	unsigned int reads;
+	bool error_flag;
+	std::string ErrorMessage;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	gnublin_lm75_cache(const gnublin_lm75_cache &);
+	gnublin_lm75_cache &operator=(const gnublin_lm75_cache &);
+public:
+	gnublin_lm75_cache(gnublin_module_lm75 *lm75, int ttl_ms);
+	~gnublin_lm75_cache();
+	const char *getErrorMessage();
+	bool fail();
+	void setTTL(int ms);
+	int getTemp(float *temp, int max_age_ms);
+	float getTempFloat();
+	int getAge();
+	bool stale();
+	unsigned int getReads();
 };
 //***** NEW BLOCK *****
 
+#define MODULE_ADC_CHANNELS 8
+#define MODULE_ADC_SCAN_MAX 16
+
+/**
+* @struct gnublin_adc_channel
+* @~english
+* @brief ADS7830 channel with its precomputed command byte
+*
+* Use gnublin_adc_single_ended or gnublin_adc_differential to create one.
+* @~german
+* @brief ADS7830 Kanal mit vorberechnetem Kommandobyte
+*
+* Wird mit gnublin_adc_single_ended oder gnublin_adc_differential erzeugt.
+*/
+struct gnublin_adc_channel {
+	unsigned char command;	// SD C2 C1 C0, without power down bits
+	unsigned char channel;	// channel used for the calibration
+};
+
+/**
+* @class gnublin_adc_single_ended
+* @~english
+* @brief Channel N (1-8) in reference to GND, the command byte is computed at compile time
+*
+* e.g. adc.getValue(gnublin_adc_single_ended<3>()); a channel outside 1-8 doesn't compile.
+* @~german
+* @brief Kanal N (1-8) bezogen zu GND, das Kommandobyte wird zur Übersetzungszeit berechnet
+*
+* z.B. adc.getValue(gnublin_adc_single_ended<3>()); ein Kanal außerhalb 1-8 lässt sich nicht übersetzen.
+*/
+template <int N>
+struct gnublin_adc_single_ended : gnublin_adc_channel {
+	typedef char channel_is_not_between_1_8[(N >= 1 && N <= 8) ? 1 : -1];
+	enum { COMMAND = 0x80 | ((N - 1) & 1) << 6 | ((N - 1) >> 1) << 4 };
+	gnublin_adc_single_ended() {
+		command = COMMAND;
+		channel = N;
+	}
+};
+
+/**
+* @class gnublin_adc_differential
+* @~english
+* @brief Channel P in reference to channel M, the command byte is computed at compile time
+*
+* Only the pairs 1-2, 3-4, 5-6 and 7-8 in both directions are possible, other pairs don't compile.
+* @~german
+* @brief Kanal P bezogen auf Kanal M, das Kommandobyte wird zur Übersetzungszeit berechnet
+*
+* Nur die Paare 1-2, 3-4, 5-6 und 7-8 in beiden Richtungen sind möglich, andere Paare lassen sich nicht übersetzen.
+*/
+template <int P, int M>
+struct gnublin_adc_differential : gnublin_adc_channel {
+	typedef char invalid_channel_pair[(P >= 1 && P <= 8 && M == ((P - 1) ^ 1) + 1) ? 1 : -1];
+	enum { COMMAND = ((P - 1) & 1) << 6 | ((P - 1) >> 1) << 4 };
+	gnublin_adc_differential() {
+		command = COMMAND;
+		channel = P;
+	}
+};
+
+/**
+* @class gnublin_adc_scan_list
+* @~english
+* @brief Precomputed list of up to 16 channels for gnublin_module_adc::scan()
+*
+* @~german
+* @brief Vorberechnete Liste von bis zu 16 Kanälen für gnublin_module_adc::scan()
+*/
+class gnublin_adc_scan_list {
+	friend class gnublin_module_adc;
+	public:
+		gnublin_adc_scan_list();
+		gnublin_adc_scan_list &add(const gnublin_adc_channel &channel);
+		void clear();
+		int size() const;
+		int getChannel(int index) const;
+	private:
+		unsigned char commands[MODULE_ADC_SCAN_MAX];
+		unsigned char channels[MODULE_ADC_SCAN_MAX];
+		int count;
+};
+
 //*****************************************************************************
 // Class for accesing GNUBLIN Module-ADC / ADS7830
 //*****************************************************************************
@@ -297,19 +931,35 @@ class gnublin_module_adc {
 		int setReference(int value);
 		int getValue(int channel);
 		int getValue(int channel1, int channel2);
+		int getValue(const gnublin_adc_channel &channel);
+		int scan(int mask, int *values);
+		int scan(const gnublin_adc_scan_list &list, int *values);
+		int scanAll(int *values);
 		int getVoltage(int channel);
 		int getVoltage(int channel1, int channel2);
+		int getVoltage(const gnublin_adc_channel &channel);
+		int setCalibration(int channel, int offset, int gain_ppm, int reference);
+		int loadCalibration(std::string filename);
+		gnublin_adc_calibration *getCalibration();
 		bool fail();
 		const char *getErrorMessage();
 	private:
+		int read(int command);
+		int scanCommands(const unsigned char *commands, int count, unsigned char *results);
 		gnublin_i2c i2c;
 		bool error_flag;
 		std::string ErrorMessage;
 		int reference_flag; // (1 = intern, 0 extern)
-		int referenceValue;
+		gnublin_adc_calibration calibration;
 };
 //***** NEW BLOCK *****
 
+//pin directions, the values are the bits of the configuration register
+enum pca9555_direction {
+	PCA9555_OUTPUT = 0,
+	PCA9555_INPUT = 1
+};
+
 //*******************************************************************
 //Class for accessing GNUBLIN Module-Portexpander or any PCA9555
 //*******************************************************************
@@ -326,20 +976,121 @@ class gnublin_module_pca9555 {
 		bool error_flag;
 		gnublin_i2c i2c;
 		std::string ErrorMessage;
+		unsigned char shadow[8]; // register copies, indexed by register number (2-7 used)
+		bool shadow_valid;
+		bool verify_flag;
+		int loadShadow();
+		int writeRegister(unsigned char reg, unsigned char value);
+		int writeRegisters(unsigned char reg, uint16_t value);
+		gnublin_gpio_edge *int_edge;
+		gnublin_event_queue *int_events;
+		gnublin_event_queue *change_queue;
+		gnublin_i2c int_i2c;
+		int snapshot;
+		gnublin_module_pca9555(const gnublin_module_pca9555 &);
+		gnublin_module_pca9555 &operator=(const gnublin_module_pca9555 &);
+		static void intCallback(const gnublin_event *event, void *arg);
 public:
 		gnublin_module_pca9555();
+		~gnublin_module_pca9555();
 		const char *getErrorMessage();
 		bool fail();
 		void setAddress(int Address);
 		void setDevicefile(std::string filename);
+		int pinMode(int pin, pca9555_direction direction);
 		int pinMode(int pin, std::string direction);
+		int portMode(int port, pca9555_direction direction);
 		int portMode(int port, std::string direction);
+		int portModeMasked(int port, unsigned char mask, pca9555_direction direction);
 		int digitalWrite(int pin, int value);
 		int digitalRead(int pin);
 		int writePort(int port, unsigned char value);
+		int writePortMasked(int port, unsigned char mask, unsigned char value);
+		int writePorts(uint16_t value);
+		int readPorts();
+		int setDirection16(uint16_t inputs);
+		int setPolarity(int pin, int inverted);
+		int resync();
+		void setVerify(bool verify);
+		int attachInterrupt(int pin, gnublin_event_queue *queue);
+		void detachInterrupt();
+		unsigned int getTransactions();
+};
+
+
+#define PCA9555_BANK_MAX_CHIPS	16
+#define PCA9555_BANK_MAX_BUSES	4
+
+//*******************************************************************
+//Class for using several PCA9555 as one wide GPIO bank
+//*******************************************************************
+/**
+* @class gnublin_pca9555_bank
+* @~english
+* @brief Maps up to 16 PCA9555 to one flat pin index space
+*
+* Pin n is pin n % 16 of the expander with the index n / 16 (the order of addExpander()).
+* pinMode() and digitalWrite() only change the requested state, commit() compares it with the shadow registers
+* and writes only the changed ports, all of them with one I2C transaction per bus.
+* update() reads the inputs of all expanders with one I2C transaction per bus.
+* @~german 
+* @brief Bildet bis zu 16 PCA9555 auf einen durchgehenden Pin Index ab
+*
+* Pin n ist Pin n % 16 des Portexpanders mit dem Index n / 16 (Reihenfolge von addExpander()).
+* pinMode() und digitalWrite() ändern nur den gewünschten Zustand, commit() vergleicht ihn mit den Schattenregistern
+* und schreibt nur die geänderten Ports, alle mit einer I2C Transaktion pro Bus.
+* update() liest die Eingänge aller Portexpander mit einer I2C Transaktion pro Bus.
+*/
+class gnublin_pca9555_bank {
+		bool error_flag;
+		std::string ErrorMessage;
+		gnublin_i2c buses[PCA9555_BANK_MAX_BUSES];
+		std::string bus_devicefile[PCA9555_BANK_MAX_BUSES];
+		int bus_count;
+		int chip_count;
+		int chip_bus[PCA9555_BANK_MAX_CHIPS];
+		int chip_address[PCA9555_BANK_MAX_CHIPS];
+		uint16_t output[PCA9555_BANK_MAX_CHIPS];	// requested state
+		uint16_t config[PCA9555_BANK_MAX_CHIPS];
+		uint16_t shadow_output[PCA9555_BANK_MAX_CHIPS];	// state of the chips
+		uint16_t shadow_config[PCA9555_BANK_MAX_CHIPS];
+		uint16_t inputs[PCA9555_BANK_MAX_CHIPS];
+		bool shadow_valid;
+		unsigned int transactions;
+		int loadShadow();
+		int transfer(int bus, struct i2c_msg *msgs, int count);
+public:
+		gnublin_pca9555_bank();
+		const char *getErrorMessage();
+		bool fail();
+		int addExpander(int address);
+		int addExpander(std::string devicefile, int address);
+		int size();
+		int pinMode(int pin, pca9555_direction direction);
+		int digitalWrite(int pin, int value);
+		int commit();
+		int update();
+		int digitalRead(int pin);
+		const uint16_t *getInputs();
+		int resync();
+		unsigned int getTransactions();
 };
 //***** NEW BLOCK *****
 
+#define RELAY_WEAR_MAGIC	0x594c5247	// "GRLY"
+
+/**
+* @struct gnublin_relay_wear
+* @~english
+* @brief Layout of the wear state file of a relay board
+*
+* @~german
+* @brief Aufbau der Verschleiß-Zustandsdatei eines Relay Boards
+*/
+struct gnublin_relay_wear {
+	uint32_t magic;
+	uint32_t switches[8];	// switching cycles per relay
+};
 
 //****************************************************************************
 // Class for easy use of the GNUBLIN Module-Relay
@@ -350,34 +1101,203 @@ public:
 * @brief Class for accessing GNUBLIN module-relay
 *
 * The GNUBLIN Module-relay can be easily controlled with the gnublin_step API. The Module uses the I2C-Bus.
+* The switching cycles of every relay are counted, optionally in a memory mapped state file which keeps them across restarts.
+* With setMinTime() a relay stays closed or open for a minimum time, requests which come too soon are deferred until flush() and requests which restore the current state are dropped.
 * @~german 
 * @brief Klasse für den zugriff auf das GNUBLIN module-relay
 *
 * Das GNUBLIN module-relay lässt sich mit Hilfe der gnublin_relay API ganz einfach ansteuern. Das Modul nutzt die I2C-Schnittstelle.  
+* Die Schaltspiele jedes Relays werden gezählt, wahlweise in einer per mmap eingeblendeten Zustandsdatei, die sie über Neustarts hinweg erhält.
+* Mit setMinTime() bleibt ein Relay eine Mindestzeit geschlossen oder offen, zu früh kommende Anforderungen werden bis flush() zurückgestellt und Anforderungen, die den aktuellen Zustand wiederherstellen, verworfen.
 */ 
 class gnublin_module_relay {
 	gnublin_module_pca9555 pca9555;
 	bool error_flag;
 	std::string ErrorMessage;
+	uint8_t outputs;		// relay pins already configured as output
+	unsigned int last_transactions;
+	uint8_t state;
+	uint8_t known;
+	uint8_t deferred_mask;
+	uint8_t deferred_values;
+	unsigned long long changed_at[8];
+	unsigned long long min_on;
+	unsigned long long min_off;
+	gnublin_relay_wear local_wear;
+	gnublin_relay_wear *wear;
+	int wear_fd;
+	gnublin_module_relay(const gnublin_module_relay &);
+	gnublin_module_relay &operator=(const gnublin_module_relay &);
+	int apply(uint8_t mask, uint8_t values);
 public:
 	gnublin_module_relay();
+	~gnublin_module_relay();
 	const char *getErrorMessage();
 	bool fail();
 	void setAddress(int Address);
 	void setDevicefile(std::string filename);
 	int switchPin(int pin, int value);
+	int setRelays(uint8_t mask, uint8_t values);
+	int setAll(uint8_t values);
+	unsigned int getTransactions();
+	void setMinTime(unsigned int on_ms, unsigned int off_ms);
+	int flush();
+	int getFlushDelay();
+	uint8_t getDeferred();
+	int openWearFile(std::string filename);
+	void closeWearFile();
+	unsigned int getSwitchCount(int pin);
 };
 
+//***** NEW BLOCK *****
+
+#define RELAY_SCHEDULER_MAX_BOARDS	32
+#define RELAY_SCHEDULER_ACTIONS		4096
+
+// timer wheel: 1 ms ticks, level 0 has 256 slots, levels 1-3 have 64 slots each (2^26 ms ~ 18.6 h)
+#define RELAY_WHEEL_LEVELS	4
+#define RELAY_WHEEL_SLOTS	256
+#define RELAY_WHEEL_BITS0	8
+#define RELAY_WHEEL_BITS	6
+
+//****************************************************************************
+// Class for timed switching of GNUBLIN Module-Relays
+//****************************************************************************
+/**
+* @class gnublin_relay_scheduler
+* @~english
+* @brief Executes scheduled relay actions of many relay boards in one thread
+*
+* The pending actions are kept in a hierarchical timer wheel with 1 ms ticks, so scheduling and executing an action costs constant time, independent of the number of pending actions.
+* One thread sleeps on a timerfd until the next action is due. All actions which are due in the same tick on the same board are applied with one port write (gnublin_module_relay::setRelays()).
+* The delay between due time and execution (jitter) is recorded.
+* Relays deferred by the minimum on/off time of a board (gnublin_module_relay::setMinTime()) are flushed by the thread as soon as they may switch.
+* While the scheduler runs, the boards must not be used from other threads.
+* @~german
+* @brief Führt geplante Relay Aktionen vieler Relay Boards in einem Thread aus
+*
+* Die anstehenden Aktionen liegen in einem hierarchischen Timer Wheel mit 1 ms Ticks, Planen und Ausführen einer Aktion kostet also konstante Zeit, unabhängig von der Anzahl anstehender Aktionen.
+* Ein Thread schläft auf einem timerfd, bis die nächste Aktion fällig ist. Alle Aktionen, die im selben Tick auf demselben Board fällig sind, werden mit einem Schreibzugriff auf den Port ausgeführt (gnublin_module_relay::setRelays()).
+* Die Verzögerung zwischen Fälligkeit und Ausführung (Jitter) wird aufgezeichnet.
+* Relays, die wegen der Mindestzeit eines Boards (gnublin_module_relay::setMinTime()) zurückgestellt wurden, schreibt der Thread, sobald sie schalten dürfen.
+* Während der Scheduler läuft, dürfen die Boards nicht von anderen Threads verwendet werden.
+*/
+class gnublin_relay_scheduler {
+	public:
+		gnublin_relay_scheduler();
+		gnublin_relay_scheduler(int actions);
+		~gnublin_relay_scheduler();
+		int addBoard(gnublin_module_relay *relay);
+		int schedule(int board, int relay, int value, unsigned int delay_ms);
+		int scheduleAt(int board, int relay, int value, unsigned long long time);
+		int pulse(int board, int relay, unsigned int duration_ms, unsigned int delay_ms);
+		int cancel(int board, int relay);
+		int start();
+		void stop();
+		int pending();
+		unsigned int getExecuted();
+		unsigned int getWrites();
+		unsigned int getErrors();
+		unsigned int getMaxJitter();
+		unsigned int getAverageJitter();
+		void resetStatistics();
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		struct relay_action {
+			unsigned long long due;		// µs, CLOCK_MONOTONIC
+			unsigned long long expires;	// tick
+			int board;
+			unsigned char mask;
+			unsigned char value;
+			unsigned int epoch;
+			int next;
+		};
+		gnublin_relay_scheduler(const gnublin_relay_scheduler &);
+		gnublin_relay_scheduler &operator=(const gnublin_relay_scheduler &);
+		void init(int actions);
+		static void *run(void *arg);
+		void insert(int action);
+		void append(int *head, int *tail, int action);
+		void cascade(int level, int slot);
+		void advance(unsigned long long tick, int *fired_head, int *fired_tail);
+		void arm(unsigned long long tick);
+		void rearm();
+		relay_action *actions;
+		int action_count;
+		int free_list;
+		int used;
+		int heads[RELAY_WHEEL_LEVELS][RELAY_WHEEL_SLOTS];
+		int tails[RELAY_WHEEL_LEVELS][RELAY_WHEEL_SLOTS];
+		unsigned long long current_tick;
+		unsigned long long armed_tick;
+		unsigned long long flush_tick;	// next deferred relay of a board, 0: none
+		gnublin_module_relay *boards[RELAY_SCHEDULER_MAX_BOARDS];
+		unsigned int epochs[RELAY_SCHEDULER_MAX_BOARDS][8];
+		int board_count;
+		unsigned int executed;
+		unsigned int writes;
+		unsigned int errors;
+		unsigned long long jitter_sum;
+		unsigned int jitter_max;
+		int timer_fd;
+		pthread_mutex_t mutex;
+		pthread_t thread;
+		volatile bool run_flag;
+		bool error_flag;
+		std::string ErrorMessage;
+};
+/**
+* @struct gnublin_step_status
+* @~english
+* @brief Decoded GetFullStatus1 and GetFullStatus2 frames of a TMC222
+*
+* @~german
+* @brief Dekodierte GetFullStatus1 und GetFullStatus2 Antworten eines TMC222
+*/
+struct gnublin_step_status {
+	unsigned long long timestamp;	// µs, CLOCK_MONOTONIC
+	// GetFullStatus2
+	int position;			// actual position, signed 16 bit
+	int target;			// target position, signed 16 bit
+	// GetFullStatus1
+	int motion;			// see gnublin_module_step::getMotionStatus()
+	bool switch_closed;		// ESW
+	unsigned char irun;
+	unsigned char ihold;
+	unsigned char vmax;
+	unsigned char vmin;
+	unsigned char acc;
+	unsigned char step_mode;
+	bool acc_shape;
+	bool shaft;
+	bool vdd_reset;
+	bool step_loss;
+	bool electrical_defect;
+	bool under_voltage;
+	bool overcurrent;		// OVC1 or OVC2
+	bool charge_pump_failure;
+	bool thermal_shutdown;		// TSD
+	bool thermal_warning;		// TW
+	unsigned char temp_info;	// Tinfo 0-3
+};
+
+int stepVelocity(unsigned int vmax);
+
 /**
 * @class gnublin_module_step
 * @~english
 * @brief Class for accessing GNUBLIN module-step
 *
 * The GNUBLIN Module-step can be easily controlled with the gnublin_step API. The Module uses the I2C-Bus.
+* getMotionStatus(), getSwitch() and getActualPosition() read a status snapshot, which is taken with one GetFullStatus1 and one GetFullStatus2 in one bus transaction.
+* With setStatusMaxAge() a snapshot is reused for some time, so several accessors called back to back cost one bus transaction.
 * @~german 
 * @brief Klasse für den zugriff auf das GNUBLIN module-step
 *
 * Das GNUBLIN module-step lässt sich mit Hilfe der gnublin_step API ganz einfach ansteuern. Das Modul nutzt die I2C-Schnittstelle.  
+* getMotionStatus(), getSwitch() und getActualPosition() lesen aus einer Status Momentaufnahme, die mit einem GetFullStatus1 und einem GetFullStatus2 in einer Bus Transaktion erstellt wird.
+* Mit setStatusMaxAge() wird eine Momentaufnahme eine Zeit lang wiederverwendet, so dass mehrere direkt nacheinander aufgerufene Abfragen eine Bus Transaktion kosten.
 */ 
 class gnublin_module_step {
 	gnublin_i2c i2c;
@@ -386,10 +1306,21 @@ class gnublin_module_step {
 	unsigned int ihold;
 	unsigned int vmax;
 	unsigned int vmin;
+	bool error_flag;
 	std::string ErrorMessage;
+	gnublin_step_status status;
+	bool status_valid;
+	unsigned long long status_max_age;
+	pthread_mutex_t lock;		// guards the snapshot and the error state, serialises status reads and position commands
+	gnublin_module_step(const gnublin_module_step &);
+	gnublin_module_step &operator=(const gnublin_module_step &);
+	int refreshStatus(gnublin_step_status *status);
+	int readStatus();
 public:
 	gnublin_module_step();
+	~gnublin_module_step();
 	void setAddress(int Address);
+	int getAddress();
 	void setDevicefile(std::string filename);
 	bool fail();
 	int setIrun(unsigned int newIrun);
@@ -412,8 +1343,388 @@ public:
 	int getActualPosition();
 	int drive(int steps);
 	int getMotionStatus();
+	int updateStatus();
+	int updateStatus(gnublin_step_status *status);
+	int getStatus(gnublin_step_status *status);
+	void setStatusMaxAge(unsigned int ms);
+	void discardStatus();
+	int buildSetMotorParam(unsigned char *buffer);
+	int buildSetMotorParam(unsigned char *buffer, unsigned int vmax);
+	int buildSetPosition(unsigned char *buffer, int position);
+	int transfer(struct i2c_msg *msgs, int count);
 	const char *getErrorMessage();
 };
+//***** NEW BLOCK *****
+
+#define STEP_POLLER_MAX_MOTORS	16
+#define STEP_POLLER_MIN_INTERVAL	2	// ms
+#define STEP_POLLER_MAX_INTERVAL	100	// ms
+
+//****************************************************************************
+// Class for waiting on the motion of several GNUBLIN Module-steps
+//****************************************************************************
+/**
+* @class gnublin_step_poller
+* @~english
+* @brief Starts moves of several gnublin_module_step and watches them with one thread
+*
+* setPosition() and drive() return a handle, which is completed when the motor stands still at its target.
+* One thread polls all moving motors with one status read each. The interval adapts to the remaining distance and velocity:
+* slow while the motor is far away from its target, fast shortly before it arrives.
+* Completed moves can also be delivered as EVENT_MOTION_DONE events.
+* While a motor is moving, it must only be used through the poller.
+* @~german
+* @brief Startet Bewegungen mehrerer gnublin_module_step und überwacht sie mit einem Thread
+*
+* setPosition() und drive() geben ein Handle zurück, das abgeschlossen ist, wenn der Motor an seinem Ziel steht.
+* Ein Thread fragt alle fahrenden Motoren mit je einem Status Lesezugriff ab. Der Abstand passt sich der restlichen Strecke und der Geschwindigkeit an:
+* langsam, solange der Motor weit vom Ziel entfernt ist, schnell kurz bevor er ankommt.
+* Abgeschlossene Bewegungen können auch als EVENT_MOTION_DONE Ereignisse geliefert werden.
+* Während ein Motor fährt, darf er nur über den Poller verwendet werden.
+*/
+class gnublin_step_poller {
+	public:
+		gnublin_step_poller();
+		~gnublin_step_poller();
+		int addMotor(gnublin_module_step *motor);
+		int setPosition(int motor, int position);
+		int drive(int motor, int steps);
+		int watch(int motor, int target);
+		int done(int handle);
+		int wait(int handle, int timeout_ms);
+		int wait(const int *handles, int count, int timeout_ms);
+		int waitAll(int timeout_ms);
+		int getPosition(int motor);
+		void setEventQueue(gnublin_event_queue *queue);
+		int setInterval(int min_ms, int max_ms);
+		unsigned int getPolls();
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		struct motor_state {
+			gnublin_module_step *motor;
+			unsigned int issued;		// sequence number of the last move
+			unsigned int completed;		// moves up to this number are done
+			int result;			// of the last completion, 1 or -1
+			int position;			// of the last status read
+			unsigned int velocity;		// steps per second of the last status read
+			unsigned long long next_poll;	// µs, CLOCK_MONOTONIC
+		};
+		gnublin_step_poller(const gnublin_step_poller &);
+		gnublin_step_poller &operator=(const gnublin_step_poller &);
+		static void *run(void *arg);
+		int start(int motor, int value, bool relative);
+		int issue(int motor, int distance);
+		bool poll(int motor, unsigned long long now, gnublin_event *event);
+		unsigned long long interval(int motor, int remaining);
+		int check(int handle);
+		bool deadline(int timeout_ms, struct timespec *time);
+		motor_state motors[STEP_POLLER_MAX_MOTORS];
+		int motor_count;
+		gnublin_event_queue *queue;
+		unsigned long long min_interval;
+		unsigned long long max_interval;
+		unsigned int polls;
+		pthread_mutex_t mutex;
+		pthread_cond_t work;
+		pthread_cond_t completion;
+		pthread_t thread;
+		bool thread_started;
+		bool run_flag;
+		bool error_flag;
+		std::string ErrorMessage;
+};
+//***** NEW BLOCK *****
+
+#define STEP_HOMING_MAX_AXES		8
+#define STEP_HOMING_MIN_INTERVAL	1	// ms
+#define STEP_HOMING_MAX_INTERVAL	50	// ms
+#define STEP_HOMING_CHUNK		30000	// steps of one SetPosition of the fast approach
+
+//****************************************************************************
+// Class for homing GNUBLIN Module-steps at their end switch
+//****************************************************************************
+/**
+* @class gnublin_step_homing
+* @~english
+* @brief Drives several gnublin_module_step to their end switch at the same time
+*
+* Every axis approaches its switch fast, backs off until the switch opens and approaches it again slowly. At the switch the motor is stopped with HardStop, so it does not overshoot while ramping down.
+* The fast approach is split into moves of 30000 steps, so the travel is not limited by the 16 bit position of the TMC222.
+* The position where the switch closes during the slow approach becomes position 0.
+* All axes are handled in parallel by one loop, every poll is one status read (see gnublin_module_step::updateStatus()).
+* The interval between two polls of an axis adapts to its velocity and distance: during the fast approach the motor moves at most half of the back off distance between two polls,
+* during the slow approach it is polled with the shortest interval.
+* @~german
+* @brief Fährt mehrere gnublin_module_step gleichzeitig an ihren Endschalter
+*
+* Jede Achse fährt schnell an ihren Schalter, fährt zurück, bis der Schalter öffnet, und fährt ihn langsam erneut an. Am Schalter wird der Motor mit HardStop angehalten, damit er beim Abbremsen nicht über den Schalter hinaus fährt.
+* Die schnelle Anfahrt wird in Bewegungen von 30000 Schritten aufgeteilt, der Fahrweg ist also nicht durch die 16 Bit Position des TMC222 begrenzt.
+* Die Position, an der der Schalter bei der langsamen Anfahrt schließt, wird Position 0.
+* Alle Achsen werden parallel in einer Schleife bearbeitet, jede Abfrage ist ein Status Lesezugriff (siehe gnublin_module_step::updateStatus()).
+* Der Abstand zwischen zwei Abfragen einer Achse passt sich ihrer Geschwindigkeit und Strecke an: bei der schnellen Anfahrt fährt der Motor zwischen zwei Abfragen höchstens die Hälfte der Rückfahrstrecke,
+* bei der langsamen Anfahrt wird er mit dem kürzesten Abstand abgefragt.
+*/
+class gnublin_step_homing {
+	public:
+		gnublin_step_homing();
+		int addAxis(gnublin_module_step *motor, int direction);
+		int setVmax(unsigned int fast, unsigned int slow);
+		int setBackoff(int steps);
+		int setTravel(int steps);
+		int setInterval(int min_ms, int max_ms);
+		int run(int timeout_ms);
+		void cancel();
+		int getTime(int axis);
+		unsigned int getPolls();
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		enum homing_phase {
+			HOMING_FAST,		// approaching the switch
+			HOMING_FAST_STOP,	// stopping after the switch closed
+			HOMING_BACKOFF,		// moving away until the switch opens
+			HOMING_SLOW,		// approaching the switch again
+			HOMING_SLOW_STOP,	// stopping after the switch closed again
+			HOMING_DONE,
+			HOMING_FAILED
+		};
+		struct homing_axis {
+			gnublin_module_step *motor;
+			int direction;			// 1 or -1
+			homing_phase phase;
+			unsigned int vmax;		// restored when the axis is homed
+			int travelled;			// steps of the fast approach before the current chunk
+			int chunk;			// steps of the current chunk
+			unsigned long long next_poll;	// µs, CLOCK_MONOTONIC
+			unsigned long long time;	// start time, then µs needed for homing
+		};
+		int begin(int axis, unsigned long long now);
+		int step(int axis, unsigned long long now);
+		int approach(int axis);
+		int failAxis(int axis, const std::string &message);
+		unsigned long long interval(unsigned int velocity, int distance);
+		homing_axis axes[STEP_HOMING_MAX_AXES];
+		int axis_count;
+		unsigned int fast_vmax;
+		unsigned int slow_vmax;
+		int backoff;
+		int travel;
+		unsigned long long min_interval;
+		unsigned long long max_interval;
+		unsigned int polls;
+		volatile sig_atomic_t cancelled;
+		bool error_flag;
+		std::string ErrorMessage;
+};
+//***** NEW BLOCK *****
+
+#define STEP_GROUP_MAX_MOTORS	16
+
+//****************************************************************************
+// Class for sending commands to several GNUBLIN Module-steps at once
+//****************************************************************************
+/**
+* @class gnublin_step_group
+* @~english
+* @brief Sends HardStop, SoftStop and SetMotorParam to several gnublin_module_step in one bus transaction
+*
+* By default the command frames of all motors are sent back to back in one I2C_RDWR transaction, so the bus is opened once and the last motor gets its command about one frame time after the first one.
+* With setBroadcast() a single frame is sent to the general call address 0, which reaches every TMC222 on the bus, also the ones which are not in the group.
+* All motors must be on the same I2C bus.
+* @~german
+* @brief Sendet HardStop, SoftStop und SetMotorParam in einer Bus Transaktion an mehrere gnublin_module_step
+*
+* Standardmäßig werden die Befehls Rahmen aller Motoren direkt hintereinander in einer I2C_RDWR Transaktion gesendet, der Bus wird also einmal geöffnet und der letzte Motor bekommt seinen Befehl etwa eine Rahmenlänge nach dem ersten.
+* Mit setBroadcast() wird ein einziger Rahmen an die General Call Adresse 0 gesendet, der jeden TMC222 am Bus erreicht, auch die, die nicht in der Gruppe sind.
+* Alle Motoren müssen am selben I2C Bus hängen.
+*/
+class gnublin_step_group {
+	public:
+		gnublin_step_group();
+		int addMotor(gnublin_module_step *motor);
+		void setBroadcast(bool broadcast);
+		void setDevicefile(std::string filename);
+		int hardStop();
+		int emergencyStop();
+		int softStop();
+		int setMotorParam();
+		unsigned long long getLatency();
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		int send(unsigned char *frames, int length);
+		gnublin_module_step *motors[STEP_GROUP_MAX_MOTORS];
+		int motor_count;
+		bool broadcast;
+		std::string devicefile;
+		unsigned long long latency;
+		bool error_flag;
+		std::string ErrorMessage;
+};
+//***** NEW BLOCK *****
+
+#define STEP_PLANNER_MAX_AXES	8
+#define STEP_PLANNER_QUEUE	32
+
+//****************************************************************************
+// Class for coordinated moves of several GNUBLIN Module-steps
+//****************************************************************************
+/**
+* @class gnublin_step_planner
+* @~english
+* @brief Linear moves of up to 8 axes, each axis driven by a gnublin_module_step
+*
+* move() queues a segment with the targets of all axes. A thread takes the segments in order:
+* the axis with the longest distance runs with the set Vmax, every other axis gets the Vmax whose velocity matches its share of the distance best, so all axes arrive together.
+* The changed motor parameters and the SetPosition commands of all axes are sent back to back in one bus transaction.
+* The next segment is sent as soon as the status reads show that all axes arrived.
+* All axes must be on the same I2C bus and must only be used through the planner while it has segments.
+* @~german
+* @brief Lineare Bewegungen von bis zu 8 Achsen, jede Achse wird von einem gnublin_module_step angetrieben
+*
+* move() reiht ein Segment mit den Zielen aller Achsen ein. Ein Thread arbeitet die Segmente der Reihe nach ab:
+* die Achse mit der längsten Strecke fährt mit dem eingestellten Vmax, jede andere Achse bekommt das Vmax, dessen Geschwindigkeit am besten zu ihrem Anteil an der Strecke passt, so dass alle Achsen gemeinsam ankommen.
+* Die geänderten Motor Parameter und die SetPosition Befehle aller Achsen werden direkt hintereinander in einer Bus Transaktion gesendet.
+* Das nächste Segment wird gesendet, sobald die Status Abfragen zeigen, dass alle Achsen angekommen sind.
+* Alle Achsen müssen am selben I2C Bus hängen und dürfen nur über den Planer verwendet werden, solange er Segmente hat.
+*/
+class gnublin_step_planner {
+	public:
+		gnublin_step_planner();
+		~gnublin_step_planner();
+		int addAxis(gnublin_module_step *motor);
+		int setVmax(unsigned int vmax);
+		int move(const int *targets);
+		int moveRelative(const int *steps);
+		int wait(int timeout_ms);
+		int pending();
+		int getPosition(int axis);
+		unsigned int getSegments();
+		unsigned int getErrors();
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		struct segment {
+			int target[STEP_PLANNER_MAX_AXES];
+			unsigned int vmax;
+		};
+		gnublin_step_planner(const gnublin_step_planner &);
+		gnublin_step_planner &operator=(const gnublin_step_planner &);
+		static void *run(void *arg);
+		int push(const segment &next);
+		int dispatch(const segment &next, int *handles);
+		gnublin_step_poller poller;
+		gnublin_module_step *axes[STEP_PLANNER_MAX_AXES];
+		int axis_count;
+		int planned[STEP_PLANNER_MAX_AXES];	// end position after all queued segments
+		int current[STEP_PLANNER_MAX_AXES];	// end position after the sent segments
+		int sent_vmax[STEP_PLANNER_MAX_AXES];	// -1: not sent yet
+		unsigned int vmax;
+		segment queue[STEP_PLANNER_QUEUE];
+		int first;
+		int count;
+		bool busy;
+		unsigned int segments;
+		unsigned int errors;
+		std::string thread_error;
+		pthread_mutex_t mutex;
+		pthread_cond_t work;
+		pthread_cond_t space;
+		pthread_t thread;
+		bool thread_started;
+		bool run_flag;
+		bool error_flag;
+		std::string ErrorMessage;
+};
+//***** NEW BLOCK *****
+
+#define GCODE_LINE_MAX		256
+#define GCODE_READ_SIZE		4096
+#define GCODE_LOOKAHEAD		16
+#define GCODE_AXES		4	// X, Y, Z, E
+
+//****************************************************************************
+// Class for running G-code on GNUBLIN Module-steps
+//****************************************************************************
+/**
+* @class gnublin_gcode
+* @~english
+* @brief Streaming G-code interpreter which feeds a gnublin_step_planner
+*
+* Supported are G0/G1 (X, Y, Z, E in mm, F in mm/min), G28 (move to position 0), G20/G21, G90/G91, G92, M104/M109 (heater relay on for S > 0, off for S0) and M2/M30.
+* Other codes are counted and ignored, comments (; and parentheses), line numbers and checksums are skipped.
+* The program is read in blocks from a file or pipe and parsed line by line, so memory use does not depend on the program size.
+* Parsed moves wait in a lookahead queue of 16 moves, where consecutive moves in the same direction with the same feed are merged into one segment.
+* Before the next block is read, all moves except the last one go to the planner, so a streamed program moves while it waits for more input.
+* The heater relay is switched after all moves before it are done.
+* Without a planner, programs are only parsed, e.g. to check them or to measure the parser.
+* @~german
+* @brief Streamender G-code Interpreter, der einen gnublin_step_planner speist
+*
+* Unterstützt werden G0/G1 (X, Y, Z, E in mm, F in mm/min), G28 (fahre auf Position 0), G20/G21, G90/G91, G92, M104/M109 (Heiz-Relay an bei S > 0, aus bei S0) und M2/M30.
+* Andere Befehle werden gezählt und ignoriert, Kommentare (; und Klammern), Zeilennummern und Prüfsummen werden übersprungen.
+* Das Programm wird blockweise aus einer Datei oder Pipe gelesen und zeilenweise ausgewertet, der Speicherbedarf hängt also nicht von der Programmgröße ab.
+* Ausgewertete Bewegungen warten in einer Vorschau-Warteschlange mit 16 Bewegungen, in der aufeinanderfolgende Bewegungen in dieselbe Richtung mit demselben Vorschub zu einem Segment zusammengefasst werden.
+* Bevor der nächste Block gelesen wird, gehen alle Bewegungen außer der letzten an den Planer, ein gestreamtes Programm bewegt sich also, während es auf weitere Eingaben wartet.
+* Das Heiz-Relay wird geschaltet, wenn alle Bewegungen davor fertig sind.
+* Ohne Planer werden Programme nur ausgewertet, z.B. um sie zu prüfen oder den Parser zu messen.
+*/
+class gnublin_gcode {
+	public:
+		gnublin_gcode(gnublin_step_planner *planner);
+		int setAxis(char letter, int axis, double steps_per_mm);
+		int setMicrosteps(int microsteps);
+		int setRapidVmax(unsigned int vmax);
+		void setHeater(gnublin_module_relay *relay, int pin);
+		int run(std::string filename);
+		int run(int fd);
+		unsigned int getLines();
+		unsigned int getMoves();
+		unsigned int getSegments();
+		unsigned int getIgnored();
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		struct gcode_move {
+			int target[STEP_PLANNER_MAX_AXES];
+			int delta[STEP_PLANNER_MAX_AXES];
+			unsigned int vmax;
+		};
+		void reset();
+		int execute(char *line);
+		int queueMove(const double *mm, bool rapid);
+		int flush(int keep);
+		int sync();
+		unsigned int feedToVmax(double distance, int longest);
+		int error(const std::string &message);
+		gnublin_step_planner *planner;
+		gnublin_module_relay *heater;
+		int heater_pin;
+		int axis_map[GCODE_AXES];		// planner axis, -1: not used
+		double steps_per_mm[GCODE_AXES];
+		int microsteps;
+		unsigned int rapid_vmax;
+		// modal state
+		double position[GCODE_AXES];		// mm
+		double offset[GCODE_AXES];		// mm, set by G92
+		double feed;				// mm/min, 0: rapid
+		double unit;				// mm per program unit
+		bool relative;
+		int motion;				// 0 or 1
+		bool stopped;
+		// lookahead
+		int steps[STEP_PLANNER_MAX_AXES];	// planned position of the last queued move
+		gcode_move lookahead[GCODE_LOOKAHEAD];
+		int first;
+		int count;
+		unsigned int line_number;
+		unsigned int moves;
+		unsigned int segments;
+		unsigned int ignored;
+		bool error_flag;
+		std::string ErrorMessage;
+};
 ////////////////////////////////////////////////////////////////////////////////
 //connection on the Portexpander Port 0
 #define LCD_EN			0x04
@@ -30,3 +30,37 @@ int hexstringToNumber(std::string str){
 	
 	return var;
 }
+
+//Converting a buffer wich repesenting a hexnumber to number (without iostreams)
+int hexbufferToNumber(const char *buf, int length){
+	int i = 0;
+	int var = 0;
+	int digits = 0;
+
+	while (i < length && (buf[i] == ' ' || buf[i] == '\t' || buf[i] == '\n'))
+		i++;
+	if (i + 1 < length && buf[i] == '0' && (buf[i+1] == 'x' || buf[i+1] == 'X'))
+		i += 2;
+	for (; i < length; i++, digits++) {
+		char c = buf[i];
+		if (c >= '0' && c <= '9')
+			var = (var << 4) | (c - '0');
+		else if (c >= 'a' && c <= 'f')
+			var = (var << 4) | (c - 'a' + 10);
+		else if (c >= 'A' && c <= 'F')
+			var = (var << 4) | (c - 'A' + 10);
+		else
+			break;
+	}
+	if (digits == 0)
+		return -1;
+	return var;
+}
+
+//Monotonic time in microseconds, used to timestamp samples and events
+unsigned long long getMonotonicTime(){
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
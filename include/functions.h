@@ -1,3 +1,5 @@
 int stringToNumber(std::string str);
 std::string numberToString(int num);
 int hexstringToNumber(std::string str);
+int hexbufferToNumber(const char *buf, int length);
+unsigned long long getMonotonicTime();
@@ -0,0 +1,576 @@
+#include "gcode.h"
+
+//****************************************************************************
+// Class for running G-code on GNUBLIN Module-steps
+//****************************************************************************
+
+static const char gcode_letters[GCODE_AXES] = { 'X', 'Y', 'Z', 'E' };
+
+/** @~english
+* @brief Create an interpreter.
+*
+* X, Y, Z and E are mapped to the planner axes 0-3 with 100 steps per mm.
+* @param planner the planner which executes the moves, NULL: the program is only parsed
+*
+* @~german
+* @brief Erzeugt einen Interpreter.
+*
+* X, Y, Z und E werden auf die Planer Achsen 0-3 mit 100 Schritten pro mm abgebildet.
+* @param planner der Planer, der die Bewegungen ausführt, NULL: das Programm wird nur ausgewertet
+*/
+gnublin_gcode::gnublin_gcode(gnublin_step_planner *planner){
+	this->planner = planner;
+	heater = NULL;
+	heater_pin = 1;
+	for (int i = 0; i < GCODE_AXES; i++) {
+		axis_map[i] = i;
+		steps_per_mm[i] = 100;
+	}
+	microsteps = 2;
+	rapid_vmax = 15;
+	reset();
+	error_flag = false;
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_gcode::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_gcode::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+int gnublin_gcode::error(const std::string &message){
+	ErrorMessage = "line " + numberToString(line_number) + ": " + message + "\n";
+	error_flag = true;
+	return -1;
+}
+
+//-------------setAxis-------------
+/** @~english
+* @brief Map a G-code axis to a planner axis.
+*
+* @param letter X, Y, Z or E
+* @param axis index of the planner axis, -1: moves of this axis are ignored
+* @param steps_per_mm motor positions per mm
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Bildet eine G-code Achse auf eine Planer Achse ab.
+*
+* @param letter X, Y, Z oder E
+* @param axis Index der Planer Achse, -1: Bewegungen dieser Achse werden ignoriert
+* @param steps_per_mm Motor Positionen pro mm
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_gcode::setAxis(char letter, int axis, double steps_per_mm){
+	for (int i = 0; i < GCODE_AXES; i++) {
+		if (gcode_letters[i] != toupper(letter))
+			continue;
+		if (axis < -1 || axis >= STEP_PLANNER_MAX_AXES || steps_per_mm <= 0) {
+			ErrorMessage = "invalid axis or steps per mm\n";
+			error_flag = true;
+			return -1;
+		}
+		axis_map[i] = axis;
+		this->steps_per_mm[i] = steps_per_mm;
+		error_flag = false;
+		return 1;
+	}
+	ErrorMessage = "axis is not X, Y, Z or E\n";
+	error_flag = true;
+	return -1;
+}
+
+//-------------setMicrosteps-------------
+/** @~english
+* @brief Set the motor positions per full step.
+*
+* Used to convert the feed to a Vmax. The default 2 matches the half step mode set by gnublin_module_step::setMotorParam().
+* @param microsteps 2, 4, 8 or 16
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Motor Positionen pro Vollschritt.
+*
+* Wird zur Umrechnung des Vorschubs in ein Vmax verwendet. Der Standardwert 2 entspricht dem Halbschritt Modus, den gnublin_module_step::setMotorParam() einstellt.
+* @param microsteps 2, 4, 8 oder 16
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_gcode::setMicrosteps(int microsteps){
+	if (microsteps != 2 && microsteps != 4 && microsteps != 8 && microsteps != 16) {
+		ErrorMessage = "microsteps is not 2, 4, 8 or 16\n";
+		error_flag = true;
+		return -1;
+	}
+	this->microsteps = microsteps;
+	error_flag = false;
+	return 1;
+}
+
+//-------------setRapidVmax-------------
+/** @~english
+* @brief Set the Vmax of G0 moves, which is also the limit for G1 moves.
+*
+* @param vmax Vmax of the TMC222 (0-15), default 15
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt das Vmax von G0 Bewegungen, das auch die Grenze für G1 Bewegungen ist.
+*
+* @param vmax Vmax des TMC222 (0-15), Standard 15
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_gcode::setRapidVmax(unsigned int vmax){
+	if (vmax > 15) {
+		ErrorMessage = "vmax is not between 0-15\n";
+		error_flag = true;
+		return -1;
+	}
+	rapid_vmax = vmax;
+	error_flag = false;
+	return 1;
+}
+
+//-------------setHeater-------------
+/** @~english
+* @brief Set the relay which is switched by M104 and M109.
+*
+* @param relay the relay board, NULL: M104 and M109 are ignored
+* @param pin number of the relay (1-8)
+*
+* @~german
+* @brief Setzt das Relay, das von M104 und M109 geschaltet wird.
+*
+* @param relay das Relay Board, NULL: M104 und M109 werden ignoriert
+* @param pin Nummer des Relays (1-8)
+*/
+void gnublin_gcode::setHeater(gnublin_module_relay *relay, int pin){
+	heater = relay;
+	heater_pin = pin;
+}
+
+void gnublin_gcode::reset(){
+	for (int i = 0; i < STEP_PLANNER_MAX_AXES; i++)
+		steps[i] = planner ? planner->getPosition(i) : 0;
+	for (int i = 0; i < GCODE_AXES; i++) {
+		position[i] = axis_map[i] < 0 ? 0 : steps[axis_map[i]] / steps_per_mm[i];
+		offset[i] = 0;
+	}
+	feed = 0;
+	unit = 1;
+	relative = false;
+	motion = 0;
+	stopped = false;
+	first = 0;
+	count = 0;
+	line_number = 0;
+	moves = 0;
+	segments = 0;
+	ignored = 0;
+}
+
+//-------------run-------------
+/** @~english
+* @brief Run a G-code program and wait until all moves are done.
+*
+* @param filename path of the program, "-" reads from stdin
+* @return success: 1, failure: -1 (the error message contains the line number)
+*
+* @~german
+* @brief Führt ein G-code Programm aus und wartet, bis alle Bewegungen fertig sind.
+*
+* @param filename Pfad des Programms, "-" liest von stdin
+* @return Erfolg: 1, Fehler: -1 (die Fehlermeldung enthält die Zeilennummer)
+*/
+int gnublin_gcode::run(std::string filename){
+	int fd, result;
+
+	if (filename == "-")
+		return run(0);
+	if ((fd = open(filename.c_str(), O_RDONLY)) < 0) {
+		ErrorMessage = "ERROR opening: " + filename + "\n";
+		error_flag = true;
+		return -1;
+	}
+	result = run(fd);
+	close(fd);
+	return result;
+}
+
+/** @~english
+* @brief Run a G-code program from a file descriptor (file, pipe or socket).
+*
+* @param fd the file descriptor, it is read until end of file
+* @return success: 1, failure: -1 (the error message contains the line number)
+*
+* @~german
+* @brief Führt ein G-code Programm von einem Dateideskriptor aus (Datei, Pipe oder Socket).
+*
+* @param fd der Dateideskriptor, er wird bis zum Dateiende gelesen
+* @return Erfolg: 1, Fehler: -1 (die Fehlermeldung enthält die Zeilennummer)
+*/
+int gnublin_gcode::run(int fd){
+	char buffer[GCODE_READ_SIZE];
+	char line[GCODE_LINE_MAX];
+	int length = 0;
+	bool too_long = false;
+	ssize_t n;
+
+	reset();
+	error_flag = false;
+	while (!stopped) {
+		// the read blocks on a pipe until the next block arrives, meanwhile the planner works off all
+		// queued moves except the last one, which may still be merged with the next move
+		if (flush(1) < 0)
+			return -1;
+		n = read(fd, buffer, sizeof(buffer));
+		if (n == 0)
+			break;
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return error("read failed");
+		}
+		for (ssize_t i = 0; i < n && !stopped; i++) {
+			if (buffer[i] != '\n') {
+				if (length < GCODE_LINE_MAX - 1)
+					line[length++] = buffer[i];
+				else
+					too_long = true;
+				continue;
+			}
+			line_number++;
+			if (too_long)
+				return error("line is longer than " + numberToString(GCODE_LINE_MAX - 1) + " characters");
+			line[length] = 0;
+			if (execute(line) < 0)
+				return -1;
+			length = 0;
+		}
+	}
+	if (length && !stopped) {
+		line_number++;
+		if (too_long)
+			return error("line is longer than " + numberToString(GCODE_LINE_MAX - 1) + " characters");
+		line[length] = 0;
+		if (execute(line) < 0)
+			return -1;
+	}
+	return sync();
+}
+
+// parses and executes one line
+int gnublin_gcode::execute(char *line){
+	double value[26];
+	bool has[26];
+	double g[4];
+	int g_count = 0;
+	char missing = 0;
+	bool home = false, set_position = false, axis_word = false;
+	char *p = line;
+
+	memset(has, 0, sizeof(has));
+	while (*p) {
+		char c = *p;
+		char *end;
+		int letter;
+
+		if (c == ';' || c == '*')
+			break;
+		if (c == '(') {
+			while (*p && *p != ')')
+				p++;
+			if (*p)
+				p++;
+			continue;
+		}
+		if (c == ' ' || c == '\t' || c == '\r') {
+			p++;
+			continue;
+		}
+		if (!isalpha(c))
+			return error(std::string("unexpected character '") + c + "'");
+		letter = toupper(c) - 'A';
+		value[letter] = strtod(++p, &end);
+		// axis words without a number are only allowed with G28, which is known after the line
+		if (end == p && !missing)
+			missing = toupper(c);
+		p = end;
+		if (letter == 'G' - 'A') {
+			if (g_count == 4)
+				return error("more than 4 G words");
+			g[g_count++] = value[letter];
+		}
+		else
+			has[letter] = true;
+		// the rest of M117 is a message for the display
+		if (letter == 'M' - 'A' && (int)value[letter] == 117)
+			break;
+	}
+
+	for (int i = 0; i < g_count; i++) {
+		switch ((int)g[i]) {
+			case 0:
+			case 1:  motion = (int)g[i]; break;
+			case 20: unit = 25.4; break;
+			case 21: unit = 1; break;
+			case 28: home = true; break;
+			case 90: relative = false; break;
+			case 91: relative = true; break;
+			case 92: set_position = true; break;
+			default: ignored++; break;
+		}
+	}
+	// G28 X Y selects axes, everywhere else a missing number is an error
+	if (missing && !(home && strchr("XYZE", missing)))
+		return error(std::string("missing number after ") + missing);
+	if (has['F' - 'A'])
+		feed = value['F' - 'A'] * unit;
+	for (int i = 0; i < GCODE_AXES; i++)
+		axis_word |= has[gcode_letters[i] - 'A'];
+
+	if (home) {
+		double target[GCODE_AXES];
+
+		// G28 without axes homes all axes
+		for (int i = 0; i < GCODE_AXES; i++) {
+			bool selected = !axis_word || has[gcode_letters[i] - 'A'];
+
+			target[i] = selected ? 0 : position[i] + offset[i];
+			if (selected)
+				offset[i] = 0;
+		}
+		if (queueMove(target, true) < 0)
+			return -1;
+		for (int i = 0; i < GCODE_AXES; i++)
+			position[i] = target[i] - offset[i];
+	}
+	else if (set_position) {
+		for (int i = 0; i < GCODE_AXES; i++) {
+			if (!has[gcode_letters[i] - 'A'])
+				continue;
+			offset[i] += position[i] - value[gcode_letters[i] - 'A'] * unit;
+			position[i] = value[gcode_letters[i] - 'A'] * unit;
+		}
+	}
+	else if (axis_word) {
+		double target[GCODE_AXES];
+
+		for (int i = 0; i < GCODE_AXES; i++) {
+			double v = value[gcode_letters[i] - 'A'] * unit;
+
+			if (has[gcode_letters[i] - 'A'])
+				position[i] = relative ? position[i] + v : v;
+			target[i] = position[i] + offset[i];
+		}
+		if (queueMove(target, motion == 0) < 0)
+			return -1;
+	}
+
+	if (has['M' - 'A']) {
+		switch ((int)value['M' - 'A']) {
+			case 104:
+			case 109:
+				if (!heater) {
+					ignored++;
+					break;
+				}
+				if (sync() < 0)
+					return -1;
+				if (heater->switchPin(heater_pin, has['S' - 'A'] && value['S' - 'A'] > 0 ? 1 : 0) < 0)
+					return error(heater->getErrorMessage());
+				break;
+			case 2:
+			case 30:
+				stopped = true;
+				break;
+			default:
+				ignored++;
+				break;
+		}
+	}
+	return 1;
+}
+
+// Vmax for the feed: the fastest velocity of the longest axis which does not exceed the feed
+unsigned int gnublin_gcode::feedToVmax(double distance, int longest){
+	double full_steps;
+	unsigned int vmax = 0;
+
+	if (feed <= 0 || distance <= 0)
+		return rapid_vmax;
+	full_steps = longest * (feed / 60) / distance / microsteps;
+	while (vmax < rapid_vmax && stepVelocity(vmax + 1) <= full_steps)
+		vmax++;
+	return vmax;
+}
+
+// converts a move to motor positions and merges it with the last queued move if it continues in the same direction
+int gnublin_gcode::queueMove(const double *mm, bool rapid){
+	gcode_move next;
+	double distance = 0;
+	int longest = 0;
+	bool moving = false;
+
+	for (int i = 0; i < STEP_PLANNER_MAX_AXES; i++) {
+		next.target[i] = steps[i];
+		next.delta[i] = 0;
+	}
+	for (int i = 0; i < GCODE_AXES; i++) {
+		int axis = axis_map[i];
+		double from, to;
+
+		if (axis < 0)
+			continue;
+		from = steps[axis] / steps_per_mm[i];
+		to = mm[i];
+		distance += (to - from) * (to - from);
+		next.target[axis] = (int)floor(to * steps_per_mm[i] + 0.5);
+		next.delta[axis] = next.target[axis] - steps[axis];
+		if (next.delta[axis]) {
+			moving = true;
+			if (abs(next.delta[axis]) > longest)
+				longest = abs(next.delta[axis]);
+		}
+	}
+	if (!moving)
+		return 1;
+	moves++;
+	next.vmax = rapid ? rapid_vmax : feedToVmax(sqrt(distance), longest);
+	for (int i = 0; i < STEP_PLANNER_MAX_AXES; i++)
+		steps[i] = next.target[i];
+
+	if (count) {
+		gcode_move *last = &lookahead[(first + count - 1) % GCODE_LOOKAHEAD];
+		bool same = last->vmax == next.vmax;
+		long long dot = 0;
+
+		// same direction: all 2x2 cross products are 0 and the dot product is positive
+		for (int i = 0; i < STEP_PLANNER_MAX_AXES && same; i++) {
+			dot += (long long)last->delta[i] * next.delta[i];
+			for (int j = i + 1; j < STEP_PLANNER_MAX_AXES && same; j++)
+				same = (long long)last->delta[i] * next.delta[j] == (long long)last->delta[j] * next.delta[i];
+		}
+		if (same && dot > 0) {
+			for (int i = 0; i < STEP_PLANNER_MAX_AXES; i++) {
+				last->target[i] = next.target[i];
+				last->delta[i] += next.delta[i];
+			}
+			return 1;
+		}
+	}
+	if (count == GCODE_LOOKAHEAD && flush(GCODE_LOOKAHEAD - 1) < 0)
+		return -1;
+	lookahead[(first + count) % GCODE_LOOKAHEAD] = next;
+	count++;
+	return 1;
+}
+
+// sends queued moves to the planner until only keep moves are left
+int gnublin_gcode::flush(int keep){
+	while (count > keep) {
+		gcode_move *next = &lookahead[first];
+
+		if (planner) {
+			if (planner->setVmax(next->vmax) < 0 || planner->move(next->target) < 0)
+				return error(planner->getErrorMessage());
+		}
+		segments++;
+		first = (first + 1) % GCODE_LOOKAHEAD;
+		count--;
+	}
+	return 1;
+}
+
+// sends all queued moves and waits until they are done
+int gnublin_gcode::sync(){
+	if (flush(0) < 0)
+		return -1;
+	if (planner && planner->wait(-1) < 0)
+		return error(planner->getErrorMessage());
+	return 1;
+}
+
+//-------------statistics-------------
+/** @~english
+* @brief Number of lines of the last program.
+*
+* @return number of lines
+*
+* @~german
+* @brief Anzahl der Zeilen des letzten Programms.
+*
+* @return Anzahl der Zeilen
+*/
+unsigned int gnublin_gcode::getLines(){
+	return line_number;
+}
+
+/** @~english
+* @brief Number of moves of the last program.
+*
+* @return number of moves
+*
+* @~german
+* @brief Anzahl der Bewegungen des letzten Programms.
+*
+* @return Anzahl der Bewegungen
+*/
+unsigned int gnublin_gcode::getMoves(){
+	return moves;
+}
+
+/** @~english
+* @brief Number of segments sent to the planner, merged moves count once.
+*
+* @return number of segments
+*
+* @~german
+* @brief Anzahl der an den Planer gesendeten Segmente, zusammengefasste Bewegungen zählen einmal.
+*
+* @return Anzahl der Segmente
+*/
+unsigned int gnublin_gcode::getSegments(){
+	return segments;
+}
+
+/** @~english
+* @brief Number of ignored G and M codes of the last program.
+*
+* @return number of codes
+*
+* @~german
+* @brief Anzahl der ignorierten G und M Befehle des letzten Programms.
+*
+* @return Anzahl der Befehle
+*/
+unsigned int gnublin_gcode::getIgnored(){
+	return ignored;
+}
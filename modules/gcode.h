@@ -0,0 +1,90 @@
+#include "../include/includes.h"
+#include "module_relay.h"
+#include "step_planner.h"
+
+#define GCODE_LINE_MAX		256
+#define GCODE_READ_SIZE		4096
+#define GCODE_LOOKAHEAD		16
+#define GCODE_AXES		4	// X, Y, Z, E
+
+//****************************************************************************
+// Class for running G-code on GNUBLIN Module-steps
+//****************************************************************************
+/**
+* @class gnublin_gcode
+* @~english
+* @brief Streaming G-code interpreter which feeds a gnublin_step_planner
+*
+* Supported are G0/G1 (X, Y, Z, E in mm, F in mm/min), G28 (move to position 0), G20/G21, G90/G91, G92, M104/M109 (heater relay on for S > 0, off for S0) and M2/M30.
+* Other codes are counted and ignored, comments (; and parentheses), line numbers and checksums are skipped.
+* The program is read in blocks from a file or pipe and parsed line by line, so memory use does not depend on the program size.
+* Parsed moves wait in a lookahead queue of 16 moves, where consecutive moves in the same direction with the same feed are merged into one segment.
+* Before the next block is read, all moves except the last one go to the planner, so a streamed program moves while it waits for more input.
+* The heater relay is switched after all moves before it are done.
+* Without a planner, programs are only parsed, e.g. to check them or to measure the parser.
+* @~german
+* @brief Streamender G-code Interpreter, der einen gnublin_step_planner speist
+*
+* Unterstützt werden G0/G1 (X, Y, Z, E in mm, F in mm/min), G28 (fahre auf Position 0), G20/G21, G90/G91, G92, M104/M109 (Heiz-Relay an bei S > 0, aus bei S0) und M2/M30.
+* Andere Befehle werden gezählt und ignoriert, Kommentare (; und Klammern), Zeilennummern und Prüfsummen werden übersprungen.
+* Das Programm wird blockweise aus einer Datei oder Pipe gelesen und zeilenweise ausgewertet, der Speicherbedarf hängt also nicht von der Programmgröße ab.
+* Ausgewertete Bewegungen warten in einer Vorschau-Warteschlange mit 16 Bewegungen, in der aufeinanderfolgende Bewegungen in dieselbe Richtung mit demselben Vorschub zu einem Segment zusammengefasst werden.
+* Bevor der nächste Block gelesen wird, gehen alle Bewegungen außer der letzten an den Planer, ein gestreamtes Programm bewegt sich also, während es auf weitere Eingaben wartet.
+* Das Heiz-Relay wird geschaltet, wenn alle Bewegungen davor fertig sind.
+* Ohne Planer werden Programme nur ausgewertet, z.B. um sie zu prüfen oder den Parser zu messen.
+*/
+class gnublin_gcode {
+	public:
+		gnublin_gcode(gnublin_step_planner *planner);
+		int setAxis(char letter, int axis, double steps_per_mm);
+		int setMicrosteps(int microsteps);
+		int setRapidVmax(unsigned int vmax);
+		void setHeater(gnublin_module_relay *relay, int pin);
+		int run(std::string filename);
+		int run(int fd);
+		unsigned int getLines();
+		unsigned int getMoves();
+		unsigned int getSegments();
+		unsigned int getIgnored();
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		struct gcode_move {
+			int target[STEP_PLANNER_MAX_AXES];
+			int delta[STEP_PLANNER_MAX_AXES];
+			unsigned int vmax;
+		};
+		void reset();
+		int execute(char *line);
+		int queueMove(const double *mm, bool rapid);
+		int flush(int keep);
+		int sync();
+		unsigned int feedToVmax(double distance, int longest);
+		int error(const std::string &message);
+		gnublin_step_planner *planner;
+		gnublin_module_relay *heater;
+		int heater_pin;
+		int axis_map[GCODE_AXES];		// planner axis, -1: not used
+		double steps_per_mm[GCODE_AXES];
+		int microsteps;
+		unsigned int rapid_vmax;
+		// modal state
+		double position[GCODE_AXES];		// mm
+		double offset[GCODE_AXES];		// mm, set by G92
+		double feed;				// mm/min, 0: rapid
+		double unit;				// mm per program unit
+		bool relative;
+		int motion;				// 0 or 1
+		bool stopped;
+		// lookahead
+		int steps[STEP_PLANNER_MAX_AXES];	// planned position of the last queued move
+		gcode_move lookahead[GCODE_LOOKAHEAD];
+		int first;
+		int count;
+		unsigned int line_number;
+		unsigned int moves;
+		unsigned int segments;
+		unsigned int ignored;
+		bool error_flag;
+		std::string ErrorMessage;
+};
@@ -1,5 +1,10 @@
 #include "module_adc.h"
 
+// ADS7830 command byte: SD C2 C1 C0 PD1 PD0 X X, single ended channels 1-8.
+// The power down bits are or'ed in: 0x07 extern reference, 0x0F intern reference.
+static const unsigned char module_adc_commands[MODULE_ADC_CHANNELS] = {
+	0x80, 0xC0, 0x90, 0xD0, 0xA0, 0xE0, 0xB0, 0xF0
+};
 
 //*****************************************************************************
 // Class for accesing GNUBLIN Module-ADC / ADS7830
@@ -16,9 +21,8 @@
 *
 * Standard I2C Addresse: 0x48
 */
-gnublin_module_adc::gnublin_module_adc() {
+gnublin_module_adc::gnublin_module_adc() : calibration(255, 2500) {
 	i2c.setAddress(0x48);
-	referenceValue = 2500;
 	reference_flag = IN;
 	error_flag = false;
 }
@@ -122,22 +126,24 @@ int gnublin_module_adc::setDevicefile(std::string filename) {
 * @~english
 * @brief Set the reverencevoltage to intern or extern
 *
+* This overrides the references loaded with loadCalibration().
 * @param value IN (1) for intern (2.5V), OUT (0) for extern (3.3V)
 * @return 1 by success, -1 by failure
 *
 * @~german
 * @brief Setzt die referenzspannung auf intern oder extern.
 *
+* Dies überschreibt die mit loadCalibration() geladenen Referenzen.
 * @param value IN (1) für intern (2,5V), OUT (0) für extern (3,3V)
 * @return 1 bei Erfolg, -1 im Fehlerfall
 */
 int gnublin_module_adc::setReference(int value) {
 	if (value == 0) {
-		referenceValue = 3300;
+		calibration.setReference(3300);
 		reference_flag = 0;
 	}
 	else if (value == 1) {
-		referenceValue = 2500;
+		calibration.setReference(2500);
 		reference_flag = 1;
 	}
 	else {
@@ -165,49 +171,11 @@ int gnublin_module_adc::setReference(int value) {
 * @return Wert
 */
 int gnublin_module_adc::getValue(int channel) {
-	int command;
-	unsigned char value[1];
-	
-	if (reference_flag == 0){
-		switch (channel) {
-			case 1: command = 0x87; break;
-			case 2: command = 0xC7; break;
-			case 3: command = 0x97; break;
-			case 4: command = 0xD7; break;
-			case 5: command = 0xA7; break;
-			case 6: command = 0xE7; break;
-			case 7: command = 0xB7; break;
-			case 8: command = 0xF7; break;
-			default: error_flag = true; return -1; break;
-		}
-	}
-	else {
-		switch (channel) {
-			case 1: command = 0x8F; break;
-			case 2: command = 0xCF; break;
-			case 3: command = 0x9F; break;
-			case 4: command = 0xDF; break;
-			case 5: command = 0xAF; break;
-			case 6: command = 0xEF; break;
-			case 7: command = 0xBF; break;
-			case 8: command = 0xFF; break;
-			default: error_flag = true; return -1; break;
-		}
-	}
-	
-	i2c.send(command);
-	if (i2c.fail()) {
+	if (channel < 1 || channel > MODULE_ADC_CHANNELS) {
 		error_flag = true;
 		return -1;
 	}
-
-	i2c.receive(value, 1);
-	if (i2c.fail()) {
-		error_flag = true;
-		return -1;
-	}
-	error_flag = false;
-	return value[0];	
+	return read(module_adc_commands[channel - 1]);
 }
 
 /**
@@ -244,50 +212,178 @@ int gnublin_module_adc::getValue(int channel) {
 * @return Wert
 */
 int gnublin_module_adc::getValue(int channel1, int channel2) {
-	int command = -1;
-	unsigned char value[1];
-	
-	for (int i = 1; i<9; i += 2 ) {
-		if (channel1 == i && channel2 == (i+1)){
-			switch(i) {
-				case 1: command = 0x00; break;
-				case 3: command = 0x10; break;
-				case 5: command = 0x20; break;
-				case 7: command = 0x30; break;
-			}
-		}
-		if (channel2 == i && channel1 == (i+1)) {
-			switch(i) {
-				case 1: command = 0x40; break;
-				case 3: command = 0x50; break;
-				case 5: command = 0x60; break;
-				case 7: command = 0x70; break;
-			}
-		}
+	// the partner of a channel is the other channel of its pair, 1-2, 3-4, ...
+	if (channel1 < 1 || channel1 > MODULE_ADC_CHANNELS || channel2 != ((channel1 - 1) ^ 1) + 1) {
+		error_flag = true;
+		return -1;
 	}
-	if (command == -1){
+	// the differential command is the single ended one of channel1 without the SD bit
+	return read(module_adc_commands[channel1 - 1] & 0x7F);
+}
+
+/**
+* @~english
+* @brief Get a value of a channel described at compile time
+*
+* e.g. getValue(gnublin_adc_single_ended<3>()) or getValue(gnublin_adc_differential<2, 1>())<br>
+* The command byte is computed by the compiler, invalid channels and pairs don't compile.
+* @param channel channel descriptor
+* @return value
+*
+* @~german
+* @brief Liefert den Wert eines zur Übersetzungszeit beschriebenen Kanals
+*
+* z.B. getValue(gnublin_adc_single_ended<3>()) oder getValue(gnublin_adc_differential<2, 1>())<br>
+* Das Kommandobyte wird vom Compiler berechnet, ungültige Kanäle und Paare lassen sich nicht übersetzen.
+* @param channel Kanalbeschreibung
+* @return Wert
+*/
+int gnublin_module_adc::getValue(const gnublin_adc_channel &channel) {
+	return read(channel.command);
+}
+
+// one combined transaction: command byte, repeated start, result
+int gnublin_module_adc::read(int command) {
+	unsigned char buf[2];
+	struct i2c_msg msgs[2];
+
+	buf[0] = command | (reference_flag ? 0x0F : 0x07);
+	msgs[0].addr = i2c.getAddress();
+	msgs[0].flags = 0;
+	msgs[0].len = 1;
+	msgs[0].buf = &buf[0];
+	msgs[1].addr = msgs[0].addr;
+	msgs[1].flags = I2C_M_RD;
+	msgs[1].len = 1;
+	msgs[1].buf = &buf[1];
+	if (i2c.transfer(msgs, 2) < 0) {
+		ErrorMessage = i2c.getErrorMessage();
 		error_flag = true;
 		return -1;
 	}
-	if (reference_flag == 0) {
-		command += 0x7;
+	error_flag = false;
+	return buf[1];
+}
+
+
+//---------------------- scan() -----------------------
+
+/**
+* @~english
+* @brief Read several channels in reference to GND with one I2C transaction
+*
+* For every selected channel the command byte and the read of the result are queued, the whole sequence is executed with one I2C_RDWR call.<br>
+* The value of channel n is stored in values[n-1], values of channels which are not selected are left untouched.
+* @param mask bit n-1 selects channel n, e.g. 0x05 for the channels 1 and 3
+* @param values array with at least 8 elements
+* @return number of channels read, -1 by failure
+*
+* @~german
+* @brief Liest mehrere Kanäle bezogen zu GND mit einer I2C Transaktion
+*
+* Für jeden ausgewählten Kanal werden das Kommandobyte und das Lesen des Ergebnisses eingereiht, die ganze Folge wird mit einem I2C_RDWR Aufruf ausgeführt.<br>
+* Der Wert von Kanal n wird in values[n-1] gespeichert, die Werte nicht ausgewählter Kanäle bleiben unverändert.
+* @param mask Bit n-1 wählt Kanal n aus, z.B. 0x05 für die Kanäle 1 und 3
+* @param values Array mit mindestens 8 Elementen
+* @return Anzahl der gelesenen Kanäle, -1 im Fehlerfall
+*/
+int gnublin_module_adc::scan(int mask, int *values) {
+	unsigned char commands[MODULE_ADC_CHANNELS];
+	unsigned char results[MODULE_ADC_CHANNELS];
+	int selected[MODULE_ADC_CHANNELS];
+	int count = 0;
+
+	if (mask < 1 || mask > 0xFF) {
+		ErrorMessage = "channel mask is not between 0x01-0xFF\n";
+		error_flag = true;
+		return -1;
 	}
-	else {
-		command += 0xF;
+	for (int i = 0; i < MODULE_ADC_CHANNELS; i++) {
+		if (!(mask & (1 << i)))
+			continue;
+		commands[count] = module_adc_commands[i];
+		selected[count] = i;
+		count++;
 	}
-	i2c.send(command);
-	if (i2c.fail()) {
+	if (scanCommands(commands, count, results) < 0)
+		return -1;
+	for (int i = 0; i < count; i++)
+		values[selected[i]] = results[i];
+	return count;
+}
+
+/**
+* @~english
+* @brief Read all 8 channels in reference to GND with one I2C transaction
+*
+* @param values array with at least 8 elements, the value of channel n is stored in values[n-1]
+* @return 8, -1 by failure
+*
+* @~german
+* @brief Liest alle 8 Kanäle bezogen zu GND mit einer I2C Transaktion
+*
+* @param values Array mit mindestens 8 Elementen, der Wert von Kanal n wird in values[n-1] gespeichert
+* @return 8, -1 im Fehlerfall
+*/
+int gnublin_module_adc::scanAll(int *values) {
+	return scan(0xFF, values);
+}
+
+/**
+* @~english
+* @brief Read a precomputed scan list with one I2C transaction
+*
+* @param list scan list, see gnublin_adc_scan_list
+* @param values array with at least list.size() elements, the value of the i-th entry is stored in values[i]
+* @return number of values read, -1 by failure
+*
+* @~german
+* @brief Liest eine vorberechnete Scanliste mit einer I2C Transaktion
+*
+* @param list Scanliste, siehe gnublin_adc_scan_list
+* @param values Array mit mindestens list.size() Elementen, der Wert des i-ten Eintrags wird in values[i] gespeichert
+* @return Anzahl der gelesenen Werte, -1 im Fehlerfall
+*/
+int gnublin_module_adc::scan(const gnublin_adc_scan_list &list, int *values) {
+	unsigned char results[MODULE_ADC_SCAN_MAX];
+
+	if (list.count < 1) {
+		ErrorMessage = "scan list is empty\n";
 		error_flag = true;
 		return -1;
 	}
+	if (scanCommands(list.commands, list.count, results) < 0)
+		return -1;
+	for (int i = 0; i < list.count; i++)
+		values[i] = results[i];
+	return list.count;
+}
 
-	i2c.receive(value, 1);
-	if (i2c.fail()) {
+// queue command byte and result read of every command, execute them with one I2C_RDWR call
+int gnublin_module_adc::scanCommands(const unsigned char *commands, int count, unsigned char *results) {
+	struct i2c_msg msgs[2 * MODULE_ADC_SCAN_MAX];
+	unsigned char bytes[MODULE_ADC_SCAN_MAX];
+	int power = reference_flag ? 0x0F : 0x07;
+	int address = i2c.getAddress();
+
+	for (int i = 0; i < count; i++) {
+		bytes[i] = commands[i] | power;
+		msgs[2 * i].addr = address;
+		msgs[2 * i].flags = 0;
+		msgs[2 * i].len = 1;
+		msgs[2 * i].buf = &bytes[i];
+		msgs[2 * i + 1].addr = address;
+		msgs[2 * i + 1].flags = I2C_M_RD;
+		msgs[2 * i + 1].len = 1;
+		msgs[2 * i + 1].buf = &results[i];
+	}
+	if (i2c.transfer(msgs, 2 * count) < 0) {
+		ErrorMessage = i2c.getErrorMessage();
 		error_flag = true;
 		return -1;
 	}
 	error_flag = false;
-	return value[0];
+	return count;
 }
 
 
@@ -299,25 +395,25 @@ int gnublin_module_adc::getValue(int channel1, int channel2) {
 * @~english
 * @brief Get the voltage of an ADC channel in reference to GND in mV
 *
+* The value is converted with the calibration of the channel and rounded to the nearest mV.
 * @param channel Number of the ADC-channel (1-8)
 * @return value in mV
 *
 * @~german
 * @brief Liefert den Wert eine ADC Ports bezogen zu GND in mV
 *
+* Der Wert wird mit der Kalibrierung des Kanals umgerechnet und auf ganze mV gerundet.
 * @param channel Nummer des ADC-Ports (1-8)
 * @return Wert in mV
 */
 int gnublin_module_adc::getVoltage(int channel) {
 	error_flag = false;
-	int voltage;
 	int value = getValue(channel);
 	if (error_flag) {
 		return -1;
 	}
 	
-	voltage = value * referenceValue / 255;
-	return voltage;
+	return calibration.toMillivolt(channel, value);
 }
 
 /**
@@ -355,12 +451,192 @@ int gnublin_module_adc::getVoltage(int channel) {
 */
 int gnublin_module_adc::getVoltage(int channel1, int channel2) {
 	error_flag = false;
-	int voltage;
 	int value = getValue(channel1, channel2);
 	if (error_flag) {
 		return -1;
 	}
 	
-	voltage = value * referenceValue / 255;
-	return voltage;
+	return calibration.toMillivolt(channel1, value);
+}
+
+/**
+* @~english
+* @brief Get the voltage of a channel described at compile time in mV
+*
+* Differential channels use the calibration of their first channel.
+* @param channel channel descriptor, e.g. gnublin_adc_single_ended<3>()
+* @return voltage in mV
+*
+* @~german
+* @brief Liefert die Spannung eines zur Übersetzungszeit beschriebenen Kanals in mV
+*
+* Differentielle Kanäle verwenden die Kalibrierung ihres ersten Kanals.
+* @param channel Kanalbeschreibung, z.B. gnublin_adc_single_ended<3>()
+* @return Wert in mV
+*/
+int gnublin_module_adc::getVoltage(const gnublin_adc_channel &channel) {
+	error_flag = false;
+	int value = getValue(channel);
+	if (error_flag) {
+		return -1;
+	}
+	
+	return calibration.toMillivolt(channel.channel, value);
+}
+
+
+//---------------------- calibration -----------------------
+
+/**
+* @~english
+* @brief Set the calibration of a channel
+*
+* @param channel Number of the ADC-channel (1-8)
+* @param offset offset in LSB, added to the raw value
+* @param gain_ppm gain in parts per million, 1000000 = 1.0
+* @param reference reference voltage in mV
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Setzt die Kalibrierung eines Kanals
+*
+* @param channel Nummer des ADC-Ports (1-8)
+* @param offset Offset in LSB, wird zum Rohwert addiert
+* @param gain_ppm Verstärkung in millionstel, 1000000 = 1,0
+* @param reference Referenzspannung in mV
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_adc::setCalibration(int channel, int offset, int gain_ppm, int reference) {
+	if (calibration.setChannel(channel, offset, gain_ppm, reference) < 0) {
+		ErrorMessage = calibration.getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
+
+/**
+* @~english
+* @brief Load the calibration of the channels from a file
+*
+* Every line contains "channel offset gain reference", e.g. "1 -2 1.0031 2500".
+* @param filename path of the calibration file
+* @return 1 by success, -1 by failure
+*
+* @~german
+* @brief Lädt die Kalibrierung der Kanäle aus einer Datei
+*
+* Jede Zeile enthält "Kanal Offset Verstärkung Referenz", z.B. "1 -2 1.0031 2500".
+* @param filename Pfad zur Kalibrierungsdatei
+* @return 1 bei Erfolg, -1 im Fehlerfall
+*/
+int gnublin_module_adc::loadCalibration(std::string filename) {
+	if (calibration.load(filename) < 0) {
+		ErrorMessage = calibration.getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
+
+/**
+* @~english
+* @brief Get the calibration, e.g. to convert whole blocks of samples to mV
+*
+* @return pointer to the calibration of this module
+*
+* @~german
+* @brief Gibt die Kalibrierung zurück, z.B. um ganze Blöcke von Werten in mV umzurechnen
+*
+* @return Zeiger auf die Kalibrierung dieses Moduls
+*/
+gnublin_adc_calibration *gnublin_module_adc::getCalibration() {
+	return &calibration;
+}
+
+
+//*****************************************************************************
+// Precomputed channel list for gnublin_module_adc::scan()
+//*****************************************************************************
+
+/**
+* @~english
+* @brief Create an empty scan list
+*
+* @~german
+* @brief Erzeugt eine leere Scanliste
+*/
+gnublin_adc_scan_list::gnublin_adc_scan_list() {
+	count = 0;
+}
+
+/**
+* @~english
+* @brief Append a channel to the list
+*
+* e.g. list.add(gnublin_adc_single_ended<1>()).add(gnublin_adc_differential<3, 4>());
+* @param channel channel descriptor
+* @return the list itself, entries beyond 16 are ignored
+*
+* @~german
+* @brief Hängt einen Kanal an die Liste an
+*
+* z.B. list.add(gnublin_adc_single_ended<1>()).add(gnublin_adc_differential<3, 4>());
+* @param channel Kanalbeschreibung
+* @return die Liste selbst, Einträge über 16 hinaus werden ignoriert
+*/
+gnublin_adc_scan_list &gnublin_adc_scan_list::add(const gnublin_adc_channel &channel) {
+	if (count < MODULE_ADC_SCAN_MAX) {
+		commands[count] = channel.command;
+		channels[count] = channel.channel;
+		count++;
+	}
+	return *this;
+}
+
+/**
+* @~english
+* @brief Remove all channels
+*
+* @~german
+* @brief Entfernt alle Kanäle
+*/
+void gnublin_adc_scan_list::clear() {
+	count = 0;
+}
+
+/**
+* @~english
+* @brief Get the number of channels in the list
+*
+* @return number of channels
+*
+* @~german
+* @brief Gibt die Anzahl der Kanäle in der Liste zurück
+*
+* @return Anzahl der Kanäle
+*/
+int gnublin_adc_scan_list::size() const {
+	return count;
+}
+
+/**
+* @~english
+* @brief Get the calibration channel of an entry, e.g. for gnublin_adc_calibration::toMillivolt()
+*
+* @param index index of the entry
+* @return channel (1-8), -1 for an invalid index
+*
+* @~german
+* @brief Gibt den Kalibrierungskanal eines Eintrags zurück, z.B. für gnublin_adc_calibration::toMillivolt()
+*
+* @param index Index des Eintrags
+* @return Kanal (1-8), -1 bei ungültigem Index
+*/
+int gnublin_adc_scan_list::getChannel(int index) const {
+	if (index < 0 || index >= count)
+		return -1;
+	return channels[index];
 }
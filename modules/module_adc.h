@@ -1,5 +1,89 @@
 #include "../include/includes.h"
 #include "../drivers/i2c.h"
+#include "../drivers/adc_calibration.h"
+
+#define MODULE_ADC_CHANNELS 8
+#define MODULE_ADC_SCAN_MAX 16
+
+/**
+* @struct gnublin_adc_channel
+* @~english
+* @brief ADS7830 channel with its precomputed command byte
+*
+* Use gnublin_adc_single_ended or gnublin_adc_differential to create one.
+* @~german
+* @brief ADS7830 Kanal mit vorberechnetem Kommandobyte
+*
+* Wird mit gnublin_adc_single_ended oder gnublin_adc_differential erzeugt.
+*/
+struct gnublin_adc_channel {
+	unsigned char command;	// SD C2 C1 C0, without power down bits
+	unsigned char channel;	// channel used for the calibration
+};
+
+/**
+* @class gnublin_adc_single_ended
+* @~english
+* @brief Channel N (1-8) in reference to GND, the command byte is computed at compile time
+*
+* e.g. adc.getValue(gnublin_adc_single_ended<3>()); a channel outside 1-8 doesn't compile.
+* @~german
+* @brief Kanal N (1-8) bezogen zu GND, das Kommandobyte wird zur Übersetzungszeit berechnet
+*
+* z.B. adc.getValue(gnublin_adc_single_ended<3>()); ein Kanal außerhalb 1-8 lässt sich nicht übersetzen.
+*/
+template <int N>
+struct gnublin_adc_single_ended : gnublin_adc_channel {
+	typedef char channel_is_not_between_1_8[(N >= 1 && N <= 8) ? 1 : -1];
+	enum { COMMAND = 0x80 | ((N - 1) & 1) << 6 | ((N - 1) >> 1) << 4 };
+	gnublin_adc_single_ended() {
+		command = COMMAND;
+		channel = N;
+	}
+};
+
+/**
+* @class gnublin_adc_differential
+* @~english
+* @brief Channel P in reference to channel M, the command byte is computed at compile time
+*
+* Only the pairs 1-2, 3-4, 5-6 and 7-8 in both directions are possible, other pairs don't compile.
+* @~german
+* @brief Kanal P bezogen auf Kanal M, das Kommandobyte wird zur Übersetzungszeit berechnet
+*
+* Nur die Paare 1-2, 3-4, 5-6 und 7-8 in beiden Richtungen sind möglich, andere Paare lassen sich nicht übersetzen.
+*/
+template <int P, int M>
+struct gnublin_adc_differential : gnublin_adc_channel {
+	typedef char invalid_channel_pair[(P >= 1 && P <= 8 && M == ((P - 1) ^ 1) + 1) ? 1 : -1];
+	enum { COMMAND = ((P - 1) & 1) << 6 | ((P - 1) >> 1) << 4 };
+	gnublin_adc_differential() {
+		command = COMMAND;
+		channel = P;
+	}
+};
+
+/**
+* @class gnublin_adc_scan_list
+* @~english
+* @brief Precomputed list of up to 16 channels for gnublin_module_adc::scan()
+*
+* @~german
+* @brief Vorberechnete Liste von bis zu 16 Kanälen für gnublin_module_adc::scan()
+*/
+class gnublin_adc_scan_list {
+	friend class gnublin_module_adc;
+	public:
+		gnublin_adc_scan_list();
+		gnublin_adc_scan_list &add(const gnublin_adc_channel &channel);
+		void clear();
+		int size() const;
+		int getChannel(int index) const;
+	private:
+		unsigned char commands[MODULE_ADC_SCAN_MAX];
+		unsigned char channels[MODULE_ADC_SCAN_MAX];
+		int count;
+};
 
 //*****************************************************************************
 // Class for accesing GNUBLIN Module-ADC / ADS7830
@@ -24,14 +108,24 @@ class gnublin_module_adc {
 		int setReference(int value);
 		int getValue(int channel);
 		int getValue(int channel1, int channel2);
+		int getValue(const gnublin_adc_channel &channel);
+		int scan(int mask, int *values);
+		int scan(const gnublin_adc_scan_list &list, int *values);
+		int scanAll(int *values);
 		int getVoltage(int channel);
 		int getVoltage(int channel1, int channel2);
+		int getVoltage(const gnublin_adc_channel &channel);
+		int setCalibration(int channel, int offset, int gain_ppm, int reference);
+		int loadCalibration(std::string filename);
+		gnublin_adc_calibration *getCalibration();
 		bool fail();
 		const char *getErrorMessage();
 	private:
+		int read(int command);
+		int scanCommands(const unsigned char *commands, int count, unsigned char *results);
 		gnublin_i2c i2c;
 		bool error_flag;
 		std::string ErrorMessage;
 		int reference_flag; // (1 = intern, 0 extern)
-		int referenceValue;
+		gnublin_adc_calibration calibration;
 };
@@ -105,12 +105,7 @@ void gnublin_module_lcd::setDevicefile(std::string filename){
 * @return Erfolg: 1, Fehler: -1
 */
 int gnublin_module_lcd::out(unsigned char rsrw, unsigned char data ){
-	if(!pca.writePort(0, data)){			//send data on Port 0
-		error_flag=true;
-		ErrorMessage = pca.getErrorMessage();
-		return -1;
-	}
-	if(!pca.writePort(1, rsrw)){			//send RS/RW bits on Port 1
+	if(pca.writePorts(data | (rsrw << 8)) < 0){	//send data on Port 0 and RS/RW bits on Port 1
 		error_flag=true;
 		ErrorMessage = pca.getErrorMessage();
 		return -1;
@@ -321,25 +316,15 @@ int gnublin_module_lcd::string(const char *data){
 * @return Erfolg: 1, Fehler: -1
 */
 int gnublin_module_lcd::init(){
-	//Set Ports as output
-	if(!pca.portMode(0, "out")){ 	//Port 0 as Output
-		error_flag=true;
-		ErrorMessage = pca.getErrorMessage();
-		return -1;
-	}
-	if(!pca.portMode(1, "out")){ 	//Port 1 as Output
+	//set all outputs to 0 before the ports become outputs
+	if(pca.writePorts(0x0000) < 0){
 		error_flag=true;
 		ErrorMessage = pca.getErrorMessage();
 		return -1;
 	}
 
-	//// initial alle Ausgänge auf Null
-	if(!pca.writePort(0, 0x00)){
-		error_flag=true;
-		ErrorMessage = pca.getErrorMessage();
-		return -1;
-	}
-	if(!pca.writePort(1, 0x00)){
+	//Set Ports as output
+	if(pca.setDirection16(0x0000) < 0){
 		error_flag=true;
 		ErrorMessage = pca.getErrorMessage();
 		return -1;
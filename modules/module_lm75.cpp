@@ -1,4 +1,11 @@
 #include "module_lm75.h"
+
+// temperature register (MSByte, LSByte) to milli degree celsius:
+// the 11 bit two's complement value sits in the upper bits, an arithmetic
+// shift sign extends it and one LSB is 0.125 degree = 125 milli degree
+static inline int lm75Decode(const unsigned char *buf){
+	return ((short)(buf[0] << 8 | buf[1]) >> 5) * 125;
+}
 //*******************************************************************
 //Class for accessing the LM75 IC via I2C
 //*******************************************************************
@@ -14,10 +21,31 @@
 gnublin_module_lm75::gnublin_module_lm75()
 {
 	error_flag=false;
+	config=-1;
+	conversion_ms=LM75_CONVERSION_MS;
+	os_edge=NULL;
+	os_events=NULL;
+	alarm_queue=NULL;
+	alarm_pin=-1;
+	alarmed=false;
 	setAddress(0x4f);
 }
 
 
+//------------------Destruktor------------------
+/** @~english 
+* @brief Stops watching the OS pin
+*
+* @~german 
+* @brief Beendet die Überwachung des OS Pins
+*
+*/
+gnublin_module_lm75::~gnublin_module_lm75()
+{
+	detachAlarm();
+}
+
+
 //-------------get Error Message-------------
 /** @~english 
 * @brief Get the last Error Message.
@@ -65,6 +93,7 @@ bool gnublin_module_lm75::fail(){
 */
 void gnublin_module_lm75::setAddress(int Address){
 	i2c.setAddress(Address);
+	config=-1;
 }
 
 
@@ -83,6 +112,7 @@ void gnublin_module_lm75::setAddress(int Address){
 */
 void gnublin_module_lm75::setDevicefile(std::string filename){
 	i2c.setDevicefile(filename);
+	config=-1;
 }
 
 
@@ -98,43 +128,12 @@ void gnublin_module_lm75::setDevicefile(std::string filename){
 * @return Temperatur, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
 */
 int gnublin_module_lm75::getTemp(){
-	short value=0;
-	int temp;	
 	unsigned char rx_buf[2];
-	error_flag=false;
-
-	if(i2c.receive(0x00, rx_buf, 2)>0){
-		// rx_buf[0] = MSByte
-		// rx_buf[1] = LSByte
-		// save the MSB
-		value = rx_buf[0];
-		// make space for the LSB
-		value<<=8;
-		// save the LSB
-		value |= rx_buf[1];
-		// Bit 0-4 isn't used in the LM75, so shift right 5 times
-		value>>=5;
-
-		//check if temperature is negative
-		if(rx_buf[0] & 0x80)
-		{
-			value = value|0xF800;
-			value =~value +1;
-			temp = value*(-0.125);
-			return temp;
-		}
-		else { //temperature is positive
-			temp = value*0.125;
-			return temp;
-		}
-
 
-	}
-	else{
-		error_flag=true;
-		ErrorMessage = "Error i2c receive\n";
-		return 0;	
-	}
+	if (readRaw(rx_buf) < 0)
+		return 0;
+	// integer division truncates towards zero like the old float conversion
+	return lm75Decode(rx_buf) / 1000;
 }
 
 
@@ -150,43 +149,11 @@ int gnublin_module_lm75::getTemp(){
 * @return Temperatur als Fließkommazahl, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
 */
 float gnublin_module_lm75::getTempFloat(){
-	short value=0;
-	float temp;	
 	unsigned char rx_buf[2];
-	error_flag=false;
 
-	if(i2c.receive(0x00, rx_buf, 2)>0){
-		// rx_buf[0] = MSByte
-		// rx_buf[1] = LSByte
-		// save the MSB
-		value = rx_buf[0];
-		// make space for the LSB
-		value<<=8;
-		// save the LSB
-		value |= rx_buf[1];
-		// Bit 0-4 isn't used in the LM75, so shift right 5 times
-		value>>=5;
-
-		//check if temperature is negative
-		if(rx_buf[0] & 0x80)
-		{
-			value = value|0xF800;
-			value =~value +1;
-			temp = value*(-0.125);
-			return temp;
-		}
-		else { //temperature is positive
-			temp = value*0.125;
-			return temp;
-		}
-		
-	}
-	else{	
-		error_flag=true;
-		ErrorMessage="Error i2c receive\n";
+	if (readRaw(rx_buf) < 0)
 		return 0;
-	}
-		
+	return lm75Decode(rx_buf) / 1000.0f;
 }
 
 
@@ -202,27 +169,945 @@ float gnublin_module_lm75::getTempFloat(){
 * @return Rohwert, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
 */
 short gnublin_module_lm75::getValue(){
-	short value=0;
 	unsigned char rx_buf[2];
+
+	if (readRaw(rx_buf) < 0)
+		return 0;
+	// Bit 0-4 isn't used in the LM75, so shift right 5 times
+	return (short)(rx_buf[0] << 8 | rx_buf[1]) >> 5;
+}
+
+
+// reads the temperature register, rx_buf[0] = MSByte, rx_buf[1] = LSByte
+int gnublin_module_lm75::readRaw(unsigned char *rx_buf){
+	error_flag=false;
+	if(i2c.receive(0x00, rx_buf, 2)<0){
+		error_flag=true;
+		ErrorMessage="Error i2c receive\n";
+		return -1;
+	}
+	return 1;
+}
+
+
+
+//--------------------------------get Config--------------------------------
+/** @~english
+* @brief reads the configuration register
+*
+* Bit 0: shutdown, bit 1: interrupt mode, bit 2: OS active high, bit 3-4: fault queue
+* @return configuration register, -1 at failure
+*
+* @~german
+* @brief liest das Konfigurationsregister
+*
+* Bit 0: Shutdown, Bit 1: Interrupt Modus, Bit 2: OS aktiv high, Bit 3-4: Fehlerwarteschlange
+* @return Konfigurationsregister, im Fehlerfall -1
+*/
+int gnublin_module_lm75::getConfig(){
+	unsigned char value;
+
+	error_flag=false;
+	if(i2c.receive(LM75_CONFIG, &value, 1)<0){
+		error_flag=true;
+		ErrorMessage="Error i2c receive\n";
+		return -1;
+	}
+	config=value;
+	return config;
+}
+
+
+//--------------------------------set Config--------------------------------
+/** @~english
+* @brief writes the configuration register
+*
+* @param value new configuration, see getConfig()
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief schreibt das Konfigurationsregister
+*
+* @param value neue Konfiguration, siehe getConfig()
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::setConfig(int value){
+	unsigned char tx_buf = value & 0x1f;
+
+	error_flag=false;
+	if(i2c.send(LM75_CONFIG, &tx_buf, 1)<0){
+		error_flag=true;
+		ErrorMessage="Error i2c send\n";
+		config=-1;
+		return -1;
+	}
+	config=tx_buf;
+	return 1;
+}
+
+// read-modify-write of the configuration register, the register is only read once
+int gnublin_module_lm75::updateConfig(int mask, int bits){
+	if(config<0 && getConfig()<0)
+		return -1;
+	return setConfig((config & ~mask) | bits);
+}
+
+
+//--------------------------------set Mode--------------------------------
+/** @~english
+* @brief sets the mode of the OS output
+*
+* LM75_MODE_COMPARATOR: OS is active while the temperature is above TOS and until it falls below THYST.<br>
+* LM75_MODE_INTERRUPT: OS becomes active when the temperature crosses TOS or THYST and is released by reading any register.
+* @param mode LM75_MODE_COMPARATOR or LM75_MODE_INTERRUPT
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief setzt den Modus des OS Ausgangs
+*
+* LM75_MODE_COMPARATOR: OS ist aktiv, solange die Temperatur über TOS liegt und bis sie unter THYST fällt.<br>
+* LM75_MODE_INTERRUPT: OS wird aktiv, wenn die Temperatur TOS oder THYST überschreitet und wird durch Lesen eines beliebigen Registers zurückgesetzt.
+* @param mode LM75_MODE_COMPARATOR oder LM75_MODE_INTERRUPT
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::setMode(int mode){
+	if(mode!=LM75_MODE_COMPARATOR && mode!=LM75_MODE_INTERRUPT){
+		error_flag=true;
+		ErrorMessage="invalid mode\n";
+		return -1;
+	}
+	return updateConfig(LM75_INTERRUPT, mode ? LM75_INTERRUPT : 0);
+}
+
+
+//--------------------------------set Fault Queue--------------------------------
+/** @~english
+* @brief sets the number of consecutive faults needed to activate OS
+*
+* @param faults 1, 2, 4 or 6
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief setzt die Anzahl aufeinanderfolgender Fehler, die OS aktivieren
+*
+* @param faults 1, 2, 4 oder 6
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::setFaultQueue(int faults){
+	int bits;
+
+	switch(faults){
+		case 1: bits=0x00; break;
+		case 2: bits=0x08; break;
+		case 4: bits=0x10; break;
+		case 6: bits=0x18; break;
+		default:
+			error_flag=true;
+			ErrorMessage="fault queue is not 1, 2, 4 or 6\n";
+			return -1;
+	}
+	return updateConfig(LM75_FAULT_QUEUE, bits);
+}
+
+
+//--------------------------------set Polarity--------------------------------
+/** @~english
+* @brief sets the polarity of the OS output
+*
+* @param active_high true: OS is active high, false: OS is active low (default)
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief setzt die Polarität des OS Ausgangs
+*
+* @param active_high true: OS ist aktiv high, false: OS ist aktiv low (Standard)
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::setPolarity(bool active_high){
+	return updateConfig(LM75_OS_ACTIVE_HIGH, active_high ? LM75_OS_ACTIVE_HIGH : 0);
+}
+
+
+//--------------------------------set Shutdown--------------------------------
+/** @~english
+* @brief switches the shutdown mode
+*
+* In shutdown mode the LM75 stops converting and draws only a few µA, the registers stay accessible.
+* @param shutdown true: shutdown, false: normal operation
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief schaltet den Shutdown Modus
+*
+* Im Shutdown Modus stoppt der LM75 die Wandlung und benötigt nur wenige µA, die Register bleiben zugänglich.
+* @param shutdown true: Shutdown, false: normaler Betrieb
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::setShutdown(bool shutdown){
+	return updateConfig(LM75_SHUTDOWN, shutdown ? LM75_SHUTDOWN : 0);
+}
+
+
+// TOS and THYST: 9 bit two's complement in the upper bits, 1 LSB = 0.5 degree
+int gnublin_module_lm75::writeThreshold(unsigned char reg, int temp){
+	unsigned char tx_buf[2];
+	short value;
+
+	if(temp<-55000 || temp>125000){
+		error_flag=true;
+		ErrorMessage="temperature is not between -55000 and 125000\n";
+		return -1;
+	}
+	value=(short)(temp/500*128);
+	tx_buf[0]=value>>8;
+	tx_buf[1]=value&0xff;
+	error_flag=false;
+	if(i2c.send(reg, tx_buf, 2)<0){
+		error_flag=true;
+		ErrorMessage="Error i2c send\n";
+		return -1;
+	}
+	return 1;
+}
+
+int gnublin_module_lm75::readThreshold(unsigned char reg){
+	unsigned char rx_buf[2];
+
 	error_flag=false;
-	if(i2c.receive(0x00, rx_buf, 2)>0){
-		
-		// rx_buf[0] = MSByte
-		// rx_buf[1] = LSByte
-		// save the MSB
-		value = rx_buf[0];
-		// make space for the LSB
-		value<<=8;
-		// save the LSB
-		value |= rx_buf[1];
-		// Bit 0-4 isn't used in the LM75, so shift right 5 times
-		value>>=5;
-		return value;
-		
-	}
-	else{
+	if(i2c.receive(reg, rx_buf, 2)<0){
 		error_flag=true;
 		ErrorMessage="Error i2c receive\n";
 		return 0;
 	}
+	return ((short)(rx_buf[0] << 8 | rx_buf[1]) >> 7) * 500;
+}
+
+
+//--------------------------------set Tos--------------------------------
+/** @~english
+* @brief sets the overtemperature shutdown threshold
+*
+* @param temp threshold in milli degree celsius (-55000 to 125000), rounded towards 0 to 0.5 degree
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief setzt die Übertemperatur-Schwelle
+*
+* @param temp Schwelle in tausendstel Grad Celsius (-55000 bis 125000), wird in Richtung 0 auf 0,5 Grad gerundet
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::setTos(int temp){
+	return writeThreshold(LM75_TOS, temp);
+}
+
+
+//--------------------------------set Thyst--------------------------------
+/** @~english
+* @brief sets the hysteresis threshold
+*
+* @param temp threshold in milli degree celsius (-55000 to 125000), rounded towards 0 to 0.5 degree
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief setzt die Hysterese-Schwelle
+*
+* @param temp Schwelle in tausendstel Grad Celsius (-55000 bis 125000), wird in Richtung 0 auf 0,5 Grad gerundet
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::setThyst(int temp){
+	return writeThreshold(LM75_THYST, temp);
+}
+
+
+//--------------------------------get Tos--------------------------------
+/** @~english
+* @brief reads the overtemperature shutdown threshold
+*
+* @return threshold in milli degree celsius, 0 at failure (check with fail() and getErrorMessage())
+*
+* @~german
+* @brief liest die Übertemperatur-Schwelle
+*
+* @return Schwelle in tausendstel Grad Celsius, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
+*/
+int gnublin_module_lm75::getTos(){
+	return readThreshold(LM75_TOS);
+}
+
+
+//--------------------------------get Thyst--------------------------------
+/** @~english
+* @brief reads the hysteresis threshold
+*
+* @return threshold in milli degree celsius, 0 at failure (check with fail() and getErrorMessage())
+*
+* @~german
+* @brief liest die Hysterese-Schwelle
+*
+* @return Schwelle in tausendstel Grad Celsius, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
+*/
+int gnublin_module_lm75::getThyst(){
+	return readThreshold(LM75_THYST);
+}
+
+
+//--------------------------------set Conversion Time--------------------------------
+/** @~english
+* @brief sets the time getTempOneShot() waits for the conversion
+*
+* The default is 100 ms, some LM75 variants need up to 300 ms.
+* @param ms conversion time in ms
+*
+* @~german
+* @brief setzt die Zeit, die getTempOneShot() auf die Wandlung wartet
+*
+* Standard sind 100 ms, manche LM75 Varianten benötigen bis zu 300 ms.
+* @param ms Wandlungszeit in ms
+*/
+void gnublin_module_lm75::setConversionTime(int ms){
+	conversion_ms=ms;
+}
+
+
+//--------------------------------get Temp One Shot--------------------------------
+/** @~english
+* @brief wakes the LM75 from shutdown mode for one conversion
+*
+* Leaves shutdown mode, waits for one conversion, reads the temperature and enters shutdown mode again.
+* Between the calls the sensor stays in shutdown mode.
+* @return temperature in milli degree celsius, 0 at failure (check with fail() and getErrorMessage())
+*
+* @~german
+* @brief weckt den LM75 für eine Wandlung aus dem Shutdown Modus
+*
+* Verlässt den Shutdown Modus, wartet eine Wandlung ab, liest die Temperatur und geht wieder in den Shutdown Modus.
+* Zwischen den Aufrufen bleibt der Sensor im Shutdown Modus.
+* @return Temperatur in tausendstel Grad Celsius, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
+*/
+int gnublin_module_lm75::getTempOneShot(){
+	unsigned char rx_buf[2];
+	int temp;
+
+	if(setShutdown(false)<0)
+		return 0;
+	usleep(conversion_ms*1000);
+	if(readRaw(rx_buf)<0){
+		setShutdown(true);
+		error_flag=true;
+		return 0;
+	}
+	temp=lm75Decode(rx_buf);
+	if(setShutdown(true)<0)
+		return 0;
+	return temp;
+}
+
+
+//--------------------------------attach Alarm--------------------------------
+/** @~english
+* @brief delivers the OS output, connected to a GPIO, as events
+*
+* Every edge of the OS pin reads the temperature and delivers EVENT_TEMP_ALARM when OS becomes active
+* and EVENT_TEMP_CLEAR when it is released in comparator mode (source: pin, device: I2C address, value: temperature in milli degree celsius).
+* In interrupt mode the read releases OS again, so the next crossing is reported without further action. There OS becomes active above TOS and below THYST in turn,
+* the activation above TOS delivers EVENT_TEMP_ALARM, the one below THYST EVENT_TEMP_CLEAR.
+* The host can block in gnublin_event_queue::wait() instead of polling the temperature.
+* @param pin GPIO the OS output is connected to
+* @param queue queue which receives the events
+* @return 1 at success, -1 at failure
+*
+* @~german
+* @brief liefert den an einen GPIO angeschlossenen OS Ausgang als Ereignisse
+*
+* Jede Flanke am OS Pin liest die Temperatur und liefert EVENT_TEMP_ALARM, wenn OS aktiv wird,
+* und EVENT_TEMP_CLEAR, wenn es im Komparator Modus zurückgesetzt wird (source: Pin, device: I2C Adresse, value: Temperatur in tausendstel Grad Celsius).
+* Im Interrupt Modus setzt das Lesen OS wieder zurück, so dass die nächste Überschreitung ohne weiteres Zutun gemeldet wird. Dort wird OS abwechselnd über TOS und unter THYST aktiv,
+* die Aktivierung über TOS liefert EVENT_TEMP_ALARM, die unter THYST EVENT_TEMP_CLEAR.
+* Der Host kann in gnublin_event_queue::wait() blockieren, anstatt die Temperatur abzufragen.
+* @param pin GPIO, an den der OS Ausgang angeschlossen ist
+* @param queue Warteschlange, die die Ereignisse erhält
+* @return 1 bei Erfolg, im Fehlerfall -1
+*/
+int gnublin_module_lm75::attachAlarm(int pin, gnublin_event_queue *queue){
+	detachAlarm();
+	if(config<0 && getConfig()<0)
+		return -1;
+	alarm_queue=queue;
+	alarm_i2c=i2c;
+	alarm_pin=pin;
+	alarmed=false;
+	os_events=new gnublin_event_queue();
+	os_events->setCallback(osCallback, this);
+	os_edge=new gnublin_gpio_edge();
+	if(os_edge->watch(pin, "both", os_events)<0){
+		ErrorMessage=os_edge->getErrorMessage();
+		detachAlarm();
+		error_flag=true;
+		return -1;
+	}
+	error_flag=false;
+	return 1;
+}
+
+
+//--------------------------------detach Alarm--------------------------------
+/** @~english
+* @brief stops delivering the OS output as events
+*
+* @~german
+* @brief beendet die Lieferung des OS Ausgangs als Ereignisse
+*/
+void gnublin_module_lm75::detachAlarm(){
+	// deleting the edge object joins its thread, so no callback runs afterwards
+	delete os_edge;
+	delete os_events;
+	os_edge=NULL;
+	os_events=NULL;
+	alarm_queue=NULL;
+	alarm_pin=-1;
+}
+
+// called from the edge thread for every edge of the OS pin
+void gnublin_module_lm75::osCallback(const gnublin_event *event, void *arg){
+	gnublin_module_lm75 *lm75=(gnublin_module_lm75 *)arg;
+	bool active_high=lm75->config & LM75_OS_ACTIVE_HIGH;
+	bool active=(event->value != 0) == active_high;
+	unsigned char rx_buf[2];
+	gnublin_event alarm;
+
+	if(lm75->config & LM75_INTERRUPT){
+		// only the activation is of interest, the release is caused by our own read;
+		// OS becomes active above TOS and below THYST in turn
+		if(!active)
+			return;
+		lm75->alarmed=!lm75->alarmed;
+		active=lm75->alarmed;
+	}
+	alarm.type=active ? EVENT_TEMP_ALARM : EVENT_TEMP_CLEAR;
+	alarm.device=lm75->alarm_i2c.getAddress();
+	alarm.source=lm75->alarm_pin;
+	alarm.value=0;
+	alarm.timestamp=event->timestamp;
+	if(lm75->alarm_i2c.receive(LM75_TEMP, rx_buf, 2)>0)
+		alarm.value=lm75Decode(rx_buf);
+	lm75->alarm_queue->push(alarm);
+}
+
+//*******************************************************************
+//Class for reading several LM75 on one or more I2C buses
+//*******************************************************************
+
+//------------------Konstruktor------------------
+/** @~english 
+* @brief Creates an empty sensor group
+*
+* @~german 
+* @brief Erzeugt eine leere Sensorgruppe
+*
+*/
+gnublin_lm75_group::gnublin_lm75_group(){
+	sensor_count = 0;
+	bus_count = 0;
+	error_flag = false;
+}
+
+
+//-------------get Error Message-------------
+/** @~english 
+* @brief Get the last Error Message.
+*
+* This function returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german 
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_lm75_group::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------------------------Fail-------------------------------
+/** @~english 
+* @brief returns the error flag to check if the last operation went wrong
+*
+* @return error_flag as boolean
+*
+* @~german 
+* @brief Gibt das error_flag zurück um zu überprüfen ob die vorangegangene Operation einen Fehler auweist
+*
+* @return error_flag als bool
+*/
+bool gnublin_lm75_group::fail(){
+	return error_flag;
+}
+
+
+//-------------------------------add Sensor-------------------------------
+/** @~english 
+* @brief adds a LM75 on the default bus "/dev/i2c-1"
+*
+* @param address I2C slave address (0x48-0x4f)
+* @return index of the sensor in the temperature array, -1 at failure
+*
+* @~german 
+* @brief fügt einen LM75 am Standard Bus "/dev/i2c-1" hinzu
+*
+* @param address I2C Slave Adresse (0x48-0x4f)
+* @return Index des Sensors im Temperatur-Array, -1 im Fehlerfall
+*/
+int gnublin_lm75_group::addSensor(int address){
+	return addSensor("/dev/i2c-1", address);
+}
+
+/** @~english 
+* @brief adds a LM75 on the given bus
+*
+* The sensors are stored in the order they were added, the first sensor has the index 0.
+* @param devicefile path to the devicefile of the bus, e.g. "/dev/i2c-0"
+* @param address I2C slave address (0x48-0x4f)
+* @return index of the sensor in the temperature array, -1 at failure
+*
+* @~german 
+* @brief fügt einen LM75 am angegebenen Bus hinzu
+*
+* Die Sensoren werden in der Reihenfolge gespeichert, in der sie hinzugefügt wurden, der erste Sensor hat den Index 0.
+* @param devicefile Pfad zur Geräte Datei des Busses, z.B. "/dev/i2c-0"
+* @param address I2C Slave Adresse (0x48-0x4f)
+* @return Index des Sensors im Temperatur-Array, -1 im Fehlerfall
+*/
+int gnublin_lm75_group::addSensor(std::string devicefile, int address){
+	int b;
+
+	if (address < 0x48 || address > 0x4f) {
+		error_flag = true;
+		ErrorMessage = "address is not between 0x48-0x4f\n";
+		return -1;
+	}
+	if (sensor_count >= LM75_GROUP_MAX_SENSORS) {
+		error_flag = true;
+		ErrorMessage = "too many sensors\n";
+		return -1;
+	}
+	for (b = 0; b < bus_count; b++)
+		if (buses[b].devicefile == devicefile)
+			break;
+	if (b == bus_count) {
+		if (bus_count >= LM75_GROUP_MAX_BUSES) {
+			error_flag = true;
+			ErrorMessage = "too many buses\n";
+			return -1;
+		}
+		buses[b].devicefile = devicefile;
+		buses[b].i2c.setDevicefile(devicefile);
+		buses[b].count = 0;
+		buses[b].group = this;
+		bus_count++;
+	}
+	for (int i = 0; i < buses[b].count; i++) {
+		if (addresses[buses[b].sensors[i]] == address) {
+			error_flag = true;
+			ErrorMessage = "sensor " + numberToString(address) + " already added\n";
+			return -1;
+		}
+	}
+	buses[b].sensors[buses[b].count++] = sensor_count;
+	addresses[sensor_count] = address;
+	raw[sensor_count][0] = 0;
+	raw[sensor_count][1] = 0;
+	temperatures[sensor_count] = 0;
+	status[sensor_count] = 0;
+	error_flag = false;
+	return sensor_count++;
+}
+
+
+//-------------------------------size-------------------------------
+/** @~english 
+* @brief returns the number of sensors
+*
+* @return number of sensors
+*
+* @~german 
+* @brief gibt die Anzahl der Sensoren zurück
+*
+* @return Anzahl der Sensoren
+*/
+int gnublin_lm75_group::size(){
+	return sensor_count;
+}
+
+
+//-------------------------------update-------------------------------
+/** @~english 
+* @brief reads the temperatures of all sensors
+*
+* All sensors of a bus are read with one I2C transaction, the buses are read in parallel (one thread per additional bus).
+* If the transaction of a bus fails, its sensors are read one by one, so a missing sensor doesn't invalidate the others.
+* @return number of sensors read successfully, -1 if no sensor could be read (check with valid())
+*
+* @~german 
+* @brief liest die Temperaturen aller Sensoren
+*
+* Alle Sensoren eines Busses werden mit einer I2C Transaktion gelesen, die Busse werden parallel gelesen (ein Thread für jeden weiteren Bus).
+* Falls die Transaktion eines Busses fehlschlägt, werden seine Sensoren einzeln gelesen, so dass ein fehlender Sensor die anderen nicht ungültig macht.
+* @return Anzahl der erfolgreich gelesenen Sensoren, -1 wenn kein Sensor gelesen werden konnte (überprüfen mit valid())
+*/
+int gnublin_lm75_group::update(){
+	pthread_t threads[LM75_GROUP_MAX_BUSES];
+	bool started[LM75_GROUP_MAX_BUSES];
+	int ok = 0;
+
+	if (sensor_count == 0) {
+		error_flag = true;
+		ErrorMessage = "no sensors added\n";
+		return -1;
+	}
+	for (int b = 1; b < bus_count; b++) {
+		started[b] = pthread_create(&threads[b], NULL, pollBus, &buses[b]) == 0;
+		if (!started[b])
+			readBus(&buses[b]);
+	}
+	readBus(&buses[0]);
+	for (int b = 1; b < bus_count; b++)
+		if (started[b])
+			pthread_join(threads[b], NULL);
+
+	for (int i = 0; i < sensor_count; i++) {
+		temperatures[i] = lm75Decode(raw[i]);
+		ok += status[i];
+	}
+	if (ok == 0) {
+		error_flag = true;
+		ErrorMessage = buses[0].i2c.getErrorMessage();
+		return -1;
+	}
+	error_flag = false;
+	return ok;
+}
+
+void *gnublin_lm75_group::pollBus(void *arg){
+	lm75_bus *bus = (lm75_bus *)arg;
+
+	bus->group->readBus(bus);
+	return NULL;
+}
+
+// pointer register 0x00 and 2 bytes temperature for every sensor of the bus
+void gnublin_lm75_group::readBus(lm75_bus *bus){
+	struct i2c_msg msgs[2 * LM75_GROUP_BUS_SENSORS];
+	unsigned char pointer = 0x00;
+
+	for (int i = 0; i < bus->count; i++) {
+		int s = bus->sensors[i];
+		msgs[2 * i].addr = addresses[s];
+		msgs[2 * i].flags = 0;
+		msgs[2 * i].len = 1;
+		msgs[2 * i].buf = &pointer;
+		msgs[2 * i + 1].addr = addresses[s];
+		msgs[2 * i + 1].flags = I2C_M_RD;
+		msgs[2 * i + 1].len = 2;
+		msgs[2 * i + 1].buf = raw[s];
+	}
+	if (bus->i2c.transfer(msgs, 2 * bus->count) > 0) {
+		for (int i = 0; i < bus->count; i++)
+			status[bus->sensors[i]] = 1;
+		return;
+	}
+	for (int i = 0; i < bus->count; i++)
+		status[bus->sensors[i]] = bus->i2c.transfer(&msgs[2 * i], 2) > 0;
+}
+
+
+//-------------------------------get Temperatures-------------------------------
+/** @~english 
+* @brief returns the temperatures of the last update()
+*
+* @return array with size() temperatures in milli degree celsius, in the order the sensors were added
+*
+* @~german 
+* @brief gibt die Temperaturen des letzten update() zurück
+*
+* @return Array mit size() Temperaturen in tausendstel Grad Celsius, in der Reihenfolge, in der die Sensoren hinzugefügt wurden
+*/
+const int *gnublin_lm75_group::getTemperatures(){
+	return temperatures;
+}
+
+
+//-------------------------------get Temp-------------------------------
+/** @~english 
+* @brief returns the temperature of one sensor of the last update()
+*
+* @param index index of the sensor
+* @return temperature in milli degree celsius, 0 for an invalid index
+*
+* @~german 
+* @brief gibt die Temperatur eines Sensors des letzten update() zurück
+*
+* @param index Index des Sensors
+* @return Temperatur in tausendstel Grad Celsius, 0 bei ungültigem Index
+*/
+int gnublin_lm75_group::getTemp(int index){
+	if (index < 0 || index >= sensor_count)
+		return 0;
+	return temperatures[index];
+}
+
+
+//-------------------------------valid-------------------------------
+/** @~english 
+* @brief checks if a sensor could be read in the last update()
+*
+* @param index index of the sensor
+* @return true if the temperature is valid
+*
+* @~german 
+* @brief prüft, ob ein Sensor beim letzten update() gelesen werden konnte
+*
+* @param index Index des Sensors
+* @return true, wenn die Temperatur gültig ist
+*/
+bool gnublin_lm75_group::valid(int index){
+	if (index < 0 || index >= sensor_count)
+		return false;
+	return status[index];
+}
+
+
+//*******************************************************************
+//Class for sharing the temperature of one LM75 between threads
+//*******************************************************************
+
+//------------------Konstruktor------------------
+/** @~english 
+* @brief Creates a cache for a LM75
+*
+* @param lm75 the sensor
+* @param ttl_ms time-to-live of a temperature in ms
+*
+* @~german 
+* @brief Erzeugt einen Zwischenspeicher für einen LM75
+*
+* @param lm75 der Sensor
+* @param ttl_ms Gültigkeitsdauer einer Temperatur in ms
+*/
+gnublin_lm75_cache::gnublin_lm75_cache(gnublin_module_lm75 *lm75, int ttl_ms){
+	this->lm75 = lm75;
+	this->ttl_ms = ttl_ms;
+	temp = 0;
+	timestamp = 0;
+	valid = false;
+	reading = false;
+	read_ok = false;
+	generation = 0;
+	reads = 0;
+	error_flag = false;
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&cond, NULL);
+}
+
+gnublin_lm75_cache::~gnublin_lm75_cache(){
+	pthread_cond_destroy(&cond);
+	pthread_mutex_destroy(&mutex);
+}
+
+
+//-------------get Error Message-------------
+/** @~english 
+* @brief Get the last Error Message.
+*
+* This function returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german 
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_lm75_cache::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------------------------Fail-------------------------------
+/** @~english 
+* @brief returns the error flag to check if the last operation went wrong
+*
+* @return error_flag as boolean
+*
+* @~german 
+* @brief Gibt das error_flag zurück um zu überprüfen ob die vorangegangene Operation einen Fehler auweist
+*
+* @return error_flag als bool
+*/
+bool gnublin_lm75_cache::fail(){
+	return error_flag;
+}
+
+
+//-------------------------------set TTL-------------------------------
+/** @~english 
+* @brief sets the time-to-live of a temperature
+*
+* @param ms time-to-live in ms
+*
+* @~german 
+* @brief setzt die Gültigkeitsdauer einer Temperatur
+*
+* @param ms Gültigkeitsdauer in ms
+*/
+void gnublin_lm75_cache::setTTL(int ms){
+	pthread_mutex_lock(&mutex);
+	ttl_ms = ms;
+	pthread_mutex_unlock(&mutex);
+}
+
+
+//-------------------------------get Temp-------------------------------
+/** @~english 
+* @brief returns a temperature which is at most max_age_ms old
+*
+* If the cached temperature is too old, the sensor is read. If another thread is already reading it, this thread waits for that result.<br>
+* max_age_ms = 0 always waits for a new read, max_age_ms = -1 returns any cached temperature and only reads if there is none.
+* This function is thread safe.
+* @param temp the temperature in degree celsius is stored in it
+* @param max_age_ms accepted age in ms
+* @return 1 at success, -1 if the sensor couldn't be read
+*
+* @~german 
+* @brief gibt eine Temperatur zurück, die höchstens max_age_ms alt ist
+*
+* Ist die gespeicherte Temperatur zu alt, wird der Sensor gelesen. Liest ein anderer Thread ihn bereits, wartet dieser Thread auf dessen Ergebnis.<br>
+* max_age_ms = 0 wartet immer auf einen neuen Lesevorgang, max_age_ms = -1 liefert jede gespeicherte Temperatur und liest nur, wenn keine vorhanden ist.
+* Diese Funktion ist threadsicher.
+* @param temp hier wird die Temperatur in Grad Celsius gespeichert
+* @param max_age_ms akzeptiertes Alter in ms
+* @return 1 bei Erfolg, -1 wenn der Sensor nicht gelesen werden konnte
+*/
+int gnublin_lm75_cache::getTemp(float *temp, int max_age_ms){
+	unsigned long long now = getMonotonicTime();
+	bool ok;
+	float value;
+
+	pthread_mutex_lock(&mutex);
+	if (valid && (max_age_ms < 0 || now - timestamp <= (unsigned long long)max_age_ms * 1000)) {
+		*temp = this->temp;
+		pthread_mutex_unlock(&mutex);
+		return 1;
+	}
+	if (reading) {
+		// a read is in flight, its result is younger than our request
+		unsigned int g = generation;
+		while (generation == g)
+			pthread_cond_wait(&cond, &mutex);
+		ok = read_ok;
+		*temp = this->temp;
+		pthread_mutex_unlock(&mutex);
+		return ok ? 1 : -1;
+	}
+	reading = true;
+	pthread_mutex_unlock(&mutex);
+
+	value = lm75->getTempFloat();
+	ok = !lm75->fail();
+
+	pthread_mutex_lock(&mutex);
+	if (ok) {
+		this->temp = value;
+		timestamp = getMonotonicTime();
+		valid = true;
+	}
+	else {
+		ErrorMessage = lm75->getErrorMessage();
+	}
+	read_ok = ok;
+	reads++;
+	reading = false;
+	generation++;
+	pthread_cond_broadcast(&cond);
+	*temp = this->temp;
+	pthread_mutex_unlock(&mutex);
+	return ok ? 1 : -1;
+}
+
+
+//-------------------------------get Temp float-------------------------------
+/** @~english 
+* @brief returns the temperature, the sensor is only read if the cached temperature is older than the TTL
+*
+* @return temperature as float, 0 at failure (check with fail() and getErrorMessage())
+*
+* @~german 
+* @brief gibt die Temperatur zurück, der Sensor wird nur gelesen, wenn die gespeicherte Temperatur älter als die Gültigkeitsdauer ist
+*
+* @return Temperatur als Fließkommazahl, im Fehlerfall 0 (überprüfen mit fail() und getErrorMessage())
+*/
+float gnublin_lm75_cache::getTempFloat(){
+	float value;
+
+	if (getTemp(&value, ttl_ms) < 0) {
+		error_flag = true;
+		return 0;
+	}
+	error_flag = false;
+	return value;
+}
+
+
+//-------------------------------get Age-------------------------------
+/** @~english 
+* @brief returns the age of the cached temperature
+*
+* @return age in ms, -1 if no temperature was read yet
+*
+* @~german 
+* @brief gibt das Alter der gespeicherten Temperatur zurück
+*
+* @return Alter in ms, -1 wenn noch keine Temperatur gelesen wurde
+*/
+int gnublin_lm75_cache::getAge(){
+	int age = -1;
+
+	pthread_mutex_lock(&mutex);
+	if (valid)
+		age = (getMonotonicTime() - timestamp) / 1000;
+	pthread_mutex_unlock(&mutex);
+	return age;
+}
+
+
+//-------------------------------stale-------------------------------
+/** @~english 
+* @brief checks if the cached temperature is older than the TTL
+*
+* @return true if the next getTempFloat() reads the sensor
+*
+* @~german 
+* @brief prüft, ob die gespeicherte Temperatur älter als die Gültigkeitsdauer ist
+*
+* @return true, wenn das nächste getTempFloat() den Sensor liest
+*/
+bool gnublin_lm75_cache::stale(){
+	int age = getAge();
+
+	return age < 0 || age > ttl_ms;
+}
+
+
+//-------------------------------get Reads-------------------------------
+/** @~english 
+* @brief returns the number of sensor reads
+*
+* @return number of I2C reads done by the cache
+*
+* @~german 
+* @brief gibt die Anzahl der Sensor-Lesevorgänge zurück
+*
+* @return Anzahl der vom Zwischenspeicher ausgeführten I2C Lesevorgänge
+*/
+unsigned int gnublin_lm75_cache::getReads(){
+	return reads;
 }
@@ -1,5 +1,25 @@
 #include "../include/includes.h"
 #include "../drivers/i2c.cpp"
+#include "../drivers/gpio_edge.h"
+
+//LM75 registers
+#define LM75_TEMP	0x00
+#define LM75_CONFIG	0x01
+#define LM75_THYST	0x02
+#define LM75_TOS	0x03
+
+//configuration register bits
+#define LM75_SHUTDOWN		0x01
+#define LM75_INTERRUPT		0x02
+#define LM75_OS_ACTIVE_HIGH	0x04
+#define LM75_FAULT_QUEUE	0x18
+
+//OS modes
+#define LM75_MODE_COMPARATOR	0
+#define LM75_MODE_INTERRUPT	1
+
+//time for one conversion after leaving shutdown mode
+#define LM75_CONVERSION_MS	100
 //*******************************************************************
 //Class for accessing the LM75 IC via I2C
 //*******************************************************************
@@ -16,8 +36,23 @@ class gnublin_module_lm75 {
 	bool error_flag;
 	gnublin_i2c i2c;
 	std::string ErrorMessage;
+	int config;
+	int conversion_ms;
+	gnublin_gpio_edge *os_edge;
+	gnublin_event_queue *os_events;
+	gnublin_event_queue *alarm_queue;
+	gnublin_i2c alarm_i2c;
+	int alarm_pin;
+	bool alarmed;			// interrupt mode: the last activation was above TOS
+	gnublin_module_lm75(const gnublin_module_lm75 &);
+	gnublin_module_lm75 &operator=(const gnublin_module_lm75 &);
+	int updateConfig(int mask, int bits);
+	int writeThreshold(unsigned char reg, int temp);
+	int readThreshold(unsigned char reg);
+	static void osCallback(const gnublin_event *event, void *arg);
 public:
 	gnublin_module_lm75();
+	~gnublin_module_lm75();
 	const char *getErrorMessage();
 	bool fail();
 	void setAddress(int Address);
@@ -25,4 +60,123 @@ public:
 	int getTemp();
 	float getTempFloat();
 	short getValue();
+	int getConfig();
+	int setConfig(int value);
+	int setMode(int mode);
+	int setFaultQueue(int faults);
+	int setPolarity(bool active_high);
+	int setShutdown(bool shutdown);
+	int setTos(int temp);
+	int setThyst(int temp);
+	int getTos();
+	int getThyst();
+	void setConversionTime(int ms);
+	int getTempOneShot();
+	int attachAlarm(int pin, gnublin_event_queue *queue);
+	void detachAlarm();
+private:
+	int readRaw(unsigned char *rx_buf);
+};
+
+
+#define LM75_GROUP_MAX_BUSES	4
+#define LM75_GROUP_BUS_SENSORS	8
+#define LM75_GROUP_MAX_SENSORS	(LM75_GROUP_MAX_BUSES * LM75_GROUP_BUS_SENSORS)
+
+//*******************************************************************
+//Class for reading several LM75 on one or more I2C buses
+//*******************************************************************
+/**
+* @class gnublin_lm75_group
+* @~english
+* @brief Reads up to 8 LM75 (0x48-0x4f) per bus on up to 4 buses
+*
+* update() reads all sensors of a bus with one I2C transaction and polls the buses in parallel,
+* the temperatures are stored in one contiguous array in milli degree celsius.
+* @~german 
+* @brief Liest bis zu 8 LM75 (0x48-0x4f) pro Bus an bis zu 4 Bussen
+*
+* update() liest alle Sensoren eines Busses mit einer I2C Transaktion und fragt die Busse parallel ab,
+* die Temperaturen werden in einem zusammenhängenden Array in tausendstel Grad Celsius gespeichert.
+*/
+class gnublin_lm75_group {
+	struct lm75_bus {
+		std::string devicefile;
+		gnublin_i2c i2c;
+		int sensors[LM75_GROUP_BUS_SENSORS];
+		int count;
+		gnublin_lm75_group *group;
+	};
+	bool error_flag;
+	std::string ErrorMessage;
+	lm75_bus buses[LM75_GROUP_MAX_BUSES];
+	int bus_count;
+	int addresses[LM75_GROUP_MAX_SENSORS];
+	unsigned char raw[LM75_GROUP_MAX_SENSORS][2];
+	int temperatures[LM75_GROUP_MAX_SENSORS];
+	int status[LM75_GROUP_MAX_SENSORS];
+	int sensor_count;
+	gnublin_lm75_group(const gnublin_lm75_group &);
+	gnublin_lm75_group &operator=(const gnublin_lm75_group &);
+	static void *pollBus(void *arg);
+	void readBus(lm75_bus *bus);
+public:
+	gnublin_lm75_group();
+	const char *getErrorMessage();
+	bool fail();
+	int addSensor(int address);
+	int addSensor(std::string devicefile, int address);
+	int size();
+	int update();
+	const int *getTemperatures();
+	int getTemp(int index);
+	bool valid(int index);
+};
+
+
+//*******************************************************************
+//Class for sharing the temperature of one LM75 between threads
+//*******************************************************************
+/**
+* @class gnublin_lm75_cache
+* @~english
+* @brief Caches the temperature of a gnublin_module_lm75 for a time-to-live
+*
+* Reads younger than the TTL are answered from the cache. If several threads need a new value at the same time,
+* only one of them reads the sensor and the others wait for its result (single-flight).
+* All threads should read the sensor through the same cache object.
+* @~german 
+* @brief Speichert die Temperatur eines gnublin_module_lm75 für eine Gültigkeitsdauer zwischen
+*
+* Abfragen, die jünger als die Gültigkeitsdauer sind, werden aus dem Zwischenspeicher beantwortet. Brauchen mehrere Threads gleichzeitig einen neuen Wert,
+* liest nur einer den Sensor und die anderen warten auf sein Ergebnis (single-flight).
+* Alle Threads sollten den Sensor über dasselbe Cache Objekt lesen.
+*/
+class gnublin_lm75_cache {
+	gnublin_module_lm75 *lm75;
+	int ttl_ms;
+	float temp;
+	unsigned long long timestamp;
+	bool valid;
+	bool reading;
+	bool read_ok;
+	unsigned int generation;
+	unsigned int reads;
+	bool error_flag;
+	std::string ErrorMessage;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	gnublin_lm75_cache(const gnublin_lm75_cache &);
+	gnublin_lm75_cache &operator=(const gnublin_lm75_cache &);
+public:
+	gnublin_lm75_cache(gnublin_module_lm75 *lm75, int ttl_ms);
+	~gnublin_lm75_cache();
+	const char *getErrorMessage();
+	bool fail();
+	void setTTL(int ms);
+	int getTemp(float *temp, int max_age_ms);
+	float getTempFloat();
+	int getAge();
+	bool stale();
+	unsigned int getReads();
 };
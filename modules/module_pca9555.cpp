@@ -15,10 +15,29 @@
 gnublin_module_pca9555::gnublin_module_pca9555() 
 {
 	error_flag=false;
+	verify_flag=false;
+	int_edge=NULL;
+	int_events=NULL;
+	change_queue=NULL;
+	snapshot=0;
 	setAddress(0x20);
 }
 
 
+//------------------Destruktor------------------
+/** @~english 
+* @brief Stops watching the INT pin
+*
+* @~german 
+* @brief Beendet die Überwachung des INT Pins
+*
+*/
+gnublin_module_pca9555::~gnublin_module_pca9555()
+{
+	detachInterrupt();
+}
+
+
 //-------------get Error Message-------------
 /** @~english 
 * @brief Get the last Error Message.
@@ -66,6 +85,7 @@ bool gnublin_module_pca9555::fail(){
 */
 void gnublin_module_pca9555::setAddress(int Address){
 	i2c.setAddress(Address);
+	shadow_valid=false;
 }
 
 
@@ -84,6 +104,7 @@ void gnublin_module_pca9555::setAddress(int Address){
 */
 void gnublin_module_pca9555::setDevicefile(std::string filename){
 	i2c.setDevicefile(filename);
+	shadow_valid=false;
 }
 
 //-----------------------------------Pin Mode-----------------------------------
@@ -92,7 +113,7 @@ void gnublin_module_pca9555::setDevicefile(std::string filename){
 *
 * With this Function you can set a single pin of the PCA9555 wether as input or output.
 * @param pin Number of the pin (0-15)
-* @param direction INPUT or OUTPUT
+* @param direction PCA9555_INPUT or PCA9555_OUTPUT
 * @return success: 1, failure: -1
 *
 * @~german
@@ -100,102 +121,50 @@ void gnublin_module_pca9555::setDevicefile(std::string filename){
 *
 * Mit dieser Funktion kann man einen einzelnen Pin entweder als Eingang oder als Ausgang setzen.
 * @param pin Nummer des Pins (0-15)
-* @param direction INPUT (Eingang) oder OUTPUT (Ausgang)
+* @param direction PCA9555_INPUT (Eingang) oder PCA9555_OUTPUT (Ausgang)
 * @return Erfolg: 1, Misserfolg: -1
 */
-int gnublin_module_pca9555::pinMode(int pin, std::string direction){
+int gnublin_module_pca9555::pinMode(int pin, pca9555_direction direction){
 	error_flag=false;
-	unsigned char TxBuf[1];
-	unsigned char RxBuf[1];
 
-	if (pin < 0 || pin > 15){
+	if ((unsigned int)pin > 15){
 		error_flag=true;
 		ErrorMessage="Pin Number is not between 0-15";
 		return -1;
 	}
+	if (loadShadow() < 0)
+		return -1;
 
-	if(pin >= 0 && pin <= 7){ // Port 0
-
-			TxBuf[0]=pow(2, pin); //convert pin into its binary form e. g. Pin 3 = 8
-
-			if (i2c.receive(0x06, RxBuf, 1)>0){ //read the current state
+	// configuration register 0x06 (pin 0-7) or 0x07 (pin 8-15), a set bit is an input
+	unsigned char reg=0x06 + (pin >> 3);
+	unsigned char mask=1 << (pin & 7);
+	return writeRegister(reg, (shadow[reg] & ~mask) | (mask & -(int)direction));
+}
 
-				if (direction=="out"){
-					TxBuf[0]=RxBuf[0] & ~TxBuf[0]; // at output you have to invert the pin you want to set und AND it to change only the pin 
-					if(i2c.send(0x06, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}
-									
-				}
-				else if (direction=="in"){
-					TxBuf[0]=RxBuf[0] | TxBuf[0]; // at input you just have to do a OR
-					if(i2c.send(0x06, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}
-				}
-				else{
-					error_flag=true;
-					ErrorMessage="direction != IN/OUTPUT";				
-					return -1;			
-				}
-			}
-			else {
-			error_flag=true;
-			ErrorMessage="i2c.receive Error";
-			return -1;
-			}
-	}
-	else if(pin >= 8 && pin <= 15){ // Port 1
-
-			TxBuf[0]=pow(2, (pin-8)); //convert pin into its binary form e. g. Pin 3 = 8
-
-			if(i2c.receive(0x07, RxBuf, 1)>0){ //read the current state
-			
-				if (direction=="out"){
-					TxBuf[0]=RxBuf[0] & ~TxBuf[0];
-					if(i2c.send(0x07, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}					
-				}
-				else if (direction=="in"){
-					TxBuf[0]=RxBuf[0] | TxBuf[0];
-					if(i2c.send(0x07, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}
-				}
-				else{
-					error_flag=true;
-					ErrorMessage="direction != IN/OUTPUT";				
-					return -1;			
-				}
-			}
-			else {
-			error_flag=true;
-			ErrorMessage="i2c.receive Error";
-			return -1;
-			}
-	}
-	else return -1;
+/** @~english
+* @brief Controls the pin mode (INPUT/OUTPUT)
+*
+* Wrapper for pinMode(int, pca9555_direction).
+* @param pin Number of the pin (0-15)
+* @param direction INPUT or OUTPUT
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt den Pin Modus (Eingang/Ausgang)
+*
+* Wrapper für pinMode(int, pca9555_direction).
+* @param pin Nummer des Pins (0-15)
+* @param direction INPUT (Eingang) oder OUTPUT (Ausgang)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::pinMode(int pin, std::string direction){
+	if (direction=="out")
+		return pinMode(pin, PCA9555_OUTPUT);
+	if (direction=="in")
+		return pinMode(pin, PCA9555_INPUT);
+	error_flag=true;
+	ErrorMessage="direction != IN/OUTPUT";
+	return -1;
 }
 
 
@@ -205,7 +174,7 @@ int gnublin_module_pca9555::pinMode(int pin, std::string direction){
 *
 * With this Function you can set a whole port of the PCA9555 wether as input or output.
 * @param port Number of the port (0-1)
-* @param direction INPUT or OUTPUT
+* @param direction PCA9555_INPUT or PCA9555_OUTPUT
 * @return success: 1, failure: -1
 *
 * @~german
@@ -213,81 +182,80 @@ int gnublin_module_pca9555::pinMode(int pin, std::string direction){
 *
 * Mit dieser Funktion kann man einen ganzen Port entweder als Eingang oder als Ausgang setzen.
 * @param port Nummer des Ports (0-1)
-* @param direction INPUT (Eingang) oder OUTPUT (Ausgang)
+* @param direction PCA9555_INPUT (Eingang) oder PCA9555_OUTPUT (Ausgang)
 * @return Erfolg: 1, Misserfolg: -1
 */
-int gnublin_module_pca9555::portMode(int port, std::string direction){
+int gnublin_module_pca9555::portMode(int port, pca9555_direction direction){
 	error_flag=false;
-	unsigned char TxBuf[1];
 
-	if (port < 0 || port > 1){
+	if ((unsigned int)port > 1){
 		error_flag=true;
 		ErrorMessage="Port Number is not between 0-1";
 		return -1;
 	}
+	if (loadShadow() < 0)
+		return -1;
 
-	if(port == 0){ // Port 0
+	return writeRegister(0x06 + port, -(int)direction);
+}
 
-			if (direction=="out"){
-				TxBuf[0]=0x00;
-				if(i2c.send(0x06, TxBuf, 1)>0){
-				return 1;
-				}
-				else {
-					error_flag=true;
-					ErrorMessage="i2c.send Error";
-					return -1;
-				}
-								
-			}
-			else if (direction=="in"){
-				TxBuf[0]=0xff;
-				if(i2c.send(0x06, TxBuf, 1)>0){
-				return 1;
-				}
-				else {
-					error_flag=true;
-					ErrorMessage="i2c.send Error";
-					return -1;
-				}
-			}
-			else{
-				error_flag=true;
-				ErrorMessage="direction != IN/OUTPUT";				
-				return -1;			
-			}
-	}
-	else if(port==1){ // Port 1
-		
-			if (direction=="out"){
-				TxBuf[0]=0x00;
-				if(i2c.send(0x07, TxBuf, 1)>0){
-				return 1;
-				}
-				else {
-					error_flag=true;
-					ErrorMessage="i2c.send Error";
-					return -1;
-				}					
-			}
-			else if (direction=="in"){
-				TxBuf[0]=0xff;
-				if(i2c.send(0x07, TxBuf, 1)>0){
-				return 1;
-				}
-				else {
-					error_flag=true;
-					ErrorMessage="i2c.send Error";
-					return -1;
-				}
-			}
-			else{
-				error_flag=true;
-				ErrorMessage="direction != IN/OUTPUT";				
-				return -1;			
-			}
+/** @~english
+* @brief Controls the port mode (INPUT/OUTPUT)
+*
+* Wrapper for portMode(int, pca9555_direction).
+* @param port Number of the port (0-1)
+* @param direction INPUT or OUTPUT
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt den Port Modus (Eingang/Ausgang)
+*
+* Wrapper für portMode(int, pca9555_direction).
+* @param port Nummer des Ports (0-1)
+* @param direction INPUT (Eingang) oder OUTPUT (Ausgang)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::portMode(int port, std::string direction){
+	if (direction=="out")
+		return portMode(port, PCA9555_OUTPUT);
+	if (direction=="in")
+		return portMode(port, PCA9555_INPUT);
+	error_flag=true;
+	ErrorMessage="direction != IN/OUTPUT";
+	return -1;
+}
+
+//-----------------------------------Port Mode Masked-----------------------------------
+/** @~english
+* @brief Controls the mode of some pins of a port with one I2C message
+*
+* The pins selected by mask get the direction, the other pins keep theirs.
+* @param port Number of the port (0-1)
+* @param mask bit n = 1: pin n of the port is changed
+* @param direction PCA9555_INPUT or PCA9555_OUTPUT
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt den Modus einiger Pins eines Ports mit einer I2C Nachricht
+*
+* Die mit mask ausgewählten Pins erhalten die Richtung, die anderen Pins behalten ihre.
+* @param port Nummer des Ports (0-1)
+* @param mask Bit n = 1: Pin n des Ports wird geändert
+* @param direction PCA9555_INPUT (Eingang) oder PCA9555_OUTPUT (Ausgang)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::portModeMasked(int port, unsigned char mask, pca9555_direction direction){
+	error_flag=false;
+
+	if ((unsigned int)port > 1){
+		error_flag=true;
+		ErrorMessage="Port Number is not between 0-1";
+		return -1;
 	}
-	else return -1;
+	if (loadShadow() < 0)
+		return -1;
+
+	return writeRegister(0x06 + port, (shadow[0x06 + port] & ~mask) | (mask & -(int)direction));
 }
 
 
@@ -310,98 +278,24 @@ int gnublin_module_pca9555::portMode(int port, std::string direction){
 */
 int gnublin_module_pca9555::digitalWrite(int pin, int value){
 	error_flag=false;
-	unsigned char TxBuf[1];
-	unsigned char RxBuf[1];
 
-	if (pin < 0 || pin > 15){
+	if ((unsigned int)pin > 15){
 		error_flag=true;
 		ErrorMessage="Pin Number is not between 0-15";
 		return -1;
 	}
-
-
-	if(pin >= 0 && pin <= 7){ // Port 0
-
-			TxBuf[0]=pow(2, pin); //convert pin into its binary form e. g. Pin 3 = 8
-
-			if (i2c.receive(0x02, RxBuf, 1)>0){ //read the current state
-
-				if (value==0){
-					TxBuf[0]=(RxBuf[0] & ~TxBuf[0]); // at low you have to invert the pin you want to set and do a AND to change only the pin you want 
-					if(i2c.send(0x02, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}
-									
-				}
-				else if (value==1){
-					TxBuf[0]=(RxBuf[0] | TxBuf[0]); // at high you just have to do a OR
-					if(i2c.send(0x02, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}
-				}
-				else{
-					error_flag=true;
-					ErrorMessage="value != 1/0";				
-					return -1;			
-				}
-			}
-			else {
-			error_flag=true;
-			ErrorMessage="i2c.receive Error";
-			return -1;
-			}
-	}
-	else if(pin >= 8 && pin <= 15){ // Port 1
-
-			TxBuf[0]=pow(2, (pin-8)); //convert pin into its binary form e. g. Pin 3 = 8
-
-			if(i2c.receive(0x03, RxBuf, 1)>0){ //read the current state
-				if (value==0){
-					
-					TxBuf[0]=RxBuf[0] & ~TxBuf[0];
-					if(i2c.send(0x03, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}					
-				}
-				else if (value==1){
-					TxBuf[0]=RxBuf[0] | TxBuf[0];
-					if(i2c.send(0x03, TxBuf, 1)>0){
-					return 1;
-					}
-					else {
-						error_flag=true;
-						ErrorMessage="i2c.send Error";
-						return -1;
-					}
-				}
-				else{
-					error_flag=true;
-					ErrorMessage="value != HIGH/LOW";				
-					return -1;			
-				}
-			}
-			else {
-			error_flag=true;
-			ErrorMessage="i2c.receive Error";
-			return -1;
-			}
+	if ((unsigned int)value > 1){
+		error_flag=true;
+		ErrorMessage="value != HIGH/LOW";
+		return -1;
 	}
-	else return -1;
+	if (loadShadow() < 0)
+		return -1;
+
+	// output register 0x02 (pin 0-7) or 0x03 (pin 8-15)
+	unsigned char reg=0x02 + (pin >> 3);
+	unsigned char mask=1 << (pin & 7);
+	return writeRegister(reg, (shadow[reg] & ~mask) | (mask & -value));
 }
 
 //-----------------------------------write Port-----------------------------------
@@ -423,35 +317,118 @@ int gnublin_module_pca9555::digitalWrite(int pin, int value){
 */
 int gnublin_module_pca9555::writePort(int port, unsigned char value){
 	error_flag=false;
-	unsigned char buffer[1];
-	buffer[0]=value;
 
-	if(port==0){ // Port 0
-		if(i2c.send(0x02, buffer, 1)>0){
-			return 1;
-		}
-		else {
-			error_flag=true;
-			ErrorMessage="i2c.send Error";
-			return -1;
-		}
-	}
-	else if(port==1){
-		if(i2c.send(0x03, buffer, 1)>0){
-			return 1;
-		}
-		else {
-			error_flag=true;
-			ErrorMessage="i2c.send Error";
-			return -1;
-		}
-	}		
-	else{
+	if (port < 0 || port > 1){
 		error_flag=true;
 		ErrorMessage="Pin Number is not between 0-1";
-		return -1;		
+		return -1;
+	}
+	if (loadShadow() < 0)
+		return -1;
+
+	return writeRegister(0x02+port, value);
+}
+
+//-----------------------------------write Port Masked-----------------------------------
+/** @~english
+* @brief  Changes some pins of a port with one I2C message
+*
+* The pins selected by mask get the levels of the corresponding bits of value, the other pins keep their levels.
+* @param port Number of the port (0-1)
+* @param mask bit n = 1: pin n of the port is changed
+* @param value new levels
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Ändert einige Pins eines Ports mit einer I2C Nachricht
+*
+* Die mit mask ausgewählten Pins erhalten die Pegel der entsprechenden Bits von value, die anderen Pins behalten ihre Pegel.
+* @param port Nummer des Ports (0-1)
+* @param mask Bit n = 1: Pin n des Ports wird geändert
+* @param value neue Pegel
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::writePortMasked(int port, unsigned char mask, unsigned char value){
+	error_flag=false;
+
+	if ((unsigned int)port > 1){
+		error_flag=true;
+		ErrorMessage="Port Number is not between 0-1";
+		return -1;
+	}
+	if (loadShadow() < 0)
+		return -1;
+
+	return writeRegister(0x02 + port, (shadow[0x02 + port] & ~mask) | (value & mask));
+}
+
+//-----------------------------------write Ports-----------------------------------
+/** @~english
+* @brief  Writes both ports with one I2C message
+*
+* Port 0 and port 1 are written with one message (register pair auto-increment), so all 16 outputs change at the same time.
+* @param value bit 0-7: port 0, bit 8-15: port 1 (pin n = bit n)
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Schreibt beide Ports mit einer I2C Nachricht
+*
+* Port 0 und Port 1 werden mit einer Nachricht geschrieben (automatisches Weiterschalten im Registerpaar), alle 16 Ausgänge ändern sich also gleichzeitig.
+* @param value Bit 0-7: Port 0, Bit 8-15: Port 1 (Pin n = Bit n)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::writePorts(uint16_t value){
+	error_flag=false;
+
+	if (loadShadow() < 0)
+		return -1;
+
+	return writeRegisters(0x02, value);
+}
+
+//-----------------------------------read Ports-----------------------------------
+/** @~english
+* @brief  Reads the inputs of both ports with one I2C transaction
+*
+* @return bit 0-7: port 0, bit 8-15: port 1 (pin n = bit n), failure: -1
+*
+* @~german
+* @brief Liest die Eingänge beider Ports mit einer I2C Transaktion
+*
+* @return Bit 0-7: Port 0, Bit 8-15: Port 1 (Pin n = Bit n), Misserfolg: -1
+*/
+int gnublin_module_pca9555::readPorts(){
+	error_flag=false;
+	unsigned char RxBuf[2];
+
+	if (i2c.receive(0x00, RxBuf, 2) < 0) {
+		error_flag=true;
+		ErrorMessage="i2c.receive Error";
+		return -1;
 	}
-	
+	return RxBuf[0] | (RxBuf[1] << 8);
+}
+
+//-----------------------------------set Direction 16-----------------------------------
+/** @~english
+* @brief  Sets the direction of all 16 pins with one I2C message
+*
+* @param inputs bit n = 1: pin n is an input, bit n = 0: pin n is an output
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Richtung aller 16 Pins mit einer I2C Nachricht
+*
+* @param inputs Bit n = 1: Pin n ist ein Eingang, Bit n = 0: Pin n ist ein Ausgang
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::setDirection16(uint16_t inputs){
+	error_flag=false;
+
+	if (loadShadow() < 0)
+		return -1;
+
+	return writeRegisters(0x06, inputs);
 }
 
 //-----------------------------------digital read-----------------------------------
@@ -473,61 +450,726 @@ int gnublin_module_pca9555::digitalRead(int pin) {
 	error_flag=false;
 	unsigned char RxBuf[1];
 
-	if (pin < 0 || pin > 15){
+	if ((unsigned int)pin > 15){
 		error_flag=true;
 		ErrorMessage="Pin Number is not between 0-15\n";
 		return -1;
 	}
-	
-	if(pin >= 0 && pin <= 7){ // Port 0		
-		if(i2c.receive(0x00, RxBuf, 1)>0){
-
-				RxBuf[0]<<=(7-pin); // MSB is now the pin you want to read from
-				RxBuf[0]&=128; // set all bits to 0 except the MSB
-		
-				if(RxBuf[0]==0){
-					return 0;
-				}
-				else if (RxBuf[0]==128){
-					return 1;
-				}
-				else{
-					error_flag=true;
-					ErrorMessage="bitshift failed\n";
-					return -1;
-				}
-		}
-		else{
-			error_flag=true;
-			ErrorMessage="i2c.receive Error";
-			return -1;
-		}
+
+	// input register 0x00 (pin 0-7) or 0x01 (pin 8-15)
+	if(i2c.receive(pin >> 3, RxBuf, 1) < 0){
+		error_flag=true;
+		ErrorMessage="i2c.receive Error";
+		return -1;
 	}
-	else if(pin >= 8 && pin <= 15){ // Port 1
-		if(i2c.receive(0x01, RxBuf, 1)>0){
-
-				RxBuf[0]<<=(15-pin); // MSB is now the pin you want to read from
-				RxBuf[0]&=128;	// set all bits to 0 except the MSB	
-		
-				if(RxBuf[0]==0){
-					return 0;
-				}
-				else if (RxBuf[0]==128){
-					return 1;
-				}
-				else{
-					error_flag=true;
-					ErrorMessage="bitshift failed\n";
-					return -1;
-				}
-		}
-		else{
-			error_flag=true;
-			ErrorMessage="i2c.receive Error";
-			return -1;
-		}
+	return (RxBuf[0] >> (pin & 7)) & 1;
+}
+
+
+//-----------------------------------set Polarity-----------------------------------
+/** @~english
+* @brief inverts the polarity of an input pin
+*
+* If the polarity of a pin is inverted, digitalRead() returns 1 for a low level and 0 for a high level.
+* @param pin Number of the pin (0-15)
+* @param inverted 1: inverted, 0: normal
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief invertiert die Polarität eines Eingangs
+*
+* Ist die Polarität eines Pins invertiert, liefert digitalRead() bei low Pegel 1 und bei high Pegel 0.
+* @param pin Nummer des Pins (0-15)
+* @param inverted 1: invertiert, 0: normal
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::setPolarity(int pin, int inverted){
+	error_flag=false;
+
+	if ((unsigned int)pin > 15){
+		error_flag=true;
+		ErrorMessage="Pin Number is not between 0-15";
+		return -1;
 	}
-	error_flag=true;
-	ErrorMessage="something went wrong";
-	return -1;
+	if (loadShadow() < 0)
+		return -1;
+
+	// polarity register 0x04 (pin 0-7) or 0x05 (pin 8-15)
+	unsigned char reg=0x04 + (pin >> 3);
+	unsigned char mask=1 << (pin & 7);
+	return writeRegister(reg, (shadow[reg] & ~mask) | (mask & -(inverted != 0)));
+}
+
+
+//-----------------------------------resync-----------------------------------
+/** @~english
+* @brief reads the output, polarity and configuration registers into the shadow registers
+*
+* pinMode(), digitalWrite(), ... modify a copy of these registers and only write the changed register, so each change is one I2C transfer and a write of an unchanged value none.
+* The copy is read once before the first change. Call resync() if another program or a reset of the chip changed the registers.
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief liest die Ausgangs-, Polaritäts- und Konfigurationsregister in die Schattenregister
+*
+* pinMode(), digitalWrite(), ... ändern eine Kopie dieser Register und schreiben nur das geänderte Register, jede Änderung ist also ein I2C Transfer und das Schreiben eines unveränderten Werts keiner.
+* Die Kopie wird einmal vor der ersten Änderung gelesen. resync() muss aufgerufen werden, wenn ein anderes Programm oder ein Reset des Chips die Register verändert hat.
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::resync(){
+	// the PCA9555 only toggles between the two registers of a pair, so every pair is a separate message
+	unsigned char regs[3]={0x02, 0x04, 0x06};
+	struct i2c_msg msgs[6];
+
+	error_flag=false;
+	for (int i = 0; i < 3; i++) {
+		msgs[2*i].addr=i2c.getAddress();
+		msgs[2*i].flags=0;
+		msgs[2*i].len=1;
+		msgs[2*i].buf=&regs[i];
+		msgs[2*i+1].addr=i2c.getAddress();
+		msgs[2*i+1].flags=I2C_M_RD;
+		msgs[2*i+1].len=2;
+		msgs[2*i+1].buf=&shadow[regs[i]];
+	}
+	if (i2c.transfer(msgs, 6) < 0) {
+		error_flag=true;
+		ErrorMessage="i2c.receive Error";
+		shadow_valid=false;
+		return -1;
+	}
+	shadow_valid=true;
+	return 1;
+}
+
+
+//-----------------------------------set Verify-----------------------------------
+/** @~english
+* @brief switches the verify-on-write debug mode
+*
+* If enabled, every written register is read back and compared with the shadow register.
+* A difference is reported as failure, e.g. if the chip was reset in between.
+* @param verify true: verify every write, false: don't verify (default)
+*
+* @~german
+* @brief schaltet den Debug Modus zur Prüfung jedes Schreibvorgangs
+*
+* Ist er eingeschaltet, wird jedes geschriebene Register zurückgelesen und mit dem Schattenregister verglichen.
+* Eine Abweichung wird als Fehler gemeldet, z.B. wenn der Chip zwischendurch zurückgesetzt wurde.
+* @param verify true: jeden Schreibvorgang prüfen, false: nicht prüfen (Standard)
+*/
+void gnublin_module_pca9555::setVerify(bool verify){
+	verify_flag=verify;
+}
+
+
+// reads the shadow registers before the first change
+int gnublin_module_pca9555::loadShadow(){
+	if (shadow_valid)
+		return 1;
+	return resync();
+}
+
+// writes one register and updates its shadow register, a register which already has the value isn't written
+int gnublin_module_pca9555::writeRegister(unsigned char reg, unsigned char value){
+	unsigned char buffer[1];
+
+	if (value == shadow[reg] && !verify_flag)
+		return 1;
+	buffer[0]=value;
+	if (i2c.send(reg, buffer, 1) < 0) {
+		error_flag=true;
+		ErrorMessage="i2c.send Error";
+		return -1;
+	}
+	shadow[reg]=value;
+	if (verify_flag) {
+		if (i2c.receive(reg, buffer, 1) < 0) {
+			error_flag=true;
+			ErrorMessage="i2c.receive Error";
+			return -1;
+		}
+		if (buffer[0] != value) {
+			error_flag=true;
+			ErrorMessage="verify failed: register " + numberToString(reg) + " is " + numberToString(buffer[0]) + " instead of " + numberToString(value) + "\n";
+			return -1;
+		}
+	}
+	return 1;
+}
+
+// writes both registers of a pair in one message and updates their shadow registers
+int gnublin_module_pca9555::writeRegisters(unsigned char reg, uint16_t value){
+	unsigned char buffer[2];
+
+	if (value == (shadow[reg] | shadow[reg+1] << 8) && !verify_flag)
+		return 1;
+	buffer[0]=value & 0xff;
+	buffer[1]=value >> 8;
+	if (i2c.send(reg, buffer, 2) < 0) {
+		error_flag=true;
+		ErrorMessage="i2c.send Error";
+		return -1;
+	}
+	shadow[reg]=buffer[0];
+	shadow[reg+1]=buffer[1];
+	if (verify_flag) {
+		if (i2c.receive(reg, buffer, 2) < 0) {
+			error_flag=true;
+			ErrorMessage="i2c.receive Error";
+			return -1;
+		}
+		if (buffer[0] != shadow[reg] || buffer[1] != shadow[reg+1]) {
+			error_flag=true;
+			ErrorMessage="verify failed: register pair " + numberToString(reg) + " is " + numberToString(buffer[0] | buffer[1] << 8) + " instead of " + numberToString(value) + "\n";
+			return -1;
+		}
+	}
+	return 1;
+}
+
+
+//-----------------------------------get Transactions-----------------------------------
+/** @~english
+* @brief returns the number of I2C transactions done by this object
+*
+* @return number of transactions
+*
+* @~german
+* @brief gibt die Anzahl der I2C Transaktionen dieses Objekts zurück
+*
+* @return Anzahl der Transaktionen
+*/
+unsigned int gnublin_module_pca9555::getTransactions(){
+	return i2c.getTransactions();
+}
+
+
+//-----------------------------------attach Interrupt-----------------------------------
+/** @~english
+* @brief delivers input changes as events, using the INT output of the PCA9555
+*
+* INT (open drain, needs a pull-up) has to be connected to a GPIO. On every falling edge both input ports are read with one transaction,
+* which also releases INT, and compared with the previous state. Every changed pin is delivered as EVENT_PIN_CHANGE
+* (device: I2C address, source: pin 0-15, value: new level). As long as no input changes, there is no bus traffic.
+* @param pin GPIO the INT output is connected to
+* @param queue queue which receives the events
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief liefert Änderungen der Eingänge als Ereignisse, mit Hilfe des INT Ausgangs des PCA9555
+*
+* INT (Open Drain, benötigt einen Pull-Up) muss mit einem GPIO verbunden sein. Bei jeder fallenden Flanke werden beide Eingangsports mit einer Transaktion gelesen,
+* was INT auch zurücksetzt, und mit dem vorherigen Zustand verglichen. Jeder geänderte Pin wird als EVENT_PIN_CHANGE geliefert
+* (device: I2C Adresse, source: Pin 0-15, value: neuer Pegel). Solange sich kein Eingang ändert, gibt es keinen Bus-Verkehr.
+* @param pin GPIO, an den der INT Ausgang angeschlossen ist
+* @param queue Warteschlange, die die Ereignisse erhält
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_module_pca9555::attachInterrupt(int pin, gnublin_event_queue *queue){
+	detachInterrupt();
+	// the first read is the reference and releases a pending INT
+	snapshot=readPorts();
+	if (snapshot < 0)
+		return -1;
+	change_queue=queue;
+	int_i2c=i2c;
+	int_events=new gnublin_event_queue();
+	int_events->setCallback(intCallback, this);
+	int_edge=new gnublin_gpio_edge();
+	if (int_edge->watch(pin, "falling", int_events) < 0) {
+		ErrorMessage=int_edge->getErrorMessage();
+		detachInterrupt();
+		error_flag=true;
+		return -1;
+	}
+	error_flag=false;
+	return 1;
+}
+
+
+//-----------------------------------detach Interrupt-----------------------------------
+/** @~english
+* @brief stops delivering input changes as events
+*
+* @~german
+* @brief beendet die Lieferung von Änderungen der Eingänge als Ereignisse
+*/
+void gnublin_module_pca9555::detachInterrupt(){
+	// deleting the edge object joins its thread, so no callback runs afterwards
+	delete int_edge;
+	delete int_events;
+	int_edge=NULL;
+	int_events=NULL;
+	change_queue=NULL;
+}
+
+// called from the edge thread for every falling edge of INT
+void gnublin_module_pca9555::intCallback(const gnublin_event *event, void *arg){
+	gnublin_module_pca9555 *pca=(gnublin_module_pca9555 *)arg;
+	unsigned char RxBuf[2];
+	gnublin_event change;
+	int state, diff;
+
+	if (pca->int_i2c.receive(0x00, RxBuf, 2) < 0)
+		return;
+	state=RxBuf[0] | (RxBuf[1] << 8);
+	diff=state ^ pca->snapshot;
+	pca->snapshot=state;
+
+	change.type=EVENT_PIN_CHANGE;
+	change.device=pca->int_i2c.getAddress();
+	change.timestamp=event->timestamp;
+	while (diff) {
+		int pin=__builtin_ctz(diff);
+		diff&=diff-1;
+		change.source=pin;
+		change.value=(state >> pin) & 1;
+		pca->change_queue->push(change);
+	}
+}
+
+
+//*******************************************************************
+//Class for using several PCA9555 as one wide GPIO bank
+//*******************************************************************
+
+//------------------Konstruktor------------------
+/** @~english 
+* @brief Creates an empty bank
+*
+* @~german 
+* @brief Erzeugt eine leere Bank
+*
+*/
+gnublin_pca9555_bank::gnublin_pca9555_bank(){
+	error_flag=false;
+	bus_count=0;
+	chip_count=0;
+	shadow_valid=false;
+	transactions=0;
+}
+
+
+//-------------get Error Message-------------
+/** @~english 
+* @brief Get the last Error Message.
+*
+* This function returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german 
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_pca9555_bank::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------------------------Fail-------------------------------
+/** @~english 
+* @brief returns the error flag to check if the last operation went wrong
+*
+* @return error_flag as boolean
+*
+* @~german 
+* @brief Gibt das error_flag zurück um zu überprüfen ob die vorangegangene Operation einen Fehler auweist
+*
+* @return error_flag als bool
+*/
+bool gnublin_pca9555_bank::fail(){
+	return error_flag;
+}
+
+
+//-----------------------------------add Expander-----------------------------------
+/** @~english
+* @brief adds a PCA9555 on the default bus "/dev/i2c-1"
+*
+* @param address I2C slave address (0x20-0x27)
+* @return index of the expander, its pins are index * 16 to index * 16 + 15. failure: -1
+*
+* @~german
+* @brief fügt einen PCA9555 am Standard Bus "/dev/i2c-1" hinzu
+*
+* @param address I2C Slave Adresse (0x20-0x27)
+* @return Index des Portexpanders, seine Pins sind Index * 16 bis Index * 16 + 15. Misserfolg: -1
+*/
+int gnublin_pca9555_bank::addExpander(int address){
+	return addExpander("/dev/i2c-1", address);
+}
+
+/** @~english
+* @brief adds a PCA9555 on the given bus
+*
+* @param devicefile path to the devicefile of the bus, e.g. "/dev/i2c-0"
+* @param address I2C slave address (0x20-0x27)
+* @return index of the expander, its pins are index * 16 to index * 16 + 15. failure: -1
+*
+* @~german
+* @brief fügt einen PCA9555 am angegebenen Bus hinzu
+*
+* @param devicefile Pfad zur Geräte Datei des Busses, z.B. "/dev/i2c-0"
+* @param address I2C Slave Adresse (0x20-0x27)
+* @return Index des Portexpanders, seine Pins sind Index * 16 bis Index * 16 + 15. Misserfolg: -1
+*/
+int gnublin_pca9555_bank::addExpander(std::string devicefile, int address){
+	int b;
+
+	error_flag=false;
+	if (address < 0x20 || address > 0x27){
+		error_flag=true;
+		ErrorMessage="address is not between 0x20-0x27\n";
+		return -1;
+	}
+	if (chip_count >= PCA9555_BANK_MAX_CHIPS){
+		error_flag=true;
+		ErrorMessage="too many expanders\n";
+		return -1;
+	}
+	for (b = 0; b < bus_count; b++)
+		if (bus_devicefile[b] == devicefile)
+			break;
+	if (b == bus_count){
+		if (bus_count >= PCA9555_BANK_MAX_BUSES){
+			error_flag=true;
+			ErrorMessage="too many buses\n";
+			return -1;
+		}
+		buses[b].setDevicefile(devicefile);
+		bus_devicefile[b]=devicefile;
+		bus_count++;
+	}
+	for (int i = 0; i < chip_count; i++){
+		if (chip_bus[i] == b && chip_address[i] == address){
+			error_flag=true;
+			ErrorMessage="expander " + numberToString(address) + " already added\n";
+			return -1;
+		}
+	}
+	chip_bus[chip_count]=b;
+	chip_address[chip_count]=address;
+	shadow_valid=false;
+	return chip_count++;
+}
+
+
+//-----------------------------------size-----------------------------------
+/** @~english
+* @brief returns the number of pins
+*
+* @return 16 * number of expanders
+*
+* @~german
+* @brief gibt die Anzahl der Pins zurück
+*
+* @return 16 * Anzahl der Portexpander
+*/
+int gnublin_pca9555_bank::size(){
+	return chip_count * 16;
+}
+
+
+//-----------------------------------Pin Mode-----------------------------------
+/** @~english
+* @brief requests the mode of a pin, it is written with the next commit()
+*
+* @param pin Number of the pin (0 to size() - 1)
+* @param direction PCA9555_INPUT or PCA9555_OUTPUT
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief fordert den Modus eines Pins an, er wird mit dem nächsten commit() geschrieben
+*
+* @param pin Nummer des Pins (0 bis size() - 1)
+* @param direction PCA9555_INPUT (Eingang) oder PCA9555_OUTPUT (Ausgang)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_pca9555_bank::pinMode(int pin, pca9555_direction direction){
+	error_flag=false;
+	if ((unsigned int)pin >= (unsigned int)size()){
+		error_flag=true;
+		ErrorMessage="Pin Number is not between 0-" + numberToString(size() - 1) + "\n";
+		return -1;
+	}
+	if (loadShadow() < 0)
+		return -1;
+	uint16_t mask=1 << (pin & 15);
+	config[pin >> 4]=(config[pin >> 4] & ~mask) | (mask & -(int)direction);
+	return 1;
+}
+
+
+//-----------------------------------digital Write-----------------------------------
+/** @~english
+* @brief requests the level of an output pin, it is written with the next commit()
+*
+* @param pin Number of the pin (0 to size() - 1)
+* @param value HIGH (1) or LOW (0)
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief fordert den Pegel eines Ausgangs an, er wird mit dem nächsten commit() geschrieben
+*
+* @param pin Nummer des Pins (0 bis size() - 1)
+* @param value HIGH (1) oder LOW (0)
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_pca9555_bank::digitalWrite(int pin, int value){
+	error_flag=false;
+	if ((unsigned int)pin >= (unsigned int)size()){
+		error_flag=true;
+		ErrorMessage="Pin Number is not between 0-" + numberToString(size() - 1) + "\n";
+		return -1;
+	}
+	if ((unsigned int)value > 1){
+		error_flag=true;
+		ErrorMessage="value != HIGH/LOW";
+		return -1;
+	}
+	if (loadShadow() < 0)
+		return -1;
+	uint16_t mask=1 << (pin & 15);
+	output[pin >> 4]=(output[pin >> 4] & ~mask) | (mask & -value);
+	return 1;
+}
+
+
+//-----------------------------------commit-----------------------------------
+/** @~english
+* @brief writes the requested state to the expanders
+*
+* Only ports which differ from the shadow registers are written, both ports of an expander with one message.
+* All messages of a bus are sent with one I2C transaction, the outputs before the directions, so a pin which becomes an output starts with its new level.
+* @return number of written ports, failure: -1
+*
+* @~german
+* @brief schreibt den angeforderten Zustand in die Portexpander
+*
+* Nur Ports, die sich von den Schattenregistern unterscheiden, werden geschrieben, beide Ports eines Portexpanders mit einer Nachricht.
+* Alle Nachrichten eines Busses werden mit einer I2C Transaktion gesendet, die Ausgänge vor den Richtungen, so dass ein Pin, der zum Ausgang wird, mit seinem neuen Pegel startet.
+* @return Anzahl der geschriebenen Ports, Misserfolg: -1
+*/
+int gnublin_pca9555_bank::commit(){
+	struct i2c_msg msgs[2 * PCA9555_BANK_MAX_CHIPS];
+	unsigned char buf[2 * PCA9555_BANK_MAX_CHIPS][3];
+	int ports=0;
+
+	error_flag=false;
+	if (loadShadow() < 0)
+		return -1;
+	for (int b = 0; b < bus_count; b++){
+		int count=0;
+
+		// pass 0: output registers, pass 1: configuration registers
+		for (int pass = 0; pass < 2; pass++){
+			for (int i = 0; i < chip_count; i++){
+				if (chip_bus[i] != b)
+					continue;
+				uint16_t value=pass ? config[i] : output[i];
+				uint16_t diff=value ^ (pass ? shadow_config[i] : shadow_output[i]);
+				unsigned char reg=pass ? 0x06 : 0x02;
+				unsigned char *p=buf[count];
+
+				if (!diff)
+					continue;
+				msgs[count].addr=chip_address[i];
+				msgs[count].flags=0;
+				msgs[count].buf=p;
+				if ((diff & 0x00ff) && (diff & 0xff00)){ // both ports, the register pair auto-increments
+					p[0]=reg;
+					p[1]=value & 0xff;
+					p[2]=value >> 8;
+					msgs[count].len=3;
+					ports+=2;
+				}
+				else if (diff & 0x00ff){
+					p[0]=reg;
+					p[1]=value & 0xff;
+					msgs[count].len=2;
+					ports++;
+				}
+				else {
+					p[0]=reg + 1;
+					p[1]=value >> 8;
+					msgs[count].len=2;
+					ports++;
+				}
+				count++;
+			}
+		}
+		if (count && transfer(b, msgs, count) < 0)
+			return -1;
+		for (int i = 0; i < chip_count; i++){
+			if (chip_bus[i] == b){
+				shadow_output[i]=output[i];
+				shadow_config[i]=config[i];
+			}
+		}
+	}
+	return ports;
+}
+
+
+//-----------------------------------update-----------------------------------
+/** @~english
+* @brief reads the inputs of all expanders
+*
+* Both input ports of all expanders of a bus are read with one I2C transaction.
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief liest die Eingänge aller Portexpander
+*
+* Beide Eingangsports aller Portexpander eines Busses werden mit einer I2C Transaktion gelesen.
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_pca9555_bank::update(){
+	struct i2c_msg msgs[2 * PCA9555_BANK_MAX_CHIPS];
+	unsigned char buf[PCA9555_BANK_MAX_CHIPS][2];
+	unsigned char reg=0x00;
+
+	error_flag=false;
+	for (int b = 0; b < bus_count; b++){
+		int count=0;
+
+		for (int i = 0; i < chip_count; i++){
+			if (chip_bus[i] != b)
+				continue;
+			msgs[count].addr=chip_address[i];
+			msgs[count].flags=0;
+			msgs[count].len=1;
+			msgs[count].buf=&reg;
+			msgs[count+1].addr=chip_address[i];
+			msgs[count+1].flags=I2C_M_RD;
+			msgs[count+1].len=2;
+			msgs[count+1].buf=buf[i];
+			count+=2;
+		}
+		if (transfer(b, msgs, count) < 0)
+			return -1;
+	}
+	for (int i = 0; i < chip_count; i++)
+		inputs[i]=buf[i][0] | (buf[i][1] << 8);
+	return 1;
+}
+
+
+//-----------------------------------digital read-----------------------------------
+/** @~english
+* @brief returns the level of a pin of the last update()
+*
+* @param pin Number of the pin (0 to size() - 1)
+* @return 0/1 logical level of the pin, failure: -1
+*
+* @~german
+* @brief gibt den Pegel eines Pins vom letzten update() zurück
+*
+* @param pin Nummer des Pins (0 bis size() - 1)
+* @return 0/1 logischer Pegel des Pins, Misserfolg: -1
+*/
+int gnublin_pca9555_bank::digitalRead(int pin){
+	if ((unsigned int)pin >= (unsigned int)size())
+		return -1;
+	return (inputs[pin >> 4] >> (pin & 15)) & 1;
+}
+
+
+//-----------------------------------get Inputs-----------------------------------
+/** @~english
+* @brief returns the inputs of the last update()
+*
+* @return array with one 16 bit value per expander
+*
+* @~german
+* @brief gibt die Eingänge vom letzten update() zurück
+*
+* @return Array mit einem 16 Bit Wert pro Portexpander
+*/
+const uint16_t *gnublin_pca9555_bank::getInputs(){
+	return inputs;
+}
+
+
+//-----------------------------------resync-----------------------------------
+/** @~english
+* @brief reads the output and configuration registers of all expanders
+*
+* The requested state is reset to the state of the chips. It is read automatically before the first change.
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief liest die Ausgangs- und Konfigurationsregister aller Portexpander
+*
+* Der angeforderte Zustand wird auf den Zustand der Chips zurückgesetzt. Er wird vor der ersten Änderung automatisch gelesen.
+* @return Erfolg: 1, Misserfolg: -1
+*/
+int gnublin_pca9555_bank::resync(){
+	struct i2c_msg msgs[4 * PCA9555_BANK_MAX_CHIPS];
+	unsigned char buf[PCA9555_BANK_MAX_CHIPS][4];
+	unsigned char regs[2]={0x02, 0x06};
+
+	error_flag=false;
+	shadow_valid=false;
+	for (int b = 0; b < bus_count; b++){
+		int count=0;
+
+		for (int i = 0; i < chip_count; i++){
+			if (chip_bus[i] != b)
+				continue;
+			for (int r = 0; r < 2; r++){
+				msgs[count].addr=chip_address[i];
+				msgs[count].flags=0;
+				msgs[count].len=1;
+				msgs[count].buf=&regs[r];
+				msgs[count+1].addr=chip_address[i];
+				msgs[count+1].flags=I2C_M_RD;
+				msgs[count+1].len=2;
+				msgs[count+1].buf=&buf[i][2*r];
+				count+=2;
+			}
+		}
+		if (transfer(b, msgs, count) < 0)
+			return -1;
+	}
+	for (int i = 0; i < chip_count; i++){
+		shadow_output[i]=output[i]=buf[i][0] | (buf[i][1] << 8);
+		shadow_config[i]=config[i]=buf[i][2] | (buf[i][3] << 8);
+	}
+	shadow_valid=true;
+	return 1;
+}
+
+
+//-----------------------------------get Transactions-----------------------------------
+/** @~english
+* @brief returns the number of I2C transactions done by this bank
+*
+* @return number of transactions
+*
+* @~german
+* @brief gibt die Anzahl der I2C Transaktionen dieser Bank zurück
+*
+* @return Anzahl der Transaktionen
+*/
+unsigned int gnublin_pca9555_bank::getTransactions(){
+	return transactions;
+}
+
+int gnublin_pca9555_bank::loadShadow(){
+	if (shadow_valid)
+		return 1;
+	return resync();
+}
+
+int gnublin_pca9555_bank::transfer(int bus, struct i2c_msg *msgs, int count){
+	transactions++;
+	if (buses[bus].transfer(msgs, count) < 0){
+		error_flag=true;
+		ErrorMessage=buses[bus].getErrorMessage();
+		return -1;
+	}
+	return 1;
 }
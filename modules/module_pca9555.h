@@ -1,5 +1,12 @@
 #include "../include/includes.h"
 #include "../drivers/i2c.cpp"
+#include "../drivers/gpio_edge.h"
+
+//pin directions, the values are the bits of the configuration register
+enum pca9555_direction {
+	PCA9555_OUTPUT = 0,
+	PCA9555_INPUT = 1
+};
 
 //*******************************************************************
 //Class for accessing GNUBLIN Module-Portexpander or any PCA9555
@@ -17,15 +24,102 @@ class gnublin_module_pca9555 {
 		bool error_flag;
 		gnublin_i2c i2c;
 		std::string ErrorMessage;
+		unsigned char shadow[8]; // register copies, indexed by register number (2-7 used)
+		bool shadow_valid;
+		bool verify_flag;
+		int loadShadow();
+		int writeRegister(unsigned char reg, unsigned char value);
+		int writeRegisters(unsigned char reg, uint16_t value);
+		gnublin_gpio_edge *int_edge;
+		gnublin_event_queue *int_events;
+		gnublin_event_queue *change_queue;
+		gnublin_i2c int_i2c;
+		int snapshot;
+		gnublin_module_pca9555(const gnublin_module_pca9555 &);
+		gnublin_module_pca9555 &operator=(const gnublin_module_pca9555 &);
+		static void intCallback(const gnublin_event *event, void *arg);
 public:
 		gnublin_module_pca9555();
+		~gnublin_module_pca9555();
 		const char *getErrorMessage();
 		bool fail();
 		void setAddress(int Address);
 		void setDevicefile(std::string filename);
+		int pinMode(int pin, pca9555_direction direction);
 		int pinMode(int pin, std::string direction);
+		int portMode(int port, pca9555_direction direction);
 		int portMode(int port, std::string direction);
+		int portModeMasked(int port, unsigned char mask, pca9555_direction direction);
 		int digitalWrite(int pin, int value);
 		int digitalRead(int pin);
 		int writePort(int port, unsigned char value);
+		int writePortMasked(int port, unsigned char mask, unsigned char value);
+		int writePorts(uint16_t value);
+		int readPorts();
+		int setDirection16(uint16_t inputs);
+		int setPolarity(int pin, int inverted);
+		int resync();
+		void setVerify(bool verify);
+		int attachInterrupt(int pin, gnublin_event_queue *queue);
+		void detachInterrupt();
+		unsigned int getTransactions();
+};
+
+
+#define PCA9555_BANK_MAX_CHIPS	16
+#define PCA9555_BANK_MAX_BUSES	4
+
+//*******************************************************************
+//Class for using several PCA9555 as one wide GPIO bank
+//*******************************************************************
+/**
+* @class gnublin_pca9555_bank
+* @~english
+* @brief Maps up to 16 PCA9555 to one flat pin index space
+*
+* Pin n is pin n % 16 of the expander with the index n / 16 (the order of addExpander()).
+* pinMode() and digitalWrite() only change the requested state, commit() compares it with the shadow registers
+* and writes only the changed ports, all of them with one I2C transaction per bus.
+* update() reads the inputs of all expanders with one I2C transaction per bus.
+* @~german 
+* @brief Bildet bis zu 16 PCA9555 auf einen durchgehenden Pin Index ab
+*
+* Pin n ist Pin n % 16 des Portexpanders mit dem Index n / 16 (Reihenfolge von addExpander()).
+* pinMode() und digitalWrite() ändern nur den gewünschten Zustand, commit() vergleicht ihn mit den Schattenregistern
+* und schreibt nur die geänderten Ports, alle mit einer I2C Transaktion pro Bus.
+* update() liest die Eingänge aller Portexpander mit einer I2C Transaktion pro Bus.
+*/
+class gnublin_pca9555_bank {
+		bool error_flag;
+		std::string ErrorMessage;
+		gnublin_i2c buses[PCA9555_BANK_MAX_BUSES];
+		std::string bus_devicefile[PCA9555_BANK_MAX_BUSES];
+		int bus_count;
+		int chip_count;
+		int chip_bus[PCA9555_BANK_MAX_CHIPS];
+		int chip_address[PCA9555_BANK_MAX_CHIPS];
+		uint16_t output[PCA9555_BANK_MAX_CHIPS];	// requested state
+		uint16_t config[PCA9555_BANK_MAX_CHIPS];
+		uint16_t shadow_output[PCA9555_BANK_MAX_CHIPS];	// state of the chips
+		uint16_t shadow_config[PCA9555_BANK_MAX_CHIPS];
+		uint16_t inputs[PCA9555_BANK_MAX_CHIPS];
+		bool shadow_valid;
+		unsigned int transactions;
+		int loadShadow();
+		int transfer(int bus, struct i2c_msg *msgs, int count);
+public:
+		gnublin_pca9555_bank();
+		const char *getErrorMessage();
+		bool fail();
+		int addExpander(int address);
+		int addExpander(std::string devicefile, int address);
+		int size();
+		int pinMode(int pin, pca9555_direction direction);
+		int digitalWrite(int pin, int value);
+		int commit();
+		int update();
+		int digitalRead(int pin);
+		const uint16_t *getInputs();
+		int resync();
+		unsigned int getTransactions();
 };
@@ -18,10 +18,30 @@
 */
 gnublin_module_relay::gnublin_module_relay() {
 	error_flag=false;
+	last_transactions=0;
+	state=0;
+	min_on=0;
+	min_off=0;
+	memset(&local_wear, 0, sizeof(local_wear));
+	local_wear.magic=RELAY_WEAR_MAGIC;
+	wear=&local_wear;
+	wear_fd=-1;
 	setAddress(0x20);
 }
 
 
+//------------------Destruktor------------------
+/** @~english 
+* @brief Closes the wear state file.
+*
+* @~german 
+* @brief Schließt die Verschleiß-Zustandsdatei.
+*/
+gnublin_module_relay::~gnublin_module_relay() {
+	closeWearFile();
+}
+
+
 //-------------getErrorMessage-------------
 /** @~english 
 * @brief Get the last Error Message.
@@ -71,6 +91,9 @@ bool gnublin_module_relay::fail(){
 */
 void gnublin_module_relay::setAddress(int Address){
 	pca9555.setAddress(Address);
+	outputs=0;
+	known=0;
+	deferred_mask=0;
 }
 
 
@@ -89,6 +112,9 @@ void gnublin_module_relay::setAddress(int Address){
 */
 void gnublin_module_relay::setDevicefile(std::string filename){
 	pca9555.setDevicefile(filename);
+	outputs=0;
+	known=0;
+	deferred_mask=0;
 }
 
 //-------------------switch Pin----------------
@@ -116,17 +142,312 @@ int gnublin_module_relay::switchPin(int pin, int value) {
 		ErrorMessage="pin is not between 1-8!\n";
 		return -1;
 	}
-	if (pca9555.pinMode((pin-1), OUTPUT) < 0){
+	if (value != 0 && value != 1) {
 		error_flag=true;
-		ErrorMessage=pca9555.getErrorMessage(); //"pca9555.pinMode failed! Address correct?\n";
+		ErrorMessage="value is not 0 or 1!\n";
 		return -1;
 	}
-	if (pca9555.digitalWrite((pin-1), value) < 0) {
+	return setRelays(1 << (pin-1), value << (pin-1));
+}
+
+
+//-------------------set Relays----------------
+/** @~english 
+* @brief Switch several relays at once.
+*
+* All relays selected by mask are switched with one port write, the other relays keep their state.
+* A relay pin is configured as output with its first write, the pins of the other relays are not touched.
+* Relays which are already in the requested state are not written, relays which changed less than the minimum time ago (see setMinTime()) are deferred until flush().
+* A new request for a relay replaces its deferred one.
+* @param mask bit n-1 = 1: relay n is switched
+* @param values bit n-1: new state of relay n, close (1) or open (0)
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Schalte mehrere Relays gleichzeitig.
+*
+* Alle mit mask ausgewählten Relays werden mit einem Schreibzugriff auf den Port geschaltet, die anderen Relays behalten ihren Zustand.
+* Ein Relay Pin wird mit seinem ersten Schreibzugriff als Ausgang konfiguriert, die Pins der anderen Relays werden nicht verändert.
+* Relays, die bereits im angeforderten Zustand sind, werden nicht geschrieben, Relays, die vor weniger als der Mindestzeit geschaltet haben (siehe setMinTime()), werden bis flush() zurückgestellt.
+* Eine neue Anforderung für ein Relay ersetzt seine zurückgestellte.
+* @param mask Bit n-1 = 1: Relay n wird geschaltet
+* @param values Bit n-1: neuer Zustand von Relay n, schließen (1) oder öffnen (0)
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_relay::setRelays(uint8_t mask, uint8_t values) {
+	return apply(deferred_mask | mask, (deferred_values & ~mask) | (values & mask));
+}
+
+
+// writes the relays of mask which may switch now, the others stay deferred
+int gnublin_module_relay::apply(uint8_t mask, uint8_t values) {
+	unsigned long long now=getMonotonicTime();
+	unsigned int start=pca9555.getTransactions();
+	uint8_t send=0;
+
+	error_flag=false;
+	last_transactions=0;
+	// known relays which already have the requested state are dropped
+	mask&=~(known & ~(state ^ values));
+	for (uint8_t m=mask; m; m&=m-1) {
+		int i=__builtin_ctz(m);
+		uint8_t bit=1 << i;
+
+		if ((known & bit) && now - changed_at[i] < ((state & bit) ? min_on : min_off))
+			continue;
+		send|=bit;
+	}
+	deferred_mask=mask & ~send;
+	deferred_values=values & deferred_mask;
+	if (!send)
+		return 1;
+
+	// the outputs get their level before they are switched to output, so no relay clicks
+	if (pca9555.writePortMasked(0, send, values) < 0) {
 		error_flag=true;
-		ErrorMessage="pca9555.digitalWrite failed! Address correct?\n";		
+		ErrorMessage=pca9555.getErrorMessage();
+		last_transactions=pca9555.getTransactions()-start;
+		deferred_mask=mask;
+		deferred_values=values & mask;
 		return -1;
 	}
+	// only the written pins become outputs, the others keep the power-up level high as inputs
+	if (send & ~outputs) {
+		if (pca9555.portModeMasked(0, send & ~outputs, PCA9555_OUTPUT) < 0) {
+			error_flag=true;
+			ErrorMessage=pca9555.getErrorMessage();
+			last_transactions=pca9555.getTransactions()-start;
+			return -1;
+		}
+		outputs|=send;
+	}
+	for (uint8_t m=send; m; m&=m-1) {
+		int i=__builtin_ctz(m);
+
+		// the first write of a relay is not counted as a switch, its previous state is unknown
+		if (known & (1 << i))
+			__sync_fetch_and_add(&wear->switches[i], 1);
+		changed_at[i]=now;
+	}
+	state=(state & ~send) | (values & send);
+	known|=send;
+	last_transactions=pca9555.getTransactions()-start;
 	return 1;
 }
 
 
+//-------------------set All----------------
+/** @~english 
+* @brief Set the state of all 8 relays with one port write.
+*
+* @param values bit n-1: new state of relay n, close (1) or open (0)
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Setze den Zustand aller 8 Relays mit einem Schreibzugriff auf den Port.
+*
+* @param values Bit n-1: neuer Zustand von Relay n, schließen (1) oder öffnen (0)
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_relay::setAll(uint8_t values) {
+	return setRelays(0xff, values);
+}
+
+
+//-------------------get Transactions----------------
+/** @~english 
+* @brief Number of I2C transactions of the last switchPin(), setRelays(), setAll() or flush() call.
+*
+* @return number of transactions
+*
+* @~german 
+* @brief Anzahl der I2C Transaktionen des letzten Aufrufs von switchPin(), setRelays(), setAll() oder flush().
+*
+* @return Anzahl der Transaktionen
+*/
+unsigned int gnublin_module_relay::getTransactions() {
+	return last_transactions;
+}
+
+
+//-------------------set Min Time----------------
+/** @~english 
+* @brief Set the minimum time a relay stays closed and open.
+*
+* Protects the relays against a control loop which switches too fast. 0 disables the limit.
+* @param on_ms minimum time a relay stays closed in ms
+* @param off_ms minimum time a relay stays open in ms
+*
+* @~german 
+* @brief Setze die Mindestzeit, die ein Relay geschlossen und offen bleibt.
+*
+* Schützt die Relays vor einer Regelung, die zu schnell schaltet. 0 schaltet die Begrenzung ab.
+* @param on_ms Mindestzeit, die ein Relay geschlossen bleibt, in ms
+* @param off_ms Mindestzeit, die ein Relay offen bleibt, in ms
+*/
+void gnublin_module_relay::setMinTime(unsigned int on_ms, unsigned int off_ms) {
+	min_on=on_ms*1000ULL;
+	min_off=off_ms*1000ULL;
+}
+
+
+//-------------------flush----------------
+/** @~english 
+* @brief Write the deferred relays whose minimum time is over.
+*
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Schreibe die zurückgestellten Relays, deren Mindestzeit abgelaufen ist.
+*
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_relay::flush() {
+	if (!deferred_mask) {
+		error_flag=false;
+		last_transactions=0;
+		return 1;
+	}
+	return apply(deferred_mask, deferred_values);
+}
+
+
+//-------------------get Flush Delay----------------
+/** @~english 
+* @brief Time until the next deferred relay may be switched.
+*
+* @return delay in ms, 0: flush() switches a relay now, -1: no relay is deferred
+*
+* @~german 
+* @brief Zeit, bis das nächste zurückgestellte Relay geschaltet werden darf.
+*
+* @return Verzögerung in ms, 0: flush() schaltet jetzt ein Relay, -1: kein Relay ist zurückgestellt
+*/
+int gnublin_module_relay::getFlushDelay() {
+	unsigned long long now=getMonotonicTime();
+	unsigned long long delay=~0ULL;
+
+	if (!deferred_mask)
+		return -1;
+	for (uint8_t m=deferred_mask; m; m&=m-1) {
+		int i=__builtin_ctz(m);
+		unsigned long long min=(state & (1 << i)) ? min_on : min_off;
+		unsigned long long age=now - changed_at[i];
+		unsigned long long d=age < min ? min - age : 0;
+
+		if (d < delay)
+			delay=d;
+	}
+	return (int)((delay + 999) / 1000);
+}
+
+
+//-------------------get Deferred----------------
+/** @~english 
+* @brief Relays with a deferred request.
+*
+* @return bit n-1 = 1: relay n is deferred
+*
+* @~german 
+* @brief Relays mit einer zurückgestellten Anforderung.
+*
+* @return Bit n-1 = 1: Relay n ist zurückgestellt
+*/
+uint8_t gnublin_module_relay::getDeferred() {
+	return deferred_mask;
+}
+
+
+//-------------------open Wear File----------------
+/** @~english 
+* @brief Keep the switching cycles in a state file.
+*
+* The file is created if it does not exist and mapped into memory, so counting a switch is a plain memory access.
+* Several processes may use the same file, the counters are incremented atomically.
+* @param filename path of the state file, one file per relay board
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Speichere die Schaltspiele in einer Zustandsdatei.
+*
+* Die Datei wird angelegt, falls sie nicht existiert, und in den Speicher eingeblendet, das Zählen eines Schaltspiels ist also ein einfacher Speicherzugriff.
+* Mehrere Prozesse können dieselbe Datei verwenden, die Zähler werden atomar erhöht.
+* @param filename Pfad der Zustandsdatei, eine Datei pro Relay Board
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_relay::openWearFile(std::string filename) {
+	struct stat st;
+	gnublin_relay_wear *map;
+	int fd;
+
+	fd=open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		error_flag=true;
+		ErrorMessage="ERROR opening: " + filename + "\n";
+		return -1;
+	}
+	if (fstat(fd, &st) < 0 || (st.st_size < (off_t)sizeof(gnublin_relay_wear) && ftruncate(fd, sizeof(gnublin_relay_wear)) < 0)) {
+		close(fd);
+		error_flag=true;
+		ErrorMessage="ERROR resizing: " + filename + "\n";
+		return -1;
+	}
+	map=(gnublin_relay_wear *)mmap(NULL, sizeof(gnublin_relay_wear), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		close(fd);
+		error_flag=true;
+		ErrorMessage="ERROR mapping: " + filename + "\n";
+		return -1;
+	}
+	if (map->magic != RELAY_WEAR_MAGIC) {
+		memset(map, 0, sizeof(gnublin_relay_wear));
+		map->magic=RELAY_WEAR_MAGIC;
+	}
+	closeWearFile();
+	wear=map;
+	wear_fd=fd;
+	error_flag=false;
+	return 1;
+}
+
+
+//-------------------close Wear File----------------
+/** @~english 
+* @brief Close the state file, the switching cycles are counted in memory again.
+*
+* @~german 
+* @brief Schließe die Zustandsdatei, die Schaltspiele werden wieder im Speicher gezählt.
+*/
+void gnublin_module_relay::closeWearFile() {
+	if (wear_fd < 0)
+		return;
+	msync(wear, sizeof(gnublin_relay_wear), MS_ASYNC);
+	munmap(wear, sizeof(gnublin_relay_wear));
+	close(wear_fd);
+	wear=&local_wear;
+	wear_fd=-1;
+}
+
+
+//-------------------get Switch Count----------------
+/** @~english 
+* @brief Number of switching cycles of a relay.
+*
+* @param pin Number of the relay (1-8)
+* @return number of switching cycles, 0 for an invalid pin
+*
+* @~german 
+* @brief Anzahl der Schaltspiele eines Relays.
+*
+* @param pin Nummer des Relays (1-8)
+* @return Anzahl der Schaltspiele, 0 bei ungültigem Pin
+*/
+unsigned int gnublin_module_relay::getSwitchCount(int pin) {
+	if (pin < 1 || pin > 8) {
+		error_flag=true;
+		ErrorMessage="pin is not between 1-8!\n";
+		return 0;
+	}
+	error_flag=false;
+	return wear->switches[pin-1];
+}
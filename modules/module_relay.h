@@ -1,6 +1,20 @@
 #include "../include/includes.h"
 #include "module_pca9555.cpp"
 
+#define RELAY_WEAR_MAGIC	0x594c5247	// "GRLY"
+
+/**
+* @struct gnublin_relay_wear
+* @~english
+* @brief Layout of the wear state file of a relay board
+*
+* @~german
+* @brief Aufbau der Verschleiß-Zustandsdatei eines Relay Boards
+*/
+struct gnublin_relay_wear {
+	uint32_t magic;
+	uint32_t switches[8];	// switching cycles per relay
+};
 
 //****************************************************************************
 // Class for easy use of the GNUBLIN Module-Relay
@@ -11,21 +25,51 @@
 * @brief Class for accessing GNUBLIN module-relay
 *
 * The GNUBLIN Module-relay can be easily controlled with the gnublin_step API. The Module uses the I2C-Bus.
+* The switching cycles of every relay are counted, optionally in a memory mapped state file which keeps them across restarts.
+* With setMinTime() a relay stays closed or open for a minimum time, requests which come too soon are deferred until flush() and requests which restore the current state are dropped.
 * @~german 
 * @brief Klasse für den zugriff auf das GNUBLIN module-relay
 *
 * Das GNUBLIN module-relay lässt sich mit Hilfe der gnublin_relay API ganz einfach ansteuern. Das Modul nutzt die I2C-Schnittstelle.  
+* Die Schaltspiele jedes Relays werden gezählt, wahlweise in einer per mmap eingeblendeten Zustandsdatei, die sie über Neustarts hinweg erhält.
+* Mit setMinTime() bleibt ein Relay eine Mindestzeit geschlossen oder offen, zu früh kommende Anforderungen werden bis flush() zurückgestellt und Anforderungen, die den aktuellen Zustand wiederherstellen, verworfen.
 */ 
 class gnublin_module_relay {
 	gnublin_module_pca9555 pca9555;
 	bool error_flag;
 	std::string ErrorMessage;
+	uint8_t outputs;		// relay pins already configured as output
+	unsigned int last_transactions;
+	uint8_t state;
+	uint8_t known;
+	uint8_t deferred_mask;
+	uint8_t deferred_values;
+	unsigned long long changed_at[8];
+	unsigned long long min_on;
+	unsigned long long min_off;
+	gnublin_relay_wear local_wear;
+	gnublin_relay_wear *wear;
+	int wear_fd;
+	gnublin_module_relay(const gnublin_module_relay &);
+	gnublin_module_relay &operator=(const gnublin_module_relay &);
+	int apply(uint8_t mask, uint8_t values);
 public:
 	gnublin_module_relay();
+	~gnublin_module_relay();
 	const char *getErrorMessage();
 	bool fail();
 	void setAddress(int Address);
 	void setDevicefile(std::string filename);
 	int switchPin(int pin, int value);
+	int setRelays(uint8_t mask, uint8_t values);
+	int setAll(uint8_t values);
+	unsigned int getTransactions();
+	void setMinTime(unsigned int on_ms, unsigned int off_ms);
+	int flush();
+	int getFlushDelay();
+	uint8_t getDeferred();
+	int openWearFile(std::string filename);
+	void closeWearFile();
+	unsigned int getSwitchCount(int pin);
 };
 
@@ -5,18 +5,70 @@
 //Class for accessing GNUBLIN Module-step
 //*******************************************************************
 
+// TMC222 maximum velocity in full steps per second for Vmax 0-15
+static const unsigned short step_vmax_table[16] = {
+	99, 136, 167, 197, 213, 228, 243, 273, 303, 334, 364, 395, 456, 546, 729, 973
+};
+
+//-------------stepVelocity-------------
+/** @~english 
+* @brief Velocity of a TMC222 for a Vmax setting.
+*
+* @param vmax Vmax (0-15)
+* @return velocity in full steps per second, -1 for an invalid Vmax
+*
+* @~german 
+* @brief Geschwindigkeit eines TMC222 für eine Vmax Einstellung.
+*
+* @param vmax Vmax (0-15)
+* @return Geschwindigkeit in Vollschritten pro Sekunde, -1 bei ungültigem Vmax
+*/
+int stepVelocity(unsigned int vmax){
+	if (vmax > 15)
+		return -1;
+	return step_vmax_table[vmax];
+}
+
 //-------------gnublin_module_step-------------
 /** @~english 
-* @brief Set irun and vmax to the default values (irun = 15, vmax = 8).
+* @brief Set the motor parameters to the default values (irun = 15, ihold = 1, vmax = 8, vmin = 1).
 *
 * @~german 
-* @brief Setzt die Standartwerte für irun und vmax (irun = 15, vmax = 8).
+* @brief Setzt die Standartwerte der Motor Parameter (irun = 15, ihold = 1, vmax = 8, vmin = 1).
 *
 */
 gnublin_module_step::gnublin_module_step()
 {
 	irun = 15;
+	ihold = 1;
 	vmax = 8;
+	vmin = 1;
+	error_flag = false;
+	status_valid = false;
+	status_max_age = 0;
+	pthread_mutex_init(&lock, NULL);
+}
+
+gnublin_module_step::~gnublin_module_step()
+{
+	pthread_mutex_destroy(&lock);
+}
+
+//-------------fail-------------
+/** @~english 
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german 
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_module_step::fail(){
+	return error_flag;
 }
 
 //-------------getErrorMessage-------------
@@ -51,6 +103,22 @@ const char *gnublin_module_step::getErrorMessage(){
 */
 void gnublin_module_step::setAddress(int Address){
 	i2c.setAddress(Address);
+	discardStatus();
+}
+
+//-------------getAddress-------------
+/** @~english 
+* @brief Get the slave address.
+*
+* @return I2C slave address
+*
+* @~german 
+* @brief Gibt die Slave Adresse zurück.
+*
+* @return I2C Slave Adresse
+*/
+int gnublin_module_step::getAddress(){
+	return i2c.getAddress();
 }
 
 //-------------setDevicefile-------------
@@ -68,6 +136,7 @@ void gnublin_module_step::setAddress(int Address){
 */
 void gnublin_module_step::setDevicefile(std::string filename){
 	i2c.setDevicefile(filename);
+	discardStatus();
 }
 
 //-------------setIrun-------------
@@ -180,7 +249,7 @@ int gnublin_module_step::setVmin(unsigned int newVmin){
 * @return Erfolg: 1, Fehler: -1
 */
 int gnublin_module_step::writeTMC(unsigned char *TxBuf, int num){
-	if(!i2c.send(TxBuf, num)){
+	if(i2c.send(TxBuf, num) < 0){
 	    return -1;
    	}
 	else return 1;
@@ -204,7 +273,7 @@ int gnublin_module_step::writeTMC(unsigned char *TxBuf, int num){
 * @return Erfolg: 1, Fehler: -1
 */
 int gnublin_module_step::readTMC(unsigned char *RxBuf, int num){
-   	if(!i2c.receive(RxBuf, num)){
+   	if(i2c.receive(RxBuf, num) < 0){
        	return -1;
     }
 	else return 1;	
@@ -269,7 +338,7 @@ int gnublin_module_step::burnNewAddress(int new_address){
 			buffer[3] = 0x02; //set AD3 AD2 AD1 AD0
 			buffer[4] = (unsigned char) new_ad;
 
-		   	if(!i2c.send(buffer, 5)){
+		   	if(i2c.send(buffer, 5) < 0){
 			   	return -1;
 			}
 			else {
@@ -298,7 +367,7 @@ int gnublin_module_step::burnNewAddress(int new_address){
 * @return Erfolg: 1, Fehler: -1
 */
 int gnublin_module_step::getFullStatus1(){
-      	if(i2c.send(0x81)){
+      	if(i2c.send(0x81) > 0){
 		return 1;		
 	}
 	else return -1;
@@ -318,7 +387,7 @@ int gnublin_module_step::getFullStatus1(){
 * @return Erfolg: 1, Fehler: -1
 */
 int gnublin_module_step::getFullStatus2(){
-	if(i2c.send(0xfc)){
+	if(i2c.send(0xfc) > 0){
 		return 1;
 	}
 	else return -1;
@@ -338,7 +407,8 @@ int gnublin_module_step::getFullStatus2(){
 * @return Erfolg: 1, Fehler: -1
 */
 int gnublin_module_step::runInit(){
-		if(i2c.send(0x88)){
+		discardStatus();
+		if(i2c.send(0x88) > 0){
 		return 1;
 		}
 		else return -1;
@@ -359,17 +429,11 @@ int gnublin_module_step::runInit(){
 */
 int gnublin_module_step::setMotorParam(){
 	unsigned char buffer[8];
-	//SetMotorParam
-	buffer[0] = 0x89; //SetMotorParam
-	buffer[1] = 0xff; //N/A
-	buffer[2] = 0xff; //N/A
-	buffer[3] = (unsigned char) ((irun * 0x10) + ihold); //Irun & I hold
-	buffer[4] = (unsigned char) ((vmax * 0x10) + vmin); //Vmax & Vmin 
-	buffer[5] = 0x00; //status
-	buffer[6] = 0x00; //securePos
-	buffer[7] = 0x00; //StepMode
 
-    if(i2c.send(buffer, 8)){
+	buildSetMotorParam(buffer);
+
+	discardStatus();
+    if(i2c.send(buffer, 8) > 0){
 	return 1;
 	}
 	else return -1;
@@ -403,17 +467,11 @@ int gnublin_module_step::setMotorParam(unsigned int newIrun, unsigned int newIho
 	vmin=newVmin;
 
 	unsigned char buffer[8];
-	//SetMotorParam
-	buffer[0] = 0x89; //SetMotorParam
-	buffer[1] = 0xff; //N/A
-	buffer[2] = 0xff; //N/A
-	buffer[3] = (unsigned char) ((irun * 0x10) + ihold); //Irun & I hold
-	buffer[4] = (unsigned char) ((vmax * 0x10) + vmin); //Vmax & Vmin 
-	buffer[5] = 0x00; //status
-	buffer[6] = 0x00; //securePos
-	buffer[7] = 0x00; //StepMode
 
-    if(i2c.send(buffer, 8)){
+	buildSetMotorParam(buffer);
+
+	discardStatus();
+    if(i2c.send(buffer, 8) > 0){
 	return 1;
 	}
 	else return -1;
@@ -433,7 +491,8 @@ int gnublin_module_step::setMotorParam(unsigned int newIrun, unsigned int newIho
 * @return Erfolg: 1, Fehler: -1
 */
 int gnublin_module_step::hardStop(){
-		if(i2c.send(0x85)){
+		discardStatus();
+		if(i2c.send(0x85) > 0){
 		return 1;
 		}
 		else return -1;
@@ -453,7 +512,8 @@ int gnublin_module_step::hardStop(){
 * @return Erfolg: 1, Fehler: -1
 */
 int gnublin_module_step::softStop(){
-		if(i2c.send(0x8f)){
+		discardStatus();
+		if(i2c.send(0x8f) > 0){
 		return 1;
 		}
 		else return -1;
@@ -473,7 +533,8 @@ int gnublin_module_step::softStop(){
 * @return Erfolg: 1, Fehler: -1
 */
 int gnublin_module_step::resetPosition(){
-		if(i2c.send(0x86)){
+		discardStatus();
+		if(i2c.send(0x86) > 0){
 		return 1;
 		}
 		else return -1;
@@ -494,16 +555,17 @@ int gnublin_module_step::resetPosition(){
 */
 int gnublin_module_step::setPosition(int position){
 	unsigned char buffer[5];
-	buffer[0] = 0x8B;   // SetPosition Command
-	buffer[1] = 0xff;   // not avialable
-	buffer[2] = 0xff;   // not avialable
-	buffer[3] = (unsigned char) (position >> 8);  // PositionByte1 (15:8)
-	buffer[4] = (unsigned char)  position;       // PositionByte2 (7:0)
+
+	buildSetPosition(buffer, position);
 	
-	if(i2c.send(buffer, 5)){
+	pthread_mutex_lock(&lock);
+	status_valid = false;
+	if(i2c.send(buffer, 5) > 0){
+		pthread_mutex_unlock(&lock);
 		return 1;
 	}
-	else return -1;
+	pthread_mutex_unlock(&lock);
+	return -1;
 }
 
 //-------------drive-------------
@@ -511,24 +573,54 @@ int gnublin_module_step::setPosition(int position){
 * @brief Drive.
 *
 * This Funktion reads the actual position from the motor and adds the amount of given steps to drive. So you can let the motor drive an amount of steps, without heaving trouble with the absolute positions.
+* The position is always read from the motor (never from the status snapshot), and no other command of this object is sent between the read and the SetPosition.
+* @param steps steps relative to the actual position
 * @return success: 1, failure: -1
 *
 * @~german 
 * @brief Fahre.
 *
 * Diese Funktion ließt die aktuelle Position des Motors und addiert die anzahl der übergebenen Schritte. So kann man den Motor einfach um eine bestimmte Anzahl Schritte fahren lassen, ohne sich über die absoulute Position gedanken machen zu müssen.
+* Die Position wird immer vom Motor gelesen (nie aus der Status Momentaufnahme), und zwischen dem Lesen und dem SetPosition wird kein anderer Befehl dieses Objekts gesendet.
+* @param steps Schritte relativ zur aktuellen Position
 * @return Erfolg: 1, Fehler: -1
 */
 int gnublin_module_step::drive(int steps){
-	int old_position;
-	int new_position;
-
-	old_position = getActualPosition();
-	new_position = old_position+steps;
-	if(setPosition(new_position)){
-		return 1;
+	unsigned char command = 0xfc;	// GetFullStatus2
+	unsigned char fs2[8];
+	unsigned char buffer[5];
+	struct i2c_msg msgs[2];
+	int position;
+
+	msgs[0].addr = i2c.getAddress();
+	msgs[0].flags = 0;
+	msgs[0].len = 1;
+	msgs[0].buf = &command;
+	msgs[1].addr = i2c.getAddress();
+	msgs[1].flags = I2C_M_RD;
+	msgs[1].len = 8;
+	msgs[1].buf = fs2;
+
+	// no other command of this object may change the target between the read and the write
+	pthread_mutex_lock(&lock);
+	status_valid = false;
+	if (i2c.transfer(msgs, 2) < 0) {
+		error_flag = true;
+		ErrorMessage = i2c.getErrorMessage();
+		pthread_mutex_unlock(&lock);
+		return -1;
 	}
-	else return -1;
+	position = (short)(fs2[1] << 8 | fs2[2]);
+	buildSetPosition(buffer, position + steps);
+	if (i2c.send(buffer, 5) < 0) {
+		error_flag = true;
+		ErrorMessage = i2c.getErrorMessage();
+		pthread_mutex_unlock(&lock);
+		return -1;
+	}
+	error_flag = false;
+	pthread_mutex_unlock(&lock);
+	return 1;
 }
 
 //-------------getMotionStatus-------------
@@ -564,15 +656,11 @@ int gnublin_module_step::drive(int steps){
 * @return motionStatus
 */
 int gnublin_module_step::getMotionStatus(){
-	unsigned char RxBuf[8];
-	int motionStatus = -1;
-	getFullStatus1();
-	
-    	if(!i2c.receive(RxBuf, 8))
+	gnublin_step_status snapshot;
+
+	if(refreshStatus(&snapshot) < 0)
 		return -1;
-	motionStatus = (RxBuf[5] & 0xe0) >> 5;
-	return motionStatus;
-	
+	return snapshot.motion;
 }
 
 
@@ -596,47 +684,296 @@ int gnublin_module_step::getMotionStatus(){
 * @return swi
 */
 int gnublin_module_step::getSwitch(){
-	unsigned char RxBuf[8];    	
-	int swi = 0;
+	gnublin_step_status snapshot;
 
-    	getFullStatus1();
-
-    	if(i2c.receive(RxBuf, 8)){
-	
-			if(RxBuf[5] & 0x10){
-				swi = 1;				
-			}
-			else{
-				swi = 0;
-			}
-			return swi;
-		}	
-		else return -1;
+	if(refreshStatus(&snapshot) < 0)
+		return -1;
+	return snapshot.switch_closed ? 1 : 0;
 }
 
 //-------------------getActualPosition----------------
 /** @~english 
 * @brief Get actual position.
 *
-* This funktion sends the getActualPosition Command to the Chip and returns its actiual position.
-* @return actualPosition -1 if failure
+* This funktion returns the actual position of the status snapshot (see updateStatus()).
+* @return actualPosition as unsigned 16 bit value (0-65535), -1 if failure
 *
 * @~german 
 * @brief Aktuelle Position ausgeben.
 *
-* Diese Funktion sendet den getActualPosition Befehl an den Chip und gibt dessen aktuelle Position zurück.
-* @return actualPosition -1 bei Fehler
+* Diese Funktion gibt die aktuelle Position der Status Momentaufnahme zurück (siehe updateStatus()).
+* @return actualPosition als vorzeichenloser 16 Bit Wert (0-65535), -1 bei Fehler
 */
 int gnublin_module_step::getActualPosition(){
-	unsigned char RxBuf[8];	
-	int actualPosition=-1;
-	
-	if(getFullStatus2()==-1)
+	gnublin_step_status snapshot;
+
+	if(refreshStatus(&snapshot) < 0)
 		return -1;
-	
-	if(i2c.receive(RxBuf, 8)){
-		actualPosition = (RxBuf[1]<<8 | RxBuf[2]);
-	}	
-	return actualPosition;
+	return snapshot.position & 0xffff;
+}
+
+//-------------------updateStatus----------------
+/** @~english 
+* @brief Take a new status snapshot.
+*
+* Sends GetFullStatus1 and GetFullStatus2 and reads both answers in one bus transaction, then decodes all fields.
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Erstellt eine neue Status Momentaufnahme.
+*
+* Sendet GetFullStatus1 und GetFullStatus2 und liest beide Antworten in einer Bus Transaktion, danach werden alle Felder dekodiert.
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::updateStatus(){
+	int result;
+
+	pthread_mutex_lock(&lock);
+	result = readStatus();
+	pthread_mutex_unlock(&lock);
+	return result;
+}
+
+// takes a new snapshot, the lock must be held
+int gnublin_module_step::readStatus(){
+	unsigned char commands[2] = { 0x81, 0xfc };	// GetFullStatus1, GetFullStatus2
+	unsigned char fs1[8], fs2[8];
+	struct i2c_msg msgs[4];
+
+	for (int i = 0; i < 2; i++) {
+		msgs[2*i].addr = i2c.getAddress();
+		msgs[2*i].flags = 0;
+		msgs[2*i].len = 1;
+		msgs[2*i].buf = &commands[i];
+		msgs[2*i+1].addr = i2c.getAddress();
+		msgs[2*i+1].flags = I2C_M_RD;
+		msgs[2*i+1].len = 8;
+		msgs[2*i+1].buf = i ? fs2 : fs1;
+	}
+	if (i2c.transfer(msgs, 4) < 0) {
+		status_valid = false;
+		error_flag = true;
+		ErrorMessage = i2c.getErrorMessage();
+		return -1;
+	}
+	status.timestamp = getMonotonicTime();
+	status.irun = fs1[1] >> 4;
+	status.ihold = fs1[1] & 0x0f;
+	status.vmax = fs1[2] >> 4;
+	status.vmin = fs1[2] & 0x0f;
+	status.acc_shape = fs1[3] & 0x80;
+	status.step_mode = (fs1[3] >> 5) & 0x03;
+	status.shaft = fs1[3] & 0x10;
+	status.acc = fs1[3] & 0x0f;
+	status.vdd_reset = fs1[4] & 0x80;
+	status.step_loss = fs1[4] & 0x40;
+	status.electrical_defect = fs1[4] & 0x20;
+	status.under_voltage = fs1[4] & 0x10;
+	status.thermal_shutdown = fs1[4] & 0x08;
+	status.thermal_warning = fs1[4] & 0x04;
+	status.temp_info = fs1[4] & 0x03;
+	status.motion = (fs1[5] & 0xe0) >> 5;
+	status.switch_closed = fs1[5] & 0x10;
+	status.overcurrent = fs1[5] & 0x0c;
+	status.charge_pump_failure = fs1[5] & 0x01;
+	status.position = (short)(fs2[1] << 8 | fs2[2]);
+	status.target = (short)(fs2[3] << 8 | fs2[4]);
+	status_valid = true;
+	error_flag = false;
+	return 1;
+}
+
+/** @~english 
+* @brief Take a new status snapshot and copy it.
+*
+* @param status the snapshot is copied to it
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Erstellt eine neue Status Momentaufnahme und kopiert sie.
+*
+* @param status hierhin wird die Momentaufnahme kopiert
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::updateStatus(gnublin_step_status *status){
+	int result;
+
+	pthread_mutex_lock(&lock);
+	result = readStatus();
+	if (result > 0)
+		*status = this->status;
+	pthread_mutex_unlock(&lock);
+	return result;
 }
 
+// copies the snapshot, a new one is taken if there is none or it is older than the allowed age
+int gnublin_module_step::refreshStatus(gnublin_step_status *status){
+	int result = 1;
+
+	pthread_mutex_lock(&lock);
+	if (status_valid && status_max_age && getMonotonicTime() - this->status.timestamp <= status_max_age)
+		error_flag = false;
+	else
+		result = readStatus();
+	if (result > 0)
+		*status = this->status;
+	pthread_mutex_unlock(&lock);
+	return result;
+}
+
+//-------------------getStatus----------------
+/** @~english 
+* @brief Get the status snapshot.
+*
+* A new snapshot is taken if the last one is older than the allowed age (see setStatusMaxAge()).
+* @param status the snapshot is copied to it
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Gibt die Status Momentaufnahme zurück.
+*
+* Eine neue Momentaufnahme wird erstellt, wenn die letzte älter als das erlaubte Alter ist (siehe setStatusMaxAge()).
+* @param status hierhin wird die Momentaufnahme kopiert
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::getStatus(gnublin_step_status *status){
+	return refreshStatus(status);
+}
+
+//-------------------setStatusMaxAge----------------
+/** @~english 
+* @brief Set how long a status snapshot is reused.
+*
+* Commands which change the motion (setPosition(), drive(), hardStop(), ...) always discard the snapshot.
+* @param ms maximum age in ms, 0: every call takes a new snapshot (default)
+*
+* @~german 
+* @brief Setzt, wie lange eine Status Momentaufnahme wiederverwendet wird.
+*
+* Befehle, die die Bewegung ändern (setPosition(), drive(), hardStop(), ...), verwerfen die Momentaufnahme immer.
+* @param ms maximales Alter in ms, 0: jeder Aufruf erstellt eine neue Momentaufnahme (Standard)
+*/
+void gnublin_module_step::setStatusMaxAge(unsigned int ms){
+	pthread_mutex_lock(&lock);
+	status_max_age = ms * 1000ULL;
+	pthread_mutex_unlock(&lock);
+}
+
+//-------------------discardStatus----------------
+/** @~english 
+* @brief Discard the status snapshot.
+*
+* Needed when a command was sent to this module by other means, e.g. with transfer() of another module or as general call.
+*
+* @~german 
+* @brief Verwirft die Status Momentaufnahme.
+*
+* Nötig, wenn ein Befehl auf anderem Weg an dieses Modul gesendet wurde, z.B. mit transfer() eines anderen Moduls oder als General Call.
+*/
+void gnublin_module_step::discardStatus(){
+	pthread_mutex_lock(&lock);
+	status_valid = false;
+	pthread_mutex_unlock(&lock);
+}
+
+//-------------------buildSetMotorParam----------------
+/** @~english 
+* @brief Build a SetMotorParam frame with the set motor parameters.
+*
+* Together with buildSetPosition() and transfer() several commands can be sent in one bus transaction.
+* @param buffer 8 bytes, the frame is stored in it
+* @return length of the frame (8)
+*
+* @~german 
+* @brief Erstellt einen SetMotorParam Rahmen mit den eingestellten Motor Parametern.
+*
+* Zusammen mit buildSetPosition() und transfer() können mehrere Befehle in einer Bus Transaktion gesendet werden.
+* @param buffer 8 Bytes, hier wird der Rahmen gespeichert
+* @return Länge des Rahmens (8)
+*/
+int gnublin_module_step::buildSetMotorParam(unsigned char *buffer){
+	return buildSetMotorParam(buffer, vmax);
+}
+
+/** @~english 
+* @brief Build a SetMotorParam frame with another Vmax.
+*
+* The set Vmax of the module is not changed.
+* @param buffer 8 bytes, the frame is stored in it
+* @param vmax Vmax of the frame (0-15)
+* @return length of the frame (8)
+*
+* @~german 
+* @brief Erstellt einen SetMotorParam Rahmen mit einem anderen Vmax.
+*
+* Das eingestellte Vmax des Moduls wird nicht verändert.
+* @param buffer 8 Bytes, hier wird der Rahmen gespeichert
+* @param vmax Vmax des Rahmens (0-15)
+* @return Länge des Rahmens (8)
+*/
+int gnublin_module_step::buildSetMotorParam(unsigned char *buffer, unsigned int vmax){
+	buffer[0] = 0x89; //SetMotorParam
+	buffer[1] = 0xff; //N/A
+	buffer[2] = 0xff; //N/A
+	buffer[3] = (unsigned char) ((irun * 0x10) + ihold); //Irun & I hold
+	buffer[4] = (unsigned char) ((vmax * 0x10) + vmin); //Vmax & Vmin 
+	buffer[5] = 0x00; //status
+	buffer[6] = 0x00; //securePos
+	buffer[7] = 0x00; //StepMode
+	return 8;
+}
+
+//-------------------buildSetPosition----------------
+/** @~english 
+* @brief Build a SetPosition frame.
+*
+* @param buffer 5 bytes, the frame is stored in it
+* @param position target position
+* @return length of the frame (5)
+*
+* @~german 
+* @brief Erstellt einen SetPosition Rahmen.
+*
+* @param buffer 5 Bytes, hier wird der Rahmen gespeichert
+* @param position Ziel Position
+* @return Länge des Rahmens (5)
+*/
+int gnublin_module_step::buildSetPosition(unsigned char *buffer, int position){
+	buffer[0] = 0x8B;   // SetPosition Command
+	buffer[1] = 0xff;   // not avialable
+	buffer[2] = 0xff;   // not avialable
+	buffer[3] = (unsigned char) (position >> 8);  // PositionByte1 (15:8)
+	buffer[4] = (unsigned char)  position;       // PositionByte2 (7:0)
+	return 5;
+}
+
+//-------------------transfer----------------
+/** @~english 
+* @brief Send several messages in one bus transaction.
+*
+* The messages go to the bus of this module, their addresses may belong to other modules on the same bus. The status snapshot is discarded.
+* @param msgs messages (see gnublin_i2c::transfer())
+* @param count number of messages
+* @return success: 1, failure: -1
+*
+* @~german 
+* @brief Sendet mehrere Nachrichten in einer Bus Transaktion.
+*
+* Die Nachrichten gehen an den Bus dieses Moduls, ihre Adressen dürfen zu anderen Modulen am selben Bus gehören. Die Status Momentaufnahme wird verworfen.
+* @param msgs Nachrichten (siehe gnublin_i2c::transfer())
+* @param count Anzahl der Nachrichten
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_module_step::transfer(struct i2c_msg *msgs, int count){
+	pthread_mutex_lock(&lock);
+	status_valid = false;
+	if (i2c.transfer(msgs, count) < 0) {
+		error_flag = true;
+		ErrorMessage = i2c.getErrorMessage();
+		pthread_mutex_unlock(&lock);
+		return -1;
+	}
+	error_flag = false;
+	pthread_mutex_unlock(&lock);
+	return 1;
+}
@@ -1,13 +1,54 @@
+/**
+* @struct gnublin_step_status
+* @~english
+* @brief Decoded GetFullStatus1 and GetFullStatus2 frames of a TMC222
+*
+* @~german
+* @brief Dekodierte GetFullStatus1 und GetFullStatus2 Antworten eines TMC222
+*/
+struct gnublin_step_status {
+	unsigned long long timestamp;	// µs, CLOCK_MONOTONIC
+	// GetFullStatus2
+	int position;			// actual position, signed 16 bit
+	int target;			// target position, signed 16 bit
+	// GetFullStatus1
+	int motion;			// see gnublin_module_step::getMotionStatus()
+	bool switch_closed;		// ESW
+	unsigned char irun;
+	unsigned char ihold;
+	unsigned char vmax;
+	unsigned char vmin;
+	unsigned char acc;
+	unsigned char step_mode;
+	bool acc_shape;
+	bool shaft;
+	bool vdd_reset;
+	bool step_loss;
+	bool electrical_defect;
+	bool under_voltage;
+	bool overcurrent;		// OVC1 or OVC2
+	bool charge_pump_failure;
+	bool thermal_shutdown;		// TSD
+	bool thermal_warning;		// TW
+	unsigned char temp_info;	// Tinfo 0-3
+};
+
+int stepVelocity(unsigned int vmax);
+
 /**
 * @class gnublin_module_step
 * @~english
 * @brief Class for accessing GNUBLIN module-step
 *
 * The GNUBLIN Module-step can be easily controlled with the gnublin_step API. The Module uses the I2C-Bus.
+* getMotionStatus(), getSwitch() and getActualPosition() read a status snapshot, which is taken with one GetFullStatus1 and one GetFullStatus2 in one bus transaction.
+* With setStatusMaxAge() a snapshot is reused for some time, so several accessors called back to back cost one bus transaction.
 * @~german 
 * @brief Klasse für den zugriff auf das GNUBLIN module-step
 *
 * Das GNUBLIN module-step lässt sich mit Hilfe der gnublin_step API ganz einfach ansteuern. Das Modul nutzt die I2C-Schnittstelle.  
+* getMotionStatus(), getSwitch() und getActualPosition() lesen aus einer Status Momentaufnahme, die mit einem GetFullStatus1 und einem GetFullStatus2 in einer Bus Transaktion erstellt wird.
+* Mit setStatusMaxAge() wird eine Momentaufnahme eine Zeit lang wiederverwendet, so dass mehrere direkt nacheinander aufgerufene Abfragen eine Bus Transaktion kosten.
 */ 
 class gnublin_module_step {
 	gnublin_i2c i2c;
@@ -16,10 +57,21 @@ class gnublin_module_step {
 	unsigned int ihold;
 	unsigned int vmax;
 	unsigned int vmin;
+	bool error_flag;
 	std::string ErrorMessage;
+	gnublin_step_status status;
+	bool status_valid;
+	unsigned long long status_max_age;
+	pthread_mutex_t lock;		// guards the snapshot and the error state, serialises status reads and position commands
+	gnublin_module_step(const gnublin_module_step &);
+	gnublin_module_step &operator=(const gnublin_module_step &);
+	int refreshStatus(gnublin_step_status *status);
+	int readStatus();
 public:
 	gnublin_module_step();
+	~gnublin_module_step();
 	void setAddress(int Address);
+	int getAddress();
 	void setDevicefile(std::string filename);
 	bool fail();
 	int setIrun(unsigned int newIrun);
@@ -42,5 +94,14 @@ public:
 	int getActualPosition();
 	int drive(int steps);
 	int getMotionStatus();
+	int updateStatus();
+	int updateStatus(gnublin_step_status *status);
+	int getStatus(gnublin_step_status *status);
+	void setStatusMaxAge(unsigned int ms);
+	void discardStatus();
+	int buildSetMotorParam(unsigned char *buffer);
+	int buildSetMotorParam(unsigned char *buffer, unsigned int vmax);
+	int buildSetPosition(unsigned char *buffer, int position);
+	int transfer(struct i2c_msg *msgs, int count);
 	const char *getErrorMessage();
 };
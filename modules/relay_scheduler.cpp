@@ -0,0 +1,661 @@
+#include "relay_scheduler.h"
+
+//****************************************************************************
+// Class for timed switching of GNUBLIN Module-Relays
+//****************************************************************************
+
+/** @~english
+* @brief Create a scheduler for up to 4096 pending actions.
+*
+* @~german
+* @brief Erzeugt einen Scheduler für bis zu 4096 anstehende Aktionen.
+*/
+gnublin_relay_scheduler::gnublin_relay_scheduler(){
+	init(RELAY_SCHEDULER_ACTIONS);
+}
+
+/** @~english
+* @brief Create a scheduler.
+*
+* @param actions maximum number of pending actions, the memory is allocated once
+*
+* @~german
+* @brief Erzeugt einen Scheduler.
+*
+* @param actions maximale Anzahl anstehender Aktionen, der Speicher wird einmal reserviert
+*/
+gnublin_relay_scheduler::gnublin_relay_scheduler(int actions){
+	init(actions);
+}
+
+void gnublin_relay_scheduler::init(int actions){
+	error_flag = false;
+	if (actions < 2)
+		actions = 2;
+	this->actions = new relay_action[actions];
+	action_count = actions;
+	for (int i = 0; i < actions; i++)
+		this->actions[i].next = i + 1 < actions ? i + 1 : -1;
+	free_list = 0;
+	used = 0;
+	for (int l = 0; l < RELAY_WHEEL_LEVELS; l++) {
+		for (int s = 0; s < RELAY_WHEEL_SLOTS; s++) {
+			heads[l][s] = -1;
+			tails[l][s] = -1;
+		}
+	}
+	current_tick = getMonotonicTime() / 1000;
+	armed_tick = 0;
+	flush_tick = 0;
+	board_count = 0;
+	executed = 0;
+	writes = 0;
+	errors = 0;
+	jitter_sum = 0;
+	jitter_max = 0;
+	run_flag = false;
+	timer_fd = timerfd_create(CLOCK_MONOTONIC, 0);
+	if (timer_fd < 0) {
+		ErrorMessage = "timerfd_create failed\n";
+		error_flag = true;
+	}
+	pthread_mutex_init(&mutex, NULL);
+}
+
+/** @~english
+* @brief Stops the thread, pending actions are discarded.
+*
+* @~german
+* @brief Hält den Thread an, anstehende Aktionen werden verworfen.
+*/
+gnublin_relay_scheduler::~gnublin_relay_scheduler(){
+	stop();
+	if (timer_fd >= 0)
+		close(timer_fd);
+	delete [] actions;
+	pthread_mutex_destroy(&mutex);
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_relay_scheduler::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_relay_scheduler::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------addBoard-------------
+/** @~english
+* @brief Add a relay board.
+*
+* @param relay the board
+* @return index of the board, failure: -1
+*
+* @~german
+* @brief Fügt ein Relay Board hinzu.
+*
+* @param relay das Board
+* @return Index des Boards, Fehler: -1
+*/
+int gnublin_relay_scheduler::addBoard(gnublin_module_relay *relay){
+	int board;
+
+	pthread_mutex_lock(&mutex);
+	if (board_count >= RELAY_SCHEDULER_MAX_BOARDS) {
+		pthread_mutex_unlock(&mutex);
+		ErrorMessage = "too many boards\n";
+		error_flag = true;
+		return -1;
+	}
+	board = board_count;
+	boards[board] = relay;
+	for (int i = 0; i < 8; i++)
+		epochs[board][i] = 0;
+	board_count++;
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return board;
+}
+
+//-------------schedule-------------
+/** @~english
+* @brief Switch a relay after a delay.
+*
+* @param board index of the board
+* @param relay number of the relay (1-8)
+* @param value close (1) or open (0) the relay
+* @param delay_ms delay in ms
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Schaltet ein Relay nach einer Verzögerung.
+*
+* @param board Index des Boards
+* @param relay Nummer des Relays (1-8)
+* @param value schließen (1) oder öffnen (0) des Relays
+* @param delay_ms Verzögerung in ms
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_relay_scheduler::schedule(int board, int relay, int value, unsigned int delay_ms){
+	return scheduleAt(board, relay, value, getMonotonicTime() + delay_ms * 1000ULL);
+}
+
+//-------------scheduleAt-------------
+/** @~english
+* @brief Switch a relay at a point in time.
+*
+* Actions for the same relay which are due in the same ms are executed in the order they were scheduled.
+* @param board index of the board
+* @param relay number of the relay (1-8)
+* @param value close (1) or open (0) the relay
+* @param time µs, CLOCK_MONOTONIC (see getMonotonicTime()), times in the past are executed immediately
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Schaltet ein Relay zu einem Zeitpunkt.
+*
+* Aktionen für dasselbe Relay, die in derselben ms fällig sind, werden in der Reihenfolge ausgeführt, in der sie geplant wurden.
+* @param board Index des Boards
+* @param relay Nummer des Relays (1-8)
+* @param value schließen (1) oder öffnen (0) des Relays
+* @param time µs, CLOCK_MONOTONIC (siehe getMonotonicTime()), Zeitpunkte in der Vergangenheit werden sofort ausgeführt
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_relay_scheduler::scheduleAt(int board, int relay, int value, unsigned long long time){
+	int a;
+
+	if (board < 0 || board >= board_count || relay < 1 || relay > 8 || (value != 0 && value != 1)) {
+		ErrorMessage = "invalid board, relay or value\n";
+		error_flag = true;
+		return -1;
+	}
+	pthread_mutex_lock(&mutex);
+	if (free_list < 0) {
+		pthread_mutex_unlock(&mutex);
+		ErrorMessage = "too many pending actions\n";
+		error_flag = true;
+		return -1;
+	}
+	// the tick stands still while nothing is pending, catch up so the wheel doesn't have to step through the idle time
+	if (used == 0) {
+		unsigned long long now = getMonotonicTime() / 1000;
+		if (now > current_tick)
+			current_tick = now;
+	}
+	a = free_list;
+	free_list = actions[a].next;
+	used++;
+	actions[a].due = time;
+	actions[a].expires = (time + 999) / 1000;
+	if (actions[a].expires <= current_tick)
+		actions[a].expires = current_tick + 1;
+	actions[a].board = board;
+	actions[a].mask = 1 << (relay - 1);
+	actions[a].value = value << (relay - 1);
+	actions[a].epoch = epochs[board][relay - 1];
+	insert(a);
+	if (armed_tick == 0 || actions[a].expires < armed_tick)
+		arm(actions[a].expires);
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return 1;
+}
+
+//-------------pulse-------------
+/** @~english
+* @brief Close a relay for some time.
+*
+* @param board index of the board
+* @param relay number of the relay (1-8)
+* @param duration_ms time the relay stays closed in ms
+* @param delay_ms delay until the relay is closed in ms
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Schließt ein Relay für eine bestimmte Zeit.
+*
+* @param board Index des Boards
+* @param relay Nummer des Relays (1-8)
+* @param duration_ms Zeit, die das Relay geschlossen bleibt, in ms
+* @param delay_ms Verzögerung, bis das Relay geschlossen wird, in ms
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_relay_scheduler::pulse(int board, int relay, unsigned int duration_ms, unsigned int delay_ms){
+	unsigned long long on = getMonotonicTime() + delay_ms * 1000ULL;
+
+	pthread_mutex_lock(&mutex);
+	if (used + 2 > action_count) {
+		pthread_mutex_unlock(&mutex);
+		ErrorMessage = "too many pending actions\n";
+		error_flag = true;
+		return -1;
+	}
+	pthread_mutex_unlock(&mutex);
+	if (scheduleAt(board, relay, 1, on) < 0)
+		return -1;
+	return scheduleAt(board, relay, 0, on + duration_ms * 1000ULL);
+}
+
+//-------------cancel-------------
+/** @~english
+* @brief Cancel all pending actions of a relay.
+*
+* The cancelled actions keep their memory until they would have been due.
+* @param board index of the board
+* @param relay number of the relay (1-8)
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Bricht alle anstehenden Aktionen eines Relays ab.
+*
+* Die abgebrochenen Aktionen belegen ihren Speicher, bis sie fällig gewesen wären.
+* @param board Index des Boards
+* @param relay Nummer des Relays (1-8)
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_relay_scheduler::cancel(int board, int relay){
+	if (board < 0 || board >= board_count || relay < 1 || relay > 8) {
+		ErrorMessage = "invalid board or relay\n";
+		error_flag = true;
+		return -1;
+	}
+	pthread_mutex_lock(&mutex);
+	epochs[board][relay - 1]++;
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return 1;
+}
+
+//-------------start-------------
+/** @~english
+* @brief Start the scheduler thread.
+*
+* Actions can be scheduled before, they are executed as soon as the thread runs.
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Startet den Scheduler Thread.
+*
+* Aktionen können auch vorher geplant werden, sie werden ausgeführt, sobald der Thread läuft.
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_relay_scheduler::start(){
+	if (run_flag)
+		return 1;
+	if (timer_fd < 0) {
+		ErrorMessage = "timerfd_create failed\n";
+		error_flag = true;
+		return -1;
+	}
+	pthread_mutex_lock(&mutex);
+	rearm();
+	pthread_mutex_unlock(&mutex);
+	run_flag = true;
+	if (pthread_create(&thread, NULL, run, this) != 0) {
+		run_flag = false;
+		ErrorMessage = "pthread_create failed\n";
+		error_flag = true;
+		return -1;
+	}
+	error_flag = false;
+	return 1;
+}
+
+//-------------stop-------------
+/** @~english
+* @brief Stop the scheduler thread, pending actions are kept.
+*
+* @~german
+* @brief Hält den Scheduler Thread an, anstehende Aktionen bleiben erhalten.
+*/
+void gnublin_relay_scheduler::stop(){
+	struct itimerspec its;
+
+	if (!run_flag)
+		return;
+	run_flag = false;
+	// an absolute time in the past expires immediately and wakes the thread
+	memset(&its, 0, sizeof(its));
+	its.it_value.tv_nsec = 1;
+	timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+	pthread_join(thread, NULL);
+	pthread_mutex_lock(&mutex);
+	armed_tick = 0;
+	pthread_mutex_unlock(&mutex);
+}
+
+//-------------pending-------------
+/** @~english
+* @brief Get the number of pending actions.
+*
+* @return number of actions, including cancelled ones which were not due yet
+*
+* @~german
+* @brief Gibt die Anzahl anstehender Aktionen zurück.
+*
+* @return Anzahl der Aktionen, einschließlich abgebrochener, die noch nicht fällig waren
+*/
+int gnublin_relay_scheduler::pending(){
+	int n;
+
+	pthread_mutex_lock(&mutex);
+	n = used;
+	pthread_mutex_unlock(&mutex);
+	return n;
+}
+
+//-------------statistics-------------
+/** @~english
+* @brief Get the number of executed actions.
+*
+* @return number of actions
+*
+* @~german
+* @brief Gibt die Anzahl ausgeführter Aktionen zurück.
+*
+* @return Anzahl der Aktionen
+*/
+unsigned int gnublin_relay_scheduler::getExecuted(){
+	return executed;
+}
+
+/** @~english
+* @brief Get the number of port writes.
+*
+* Less writes than executed actions show how many actions were coalesced or dropped by the boards.
+* @return number of writes
+*
+* @~german
+* @brief Gibt die Anzahl der Schreibzugriffe auf die Ports zurück.
+*
+* Weniger Schreibzugriffe als ausgeführte Aktionen zeigen, wie viele Aktionen zusammengefasst oder von den Boards verworfen wurden.
+* @return Anzahl der Schreibzugriffe
+*/
+unsigned int gnublin_relay_scheduler::getWrites(){
+	return writes;
+}
+
+/** @~english
+* @brief Get the number of failed port writes.
+*
+* @return number of failed writes
+*
+* @~german
+* @brief Gibt die Anzahl fehlgeschlagener Schreibzugriffe zurück.
+*
+* @return Anzahl fehlgeschlagener Schreibzugriffe
+*/
+unsigned int gnublin_relay_scheduler::getErrors(){
+	return errors;
+}
+
+/** @~english
+* @brief Get the largest delay between due time and port write.
+*
+* @return jitter in µs
+*
+* @~german
+* @brief Gibt die größte Verzögerung zwischen Fälligkeit und Schreibzugriff zurück.
+*
+* @return Jitter in µs
+*/
+unsigned int gnublin_relay_scheduler::getMaxJitter(){
+	return jitter_max;
+}
+
+/** @~english
+* @brief Get the average delay between due time and port write.
+*
+* @return jitter in µs
+*
+* @~german
+* @brief Gibt die durchschnittliche Verzögerung zwischen Fälligkeit und Schreibzugriff zurück.
+*
+* @return Jitter in µs
+*/
+unsigned int gnublin_relay_scheduler::getAverageJitter(){
+	unsigned int avg;
+
+	pthread_mutex_lock(&mutex);
+	avg = executed ? jitter_sum / executed : 0;
+	pthread_mutex_unlock(&mutex);
+	return avg;
+}
+
+/** @~english
+* @brief Reset the counters and the jitter statistics.
+*
+* @~german
+* @brief Setzt die Zähler und die Jitter Statistik zurück.
+*/
+void gnublin_relay_scheduler::resetStatistics(){
+	pthread_mutex_lock(&mutex);
+	executed = 0;
+	writes = 0;
+	errors = 0;
+	jitter_sum = 0;
+	jitter_max = 0;
+	pthread_mutex_unlock(&mutex);
+}
+
+// appends an action to a list, the order of actions due in the same tick is kept
+void gnublin_relay_scheduler::append(int *head, int *tail, int action){
+	actions[action].next = -1;
+	if (*head < 0)
+		*head = action;
+	else
+		actions[*tail].next = action;
+	*tail = action;
+}
+
+void gnublin_relay_scheduler::insert(int action){
+	unsigned long long expires = actions[action].expires;
+	unsigned long long delta = expires - current_tick;
+	int level, slot;
+
+	if (delta < (1ULL << RELAY_WHEEL_BITS0)) {
+		level = 0;
+		slot = expires & (RELAY_WHEEL_SLOTS - 1);
+	}
+	else if (delta < (1ULL << (RELAY_WHEEL_BITS0 + RELAY_WHEEL_BITS))) {
+		level = 1;
+		slot = (expires >> RELAY_WHEEL_BITS0) & ((1 << RELAY_WHEEL_BITS) - 1);
+	}
+	else if (delta < (1ULL << (RELAY_WHEEL_BITS0 + 2 * RELAY_WHEEL_BITS))) {
+		level = 2;
+		slot = (expires >> (RELAY_WHEEL_BITS0 + RELAY_WHEEL_BITS)) & ((1 << RELAY_WHEEL_BITS) - 1);
+	}
+	else {
+		// beyond the wheel: park in the last level, the action is inserted again when that slot cascades
+		if (delta >= (1ULL << (RELAY_WHEEL_BITS0 + 3 * RELAY_WHEEL_BITS)))
+			expires = current_tick + (1ULL << (RELAY_WHEEL_BITS0 + 3 * RELAY_WHEEL_BITS)) - 1;
+		level = 3;
+		slot = (expires >> (RELAY_WHEEL_BITS0 + 2 * RELAY_WHEEL_BITS)) & ((1 << RELAY_WHEEL_BITS) - 1);
+	}
+	append(&heads[level][slot], &tails[level][slot], action);
+}
+
+// moves the actions of a slot of a higher level to the lower levels
+void gnublin_relay_scheduler::cascade(int level, int slot){
+	int a = heads[level][slot];
+
+	heads[level][slot] = -1;
+	tails[level][slot] = -1;
+	while (a >= 0) {
+		int next = actions[a].next;
+		insert(a);
+		a = next;
+	}
+}
+
+// goes to the next tick with due actions or a cascade, at most to "tick", the due actions are appended to the fired list
+void gnublin_relay_scheduler::advance(unsigned long long tick, int *fired_head, int *fired_tail){
+	int index, a;
+
+	if (used == 0) {
+		current_tick = tick;
+		return;
+	}
+	// jump over empty slots of level 0, but not over the next cascade
+	while (current_tick + 1 < tick && ((current_tick + 1) & (RELAY_WHEEL_SLOTS - 1)) != 0
+	       && heads[0][(current_tick + 1) & (RELAY_WHEEL_SLOTS - 1)] < 0)
+		current_tick++;
+	current_tick++;
+	index = current_tick & (RELAY_WHEEL_SLOTS - 1);
+	if (index == 0) {
+		int i1 = (current_tick >> RELAY_WHEEL_BITS0) & ((1 << RELAY_WHEEL_BITS) - 1);
+		cascade(1, i1);
+		if (i1 == 0) {
+			int i2 = (current_tick >> (RELAY_WHEEL_BITS0 + RELAY_WHEEL_BITS)) & ((1 << RELAY_WHEEL_BITS) - 1);
+			cascade(2, i2);
+			if (i2 == 0)
+				cascade(3, (current_tick >> (RELAY_WHEEL_BITS0 + 2 * RELAY_WHEEL_BITS)) & ((1 << RELAY_WHEEL_BITS) - 1));
+		}
+	}
+	a = heads[0][index];
+	heads[0][index] = -1;
+	tails[0][index] = -1;
+	while (a >= 0) {
+		int next = actions[a].next;
+		append(fired_head, fired_tail, a);
+		a = next;
+	}
+}
+
+void gnublin_relay_scheduler::arm(unsigned long long tick){
+	struct itimerspec its;
+
+	armed_tick = tick;
+	memset(&its, 0, sizeof(its));
+	its.it_value.tv_sec = tick / 1000;
+	its.it_value.tv_nsec = (tick % 1000) * 1000000;
+	timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+// arms the timer for the next non-empty slot of level 0, the next cascade or the next deferred relay, disarms it if nothing is pending
+void gnublin_relay_scheduler::rearm(){
+	unsigned long long tick = current_tick + 1;
+	struct itimerspec its;
+
+	if (used == 0 && flush_tick == 0) {
+		armed_tick = 0;
+		memset(&its, 0, sizeof(its));
+		timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+		return;
+	}
+	while (used && heads[0][tick & (RELAY_WHEEL_SLOTS - 1)] < 0 && (tick & (RELAY_WHEEL_SLOTS - 1)) != 0)
+		tick++;
+	if (flush_tick && (used == 0 || flush_tick < tick))
+		tick = flush_tick;
+	arm(tick);
+}
+
+void *gnublin_relay_scheduler::run(void *arg){
+	gnublin_relay_scheduler *s = (gnublin_relay_scheduler *)arg;
+	unsigned char masks[RELAY_SCHEDULER_MAX_BOARDS];
+	unsigned char values[RELAY_SCHEDULER_MAX_BOARDS];
+	uint64_t expirations;
+
+	while (s->run_flag) {
+		unsigned long long now, flush, written[RELAY_SCHEDULER_MAX_BOARDS];
+		int fired = -1, fired_tail = -1;
+
+		if (read(s->timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EINTR)
+			break;
+		if (!s->run_flag)
+			break;
+
+		now = getMonotonicTime() / 1000;
+		pthread_mutex_lock(&s->mutex);
+		while (s->current_tick < now)
+			s->advance(now, &fired, &fired_tail);
+		// coalesce the due actions per board, later actions of a relay overwrite earlier ones
+		for (int b = 0; b < s->board_count; b++)
+			masks[b] = 0;
+		for (int a = fired; a >= 0; a = s->actions[a].next) {
+			relay_action *action = &s->actions[a];
+			int bit = __builtin_ctz(action->mask);
+
+			if (action->epoch != s->epochs[action->board][bit]) {
+				action->mask = 0;	// cancelled
+				continue;
+			}
+			masks[action->board] |= action->mask;
+			values[action->board] = (values[action->board] & ~action->mask) | action->value;
+		}
+		pthread_mutex_unlock(&s->mutex);
+
+		for (int b = 0; b < s->board_count; b++) {
+			if (masks[b]) {
+				written[b] = getMonotonicTime();
+				if (s->boards[b]->setRelays(masks[b], values[b]) < 0)
+					s->errors++;
+			}
+			else if (s->boards[b]->getFlushDelay() == 0) {
+				if (s->boards[b]->flush() < 0)
+					s->errors++;
+			}
+			else
+				continue;
+			if (s->boards[b]->getTransactions())
+				s->writes++;
+		}
+		// wake up again for the earliest deferred relay
+		flush = 0;
+		for (int b = 0; b < s->board_count; b++) {
+			int delay = s->boards[b]->getFlushDelay();
+			unsigned long long tick = now + delay + 1;
+
+			if (delay >= 0 && (flush == 0 || tick < flush))
+				flush = tick;
+		}
+
+		pthread_mutex_lock(&s->mutex);
+		while (fired >= 0) {
+			relay_action *action = &s->actions[fired];
+			int next = action->next;
+
+			if (action->mask) {
+				unsigned long long jitter = written[action->board] > action->due ? written[action->board] - action->due : 0;
+				s->jitter_sum += jitter;
+				if (jitter > s->jitter_max)
+					s->jitter_max = jitter;
+				s->executed++;
+			}
+			action->next = s->free_list;
+			s->free_list = fired;
+			s->used--;
+			fired = next;
+		}
+		s->flush_tick = flush;
+		s->rearm();
+		pthread_mutex_unlock(&s->mutex);
+	}
+	return NULL;
+}
@@ -0,0 +1,99 @@
+#include "../include/includes.h"
+#include "module_relay.h"
+
+#define RELAY_SCHEDULER_MAX_BOARDS	32
+#define RELAY_SCHEDULER_ACTIONS		4096
+
+// timer wheel: 1 ms ticks, level 0 has 256 slots, levels 1-3 have 64 slots each (2^26 ms ~ 18.6 h)
+#define RELAY_WHEEL_LEVELS	4
+#define RELAY_WHEEL_SLOTS	256
+#define RELAY_WHEEL_BITS0	8
+#define RELAY_WHEEL_BITS	6
+
+//****************************************************************************
+// Class for timed switching of GNUBLIN Module-Relays
+//****************************************************************************
+/**
+* @class gnublin_relay_scheduler
+* @~english
+* @brief Executes scheduled relay actions of many relay boards in one thread
+*
+* The pending actions are kept in a hierarchical timer wheel with 1 ms ticks, so scheduling and executing an action costs constant time, independent of the number of pending actions.
+* One thread sleeps on a timerfd until the next action is due. All actions which are due in the same tick on the same board are applied with one port write (gnublin_module_relay::setRelays()).
+* The delay between due time and execution (jitter) is recorded.
+* Relays deferred by the minimum on/off time of a board (gnublin_module_relay::setMinTime()) are flushed by the thread as soon as they may switch.
+* While the scheduler runs, the boards must not be used from other threads.
+* @~german
+* @brief Führt geplante Relay Aktionen vieler Relay Boards in einem Thread aus
+*
+* Die anstehenden Aktionen liegen in einem hierarchischen Timer Wheel mit 1 ms Ticks, Planen und Ausführen einer Aktion kostet also konstante Zeit, unabhängig von der Anzahl anstehender Aktionen.
+* Ein Thread schläft auf einem timerfd, bis die nächste Aktion fällig ist. Alle Aktionen, die im selben Tick auf demselben Board fällig sind, werden mit einem Schreibzugriff auf den Port ausgeführt (gnublin_module_relay::setRelays()).
+* Die Verzögerung zwischen Fälligkeit und Ausführung (Jitter) wird aufgezeichnet.
+* Relays, die wegen der Mindestzeit eines Boards (gnublin_module_relay::setMinTime()) zurückgestellt wurden, schreibt der Thread, sobald sie schalten dürfen.
+* Während der Scheduler läuft, dürfen die Boards nicht von anderen Threads verwendet werden.
+*/
+class gnublin_relay_scheduler {
+	public:
+		gnublin_relay_scheduler();
+		gnublin_relay_scheduler(int actions);
+		~gnublin_relay_scheduler();
+		int addBoard(gnublin_module_relay *relay);
+		int schedule(int board, int relay, int value, unsigned int delay_ms);
+		int scheduleAt(int board, int relay, int value, unsigned long long time);
+		int pulse(int board, int relay, unsigned int duration_ms, unsigned int delay_ms);
+		int cancel(int board, int relay);
+		int start();
+		void stop();
+		int pending();
+		unsigned int getExecuted();
+		unsigned int getWrites();
+		unsigned int getErrors();
+		unsigned int getMaxJitter();
+		unsigned int getAverageJitter();
+		void resetStatistics();
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		struct relay_action {
+			unsigned long long due;		// µs, CLOCK_MONOTONIC
+			unsigned long long expires;	// tick
+			int board;
+			unsigned char mask;
+			unsigned char value;
+			unsigned int epoch;
+			int next;
+		};
+		gnublin_relay_scheduler(const gnublin_relay_scheduler &);
+		gnublin_relay_scheduler &operator=(const gnublin_relay_scheduler &);
+		void init(int actions);
+		static void *run(void *arg);
+		void insert(int action);
+		void append(int *head, int *tail, int action);
+		void cascade(int level, int slot);
+		void advance(unsigned long long tick, int *fired_head, int *fired_tail);
+		void arm(unsigned long long tick);
+		void rearm();
+		relay_action *actions;
+		int action_count;
+		int free_list;
+		int used;
+		int heads[RELAY_WHEEL_LEVELS][RELAY_WHEEL_SLOTS];
+		int tails[RELAY_WHEEL_LEVELS][RELAY_WHEEL_SLOTS];
+		unsigned long long current_tick;
+		unsigned long long armed_tick;
+		unsigned long long flush_tick;	// next deferred relay of a board, 0: none
+		gnublin_module_relay *boards[RELAY_SCHEDULER_MAX_BOARDS];
+		unsigned int epochs[RELAY_SCHEDULER_MAX_BOARDS][8];
+		int board_count;
+		unsigned int executed;
+		unsigned int writes;
+		unsigned int errors;
+		unsigned long long jitter_sum;
+		unsigned int jitter_max;
+		int timer_fd;
+		pthread_mutex_t mutex;
+		pthread_t thread;
+		volatile bool run_flag;
+		bool error_flag;
+		std::string ErrorMessage;
+};
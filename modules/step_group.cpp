@@ -0,0 +1,256 @@
+#include "step_group.h"
+
+//****************************************************************************
+// Class for sending commands to several GNUBLIN Module-steps at once
+//****************************************************************************
+
+/** @~english
+* @brief Create an empty group.
+*
+* @~german
+* @brief Erzeugt eine leere Gruppe.
+*/
+gnublin_step_group::gnublin_step_group(){
+	motor_count = 0;
+	broadcast = false;
+	devicefile = "/dev/i2c-1";
+	latency = 0;
+	error_flag = false;
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_step_group::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_step_group::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------addMotor-------------
+/** @~english
+* @brief Add a motor.
+*
+* @param motor the motor
+* @return index of the motor, failure: -1
+*
+* @~german
+* @brief Fügt einen Motor hinzu.
+*
+* @param motor der Motor
+* @return Index des Motors, Fehler: -1
+*/
+int gnublin_step_group::addMotor(gnublin_module_step *motor){
+	if (motor_count >= STEP_GROUP_MAX_MOTORS) {
+		ErrorMessage = "too many motors\n";
+		error_flag = true;
+		return -1;
+	}
+	motors[motor_count] = motor;
+	error_flag = false;
+	return motor_count++;
+}
+
+//-------------setBroadcast-------------
+/** @~english
+* @brief Send the commands to the general call address.
+*
+* One frame reaches all TMC222 on the bus at the same time. setMotorParam() then sends the parameters of the first motor to all motors.
+* @param broadcast true: general call, false: one frame per motor (default)
+*
+* @~german
+* @brief Sendet die Befehle an die General Call Adresse.
+*
+* Ein Rahmen erreicht alle TMC222 am Bus gleichzeitig. setMotorParam() sendet dann die Parameter des ersten Motors an alle Motoren.
+* @param broadcast true: General Call, false: ein Rahmen pro Motor (Standard)
+*/
+void gnublin_step_group::setBroadcast(bool broadcast){
+	this->broadcast = broadcast;
+}
+
+//-------------setDevicefile-------------
+/** @~english
+* @brief Set the I2C device file of the bus for emergencyStop().
+*
+* The other commands use the bus of the first motor. Default is "/dev/i2c-1".
+* @param filename path to the I2C device file
+*
+* @~german
+* @brief Setzt die I2C Gerätedatei des Busses für emergencyStop().
+*
+* Die anderen Befehle benutzen den Bus des ersten Motors. Standardmäßig wird "/dev/i2c-1" benutzt.
+* @param filename Pfad zur I2C Gerätedatei
+*/
+void gnublin_step_group::setDevicefile(std::string filename){
+	devicefile = filename;
+}
+
+// sends frames of the given length (one per motor, or the first one as general call) in one transaction
+int gnublin_step_group::send(unsigned char *frames, int length){
+	struct i2c_msg msgs[STEP_GROUP_MAX_MOTORS];
+	unsigned long long start = getMonotonicTime();
+	int count = broadcast ? 1 : motor_count;
+
+	if (motor_count == 0) {
+		ErrorMessage = "no motors\n";
+		error_flag = true;
+		return -1;
+	}
+	for (int i = 0; i < count; i++) {
+		msgs[i].addr = broadcast ? 0 : motors[i]->getAddress();
+		msgs[i].flags = 0;
+		msgs[i].len = length;
+		msgs[i].buf = &frames[i * length];
+	}
+	if (motors[0]->transfer(msgs, count) < 0) {
+		latency = getMonotonicTime() - start;
+		ErrorMessage = motors[0]->getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
+	latency = getMonotonicTime() - start;
+	for (int i = 1; i < motor_count; i++)
+		motors[i]->discardStatus();
+	error_flag = false;
+	return 1;
+}
+
+//-------------hardStop-------------
+/** @~english
+* @brief Stop all motors immediately.
+*
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Hält alle Motoren sofort an.
+*
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_group::hardStop(){
+	unsigned char frames[STEP_GROUP_MAX_MOTORS];
+
+	memset(frames, 0x85, sizeof(frames));	// HardStop
+	return send(frames, 1);
+}
+
+//-------------emergencyStop-------------
+/** @~english
+* @brief Stop all motors immediately, from a signal handler.
+*
+* Like hardStop(), but the frames go straight to a new file descriptor of the bus (see setDevicefile()) without the locks of the motors, so it may be called from a signal handler while another command of the motors is running.
+* It neither sets the error state nor the latency and does not discard the status snapshots of the motors.
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Hält alle Motoren sofort an, aus einem Signal Handler.
+*
+* Wie hardStop(), aber die Rahmen gehen ohne die Sperren der Motoren direkt an einen neuen Dateideskriptor des Busses (siehe setDevicefile()), die Funktion darf also aus einem Signal Handler aufgerufen werden, während ein anderer Befehl der Motoren läuft.
+* Sie setzt weder den Fehlerzustand noch die Latenz und verwirft die Status Momentaufnahmen der Motoren nicht.
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_group::emergencyStop(){
+	unsigned char frame = 0x85;	// HardStop
+	struct i2c_msg msgs[STEP_GROUP_MAX_MOTORS];
+	struct i2c_rdwr_ioctl_data data;
+	int count = broadcast ? 1 : motor_count;
+	int fd, result;
+
+	if (motor_count == 0)
+		return -1;
+	for (int i = 0; i < count; i++) {
+		msgs[i].addr = broadcast ? 0 : motors[i]->getAddress();
+		msgs[i].flags = 0;
+		msgs[i].len = 1;
+		msgs[i].buf = &frame;
+	}
+	data.msgs = msgs;
+	data.nmsgs = count;
+	// only async signal safe calls from here on
+	fd = open(devicefile.c_str(), O_RDWR);
+	if (fd < 0)
+		return -1;
+	result = ioctl(fd, I2C_RDWR, &data) == count ? 1 : -1;
+	close(fd);
+	return result;
+}
+
+//-------------softStop-------------
+/** @~english
+* @brief Slow down and stop all motors.
+*
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Bremst alle Motoren ab und hält sie an.
+*
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_group::softStop(){
+	unsigned char frames[STEP_GROUP_MAX_MOTORS];
+
+	memset(frames, 0x8f, sizeof(frames));	// SoftStop
+	return send(frames, 1);
+}
+
+//-------------setMotorParam-------------
+/** @~english
+* @brief Send the motor parameters of all motors.
+*
+* Every motor gets the parameters set with its own setIrun(), setVmax(), ...
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Sendet die Motor Parameter aller Motoren.
+*
+* Jeder Motor bekommt die Parameter, die mit seinem eigenen setIrun(), setVmax(), ... eingestellt wurden.
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_group::setMotorParam(){
+	unsigned char frames[STEP_GROUP_MAX_MOTORS * 8];
+
+	for (int i = 0; i < motor_count; i++)
+		motors[i]->buildSetMotorParam(&frames[i * 8]);
+	return send(frames, 8);
+}
+
+//-------------getLatency-------------
+/** @~english
+* @brief Duration of the last command from the call until the transaction was done.
+*
+* This is the worst case latency: the last motor got its command at the latest at this time after the call.
+* @return time in µs
+*
+* @~german
+* @brief Dauer des letzten Befehls vom Aufruf bis die Transaktion fertig war.
+*
+* Das ist die Latenz im ungünstigsten Fall: der letzte Motor hat seinen Befehl spätestens nach dieser Zeit bekommen.
+* @return Zeit in µs
+*/
+unsigned long long gnublin_step_group::getLatency(){
+	return latency;
+}
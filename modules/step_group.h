@@ -0,0 +1,46 @@
+#include "../include/includes.h"
+#include "module_step.h"
+
+#define STEP_GROUP_MAX_MOTORS	16
+
+//****************************************************************************
+// Class for sending commands to several GNUBLIN Module-steps at once
+//****************************************************************************
+/**
+* @class gnublin_step_group
+* @~english
+* @brief Sends HardStop, SoftStop and SetMotorParam to several gnublin_module_step in one bus transaction
+*
+* By default the command frames of all motors are sent back to back in one I2C_RDWR transaction, so the bus is opened once and the last motor gets its command about one frame time after the first one.
+* With setBroadcast() a single frame is sent to the general call address 0, which reaches every TMC222 on the bus, also the ones which are not in the group.
+* All motors must be on the same I2C bus.
+* @~german
+* @brief Sendet HardStop, SoftStop und SetMotorParam in einer Bus Transaktion an mehrere gnublin_module_step
+*
+* Standardmäßig werden die Befehls Rahmen aller Motoren direkt hintereinander in einer I2C_RDWR Transaktion gesendet, der Bus wird also einmal geöffnet und der letzte Motor bekommt seinen Befehl etwa eine Rahmenlänge nach dem ersten.
+* Mit setBroadcast() wird ein einziger Rahmen an die General Call Adresse 0 gesendet, der jeden TMC222 am Bus erreicht, auch die, die nicht in der Gruppe sind.
+* Alle Motoren müssen am selben I2C Bus hängen.
+*/
+class gnublin_step_group {
+	public:
+		gnublin_step_group();
+		int addMotor(gnublin_module_step *motor);
+		void setBroadcast(bool broadcast);
+		void setDevicefile(std::string filename);
+		int hardStop();
+		int emergencyStop();
+		int softStop();
+		int setMotorParam();
+		unsigned long long getLatency();
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		int send(unsigned char *frames, int length);
+		gnublin_module_step *motors[STEP_GROUP_MAX_MOTORS];
+		int motor_count;
+		bool broadcast;
+		std::string devicefile;
+		unsigned long long latency;
+		bool error_flag;
+		std::string ErrorMessage;
+};
@@ -0,0 +1,458 @@
+#include "step_homing.h"
+
+//****************************************************************************
+// Class for homing GNUBLIN Module-steps at their end switch
+//****************************************************************************
+
+/** @~english
+* @brief Create a homing routine without axes.
+*
+* Defaults: fast Vmax 12, slow Vmax 2, back off 200 steps, travel 30000 steps.
+*
+* @~german
+* @brief Erzeugt eine Referenzfahrt ohne Achsen.
+*
+* Standardwerte: schnelles Vmax 12, langsames Vmax 2, Rückfahrt 200 Schritte, Fahrweg 30000 Schritte.
+*/
+gnublin_step_homing::gnublin_step_homing(){
+	axis_count = 0;
+	fast_vmax = 12;
+	slow_vmax = 2;
+	backoff = 200;
+	travel = 30000;
+	min_interval = STEP_HOMING_MIN_INTERVAL * 1000ULL;
+	max_interval = STEP_HOMING_MAX_INTERVAL * 1000ULL;
+	polls = 0;
+	cancelled = 0;
+	error_flag = false;
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_step_homing::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_step_homing::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------addAxis-------------
+/** @~english
+* @brief Add an axis.
+*
+* @param motor the motor, it must be initialised (setMotorParam(), getFullStatus1(), runInit())
+* @param direction direction of the switch, 1: positive, -1: negative
+* @return index of the axis, failure: -1
+*
+* @~german
+* @brief Fügt eine Achse hinzu.
+*
+* @param motor der Motor, er muss initialisiert sein (setMotorParam(), getFullStatus1(), runInit())
+* @param direction Richtung des Schalters, 1: positiv, -1: negativ
+* @return Index der Achse, Fehler: -1
+*/
+int gnublin_step_homing::addAxis(gnublin_module_step *motor, int direction){
+	if (axis_count >= STEP_HOMING_MAX_AXES || (direction != 1 && direction != -1)) {
+		ErrorMessage = "too many axes or invalid direction\n";
+		error_flag = true;
+		return -1;
+	}
+	axes[axis_count].motor = motor;
+	axes[axis_count].direction = direction;
+	axes[axis_count].phase = HOMING_FAILED;
+	axes[axis_count].time = 0;
+	error_flag = false;
+	return axis_count++;
+}
+
+//-------------setVmax-------------
+/** @~english
+* @brief Set the velocities of the approaches.
+*
+* The Vmax of the motors is restored when they are homed.
+* @param fast Vmax of the fast approach (0-15)
+* @param slow Vmax of the slow approach (0-15), the switch position is as exact as the distance moved in the shortest interval
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Geschwindigkeiten der Anfahrten.
+*
+* Das Vmax der Motoren wird wiederhergestellt, wenn sie referenziert sind.
+* @param fast Vmax der schnellen Anfahrt (0-15)
+* @param slow Vmax der langsamen Anfahrt (0-15), die Schalter Position ist so genau wie die Strecke, die im kürzesten Abstand gefahren wird
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_homing::setVmax(unsigned int fast, unsigned int slow){
+	if (fast > 15 || slow > 15) {
+		ErrorMessage = "vmax is not between 0-15\n";
+		error_flag = true;
+		return -1;
+	}
+	fast_vmax = fast;
+	slow_vmax = slow;
+	error_flag = false;
+	return 1;
+}
+
+//-------------setBackoff-------------
+/** @~english
+* @brief Set the distance of the back off after the fast approach.
+*
+* It must be larger than the distance the motor needs to stop from the fast velocity.
+* @param steps distance in steps (1-2000), default 200
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Strecke der Rückfahrt nach der schnellen Anfahrt.
+*
+* Sie muss größer als der Bremsweg des Motors aus der schnellen Geschwindigkeit sein.
+* @param steps Strecke in Schritten (1-2000), Standard 200
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_homing::setBackoff(int steps){
+	if (steps < 1 || steps > 2000) {
+		ErrorMessage = "backoff is not between 1-2000\n";
+		error_flag = true;
+		return -1;
+	}
+	backoff = steps;
+	error_flag = false;
+	return 1;
+}
+
+//-------------setTravel-------------
+/** @~english
+* @brief Set the longest distance of the fast approach.
+*
+* An axis fails if its switch has not closed after this distance.
+* @param steps distance in steps (1-1000000), default 30000
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die längste Strecke der schnellen Anfahrt.
+*
+* Eine Achse schlägt fehl, wenn ihr Schalter nach dieser Strecke nicht geschlossen hat.
+* @param steps Strecke in Schritten (1-1000000), Standard 30000
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_homing::setTravel(int steps){
+	if (steps < 1 || steps > 1000000) {
+		ErrorMessage = "travel is not between 1-1000000\n";
+		error_flag = true;
+		return -1;
+	}
+	travel = steps;
+	error_flag = false;
+	return 1;
+}
+
+//-------------setInterval-------------
+/** @~english
+* @brief Set the limits of the polling interval.
+*
+* @param min_ms shortest interval in ms (1-1000), default 1
+* @param max_ms longest interval in ms (min_ms-10000), default 50
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Grenzen des Abfrage Intervalls.
+*
+* @param min_ms kürzestes Intervall in ms (1-1000), Standard 1
+* @param max_ms längstes Intervall in ms (min_ms-10000), Standard 50
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_homing::setInterval(int min_ms, int max_ms){
+	if (min_ms < 1 || min_ms > 1000 || max_ms < min_ms || max_ms > 10000) {
+		ErrorMessage = "invalid interval\n";
+		error_flag = true;
+		return -1;
+	}
+	min_interval = min_ms * 1000ULL;
+	max_interval = max_ms * 1000ULL;
+	error_flag = false;
+	return 1;
+}
+
+// half of the time the motor needs for the distance, between the minimum and maximum interval
+unsigned long long gnublin_step_homing::interval(unsigned int velocity, int distance){
+	unsigned long long t;
+
+	if (velocity == 0)
+		return min_interval;
+	t = distance * 500000ULL / velocity;
+	if (t < min_interval)
+		return min_interval;
+	if (t > max_interval)
+		return max_interval;
+	return t;
+}
+
+// stops the motor of a failed axis and remembers the message
+int gnublin_step_homing::failAxis(int axis, const std::string &message){
+	axes[axis].motor->softStop();
+	axes[axis].phase = HOMING_FAILED;
+	ErrorMessage = "axis " + numberToString(axis) + ": " + message + "\n";
+	return -1;
+}
+
+// starts the next chunk of the fast approach from position 0, so the target fits into the signed 16 bit position
+int gnublin_step_homing::approach(int axis){
+	homing_axis *a = &axes[axis];
+
+	a->chunk = travel - a->travelled < STEP_HOMING_CHUNK ? travel - a->travelled : STEP_HOMING_CHUNK;
+	if (a->motor->resetPosition() < 0 || a->motor->setPosition(a->direction * a->chunk) < 0)
+		return failAxis(axis, "starting the fast approach failed");
+	a->phase = HOMING_FAST;
+	return 1;
+}
+
+// remembers the Vmax and starts the fast approach, or the back off if the switch is already closed
+int gnublin_step_homing::begin(int axis, unsigned long long now){
+	homing_axis *a = &axes[axis];
+	gnublin_step_status status;
+
+	a->time = now;
+	a->next_poll = now;
+	a->travelled = 0;
+	polls++;
+	if (a->motor->updateStatus(&status) < 0)
+		return failAxis(axis, a->motor->getErrorMessage());
+	a->vmax = status.vmax;
+	if (a->motor->setVmax(fast_vmax) < 0 || a->motor->setMotorParam() < 0)
+		return failAxis(axis, "setting the fast vmax failed");
+	if (status.switch_closed) {
+		a->phase = HOMING_BACKOFF;
+		if (a->motor->resetPosition() < 0 || a->motor->setPosition(-a->direction * backoff) < 0)
+			return failAxis(axis, "starting the back off failed");
+		return 1;
+	}
+	return approach(axis);
+}
+
+// polls one axis and advances its phase
+int gnublin_step_homing::step(int axis, unsigned long long now){
+	homing_axis *a = &axes[axis];
+	gnublin_step_status status;
+	unsigned int velocity;
+	int remaining;
+	bool stopped;
+
+	polls++;
+	if (a->motor->updateStatus(&status) < 0)
+		return failAxis(axis, a->motor->getErrorMessage());
+	if (status.electrical_defect || status.thermal_shutdown)
+		return failAxis(axis, "electrical defect or thermal shutdown");
+	stopped = status.motion == 0 && status.position == status.target;
+	velocity = stepVelocity(status.vmax) * (2 << status.step_mode);
+	remaining = abs(status.target - status.position);
+
+	switch (a->phase) {
+		case HOMING_FAST:
+			if (status.switch_closed) {
+				// a soft stop would ramp down from the fast Vmax and overshoot the switch by more than the back off
+				if (a->motor->hardStop() < 0)
+					return failAxis(axis, "stopping failed");
+				a->phase = HOMING_FAST_STOP;
+			}
+			else if (stopped) {
+				a->travelled += a->chunk;
+				if (a->travelled >= travel)
+					return failAxis(axis, "switch not found");
+				if (approach(axis) < 0)
+					return -1;
+				remaining = a->chunk;
+			}
+			else {
+				// the motor must not move further than half the back off distance between two polls
+				a->next_poll = now + interval(velocity, remaining < backoff ? remaining : backoff);
+				return 1;
+			}
+			break;
+		case HOMING_FAST_STOP:
+			if (stopped) {
+				if (a->motor->setPosition(status.position - a->direction * backoff) < 0)
+					return failAxis(axis, "starting the back off failed");
+				a->phase = HOMING_BACKOFF;
+				remaining = backoff;
+			}
+			break;
+		case HOMING_BACKOFF:
+			if (stopped) {
+				if (status.switch_closed)
+					return failAxis(axis, "switch does not open");
+				if (a->motor->setVmax(slow_vmax) < 0 || a->motor->setMotorParam() < 0
+				    || a->motor->setPosition(status.position + a->direction * 2 * backoff) < 0)
+					return failAxis(axis, "starting the slow approach failed");
+				a->phase = HOMING_SLOW;
+				a->next_poll = now + min_interval;
+				return 1;
+			}
+			break;
+		case HOMING_SLOW:
+			if (status.switch_closed) {
+				if (a->motor->hardStop() < 0)
+					return failAxis(axis, "stopping failed");
+				a->phase = HOMING_SLOW_STOP;
+			}
+			else if (stopped)
+				return failAxis(axis, "switch not found");
+			else {
+				a->next_poll = now + min_interval;
+				return 1;
+			}
+			break;
+		case HOMING_SLOW_STOP:
+			if (stopped) {
+				if (a->motor->resetPosition() < 0)
+					return failAxis(axis, "resetting the position failed");
+				a->motor->setVmax(a->vmax);
+				if (a->motor->setMotorParam() < 0)
+					return failAxis(axis, "restoring the vmax failed");
+				a->time = now - a->time;
+				a->phase = HOMING_DONE;
+				return 1;
+			}
+			break;
+		default:
+			return 1;
+	}
+	a->next_poll = now + interval(velocity, remaining);
+	return 1;
+}
+
+//-------------run-------------
+/** @~english
+* @brief Home all axes and wait until they are done.
+*
+* If an axis fails, it is stopped and the other axes are homed anyway.
+* @param timeout_ms maximum time in ms, -1 waits forever; at the timeout all moving axes are stopped
+* @return all axes homed: 1, failure: -1 (the message names the failed axis)
+*
+* @~german
+* @brief Referenziert alle Achsen und wartet, bis sie fertig sind.
+*
+* Schlägt eine Achse fehl, wird sie angehalten und die anderen Achsen werden trotzdem referenziert.
+* @param timeout_ms maximale Zeit in ms, -1 wartet unbegrenzt; bei Zeitüberschreitung werden alle fahrenden Achsen angehalten
+* @return alle Achsen referenziert: 1, Fehler: -1 (die Meldung nennt die fehlgeschlagene Achse)
+*/
+int gnublin_step_homing::run(int timeout_ms){
+	unsigned long long start = getMonotonicTime();
+	unsigned long long end = start + timeout_ms * 1000ULL;
+	int result = 1;
+
+	polls = 0;
+	for (int i = 0; i < axis_count; i++) {
+		if (begin(i, start) < 0)
+			result = -1;
+	}
+	while (1) {
+		unsigned long long now = getMonotonicTime();
+		unsigned long long next = 0;
+
+		for (int i = 0; i < axis_count; i++) {
+			homing_axis *a = &axes[i];
+
+			if (a->phase == HOMING_DONE || a->phase == HOMING_FAILED)
+				continue;
+			if (cancelled) {
+				result = failAxis(i, "cancelled");
+				continue;
+			}
+			if (timeout_ms >= 0 && now >= end) {
+				result = failAxis(i, "timeout");
+				continue;
+			}
+			if (a->next_poll <= now && step(i, now) < 0) {
+				result = -1;
+				continue;
+			}
+			if (a->phase != HOMING_DONE && (next == 0 || a->next_poll < next))
+				next = a->next_poll;
+		}
+		if (next == 0)
+			break;
+		now = getMonotonicTime();
+		if (timeout_ms >= 0 && next > end)
+			next = end;
+		if (next > now)
+			usleep(next - now);
+	}
+	// the cancel is used up, the object can home again
+	cancelled = 0;
+	error_flag = result < 0;
+	return result;
+}
+
+//-------------cancel-------------
+/** @~english
+* @brief Cancel run().
+*
+* The running run(), or the next one if none is running, stops all axes which are not done yet and returns -1. Later calls of run() home again. Only a flag is set, so it may be called from a signal handler.
+*
+* @~german
+* @brief Bricht run() ab.
+*
+* Das laufende run(), oder das nächste, wenn keines läuft, hält alle noch nicht fertigen Achsen an und gibt -1 zurück. Spätere Aufrufe von run() referenzieren wieder. Es wird nur ein Flag gesetzt, die Funktion darf also aus einem Signal Handler aufgerufen werden.
+*/
+void gnublin_step_homing::cancel(){
+	cancelled = 1;
+}
+
+//-------------getTime-------------
+/** @~english
+* @brief Time an axis needed for homing in the last run().
+*
+* @param axis index of the axis
+* @return time in ms, -1 if the axis failed
+*
+* @~german
+* @brief Zeit, die eine Achse beim letzten run() für die Referenzfahrt gebraucht hat.
+*
+* @param axis Index der Achse
+* @return Zeit in ms, -1 wenn die Achse fehlgeschlagen ist
+*/
+int gnublin_step_homing::getTime(int axis){
+	if (axis < 0 || axis >= axis_count || axes[axis].phase != HOMING_DONE)
+		return -1;
+	return axes[axis].time / 1000;
+}
+
+//-------------getPolls-------------
+/** @~english
+* @brief Number of status reads in the last run().
+*
+* @return number of status reads
+*
+* @~german
+* @brief Anzahl der Status Lesezugriffe beim letzten run().
+*
+* @return Anzahl der Status Lesezugriffe
+*/
+unsigned int gnublin_step_homing::getPolls(){
+	return polls;
+}
@@ -0,0 +1,84 @@
+#include "../include/includes.h"
+#include "module_step.h"
+
+#define STEP_HOMING_MAX_AXES		8
+#define STEP_HOMING_MIN_INTERVAL	1	// ms
+#define STEP_HOMING_MAX_INTERVAL	50	// ms
+#define STEP_HOMING_CHUNK		30000	// steps of one SetPosition of the fast approach
+
+//****************************************************************************
+// Class for homing GNUBLIN Module-steps at their end switch
+//****************************************************************************
+/**
+* @class gnublin_step_homing
+* @~english
+* @brief Drives several gnublin_module_step to their end switch at the same time
+*
+* Every axis approaches its switch fast, backs off until the switch opens and approaches it again slowly. At the switch the motor is stopped with HardStop, so it does not overshoot while ramping down.
+* The fast approach is split into moves of 30000 steps, so the travel is not limited by the 16 bit position of the TMC222.
+* The position where the switch closes during the slow approach becomes position 0.
+* All axes are handled in parallel by one loop, every poll is one status read (see gnublin_module_step::updateStatus()).
+* The interval between two polls of an axis adapts to its velocity and distance: during the fast approach the motor moves at most half of the back off distance between two polls,
+* during the slow approach it is polled with the shortest interval.
+* @~german
+* @brief Fährt mehrere gnublin_module_step gleichzeitig an ihren Endschalter
+*
+* Jede Achse fährt schnell an ihren Schalter, fährt zurück, bis der Schalter öffnet, und fährt ihn langsam erneut an. Am Schalter wird der Motor mit HardStop angehalten, damit er beim Abbremsen nicht über den Schalter hinaus fährt.
+* Die schnelle Anfahrt wird in Bewegungen von 30000 Schritten aufgeteilt, der Fahrweg ist also nicht durch die 16 Bit Position des TMC222 begrenzt.
+* Die Position, an der der Schalter bei der langsamen Anfahrt schließt, wird Position 0.
+* Alle Achsen werden parallel in einer Schleife bearbeitet, jede Abfrage ist ein Status Lesezugriff (siehe gnublin_module_step::updateStatus()).
+* Der Abstand zwischen zwei Abfragen einer Achse passt sich ihrer Geschwindigkeit und Strecke an: bei der schnellen Anfahrt fährt der Motor zwischen zwei Abfragen höchstens die Hälfte der Rückfahrstrecke,
+* bei der langsamen Anfahrt wird er mit dem kürzesten Abstand abgefragt.
+*/
+class gnublin_step_homing {
+	public:
+		gnublin_step_homing();
+		int addAxis(gnublin_module_step *motor, int direction);
+		int setVmax(unsigned int fast, unsigned int slow);
+		int setBackoff(int steps);
+		int setTravel(int steps);
+		int setInterval(int min_ms, int max_ms);
+		int run(int timeout_ms);
+		void cancel();
+		int getTime(int axis);
+		unsigned int getPolls();
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		enum homing_phase {
+			HOMING_FAST,		// approaching the switch
+			HOMING_FAST_STOP,	// stopping after the switch closed
+			HOMING_BACKOFF,		// moving away until the switch opens
+			HOMING_SLOW,		// approaching the switch again
+			HOMING_SLOW_STOP,	// stopping after the switch closed again
+			HOMING_DONE,
+			HOMING_FAILED
+		};
+		struct homing_axis {
+			gnublin_module_step *motor;
+			int direction;			// 1 or -1
+			homing_phase phase;
+			unsigned int vmax;		// restored when the axis is homed
+			int travelled;			// steps of the fast approach before the current chunk
+			int chunk;			// steps of the current chunk
+			unsigned long long next_poll;	// µs, CLOCK_MONOTONIC
+			unsigned long long time;	// start time, then µs needed for homing
+		};
+		int begin(int axis, unsigned long long now);
+		int step(int axis, unsigned long long now);
+		int approach(int axis);
+		int failAxis(int axis, const std::string &message);
+		unsigned long long interval(unsigned int velocity, int distance);
+		homing_axis axes[STEP_HOMING_MAX_AXES];
+		int axis_count;
+		unsigned int fast_vmax;
+		unsigned int slow_vmax;
+		int backoff;
+		int travel;
+		unsigned long long min_interval;
+		unsigned long long max_interval;
+		unsigned int polls;
+		volatile sig_atomic_t cancelled;
+		bool error_flag;
+		std::string ErrorMessage;
+};
@@ -0,0 +1,472 @@
+#include "step_planner.h"
+
+//****************************************************************************
+// Class for coordinated moves of several GNUBLIN Module-steps
+//****************************************************************************
+
+/** @~english
+* @brief Create a planner without axes, Vmax is 8.
+*
+* @~german
+* @brief Erzeugt einen Planer ohne Achsen, Vmax ist 8.
+*/
+gnublin_step_planner::gnublin_step_planner(){
+	pthread_condattr_t attr;
+
+	axis_count = 0;
+	vmax = 8;
+	first = 0;
+	count = 0;
+	busy = false;
+	segments = 0;
+	errors = 0;
+	thread_started = false;
+	run_flag = false;
+	error_flag = false;
+	pthread_mutex_init(&mutex, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&work, &attr);
+	pthread_cond_init(&space, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+/** @~english
+* @brief Waits until the sent segment is done, queued segments are discarded.
+*
+* @~german
+* @brief Wartet, bis das gesendete Segment fertig ist, eingereihte Segmente werden verworfen.
+*/
+gnublin_step_planner::~gnublin_step_planner(){
+	if (thread_started) {
+		pthread_mutex_lock(&mutex);
+		run_flag = false;
+		count = 0;
+		pthread_cond_broadcast(&work);
+		pthread_mutex_unlock(&mutex);
+		pthread_join(thread, NULL);
+	}
+	pthread_cond_destroy(&work);
+	pthread_cond_destroy(&space);
+	pthread_mutex_destroy(&mutex);
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_step_planner::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_step_planner::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------addAxis-------------
+/** @~english
+* @brief Add an axis.
+*
+* The actual position of the motor is read, all axes must be added before the first move.
+* @param motor the motor, it must be initialised (setMotorParam(), runInit())
+* @return index of the axis, failure: -1
+*
+* @~german
+* @brief Fügt eine Achse hinzu.
+*
+* Die aktuelle Position des Motors wird gelesen, alle Achsen müssen vor der ersten Bewegung hinzugefügt werden.
+* @param motor der Motor, er muss initialisiert sein (setMotorParam(), runInit())
+* @return Index der Achse, Fehler: -1
+*/
+int gnublin_step_planner::addAxis(gnublin_module_step *motor){
+	gnublin_step_status status;
+	int axis;
+
+	pthread_mutex_lock(&mutex);
+	if (axis_count >= STEP_PLANNER_MAX_AXES || count || busy) {
+		pthread_mutex_unlock(&mutex);
+		ErrorMessage = "too many axes or planner is moving\n";
+		error_flag = true;
+		return -1;
+	}
+	if (motor->updateStatus(&status) < 0) {
+		pthread_mutex_unlock(&mutex);
+		ErrorMessage = motor->getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
+	if (poller.addMotor(motor) < 0) {
+		pthread_mutex_unlock(&mutex);
+		ErrorMessage = poller.getErrorMessage();
+		error_flag = true;
+		return -1;
+	}
+	axis = axis_count;
+	axes[axis] = motor;
+	planned[axis] = status.position;
+	current[axis] = status.position;
+	sent_vmax[axis] = -1;
+	axis_count++;
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return axis;
+}
+
+//-------------setVmax-------------
+/** @~english
+* @brief Set the velocity of the longest axis.
+*
+* Applies to the segments which are queued afterwards.
+* @param vmax Vmax of the TMC222 (0-15)
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Geschwindigkeit der längsten Achse.
+*
+* Gilt für die danach eingereihten Segmente.
+* @param vmax Vmax des TMC222 (0-15)
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_planner::setVmax(unsigned int vmax){
+	if (vmax > 15) {
+		ErrorMessage = "vmax is not between 0-15\n";
+		error_flag = true;
+		return -1;
+	}
+	pthread_mutex_lock(&mutex);
+	this->vmax = vmax;
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return 1;
+}
+
+//-------------move-------------
+/** @~english
+* @brief Queue a linear move to absolute positions.
+*
+* Blocks while the queue is full (32 segments).
+* @param targets target position of every axis, in the order the axes were added
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Reiht eine lineare Bewegung zu absoluten Positionen ein.
+*
+* Blockiert, solange die Warteschlange voll ist (32 Segmente).
+* @param targets Ziel Position jeder Achse, in der Reihenfolge, in der die Achsen hinzugefügt wurden
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_planner::move(const int *targets){
+	segment next;
+
+	for (int i = 0; i < axis_count; i++)
+		next.target[i] = targets[i];
+	return push(next);
+}
+
+//-------------moveRelative-------------
+/** @~english
+* @brief Queue a linear move relative to the end of the queued moves.
+*
+* @param steps steps of every axis, in the order the axes were added
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Reiht eine lineare Bewegung relativ zum Ende der eingereihten Bewegungen ein.
+*
+* @param steps Schritte jeder Achse, in der Reihenfolge, in der die Achsen hinzugefügt wurden
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_planner::moveRelative(const int *steps){
+	segment next;
+
+	pthread_mutex_lock(&mutex);
+	for (int i = 0; i < axis_count; i++)
+		next.target[i] = planned[i] + steps[i];
+	pthread_mutex_unlock(&mutex);
+	return push(next);
+}
+
+int gnublin_step_planner::push(const segment &next){
+	if (axis_count == 0) {
+		ErrorMessage = "no axis\n";
+		error_flag = true;
+		return -1;
+	}
+	for (int i = 0; i < axis_count; i++) {
+		if (next.target[i] < -32768 || next.target[i] > 32767) {
+			ErrorMessage = "position is not between -32768 and 32767\n";
+			error_flag = true;
+			return -1;
+		}
+	}
+	pthread_mutex_lock(&mutex);
+	if (!thread_started) {
+		run_flag = true;
+		if (pthread_create(&thread, NULL, run, this) != 0) {
+			run_flag = false;
+			pthread_mutex_unlock(&mutex);
+			ErrorMessage = "pthread_create failed\n";
+			error_flag = true;
+			return -1;
+		}
+		thread_started = true;
+	}
+	while (count == STEP_PLANNER_QUEUE)
+		pthread_cond_wait(&space, &mutex);
+	queue[(first + count) % STEP_PLANNER_QUEUE] = next;
+	queue[(first + count) % STEP_PLANNER_QUEUE].vmax = vmax;
+	count++;
+	for (int i = 0; i < axis_count; i++)
+		planned[i] = next.target[i];
+	pthread_cond_signal(&work);
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return 1;
+}
+
+//-------------wait-------------
+/** @~english
+* @brief Wait until all queued segments are done.
+*
+* @param timeout_ms maximum time to wait in ms, -1 waits forever
+* @return done: 1, timeout: 0, a segment failed: -1 (see getErrorMessage())
+*
+* @~german
+* @brief Wartet, bis alle eingereihten Segmente fertig sind.
+*
+* @param timeout_ms maximale Wartezeit in ms, -1 wartet unbegrenzt
+* @return fertig: 1, Zeitüberschreitung: 0, ein Segment ist fehlgeschlagen: -1 (siehe getErrorMessage())
+*/
+int gnublin_step_planner::wait(int timeout_ms){
+	struct timespec deadline;
+	int result = 1;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += timeout_ms / 1000;
+	deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000) {
+		deadline.tv_nsec -= 1000000000;
+		deadline.tv_sec++;
+	}
+	pthread_mutex_lock(&mutex);
+	while (count || busy) {
+		if (timeout_ms < 0)
+			pthread_cond_wait(&space, &mutex);
+		else if (pthread_cond_timedwait(&space, &mutex, &deadline) == ETIMEDOUT)
+			break;
+	}
+	if (count || busy)
+		result = 0;
+	if (!thread_error.empty()) {
+		ErrorMessage = thread_error;
+		thread_error.clear();
+		error_flag = true;
+		pthread_mutex_unlock(&mutex);
+		return -1;
+	}
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return result;
+}
+
+//-------------pending-------------
+/** @~english
+* @brief Number of segments which are queued or running.
+*
+* @return number of segments
+*
+* @~german
+* @brief Anzahl der eingereihten oder laufenden Segmente.
+*
+* @return Anzahl der Segmente
+*/
+int gnublin_step_planner::pending(){
+	int n;
+
+	pthread_mutex_lock(&mutex);
+	n = count + (busy ? 1 : 0);
+	pthread_mutex_unlock(&mutex);
+	return n;
+}
+
+//-------------getPosition-------------
+/** @~english
+* @brief Position of an axis at the end of the queued segments.
+*
+* @param axis index of the axis
+* @return position, 0 for an invalid axis
+*
+* @~german
+* @brief Position einer Achse am Ende der eingereihten Segmente.
+*
+* @param axis Index der Achse
+* @return Position, 0 bei ungültiger Achse
+*/
+int gnublin_step_planner::getPosition(int axis){
+	int position;
+
+	if (axis < 0 || axis >= axis_count)
+		return 0;
+	pthread_mutex_lock(&mutex);
+	position = planned[axis];
+	pthread_mutex_unlock(&mutex);
+	return position;
+}
+
+//-------------getSegments-------------
+/** @~english
+* @brief Number of finished segments.
+*
+* @return number of segments
+*
+* @~german
+* @brief Anzahl der fertigen Segmente.
+*
+* @return Anzahl der Segmente
+*/
+unsigned int gnublin_step_planner::getSegments(){
+	return segments;
+}
+
+//-------------getErrors-------------
+/** @~english
+* @brief Number of failed segments.
+*
+* @return number of segments
+*
+* @~german
+* @brief Anzahl der fehlgeschlagenen Segmente.
+*
+* @return Anzahl der Segmente
+*/
+unsigned int gnublin_step_planner::getErrors(){
+	return errors;
+}
+
+// sends the motor parameters and positions of one segment in one transfer, returns the number of moving axes
+int gnublin_step_planner::dispatch(const segment &next, int *handles){
+	struct i2c_msg msgs[2 * STEP_PLANNER_MAX_AXES];
+	unsigned char params[STEP_PLANNER_MAX_AXES][8];
+	unsigned char positions[STEP_PLANNER_MAX_AXES][5];
+	int distance[STEP_PLANNER_MAX_AXES];
+	int longest = 0, velocity = stepVelocity(next.vmax);
+	int n = 0, moving = 0;
+
+	for (int i = 0; i < axis_count; i++) {
+		distance[i] = abs(next.target[i] - current[i]);
+		if (distance[i] > longest)
+			longest = distance[i];
+	}
+	if (longest == 0)
+		return 0;
+
+	// pass 0: motor parameters of the axes whose velocity changes, pass 1: positions
+	for (int pass = 0; pass < 2; pass++) {
+		for (int i = 0; i < axis_count; i++) {
+			if (distance[i] == 0)
+				continue;
+			msgs[n].addr = axes[i]->getAddress();
+			msgs[n].flags = 0;
+			if (pass == 0) {
+				int wanted = (long long)velocity * distance[i] / longest;
+				int best = next.vmax;
+
+				for (int v = 0; v < (int)next.vmax; v++) {
+					if (abs(stepVelocity(v) - wanted) < abs(stepVelocity(best) - wanted))
+						best = v;
+				}
+				if (best == sent_vmax[i])
+					continue;
+				msgs[n].len = axes[i]->buildSetMotorParam(params[i], best);
+				msgs[n].buf = params[i];
+				sent_vmax[i] = best;
+			}
+			else {
+				msgs[n].len = axes[i]->buildSetPosition(positions[i], next.target[i]);
+				msgs[n].buf = positions[i];
+			}
+			n++;
+		}
+	}
+	if (axes[0]->transfer(msgs, n) < 0) {
+		// the parameters may not have arrived
+		for (int i = 0; i < axis_count; i++)
+			sent_vmax[i] = -1;
+		return -1;
+	}
+	for (int i = 0; i < axis_count; i++) {
+		if (distance[i] == 0)
+			continue;
+		handles[moving++] = poller.watch(i, next.target[i]);
+		current[i] = next.target[i];
+	}
+	return moving;
+}
+
+void *gnublin_step_planner::run(void *arg){
+	gnublin_step_planner *p = (gnublin_step_planner *)arg;
+	int handles[STEP_PLANNER_MAX_AXES];
+
+	pthread_mutex_lock(&p->mutex);
+	while (p->run_flag) {
+		segment next;
+		int moving;
+
+		if (p->count == 0) {
+			// the axes may be used directly now, so the parameters are sent again with the next segment
+			for (int i = 0; i < p->axis_count; i++)
+				p->sent_vmax[i] = -1;
+			p->busy = false;
+			pthread_cond_broadcast(&p->space);
+			pthread_cond_wait(&p->work, &p->mutex);
+			continue;
+		}
+		next = p->queue[p->first];
+		p->first = (p->first + 1) % STEP_PLANNER_QUEUE;
+		p->count--;
+		p->busy = true;
+		pthread_cond_broadcast(&p->space);
+		pthread_mutex_unlock(&p->mutex);
+
+		moving = p->dispatch(next, handles);
+		if (moving < 0) {
+			pthread_mutex_lock(&p->mutex);
+			p->thread_error = p->axes[0]->getErrorMessage();
+			p->errors++;
+		}
+		else if (moving > 0 && p->poller.wait(handles, moving, -1) < 0) {
+			pthread_mutex_lock(&p->mutex);
+			p->thread_error = "an axis failed while moving\n";
+			p->errors++;
+		}
+		else
+			pthread_mutex_lock(&p->mutex);
+		p->segments++;
+	}
+	p->busy = false;
+	pthread_cond_broadcast(&p->space);
+	pthread_mutex_unlock(&p->mutex);
+	return NULL;
+}
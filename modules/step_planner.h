@@ -0,0 +1,77 @@
+#include "../include/includes.h"
+#include "module_step.h"
+#include "step_poller.h"
+
+#define STEP_PLANNER_MAX_AXES	8
+#define STEP_PLANNER_QUEUE	32
+
+//****************************************************************************
+// Class for coordinated moves of several GNUBLIN Module-steps
+//****************************************************************************
+/**
+* @class gnublin_step_planner
+* @~english
+* @brief Linear moves of up to 8 axes, each axis driven by a gnublin_module_step
+*
+* move() queues a segment with the targets of all axes. A thread takes the segments in order:
+* the axis with the longest distance runs with the set Vmax, every other axis gets the Vmax whose velocity matches its share of the distance best, so all axes arrive together.
+* The changed motor parameters and the SetPosition commands of all axes are sent back to back in one bus transaction.
+* The next segment is sent as soon as the status reads show that all axes arrived.
+* All axes must be on the same I2C bus and must only be used through the planner while it has segments.
+* @~german
+* @brief Lineare Bewegungen von bis zu 8 Achsen, jede Achse wird von einem gnublin_module_step angetrieben
+*
+* move() reiht ein Segment mit den Zielen aller Achsen ein. Ein Thread arbeitet die Segmente der Reihe nach ab:
+* die Achse mit der längsten Strecke fährt mit dem eingestellten Vmax, jede andere Achse bekommt das Vmax, dessen Geschwindigkeit am besten zu ihrem Anteil an der Strecke passt, so dass alle Achsen gemeinsam ankommen.
+* Die geänderten Motor Parameter und die SetPosition Befehle aller Achsen werden direkt hintereinander in einer Bus Transaktion gesendet.
+* Das nächste Segment wird gesendet, sobald die Status Abfragen zeigen, dass alle Achsen angekommen sind.
+* Alle Achsen müssen am selben I2C Bus hängen und dürfen nur über den Planer verwendet werden, solange er Segmente hat.
+*/
+class gnublin_step_planner {
+	public:
+		gnublin_step_planner();
+		~gnublin_step_planner();
+		int addAxis(gnublin_module_step *motor);
+		int setVmax(unsigned int vmax);
+		int move(const int *targets);
+		int moveRelative(const int *steps);
+		int wait(int timeout_ms);
+		int pending();
+		int getPosition(int axis);
+		unsigned int getSegments();
+		unsigned int getErrors();
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		struct segment {
+			int target[STEP_PLANNER_MAX_AXES];
+			unsigned int vmax;
+		};
+		gnublin_step_planner(const gnublin_step_planner &);
+		gnublin_step_planner &operator=(const gnublin_step_planner &);
+		static void *run(void *arg);
+		int push(const segment &next);
+		int dispatch(const segment &next, int *handles);
+		gnublin_step_poller poller;
+		gnublin_module_step *axes[STEP_PLANNER_MAX_AXES];
+		int axis_count;
+		int planned[STEP_PLANNER_MAX_AXES];	// end position after all queued segments
+		int current[STEP_PLANNER_MAX_AXES];	// end position after the sent segments
+		int sent_vmax[STEP_PLANNER_MAX_AXES];	// -1: not sent yet
+		unsigned int vmax;
+		segment queue[STEP_PLANNER_QUEUE];
+		int first;
+		int count;
+		bool busy;
+		unsigned int segments;
+		unsigned int errors;
+		std::string thread_error;
+		pthread_mutex_t mutex;
+		pthread_cond_t work;
+		pthread_cond_t space;
+		pthread_t thread;
+		bool thread_started;
+		bool run_flag;
+		bool error_flag;
+		std::string ErrorMessage;
+};
@@ -0,0 +1,542 @@
+#include "step_poller.h"
+
+//****************************************************************************
+// Class for waiting on the motion of several GNUBLIN Module-steps
+//****************************************************************************
+
+/** @~english
+* @brief Create a poller without motors.
+*
+* @~german
+* @brief Erzeugt einen Poller ohne Motoren.
+*/
+gnublin_step_poller::gnublin_step_poller(){
+	pthread_condattr_t attr;
+
+	motor_count = 0;
+	queue = NULL;
+	min_interval = STEP_POLLER_MIN_INTERVAL * 1000ULL;
+	max_interval = STEP_POLLER_MAX_INTERVAL * 1000ULL;
+	polls = 0;
+	thread_started = false;
+	run_flag = false;
+	error_flag = false;
+	pthread_mutex_init(&mutex, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&work, &attr);
+	pthread_cond_init(&completion, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+/** @~english
+* @brief Stops the thread, moves in progress are not stopped.
+*
+* @~german
+* @brief Hält den Thread an, laufende Bewegungen werden nicht angehalten.
+*/
+gnublin_step_poller::~gnublin_step_poller(){
+	if (thread_started) {
+		pthread_mutex_lock(&mutex);
+		run_flag = false;
+		pthread_cond_signal(&work);
+		pthread_mutex_unlock(&mutex);
+		pthread_join(thread, NULL);
+	}
+	pthread_cond_destroy(&work);
+	pthread_cond_destroy(&completion);
+	pthread_mutex_destroy(&mutex);
+}
+
+//-------------fail-------------
+/** @~english
+* @brief Returns the error flag.
+*
+* If something went wrong, the flag is true.
+* @return bool error_flag
+*
+* @~german
+* @brief Gibt das Error Flag zurück.
+*
+* Falls das Error Flag in der Klasse gesetzt wurde, wird true zurück gegeben, anderenfalls false.
+* @return bool error_flag
+*/
+bool gnublin_step_poller::fail(){
+	return error_flag;
+}
+
+//-------------getErrorMessage-------------
+/** @~english
+* @brief Get the last Error Message.
+*
+* This Funktion returns the last Error Message, which occurred in that Class.
+* @return ErrorMessage as c-string
+*
+* @~german
+* @brief Gibt die letzte Error Nachricht zurück.
+*
+* Diese Funktion gibt die Letzte Error Nachricht zurück, welche in dieser Klasse gespeichert wurde.
+* @return ErrorMessage als c-string
+*/
+const char *gnublin_step_poller::getErrorMessage(){
+	return ErrorMessage.c_str();
+}
+
+//-------------addMotor-------------
+/** @~english
+* @brief Add a motor.
+*
+* The thread is started with the first motor.
+* @param motor the motor, it must be initialised (setMotorParam(), runInit())
+* @return index of the motor, failure: -1
+*
+* @~german
+* @brief Fügt einen Motor hinzu.
+*
+* Der Thread wird mit dem ersten Motor gestartet.
+* @param motor der Motor, er muss initialisiert sein (setMotorParam(), runInit())
+* @return Index des Motors, Fehler: -1
+*/
+int gnublin_step_poller::addMotor(gnublin_module_step *motor){
+	int index;
+
+	pthread_mutex_lock(&mutex);
+	if (motor_count >= STEP_POLLER_MAX_MOTORS) {
+		pthread_mutex_unlock(&mutex);
+		ErrorMessage = "too many motors\n";
+		error_flag = true;
+		return -1;
+	}
+	if (!thread_started) {
+		run_flag = true;
+		if (pthread_create(&thread, NULL, run, this) != 0) {
+			run_flag = false;
+			pthread_mutex_unlock(&mutex);
+			ErrorMessage = "pthread_create failed\n";
+			error_flag = true;
+			return -1;
+		}
+		thread_started = true;
+	}
+	index = motor_count;
+	motors[index].motor = motor;
+	motors[index].issued = 0;
+	motors[index].completed = 0;
+	motors[index].result = 1;
+	motors[index].position = 0;
+	motors[index].velocity = 0;
+	motors[index].next_poll = 0;
+	motor_count++;
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return index;
+}
+
+//-------------setPosition-------------
+/** @~english
+* @brief Drive a motor to a position.
+*
+* A new move of a motor replaces its previous one, both handles complete when the motor stands still.
+* @param motor index of the motor
+* @param position target position
+* @return handle of the move (> 0), failure: -1
+*
+* @~german
+* @brief Fährt einen Motor an eine Position.
+*
+* Eine neue Bewegung eines Motors ersetzt seine vorherige, beide Handles sind abgeschlossen, wenn der Motor steht.
+* @param motor Index des Motors
+* @param position Ziel Position
+* @return Handle der Bewegung (> 0), Fehler: -1
+*/
+int gnublin_step_poller::setPosition(int motor, int position){
+	return start(motor, position, false);
+}
+
+//-------------drive-------------
+/** @~english
+* @brief Drive a motor an amount of steps.
+*
+* @param motor index of the motor
+* @param steps steps relative to the actual position
+* @return handle of the move (> 0), failure: -1
+*
+* @~german
+* @brief Fährt einen Motor eine Anzahl Schritte.
+*
+* @param motor Index des Motors
+* @param steps Schritte relativ zur aktuellen Position
+* @return Handle der Bewegung (> 0), Fehler: -1
+*/
+int gnublin_step_poller::drive(int motor, int steps){
+	return start(motor, steps, true);
+}
+
+int gnublin_step_poller::start(int motor, int value, bool relative){
+	motor_state *m;
+	int result, handle;
+
+	if (motor < 0 || motor >= motor_count) {
+		ErrorMessage = "invalid motor\n";
+		error_flag = true;
+		return -1;
+	}
+	m = &motors[motor];
+	pthread_mutex_lock(&mutex);
+	result = relative ? m->motor->drive(value) : m->motor->setPosition(value);
+	if (result < 0) {
+		ErrorMessage = m->motor->getErrorMessage();
+		pthread_mutex_unlock(&mutex);
+		error_flag = true;
+		return -1;
+	}
+	handle = issue(motor, relative ? abs(value) : abs(value - m->position));
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return handle;
+}
+
+//-------------watch-------------
+/** @~english
+* @brief Watch a move which was started without the poller.
+*
+* E.g. a SetPosition which was sent together with other commands with gnublin_module_step::transfer().
+* @param motor index of the motor
+* @param target target position of the move
+* @return handle of the move (> 0), failure: -1
+*
+* @~german
+* @brief Überwacht eine Bewegung, die ohne den Poller gestartet wurde.
+*
+* Z.B. ein SetPosition, das zusammen mit anderen Befehlen mit gnublin_module_step::transfer() gesendet wurde.
+* @param motor Index des Motors
+* @param target Ziel Position der Bewegung
+* @return Handle der Bewegung (> 0), Fehler: -1
+*/
+int gnublin_step_poller::watch(int motor, int target){
+	int handle;
+
+	if (motor < 0 || motor >= motor_count) {
+		ErrorMessage = "invalid motor\n";
+		error_flag = true;
+		return -1;
+	}
+	pthread_mutex_lock(&mutex);
+	handle = issue(motor, abs(target - motors[motor].position));
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return handle;
+}
+
+// registers a new move and wakes up the thread; the mutex must be held
+int gnublin_step_poller::issue(int motor, int distance){
+	motor_state *m = &motors[motor];
+
+	m->issued++;
+	m->next_poll = getMonotonicTime() + interval(motor, distance);
+	pthread_cond_signal(&work);
+	return m->issued * STEP_POLLER_MAX_MOTORS + motor;
+}
+
+// half of the expected remaining time, between the minimum and maximum interval
+unsigned long long gnublin_step_poller::interval(int motor, int remaining){
+	unsigned long long t;
+
+	if (motors[motor].velocity == 0)
+		return min_interval;
+	t = remaining * 500000ULL / motors[motor].velocity;
+	if (t < min_interval)
+		return min_interval;
+	if (t > max_interval)
+		return max_interval;
+	return t;
+}
+
+// 1: done, 0: running, -1: failed; the mutex must be held
+int gnublin_step_poller::check(int handle){
+	int motor = handle % STEP_POLLER_MAX_MOTORS;
+	unsigned int sequence = handle / STEP_POLLER_MAX_MOTORS;
+
+	if (handle <= 0 || motor >= motor_count || sequence > motors[motor].issued)
+		return -1;
+	if (sequence > motors[motor].completed)
+		return 0;
+	return motors[motor].result;
+}
+
+//-------------done-------------
+/** @~english
+* @brief Check if a move is completed.
+*
+* @param handle handle of the move
+* @return done: 1, running: 0, failure or invalid handle: -1
+*
+* @~german
+* @brief Prüft, ob eine Bewegung abgeschlossen ist.
+*
+* @param handle Handle der Bewegung
+* @return abgeschlossen: 1, läuft: 0, Fehler oder ungültiges Handle: -1
+*/
+int gnublin_step_poller::done(int handle){
+	int result;
+
+	pthread_mutex_lock(&mutex);
+	result = check(handle);
+	pthread_mutex_unlock(&mutex);
+	return result;
+}
+
+// absolute CLOCK_MONOTONIC time after timeout_ms, false for an unlimited timeout
+bool gnublin_step_poller::deadline(int timeout_ms, struct timespec *time){
+	if (timeout_ms < 0)
+		return false;
+	clock_gettime(CLOCK_MONOTONIC, time);
+	time->tv_sec += timeout_ms / 1000;
+	time->tv_nsec += (timeout_ms % 1000) * 1000000L;
+	if (time->tv_nsec >= 1000000000) {
+		time->tv_nsec -= 1000000000;
+		time->tv_sec++;
+	}
+	return true;
+}
+
+//-------------wait-------------
+/** @~english
+* @brief Wait until a move is completed.
+*
+* @param handle handle of the move
+* @param timeout_ms maximum time to wait in ms, -1 waits forever
+* @return done: 1, timeout: 0, failure or invalid handle: -1
+*
+* @~german
+* @brief Wartet, bis eine Bewegung abgeschlossen ist.
+*
+* @param handle Handle der Bewegung
+* @param timeout_ms maximale Wartezeit in ms, -1 wartet unbegrenzt
+* @return abgeschlossen: 1, Zeitüberschreitung: 0, Fehler oder ungültiges Handle: -1
+*/
+int gnublin_step_poller::wait(int handle, int timeout_ms){
+	return wait(&handle, 1, timeout_ms);
+}
+
+/** @~english
+* @brief Wait until several moves are completed.
+*
+* @param handles handles of the moves
+* @param count number of handles
+* @param timeout_ms maximum time to wait in ms, -1 waits forever
+* @return all done: 1, timeout: 0, a move failed or an invalid handle: -1
+*
+* @~german
+* @brief Wartet, bis mehrere Bewegungen abgeschlossen sind.
+*
+* @param handles Handles der Bewegungen
+* @param count Anzahl der Handles
+* @param timeout_ms maximale Wartezeit in ms, -1 wartet unbegrenzt
+* @return alle abgeschlossen: 1, Zeitüberschreitung: 0, eine Bewegung fehlgeschlagen oder ungültiges Handle: -1
+*/
+int gnublin_step_poller::wait(const int *handles, int count, int timeout_ms){
+	struct timespec time;
+	bool limited = deadline(timeout_ms, &time);
+	int result = 1;
+
+	pthread_mutex_lock(&mutex);
+	for (int i = 0; i < count; i++) {
+		while ((result = check(handles[i])) == 0) {
+			if (!limited)
+				pthread_cond_wait(&completion, &mutex);
+			else if (pthread_cond_timedwait(&completion, &mutex, &time) == ETIMEDOUT) {
+				result = check(handles[i]);
+				break;
+			}
+		}
+		if (result != 1)
+			break;
+	}
+	pthread_mutex_unlock(&mutex);
+	return result;
+}
+
+//-------------waitAll-------------
+/** @~english
+* @brief Wait until all motors stand still.
+*
+* @param timeout_ms maximum time to wait in ms, -1 waits forever
+* @return all done: 1, timeout: 0, a move failed: -1
+*
+* @~german
+* @brief Wartet, bis alle Motoren stehen.
+*
+* @param timeout_ms maximale Wartezeit in ms, -1 wartet unbegrenzt
+* @return alle abgeschlossen: 1, Zeitüberschreitung: 0, eine Bewegung fehlgeschlagen: -1
+*/
+int gnublin_step_poller::waitAll(int timeout_ms){
+	int handles[STEP_POLLER_MAX_MOTORS];
+	int count = 0;
+
+	pthread_mutex_lock(&mutex);
+	for (int i = 0; i < motor_count; i++) {
+		if (motors[i].issued)
+			handles[count++] = motors[i].issued * STEP_POLLER_MAX_MOTORS + i;
+	}
+	pthread_mutex_unlock(&mutex);
+	return wait(handles, count, timeout_ms);
+}
+
+//-------------getPosition-------------
+/** @~english
+* @brief Position of a motor at its last status read.
+*
+* @param motor index of the motor
+* @return position, 0 for an invalid motor
+*
+* @~german
+* @brief Position eines Motors beim letzten Status Lesezugriff.
+*
+* @param motor Index des Motors
+* @return Position, 0 bei ungültigem Motor
+*/
+int gnublin_step_poller::getPosition(int motor){
+	int position;
+
+	if (motor < 0 || motor >= motor_count)
+		return 0;
+	pthread_mutex_lock(&mutex);
+	position = motors[motor].position;
+	pthread_mutex_unlock(&mutex);
+	return position;
+}
+
+//-------------setEventQueue-------------
+/** @~english
+* @brief Deliver completed moves as events.
+*
+* Every completed move pushes an EVENT_MOTION_DONE event, device is the I2C address, source the index of the motor and value the position (or -1 for a failure).
+* @param queue the event queue, NULL: no events
+*
+* @~german
+* @brief Liefert abgeschlossene Bewegungen als Ereignisse.
+*
+* Jede abgeschlossene Bewegung erzeugt ein EVENT_MOTION_DONE Ereignis, device ist die I2C Adresse, source der Index des Motors und value die Position (oder -1 bei einem Fehler).
+* @param queue die Ereignis Warteschlange, NULL: keine Ereignisse
+*/
+void gnublin_step_poller::setEventQueue(gnublin_event_queue *queue){
+	pthread_mutex_lock(&mutex);
+	this->queue = queue;
+	pthread_mutex_unlock(&mutex);
+}
+
+//-------------setInterval-------------
+/** @~english
+* @brief Set the limits of the polling interval.
+*
+* @param min_ms shortest interval in ms (1-1000), default 2
+* @param max_ms longest interval in ms (min_ms-10000), default 100
+* @return success: 1, failure: -1
+*
+* @~german
+* @brief Setzt die Grenzen des Abfrage Intervalls.
+*
+* @param min_ms kürzestes Intervall in ms (1-1000), Standard 2
+* @param max_ms längstes Intervall in ms (min_ms-10000), Standard 100
+* @return Erfolg: 1, Fehler: -1
+*/
+int gnublin_step_poller::setInterval(int min_ms, int max_ms){
+	if (min_ms < 1 || min_ms > 1000 || max_ms < min_ms || max_ms > 10000) {
+		ErrorMessage = "invalid interval\n";
+		error_flag = true;
+		return -1;
+	}
+	pthread_mutex_lock(&mutex);
+	min_interval = min_ms * 1000ULL;
+	max_interval = max_ms * 1000ULL;
+	pthread_mutex_unlock(&mutex);
+	error_flag = false;
+	return 1;
+}
+
+//-------------getPolls-------------
+/** @~english
+* @brief Number of status reads of the thread.
+*
+* @return number of status reads
+*
+* @~german
+* @brief Anzahl der Status Lesezugriffe des Threads.
+*
+* @return Anzahl der Status Lesezugriffe
+*/
+unsigned int gnublin_step_poller::getPolls(){
+	return polls;
+}
+
+// reads the status of a moving motor and completes its moves when it stands at the target; the mutex must be held
+bool gnublin_step_poller::poll(int motor, unsigned long long now, gnublin_event *event){
+	motor_state *m = &motors[motor];
+	gnublin_step_status status;
+
+	polls++;
+	if (m->motor->updateStatus(&status) < 0 || status.electrical_defect || status.thermal_shutdown) {
+		m->result = -1;
+	}
+	else {
+		m->position = status.position;
+		m->velocity = stepVelocity(status.vmax) * (2 << status.step_mode);
+		if (status.motion != 0 || status.position != status.target) {
+			m->next_poll = now + interval(motor, abs(status.target - status.position));
+			return false;
+		}
+		m->result = 1;
+	}
+	m->completed = m->issued;
+	pthread_cond_broadcast(&completion);
+	event->type = EVENT_MOTION_DONE;
+	event->device = m->motor->getAddress();
+	event->source = motor;
+	event->value = m->result < 0 ? -1 : m->position;
+	event->timestamp = now;
+	return true;
+}
+
+void *gnublin_step_poller::run(void *arg){
+	gnublin_step_poller *p = (gnublin_step_poller *)arg;
+	gnublin_event events[STEP_POLLER_MAX_MOTORS];
+
+	pthread_mutex_lock(&p->mutex);
+	while (p->run_flag) {
+		unsigned long long now = getMonotonicTime();
+		unsigned long long next = 0;
+		struct timespec time;
+		int count = 0;
+
+		for (int i = 0; i < p->motor_count; i++) {
+			motor_state *m = &p->motors[i];
+
+			if (m->completed == m->issued)
+				continue;
+			if (m->next_poll <= now && p->poll(i, now, &events[count]))
+				count++;
+			if (m->completed != m->issued && (next == 0 || m->next_poll < next))
+				next = m->next_poll;
+		}
+		// the callback of the queue may call the poller, so the events are pushed without the mutex
+		if (count && p->queue) {
+			gnublin_event_queue *queue = p->queue;
+
+			pthread_mutex_unlock(&p->mutex);
+			for (int i = 0; i < count; i++)
+				queue->push(events[i]);
+			pthread_mutex_lock(&p->mutex);
+			continue;
+		}
+		if (next == 0) {
+			pthread_cond_wait(&p->work, &p->mutex);
+			continue;
+		}
+		time.tv_sec = next / 1000000;
+		time.tv_nsec = (next % 1000000) * 1000;
+		pthread_cond_timedwait(&p->work, &p->mutex, &time);
+	}
+	pthread_mutex_unlock(&p->mutex);
+	return NULL;
+}
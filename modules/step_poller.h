@@ -0,0 +1,82 @@
+#include "../include/includes.h"
+#include "../drivers/event.h"
+#include "module_step.h"
+
+#define STEP_POLLER_MAX_MOTORS	16
+#define STEP_POLLER_MIN_INTERVAL	2	// ms
+#define STEP_POLLER_MAX_INTERVAL	100	// ms
+
+//****************************************************************************
+// Class for waiting on the motion of several GNUBLIN Module-steps
+//****************************************************************************
+/**
+* @class gnublin_step_poller
+* @~english
+* @brief Starts moves of several gnublin_module_step and watches them with one thread
+*
+* setPosition() and drive() return a handle, which is completed when the motor stands still at its target.
+* One thread polls all moving motors with one status read each. The interval adapts to the remaining distance and velocity:
+* slow while the motor is far away from its target, fast shortly before it arrives.
+* Completed moves can also be delivered as EVENT_MOTION_DONE events.
+* While a motor is moving, it must only be used through the poller.
+* @~german
+* @brief Startet Bewegungen mehrerer gnublin_module_step und überwacht sie mit einem Thread
+*
+* setPosition() und drive() geben ein Handle zurück, das abgeschlossen ist, wenn der Motor an seinem Ziel steht.
+* Ein Thread fragt alle fahrenden Motoren mit je einem Status Lesezugriff ab. Der Abstand passt sich der restlichen Strecke und der Geschwindigkeit an:
+* langsam, solange der Motor weit vom Ziel entfernt ist, schnell kurz bevor er ankommt.
+* Abgeschlossene Bewegungen können auch als EVENT_MOTION_DONE Ereignisse geliefert werden.
+* Während ein Motor fährt, darf er nur über den Poller verwendet werden.
+*/
+class gnublin_step_poller {
+	public:
+		gnublin_step_poller();
+		~gnublin_step_poller();
+		int addMotor(gnublin_module_step *motor);
+		int setPosition(int motor, int position);
+		int drive(int motor, int steps);
+		int watch(int motor, int target);
+		int done(int handle);
+		int wait(int handle, int timeout_ms);
+		int wait(const int *handles, int count, int timeout_ms);
+		int waitAll(int timeout_ms);
+		int getPosition(int motor);
+		void setEventQueue(gnublin_event_queue *queue);
+		int setInterval(int min_ms, int max_ms);
+		unsigned int getPolls();
+		bool fail();
+		const char *getErrorMessage();
+	private:
+		struct motor_state {
+			gnublin_module_step *motor;
+			unsigned int issued;		// sequence number of the last move
+			unsigned int completed;		// moves up to this number are done
+			int result;			// of the last completion, 1 or -1
+			int position;			// of the last status read
+			unsigned int velocity;		// steps per second of the last status read
+			unsigned long long next_poll;	// µs, CLOCK_MONOTONIC
+		};
+		gnublin_step_poller(const gnublin_step_poller &);
+		gnublin_step_poller &operator=(const gnublin_step_poller &);
+		static void *run(void *arg);
+		int start(int motor, int value, bool relative);
+		int issue(int motor, int distance);
+		bool poll(int motor, unsigned long long now, gnublin_event *event);
+		unsigned long long interval(int motor, int remaining);
+		int check(int handle);
+		bool deadline(int timeout_ms, struct timespec *time);
+		motor_state motors[STEP_POLLER_MAX_MOTORS];
+		int motor_count;
+		gnublin_event_queue *queue;
+		unsigned long long min_interval;
+		unsigned long long max_interval;
+		unsigned int polls;
+		pthread_mutex_t mutex;
+		pthread_cond_t work;
+		pthread_cond_t completion;
+		pthread_t thread;
+		bool thread_started;
+		bool run_flag;
+		bool error_flag;
+		std::string ErrorMessage;
+};